@@ -5,6 +5,8 @@
 #include "mlir/Analysis/DataFlow/SparseAnalysis.h"
 #include "llvm/ADT/DenseSet.h"
 
+#include <optional>
+
 namespace mlir {
 
 class AliasInfo {
@@ -12,12 +14,42 @@ public:
   AliasInfo() = default;
   AliasInfo(Value value) { insert(value); }
 
-  void insert(Value value) { allocs.insert(value); }
+  void insert(Value value) {
+    allocs.insert(value);
+    slots.erase(value);
+  }
+
+  /// Inserts a single slot along the leading dimension of `value`, if the
+  /// other slots of `value` aren't aliased yet.
+  void insert(Value value, int64_t slot) {
+    if (!allocs.insert(value).second && !slots.count(value))
+      return;
+    auto &allocSlots = slots[value];
+    auto it = llvm::lower_bound(allocSlots, slot);
+    if (it == allocSlots.end() || *it != slot)
+      allocSlots.insert(it, slot);
+  }
 
   const DenseSet<Value> &getAllocs() const { return allocs; }
 
+  /// Returns the sorted slots of `alloc` that are aliased, or std::nullopt
+  /// if the whole `alloc` is.
+  std::optional<ArrayRef<int64_t>> getSlots(Value alloc) const {
+    auto it = slots.find(alloc);
+    if (it == slots.end())
+      return std::nullopt;
+    return ArrayRef<int64_t>(it->second);
+  }
+
   bool operator==(const AliasInfo &other) const {
-    return allocs == other.allocs;
+    if (allocs != other.allocs || slots.size() != other.slots.size())
+      return false;
+    for (auto &[alloc, allocSlots] : slots) {
+      auto otherSlots = other.getSlots(alloc);
+      if (!otherSlots || *otherSlots != ArrayRef<int64_t>(allocSlots))
+        return false;
+    }
+    return true;
   }
 
   /// The pessimistic value state of a value without alias
@@ -30,7 +62,14 @@ public:
   static AliasInfo join(const AliasInfo &lhs, const AliasInfo &rhs);
 
   void print(raw_ostream &os) const {
-    llvm::interleaveComma(allocs, os, [&](Value alloc) { alloc.print(os); });
+    llvm::interleaveComma(allocs, os, [&](Value alloc) {
+      alloc.print(os);
+      if (auto allocSlots = getSlots(alloc)) {
+        os << "[";
+        llvm::interleaveComma(*allocSlots, os);
+        os << "]";
+      }
+    });
   }
 
 private:
@@ -57,8 +96,21 @@ private:
   /// Therefore, v1's liveness range is the union of v3, v4, and v6
   /// v2's liveness range is the union of v4 and v5.
   DenseSet<Value> allocs;
+  /// The allocated values of which only some slots along the leading
+  /// dimension are aliased, e.g. by
+  ///   %slice = triton_gpu.extract_slice %buffer[1, 0, 0] [1, 16, 16]
+  /// whose alias is [%buffer[1]]. A multi-buffered allocation is then only
+  /// accessed at the stages of its slices.
+  DenseMap<Value, SmallVector<int64_t>> slots;
 };
 
+/// Returns the index of the slot along the leading dimension of `shape`
+/// covered by a slice, if the slice covers exactly one slot.
+std::optional<int64_t> getSlotIndex(ArrayRef<OpFoldResult> offsets,
+                                    ArrayRef<OpFoldResult> sizes,
+                                    ArrayRef<OpFoldResult> strides,
+                                    ArrayRef<int64_t> shape);
+
 //===----------------------------------------------------------------------===//
 // Shared Memory Alias Analysis
 //===----------------------------------------------------------------------===//
@@ -21,8 +21,32 @@ SmallVector<unsigned>
 getScratchConfigForCvtLayout(triton::gpu::ConvertLayoutOp op, unsigned &inVec,
                              unsigned &outVec);
 
+/// Same as above, and sets `swizzleVec` to the number of elements of the XOR
+/// swizzled chunks of the scratch buffer, or to 0 if the buffer is padded
+/// instead. Swizzled buffers are not padded: the chunks of each row are
+/// permuted so that vectors of up to `swizzleVec` elements stay contiguous.
+/// Swizzling is used for 2D blocked/mma conversions when
+/// TRITON_SWIZZLE_CVT_LAYOUT is set.
+SmallVector<unsigned>
+getScratchConfigForCvtLayout(triton::gpu::ConvertLayoutOp op, unsigned &inVec,
+                             unsigned &outVec, unsigned &swizzleVec);
+
 } // namespace triton
 
+/// Strategies used to assign offsets to shared memory buffers.
+enum class AllocationStrategy {
+  /// Triple-map start offsets followed by first-fit graph coloring.
+  Heuristic,
+  /// Best-fit packing of the buffers over their live ranges. Small functions
+  /// are solved with an exhaustive search over placement orders. The result
+  /// is never larger than the one of the heuristic.
+  BestFit,
+};
+
+/// Returns the strategy selected by the TRITON_SMEM_ALLOCATOR environment
+/// variable ("heuristic" or "best-fit"), defaulting to the heuristic.
+AllocationStrategy getDefaultAllocationStrategy();
+
 /// Modified from llvm-15.0: llvm/ADT/AddressRanges.h
 /// A class that represents an interval, specified using a start and an end
 /// values: [Start, End).
@@ -63,7 +87,10 @@ public:
   Allocation() = default;
   /// Creates a new Allocation analysis that computes the shared memory
   /// information for all associated shared memory values.
-  explicit Allocation(Operation *operation) : operation(operation) {}
+  explicit Allocation(
+      Operation *operation,
+      AllocationStrategy strategy = AllocationStrategy::Heuristic)
+      : operation(operation), strategy(strategy) {}
 
   /// Runs allocation analysis on the given top-level operation.
   void run(FuncAllocMapT &funcAllocMap);
@@ -71,6 +98,9 @@ public:
   /// Returns the operation this analysis was constructed from.
   Operation *getOperation() const { return operation; }
 
+  /// Returns the strategy used to assign the buffer offsets.
+  AllocationStrategy getStrategy() const { return strategy; }
+
   /// Returns the offset of the given buffer in the shared memory.
   size_t getOffset(BufferId bufferId) const {
     return bufferSet.at(bufferId).offset;
@@ -112,6 +142,22 @@ public:
     return bufferIds;
   }
 
+  /// Returns the intervals of the given buffer accessed through the given
+  /// value, which only covers some slots of a multi-buffered allocation if
+  /// it is an alias of them.
+  SmallVector<Interval<size_t>> getAliasedIntervals(Value value,
+                                                    BufferId bufferId) const {
+    auto interval = getAllocatedInterval(bufferId);
+    auto it = aliasSlots.find({value, bufferId});
+    if (it == aliasSlots.end())
+      return {interval};
+    SmallVector<Interval<size_t>> intervals;
+    for (auto slot : it->second)
+      intervals.push_back(Interval<size_t>(interval.start() + slot.start(),
+                                           interval.start() + slot.end()));
+    return intervals;
+  }
+
   /// Returns the scratch buffer id of the given value.
   BufferId getBufferId(Operation *operation) const {
     if (opScratch.count(operation)) {
@@ -131,6 +177,18 @@ public:
   /// Returns the size of total shared memory allocated
   size_t getSharedMemorySize() const { return sharedMemorySize; }
 
+  /// Returns the largest amount of shared memory simultaneously live, which
+  /// is a lower bound of the size achievable by any allocation strategy.
+  size_t getSharedMemoryLowerBound() const { return sharedMemoryLowerBound; }
+
+  /// Returns the largest alignment required by a buffer of this allocation
+  size_t getSharedMemoryAlignment() const {
+    size_t alignment = 1;
+    for (auto &[id, buffer] : bufferSet)
+      alignment = std::max(alignment, buffer.alignment);
+    return alignment;
+  }
+
 private:
   /// A class that represents a shared memory buffer
   struct BufferT {
@@ -145,6 +203,7 @@ private:
     BufferKind kind;
     BufferId id;
     size_t size;
+    size_t alignment;
     size_t offset;
 
     bool operator==(const BufferT &other) const { return id == other.id; }
@@ -152,10 +211,11 @@ private:
 
     BufferT() : BufferT(BufferKind::Explicit) {}
     BufferT(BufferKind kind)
-        : kind(kind), id(InvalidBufferId), size(0), offset(0) {}
-    BufferT(BufferKind kind, size_t size) : BufferT(kind, size, 0) {}
-    BufferT(BufferKind kind, size_t size, size_t offset)
-        : kind(kind), id(nextId++), size(size), offset(offset) {}
+        : kind(kind), id(InvalidBufferId), size(0), alignment(1), offset(0) {}
+    BufferT(BufferKind kind, size_t size, size_t alignment = 1,
+            size_t offset = 0)
+        : kind(kind), id(nextId++), size(size), alignment(alignment),
+          offset(offset) {}
   };
 
   /// Op -> Scratch Buffer
@@ -164,6 +224,9 @@ private:
   using ValueBufferMapT = llvm::MapVector<Value, BufferT *>;
   /// Value -> Alias Buffer
   using AliasBufferMapT = llvm::MapVector<Value, llvm::SetVector<BufferT *>>;
+  /// (Value, BufferId) -> Aliased slots, relative to the buffer
+  using AliasSlotMapT =
+      DenseMap<std::pair<Value, BufferId>, SmallVector<Interval<size_t>>>;
   /// BufferId -> Buffer
   using BufferSetT = std::map<BufferId, BufferT>;
 
@@ -181,18 +244,37 @@ private:
     }
   }
 
-  void addAlias(Value value, Value alloc) {
-    aliasBuffer[value].insert(valueBuffer[alloc]);
+  void addAlias(Value value, Value alloc,
+                std::optional<ArrayRef<int64_t>> slots = std::nullopt) {
+    auto *buffer = valueBuffer[alloc];
+    aliasBuffer[value].insert(buffer);
+    // The slots along the leading dimension of `alloc` split the buffer
+    auto tensorType = alloc.getType().dyn_cast<RankedTensorType>();
+    if (!buffer || !slots || !tensorType || tensorType.getRank() < 2 ||
+        buffer->size % tensorType.getShape()[0] != 0)
+      return;
+    size_t slotSize = buffer->size / tensorType.getShape()[0];
+    SmallVector<Interval<size_t>> intervals;
+    for (auto slot : *slots) {
+      if (slot < 0 || slot >= tensorType.getShape()[0])
+        return;
+      intervals.push_back(
+          Interval<size_t>(slot * slotSize, (slot + 1) * slotSize));
+    }
+    aliasSlots[{value, buffer->id}] = std::move(intervals);
   }
 
 private:
   Operation *operation = nullptr;
+  AllocationStrategy strategy = AllocationStrategy::Heuristic;
   OpScratchMapT opScratch;
   OpScratchMapT opVirtual;
   ValueBufferMapT valueBuffer;
   AliasBufferMapT aliasBuffer;
+  AliasSlotMapT aliasSlots;
   BufferSetT bufferSet;
   size_t sharedMemorySize = 0;
+  size_t sharedMemoryLowerBound = 0;
 
   friend class triton::AllocationAnalysis;
 };
@@ -207,14 +289,16 @@ class ModuleAllocation : public CallGraph<Allocation> {
 public:
   using FuncOffsetMapT = DenseMap<FunctionOpInterface, Value>;
 
-  explicit ModuleAllocation(ModuleOp moduleOp)
+  explicit ModuleAllocation(
+      ModuleOp moduleOp,
+      AllocationStrategy strategy = getDefaultAllocationStrategy())
       : CallGraph<Allocation>(moduleOp) {
     walk<WalkOrder::PreOrder, WalkOrder::PostOrder>(
         // Pre-order edge walk callback
         [](CallOpInterface callOp, FunctionOpInterface funcOp) {},
         // Post-order node walk callback
         [&](FunctionOpInterface funcOp) {
-          auto [iter, inserted] = funcMap.try_emplace(funcOp, funcOp);
+          auto [iter, inserted] = funcMap.try_emplace(funcOp, funcOp, strategy);
           if (inserted)
             iter->second.run(funcMap);
         });
@@ -229,6 +313,24 @@ public:
     return size;
   }
 
+  size_t getSharedMemoryLowerBound() {
+    size_t size = 0;
+    for (auto funcOp : getRoots()) {
+      auto *alloc = getFuncData(funcOp);
+      size = std::max(size, alloc->getSharedMemoryLowerBound());
+    }
+    return size;
+  }
+
+  size_t getSharedMemoryAlignment() {
+    size_t alignment = 1;
+    for (auto funcOp : getRoots()) {
+      auto *alloc = getFuncData(funcOp);
+      alignment = std::max(alignment, alloc->getSharedMemoryAlignment());
+    }
+    return alignment;
+  }
+
   size_t getSharedMemorySize(FunctionOpInterface funcOp) {
     return getFuncData(funcOp)->getSharedMemorySize();
   }
@@ -58,6 +58,12 @@ public:
   static void
   initPessimisticStateFromFunc(int argNumber, T funcOp, DimVectorT *contiguity,
                                DimVectorT *divisibility, DimVectorT *constancy);
+
+  /// Attaches this axis info to the `argNumber`-th argument of `funcOp`.
+  /// The tt.contiguity, tt.divisibility and tt.constancy attributes the
+  /// argument already has are replaced by their gcd with it.
+  void joinFuncArgAttrs(FunctionOpInterface funcOp, int argNumber) const;
+
   /// Comparison
   bool operator==(const AxisInfo &other) const {
     return (contiguity == other.contiguity) &&
@@ -297,8 +303,8 @@ public:
 /// do not have recursive functions.
 /// Since each function will be called multiple times, we need to
 /// calculate the axis info based on the axis info of all the callers.
-/// In the future, we can perform optimization using function cloning so that
-/// each call site will have unique axis info.
+/// The triton-specialize-calls pass clones the callees whose call sites
+/// disagree, so that each call site gets the axis info of its arguments.
 using AxisInfoMapT = DenseMap<Value, AxisInfo>;
 class ModuleAxisInfoAnalysis : public CallGraph<AxisInfoMapT> {
 public:
@@ -347,6 +353,27 @@ public:
 
   unsigned getMaskAlignment(Value mask);
 
+  /// Returns the number of elements of the block pointer `ptr`, along the
+  /// contiguous dimension of its `tt.make_tensor_ptr`, that can be accessed
+  /// with one aligned vector whose `boundaryCheck` mask is uniform.
+  unsigned
+  getTensorPtrAlignment(Value ptr,
+                        std::optional<ArrayRef<int32_t>> boundaryCheck = {});
+
+  /// Returns the vector size that a thread of `valueTy` can use to access
+  /// the block pointer `ptr`.
+  unsigned
+  getTensorPtrContiguity(Value ptr, RankedTensorType valueTy,
+                         std::optional<ArrayRef<int32_t>> boundaryCheck = {});
+
+  /// Returns the number of consecutive elements of a thread, along the
+  /// fastest dimension, that are known to have the same value.
+  unsigned getConstancyPerThread(Value value);
+
+  /// Returns whether all the elements of the tensor `value` are known to have
+  /// the same value.
+  bool isUniform(Value value);
+
 private:
   void initialize(FunctionOpInterface funcOp);
 
@@ -4,6 +4,7 @@
 #include "Allocation.h"
 #include "llvm/ADT/SmallPtrSet.h"
 
+#include <optional>
 #include <set>
 
 namespace mlir {
@@ -14,20 +15,71 @@ struct BlockInfo {
   using BufferIdSetT = Allocation::BufferIdSetT;
   using IntervalSetT = std::set<Interval<size_t>>;
 
+  /// Maximum number of commit groups tracked individually. Older groups are
+  /// moved to `overflowAsyncIntervals`.
+  static constexpr size_t kMaxAsyncGroups = 8;
+
   IntervalSetT syncReadIntervals;
   IntervalSetT syncWriteIntervals;
+  /// Intervals written by async copies that have not been committed yet.
+  IntervalSetT uncommittedAsyncIntervals;
+  /// Intervals written by each pending commit group, from the oldest to the
+  /// most recent one.
+  SmallVector<IntervalSetT> asyncGroupIntervals;
+  /// Intervals written by async copies whose commit group is unknown. Any
+  /// async wait may complete them.
+  IntervalSetT overflowAsyncIntervals;
 
   BlockInfo() = default;
 
-  /// Unions two BlockInfo objects.
+  /// Unions two BlockInfo objects. Pending commit groups are aligned on the
+  /// most recent one.
   BlockInfo &join(const BlockInfo &other) {
     syncReadIntervals.insert(other.syncReadIntervals.begin(),
                              other.syncReadIntervals.end());
     syncWriteIntervals.insert(other.syncWriteIntervals.begin(),
                               other.syncWriteIntervals.end());
+    uncommittedAsyncIntervals.insert(other.uncommittedAsyncIntervals.begin(),
+                                     other.uncommittedAsyncIntervals.end());
+    overflowAsyncIntervals.insert(other.overflowAsyncIntervals.begin(),
+                                  other.overflowAsyncIntervals.end());
+    size_t numGroups = other.asyncGroupIntervals.size();
+    if (numGroups > asyncGroupIntervals.size())
+      asyncGroupIntervals.insert(asyncGroupIntervals.begin(),
+                                 numGroups - asyncGroupIntervals.size(),
+                                 IntervalSetT());
+    size_t offset = asyncGroupIntervals.size() - numGroups;
+    for (size_t i = 0; i < numGroups; ++i)
+      asyncGroupIntervals[offset + i].insert(
+          other.asyncGroupIntervals[i].begin(),
+          other.asyncGroupIntervals[i].end());
     return *this;
   }
 
+  /// Closes the group of the uncommitted async copies.
+  void commitAsync() {
+    asyncGroupIntervals.push_back(std::move(uncommittedAsyncIntervals));
+    uncommittedAsyncIntervals.clear();
+    if (asyncGroupIntervals.size() > kMaxAsyncGroups) {
+      overflowAsyncIntervals.insert(asyncGroupIntervals.front().begin(),
+                                    asyncGroupIntervals.front().end());
+      asyncGroupIntervals.erase(asyncGroupIntervals.begin());
+    }
+  }
+
+  /// Waits until at most `numPending` commit groups are pending. The writes of
+  /// the completed groups become visible to the other warps after the next
+  /// barrier, so they are tracked as synchronous writes from now on.
+  void waitAsync(size_t numPending) {
+    syncWriteIntervals.insert(overflowAsyncIntervals.begin(),
+                              overflowAsyncIntervals.end());
+    while (asyncGroupIntervals.size() > numPending) {
+      syncWriteIntervals.insert(asyncGroupIntervals.front().begin(),
+                                asyncGroupIntervals.front().end());
+      asyncGroupIntervals.erase(asyncGroupIntervals.begin());
+    }
+  }
+
   /// Returns true if intervals in two BlockInfo objects are intersected.
   bool isIntersected(const BlockInfo &other) const {
     return /*RAW*/ isIntersected(syncWriteIntervals, other.syncReadIntervals) ||
@@ -46,7 +98,10 @@ struct BlockInfo {
   /// Compares two BlockInfo objects.
   bool operator==(const BlockInfo &other) const {
     return syncReadIntervals == other.syncReadIntervals &&
-           syncWriteIntervals == other.syncWriteIntervals;
+           syncWriteIntervals == other.syncWriteIntervals &&
+           uncommittedAsyncIntervals == other.uncommittedAsyncIntervals &&
+           asyncGroupIntervals == other.asyncGroupIntervals &&
+           overflowAsyncIntervals == other.overflowAsyncIntervals;
   }
 
   bool operator!=(const BlockInfo &other) const { return !(*this == other); }
@@ -81,6 +136,11 @@ public:
   /// a shared memory read. If the temporary storage is written but not read,
   /// it is considered as the problem of the operation itself but not the membar
   /// analysis.
+  /// Async copies (insert_slice_async) are tracked per commit group: the
+  /// writes of a group become visible when an async_wait completes it, so a
+  /// barrier is only inserted before the first access that conflicts with
+  /// them. Slices of multi-buffered tensors taken at a constant index only
+  /// cover their own slot of the buffer.
   MembarAnalysis() = default;
   explicit MembarAnalysis(Allocation *allocation) : allocation(allocation) {}
 
@@ -113,6 +173,14 @@ private:
   /// Collects the successors of the terminator
   void visitTerminator(Operation *operation, SmallVector<Block *> &successors);
 
+  /// Returns the intervals of the buffers accessed through `value`.
+  BlockInfo::IntervalSetT getIntervals(Value value) const;
+
+  /// Returns the intervals of the `index`-th slot along the leading dimension
+  /// of `buffer`, or all of its intervals if the slot is unknown.
+  BlockInfo::IntervalSetT getSlotIntervals(Value buffer,
+                                           std::optional<int64_t> index) const;
+
 private:
   Allocation *allocation = nullptr;
 };
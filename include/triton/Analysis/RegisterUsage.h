@@ -0,0 +1,28 @@
+#ifndef TRITON_ANALYSIS_REGISTERUSAGE_H
+#define TRITON_ANALYSIS_REGISTERUSAGE_H
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Interfaces/FunctionInterfaces.h"
+
+namespace mlir {
+
+/// Returns the 32-bit registers per thread that hold a value of `type`: the
+/// elements of a distributed tensor that the thread owns, packed by their bit
+/// width, or a scalar. A tensor in shared memory takes the register of its
+/// address.
+unsigned getNumRegisters(Type type);
+
+/// Estimates the registers per thread of `funcOp` from the TritonGPU
+/// encodings: the largest number of registers held by the values live at
+/// the same time. The estimate ignores the temporaries of the lowering, e.g.
+/// the addresses and masks of loads, and the registers that the code
+/// generator rematerializes, so it is a lower bound of the allocation of
+/// ptxas in most kernels.
+unsigned estimateRegisterUsage(FunctionOpInterface funcOp);
+
+/// Returns the largest estimate of the functions of `moduleOp`.
+unsigned estimateRegisterUsage(ModuleOp moduleOp);
+
+} // namespace mlir
+
+#endif // TRITON_ANALYSIS_REGISTERUSAGE_H
@@ -6,6 +6,7 @@
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include <algorithm>
 #include <numeric>
+#include <optional>
 #include <string>
 
 namespace mlir {
@@ -41,6 +42,10 @@ public:
 
   unsigned getThreadsReductionAxis();
 
+  // Returns true when each warp reduces its data alone, so that the
+  // reduction needs no exchange through shared memory.
+  bool isWarpSynchronous();
+
   SmallVector<unsigned> getScratchConfigBasic();
 
   SmallVector<SmallVector<unsigned>> getScratchConfigsFast();
@@ -57,6 +62,72 @@ private:
   int axis;
 };
 
+class ScanLoweringHelper {
+public:
+  explicit ScanLoweringHelper(triton::ScanOp op) : scanOp(op) {
+    auto type = scanOp.getOperands()[0].getType().cast<RankedTensorType>();
+    srcShape = type.getShape();
+    srcEncoding = type.getEncoding();
+  }
+  // Return true if the lowering of the scan op is supported.
+  bool isSupported();
+  // Return the number of contiguous elements owned by a thread along the axis.
+  unsigned getAxisNumElementsPerThread();
+  // Return the number of threads per warp holding unique data along the axis.
+  unsigned getAxisNumThreadsPerWarp();
+  // Return the number of warps holding unique data along the axis.
+  unsigned getAxisNumWarps();
+  // Return the number of times the CTA tile is repeated along the axis.
+  unsigned getAxisNumBlocks();
+  // Return the shape of the scratch buffer holding the per-warp partial
+  // results.
+  SmallVector<unsigned> getScratchConfig();
+  // Return the size of the scratch shared memory needed for the scan.
+  unsigned getScratchSizeInBytes();
+
+  ArrayRef<int64_t> getSrcShape() { return srcShape; }
+  Attribute getEncoding() { return srcEncoding; }
+  unsigned getAxis() { return scanOp.getAxis(); }
+
+private:
+  triton::ScanOp scanOp;
+  ArrayRef<int64_t> srcShape;
+  Attribute srcEncoding;
+};
+
+class SortLoweringHelper {
+public:
+  // `op` is a triton::SortOp or a triton::TopKOp.
+  explicit SortLoweringHelper(Operation *op) : op(op) {
+    auto type = op->getOperand(0).getType().cast<RankedTensorType>();
+    srcShape = type.getShape();
+    srcEncoding = type.getEncoding();
+    axis = op->getAttrOfType<IntegerAttr>("axis").getInt();
+  }
+  // Return the number of elements along the axis sorted within each thread.
+  unsigned getAxisNumElementsPerThread();
+  // Return the number of elements along the axis sorted within each warp,
+  // the lanes exchanging elements with shuffles.
+  unsigned getAxisNumElementsPerWarp();
+  // Return true if elements are exchanged through shared memory, across warps
+  // or to gather the results of a top-k.
+  bool needsSharedMemory();
+  // Return the shape of the scratch buffer holding the exchanged elements.
+  SmallVector<unsigned> getScratchConfig();
+  // Return the size of the scratch shared memory needed for the sort.
+  unsigned getScratchSizeInBytes();
+
+  ArrayRef<int64_t> getSrcShape() { return srcShape; }
+  Attribute getEncoding() { return srcEncoding; }
+  unsigned getAxis() { return axis; }
+
+private:
+  Operation *op;
+  ArrayRef<int64_t> srcShape;
+  Attribute srcEncoding;
+  unsigned axis;
+};
+
 bool isSharedEncoding(Value value);
 
 bool maybeSharedAllocationOp(Operation *op);
@@ -67,6 +138,20 @@ bool supportMMA(triton::DotOp op, int version);
 
 bool supportMMA(Value value, int version);
 
+/// Returns the conversion that loads $b of a Hopper dot from shared memory
+/// when wgmma can read the operand in place, or nullptr if the dot has to
+/// load it into registers for mma.sync.
+triton::gpu::ConvertLayoutOp getWGMMAOperandB(triton::DotOp op);
+
+/// Returns the `tt.make_tensor_ptr` that defines the block pointer `ptr`,
+/// looking through `tt.advance`, the iteration arguments of `scf.for` and
+/// the arguments of branch targets, or nullptr if `ptr` can come from several
+/// of them. The advances on the way
+/// are appended to `advances` when it is given.
+triton::MakeTensorPtrOp
+getMakeTensorPtrOp(Value ptr,
+                   SmallVectorImpl<triton::AdvanceOp> *advances = nullptr);
+
 Type getElementType(Value value);
 
 std::string getValueOperandName(Value value, AsmState &state);
@@ -106,8 +191,29 @@ template <typename T> T highestPowOf2Divisor(T n) {
 
 bool isSingleValue(Value value);
 
+/// A signed range [min, max] of integers.
+using IntegerRange = std::pair<int64_t, int64_t>;
+
+/// Returns the range the integer `value`, or each element of the integer
+/// tensor `value`, is known to be in. The ranges start from constants,
+/// tt.make_range, tt.get_program_id and the induction variables of scf.for
+/// loops, and go through the arith ops that cannot overflow the type of
+/// their result.
+std::optional<IntegerRange> getIntegerRange(Value value);
+
 bool isMmaToDotShortcut(RankedTensorType &srcTy, RankedTensorType &dstTy);
 
+/// Returns, for each register of the result of a conversion from `srcTy` to
+/// `dstTy`, the register of the operand it is read from, if the conversion
+/// only moves data between the lanes of each warp and every result register
+/// is read from the same operand register of all the lanes. Such conversions
+/// are lowered to one warp shuffle per register, without shared memory.
+/// Returns std::nullopt otherwise. Only blocked layouts are supported.
+std::optional<SmallVector<unsigned>>
+getWarpLocalCvtSrcRegs(RankedTensorType srcTy, RankedTensorType dstTy);
+
+bool isWarpLocalCvtLayout(RankedTensorType srcTy, RankedTensorType dstTy);
+
 /// Multi-root DAG topological sort.
 /// Performs a topological sort of the Operation in the `toSort` SetVector.
 /// Returns a topologically sorted SetVector.
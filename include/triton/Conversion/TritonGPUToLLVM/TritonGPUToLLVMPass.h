@@ -4,6 +4,7 @@
 #include "mlir/Conversion/LLVMCommon/TypeConverter.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include <memory>
+#include <string>
 
 namespace mlir {
 
@@ -12,9 +13,21 @@ template <typename T> class OperationPass;
 
 namespace triton {
 
+class PrintOp;
+
 std::unique_ptr<OperationPass<ModuleOp>>
 createConvertTritonGPUToLLVMPass(int computeCapability = 80,
-                                 bool isROCM = false);
+                                 bool isROCM = false, bool fastMath = false);
+
+// In the modules with a triton_gpu.print-buffer attribute, tt.print appends a
+// binary record per thread to the print buffer instead of calling vprintf.
+// Returns the format the host decodes the records of `op` with: the kind and
+// number of the values of each operand held by a thread, then the prefix,
+// e.g. "f32x4,i64x1| x: ".
+std::string getPrintRecordFormat(PrintOp op);
+
+// Returns the id of the records of `format`, their first word
+uint32_t getPrintRecordId(StringRef format);
 
 } // namespace triton
 
@@ -11,13 +11,16 @@ template <typename T> class OperationPass;
 namespace triton {
 
 constexpr static char AttrNumWarpsName[] = "triton_gpu.num-warps";
+constexpr static char AttrNumThreadsPerWarp[] = "triton_gpu.threads-per-warp";
 
 // Create the pass with numWarps passed from cl::opt.
 std::unique_ptr<OperationPass<ModuleOp>> createConvertTritonToTritonGPUPass();
 
-// Create the pass with numWarps set explicitly.
+// Create the pass with numWarps and threadsPerWarp set explicitly. With
+// autoNumWarps, numWarps bounds the warps of the modules of small tensors.
 std::unique_ptr<OperationPass<ModuleOp>>
-createConvertTritonToTritonGPUPass(int numWarps);
+createConvertTritonToTritonGPUPass(int numWarps, int threadsPerWarp = 32,
+                                   bool autoNumWarps = false);
 
 } // namespace triton
 } // namespace mlir
@@ -12,8 +12,15 @@ namespace mlir {
 
 namespace triton {
 
+// The address space of the pointers to the parameter tables of a kernel,
+// which are passed by value in the parameters of the launch
+constexpr unsigned kParamAddressSpace = 101;
+
 bool isTensorPointerType(Type type);
 
+// Whether the pointer, or tensor of pointers, points into a parameter table
+bool isParamPointerType(Type type);
+
 unsigned getPointeeBitWidth(Type type);
 
 Type getPointeeType(Type type);
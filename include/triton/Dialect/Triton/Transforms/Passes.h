@@ -11,6 +11,12 @@ std::unique_ptr<Pass> createCombineOpsPass();
 std::unique_ptr<Pass>
 createRewriteTensorPointerPass(int computeCapability = 80);
 
+std::unique_ptr<Pass> createSpecializeCallsPass(unsigned maxClones = 4);
+
+std::unique_ptr<Pass> createMarkStreamingStoresPass();
+
+std::unique_ptr<Pass> createRebaseLoopPointersPass();
+
 } // namespace triton
 
 #define GEN_PASS_REGISTRATION
@@ -11,20 +11,26 @@ createTritonGPUAccelerateMatmulPass(int computeCapability = 80);
 
 std::unique_ptr<Pass> createTritonGPUPrefetchPass();
 
+std::unique_ptr<Pass> createTritonGPULoopUnrollPass();
+
 std::unique_ptr<Pass> createTritonGPUCanonicalizeLoopsPass();
 
 std::unique_ptr<Pass> createTritonGPUCoalescePass();
 
-std::unique_ptr<Pass> createTritonGPUReorderInstructionsPass();
+std::unique_ptr<Pass>
+createTritonGPUReorderInstructionsPass(int regBudget = 0);
 
 std::unique_ptr<Pass> createTritonGPUDecomposeConversionsPass();
 
-std::unique_ptr<Pass> createTritonGPURemoveLayoutConversionsPass();
+std::unique_ptr<Pass>
+createTritonGPURemoveLayoutConversionsPass(bool costModel = false);
 
 std::unique_ptr<Pass> createTritonGPUVerifier();
 
 std::unique_ptr<Pass> createTritonGPUOptimizeDotOperandsPass();
 
+std::unique_ptr<Pass> createTritonGPUPerfLintPass(int numStages = 2);
+
 /// Generate the code for registering passes.
 #define GEN_PASS_REGISTRATION
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
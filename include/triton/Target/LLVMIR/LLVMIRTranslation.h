@@ -22,16 +22,18 @@ void addExternalLibs(mlir::ModuleOp &module,
                      const std::vector<std::string> &names,
                      const std::vector<std::string> &paths);
 
-// Translate TritonGPU dialect to LLVMIR, return null if failed.
+// Translate TritonGPU dialect to LLVMIR, return null if failed. The LLVM IR is
+// optimized at `optLevel` (0-3).
 std::unique_ptr<llvm::Module>
 translateTritonGPUToLLVMIR(llvm::LLVMContext *llvmContext,
                            mlir::ModuleOp module, int computeCapability,
-                           bool isROCM);
+                           bool isROCM, bool fastMath = false,
+                           int optLevel = 3);
 
 // Translate mlir LLVM dialect to LLVMIR, return null if failed.
 std::unique_ptr<llvm::Module>
 translateLLVMToLLVMIR(llvm::LLVMContext *llvmContext, mlir::ModuleOp module,
-                      bool isROCM);
+                      bool isROCM, int optLevel = 3);
 
 } // namespace triton
 } // namespace mlir
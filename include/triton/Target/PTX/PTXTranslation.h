@@ -9,8 +9,13 @@ class Module;
 
 namespace triton {
 
-// Translate TritonGPU IR to PTX code.
-std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version);
+// Translate TritonGPU IR to PTX code. The code generator optimizes at
+// `optLevel` (0-3). A positive `maxNReg` bounds the registers per thread of
+// the kernels and a positive `minBlocksPerSM` asks ptxas to fit that many
+// blocks on a multiprocessor.
+std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version,
+                                 int optLevel = 3, int maxNReg = 0,
+                                 int minBlocksPerSM = 0);
 
 } // namespace triton
 
@@ -1,5 +1,6 @@
 #include "triton/Analysis/Alias.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 
@@ -8,16 +9,34 @@ namespace mlir {
 AliasInfo AliasInfo::join(const AliasInfo &lhs, const AliasInfo &rhs) {
   if (lhs == rhs)
     return lhs;
-  AliasInfo ret;
-  for (auto value : lhs.allocs) {
-    ret.insert(value);
-  }
+  AliasInfo ret = lhs;
   for (auto value : rhs.allocs) {
-    ret.insert(value);
+    if (auto slots = rhs.getSlots(value)) {
+      for (auto slot : *slots)
+        ret.insert(value, slot);
+    } else {
+      ret.insert(value);
+    }
   }
   return ret;
 }
 
+std::optional<int64_t> getSlotIndex(ArrayRef<OpFoldResult> offsets,
+                                    ArrayRef<OpFoldResult> sizes,
+                                    ArrayRef<OpFoldResult> strides,
+                                    ArrayRef<int64_t> shape) {
+  if (offsets.size() != shape.size() || getConstantIntValue(sizes[0]) != 1)
+    return std::nullopt;
+  for (unsigned i = 0; i < shape.size(); ++i) {
+    if (getConstantIntValue(strides[i]) != 1)
+      return std::nullopt;
+    if (i > 0 && (getConstantIntValue(offsets[i]) != 0 ||
+                  getConstantIntValue(sizes[i]) != shape[i]))
+      return std::nullopt;
+  }
+  return getConstantIntValue(offsets[0]);
+}
+
 void SharedMemoryAliasAnalysis::visitOperation(
     Operation *op, ArrayRef<const dataflow::Lattice<AliasInfo> *> operands,
     ArrayRef<dataflow::Lattice<AliasInfo> *> results) {
@@ -27,8 +46,32 @@ void SharedMemoryAliasAnalysis::visitOperation(
     // These ops may allocate a new shared memory buffer.
     auto result = op->getResult(0);
     // XXX(Keren): the following ops are always aliasing for now
-    if (isa<triton::gpu::ExtractSliceOp, triton::TransOp>(op)) {
+    if (auto extractOp = dyn_cast<triton::gpu::ExtractSliceOp>(op)) {
       // extract_slice %src
+      // A slice at a constant slot of a whole allocation only aliases that
+      // slot
+      auto srcType = extractOp.getSource().getType();
+      auto slot = getSlotIndex(
+          extractOp.getMixedOffsets(), extractOp.getMixedSizes(),
+          extractOp.getMixedStrides(),
+          srcType.cast<RankedTensorType>().getShape());
+      const AliasInfo &srcInfo = operands[0]->getValue();
+      aliasInfo = srcInfo;
+      if (slot) {
+        aliasInfo = AliasInfo();
+        for (auto alloc : srcInfo.getAllocs()) {
+          if (auto slots = srcInfo.getSlots(alloc)) {
+            for (auto allocSlot : *slots)
+              aliasInfo.insert(alloc, allocSlot);
+          } else if (alloc.getType() == srcType) {
+            aliasInfo.insert(alloc, *slot);
+          } else {
+            aliasInfo.insert(alloc);
+          }
+        }
+      }
+      pessimistic = false;
+    } else if (isa<triton::TransOp>(op)) {
       // trans %src
       aliasInfo = AliasInfo(operands[0]->getValue());
       pessimistic = false;
@@ -6,11 +6,13 @@
 #include "triton/Analysis/Alias.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Tools/Sys/GetEnv.hpp"
 #include "llvm/ADT/SmallVector.h"
 
 #include <algorithm>
 #include <limits>
 #include <numeric>
+#include <optional>
 
 using ::mlir::triton::gpu::BlockedEncodingAttr;
 using ::mlir::triton::gpu::DotOperandEncodingAttr;
@@ -50,9 +52,24 @@ getCvtOrder(Attribute srcLayout, Attribute dstLayout) {
   return {inOrd, outOrd};
 }
 
+// Layouts whose conversions can use a swizzled scratch buffer
+static bool isSwizzlableCvtLayout(Attribute layout) {
+  if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>())
+    return mmaLayout.isAmpere() || mmaLayout.isHopper();
+  return layout.isa<BlockedEncodingAttr>();
+}
+
 SmallVector<unsigned>
 getScratchConfigForCvtLayout(triton::gpu::ConvertLayoutOp op, unsigned &inVec,
                              unsigned &outVec) {
+  unsigned swizzleVec = 0;
+  return getScratchConfigForCvtLayout(op, inVec, outVec, swizzleVec);
+}
+
+SmallVector<unsigned>
+getScratchConfigForCvtLayout(triton::gpu::ConvertLayoutOp op, unsigned &inVec,
+                             unsigned &outVec, unsigned &swizzleVec) {
+  swizzleVec = 0;
   auto srcTy = op.getSrc().getType().cast<RankedTensorType>();
   auto dstTy = op.getResult().getType().cast<RankedTensorType>();
   Attribute srcLayout = srcTy.getEncoding();
@@ -64,6 +81,10 @@ getScratchConfigForCvtLayout(triton::gpu::ConvertLayoutOp op, unsigned &inVec,
     if (isMmaToDotShortcut(srcTy, dstTy))
       return {};
 
+  // Warp-local conversions are lowered to warp shuffles
+  if (isWarpLocalCvtLayout(srcTy, dstTy))
+    return {};
+
   assert(srcLayout && dstLayout &&
          "Unexpected layout in getScratchConfigForCvtLayout()");
   auto [inOrd, outOrd] = getCvtOrder(srcLayout, dstLayout);
@@ -89,6 +110,26 @@ getScratchConfigForCvtLayout(triton::gpu::ConvertLayoutOp op, unsigned &inVec,
   }
   if (rank == 1)
     return paddedRepShape;
+  if (rank == 2 && isSwizzlableCvtLayout(srcLayout) &&
+      isSwizzlableCvtLayout(dstLayout) &&
+      ::triton::tools::getBoolEnv("TRITON_SWIZZLE_CVT_LAYOUT")) {
+    // Vectors of at most 128 bits on both sides
+    auto elemTy = srcTy.getElementType();
+    unsigned bitWidth = elemTy.isa<triton::PointerType>()
+                            ? kPtrBitWidth
+                            : std::max<int>(8, elemTy.getIntOrFloatBitWidth());
+    unsigned maxVec = std::max(1u, 128 / bitWidth);
+    unsigned vec = std::max(std::min(inVec, maxVec), std::min(outVec, maxVec));
+    bool canSwizzle = llvm::all_of(paddedRepShape, [&](unsigned dim) {
+      return dim % vec == 0 && llvm::isPowerOf2_32(dim / vec);
+    });
+    if (canSwizzle) {
+      inVec = std::min(inVec, maxVec);
+      outVec = std::min(outVec, maxVec);
+      swizzleVec = vec;
+      return paddedRepShape;
+    }
+  }
   unsigned paddedDim = 1;
   if (auto dstBlockedLayout = dstLayout.dyn_cast<BlockedEncodingAttr>()) {
     paddedDim = dstBlockedLayout.getOrder()[0];
@@ -131,6 +172,8 @@ private:
   /// Value -> Liveness Range
   /// Use MapVector to ensure determinism.
   using BufferRangeMapT = llvm::MapVector<BufferT *, Interval<size_t>>;
+  /// Value -> Sorted disjoint pieces of the liveness range
+  using BufferPiecesMapT = DenseMap<BufferT *, SmallVector<Interval<size_t>>>;
   /// Nodes -> Nodes
   using GraphT = DenseMap<BufferT *, DenseSet<BufferT *>>;
 
@@ -158,17 +201,36 @@ private:
         auto tensorType = result.getType().dyn_cast<RankedTensorType>();
         auto bytes = tensorType.getNumElements() *
                      tensorType.getElementTypeBitWidth() / 8;
-        allocation->addBuffer<BufferT::BufferKind::Explicit>(result, bytes);
+        allocation->addBuffer<BufferT::BufferKind::Explicit>(
+            result, bytes, getExplicitValueAlignment(tensorType));
       }
     }
   }
 
+  /// wgmma computes the swizzling of its shared memory operands from the
+  /// address bits, so with Hopper dots the swizzled buffers start on a
+  /// multiple of their swizzle pattern: maxPhase rows of 128 bytes.
+  size_t getExplicitValueAlignment(RankedTensorType tensorType) {
+    auto sharedLayout = tensorType.getEncoding().cast<SharedEncodingAttr>();
+    if (!hasHopperDot || sharedLayout.getMaxPhase() == 1)
+      return 1;
+    return 128 * sharedLayout.getMaxPhase();
+  }
+
   /// Initializes temporary shared memory for a given operation.
   void getScratchValueSize(Operation *op) {
     if (auto reduceOp = dyn_cast<triton::ReduceOp>(op)) {
       ReduceOpHelper helper(reduceOp);
       unsigned bytes = helper.getScratchSizeInBytes();
       allocation->addBuffer<BufferT::BufferKind::Scratch>(op, bytes);
+    } else if (auto scanOp = dyn_cast<triton::ScanOp>(op)) {
+      ScanLoweringHelper helper(scanOp);
+      unsigned bytes = helper.getScratchSizeInBytes();
+      allocation->addBuffer<BufferT::BufferKind::Scratch>(op, bytes);
+    } else if (isa<triton::SortOp, triton::TopKOp>(op)) {
+      SortLoweringHelper helper(op);
+      unsigned bytes = helper.getScratchSizeInBytes();
+      allocation->addBuffer<BufferT::BufferKind::Scratch>(op, bytes);
     } else if (auto cvtLayout = dyn_cast<triton::gpu::ConvertLayoutOp>(op)) {
       auto srcTy = cvtLayout.getSrc().getType().cast<RankedTensorType>();
       auto dstTy = cvtLayout.getResult().getType().cast<RankedTensorType>();
@@ -179,10 +241,11 @@ private:
         // Conversions from/to shared memory do not need scratch memory.
         return;
       }
+      if (isWarpLocalCvtLayout(srcTy, dstTy)) {
+        // Conversions within warps are done with warp shuffles.
+        return;
+      }
       // ConvertLayoutOp with both input/output non-shared_layout
-      // TODO: Besides of implementing ConvertLayoutOp via shared memory, it's
-      //       also possible to realize it with other approaches in restricted
-      //       conditions, such as warp-shuffle
       unsigned inVec = 0;
       unsigned outVec = 0;
       auto smemShape = getScratchConfigForCvtLayout(cvtLayout, inVec, outVec);
@@ -195,9 +258,10 @@ private:
       allocation->addBuffer<BufferT::BufferKind::Scratch>(op, bytes);
     } else if (auto atomicRMWOp = dyn_cast<triton::AtomicRMWOp>(op)) {
       auto value = op->getOperand(0);
-      // only scalar requires scratch memory
+      // only scalar requires scratch memory, to broadcast the old value
       // make it explicit for readability
-      if (value.getType().dyn_cast<RankedTensorType>()) {
+      if (value.getType().dyn_cast<RankedTensorType>() ||
+          atomicRMWOp.getResult().use_empty()) {
         // nothing to do
       } else {
         auto smemShape = getScratchConfigForAtomicRMW(atomicRMWOp);
@@ -222,12 +286,18 @@ private:
                        ? elems * kPtrBitWidth / 8
                        : elems * elemTy.getIntOrFloatBitWidth() / 8;
       allocation->addBuffer<BufferT::BufferKind::Scratch>(op, bytes);
+    } else if (auto histogramOp = dyn_cast<triton::HistogramOp>(op)) {
+      // The bins of the CTA are counted in shared memory
+      auto dstTy = histogramOp.getResult().getType().cast<RankedTensorType>();
+      auto bytes = dstTy.getNumElements() * dstTy.getElementTypeBitWidth() / 8;
+      allocation->addBuffer<BufferT::BufferKind::Scratch>(op, bytes);
     } else if (auto callOp = dyn_cast<CallOpInterface>(op)) {
       auto callable = callOp.resolveCallable();
       auto funcOp = dyn_cast<FunctionOpInterface>(callable);
       auto *funcAlloc = &(*funcAllocMap)[funcOp];
       auto bytes = funcAlloc->getSharedMemorySize();
-      allocation->addBuffer<BufferT::BufferKind::Virtual>(op, bytes);
+      allocation->addBuffer<BufferT::BufferKind::Virtual>(
+          op, bytes, funcAlloc->getSharedMemoryAlignment());
     }
   }
 
@@ -238,7 +308,7 @@ private:
       AliasInfo &info = latticeElement->getValue();
       if (!info.getAllocs().empty()) {
         for (auto alloc : info.getAllocs()) {
-          allocation->addAlias(value, alloc);
+          allocation->addAlias(value, alloc, info.getSlots(alloc));
         }
       }
     }
@@ -246,6 +316,13 @@ private:
 
   /// Extract all shared memory values and their sizes
   void getValuesAndSizes() {
+    operation->walk([&](triton::DotOp dotOp) {
+      auto mmaLayout = dotOp.getType()
+                           .cast<RankedTensorType>()
+                           .getEncoding()
+                           .dyn_cast<MmaEncodingAttr>();
+      hasHopperDot |= mmaLayout && mmaLayout.isHopper();
+    });
     // Get the alloc values
     operation->walk<WalkOrder::PreOrder>([&](Operation *op) {
       getExplicitValueSize(op);
@@ -269,6 +346,52 @@ private:
     });
   }
 
+  /// Adds the liveness range of a value held by `buffer`. The ranges of the
+  /// values are kept apart when they don't overlap: the contents of the
+  /// buffer are dead in between, e.g. in the other branch of an scf.if, so
+  /// other buffers may reuse it there.
+  void addLiveRange(BufferT *buffer, Interval<size_t> range) {
+    auto &pieces = bufferPieces[buffer];
+    auto it = llvm::lower_bound(pieces, range);
+    it = pieces.insert(it, range);
+    // Merge the overlapping and adjacent pieces
+    SmallVector<Interval<size_t>> merged;
+    for (auto piece : pieces) {
+      if (!merged.empty() && piece.start() <= merged.back().end())
+        merged.back() =
+            Interval(merged.back().start(),
+                     std::max(merged.back().end(), piece.end()));
+      else
+        merged.push_back(piece);
+    }
+    pieces = std::move(merged);
+    bufferRange[buffer] = Interval(pieces.front().start(), pieces.back().end());
+  }
+
+  /// Returns true if `x` and `y` are live at the same time.
+  bool isLiveTogether(BufferT *x, BufferT *y) const {
+    auto &xPieces = bufferPieces.find(x)->second;
+    auto &yPieces = bufferPieces.find(y)->second;
+    auto xIt = xPieces.begin();
+    auto yIt = yPieces.begin();
+    while (xIt != xPieces.end() && yIt != yPieces.end()) {
+      if (xIt->intersects(*yIt))
+        return true;
+      if (xIt->end() <= yIt->end())
+        ++xIt;
+      else
+        ++yIt;
+    }
+    return false;
+  }
+
+  /// Returns true if `buffer` is live at operation `point`.
+  bool isLiveAt(BufferT *buffer, size_t point) const {
+    return llvm::any_of(
+        bufferPieces.find(buffer)->second,
+        [&](const Interval<size_t> &piece) { return piece.contains(point); });
+  }
+
   /// Computes the liveness range of the allocated value.
   /// Each buffer is allocated only once.
   void resolveExplicitBufferLiveness(
@@ -276,7 +399,7 @@ private:
     for (auto valueBufferIter : allocation->valueBuffer) {
       auto value = valueBufferIter.first;
       auto *buffer = valueBufferIter.second;
-      bufferRange[buffer] = getLiveness(value);
+      addLiveRange(buffer, getLiveness(value));
     }
   }
 
@@ -289,16 +412,8 @@ private:
       auto value = aliasBufferIter.first;
       auto buffers = aliasBufferIter.second;
       auto range = getLiveness(value);
-      for (auto *buffer : buffers) {
-        auto minId = range.start();
-        auto maxId = range.end();
-        if (bufferRange.count(buffer)) {
-          // Extend the allocated buffer's range
-          minId = std::min(minId, bufferRange[buffer].start());
-          maxId = std::max(maxId, bufferRange[buffer].end());
-        }
-        bufferRange[buffer] = Interval(minId, maxId);
-      }
+      for (auto *buffer : buffers)
+        addLiveRange(buffer, range);
     }
   }
 
@@ -314,8 +429,8 @@ private:
         // range.
         auto *op = opScratchIter.first;
         auto *buffer = opScratchIter.second;
-        bufferRange.insert({buffer, Interval(operationId.lookup(op),
-                                             operationId.lookup(op) + 1)});
+        addLiveRange(buffer, Interval(operationId.lookup(op),
+                                      operationId.lookup(op) + 1));
       }
     };
     processScratchMemory(allocation->opScratch);
@@ -376,6 +491,8 @@ private:
       buffers.emplace_back(bufferIter.first);
     }
 
+    computeLowerBound(buffers);
+
     DenseMap<BufferT *, size_t> bufferStart;
     calculateStarts(buffers, bufferStart);
 
@@ -383,6 +500,35 @@ private:
     buildInterferenceGraph(buffers, bufferStart, interference);
 
     allocate(buffers, bufferStart, interference);
+
+    // The heuristic ignores the alignment of the buffers, the best-fit
+    // packing does not. The heuristic also places the buffers along the hull
+    // of their liveness ranges, so it can't reuse the holes of split ranges.
+    bool isAligned = llvm::all_of(
+        buffers, [](BufferT *x) { return x->offset % x->alignment == 0; });
+    bool isSplit = llvm::any_of(
+        buffers, [&](BufferT *x) { return bufferPieces[x].size() > 1; });
+    if (allocation->strategy == AllocationStrategy::BestFit || !isAligned ||
+        isSplit)
+      refineBestFit(buffers, /*force=*/!isAligned);
+  }
+
+  /// Computes the largest total size of the buffers that are live at the same
+  /// time. No allocation can use less shared memory than this.
+  void computeLowerBound(const SmallVector<BufferT *> &buffers) {
+    // The set of live buffers only grows at the start of a live range, so
+    // probing these points is enough.
+    for (auto x : buffers) {
+      for (auto piece : bufferPieces.lookup(x)) {
+        size_t liveSize = 0;
+        for (auto y : buffers) {
+          if (isLiveAt(y, piece.start()))
+            liveSize += y->size;
+        }
+        allocation->sharedMemoryLowerBound =
+            std::max(allocation->sharedMemoryLowerBound, liveSize);
+      }
+    }
   }
 
   /// Computes the initial shared memory offsets.
@@ -458,10 +604,7 @@ private:
         auto ySize = y->size;
         Interval xSizeRange = {xStart, xStart + xSize};
         Interval ySizeRange = {yStart, yStart + ySize};
-        auto xOpRange = bufferRange.lookup(x);
-        auto yOpRange = bufferRange.lookup(y);
-        if (xOpRange.intersects(yOpRange) &&
-            xSizeRange.intersects(ySizeRange)) {
+        if (isLiveTogether(x, y) && xSizeRange.intersects(ySizeRange)) {
           interference[x].insert(y);
         }
       }
@@ -510,15 +653,117 @@ private:
     }
   }
 
+  /// Maximum number of buffers for which every placement order is searched.
+  static constexpr size_t kMaxExhaustiveBuffers = 7;
+
+  /// Places the buffers one by one in the given order. Each buffer goes to the
+  /// smallest free gap that fits it among the buffers that are already placed
+  /// and live at the same time, or on top of them if there is no such gap.
+  /// Gaps start at the first offset aligned for the buffer.
+  /// Returns the total size, or std::nullopt as soon as it exceeds `limit`.
+  std::optional<size_t> bestFit(ArrayRef<BufferT *> order, size_t limit,
+                                DenseMap<BufferT *, size_t> &offsets) {
+    offsets.clear();
+    size_t totalSize = 0;
+    SmallVector<Interval<size_t>> busy;
+    for (auto x : order) {
+      busy.clear();
+      for (auto &[y, yOffset] : offsets) {
+        if (isLiveTogether(x, y))
+          busy.push_back({yOffset, yOffset + y->size});
+      }
+      llvm::sort(busy);
+      size_t bestOffset = std::numeric_limits<size_t>::max();
+      size_t bestGap = std::numeric_limits<size_t>::max();
+      size_t cursor = 0;
+      for (auto &interval : busy) {
+        auto start = llvm::alignTo(cursor, x->alignment);
+        if (interval.start() > start) {
+          auto gap = interval.start() - start;
+          if (gap >= x->size && gap < bestGap) {
+            bestGap = gap;
+            bestOffset = start;
+          }
+        }
+        cursor = std::max(cursor, interval.end());
+      }
+      if (bestOffset == std::numeric_limits<size_t>::max())
+        bestOffset = llvm::alignTo(cursor, x->alignment);
+      offsets[x] = bestOffset;
+      totalSize = std::max(totalSize, bestOffset + x->size);
+      if (totalSize > limit)
+        return std::nullopt;
+    }
+    return totalSize;
+  }
+
+  /// Replaces the offsets computed by the heuristic with a best-fit packing
+  /// whenever the latter uses strictly less shared memory, or always if
+  /// `force` is set.
+  void refineBestFit(const SmallVector<BufferT *> &buffers, bool force) {
+    auto lowerBound = allocation->sharedMemoryLowerBound;
+    auto bestSize = force ? std::numeric_limits<size_t>::max()
+                          : allocation->sharedMemorySize;
+    if (bestSize <= lowerBound)
+      return;
+
+    DenseMap<BufferT *, size_t> offsets;
+    DenseMap<BufferT *, size_t> bestOffsets;
+    auto tryOrder = [&](ArrayRef<BufferT *> order) {
+      if (auto size = bestFit(order, bestSize - 1, offsets)) {
+        bestSize = *size;
+        bestOffsets = offsets;
+      }
+    };
+
+    // Largest buffers first, ties broken by the start of the live range.
+    SmallVector<BufferT *> order = buffers;
+    llvm::stable_sort(order, [&](BufferT *x, BufferT *y) {
+      if (x->size != y->size)
+        return x->size > y->size;
+      return bufferRange.lookup(x).start() < bufferRange.lookup(y).start();
+    });
+    tryOrder(order);
+
+    // Branch and bound over all the placement orders of small functions:
+    // an order is abandoned as soon as it exceeds the best size found so far,
+    // and the search stops once the lower bound is reached.
+    if (buffers.size() <= kMaxExhaustiveBuffers) {
+      SmallVector<unsigned> perm(buffers.size());
+      std::iota(perm.begin(), perm.end(), 0);
+      do {
+        for (unsigned i = 0; i < perm.size(); ++i)
+          order[i] = buffers[perm[i]];
+        tryOrder(order);
+      } while (bestSize > lowerBound &&
+               std::next_permutation(perm.begin(), perm.end()));
+    }
+
+    if (bestOffsets.empty())
+      return;
+    for (auto x : buffers)
+      x->offset = bestOffsets.lookup(x);
+    allocation->sharedMemorySize = bestSize;
+  }
+
 private:
   Operation *operation;
   Allocation::FuncAllocMapT *funcAllocMap;
   Allocation *allocation;
+  /// The hull of the liveness range of each buffer
   BufferRangeMapT bufferRange;
+  BufferPiecesMapT bufferPieces;
+  bool hasHopperDot = false;
 };
 
 } // namespace triton
 
+AllocationStrategy getDefaultAllocationStrategy() {
+  if (::triton::tools::getenv("TRITON_SMEM_ALLOCATOR") == "best-fit")
+    return AllocationStrategy::BestFit;
+  return AllocationStrategy::Heuristic;
+}
+
 void Allocation::run(FuncAllocMapT &funcAllocMap) {
   triton::AllocationAnalysis(getOperation(), &funcAllocMap, this);
 }
@@ -6,6 +6,8 @@
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 
+#include <numeric>
+
 namespace mlir {
 
 // Function for extended Euclidean Algorithm
@@ -57,13 +59,41 @@ void AxisInfo::initPessimisticStateFromFunc(int argNumber, T funcOp,
     Attribute attr = funcOp.getArgAttr(argNumber, attrName);
     if (auto int_attr = attr.dyn_cast_or_null<IntegerAttr>())
       *vec = DimVectorT(contiguity->size(), int_attr.getValue().getZExtValue());
-    if (auto dense_attr = attr.dyn_cast_or_null<DenseElementsAttr>()) {
-      auto vals = dense_attr.getValues<int>();
-      *vec = DimVectorT(vals.begin(), vals.end());
+    if (auto dense_attr = attr.dyn_cast_or_null<DenseIntElementsAttr>()) {
+      vec->clear();
+      for (const APInt &val : dense_attr.getValues<APInt>())
+        vec->push_back(val.getZExtValue());
     }
   }
 }
 
+void AxisInfo::joinFuncArgAttrs(FunctionOpInterface funcOp,
+                                int argNumber) const {
+  DimVectorT argContiguity(rank, highestPowOf2Divisor<int64_t>(0));
+  DimVectorT argDivisibility(rank, highestPowOf2Divisor<int64_t>(0));
+  DimVectorT argConstancy(rank, highestPowOf2Divisor<int64_t>(0));
+  initPessimisticStateFromFunc(argNumber, funcOp, &argContiguity,
+                               &argDivisibility, &argConstancy);
+  auto i64Ty = IntegerType::get(funcOp.getContext(), 64);
+  auto setAttrFn = [&](StringRef attrName, const DimVectorT &argVec,
+                       const DimVectorT &vec) {
+    DimVectorT values;
+    for (int d = 0; d < rank; ++d)
+      values.push_back(gcd(argVec[d], vec[d]));
+    // Scalars and 1-D tensors keep the form used by the frontend
+    Attribute attr;
+    if (rank == 1)
+      attr = IntegerAttr::get(i64Ty, values[0]);
+    else
+      attr = DenseIntElementsAttr::get(RankedTensorType::get({rank}, i64Ty),
+                                       ArrayRef<int64_t>(values));
+    funcOp.setArgAttr(argNumber, attrName, attr);
+  };
+  setAttrFn("tt.contiguity", argContiguity, contiguity);
+  setAttrFn("tt.divisibility", argDivisibility, divisibility);
+  setAttrFn("tt.constancy", argConstancy, constancy);
+}
+
 AxisInfo AxisInfo::getPessimisticValueState(Value value) {
   auto rank = 1;
   if (TensorType ty = value.getType().dyn_cast<TensorType>())
@@ -928,6 +958,34 @@ unsigned ModuleAxisInfoAnalysis::getPtrContiguity(Value ptr) {
   return contiguity;
 }
 
+unsigned ModuleAxisInfoAnalysis::getConstancyPerThread(Value value) {
+  auto tensorTy = value.getType().dyn_cast<RankedTensorType>();
+  if (!tensorTy)
+    return 1;
+  auto *axisInfo = getAxisInfo(value);
+  if (!axisInfo)
+    return 1;
+  auto order = triton::gpu::getOrder(tensorTy.getEncoding());
+  auto uniqueContigPerThread = triton::gpu::getUniqueContigPerThread(tensorTy);
+  // runs of constant values start at multiples of the constancy, and the
+  // elements of a thread at multiples of its contiguity
+  unsigned constancy = axisInfo->getConstancy(order[0]);
+  return std::gcd(constancy, uniqueContigPerThread[order[0]]);
+}
+
+bool ModuleAxisInfoAnalysis::isUniform(Value value) {
+  auto tensorTy = value.getType().dyn_cast<RankedTensorType>();
+  if (!tensorTy)
+    return false;
+  auto *axisInfo = getAxisInfo(value);
+  if (!axisInfo)
+    return false;
+  for (unsigned d = 0; d < tensorTy.getRank(); ++d)
+    if (!AxisInfoVisitor::isConstantDim(*axisInfo, tensorTy.getShape(), d))
+      return false;
+  return true;
+}
+
 unsigned ModuleAxisInfoAnalysis::getPtrAlignment(Value ptr) {
   auto tensorTy = ptr.getType().dyn_cast<RankedTensorType>();
   if (!tensorTy)
@@ -958,6 +1016,56 @@ unsigned ModuleAxisInfoAnalysis::getMaskAlignment(Value mask) {
   return alignment;
 }
 
+unsigned ModuleAxisInfoAnalysis::getTensorPtrAlignment(
+    Value ptr, std::optional<ArrayRef<int32_t>> boundaryCheck) {
+  SmallVector<triton::AdvanceOp> advances;
+  auto makeTensorPtr = getMakeTensorPtrOp(ptr, &advances);
+  if (!makeTensorPtr)
+    return 1;
+  auto getDivisibility = [&](Value value) -> int64_t {
+    auto *axisInfo = getAxisInfo(value);
+    return axisInfo ? axisInfo->getDivisibility(0) : 1;
+  };
+  // Only a dimension of unit stride has consecutive addresses
+  unsigned dim = makeTensorPtr.getOrder()[0];
+  auto *strideInfo = getAxisInfo(makeTensorPtr.getStrides()[dim]);
+  if (!strideInfo || strideInfo->getConstantValue() != 1)
+    return 1;
+  auto blockTy = triton::getPointeeType(ptr.getType()).cast<RankedTensorType>();
+  auto elemNumBytes = std::max<unsigned>(
+      blockTy.getElementType().getIntOrFloatBitWidth() / 8, 1);
+  // The address of an element is base + sum((offset + index) * stride)
+  int64_t alignment =
+      std::max<int64_t>(getDivisibility(makeTensorPtr.getBase()) /
+                            elemNumBytes,
+                        1);
+  for (auto stride : llvm::enumerate(makeTensorPtr.getStrides()))
+    if (stride.index() != dim)
+      alignment = gcd(alignment, getDivisibility(stride.value()));
+  alignment = gcd(alignment, getDivisibility(makeTensorPtr.getOffsets()[dim]));
+  for (auto advance : advances)
+    alignment = gcd(alignment, getDivisibility(advance.getOffsets()[dim]));
+  // The bound of a checked dimension must not split a vector
+  if (boundaryCheck && llvm::is_contained(*boundaryCheck, int32_t(dim)))
+    alignment = gcd(alignment, getDivisibility(makeTensorPtr.getShape()[dim]));
+  return std::min<int64_t>(alignment, blockTy.getShape()[dim]);
+}
+
+unsigned ModuleAxisInfoAnalysis::getTensorPtrContiguity(
+    Value ptr, RankedTensorType valueTy,
+    std::optional<ArrayRef<int32_t>> boundaryCheck) {
+  auto makeTensorPtr = getMakeTensorPtrOp(ptr);
+  if (!makeTensorPtr || !valueTy.getEncoding())
+    return 1;
+  unsigned dim = makeTensorPtr.getOrder()[0];
+  auto order = triton::gpu::getOrder(valueTy.getEncoding());
+  if (order[0] != dim)
+    return 1;
+  auto uniqueContigPerThread = triton::gpu::getUniqueContigPerThread(valueTy);
+  return std::min(getTensorPtrAlignment(ptr, boundaryCheck),
+                  uniqueContigPerThread[dim]);
+}
+
 void ModuleAxisInfoAnalysis::initialize(FunctionOpInterface funcOp) {
   std::unique_ptr<DataFlowSolver> solver = createDataFlowSolver();
   AxisInfoAnalysis *analysis = solver->load<AxisInfoAnalysis>();
@@ -991,23 +1099,9 @@ void ModuleAxisInfoAnalysis::update(CallOpInterface callOp,
   auto caller = callOp->getParentOfType<FunctionOpInterface>();
   auto *axisInfoMap = getFuncData(caller);
   for (auto entry : llvm::enumerate(callOp->getOperands())) {
-    auto index = entry.index();
-    auto value = entry.value();
-    auto setAttrFn = [&](StringRef attrName, int64_t prevValue) {
-      auto curValue = highestPowOf2Divisor<int64_t>(0);
-      if (callee.getArgAttrOfType<IntegerAttr>(index, attrName)) {
-        curValue =
-            callee.getArgAttrOfType<IntegerAttr>(index, attrName).getInt();
-      }
-      auto attr = IntegerAttr::get(IntegerType::get(callee.getContext(), 64),
-                                   gcd(prevValue, curValue));
-      callee.setArgAttr(index, attrName, attr);
-    };
-    auto axisInfo = axisInfoMap->lookup(value);
-    assert(axisInfo.getRank() == 1 && "only scalar arguments are supported");
-    setAttrFn("tt.contiguity", axisInfo.getContiguity(0));
-    setAttrFn("tt.divisibility", axisInfo.getDivisibility(0));
-    setAttrFn("tt.constancy", axisInfo.getConstancy(0));
+    auto axisInfo = axisInfoMap->lookup(entry.value());
+    assert(axisInfo.getRank() > 0 && "the argument has no axis info");
+    axisInfo.joinFuncArgAttrs(callee, entry.index());
   }
 }
 
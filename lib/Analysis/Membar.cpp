@@ -5,6 +5,7 @@
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/GPU/IR/GPUDialect.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
 #include <deque>
 
 namespace mlir {
@@ -86,19 +87,56 @@ void MembarAnalysis::visitTerminator(Operation *op,
     return;
   }
   // Otherwise, it could be a return op
-  if (isa<triton::ReduceReturnOp>(op) || isa<triton::ReturnOp>(op)) {
+  if (isa<triton::ReduceReturnOp, triton::ScanReturnOp, triton::ReturnOp>(op)) {
     return;
   }
   llvm_unreachable("Unknown terminator encountered in membar analysis");
 }
 
+BlockInfo::IntervalSetT MembarAnalysis::getIntervals(Value value) const {
+  // A slice of a multi-buffered tensor only covers its own slot
+  if (auto extractOp = value.getDefiningOp<triton::gpu::ExtractSliceOp>()) {
+    auto srcType = extractOp.getSource().getType().cast<RankedTensorType>();
+    auto index = getSlotIndex(
+        extractOp.getMixedOffsets(), extractOp.getMixedSizes(),
+        extractOp.getMixedStrides(), srcType.getShape());
+    if (index)
+      return getSlotIntervals(extractOp.getSource(), index);
+  }
+  return getSlotIntervals(value, std::nullopt);
+}
+
+BlockInfo::IntervalSetT
+MembarAnalysis::getSlotIntervals(Value buffer,
+                                 std::optional<int64_t> index) const {
+  BlockInfo::IntervalSetT intervals;
+  for (auto bufferId : allocation->getBufferIds(buffer))
+    if (bufferId != Allocation::InvalidBufferId)
+      for (auto interval : allocation->getAliasedIntervals(buffer, bufferId))
+        intervals.insert(interval);
+  auto tensorType = buffer.getType().dyn_cast<RankedTensorType>();
+  if (!index || intervals.size() != 1 || !tensorType ||
+      tensorType.getRank() < 2 ||
+      !tensorType.getElementType().isIntOrFloat())
+    return intervals;
+  auto interval = *intervals.begin();
+  int64_t numSlots = tensorType.getShape()[0];
+  size_t bytes = tensorType.getNumElements() *
+                 tensorType.getElementTypeBitWidth() / 8;
+  if (*index < 0 || *index >= numSlots || interval.size() != bytes)
+    return intervals;
+  size_t slotSize = bytes / numSlots;
+  size_t start = interval.start() + *index * slotSize;
+  return {Interval<size_t>(start, start + slotSize)};
+}
+
 void MembarAnalysis::update(Operation *op, BlockInfo *blockInfo,
                             FuncBlockInfoMapT *funcBlockInfoMap,
                             OpBuilder *builder) {
   if (isa<triton::gpu::ExtractSliceOp>(op) ||
       isa<triton::gpu::AllocTensorOp>(op) || isa<triton::TransOp>(op)) {
     // alloc is an allocation op without memory write.
-    // FIXME(Keren): extract_slice is always alias for now
+    // extract_slice is an alias, its slot is accessed by its users.
     return;
   }
 
@@ -108,15 +146,15 @@ void MembarAnalysis::update(Operation *op, BlockInfo *blockInfo,
     return;
   }
 
-  if (isa<triton::gpu::AsyncWaitOp>(op) &&
-      !isa<gpu::BarrierOp>(op->getNextNode())) {
-    // If the current op is an async wait and the next op is not a barrier we
-    // insert a barrier op and sync
-    blockInfo->sync();
-    OpBuilder::InsertionGuard g(*builder);
-    builder->setInsertionPointAfter(op);
-    builder->create<gpu::BarrierOp>(op->getLoc());
-    blockInfo->sync();
+  if (isa<triton::gpu::AsyncCommitGroupOp>(op)) {
+    blockInfo->commitAsync();
+    return;
+  }
+
+  if (auto waitOp = dyn_cast<triton::gpu::AsyncWaitOp>(op)) {
+    // The completed async copies are synced by the barrier inserted before
+    // the first access that conflicts with them
+    blockInfo->waitAsync(waitOp.getNum());
     return;
   }
 
@@ -130,21 +168,30 @@ void MembarAnalysis::update(Operation *op, BlockInfo *blockInfo,
     }
   } else {
     // Intra-function dependencies
-    for (Value value : op->getOperands()) {
-      for (auto bufferId : allocation->getBufferIds(value)) {
-        if (bufferId != Allocation::InvalidBufferId) {
-          if (isa<triton::gpu::InsertSliceAsyncOp>(op) ||
-              isa<tensor::InsertSliceOp>(op)) {
-            // FIXME(Keren): insert_slice and insert_slice_async are always
-            // alias for now
-            curBlockInfo.syncWriteIntervals.insert(
-                allocation->getAllocatedInterval(bufferId));
-          } else {
-            // ConvertLayoutOp: shared memory -> registers
-            curBlockInfo.syncReadIntervals.insert(
-                allocation->getAllocatedInterval(bufferId));
-          }
-        }
+    if (auto insertOp = dyn_cast<triton::gpu::InsertSliceAsyncOp>(op)) {
+      // The copy is also tracked as a synchronous write so that accesses
+      // issued before its group completes stay ordered with it
+      std::optional<int64_t> index;
+      if (insertOp.getAxis() == 0)
+        index = getConstantIntValue(insertOp.getIndex());
+      auto intervals = getSlotIntervals(insertOp.getDst(), index);
+      curBlockInfo.syncWriteIntervals.insert(intervals.begin(),
+                                             intervals.end());
+      blockInfo->uncommittedAsyncIntervals.insert(intervals.begin(),
+                                                  intervals.end());
+    } else if (auto insertOp = dyn_cast<tensor::InsertSliceOp>(op)) {
+      auto index = getSlotIndex(
+          insertOp.getMixedOffsets(), insertOp.getMixedSizes(),
+          insertOp.getMixedStrides(), insertOp.getDestType().getShape());
+      auto intervals = getSlotIntervals(insertOp.getDest(), index);
+      curBlockInfo.syncWriteIntervals.insert(intervals.begin(),
+                                             intervals.end());
+    } else {
+      for (Value value : op->getOperands()) {
+        // ConvertLayoutOp: shared memory -> registers
+        auto intervals = getIntervals(value);
+        curBlockInfo.syncReadIntervals.insert(intervals.begin(),
+                                              intervals.end());
       }
     }
     for (Value value : op->getResults()) {
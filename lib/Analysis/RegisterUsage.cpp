@@ -0,0 +1,62 @@
+#include "triton/Analysis/RegisterUsage.h"
+#include "mlir/Analysis/Liveness.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+
+#include <algorithm>
+
+namespace mlir {
+
+static unsigned getBitWidth(Type type) {
+  if (type.isa<triton::PointerType>())
+    return 64;
+  if (type.isIntOrFloat())
+    return type.getIntOrFloatBitWidth();
+  // Index values are lowered to i32
+  return 32;
+}
+
+unsigned getNumRegisters(Type type) {
+  auto tensorTy = type.dyn_cast<RankedTensorType>();
+  if (!tensorTy)
+    return (getBitWidth(type) + 31) / 32;
+  Attribute encoding = tensorTy.getEncoding();
+  // Tensors are only distributed once they have a TritonGPU layout
+  if (!encoding)
+    return 0;
+  if (encoding.isa<triton::gpu::SharedEncodingAttr>())
+    return 1;
+  unsigned elems = triton::gpu::getTotalElemsPerThread(tensorTy);
+  unsigned bitWidth = getBitWidth(tensorTy.getElementType());
+  // Booleans live in predicate registers
+  if (bitWidth == 1)
+    return 0;
+  return (elems * bitWidth + 31) / 32;
+}
+
+unsigned estimateRegisterUsage(FunctionOpInterface funcOp) {
+  Liveness liveness(funcOp);
+  unsigned maxRegisters = 0;
+  funcOp->walk([&](Block *block) {
+    const LivenessBlockInfo *blockInfo = liveness.getLiveness(block);
+    if (!blockInfo)
+      return;
+    for (Operation &op : *block) {
+      unsigned registers = 0;
+      for (Value value : blockInfo->currentlyLiveValues(&op))
+        registers += getNumRegisters(value.getType());
+      maxRegisters = std::max(maxRegisters, registers);
+    }
+  });
+  return maxRegisters;
+}
+
+unsigned estimateRegisterUsage(ModuleOp moduleOp) {
+  unsigned maxRegisters = 0;
+  moduleOp.walk([&](FunctionOpInterface funcOp) {
+    maxRegisters = std::max(maxRegisters, estimateRegisterUsage(funcOp));
+  });
+  return maxRegisters;
+}
+
+} // namespace mlir
@@ -1,8 +1,11 @@
 #include "triton/Analysis/Utility.h"
 #include "mlir/Analysis/DataFlow/ConstantPropagationAnalysis.h"
 #include "mlir/Analysis/DataFlow/DeadCodeAnalysis.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/Dialect.h"
 #include "mlir/IR/Matchers.h"
+#include "mlir/IR/TypeUtilities.h"
+#include "mlir/Interfaces/ControlFlowInterfaces.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include <deque>
@@ -36,6 +39,10 @@ unsigned ReduceOpHelper::getThreadsReductionAxis() {
          triton::gpu::getWarpsPerCTAWithUniqueData(srcLayout, srcShape)[axis];
 }
 
+bool ReduceOpHelper::isWarpSynchronous() {
+  return isFastReduction() && getInterWarpSize() == 1;
+}
+
 SmallVector<unsigned> ReduceOpHelper::getScratchConfigBasic() {
   auto smemShape = convertType<unsigned>(getSrcShape());
   smemShape[axis] = std::min(smemShape[axis], getThreadsReductionAxis());
@@ -47,7 +54,8 @@ SmallVector<SmallVector<unsigned>> ReduceOpHelper::getScratchConfigsFast() {
 
   auto argLayout = getSrcLayout();
   auto argLayoutMma = argLayout.dyn_cast<triton::gpu::MmaEncodingAttr>();
-  if (argLayoutMma && argLayoutMma.getVersionMajor() == 2 &&
+  if (argLayoutMma &&
+      (argLayoutMma.isAmpere() || argLayoutMma.isHopper()) &&
       triton::gpu::getWarpsPerCTA(argLayout)[axis] == 1)
     return {{1, 1}, {1, 1}};
 
@@ -59,12 +67,17 @@ SmallVector<SmallVector<unsigned>> ReduceOpHelper::getScratchConfigsFast() {
   /// shared memory block1:
   auto mod = op->getParentOfType<ModuleOp>();
   unsigned numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
-  smemShapes[1].push_back(numWarps * 32);
+  unsigned threadsPerWarp =
+      triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+  smemShapes[1].push_back(numWarps * threadsPerWarp);
 
   return smemShapes;
 }
 
 unsigned ReduceOpHelper::getScratchSizeInBytes() {
+  if (isWarpSynchronous())
+    return 0;
+
   unsigned elems = 0;
   if (isFastReduction()) {
     auto smemShapes = getScratchConfigsFast();
@@ -88,7 +101,7 @@ bool ReduceOpHelper::isSupportedLayout() {
     return true;
   }
   if (auto mmaLayout = srcLayout.dyn_cast<triton::gpu::MmaEncodingAttr>()) {
-    if (mmaLayout.isAmpere()) {
+    if (mmaLayout.isAmpere() || mmaLayout.isHopper()) {
       return true;
     }
   }
@@ -98,6 +111,106 @@ bool ReduceOpHelper::isSupportedLayout() {
   return false;
 }
 
+bool ScanLoweringHelper::isSupported() {
+  // TODO: Support the mma and slice layouts.
+  auto blockedLayout =
+      srcEncoding.dyn_cast<triton::gpu::BlockedEncodingAttr>();
+  if (!blockedLayout)
+    return false;
+  if (blockedLayout.getSizePerThread()[getAxis()] > srcShape[getAxis()])
+    return false;
+  for (auto ty : scanOp.getElementTypes())
+    if (!ty.isIntOrFloat() || ty.getIntOrFloatBitWidth() < 8)
+      return false;
+  return true;
+}
+
+unsigned ScanLoweringHelper::getAxisNumElementsPerThread() {
+  return triton::gpu::getSizePerThread(srcEncoding)[getAxis()];
+}
+
+unsigned ScanLoweringHelper::getAxisNumThreadsPerWarp() {
+  unsigned threadsPerWarp =
+      triton::gpu::getThreadsPerWarp(srcEncoding)[getAxis()];
+  unsigned maxThreads = srcShape[getAxis()] / getAxisNumElementsPerThread();
+  return std::max<unsigned>(1, std::min(threadsPerWarp, maxThreads));
+}
+
+unsigned ScanLoweringHelper::getAxisNumWarps() {
+  unsigned warpsPerCTA = triton::gpu::getWarpsPerCTA(srcEncoding)[getAxis()];
+  unsigned sizePerWarp =
+      getAxisNumElementsPerThread() *
+      triton::gpu::getThreadsPerWarp(srcEncoding)[getAxis()];
+  unsigned maxWarps = srcShape[getAxis()] / sizePerWarp;
+  return std::max<unsigned>(1, std::min(warpsPerCTA, maxWarps));
+}
+
+unsigned ScanLoweringHelper::getAxisNumBlocks() {
+  unsigned shapePerCTA =
+      getAxisNumElementsPerThread() *
+      triton::gpu::getThreadsPerWarp(srcEncoding)[getAxis()] *
+      triton::gpu::getWarpsPerCTA(srcEncoding)[getAxis()];
+  return std::max<unsigned>(1, srcShape[getAxis()] / shapePerCTA);
+}
+
+SmallVector<unsigned> ScanLoweringHelper::getScratchConfig() {
+  auto smemShape = convertType<unsigned>(srcShape);
+  smemShape[getAxis()] = getAxisNumWarps() * getAxisNumBlocks();
+  return smemShape;
+}
+
+unsigned ScanLoweringHelper::getScratchSizeInBytes() {
+  // A single warp along the axis does not exchange data through shared memory
+  if (getAxisNumWarps() * getAxisNumBlocks() == 1)
+    return 0;
+  unsigned bytesPerElem = 0;
+  for (const auto &ty : scanOp.getElementTypes())
+    bytesPerElem += ty.getIntOrFloatBitWidth() / 8;
+  return bytesPerElem * product<unsigned>(getScratchConfig());
+}
+
+unsigned SortLoweringHelper::getAxisNumElementsPerThread() {
+  // Elements owned by the other layouts are compared in shared memory
+  auto blockedLayout =
+      srcEncoding.dyn_cast<triton::gpu::BlockedEncodingAttr>();
+  if (!blockedLayout)
+    return 1;
+  unsigned sizePerThread = blockedLayout.getSizePerThread()[axis];
+  return sizePerThread <= srcShape[axis] ? sizePerThread : 1;
+}
+
+unsigned SortLoweringHelper::getAxisNumElementsPerWarp() {
+  unsigned sizePerThread = getAxisNumElementsPerThread();
+  // Shuffles pair the lanes along the axis, which must be the fastest varying
+  // dimension of the lane id
+  auto blockedLayout =
+      srcEncoding.dyn_cast<triton::gpu::BlockedEncodingAttr>();
+  if (!blockedLayout || blockedLayout.getOrder()[0] != axis)
+    return sizePerThread;
+  unsigned sizePerWarp =
+      sizePerThread * blockedLayout.getThreadsPerWarp()[axis];
+  return sizePerWarp <= srcShape[axis] ? sizePerWarp : sizePerThread;
+}
+
+bool SortLoweringHelper::needsSharedMemory() {
+  return isa<triton::TopKOp>(op) ||
+         getAxisNumElementsPerWarp() < srcShape[axis];
+}
+
+SmallVector<unsigned> SortLoweringHelper::getScratchConfig() {
+  return convertType<unsigned>(srcShape);
+}
+
+unsigned SortLoweringHelper::getScratchSizeInBytes() {
+  if (!needsSharedMemory())
+    return 0;
+  unsigned bytesPerElem = 0;
+  for (auto operand : op->getOperands())
+    bytesPerElem +=
+        getElementTypeOrSelf(operand.getType()).getIntOrFloatBitWidth() / 8;
+  return bytesPerElem * product<unsigned>(getScratchConfig());
+}
+
 bool isSharedEncoding(Value value) {
   auto type = value.getType();
   if (auto tensorType = type.dyn_cast<RankedTensorType>()) {
@@ -142,7 +255,9 @@ bool supportMMA(Value value, int version) {
   // Tell whether a DotOp support HMMA by the operand type(either $a or $b).
   // We cannot get both the operand types(in TypeConverter), here we assume the
   // types of both the operands are identical here.
-  assert((version == 1 || version == 2) &&
+  // Hopper dots fall back to the Ampere instructions for the operands that
+  // wgmma cannot read, so they support the same types.
+  assert((version == 1 || version == 2 || version == 3) &&
          "Unexpected MMA layout version found");
   auto elemTy = value.getType().cast<RankedTensorType>().getElementType();
   return elemTy.isF16() || elemTy.isBF16() ||
@@ -150,6 +265,102 @@ bool supportMMA(Value value, int version) {
          (elemTy.isInteger(8) && version >= 2);
 }
 
+triton::gpu::ConvertLayoutOp getWGMMAOperandB(triton::DotOp op) {
+  auto dTy = op.getD().getType().cast<RankedTensorType>();
+  auto mmaLayout = dTy.getEncoding().dyn_cast<triton::gpu::MmaEncodingAttr>();
+  if (!mmaLayout || !mmaLayout.isHopper())
+    return nullptr;
+  auto cvt = op.getB().getDefiningOp<triton::gpu::ConvertLayoutOp>();
+  if (!cvt)
+    return nullptr;
+  auto srcTy = cvt.getSrc().getType().cast<RankedTensorType>();
+  auto sharedLayout =
+      srcTy.getEncoding().dyn_cast<triton::gpu::SharedEncodingAttr>();
+  if (!sharedLayout)
+    return nullptr;
+  auto elemTy = srcTy.getElementType();
+  if (!(elemTy.isF16() || elemTy.isBF16()) ||
+      getElementType(op.getA()) != elemTy || !dTy.getElementType().isF32())
+    return nullptr;
+  // Every warpgroup computes rows [64 * i, 64 * (i + 1)) of the repetitions
+  // of the layout with m64nNk16 instructions
+  auto warpsPerCTA = mmaLayout.getWarpsPerCTA();
+  auto shape = srcTy.getShape();
+  if (warpsPerCTA[0] % 4 != 0 || warpsPerCTA[1] != 1 ||
+      dTy.getShape()[0] % (16 * warpsPerCTA[0]) != 0 || shape[0] % 16 != 0 ||
+      shape[1] % 8 != 0 || shape[1] > 256)
+    return nullptr;
+  // A row of the tile must be exactly one 32, 64 or 128-byte swizzle atom:
+  // its 16-byte vectors are xor-ed with the index of the row in groups of 8
+  auto order = sharedLayout.getOrder();
+  unsigned rowBytes = shape[order[0]] * elemTy.getIntOrFloatBitWidth() / 8;
+  if (rowBytes != 32 && rowBytes != 64 && rowBytes != 128)
+    return nullptr;
+  unsigned maxPhase = rowBytes / 16;
+  if (sharedLayout.getVec() != 8 || sharedLayout.getMaxPhase() != maxPhase ||
+      sharedLayout.getPerPhase() * maxPhase != 8)
+    return nullptr;
+  return cvt;
+}
+
+triton::MakeTensorPtrOp
+getMakeTensorPtrOp(Value ptr, SmallVectorImpl<triton::AdvanceOp> *advances) {
+  triton::MakeTensorPtrOp makeTensorPtr;
+  SmallVector<Value> worklist{ptr};
+  DenseSet<Value> visited;
+  // A block pointer carried by a loop comes from its init value and from
+  // the value yielded by the previous iteration
+  auto visitLoopValue = [&](scf::ForOp forOp, unsigned idx) {
+    worklist.push_back(forOp.getIterOperands()[idx]);
+    worklist.push_back(forOp.getBody()->getTerminator()->getOperand(idx));
+  };
+  while (!worklist.empty()) {
+    Value value = worklist.pop_back_val();
+    if (!visited.insert(value).second)
+      continue;
+    if (auto arg = value.dyn_cast<BlockArgument>()) {
+      Block *block = arg.getOwner();
+      auto forOp = dyn_cast<scf::ForOp>(block->getParentOp());
+      if (forOp) {
+        if (arg.getArgNumber() < forOp.getNumInductionVars())
+          return nullptr;
+        visitLoopValue(forOp, arg.getArgNumber() - forOp.getNumInductionVars());
+        continue;
+      }
+      // Once loops are lowered to branches, the block pointer comes from
+      // the operands of the branches to the block
+      if (block->isEntryBlock())
+        return nullptr;
+      for (Block *pred : block->getPredecessors()) {
+        auto branch = dyn_cast<BranchOpInterface>(pred->getTerminator());
+        if (!branch)
+          return nullptr;
+        for (unsigned i = 0; i < branch->getNumSuccessors(); ++i) {
+          if (branch->getSuccessor(i) != block)
+            continue;
+          Value operand = branch.getSuccessorOperands(i)[arg.getArgNumber()];
+          if (!operand)
+            return nullptr;
+          worklist.push_back(operand);
+        }
+      }
+    } else if (auto op = value.getDefiningOp<triton::MakeTensorPtrOp>()) {
+      if (makeTensorPtr && makeTensorPtr != op)
+        return nullptr;
+      makeTensorPtr = op;
+    } else if (auto op = value.getDefiningOp<triton::AdvanceOp>()) {
+      if (advances)
+        advances->push_back(op);
+      worklist.push_back(op.getPtr());
+    } else if (auto forOp = value.getDefiningOp<scf::ForOp>()) {
+      visitLoopValue(forOp, value.cast<OpResult>().getResultNumber());
+    } else {
+      return nullptr;
+    }
+  }
+  return makeTensorPtr;
+}
+
 Type getElementType(Value value) {
   auto type = value.getType();
   if (auto tensorType = type.dyn_cast<RankedTensorType>())
@@ -165,17 +376,161 @@ std::string getValueOperandName(Value value, AsmState &state) {
 }
 
 bool isMmaToDotShortcut(RankedTensorType &srcTy, RankedTensorType &dstTy) {
-  // dot_op<opIdx=0, parent=#mma> = #mma
-  // when #mma = MmaEncoding<version=2, warpsPerCTA=[..., 1]>
+  // dot_op<opIdx=0, parent=#mma'> = #mma
+  // when #mma = MmaEncoding<version=2 or 3, warpsPerCTA=[..., 1]>: the quad
+  // of threads holding a row of the accumulators holds the row of $a too,
+  // spread over the quad as the lowering expects for 16-bit elements, and up
+  // to shuffles within the quad for 8-bit and 32-bit elements on Ampere.
+  // #mma' must split its rows over the same warps as #mma, so that a warp
+  // reads the rows of $a it computed: as both layouts hold all the warps of
+  // the CTA, #mma' has warpsPerCTA=[numWarps, 1] too.
   auto srcLayout = srcTy.getEncoding();
   auto dstLayout = dstTy.getEncoding();
   auto mmaLayout = srcLayout.cast<triton::gpu::MmaEncodingAttr>();
   auto dotOperandLayout = dstLayout.cast<triton::gpu::DotOperandEncodingAttr>();
-  return mmaLayout.getVersionMajor() == 2 &&
-         mmaLayout.getWarpsPerCTA()[1] == 1 &&
-         dotOperandLayout.getOpIdx() == 0 &&
-         dotOperandLayout.getParent() == mmaLayout &&
-         !srcTy.getElementType().isF32();
+  auto parentLayout =
+      dotOperandLayout.getParent().dyn_cast<triton::gpu::MmaEncodingAttr>();
+  if (!(mmaLayout.isAmpere() || mmaLayout.isHopper()) ||
+      mmaLayout.getWarpsPerCTA()[1] != 1 ||
+      dotOperandLayout.getOpIdx() != 0 || !parentLayout)
+    return false;
+  unsigned bitwidth = srcTy.getElementType().getIntOrFloatBitWidth();
+  if (mmaLayout.isHopper())
+    return parentLayout == mmaLayout && bitwidth == 16;
+  // the registers of $a hold consecutive columns, as many as fit
+  unsigned kPerReg = 32 / bitwidth;
+  return parentLayout.isAmpere() &&
+         parentLayout.getWarpsPerCTA()[0] == mmaLayout.getWarpsPerCTA()[0] &&
+         (bitwidth == 8 || bitwidth == 16 || bitwidth == 32) &&
+         dotOperandLayout.getMMAv2kWidth() == kPerReg &&
+         srcTy.getShape()[1] % (8 * kPerReg) == 0;
+}
+
+namespace {
+
+// Delinearizes `linear` over `shape`, with order[0] the fastest dimension.
+SmallVector<unsigned> delinearize(unsigned linear, ArrayRef<unsigned> shape,
+                                  ArrayRef<unsigned> order) {
+  SmallVector<unsigned> multiDim(shape.size());
+  for (unsigned d : order) {
+    multiDim[d] = linear % shape[d];
+    linear /= shape[d];
+  }
+  return multiDim;
+}
+
+unsigned linearize(ArrayRef<unsigned> multiDim, ArrayRef<unsigned> shape,
+                   ArrayRef<unsigned> order) {
+  unsigned linear = 0;
+  for (unsigned d : llvm::reverse(order))
+    linear = linear * shape[d] + multiDim[d];
+  return linear;
+}
+
+// Maps the elements of a tensor to the warp, the lane and the register
+// holding them in a blocked layout. Only tensors made of whole CTA tiles are
+// supported, so that every element is held by exactly one thread.
+class BlockedElemMap {
+public:
+  BlockedElemMap(triton::gpu::BlockedEncodingAttr layout,
+                 ArrayRef<int64_t> shape)
+      : sizePerThread(layout.getSizePerThread()),
+        threadsPerWarp(layout.getThreadsPerWarp()),
+        warpsPerCTA(layout.getWarpsPerCTA()), order(layout.getOrder()) {
+    auto shapePerCTA = triton::gpu::getShapePerCTA(layout);
+    for (unsigned d = 0; d < shape.size(); ++d) {
+      isSupported &= shape[d] % shapePerCTA[d] == 0;
+      tilesPerDim.push_back(shape[d] / shapePerCTA[d]);
+    }
+    elemsPerTile = product<unsigned>(sizePerThread);
+  }
+
+  bool supported() const { return isSupported; }
+
+  SmallVector<unsigned> getCoord(unsigned warp, unsigned lane,
+                                 unsigned reg) const {
+    auto warpId = delinearize(warp, warpsPerCTA, order);
+    auto laneId = delinearize(lane, threadsPerWarp, order);
+    auto tileId = delinearize(reg / elemsPerTile, tilesPerDim, order);
+    auto elemId = delinearize(reg % elemsPerTile, sizePerThread, order);
+    SmallVector<unsigned> coord(order.size());
+    for (unsigned d = 0; d < order.size(); ++d)
+      coord[d] = ((tileId[d] * warpsPerCTA[d] + warpId[d]) * threadsPerWarp[d] +
+                  laneId[d]) *
+                     sizePerThread[d] +
+                 elemId[d];
+    return coord;
+  }
+
+  // Returns the warp, lane and register holding the element at `coord`.
+  std::tuple<unsigned, unsigned, unsigned>
+  getLocation(ArrayRef<unsigned> coord) const {
+    unsigned rank = order.size();
+    SmallVector<unsigned> warpId(rank), laneId(rank), tileId(rank),
+        elemId(rank);
+    for (unsigned d = 0; d < rank; ++d) {
+      unsigned thread = coord[d] / sizePerThread[d];
+      elemId[d] = coord[d] % sizePerThread[d];
+      laneId[d] = thread % threadsPerWarp[d];
+      warpId[d] = thread / threadsPerWarp[d] % warpsPerCTA[d];
+      tileId[d] = thread / threadsPerWarp[d] / warpsPerCTA[d];
+    }
+    unsigned reg = linearize(tileId, tilesPerDim, order) * elemsPerTile +
+                   linearize(elemId, sizePerThread, order);
+    return {linearize(warpId, warpsPerCTA, order),
+            linearize(laneId, threadsPerWarp, order), reg};
+  }
+
+private:
+  SmallVector<unsigned> sizePerThread;
+  SmallVector<unsigned> threadsPerWarp;
+  SmallVector<unsigned> warpsPerCTA;
+  SmallVector<unsigned> order;
+  SmallVector<unsigned> tilesPerDim;
+  unsigned elemsPerTile;
+  bool isSupported = true;
+};
+
+} // namespace
+
+std::optional<SmallVector<unsigned>>
+getWarpLocalCvtSrcRegs(RankedTensorType srcTy, RankedTensorType dstTy) {
+  auto srcLayout =
+      srcTy.getEncoding().dyn_cast<triton::gpu::BlockedEncodingAttr>();
+  auto dstLayout =
+      dstTy.getEncoding().dyn_cast<triton::gpu::BlockedEncodingAttr>();
+  // conversions between identical layouts are folded away, not lowered
+  if (!srcLayout || !dstLayout || srcLayout == dstLayout ||
+      srcTy.getShape() != dstTy.getShape())
+    return std::nullopt;
+  unsigned numWarps = product<unsigned>(dstLayout.getWarpsPerCTA());
+  unsigned warpSize = product<unsigned>(dstLayout.getThreadsPerWarp());
+  if (product<unsigned>(srcLayout.getWarpsPerCTA()) != numWarps ||
+      product<unsigned>(srcLayout.getThreadsPerWarp()) != warpSize)
+    return std::nullopt;
+  BlockedElemMap srcMap(srcLayout, srcTy.getShape());
+  BlockedElemMap dstMap(dstLayout, dstTy.getShape());
+  if (!srcMap.supported() || !dstMap.supported())
+    return std::nullopt;
+
+  unsigned numRegs = dstTy.getNumElements() / (numWarps * warpSize);
+  SmallVector<unsigned> srcRegs(numRegs);
+  for (unsigned reg = 0; reg < numRegs; ++reg)
+    for (unsigned warp = 0; warp < numWarps; ++warp)
+      for (unsigned lane = 0; lane < warpSize; ++lane) {
+        auto [srcWarp, srcLane, srcReg] =
+            srcMap.getLocation(dstMap.getCoord(warp, lane, reg));
+        // the element must stay in its warp, and all the lanes must read the
+        // same register so that a single shuffle fills `reg`
+        if (srcWarp != warp || (warp + lane > 0 && srcRegs[reg] != srcReg))
+          return std::nullopt;
+        srcRegs[reg] = srcReg;
+      }
+  return srcRegs;
+}
+
+bool isWarpLocalCvtLayout(RankedTensorType srcTy, RankedTensorType dstTy) {
+  return getWarpLocalCvtSrcRegs(srcTy, dstTy).has_value();
 }
 
 bool isSingleValue(Value value) {
@@ -191,6 +546,125 @@ bool isSingleValue(Value value) {
   return true;
 }
 
+// The ranges are only derived through a few ops, so the depth is bounded to
+// keep the walk cheap on long chains.
+static constexpr unsigned kMaxIntegerRangeDepth = 16;
+
+static std::optional<IntegerRange> getIntegerRange(Value value,
+                                                   unsigned depth) {
+  auto intTy = getElementTypeOrSelf(value.getType()).dyn_cast<IntegerType>();
+  if (!intTy || depth > kMaxIntegerRangeDepth)
+    return std::nullopt;
+  unsigned bitwidth = intTy.getWidth();
+  // Ranges of i64 values can overflow the int64_t arithmetic below, and i1
+  // values are predicates rather than offsets
+  if (bitwidth == 1 || bitwidth > 32)
+    return std::nullopt;
+  auto getRange = [&](Value operand) {
+    return getIntegerRange(operand, depth + 1);
+  };
+  // The range of the result, if the op cannot overflow its type
+  auto checked = [&](int64_t min, int64_t max) -> std::optional<IntegerRange> {
+    if (min < -(int64_t(1) << (bitwidth - 1)) ||
+        max >= (int64_t(1) << (bitwidth - 1)))
+      return std::nullopt;
+    return IntegerRange{min, max};
+  };
+
+  if (auto blockArg = value.dyn_cast<BlockArgument>()) {
+    auto forOp = dyn_cast<scf::ForOp>(blockArg.getOwner()->getParentOp());
+    if (!forOp || blockArg != forOp.getInductionVar())
+      return std::nullopt;
+    auto lb = getRange(forOp.getLowerBound());
+    auto ub = getRange(forOp.getUpperBound());
+    auto step = getRange(forOp.getStep());
+    if (!lb || !ub || !step || step->first <= 0)
+      return std::nullopt;
+    // The loop doesn't execute the body when lb >= ub
+    return IntegerRange{lb->first, std::max(lb->first, ub->second - 1)};
+  }
+
+  Operation *op = value.getDefiningOp();
+  if (!op)
+    return std::nullopt;
+  APInt constant;
+  if (matchPattern(value, m_ConstantInt(&constant)))
+    return IntegerRange{constant.getSExtValue(), constant.getSExtValue()};
+  if (auto makeRangeOp = dyn_cast<triton::MakeRangeOp>(op))
+    return IntegerRange{makeRangeOp.getStart(), makeRangeOp.getEnd() - 1};
+  // The grid has at most 2^31 - 1 programs along x and 65535 along y and z
+  if (auto pidOp = dyn_cast<triton::GetProgramIdOp>(op))
+    return IntegerRange{0, pidOp.getAxis() == 0 ? (1ll << 31) - 2 : 65534};
+  if (auto numProgramsOp = dyn_cast<triton::GetNumProgramsOp>(op))
+    return IntegerRange{1, numProgramsOp.getAxis() == 0 ? (1ll << 31) - 1
+                                                        : 65535};
+  if (isa<triton::SplatOp, triton::BroadcastOp, triton::ExpandDimsOp,
+          triton::ViewOp, arith::ExtSIOp, triton::gpu::ConvertLayoutOp>(op))
+    return getRange(op->getOperand(0));
+  if (isa<arith::ExtUIOp, arith::TruncIOp>(op)) {
+    auto src = getRange(op->getOperand(0));
+    if (!src || src->first < 0)
+      return std::nullopt;
+    return checked(src->first, src->second);
+  }
+  if (auto selectOp = dyn_cast<arith::SelectOp>(op)) {
+    auto lhs = getRange(selectOp.getTrueValue());
+    auto rhs = getRange(selectOp.getFalseValue());
+    if (!lhs || !rhs)
+      return std::nullopt;
+    return IntegerRange{std::min(lhs->first, rhs->first),
+                        std::max(lhs->second, rhs->second)};
+  }
+  if (op->getNumOperands() != 2)
+    return std::nullopt;
+  auto lhs = getRange(op->getOperand(0));
+  auto rhs = getRange(op->getOperand(1));
+  // x & y is in [0, y] if y >= 0, regardless of x
+  if (isa<arith::AndIOp>(op)) {
+    if (lhs && lhs->first >= 0 && rhs && rhs->first >= 0)
+      return IntegerRange{0, std::min(lhs->second, rhs->second)};
+    if (lhs && lhs->first >= 0)
+      return IntegerRange{0, lhs->second};
+    if (rhs && rhs->first >= 0)
+      return IntegerRange{0, rhs->second};
+    return std::nullopt;
+  }
+  if (!lhs || !rhs)
+    return std::nullopt;
+  auto [lhsMin, lhsMax] = *lhs;
+  auto [rhsMin, rhsMax] = *rhs;
+  if (isa<arith::AddIOp>(op))
+    return checked(lhsMin + rhsMin, lhsMax + rhsMax);
+  if (isa<arith::SubIOp>(op))
+    return checked(lhsMin - rhsMax, lhsMax - rhsMin);
+  if (isa<arith::MulIOp>(op)) {
+    int64_t products[] = {lhsMin * rhsMin, lhsMin * rhsMax, lhsMax * rhsMin,
+                          lhsMax * rhsMax};
+    return checked(*std::min_element(std::begin(products), std::end(products)),
+                   *std::max_element(std::begin(products), std::end(products)));
+  }
+  if (isa<arith::MinSIOp>(op))
+    return IntegerRange{std::min(lhsMin, rhsMin), std::min(lhsMax, rhsMax)};
+  if (isa<arith::MaxSIOp>(op))
+    return IntegerRange{std::max(lhsMin, rhsMin), std::max(lhsMax, rhsMax)};
+  // The division and the remainder of non-negative values by positive ones
+  // are the same for signed and unsigned ops
+  if (lhsMin < 0 || rhsMin <= 0)
+    return std::nullopt;
+  if (isa<arith::DivSIOp, arith::DivUIOp>(op))
+    return IntegerRange{lhsMin / rhsMax, lhsMax / rhsMin};
+  if (isa<arith::RemSIOp, arith::RemUIOp>(op)) {
+    if (lhsMax < rhsMin)
+      return IntegerRange{lhsMin, lhsMax};
+    return IntegerRange{0, std::min(lhsMax, rhsMax - 1)};
+  }
+  return std::nullopt;
+}
+
+std::optional<IntegerRange> getIntegerRange(Value value) {
+  return getIntegerRange(value, 0);
+}
+
 namespace {
 
 /// A data structure similar to SetVector but maintains
@@ -3,6 +3,7 @@
 
 using ::mlir::LLVM::getSharedMemoryObjectFromStruct;
 using ::mlir::LLVM::getStridesFromShapeAndOrder;
+using ::mlir::LLVM::shflIdxSync;
 using ::mlir::triton::gpu::DotOperandEncodingAttr;
 using ::mlir::triton::gpu::getContigPerThread;
 using ::mlir::triton::gpu::getOrder;
@@ -70,7 +71,13 @@ public:
         dstLayout.isa<DotOperandEncodingAttr>()) {
       return lowerSharedToDotOperand(op, adaptor, rewriter);
     }
+    if (srcLayout.isa<SharedEncodingAttr>() &&
+        isaDistributedLayout(dstLayout)) {
+      return lowerSharedToDistributed(op, adaptor, rewriter);
+    }
     if (isaDistributedLayout(srcLayout) && isaDistributedLayout(dstLayout)) {
+      if (auto srcRegs = getWarpLocalCvtSrcRegs(srcTy, dstTy))
+        return lowerWarpLocal(op, adaptor, rewriter, *srcRegs);
       return lowerDistributedToDistributed(op, adaptor, rewriter);
     }
     if (srcLayout.isa<MmaEncodingAttr>() &&
@@ -147,7 +154,7 @@ private:
       Value _4 = i32_val(4);
       Value _8 = i32_val(8);
       Value _16 = i32_val(16);
-      if (mmaLayout.isAmpere()) {
+      if (mmaLayout.isAmpere() || mmaLayout.isHopper()) {
         multiDimWarpId[0] = urem(multiDimWarpId[0], i32_val(shape[0] / 16));
         multiDimWarpId[1] = urem(multiDimWarpId[1], i32_val(shape[1] / 8));
         Value mmaGrpId = udiv(laneId, _4);
@@ -169,7 +176,7 @@ private:
 
       assert(rank == 2);
       SmallVector<Value> multiDimOffset(rank);
-      if (mmaLayout.isAmpere()) {
+      if (mmaLayout.isAmpere() || mmaLayout.isHopper()) {
         multiDimOffset[0] = elemId < 2 ? mmaRowIdx[0] : mmaRowIdx[1];
         multiDimOffset[1] = elemId % 2 == 0 ? mmaColIdx[0] : mmaColIdx[1];
         multiDimOffset[0] = add(
@@ -191,14 +198,41 @@ private:
     llvm_unreachable("unexpected layout in getMultiDimOffset");
   }
 
-  // shared memory rd/st for blocked or mma layout with data padding
+  // Offset of an element in an unpadded 2D scratch buffer whose rows are
+  // split in chunks of `swizzleVec` elements, permuted by XOR-ing their index
+  // with a per-row phase as for swizzled shared layouts. Accesses of up to
+  // `swizzleVec` elements stay contiguous, and consecutive rows map the same
+  // column to different banks.
+  Value getSwizzledOffset(Location loc, ConversionPatternRewriter &rewriter,
+                          ArrayRef<Value> multiDimOffset,
+                          ArrayRef<unsigned> repShape,
+                          ArrayRef<unsigned> outOrd, unsigned swizzleVec,
+                          unsigned elemBytes) const {
+    // shared memory is split in 32 banks of 4 bytes
+    const unsigned bankBytes = 128;
+    unsigned rowLen = repShape[outOrd[0]];
+    unsigned numChunks = rowLen / swizzleVec;
+    unsigned perPhase = std::max(1u, bankBytes / (rowLen * elemBytes));
+    unsigned maxPhase =
+        std::min(numChunks, std::max(1u, bankBytes / (swizzleVec * elemBytes)));
+    Value row = multiDimOffset[outOrd[1]];
+    Value col = multiDimOffset[outOrd[0]];
+    Value phase = urem(udiv(row, i32_val(perPhase)), i32_val(maxPhase));
+    Value chunk = xor_(udiv(col, i32_val(swizzleVec)), phase);
+    Value swizzledCol =
+        add(mul(chunk, i32_val(swizzleVec)), urem(col, i32_val(swizzleVec)));
+    return add(mul(row, i32_val(rowLen)), swizzledCol);
+  }
+
+  // shared memory rd/st for blocked or mma layout with data padding, or with
+  // swizzling if `swizzleVec` is not 0
   void processReplica(Location loc, ConversionPatternRewriter &rewriter,
                       bool stNotRd, RankedTensorType type,
                       ArrayRef<unsigned> numCTAsEachRep,
                       ArrayRef<unsigned> multiDimRepId, unsigned vec,
                       ArrayRef<unsigned> paddedRepShape,
                       ArrayRef<unsigned> outOrd, SmallVector<Value> &vals,
-                      Value smemBase) const {
+                      Value smemBase, unsigned swizzleVec = 0) const {
     auto accumNumCTAsEachRep = product<unsigned>(numCTAsEachRep);
     auto layout = type.getEncoding();
     auto rank = type.getRank();
@@ -240,7 +274,12 @@ private:
             getMultiDimOffset(layout, loc, rewriter, elemId, type,
                               multiDimCTAInRepId, shapePerCTA);
         Value offset =
-            linearize(rewriter, loc, multiDimOffset, paddedRepShape, outOrd);
+            swizzleVec
+                ? getSwizzledOffset(loc, rewriter, multiDimOffset,
+                                    paddedRepShape, outOrd, swizzleVec,
+                                    llvmElemTy.getIntOrFloatBitWidth() / 8)
+                : linearize(rewriter, loc, multiDimOffset, paddedRepShape,
+                            outOrd);
 
         auto elemPtrTy = ptr_ty(llvmElemTy, 3);
         Value ptr = gep(elemPtrTy, smemBase, offset);
@@ -375,8 +414,44 @@ private:
     }
   }
 
+  // blocked -> blocked within warps.
+  // Every register of the result is read from the same register of the
+  // operand in other lanes, with one warp shuffle and no shared memory.
+  LogicalResult lowerWarpLocal(triton::gpu::ConvertLayoutOp op,
+                               OpAdaptor adaptor,
+                               ConversionPatternRewriter &rewriter,
+                               ArrayRef<unsigned> srcRegs) const {
+    auto loc = op.getLoc();
+    auto srcTy = op.getSrc().getType().cast<RankedTensorType>();
+    auto dstTy = op.getResult().getType().cast<RankedTensorType>();
+    auto srcLayout = srcTy.getEncoding().cast<BlockedEncodingAttr>();
+    auto sizePerThread = srcLayout.getSizePerThread();
+    auto threadsPerWarp = srcLayout.getThreadsPerWarp();
+    auto order = srcLayout.getOrder();
+    unsigned rank = dstTy.getRank();
+    auto vals = getTypeConverter()->unpackLLElements(loc, adaptor.getSrc(),
+                                                     rewriter, srcTy);
+    auto dstIndices = emitIndices(loc, rewriter, dstTy.getEncoding(), dstTy);
+    SmallVector<Value> outVals(srcRegs.size());
+    for (unsigned reg = 0; reg < srcRegs.size(); ++reg) {
+      // lane of the operand holding the element
+      SmallVector<Value> multiDimLaneId(rank);
+      for (unsigned d = 0; d < rank; ++d)
+        multiDimLaneId[d] =
+            urem(udiv(dstIndices[reg][d], i32_val(sizePerThread[d])),
+                 i32_val(threadsPerWarp[d]));
+      Value srcLane =
+          linearize(rewriter, loc, multiDimLaneId, threadsPerWarp, order);
+      outVals[reg] = shflIdxSync(loc, rewriter, vals[srcRegs[reg]], srcLane);
+    }
+    Value result =
+        getTypeConverter()->packLLElements(loc, outVals, rewriter, dstTy);
+    rewriter.replaceOp(op, result);
+    return success();
+  }
+
   // blocked/mma -> blocked/mma.
-  // Data padding in shared memory to avoid bank conflict.
+  // Data padding or swizzling in shared memory to avoid bank conflict.
   LogicalResult
   lowerDistributedToDistributed(triton::gpu::ConvertLayoutOp op,
                                 OpAdaptor adaptor,
@@ -437,7 +512,9 @@ private:
                                                      rewriter, srcTy);
     unsigned inVec = 0;
     unsigned outVec = 0;
-    auto paddedRepShape = getScratchConfigForCvtLayout(op, inVec, outVec);
+    unsigned swizzleVec = 0;
+    auto paddedRepShape =
+        getScratchConfigForCvtLayout(op, inVec, outVec, swizzleVec);
 
     unsigned outElems = getTotalElemsPerThread(dstTy);
     auto outOrd = getOrder(dstLayout);
@@ -458,7 +535,7 @@ private:
         else
           processReplica(loc, rewriter, /*stNotRd*/ true, srcTy,
                          inNumCTAsEachRep, multiDimRepId, inVec, paddedRepShape,
-                         outOrd, vals, smemBase);
+                         outOrd, vals, smemBase, swizzleVec);
       } else {
         assert(0 && "ConvertLayout with input layout not implemented");
         return failure();
@@ -475,7 +552,7 @@ private:
         else
           processReplica(loc, rewriter, /*stNotRd*/ false, dstTy,
                          outNumCTAsEachRep, multiDimRepId, outVec,
-                         paddedRepShape, outOrd, outVals, smemBase);
+                         paddedRepShape, outOrd, outVals, smemBase, swizzleVec);
       } else {
         assert(0 && "ConvertLayout with output layout not implemented");
         return failure();
@@ -528,6 +605,29 @@ private:
     return success();
   }
 
+  // shared -> blocked.
+  // Used for the tensors loaded from the buffers of the frontend, which do
+  // not feed dots.
+  LogicalResult
+  lowerSharedToDistributed(triton::gpu::ConvertLayoutOp op, OpAdaptor adaptor,
+                           ConversionPatternRewriter &rewriter) const {
+    auto loc = op.getLoc();
+    Value src = op.getSrc();
+    Value dst = op.getResult();
+    auto dstTy = dst.getType().cast<RankedTensorType>();
+    assert(dstTy.getShape().size() == 2 &&
+           "Unexpected rank of ConvertLayout(shared->blocked)");
+    auto smemObj =
+        getSharedMemoryObjectFromStruct(loc, adaptor.getSrc(), rewriter);
+    auto elemTy = getTypeConverter()->convertType(dstTy.getElementType());
+    auto outVals =
+        loadSharedToDistributed(dst, src, smemObj, elemTy, loc, rewriter);
+    Value result =
+        getTypeConverter()->packLLElements(loc, outVals, rewriter, dstTy);
+    rewriter.replaceOp(op, result);
+    return success();
+  }
+
   // shared -> mma_operand
   LogicalResult
   lowerSharedToDotOperand(triton::gpu::ConvertLayoutOp op, OpAdaptor adaptor,
@@ -571,6 +671,77 @@ private:
     return success();
   }
 
+  // Gathers the registers of $a from the accumulator values of `vals` for
+  // 8-bit and 32-bit elements: the quad of threads holding a row of the
+  // accumulators holds it in $a too, but with the columns of a thread spread
+  // over the other threads of the quad. Returns the a0, a1, a2, a3 registers
+  // of each (m, k) tile, as `mma` reads them.
+  SmallVector<Value>
+  shuffleMmaToDotOperand(Location loc, ConversionPatternRewriter &rewriter,
+                         ArrayRef<Value> vals, RankedTensorType srcTy,
+                         unsigned bitwidth) const {
+    // each n8 tile of the accumulators holds, per thread t of a quad, the
+    // columns 2t and 2t+1 of the rows g (c0, c1) and g+8 (c2, c3)
+    unsigned nTiles = srcTy.getShape()[1] / 8;
+    unsigned mTiles = vals.size() / (4 * nTiles);
+    auto acc = [&](unsigned m, unsigned n, unsigned q) {
+      return vals[(m * nTiles + n) * 4 + q];
+    };
+    Value laneId = urem(getThreadId(rewriter, loc), i32_val(32));
+    Value quadId = urem(laneId, i32_val(4));
+    Value quadBase = sub(laneId, quadId);
+    SmallVector<Value> regs;
+    if (bitwidth == 32) {
+      Value isOdd = icmp_eq(urem(quadId, i32_val(2)), i32_val(1));
+      // register r = 2h + rowHalf of thread t holds the column t + 4h of a
+      // k8 tile: element t % 2 of thread 2h + t / 2
+      for (unsigned m = 0; m < mTiles; ++m)
+        for (unsigned k = 0; k < nTiles; ++k)
+          for (unsigned r = 0; r < 4; ++r) {
+            unsigned h = r / 2, rowHalf = r % 2;
+            Value srcLane = add(add(quadBase, i32_val(2 * h)),
+                                udiv(quadId, i32_val(2)));
+            Value v0 = shflIdxSync(
+                loc, rewriter, bitcast(acc(m, k, 2 * rowHalf), i32_ty),
+                srcLane);
+            Value v1 = shflIdxSync(
+                loc, rewriter, bitcast(acc(m, k, 2 * rowHalf + 1), i32_ty),
+                srcLane);
+            regs.push_back(select(isOdd, v1, v0));
+          }
+      return regs;
+    }
+    assert(bitwidth == 8);
+    // register r = 2h + rowHalf of thread t holds the columns 4t..4t+3 of
+    // the half h of a k32 tile: the columns of the n8 tile 2h + t / 2 held
+    // by the threads 2 (t % 2) and 2 (t % 2) + 1
+    Value evenLane = add(quadBase, mul(urem(quadId, i32_val(2)), i32_val(2)));
+    Value oddLane = add(evenLane, i32_val(1));
+    Value shift = mul(udiv(quadId, i32_val(2)), i32_val(16));
+    auto pair = [&](unsigned m, unsigned n, unsigned rowHalf) {
+      Value lo = zext(i32_ty, acc(m, n, 2 * rowHalf));
+      Value hi = zext(i32_ty, acc(m, n, 2 * rowHalf + 1));
+      return or_(i32_ty, lo, shl(i32_ty, hi, i32_val(8)));
+    };
+    for (unsigned m = 0; m < mTiles; ++m)
+      for (unsigned k = 0; k < nTiles / 4; ++k)
+        for (unsigned r = 0; r < 4; ++r) {
+          unsigned h = r / 2, rowHalf = r % 2;
+          unsigned n = 4 * k + 2 * h;
+          // the two n8 tiles a thread may ask for, in the halves of a word
+          Value word = or_(i32_ty, pair(m, n, rowHalf),
+                           shl(i32_ty, pair(m, n + 1, rowHalf), i32_val(16)));
+          Value lo = lshr(i32_ty, shflIdxSync(loc, rewriter, word, evenLane),
+                          shift);
+          Value hi = lshr(i32_ty, shflIdxSync(loc, rewriter, word, oddLane),
+                          shift);
+          lo = and_(i32_ty, lo, i32_val(0xffff));
+          hi = shl(i32_ty, and_(i32_ty, hi, i32_val(0xffff)), i32_val(16));
+          regs.push_back(or_(i32_ty, lo, hi));
+        }
+    return regs;
+  }
+
   // mma -> dot_operand
   LogicalResult
   lowerMmaToDotOperand(triton::gpu::ConvertLayoutOp op, OpAdaptor adaptor,
@@ -588,12 +759,14 @@ private:
       // for the destination type, we need to pack values together
       // so they can be consumed by tensor core operations
       SmallVector<Value> vecVals;
-      SmallVector<Type> types;
-      // For some reasons, LLVM's NVPTX backend inserts unnecessary (?) integer
-      // instructions to pack & unpack sub-word integers. A workaround is to
-      // store the results of ldmatrix in i32
       auto elemSize = elemTy.getIntOrFloatBitWidth();
-      if (auto intTy = elemTy.dyn_cast<IntegerType>() && elemSize <= 16) {
+      if (elemSize != 16) {
+        vecVals =
+            shuffleMmaToDotOperand(loc, rewriter, vals, srcTy, elemSize);
+      } else if (elemTy.isa<IntegerType>()) {
+        // For some reasons, LLVM's NVPTX backend inserts unnecessary (?)
+        // integer instructions to pack & unpack sub-word integers. A
+        // workaround is to store the results of ldmatrix in i32
         auto fold = 32 / elemSize;
         for (unsigned i = 0; i < elems; i += fold) {
           Value val = i32_val(0);
@@ -604,12 +777,9 @@ private:
           }
           vecVals.push_back(val);
         }
-        elems = elems / (32 / elemSize);
-        types = SmallVector<Type>(elems, i32_ty);
       } else {
         unsigned vecSize = std::max<unsigned>(32 / elemSize, 1);
         Type vecTy = vec_ty(elemTy, vecSize);
-        types = SmallVector<Type>(elems / vecSize, vecTy);
         for (unsigned i = 0; i < elems; i += vecSize) {
           Value packed = rewriter.create<LLVM::UndefOp>(loc, vecTy);
           for (unsigned j = 0; j < vecSize; j++)
@@ -639,6 +809,16 @@ private:
     return failure();
   }
 
+  // Whether every user of a shared -> dot_operand conversion is a dot reading
+  // the operand in shared memory with wgmma.
+  static bool isReadByWGMMA(triton::gpu::ConvertLayoutOp op) {
+    return !op->use_empty() &&
+           llvm::all_of(op->getUsers(), [&](Operation *user) {
+             auto dot = dyn_cast<triton::DotOp>(user);
+             return dot && getWGMMAOperandB(dot) == op;
+           });
+  }
+
   // shared -> dot_operand if the result layout is mma
   Value lowerSharedToDotOperandMMA(
       triton::gpu::ConvertLayoutOp op, OpAdaptor adaptor,
@@ -652,8 +832,15 @@ private:
         getSharedMemoryObjectFromStruct(loc, adaptor.getSrc(), rewriter);
     Value res;
 
-    if (!isOuter && mmaLayout.isAmpere()) { // tensor core v2
+    if (!isOuter && mmaLayout.isHopper() && dotOperandLayout.getOpIdx() == 1 &&
+        isReadByWGMMA(op)) { // tensor core v3
+      // wgmma reads $b from shared memory through a descriptor, so the
+      // registers of the operand are never used.
+      res = rewriter.create<LLVM::UndefOp>(
+          loc, getTypeConverter()->convertType(dst.getType()));
 
+    } else if (!isOuter && (mmaLayout.isAmpere() || mmaLayout.isHopper())) {
+      // tensor core v2, also used by Hopper for the operands in registers
       res = SharedToDotOperandMMAv2::convertLayout(
           dotOperandLayout.getOpIdx(), rewriter, loc, src, dotOperandLayout,
           smemObj, getTypeConverter(), tid_val());
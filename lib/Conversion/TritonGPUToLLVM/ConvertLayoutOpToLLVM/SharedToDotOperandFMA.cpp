@@ -68,6 +68,30 @@ Value getStructFromValueTable(ArrayRef<Value> vals,
   return typeConverter->packLLElements(loc, elems, rewriter, structTy);
 }
 
+// Returns the width of the vectors in which a thread loads its sizePerThread
+// elements of an operand, which are contiguous when the operand is stored
+// along them. The vectors are at most 128 bits wide.
+static int getFMALoadVec(bool isContig, int sizePerThread, Type elemTy) {
+  if (!isContig)
+    return 1;
+  int maxVec = std::max<int>(128 / elemTy.getIntOrFloatBitWidth(), 1);
+  return std::min(sizePerThread, maxVec);
+}
+
+// Loads `vec` contiguous elements at `ptr` and appends them to `vals`.
+static void loadElements(Value ptr, Type elemTy, int vec,
+                         SmallVectorImpl<Value> &vals,
+                         ConversionPatternRewriter &rewriter, Location loc) {
+  if (vec == 1) {
+    vals.push_back(load(ptr));
+    return;
+  }
+  Type vecTy = vec_ty(elemTy, vec);
+  Value vecVal = load(bitcast(ptr, ptr_ty(vecTy, 3)));
+  for (int i = 0; i < vec; ++i)
+    vals.push_back(extract_element(elemTy, vecVal, i32_val(i)));
+}
+
 ValueTable getValueTableFromStruct(Value val, int K, int n0, int shapePerCTA,
                                    int sizePerThread,
                                    ConversionPatternRewriter &rewriter,
@@ -136,15 +160,15 @@ Value loadAFMA(Value A, Value llA, BlockedEncodingAttr dLayout, Value thread,
 
   int mShapePerCTA = getShapePerCTAForMN(dLayout, true /*isM*/);
   int mSizePerThread = getSizePerThreadForMN(dLayout, true /*isM*/);
+  int aVec = getFMALoadVec(!isARow, mSizePerThread, elemTy);
 
   for (unsigned k = 0; k < K; ++k)
     for (unsigned m = 0; m < M; m += mShapePerCTA)
-      for (unsigned mm = 0; mm < mSizePerThread; ++mm) {
+      for (unsigned mm = 0; mm < mSizePerThread; mm += aVec) {
         Value offset =
             add(mul(i32_val(m + mm), strideAM), mul(i32_val(k), strideAK));
         Value pa = gep(ptrTy, aPtrs[0], offset);
-        Value va = load(pa);
-        vas.emplace_back(va);
+        loadElements(pa, elemTy, aVec, vas, rewriter, loc);
       }
 
   return getStructFromValueTable(vas, rewriter, loc, typeConverter, elemTy);
@@ -200,15 +224,15 @@ Value loadBFMA(Value B, Value llB, BlockedEncodingAttr dLayout, Value thread,
 
   int nShapePerCTA = getShapePerCTAForMN(dLayout, false /*isM*/);
   int nSizePerThread = getSizePerThreadForMN(dLayout, false /*isM*/);
+  int bVec = getFMALoadVec(isBRow, nSizePerThread, elemTy);
 
   for (unsigned k = 0; k < K; ++k)
     for (unsigned n = 0; n < N; n += nShapePerCTA)
-      for (unsigned nn = 0; nn < nSizePerThread; ++nn) {
+      for (unsigned nn = 0; nn < nSizePerThread; nn += bVec) {
         Value offset =
             add(mul(i32_val(n + nn), strideBN), mul(i32_val(k), strideBK));
         Value pb = gep(ptrTy, bPtrs[0], offset);
-        Value vb = load(pb);
-        vbs.emplace_back(vb);
+        loadElements(pb, elemTy, bVec, vbs, rewriter, loc);
       }
 
   return getStructFromValueTable(vbs, rewriter, loc, typeConverter, elemTy);
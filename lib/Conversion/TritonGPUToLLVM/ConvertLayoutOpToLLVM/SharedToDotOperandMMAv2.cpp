@@ -243,6 +243,29 @@ SmallVector<Value> MMA16816SmemLoader::computeLdsMatOffs(Value warpOff,
   return offs;
 }
 
+// Packs the low bytes of 4 i32 values into an i32, the first one in the
+// least significant byte. The NVPTX backend expands the insertions into
+// vectors of i8 into masks and shifts, whereas `prmt` picks bytes directly.
+static Value packBytes(ArrayRef<Value> bytes,
+                       ConversionPatternRewriter &rewriter, Location loc) {
+  assert(bytes.size() == 4 && "expected 4 bytes");
+  auto *ptxAsm = "{                            \n"
+                 ".reg .b32 lo, hi;            \n"
+                 "prmt.b32 lo, $1, $2, 0x0040; \n" // lo = (b1, b0)
+                 "prmt.b32 hi, $3, $4, 0x0040; \n" // hi = (b3, b2)
+                 "prmt.b32 $0, lo, hi, 0x5410; \n" // (b3, b2, b1, b0)
+                 "}";
+  PTXBuilder builder;
+  auto &ptxOp = *builder.create(ptxAsm);
+  auto *o = builder.newOperand("=r");
+  auto *i0 = builder.newOperand(bytes[0], "r");
+  auto *i1 = builder.newOperand(bytes[1], "r");
+  auto *i2 = builder.newOperand(bytes[2], "r");
+  auto *i3 = builder.newOperand(bytes[3], "r");
+  ptxOp({o, i0, i1, i2, i3}, /*onlyAttachMLIRArgs=*/true);
+  return builder.launch(rewriter, loc, i32_ty, false);
+}
+
 std::tuple<Value, Value, Value, Value>
 MMA16816SmemLoader::loadX4(int mat0, int mat1, ArrayRef<Value> offs,
                            ArrayRef<Value> ptrs, Type matTy,
@@ -331,6 +354,18 @@ MMA16816SmemLoader::loadX4(int mat0, int mat1, ArrayRef<Value> offs,
         (needTrans && kOrder == 1) || (!needTrans && kOrder == 0);
     if (isActualTrans)
       std::swap(vptrs[1], vptrs[2]);
+    // The 4 bytes of each 32-bit value of a transposed 8-bit operand come
+    // from 4 rows, so they are loaded one by one and packed with prmt.
+    if (needTrans && elemBytes == 1) {
+      std::array<Value, 4> retElems;
+      for (int idx = 0; idx < 4; ++idx) {
+        SmallVector<Value> bytes;
+        for (int e = 0; e < vecWidth; ++e)
+          bytes.push_back(zext(i32_ty, load(vptrs[idx][e])));
+        retElems[idx] = packBytes(bytes, rewriter, loc);
+      }
+      return {retElems[0], retElems[1], retElems[2], retElems[3]};
+    }
     // pack loaded vectors into 4 32-bit values
     int inc = needTrans ? 1 : kWidth;
     VectorType packedTy = vec_ty(int_ty(8 * elemBytes), inc);
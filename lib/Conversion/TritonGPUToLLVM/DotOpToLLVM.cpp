@@ -9,7 +9,7 @@ using ::mlir::triton::gpu::MmaEncodingAttr;
 
 LogicalResult convertFMADot(triton::DotOp op, triton::DotOp::Adaptor adaptor,
                             TritonGPUToLLVMTypeConverter *typeConverter,
-                            ConversionPatternRewriter &rewriter);
+                            ConversionPatternRewriter &rewriter, bool isROCM);
 
 LogicalResult convertMMA884(triton::DotOp op, triton::DotOp::Adaptor adaptor,
                             TritonGPUToLLVMTypeConverter *typeConverter,
@@ -19,9 +19,23 @@ LogicalResult convertMMA16816(triton::DotOp op, triton::DotOp::Adaptor adaptor,
                               TritonGPUToLLVMTypeConverter *typeConverter,
                               ConversionPatternRewriter &rewriter);
 
+LogicalResult convertWGMMA(triton::DotOp op, triton::DotOp::Adaptor adaptor,
+                           TritonGPUToLLVMTypeConverter *typeConverter,
+                           ConversionPatternRewriter &rewriter);
+
+LogicalResult
+convertSparseMMA16832(triton::SparseDotOp op,
+                      triton::SparseDotOp::Adaptor adaptor, Value thread,
+                      TritonGPUToLLVMTypeConverter *typeConverter,
+                      ConversionPatternRewriter &rewriter);
+
 struct DotOpConversion : public ConvertTritonGPUOpToLLVMPattern<triton::DotOp> {
-  using ConvertTritonGPUOpToLLVMPattern<
-      triton::DotOp>::ConvertTritonGPUOpToLLVMPattern;
+  DotOpConversion(TritonGPUToLLVMTypeConverter &typeConverter,
+                  ModuleAllocation &allocation, bool isROCM,
+                  PatternBenefit benefit)
+      : ConvertTritonGPUOpToLLVMPattern<triton::DotOp>(typeConverter,
+                                                       allocation, benefit),
+        isROCM(isROCM) {}
 
   LogicalResult
   matchAndRewrite(triton::DotOp op, OpAdaptor adaptor,
@@ -45,25 +59,59 @@ struct DotOpConversion : public ConvertTritonGPUOpToLLVMPattern<triton::DotOp> {
         return convertMMA884(op, adaptor, getTypeConverter(), rewriter);
       if (mmaLayout.isAmpere())
         return convertMMA16816(op, adaptor, getTypeConverter(), rewriter);
+      if (mmaLayout.isHopper()) {
+        if (getWGMMAOperandB(op))
+          return convertWGMMA(op, adaptor, getTypeConverter(), rewriter);
+        // $b was loaded into registers with the Ampere layout
+        return convertMMA16816(op, adaptor, getTypeConverter(), rewriter);
+      }
 
       llvm::report_fatal_error(
           "Unsupported MMA kind found when converting DotOp to LLVM.");
     }
 
+    // The dots of AMD GPUs keep blocked layouts and take the FMA path, with
+    // v_dot2 for f16 x f16 -> f32.
     if (D.getType()
             .cast<RankedTensorType>()
             .getEncoding()
             .isa<BlockedEncodingAttr>())
-      return convertFMADot(op, adaptor, getTypeConverter(), rewriter);
+      return convertFMADot(op, adaptor, getTypeConverter(), rewriter, isROCM);
 
     llvm::report_fatal_error(
         "Unsupported DotOp found when converting TritonGPU to LLVM.");
   }
+
+private:
+  bool isROCM;
+};
+
+struct SparseDotOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::SparseDotOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::SparseDotOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::SparseDotOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto mmaLayout = op.getD()
+                         .getType()
+                         .cast<RankedTensorType>()
+                         .getEncoding()
+                         .dyn_cast<MmaEncodingAttr>();
+    if (!mmaLayout || !mmaLayout.isAmpere())
+      llvm::report_fatal_error(
+          "Sparse dots are only lowered from the layouts of MMA v2.");
+    Value thread = getThreadId(rewriter, op.getLoc());
+    return convertSparseMMA16832(op, adaptor, thread, getTypeConverter(),
+                                 rewriter);
+  }
 };
 
 void populateDotOpToLLVMPatterns(TritonGPUToLLVMTypeConverter &typeConverter,
                                  RewritePatternSet &patterns,
-                                 ModuleAllocation &allocation,
+                                 ModuleAllocation &allocation, bool isROCM,
                                  PatternBenefit benefit) {
-  patterns.add<DotOpConversion>(typeConverter, allocation, benefit);
+  patterns.add<DotOpConversion>(typeConverter, allocation, isROCM, benefit);
+  patterns.add<SparseDotOpConversion>(typeConverter, allocation, benefit);
 }
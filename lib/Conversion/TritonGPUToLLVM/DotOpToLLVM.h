@@ -8,7 +8,7 @@ using namespace mlir::triton;
 
 void populateDotOpToLLVMPatterns(TritonGPUToLLVMTypeConverter &typeConverter,
                                  RewritePatternSet &patterns,
-                                 ModuleAllocation &allocation,
+                                 ModuleAllocation &allocation, bool isROCM,
                                  PatternBenefit benefit);
 
 #endif
@@ -25,9 +25,31 @@ static ValueTableFMA getValueTableFromStructFMA(
   return res;
 }
 
+// Returns the declaration of `llvm.amdgcn.fdot2`, which computes
+// a.x * b.x + a.y * b.y + c for f16 pairs a and b with v_dot2_f32_f16.
+static LLVM::LLVMFuncOp
+getFDot2Declaration(ConversionPatternRewriter &rewriter) {
+  auto moduleOp = rewriter.getBlock()->getParent()->getParentOfType<ModuleOp>();
+  StringRef funcName("llvm.amdgcn.fdot2");
+  Operation *funcOp = moduleOp.lookupSymbol(funcName);
+  if (funcOp)
+    return cast<LLVM::LLVMFuncOp>(*funcOp);
+
+  auto *context = rewriter.getContext();
+  SmallVector<Type> argsType{vec_ty(f16_ty, 2), vec_ty(f16_ty, 2), f32_ty,
+                             i1_ty};
+  auto funcType = LLVM::LLVMFunctionType::get(f32_ty, argsType);
+
+  ConversionPatternRewriter::InsertionGuard guard(rewriter);
+  rewriter.setInsertionPointToStart(moduleOp.getBody());
+  return rewriter.create<LLVM::LLVMFuncOp>(UnknownLoc::get(context), funcName,
+                                           funcType);
+}
+
 LogicalResult convertFMADot(triton::DotOp op, triton::DotOp::Adaptor adaptor,
                             TritonGPUToLLVMTypeConverter *typeConverter,
-                            ConversionPatternRewriter &rewriter) {
+                            ConversionPatternRewriter &rewriter,
+                            bool isROCM) {
   auto *ctx = rewriter.getContext();
   auto loc = op.getLoc();
 
@@ -78,19 +100,91 @@ LogicalResult convertFMADot(triton::DotOp op, triton::DotOp::Adaptor adaptor,
   SmallVector<Value> ret = cc;
   bool isCRow = order[0] == 1;
 
-  for (unsigned k = 0; k < K; k++) {
-    for (unsigned m = 0; m < M; m += mShapePerCTA)
-      for (unsigned n = 0; n < N; n += nShapePerCTA)
-        for (unsigned mm = 0; mm < mSizePerThread; ++mm)
-          for (unsigned nn = 0; nn < nSizePerThread; ++nn) {
-            int mIdx = m / mShapePerCTA * mSizePerThread + mm;
-            int nIdx = n / nShapePerCTA * nSizePerThread + nn;
-
-            int z = isCRow ? mIdx * N / nShapePerCTA * mSizePerThread + nIdx
-                           : nIdx * M / mShapePerCTA * nSizePerThread + mIdx;
-            ret[z] = rewriter.create<LLVM::FMulAddOp>(loc, has[{m + mm, k}],
-                                                      hbs[{n + nn, k}], ret[z]);
-          }
+  // Mixed precision dots accumulate in the type of $c. On AMD GPUs, two
+  // steps of a f16 dot with a f32 accumulator take a single v_dot2.
+  Type aElemTy = aTensorTy.getElementType();
+  Type dElemTy = dTensorTy.getElementType();
+  bool isDot2 = isROCM && aElemTy.isF16() &&
+                bTensorTy.getElementType().isF16() && dElemTy.isF32();
+  Type dLLElemTy = typeConverter->convertType(dElemTy);
+  auto extend = [&](Value val) -> Value {
+    if (val.getType() == dLLElemTy)
+      return val;
+    return fpext(dLLElemTy, val);
+  };
+  auto pack = [&](Value lo, Value hi) -> Value {
+    Type vecTy = vec_ty(f16_ty, 2);
+    Value vec = undef(vecTy);
+    vec = insert_element(vecTy, vec, lo, i32_val(0));
+    return insert_element(vecTy, vec, hi, i32_val(1));
+  };
+  LLVM::LLVMFuncOp fdot2 = isDot2 ? getFDot2Declaration(rewriter) : nullptr;
+
+  auto getAccIdx = [&](int mIdx, int nIdx) -> int {
+    return isCRow ? mIdx * N / nShapePerCTA * mSizePerThread + nIdx
+                  : nIdx * M / mShapePerCTA * nSizePerThread + mIdx;
+  };
+
+  // The f16 dots that accumulate in f16 update the accumulators of a thread
+  // by pairs of adjacent elements with packed fma (fma.rn.f16x2 on NVIDIA
+  // GPUs, v_pk_fma_f16 on AMD GPUs). The pairs stay packed along K.
+  bool isF16x2 = aElemTy.isF16() && bTensorTy.getElementType().isF16() &&
+                 dElemTy.isF16() &&
+                 (nSizePerThread % 2 == 0 || mSizePerThread % 2 == 0);
+  if (isF16x2) {
+    bool alongN = nSizePerThread % 2 == 0;
+    // Calls fn(m, n, z0, z1) for each pair of accumulators, the elements
+    // (m, n) and (m, n + 1) when paired along N, (m + 1, n) otherwise.
+    auto forEachPair = [&](auto fn) {
+      for (unsigned m = 0; m < M; m += mShapePerCTA)
+        for (unsigned n = 0; n < N; n += nShapePerCTA)
+          for (unsigned mm = 0; mm < mSizePerThread; mm += alongN ? 1 : 2)
+            for (unsigned nn = 0; nn < nSizePerThread; nn += alongN ? 2 : 1) {
+              int mIdx = m / mShapePerCTA * mSizePerThread + mm;
+              int nIdx = n / nShapePerCTA * nSizePerThread + nn;
+              int z1 = alongN ? getAccIdx(mIdx, nIdx + 1)
+                              : getAccIdx(mIdx + 1, nIdx);
+              fn(m + mm, n + nn, getAccIdx(mIdx, nIdx), z1);
+            }
+    };
+    DenseMap<int, Value> acc;
+    forEachPair([&](int m, int n, int z0, int z1) {
+      acc[z0] = pack(ret[z0], ret[z1]);
+    });
+    for (unsigned k = 0; k < K; ++k)
+      forEachPair([&](int m, int n, int z0, int z1) {
+        Value a = has[{m, k}], b = hbs[{n, k}];
+        Value va = alongN ? pack(a, a) : pack(a, has[{m + 1, k}]);
+        Value vb = alongN ? pack(b, hbs[{n + 1, k}]) : pack(b, b);
+        acc[z0] = rewriter.create<LLVM::FMulAddOp>(loc, va, vb, acc[z0]);
+      });
+    forEachPair([&](int m, int n, int z0, int z1) {
+      ret[z0] = extract_element(f16_ty, acc[z0], i32_val(0));
+      ret[z1] = extract_element(f16_ty, acc[z0], i32_val(1));
+    });
+  } else {
+    for (unsigned k = 0; k < K; k += isDot2 && k + 1 < K ? 2 : 1) {
+      bool isPair = isDot2 && k + 1 < K;
+      for (unsigned m = 0; m < M; m += mShapePerCTA)
+        for (unsigned n = 0; n < N; n += nShapePerCTA)
+          for (unsigned mm = 0; mm < mSizePerThread; ++mm)
+            for (unsigned nn = 0; nn < nSizePerThread; ++nn) {
+              int mIdx = m / mShapePerCTA * mSizePerThread + mm;
+              int nIdx = n / nShapePerCTA * nSizePerThread + nn;
+
+              int z = getAccIdx(mIdx, nIdx);
+              if (isPair) {
+                Value a = pack(has[{m + mm, k}], has[{m + mm, k + 1}]);
+                Value b = pack(hbs[{n + nn, k}], hbs[{n + nn, k + 1}]);
+                SmallVector<Value> operands{a, b, ret[z], int_val(1, 0)};
+                ret[z] = call(fdot2, operands).getResult();
+                continue;
+              }
+              ret[z] = rewriter.create<LLVM::FMulAddOp>(
+                  loc, extend(has[{m + mm, k}]), extend(hbs[{n + nn, k}]),
+                  ret[z]);
+            }
+    }
   }
 
   auto res = typeConverter->packLLElements(loc, ret, rewriter, dTensorTy);
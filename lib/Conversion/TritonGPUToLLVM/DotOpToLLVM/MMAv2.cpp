@@ -289,3 +289,117 @@ LogicalResult convertMMA16816(triton::DotOp op, triton::DotOp::Adaptor adaptor,
   return convertDot(typeConverter, rewriter, op.getLoc(), A, B, C, op.getD(),
                     loadedA, loadedB, loadedC, op, adaptor);
 }
+
+// Loads the metadata of the rows of $a that the thread passes to the tile
+// (m, k) of mma.sp. With the sparsity selector 0, the threads 0 and 1 of each
+// quad pass the 32 bits of the rows groupID and groupID + 8, which are the
+// two i16 elements of the 32 columns of the tile.
+static ValueTableV2 loadSparseMeta(Value meta, Value llMeta, Value thread,
+                                   MmaEncodingAttr mmaLayout, int repM,
+                                   int repK, Location loc,
+                                   ConversionPatternRewriter &rewriter) {
+  auto metaShape = meta.getType().cast<RankedTensorType>().getShape();
+  auto smemObj = getSharedMemoryObjectFromStruct(loc, llMeta, rewriter);
+  unsigned wpt = mmaLayout.getWarpsPerCTA()[0];
+  unsigned rowTiles = std::max<unsigned>(metaShape[0] / 16, 1);
+  Value warp = udiv(thread, i32_val(32));
+  Value lane = urem(thread, i32_val(32));
+  Value warpM = urem(urem(warp, i32_val(wpt)), i32_val(rowTiles));
+  unsigned wptM = std::min(wpt, rowTiles);
+  Value rowInTile = add(udiv(lane, i32_val(4)),
+                        mul(urem(lane, i32_val(2)), i32_val(8)));
+  Value rowBase = add(rowInTile, mul(warpM, i32_val(16)));
+
+  ValueTableV2 vals;
+  for (int m = 0; m < repM; ++m) {
+    Value row = add(rowBase, i32_val(m * 16 * wptM));
+    for (int k = 0; k < repK; ++k) {
+      Value offset = add(mul(row, smemObj.strides[0]),
+                         mul(i32_val(2 * k), smemObj.strides[1]));
+      Value ptr = gep(ptr_ty(i16_ty, 3), smemObj.base, offset);
+      vals[{m, k}] = load(bitcast(ptr, ptr_ty(i32_ty, 3)));
+    }
+  }
+  return vals;
+}
+
+// Convert to mma.sp.m16n8k32: each tile of $a holds the 16 values of 32
+// columns of the dense matrix, so it is paired with two k-tiles of $b.
+LogicalResult
+convertSparseMMA16832(triton::SparseDotOp op,
+                      triton::SparseDotOp::Adaptor adaptor, Value thread,
+                      TritonGPUToLLVMTypeConverter *typeConverter,
+                      ConversionPatternRewriter &rewriter) {
+  auto loc = op.getLoc();
+  MLIRContext *ctx = op.getContext();
+  auto aTensorTy = op.getA().getType().cast<RankedTensorType>();
+  auto bTensorTy = op.getB().getType().cast<RankedTensorType>();
+  auto dTensorTy = op.getD().getType().cast<RankedTensorType>();
+  auto mmaLayout = dTensorTy.getEncoding().cast<MmaEncodingAttr>();
+  Type elemTy = aTensorTy.getElementType();
+  assert((elemTy.isF16() || elemTy.isBF16()) &&
+         dTensorTy.getElementType().isF32() &&
+         "sparse dots are only supported for f16 and bf16 into f32");
+
+  int bitwidth = elemTy.getIntOrFloatBitWidth();
+  auto repA =
+      aTensorTy.getEncoding().cast<DotOperandEncodingAttr>().getMMAv2Rep(
+          aTensorTy.getShape(), bitwidth);
+  auto repB =
+      bTensorTy.getEncoding().cast<DotOperandEncodingAttr>().getMMAv2Rep(
+          bTensorTy.getShape(), bitwidth);
+  assert(2 * repA[1] == repB[0]);
+  int repM = repA[0], repN = repB[1], repK = repA[1];
+
+  auto ha = getValuesFromDotOperandLayoutStruct(
+      typeConverter, loc, rewriter, adaptor.getA(), repM, repK, aTensorTy);
+  auto hb = getValuesFromDotOperandLayoutStruct(
+      typeConverter, loc, rewriter, adaptor.getB(), std::max(repN / 2, 1),
+      2 * repK, bTensorTy);
+  auto he = loadSparseMeta(op.getAMeta(), adaptor.getAMeta(), thread,
+                           mmaLayout, repM, repK, loc, rewriter);
+  auto fc = typeConverter->unpackLLElements(loc, adaptor.getC(), rewriter,
+                                            dTensorTy);
+
+  std::string instr = std::string("mma.sp.sync.aligned.m16n8k32.row.col.f32.") +
+                      (elemTy.isF16() ? "f16.f16" : "bf16.bf16") + ".f32";
+  unsigned colsPerThread = repN * 2;
+  Type retTy =
+      LLVM::LLVMStructType::getLiteral(ctx, SmallVector<Type>(4, f32_ty));
+  for (int k = 0; k < repK; ++k)
+    for (int m = 0; m < repM; ++m)
+      for (int n = 0; n < repN; ++n) {
+        PTXBuilder builder;
+        auto &mma = *builder.create(instr);
+        auto retArgs = builder.newListOperand(4, "=f");
+        auto aArgs = builder.newListOperand({
+            {ha[{2 * m, 2 * k}], "r"},
+            {ha[{2 * m + 1, 2 * k}], "r"},
+            {ha[{2 * m, 2 * k + 1}], "r"},
+            {ha[{2 * m + 1, 2 * k + 1}], "r"},
+        });
+        auto bArgs = builder.newListOperand({
+            {hb[{n, 4 * k}], "r"},
+            {hb[{n, 4 * k + 1}], "r"},
+            {hb[{n, 4 * k + 2}], "r"},
+            {hb[{n, 4 * k + 3}], "r"},
+        });
+        unsigned cBase = 2 * m * colsPerThread + 4 * n;
+        auto cArgs = builder.newListOperand();
+        for (int i = 0; i < 4; ++i)
+          cArgs->listAppend(
+              builder.newOperand(fc[cBase + i], std::to_string(i)));
+        auto eArg = builder.newOperand(he[{m, k}], "r");
+        auto selector = builder.newConstantOperand(0);
+        mma(retArgs, aArgs, bArgs, cArgs, eArg, selector);
+        Value mmaOut = builder.launch(rewriter, loc, retTy);
+        for (int i = 0; i < 4; ++i)
+          fc[cBase + i] = extract_val(f32_ty, mmaOut, i);
+      }
+
+  Type structTy = LLVM::LLVMStructType::getLiteral(
+      ctx, SmallVector<Type>(fc.size(), f32_ty));
+  Value res = typeConverter->packLLElements(loc, fc, rewriter, structTy);
+  rewriter.replaceOp(op, res);
+  return success();
+}
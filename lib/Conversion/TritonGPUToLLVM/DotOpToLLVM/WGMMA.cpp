@@ -0,0 +1,174 @@
+#include "../DotOpToLLVM.h"
+#include "../Utility.h"
+
+using namespace mlir;
+using namespace mlir::triton;
+
+using ::mlir::triton::gpu::DotOperandEncodingAttr;
+using ::mlir::triton::gpu::MmaEncodingAttr;
+using ::mlir::triton::gpu::SharedEncodingAttr;
+
+using ValueTableV2 = std::map<std::pair<unsigned, unsigned>, Value>;
+
+Value loadC(Value tensor, Value llTensor,
+            TritonGPUToLLVMTypeConverter *typeConverter, Location loc,
+            ConversionPatternRewriter &rewriter);
+
+ValueTableV2 getValuesFromDotOperandLayoutStruct(
+    TritonGPUToLLVMTypeConverter *typeConverter, Location loc,
+    ConversionPatternRewriter &rewriter, Value value, int n0, int n1,
+    RankedTensorType type);
+
+namespace {
+
+// Builds the 64-bit descriptor of the k16 slices of $b in shared memory.
+//
+// The tile is stored as rows of `rowBytes` bytes, swizzled in groups of 8
+// rows, which is the canonical layout wgmma expects for the 32B, 64B and
+// 128B swizzle modes:
+//   bits  0-13: start address >> 4
+//   bits 16-29: leading byte offset >> 4, unused by the swizzled layouts
+//   bits 32-45: stride byte offset >> 4, the distance between groups of 8 rows
+//   bits 62-63: swizzle mode, 1 = 128B, 2 = 64B, 3 = 32B
+struct WGMMADescriptor {
+  WGMMADescriptor(ConversionPatternRewriter &rewriter, Location loc,
+                  Value base, unsigned rowBytes)
+      : rewriter(rewriter), loc(loc) {
+    addr = ptrtoint(i32_ty, base);
+    unsigned swizzle = rowBytes == 128 ? 1 : rowBytes == 64 ? 2 : 3;
+    uint64_t sbo = 8 * rowBytes >> 4;
+    hi = uint64_t(swizzle) << 62 | sbo << 32 | uint64_t(1) << 16;
+  }
+
+  // Descriptor of the slice starting `offset` bytes after the base.
+  Value get(unsigned offset) {
+    Value start = add(addr, i32_val(offset));
+    Value lo = zext(i64_ty, lshr(and_(start, i32_val(0x3FFFF)), i32_val(4)));
+    return or_(lo, int_val(64, hi));
+  }
+
+private:
+  ConversionPatternRewriter &rewriter;
+  Location loc;
+  Value addr;
+  uint64_t hi;
+};
+
+} // namespace
+
+// Convert to wgmma.mma_async.m64nNk16 with $a in registers and $b read from
+// shared memory. $a and the accumulators use the Ampere layouts, so each
+// warp of a warpgroup holds the same 16 rows as for mma.m16n8k16 and one
+// instruction covers a 64-row repetition of the layout.
+LogicalResult convertWGMMA(triton::DotOp op, triton::DotOp::Adaptor adaptor,
+                           TritonGPUToLLVMTypeConverter *typeConverter,
+                           ConversionPatternRewriter &rewriter) {
+  auto loc = op.getLoc();
+  auto ctx = op.getContext();
+  auto cvt = getWGMMAOperandB(op);
+  assert(cvt && "$b cannot be read by wgmma");
+
+  auto aTensorTy = op.getA().getType().cast<RankedTensorType>();
+  auto bTensorTy = op.getB().getType().cast<RankedTensorType>();
+  auto dTensorTy = op.getD().getType().cast<RankedTensorType>();
+  auto bSharedTy = cvt.getSrc().getType().cast<RankedTensorType>();
+  auto bLayout = bSharedTy.getEncoding().cast<SharedEncodingAttr>();
+  bool isBF16 = aTensorTy.getElementType().isBF16();
+
+  int bitwidth = aTensorTy.getElementType().getIntOrFloatBitWidth();
+  auto repA =
+      aTensorTy.getEncoding().cast<DotOperandEncodingAttr>().getMMAv2Rep(
+          aTensorTy.getShape(), bitwidth);
+  auto repB =
+      bTensorTy.getEncoding().cast<DotOperandEncodingAttr>().getMMAv2Rep(
+          bTensorTy.getShape(), bitwidth);
+  assert(repA[1] == repB[0]);
+  int repM = repA[0], repN = repB[1], repK = repA[1];
+  unsigned N = bSharedTy.getShape()[1];
+  assert(repN * 8 == N && "wgmma covers all the columns of a warp");
+
+  auto ha = getValuesFromDotOperandLayoutStruct(
+      typeConverter, loc, rewriter, adaptor.getA(), repM, repK, aTensorTy);
+  Value loadedC =
+      loadC(op.getC(), adaptor.getC(), typeConverter, loc, rewriter);
+  auto fc = typeConverter->unpackLLElements(loc, loadedC, rewriter, dTensorTy);
+
+  // K-major tiles step through the k16 slices within a row, N-major tiles
+  // step over 16 rows.
+  auto bSmemObj = getSharedMemoryObjectFromStruct(
+      loc, rewriter.getRemappedValue(cvt.getSrc()), rewriter);
+  bool isNMajor = bLayout.getOrder()[0] == 1;
+  unsigned rowBytes = bSharedTy.getShape()[bLayout.getOrder()[0]] * 2;
+  unsigned kStepBytes = isNMajor ? 16 * rowBytes : 32;
+  WGMMADescriptor descB(rewriter, loc, bSmemObj.base, rowBytes);
+
+  // The shared memory writes of the generic proxy must be visible to the
+  // async proxy of wgmma, and the accumulator registers must be ready.
+  PTXBuilder fenceBuilder;
+  fenceBuilder.create<>("fence.proxy.async.shared::cta")->operator()();
+  fenceBuilder.launch(rewriter, loc, void_ty(ctx));
+  barrier();
+  PTXBuilder wgmmaFenceBuilder;
+  wgmmaFenceBuilder.create<>("wgmma.fence.sync.aligned")->operator()();
+  wgmmaFenceBuilder.launch(rewriter, loc, void_ty(ctx));
+
+  std::string instr = "wgmma.mma_async.sync.aligned.m64n" + std::to_string(N) +
+                      "k16.f32." + (isBF16 ? "bf16.bf16" : "f16.f16");
+  unsigned numAcc = N / 2;
+  Type accTy = struct_ty(SmallVector<Type>(numAcc, f32_ty));
+  auto callWGMMA = [&](unsigned m, unsigned k) {
+    PTXBuilder builder;
+    SmallVector<PTXBuilder::Operand *> oprs;
+    std::string dRegs;
+    for (unsigned i = 0; i < numAcc; ++i) {
+      oprs.push_back(builder.newOperand("=f"));
+      dRegs += (i ? ", $" : "$") + std::to_string(i);
+    }
+    for (unsigned i = 0; i < numAcc; ++i)
+      oprs.push_back(builder.newOperand(fc[m * numAcc + i], std::to_string(i)));
+    Value aRegs[] = {ha[{2 * m, 2 * k}], ha[{2 * m + 1, 2 * k}],
+                     ha[{2 * m, 2 * k + 1}], ha[{2 * m + 1, 2 * k + 1}]};
+    for (Value a : aRegs)
+      oprs.push_back(builder.newOperand(a, "r"));
+    oprs.push_back(builder.newOperand(descB.get(k * kStepBytes), "l"));
+    unsigned aIdx = 2 * numAcc, descIdx = aIdx + 4;
+    std::string ptx = "{ .reg .pred p; setp.ne.b32 p, 1, 0; " + instr + " {" +
+                      dRegs + "}, {";
+    for (unsigned i = 0; i < 4; ++i)
+      ptx += (i ? ", $" : "$") + std::to_string(aIdx + i);
+    ptx += "}, $" + std::to_string(descIdx) + ", p, 1, 1, " +
+           (isNMajor ? "1" : "0") + "; }";
+    auto &wgmma = *builder.create<>(ptx);
+    wgmma(oprs, /*onlyAttachMLIRArgs=*/true);
+    Value res = builder.launch(rewriter, loc, accTy);
+    for (unsigned i = 0; i < numAcc; ++i)
+      fc[m * numAcc + i] = extract_val(f32_ty, res, i);
+  };
+
+  for (int k = 0; k < repK; ++k)
+    for (int m = 0; m < repM; ++m)
+      callWGMMA(m, k);
+
+  // Waiting ties every accumulator, so nothing reads them before the
+  // asynchronous instructions complete.
+  PTXBuilder commitBuilder;
+  commitBuilder.create<>("wgmma.commit_group.sync.aligned")->operator()();
+  commitBuilder.launch(rewriter, loc, void_ty(ctx));
+  PTXBuilder waitBuilder;
+  SmallVector<PTXBuilder::Operand *> waitOprs;
+  for (unsigned i = 0; i < fc.size(); ++i)
+    waitOprs.push_back(waitBuilder.newOperand("=f"));
+  for (unsigned i = 0; i < fc.size(); ++i)
+    waitOprs.push_back(waitBuilder.newOperand(fc[i], std::to_string(i)));
+  auto &wait = *waitBuilder.create<>("wgmma.wait_group.sync.aligned 0;");
+  wait(waitOprs, /*onlyAttachMLIRArgs=*/true);
+  Value waited = waitBuilder.launch(
+      rewriter, loc, struct_ty(SmallVector<Type>(fc.size(), f32_ty)));
+  for (unsigned i = 0; i < fc.size(); ++i)
+    fc[i] = extract_val(f32_ty, waited, i);
+
+  Type structTy = struct_ty(SmallVector<Type>(fc.size(), f32_ty));
+  Value res = typeConverter->packLLElements(loc, fc, rewriter, structTy);
+  rewriter.replaceOp(op, res);
+  return success();
+}
@@ -1,4 +1,5 @@
 #include "ElementwiseOpToLLVM.h"
+#include "mlir/IR/Matchers.h"
 
 using namespace mlir;
 using namespace mlir::triton;
@@ -131,8 +132,12 @@ inline SmallVector<Value> packI32(const SmallVector<Value> &inValues,
 
 struct FpToFpOpConversion
     : public ConvertTritonGPUOpToLLVMPattern<triton::FpToFpOp> {
-  using ConvertTritonGPUOpToLLVMPattern<
-      triton::FpToFpOp>::ConvertTritonGPUOpToLLVMPattern;
+  explicit FpToFpOpConversion(TritonGPUToLLVMTypeConverter &typeConverter,
+                              int computeCapability,
+                              PatternBenefit benefit = 1)
+      : ConvertTritonGPUOpToLLVMPattern<triton::FpToFpOp>(typeConverter,
+                                                          benefit),
+        computeCapability(computeCapability) {}
 
   typedef std::function<SmallVector<Value>(
       Location, ConversionPatternRewriter &, const Value &, const Value &,
@@ -210,6 +215,35 @@ struct FpToFpOpConversion
     return convertFp8x4ToFp16x4(loc, rewriter, ptxAsm, v0, v1, v2, v3);
   }
 
+  // sm_90 converts fp8 pairs natively, subnormals included
+  static SmallVector<Value>
+  convertFp8E4M3x4ToFp16x4Native(Location loc,
+                                 ConversionPatternRewriter &rewriter,
+                                 const Value &v0, const Value &v1,
+                                 const Value &v2, const Value &v3) {
+    auto *ptxAsm = "{                                \n"
+                   ".reg .b16 a<2>;                  \n"
+                   "mov.b32 {a0, a1}, $2;            \n"
+                   "cvt.rn.f16x2.e4m3x2 $0, a0;      \n"
+                   "cvt.rn.f16x2.e4m3x2 $1, a1;      \n"
+                   "}";
+    return convertFp8x4ToFp16x4(loc, rewriter, ptxAsm, v0, v1, v2, v3);
+  }
+
+  static SmallVector<Value>
+  convertFp8E5M2x4ToFp16x4Native(Location loc,
+                                 ConversionPatternRewriter &rewriter,
+                                 const Value &v0, const Value &v1,
+                                 const Value &v2, const Value &v3) {
+    auto *ptxAsm = "{                                \n"
+                   ".reg .b16 a<2>;                  \n"
+                   "mov.b32 {a0, a1}, $2;            \n"
+                   "cvt.rn.f16x2.e5m2x2 $0, a0;      \n"
+                   "cvt.rn.f16x2.e5m2x2 $1, a1;      \n"
+                   "}";
+    return convertFp8x4ToFp16x4(loc, rewriter, ptxAsm, v0, v1, v2, v3);
+  }
+
   /* ------------------ */
   // FP8 -> BF16
   /* ------------------ */
@@ -367,6 +401,34 @@ struct FpToFpOpConversion
     return convertFp16x4ToFp8x4(loc, rewriter, ptxAsm, v0, v1, v2, v3);
   }
 
+  static SmallVector<Value>
+  convertFp16x4ToFp8E4M3x4Native(Location loc,
+                                 ConversionPatternRewriter &rewriter,
+                                 const Value &v0, const Value &v1,
+                                 const Value &v2, const Value &v3) {
+    auto *ptxAsm = "{                                      \n"
+                   ".reg .b16 a<2>;                        \n"
+                   "cvt.rn.satfinite.e4m3x2.f16x2 a0, $1;  \n"
+                   "cvt.rn.satfinite.e4m3x2.f16x2 a1, $2;  \n"
+                   "mov.b32 $0, {a0, a1};                  \n"
+                   "}";
+    return convertFp16x4ToFp8x4(loc, rewriter, ptxAsm, v0, v1, v2, v3);
+  }
+
+  static SmallVector<Value>
+  convertFp16x4ToFp8E5M2x4Native(Location loc,
+                                 ConversionPatternRewriter &rewriter,
+                                 const Value &v0, const Value &v1,
+                                 const Value &v2, const Value &v3) {
+    auto *ptxAsm = "{                                      \n"
+                   ".reg .b16 a<2>;                        \n"
+                   "cvt.rn.satfinite.e5m2x2.f16x2 a0, $1;  \n"
+                   "cvt.rn.satfinite.e5m2x2.f16x2 a1, $2;  \n"
+                   "mov.b32 $0, {a0, a1};                  \n"
+                   "}";
+    return convertFp16x4ToFp8x4(loc, rewriter, ptxAsm, v0, v1, v2, v3);
+  }
+
   /* ------------------ */
   // FP32 -> FP8
   /* ------------------ */
@@ -393,6 +455,57 @@ struct FpToFpOpConversion
     return convertFp16x4ToFp8E5M2x4(loc, rewriter, c0, c1, c2, c3);
   }
 
+  static SmallVector<Value>
+  convertFp32x4ToFp8x4(Location loc, ConversionPatternRewriter &rewriter,
+                       const char *ptxAsm, const Value &v0, const Value &v1,
+                       const Value &v2, const Value &v3) {
+    PTXBuilder builder;
+    auto &ptxOp = *builder.create(ptxAsm);
+
+    auto *o = builder.newOperand("=r");
+    auto *i0 = builder.newOperand(v0, "r");
+    auto *i1 = builder.newOperand(v1, "r");
+    auto *i2 = builder.newOperand(v2, "r");
+    auto *i3 = builder.newOperand(v3, "r");
+    ptxOp({o, i0, i1, i2, i3}, /*onlyAttachMLIRArgs=*/true);
+
+    auto fp8x4VecTy = vec_ty(i8_ty, 4);
+    auto fp8x4Vec = builder.launch(rewriter, loc, fp8x4VecTy, false);
+    return {extract_element(i8_ty, fp8x4Vec, i32_val(0)),
+            extract_element(i8_ty, fp8x4Vec, i32_val(1)),
+            extract_element(i8_ty, fp8x4Vec, i32_val(2)),
+            extract_element(i8_ty, fp8x4Vec, i32_val(3))};
+  }
+
+  // The first source of cvt.*x2.f32 goes to the upper half of the result
+  static SmallVector<Value>
+  convertFp32x4ToFp8E4M3x4Native(Location loc,
+                                 ConversionPatternRewriter &rewriter,
+                                 const Value &v0, const Value &v1,
+                                 const Value &v2, const Value &v3) {
+    auto *ptxAsm = "{                                      \n"
+                   ".reg .b16 a<2>;                        \n"
+                   "cvt.rn.satfinite.e4m3x2.f32 a0, $2, $1;\n"
+                   "cvt.rn.satfinite.e4m3x2.f32 a1, $4, $3;\n"
+                   "mov.b32 $0, {a0, a1};                  \n"
+                   "}";
+    return convertFp32x4ToFp8x4(loc, rewriter, ptxAsm, v0, v1, v2, v3);
+  }
+
+  static SmallVector<Value>
+  convertFp32x4ToFp8E5M2x4Native(Location loc,
+                                 ConversionPatternRewriter &rewriter,
+                                 const Value &v0, const Value &v1,
+                                 const Value &v2, const Value &v3) {
+    auto *ptxAsm = "{                                      \n"
+                   ".reg .b16 a<2>;                        \n"
+                   "cvt.rn.satfinite.e5m2x2.f32 a0, $2, $1;\n"
+                   "cvt.rn.satfinite.e5m2x2.f32 a1, $4, $3;\n"
+                   "mov.b32 $0, {a0, a1};                  \n"
+                   "}";
+    return convertFp32x4ToFp8x4(loc, rewriter, ptxAsm, v0, v1, v2, v3);
+  }
+
   /* ------------------ */
   // BF16 -> FP8
   /* ------------------ */
@@ -549,6 +662,32 @@ struct FpToFpOpConversion
             rewriter.create<LLVM::FPExtOp>(loc, f32_ty, fp16Values[3])};
   }
 
+  static SmallVector<Value>
+  convertFp8E4M3x4ToFp32x4Native(Location loc,
+                                 ConversionPatternRewriter &rewriter,
+                                 const Value &v0, const Value &v1,
+                                 const Value &v2, const Value &v3) {
+    auto fp16Values =
+        convertFp8E4M3x4ToFp16x4Native(loc, rewriter, v0, v1, v2, v3);
+    return {rewriter.create<LLVM::FPExtOp>(loc, f32_ty, fp16Values[0]),
+            rewriter.create<LLVM::FPExtOp>(loc, f32_ty, fp16Values[1]),
+            rewriter.create<LLVM::FPExtOp>(loc, f32_ty, fp16Values[2]),
+            rewriter.create<LLVM::FPExtOp>(loc, f32_ty, fp16Values[3])};
+  }
+
+  static SmallVector<Value>
+  convertFp8E5M2x4ToFp32x4Native(Location loc,
+                                 ConversionPatternRewriter &rewriter,
+                                 const Value &v0, const Value &v1,
+                                 const Value &v2, const Value &v3) {
+    auto fp16Values =
+        convertFp8E5M2x4ToFp16x4Native(loc, rewriter, v0, v1, v2, v3);
+    return {rewriter.create<LLVM::FPExtOp>(loc, f32_ty, fp16Values[0]),
+            rewriter.create<LLVM::FPExtOp>(loc, f32_ty, fp16Values[1]),
+            rewriter.create<LLVM::FPExtOp>(loc, f32_ty, fp16Values[2]),
+            rewriter.create<LLVM::FPExtOp>(loc, f32_ty, fp16Values[3])};
+  }
+
   //
 
   static SmallVector<Value>
@@ -619,7 +758,72 @@ struct FpToFpOpConversion
     return builder.launch(rewriter, loc, f16_ty, false);
   }
 
+  /* ------------------ */
+  // FP32 x2 -> FP16/BF16 x2 (sm_80+)
+  /* ------------------ */
+
+  static SmallVector<Value>
+  convertFp32x2ToHalfx2(Location loc, ConversionPatternRewriter &rewriter,
+                        const char *ptxAsm, Type halfTy, const Value &v0,
+                        const Value &v1) {
+    PTXBuilder builder;
+    auto &cvt = *builder.create(ptxAsm);
+    auto *res = builder.newOperand("=r");
+    auto *i0 = builder.newOperand(v0, "r");
+    auto *i1 = builder.newOperand(v1, "r");
+    cvt({res, i0, i1}, /*onlyAttachMLIRArgs=*/true);
+    auto halfx2VecTy = vec_ty(halfTy, 2);
+    auto halfx2Vec =
+        bitcast(builder.launch(rewriter, loc, i32_ty, false), halfx2VecTy);
+    return {extract_element(halfTy, halfx2Vec, i32_val(0)),
+            extract_element(halfTy, halfx2Vec, i32_val(1))};
+  }
+
+  // v0 lands in the lower half, which is the first element once unpacked
+  static SmallVector<Value>
+  convertFp32x2ToFp16x2(Location loc, ConversionPatternRewriter &rewriter,
+                        const Value &v0, const Value &v1) {
+    return convertFp32x2ToHalfx2(
+        loc, rewriter, "cvt.rn.f16x2.f32 $0, $2, $1;", f16_ty, v0, v1);
+  }
+
+  static SmallVector<Value>
+  convertFp32x2ToBf16x2(Location loc, ConversionPatternRewriter &rewriter,
+                        const Value &v0, const Value &v1) {
+    // TODO: i16 stands for bf16, see convertFp32ToBf16
+    return convertFp32x2ToHalfx2(
+        loc, rewriter, "cvt.rn.bf16x2.f32 $0, $2, $1;", i16_ty, v0, v1);
+  }
+
+  ConvertorT getNativeConversionFunc(Type srcTy, Type dstTy) const {
+    auto F8E4M3TyID = TypeID::get<mlir::Float8E4M3FNType>();
+    auto F8E5M2TyID = TypeID::get<mlir::Float8E5M2Type>();
+    auto F16TyID = TypeID::get<mlir::Float16Type>();
+    auto F32TyID = TypeID::get<mlir::Float32Type>();
+    static DenseMap<std::pair<TypeID, TypeID>, ConvertorT> convertorMap = {
+        // F8 -> F16
+        {{F8E4M3TyID, F16TyID}, convertFp8E4M3x4ToFp16x4Native},
+        {{F8E5M2TyID, F16TyID}, convertFp8E5M2x4ToFp16x4Native},
+        // F16 -> F8
+        {{F16TyID, F8E4M3TyID}, convertFp16x4ToFp8E4M3x4Native},
+        {{F16TyID, F8E5M2TyID}, convertFp16x4ToFp8E5M2x4Native},
+        // F8 -> F32
+        {{F8E4M3TyID, F32TyID}, convertFp8E4M3x4ToFp32x4Native},
+        {{F8E5M2TyID, F32TyID}, convertFp8E5M2x4ToFp32x4Native},
+        // F32 -> F8
+        {{F32TyID, F8E4M3TyID}, convertFp32x4ToFp8E4M3x4Native},
+        {{F32TyID, F8E5M2TyID}, convertFp32x4ToFp8E5M2x4Native},
+    };
+    std::pair<TypeID, TypeID> key = {srcTy.getTypeID(), dstTy.getTypeID()};
+    return convertorMap.lookup(key);
+  }
+
   ConvertorT getConversionFunc(Type srcTy, Type dstTy) const {
+    // The fp8 cvt instructions need sm_90 (or sm_89 with PTX 8.1, which the
+    // lowering cannot tell from here)
+    if (computeCapability >= 90)
+      if (auto cvtFunc = getNativeConversionFunc(srcTy, dstTy))
+        return cvtFunc;
     auto F8E4M3TyID = TypeID::get<mlir::Float8E4M3FNType>();
     auto F8E5M2TyID = TypeID::get<mlir::Float8E5M2Type>();
     auto F16TyID = TypeID::get<mlir::Float16Type>();
@@ -691,6 +895,9 @@ struct FpToFpOpConversion
     rewriter.replaceOp(op, result);
     return success();
   }
+
+private:
+  int computeCapability;
 };
 
 template <typename SourceOp, typename ConcreteT>
@@ -726,13 +933,19 @@ public:
     }
     if (allOperands.size() == 0)
       allOperands.push_back({});
-    for (const SmallVector<Value> &operands : allOperands) {
-      Value curr =
+    // Elements are handed out in groups so that patterns can emit packed
+    // instructions; the last group is never partial.
+    unsigned numPacked = ((ConcreteT *)(this))->getNumPackedElems(op);
+    if (numPacked == 0 || allOperands.size() % numPacked != 0)
+      numPacked = 1;
+    for (unsigned i = 0; i < allOperands.size(); i += numPacked) {
+      ArrayRef<SmallVector<Value>> operands(&allOperands[i], numPacked);
+      SmallVector<Value> curr =
           ((ConcreteT *)(this))
-              ->createDestOp(op, adaptor, rewriter, elemTy, operands, loc);
-      if (!bool(curr))
+              ->createDestOps(op, adaptor, rewriter, elemTy, operands, loc);
+      if (curr.size() != numPacked)
         return failure();
-      resultVals.push_back(curr);
+      resultVals.append(curr.begin(), curr.end());
     }
     if (op->getNumOperands() > 0) {
       auto argTy = op->getOperand(0).getType();
@@ -746,6 +959,28 @@ public:
 
     return success();
   }
+
+  // Number of elements converted by one createDestOps call.
+  unsigned getNumPackedElems(SourceOp op) const { return 1; }
+
+  // An interface to support packed DestOp builders. operands[i] holds the
+  // operands of the i-th element; an empty result means failure.
+  SmallVector<Value> createDestOps(SourceOp op, OpAdaptor adaptor,
+                                   ConversionPatternRewriter &rewriter,
+                                   Type elemTy,
+                                   ArrayRef<SmallVector<Value>> operands,
+                                   Location loc) const {
+    SmallVector<Value> ret;
+    for (const SmallVector<Value> &elemOperands : operands) {
+      Value curr = ((ConcreteT *)(this))
+                       ->createDestOp(op, adaptor, rewriter, elemTy,
+                                      elemOperands, loc);
+      if (!bool(curr))
+        return {};
+      ret.push_back(curr);
+    }
+    return ret;
+  }
 };
 
 template <typename SourceOp, typename DestOp>
@@ -908,16 +1143,230 @@ private:
   }
 };
 
+// Runs the inline asm of the op on groups of `packed_element` elements. The
+// elements of a group narrower than 32 bits share registers, e.g. four i8 or
+// two f16 per 32-bit register, so that the asm applies byte and half-word
+// tricks (prmt, lop3, ...) to whole registers.
+struct ElementwiseInlineAsmOpConversion
+    : public ElementwiseOpConversionBase<triton::ElementwiseInlineAsmOp,
+                                         ElementwiseInlineAsmOpConversion> {
+  using Base = ElementwiseOpConversionBase<triton::ElementwiseInlineAsmOp,
+                                           ElementwiseInlineAsmOpConversion>;
+  using Base::Base;
+  using Adaptor = typename Base::OpAdaptor;
+
+  unsigned getNumPackedElems(triton::ElementwiseInlineAsmOp op) const {
+    return op.getPackedElement();
+  }
+
+  SmallVector<Value> createDestOps(triton::ElementwiseInlineAsmOp op,
+                                   OpAdaptor adaptor,
+                                   ConversionPatternRewriter &rewriter,
+                                   Type elemTy,
+                                   ArrayRef<SmallVector<Value>> operands,
+                                   Location loc) const {
+    MLIRContext *ctx = rewriter.getContext();
+    unsigned numPacked = op.getPackedElement();
+    // The base converts the elements one by one if the elements of a thread
+    // are not a multiple of the groups
+    if (operands.size() != numPacked) {
+      op.emitError("the elements per thread are not a multiple of ")
+          << numPacked;
+      return {};
+    }
+    SmallVector<StringRef> constraints;
+    op.getConstraints().split(constraints, ',');
+    unsigned numConstraints = 0;
+    auto nextConstraint = [&](bool isOutput) -> std::optional<StringRef> {
+      if (numConstraints == constraints.size() ||
+          constraints[numConstraints].startswith("=") != isOutput)
+        return std::nullopt;
+      return constraints[numConstraints++].trim();
+    };
+
+    PTXBuilder builder;
+    auto &asmOp = *builder.create(op.getAsmString().str());
+    SmallVector<PTXBuilder::Operand *> asmOperands;
+    // The result registers
+    unsigned resPerReg = getNumElemsPerReg(elemTy, numPacked);
+    SmallVector<Type> resRegTys(numPacked / resPerReg,
+                                getRegType(rewriter, elemTy, resPerReg));
+    for (unsigned i = 0; i < resRegTys.size(); ++i) {
+      std::optional<StringRef> constraint = nextConstraint(/*isOutput=*/true);
+      if (!constraint) {
+        op.emitError("expected ") << resRegTys.size() << " output constraints";
+        return {};
+      }
+      asmOperands.push_back(builder.newOperand(constraint->str()));
+    }
+    // The operand registers, argument by argument
+    for (unsigned arg = 0; arg < op.getNumOperands(); ++arg) {
+      Type argElemTy = getTypeConverter()->convertType(
+          getElementTypeOrSelf(op.getOperand(arg).getType()));
+      unsigned argPerReg = getNumElemsPerReg(argElemTy, numPacked);
+      for (unsigned i = 0; i < numPacked; i += argPerReg) {
+        std::optional<StringRef> constraint =
+            nextConstraint(/*isOutput=*/false);
+        if (!constraint) {
+          op.emitError("too few input constraints for argument ") << arg;
+          return {};
+        }
+        SmallVector<Value> elems;
+        for (unsigned j = 0; j < argPerReg; ++j)
+          elems.push_back(operands[i + j][arg]);
+        Value reg = packReg(rewriter, loc, elems, argElemTy);
+        asmOperands.push_back(builder.newOperand(reg, constraint->str()));
+      }
+    }
+    if (numConstraints != constraints.size()) {
+      op.emitError("more constraints than operands of the asm");
+      return {};
+    }
+    asmOp(asmOperands, /*onlyAttachMLIRArgs=*/true);
+
+    Type retTy = resRegTys.size() == 1 ? resRegTys[0] : struct_ty(resRegTys);
+    Value ret = builder.launch(rewriter, loc, retTy, !op.getPure());
+    SmallVector<Value> results;
+    for (unsigned i = 0; i < resRegTys.size(); ++i) {
+      Value reg =
+          resRegTys.size() == 1 ? ret : extract_val(resRegTys[i], ret, i);
+      if (resPerReg == 1) {
+        results.push_back(reg);
+        continue;
+      }
+      auto vecTy = vec_ty(elemTy, resPerReg);
+      Value vec = bitcast(reg, vecTy);
+      for (unsigned j = 0; j < resPerReg; ++j)
+        results.push_back(extract_element(elemTy, vec, i32_val(j)));
+    }
+    return results;
+  }
+
+private:
+  // The elements of a group held by a register: 32 bits' worth of the
+  // narrow types, capped by the group
+  static unsigned getNumElemsPerReg(Type elemTy, unsigned numPacked) {
+    unsigned bitWidth = elemTy.getIntOrFloatBitWidth();
+    return std::min(bitWidth < 32 ? 32 / bitWidth : 1, numPacked);
+  }
+
+  static Type getRegType(ConversionPatternRewriter &rewriter, Type elemTy,
+                         unsigned numElems) {
+    if (numElems == 1)
+      return elemTy;
+    return int_ty(numElems * elemTy.getIntOrFloatBitWidth());
+  }
+
+  static Value packReg(ConversionPatternRewriter &rewriter, Location loc,
+                       ArrayRef<Value> elems, Type elemTy) {
+    if (elems.size() == 1)
+      return elems[0];
+    auto vecTy = vec_ty(elemTy, elems.size());
+    Value vec = undef(vecTy);
+    for (auto elem : llvm::enumerate(elems))
+      vec = insert_element(vecTy, vec, elem.value(), i32_val(elem.index()));
+    return bitcast(vec, getRegType(rewriter, elemTy, elems.size()));
+  }
+};
+
+// Runs the Philox4x32 rounds on each element held by the thread. Each round
+// needs the high and low halves of two 32x32-bit products: they are taken
+// from one 64-bit multiply of the zero-extended words, which the backends
+// select as a single wide multiply (mul.wide.u32 on NVPTX).
+struct PhiloxOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::PhiloxOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::PhiloxOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  static constexpr uint32_t kKeyA = 0x9E3779B9;
+  static constexpr uint32_t kKeyB = 0xBB67AE85;
+  static constexpr uint32_t kRoundA = 0xD2511F53;
+  static constexpr uint32_t kRoundB = 0xCD9E8D57;
+
+  LogicalResult
+  matchAndRewrite(triton::PhiloxOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op->getLoc();
+    Type ty = op.getC0().getType();
+    SmallVector<SmallVector<Value>> operands;
+    for (Value operand : adaptor.getOperands())
+      operands.push_back(
+          getTypeConverter()->unpackLLElements(loc, operand, rewriter, ty));
+    SmallVector<SmallVector<Value>> words(4);
+    for (unsigned i = 0; i < operands[0].size(); ++i) {
+      Value c0 = operands[0][i], c1 = operands[1][i], c2 = operands[2][i],
+            c3 = operands[3][i], k0 = operands[4][i], k1 = operands[5][i];
+      for (unsigned round = 0; round < op.getNRounds(); ++round) {
+        auto [hi0, lo0] = mulWide(rewriter, loc, c0, kRoundA);
+        auto [hi2, lo2] = mulWide(rewriter, loc, c2, kRoundB);
+        c0 = xor_(xor_(hi2, c1), k0);
+        c2 = xor_(xor_(hi0, c3), k1);
+        c1 = lo2;
+        c3 = lo0;
+        k0 = add(k0, i32_val(static_cast<int32_t>(kKeyA)));
+        k1 = add(k1, i32_val(static_cast<int32_t>(kKeyB)));
+      }
+      words[0].push_back(c0);
+      words[1].push_back(c1);
+      words[2].push_back(c2);
+      words[3].push_back(c3);
+    }
+    SmallVector<Value> results;
+    for (ArrayRef<Value> word : words)
+      results.push_back(
+          getTypeConverter()->packLLElements(loc, word, rewriter, ty));
+    rewriter.replaceOp(op, results);
+    return success();
+  }
+
+private:
+  // Returns the high and low words of a * b
+  static std::pair<Value, Value> mulWide(ConversionPatternRewriter &rewriter,
+                                         Location loc, Value a, uint32_t b) {
+    Value prod = mul(zext(i64_ty, a), int_val(64, b));
+    Value hi = rewriter.create<LLVM::TruncOp>(loc, i32_ty,
+                                              lshr(prod, int_val(64, 32)));
+    Value lo = rewriter.create<LLVM::TruncOp>(loc, i32_ty, prod);
+    return {hi, lo};
+  }
+};
+
+// Emits a single-operand f32 PTX approximation, e.g. ex2.approx.f32, as
+// outScale * instr(inScale * v).
+static Value createApproxF32Op(Location loc,
+                               ConversionPatternRewriter &rewriter,
+                               StringRef instr, Value v, double inScale = 1.0,
+                               double outScale = 1.0) {
+  if (inScale != 1.0)
+    v = fmul(f32_ty, v, f32_val(inScale));
+  PTXBuilder ptxBuilder;
+  auto &approx = *ptxBuilder.create<PTXInstr>(instr.str());
+  auto output = ptxBuilder.newOperand("=f");
+  auto input = ptxBuilder.newOperand(v, "f");
+  approx(output, input);
+  Value ret = ptxBuilder.launch(rewriter, loc, f32_ty, false);
+  if (outScale != 1.0)
+    ret = fmul(f32_ty, ret, f32_val(outScale));
+  return ret;
+}
+
 struct FDivOpConversion
     : ElementwiseOpConversionBase<mlir::arith::DivFOp, FDivOpConversion> {
   using Base =
       ElementwiseOpConversionBase<mlir::arith::DivFOp, FDivOpConversion>;
-  using Base::Base;
   using Adaptor = typename Base::OpAdaptor;
 
+  explicit FDivOpConversion(TritonGPUToLLVMTypeConverter &typeConverter,
+                            bool fastMath, PatternBenefit benefit = 1)
+      : Base(typeConverter, benefit), fastMath(fastMath) {}
+
   Value createDestOp(mlir::arith::DivFOp op, OpAdaptor adaptor,
                      ConversionPatternRewriter &rewriter, Type elemTy,
                      ValueRange operands, Location loc) const {
+    // With fast-math, 1 / x only needs the reciprocal
+    if (fastMath && elemTy.isF32() && matchPattern(op.getLhs(), m_OneFloat()))
+      return createApproxF32Op(loc, rewriter, "rcp.approx.f32", operands[1]);
+
     PTXBuilder ptxBuilder;
     auto &fdiv = *ptxBuilder.create<PTXInstr>("div");
     unsigned bitwidth = elemTy.getIntOrFloatBitWidth();
@@ -937,6 +1386,9 @@ struct FDivOpConversion
     Value ret = ptxBuilder.launch(rewriter, loc, elemTy, false);
     return ret;
   }
+
+private:
+  bool fastMath;
 };
 
 struct FMulOpConversion
@@ -1029,13 +1481,91 @@ struct FSubOpConversion
   }
 };
 
+// Packs the i8 values into one i32 for the magic-number conversions below.
+static Value packI8x4(Location loc, ConversionPatternRewriter &rewriter,
+                      ArrayRef<SmallVector<Value>> operands) {
+  auto i8x4VecTy = vec_ty(i8_ty, 4);
+  Value i8x4Vec = undef(i8x4VecTy);
+  for (unsigned i = 0; i < 4; ++i)
+    i8x4Vec = insert_element(i8x4VecTy, i8x4Vec, operands[i][0], i32_val(i));
+  return bitcast(i8x4Vec, i32_ty);
+}
+
+// Converts four 8-bit integers, packed in $2, to f16 with prmt/sub.f16x2:
+// 0x64XX is the fp16 encoding of 1024 + XX, so building that value and
+// subtracting the bias gives the exact result. Signed inputs are first
+// shifted to [0, 255] by flipping their sign bit. sub.f16x2 needs sm_53.
+static SmallVector<Value>
+convertI8x4ToFp16x4(Location loc, ConversionPatternRewriter &rewriter,
+                    ArrayRef<SmallVector<Value>> operands, bool isSigned) {
+  auto *ptxAsm = isSigned ? "{                                   \n"
+                            ".reg .b32 a, b<2>, bias;            \n"
+                            "xor.b32 a, $2, 0x80808080;          \n"
+                            "prmt.b32 b0, a, 0x64646464, 0x5150; \n"
+                            "prmt.b32 b1, a, 0x64646464, 0x5352; \n"
+                            "mov.b32 bias, 0x64806480;           \n" // 1152
+                            "sub.f16x2 $0, b0, bias;             \n"
+                            "sub.f16x2 $1, b1, bias;             \n"
+                            "}"
+                          : "{                                   \n"
+                            ".reg .b32 b<2>, bias;               \n"
+                            "prmt.b32 b0, $2, 0x64646464, 0x5150;\n"
+                            "prmt.b32 b1, $2, 0x64646464, 0x5352;\n"
+                            "mov.b32 bias, 0x64006400;           \n" // 1024
+                            "sub.f16x2 $0, b0, bias;             \n"
+                            "sub.f16x2 $1, b1, bias;             \n"
+                            "}";
+  PTXBuilder builder;
+  auto &ptxOp = *builder.create(ptxAsm);
+  auto *o0 = builder.newOperand("=r");
+  auto *o1 = builder.newOperand("=r");
+  auto *i = builder.newOperand(packI8x4(loc, rewriter, operands), "r");
+  ptxOp({o0, o1, i}, /*onlyAttachMLIRArgs=*/true);
+
+  auto fp16x2VecTy = vec_ty(f16_ty, 2);
+  auto fp16x2x2StructTy =
+      struct_ty(SmallVector<Type>{fp16x2VecTy, fp16x2VecTy});
+  auto fp16x2x2Struct = builder.launch(rewriter, loc, fp16x2x2StructTy, false);
+  auto fp16x2Vec0 = extract_val(fp16x2VecTy, fp16x2x2Struct, 0);
+  auto fp16x2Vec1 = extract_val(fp16x2VecTy, fp16x2x2Struct, 1);
+  return {extract_element(f16_ty, fp16x2Vec0, i32_val(0)),
+          extract_element(f16_ty, fp16x2Vec0, i32_val(1)),
+          extract_element(f16_ty, fp16x2Vec1, i32_val(0)),
+          extract_element(f16_ty, fp16x2Vec1, i32_val(1))};
+}
+
+static bool isI8ToFp16(Type inElemTy, Type outElemTy) {
+  return inElemTy.isInteger(8) && outElemTy.isF16();
+}
+
 struct SIToFPOpConversion
     : ElementwiseOpConversionBase<mlir::arith::SIToFPOp, SIToFPOpConversion> {
   using Base =
       ElementwiseOpConversionBase<mlir::arith::SIToFPOp, SIToFPOpConversion>;
-  using Base::Base;
   using Adaptor = typename Base::OpAdaptor;
 
+  explicit SIToFPOpConversion(TritonGPUToLLVMTypeConverter &typeConverter,
+                              int computeCapability,
+                              PatternBenefit benefit = 1)
+      : Base(typeConverter, benefit), computeCapability(computeCapability) {}
+
+  unsigned getNumPackedElems(mlir::arith::SIToFPOp op) const {
+    if (computeCapability >= 53 &&
+        isI8ToFp16(getElementType(op.getIn()), getElementType(op.getOut())))
+      return 4;
+    return 1;
+  }
+
+  SmallVector<Value> createDestOps(mlir::arith::SIToFPOp op, OpAdaptor adaptor,
+                                   ConversionPatternRewriter &rewriter,
+                                   Type elemTy,
+                                   ArrayRef<SmallVector<Value>> operands,
+                                   Location loc) const {
+    if (operands.size() == 4)
+      return convertI8x4ToFp16x4(loc, rewriter, operands, /*isSigned=*/true);
+    return Base::createDestOps(op, adaptor, rewriter, elemTy, operands, loc);
+  }
+
   Value createDestOp(mlir::arith::SIToFPOp op, OpAdaptor adaptor,
                      ConversionPatternRewriter &rewriter, Type elemTy,
                      ValueRange operands, Location loc) const {
@@ -1047,6 +1577,47 @@ struct SIToFPOpConversion
       return rewriter.create<LLVM::SIToFPOp>(loc, elemTy, operands[0]);
     }
   }
+
+private:
+  int computeCapability;
+};
+
+struct UIToFPOpConversion
+    : ElementwiseOpConversionBase<mlir::arith::UIToFPOp, UIToFPOpConversion> {
+  using Base =
+      ElementwiseOpConversionBase<mlir::arith::UIToFPOp, UIToFPOpConversion>;
+  using Adaptor = typename Base::OpAdaptor;
+
+  explicit UIToFPOpConversion(TritonGPUToLLVMTypeConverter &typeConverter,
+                              int computeCapability,
+                              PatternBenefit benefit = 1)
+      : Base(typeConverter, benefit), computeCapability(computeCapability) {}
+
+  unsigned getNumPackedElems(mlir::arith::UIToFPOp op) const {
+    if (computeCapability >= 53 &&
+        isI8ToFp16(getElementType(op.getIn()), getElementType(op.getOut())))
+      return 4;
+    return 1;
+  }
+
+  SmallVector<Value> createDestOps(mlir::arith::UIToFPOp op, OpAdaptor adaptor,
+                                   ConversionPatternRewriter &rewriter,
+                                   Type elemTy,
+                                   ArrayRef<SmallVector<Value>> operands,
+                                   Location loc) const {
+    if (operands.size() == 4)
+      return convertI8x4ToFp16x4(loc, rewriter, operands, /*isSigned=*/false);
+    return Base::createDestOps(op, adaptor, rewriter, elemTy, operands, loc);
+  }
+
+  Value createDestOp(mlir::arith::UIToFPOp op, OpAdaptor adaptor,
+                     ConversionPatternRewriter &rewriter, Type elemTy,
+                     ValueRange operands, Location loc) const {
+    return rewriter.create<LLVM::UIToFPOp>(loc, elemTy, operands[0]);
+  }
+
+private:
+  int computeCapability;
 };
 
 struct FPToSIOpConversion
@@ -1077,6 +1648,32 @@ struct ExtFOpConversion
   using Base::Base;
   using Adaptor = typename Base::OpAdaptor;
 
+  unsigned getNumPackedElems(mlir::arith::ExtFOp op) const {
+    return getElementType(op.getIn()).isBF16() ? 2 : 1;
+  }
+
+  // bf16 is the upper half of f32: a bf16 pair loaded as one i32 is widened
+  // with a shift and a mask, with no cvt at all.
+  SmallVector<Value> createDestOps(mlir::arith::ExtFOp op, OpAdaptor adaptor,
+                                   ConversionPatternRewriter &rewriter,
+                                   Type elemTy,
+                                   ArrayRef<SmallVector<Value>> operands,
+                                   Location loc) const {
+    if (operands.size() != 2)
+      return Base::createDestOps(op, adaptor, rewriter, elemTy, operands, loc);
+    assert(getElementType(op.getOut()).isF32() && "unsupported conversion");
+    auto bf16x2VecTy = vec_ty(i16_ty, 2);
+    Value bf16x2Vec = undef(bf16x2VecTy);
+    bf16x2Vec =
+        insert_element(bf16x2VecTy, bf16x2Vec, operands[0][0], i32_val(0));
+    bf16x2Vec =
+        insert_element(bf16x2VecTy, bf16x2Vec, operands[1][0], i32_val(1));
+    Value packed = bitcast(bf16x2Vec, i32_ty);
+    Value lo = shl(packed, i32_val(16));
+    Value hi = and_(packed, i32_val(0xffff0000));
+    return {bitcast(lo, f32_ty), bitcast(hi, f32_ty)};
+  }
+
   Value createDestOp(mlir::arith::ExtFOp op, OpAdaptor adaptor,
                      ConversionPatternRewriter &rewriter, Type elemTy,
                      ValueRange operands, Location loc) const {
@@ -1095,9 +1692,35 @@ struct TruncFOpConversion
     : ElementwiseOpConversionBase<mlir::arith::TruncFOp, TruncFOpConversion> {
   using Base =
       ElementwiseOpConversionBase<mlir::arith::TruncFOp, TruncFOpConversion>;
-  using Base::Base;
   using Adaptor = typename Base::OpAdaptor;
 
+  explicit TruncFOpConversion(TritonGPUToLLVMTypeConverter &typeConverter,
+                              int computeCapability,
+                              PatternBenefit benefit = 1)
+      : Base(typeConverter, benefit), computeCapability(computeCapability) {}
+
+  unsigned getNumPackedElems(mlir::arith::TruncFOp op) const {
+    auto outElemTy = getElementType(op.getOut());
+    if (computeCapability >= 80 && getElementType(op.getIn()).isF32() &&
+        (outElemTy.isF16() || outElemTy.isBF16()))
+      return 2;
+    return 1;
+  }
+
+  SmallVector<Value> createDestOps(mlir::arith::TruncFOp op, OpAdaptor adaptor,
+                                   ConversionPatternRewriter &rewriter,
+                                   Type elemTy,
+                                   ArrayRef<SmallVector<Value>> operands,
+                                   Location loc) const {
+    if (operands.size() != 2)
+      return Base::createDestOps(op, adaptor, rewriter, elemTy, operands, loc);
+    if (getElementType(op.getOut()).isBF16())
+      return FpToFpOpConversion::convertFp32x2ToBf16x2(
+          loc, rewriter, operands[0][0], operands[1][0]);
+    return FpToFpOpConversion::convertFp32x2ToFp16x2(
+        loc, rewriter, operands[0][0], operands[1][0]);
+  }
+
   Value createDestOp(mlir::arith::TruncFOp op, OpAdaptor adaptor,
                      ConversionPatternRewriter &rewriter, Type elemTy,
                      ValueRange operands, Location loc) const {
@@ -1110,6 +1733,9 @@ struct TruncFOpConversion
       return rewriter.create<LLVM::FPTruncOp>(loc, elemTy, operands[0]);
     }
   }
+
+private:
+  int computeCapability;
 };
 
 struct ExpOpConversionApprox
@@ -1127,15 +1753,89 @@ struct ExpOpConversionApprox
       return {};
 
     const double log2e = 1.4426950408889634;
-    Value prod = fmul(f32_ty, operands[0], f32_val(log2e));
+    return createApproxF32Op(loc, rewriter, "ex2.approx.f32", operands[0],
+                             log2e);
+  }
+};
 
-    PTXBuilder ptxBuilder;
-    auto &exp2 = ptxBuilder.create<PTXInstr>("ex2")->o("approx").o("f32");
-    auto output = ptxBuilder.newOperand("=f");
-    auto input = ptxBuilder.newOperand(prod, "f");
-    exp2(output, input);
-    return ptxBuilder.launch(rewriter, loc, f32_ty, false);
+// A PTX approximation of a single-operand f32 function:
+// outScale * instr(inScale * x), available from sm_<minCC>.
+struct ApproxF32Func {
+  StringRef instr;
+  double inScale = 1.0;
+  double outScale = 1.0;
+  int minCC = 0;
+};
+
+// Fast-math lowering of f32 math ops to approximate PTX instructions. Other
+// element types fail to match and go to the precise lowering.
+template <typename SourceOp>
+struct FastMathOpConversion
+    : ElementwiseOpConversionBase<SourceOp, FastMathOpConversion<SourceOp>> {
+  using Base =
+      ElementwiseOpConversionBase<SourceOp, FastMathOpConversion<SourceOp>>;
+  using OpAdaptor = typename Base::OpAdaptor;
+
+  explicit FastMathOpConversion(TritonGPUToLLVMTypeConverter &typeConverter,
+                                ApproxF32Func func, PatternBenefit benefit = 1)
+      : Base(typeConverter, benefit), func(func) {}
+
+  Value createDestOp(SourceOp op, OpAdaptor adaptor,
+                     ConversionPatternRewriter &rewriter, Type elemTy,
+                     ValueRange operands, Location loc) const {
+    if (!elemTy.isF32())
+      return {};
+    return createApproxF32Op(loc, rewriter, func.instr, operands[0],
+                             func.inScale, func.outScale);
+  }
+
+private:
+  ApproxF32Func func;
+};
+
+// Fast-math lowering of the libdevice calls that have a PTX approximation;
+// the other calls are left to ExternElementwiseOpConversion.
+struct FastMathExternElementwiseOpConversion
+    : ElementwiseOpConversionBase<triton::PureExternElementwiseOp,
+                                  FastMathExternElementwiseOpConversion> {
+  using Base = ElementwiseOpConversionBase<
+      triton::PureExternElementwiseOp, FastMathExternElementwiseOpConversion>;
+  using Adaptor = typename Base::OpAdaptor;
+
+  explicit FastMathExternElementwiseOpConversion(
+      TritonGPUToLLVMTypeConverter &typeConverter, int computeCapability,
+      PatternBenefit benefit = 1)
+      : Base(typeConverter, benefit), computeCapability(computeCapability) {}
+
+  Value createDestOp(triton::PureExternElementwiseOp op, OpAdaptor adaptor,
+                     ConversionPatternRewriter &rewriter, Type elemTy,
+                     ValueRange operands, Location loc) const {
+    const double log2e = 1.4426950408889634;
+    const double ln2 = 0.6931471805599453;
+    static const llvm::StringMap<ApproxF32Func> approxFuncs = {
+        {"__nv_expf", {"ex2.approx.f32", log2e}},
+        {"__nv_exp2f", {"ex2.approx.f32"}},
+        {"__nv_logf", {"lg2.approx.f32", 1.0, ln2}},
+        {"__nv_log2f", {"lg2.approx.f32"}},
+        {"__nv_sinf", {"sin.approx.f32"}},
+        {"__nv_cosf", {"cos.approx.f32"}},
+        {"__nv_sqrtf", {"sqrt.approx.f32"}},
+        {"__nv_rsqrtf", {"rsqrt.approx.f32"}},
+        {"__nv_frcp_rn", {"rcp.approx.f32"}},
+        {"__nv_tanhf", {"tanh.approx.f32", 1.0, 1.0, /*minCC=*/75}},
+    };
+    if (!elemTy.isF32() || operands.size() != 1)
+      return {};
+    auto it = approxFuncs.find(op.getSymbol());
+    if (it == approxFuncs.end() || computeCapability < it->second.minCC)
+      return {};
+    const ApproxF32Func &func = it->second;
+    return createApproxF32Op(loc, rewriter, func.instr, operands[0],
+                             func.inScale, func.outScale);
   }
+
+private:
+  int computeCapability;
 };
 
 struct AbsIOpConversion
@@ -1182,7 +1882,7 @@ struct AbsFOpConversion
 
 void populateElementwiseOpToLLVMPatterns(
     TritonGPUToLLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
-    PatternBenefit benefit) {
+    int computeCapability, bool fastMath, PatternBenefit benefit) {
 #define POPULATE_TERNARY_OP(SRC_OP, DST_OP)                                    \
   patterns.add<ElementwiseOpConversion<SRC_OP, DST_OP>>(typeConverter, benefit);
   POPULATE_TERNARY_OP(triton::gpu::SelectOp, LLVM::SelectOp)
@@ -1215,7 +1915,6 @@ void populateElementwiseOpToLLVMPatterns(
   POPULATE_UNARY_OP(arith::ExtSIOp, LLVM::SExtOp)
   POPULATE_UNARY_OP(arith::ExtUIOp, LLVM::ZExtOp)
   POPULATE_UNARY_OP(arith::FPToUIOp, LLVM::FPToUIOp)
-  POPULATE_UNARY_OP(arith::UIToFPOp, LLVM::UIToFPOp)
   POPULATE_UNARY_OP(math::LogOp, math::LogOp)
   POPULATE_UNARY_OP(math::CosOp, math::CosOp)
   POPULATE_UNARY_OP(math::SinOp, math::SinOp)
@@ -1231,26 +1930,47 @@ void populateElementwiseOpToLLVMPatterns(
   patterns.add<CmpIOpConversion>(typeConverter, benefit);
   patterns.add<CmpFOpConversion>(typeConverter, benefit);
 
-  patterns.add<FDivOpConversion>(typeConverter, benefit);
+  patterns.add<FDivOpConversion>(typeConverter, fastMath, benefit);
   patterns.add<FSubOpConversion>(typeConverter, benefit);
   patterns.add<FAddOpConversion>(typeConverter, benefit);
   patterns.add<FMulOpConversion>(typeConverter, benefit);
 
   patterns.add<ExtFOpConversion>(typeConverter, benefit);
-  patterns.add<TruncFOpConversion>(typeConverter, benefit);
+  patterns.add<TruncFOpConversion>(typeConverter, computeCapability, benefit);
   patterns.add<FPToSIOpConversion>(typeConverter, benefit);
-  patterns.add<SIToFPOpConversion>(typeConverter, benefit);
+  patterns.add<SIToFPOpConversion>(typeConverter, computeCapability, benefit);
+  patterns.add<UIToFPOpConversion>(typeConverter, computeCapability, benefit);
 
-  patterns.add<FpToFpOpConversion>(typeConverter, benefit);
+  patterns.add<FpToFpOpConversion>(typeConverter, computeCapability, benefit);
 
   patterns.add<ExternElementwiseOpConversion<triton::PureExternElementwiseOp>>(
       typeConverter, benefit);
   patterns
       .add<ExternElementwiseOpConversion<triton::ImpureExternElementwiseOp>>(
           typeConverter, benefit);
+  patterns.add<ElementwiseInlineAsmOpConversion>(typeConverter, benefit);
+  patterns.add<PhiloxOpConversion>(typeConverter, benefit);
   // ExpOpConversionApprox will try using ex2.approx if the input type is
   // FP32. For other input types, ExpOpConversionApprox will return failure and
   // ElementwiseOpConversion<math::ExpOp, math::ExpOp> defined below will call
   // __nv_expf for higher-precision calculation
   patterns.add<ExpOpConversionApprox>(typeConverter, benefit);
+
+  // With fast-math, the f32 approximations take precedence over the precise
+  // lowerings registered above.
+  if (fastMath) {
+    PatternBenefit fastMathBenefit(benefit.getBenefit() + 1);
+    const double ln2 = 0.6931471805599453;
+    patterns.add<FastMathOpConversion<math::LogOp>>(
+        typeConverter, ApproxF32Func{"lg2.approx.f32", 1.0, ln2},
+        fastMathBenefit);
+    patterns.add<FastMathOpConversion<math::SinOp>>(
+        typeConverter, ApproxF32Func{"sin.approx.f32"}, fastMathBenefit);
+    patterns.add<FastMathOpConversion<math::CosOp>>(
+        typeConverter, ApproxF32Func{"cos.approx.f32"}, fastMathBenefit);
+    patterns.add<FastMathOpConversion<math::SqrtOp>>(
+        typeConverter, ApproxF32Func{"sqrt.approx.f32"}, fastMathBenefit);
+    patterns.add<FastMathExternElementwiseOpConversion>(
+        typeConverter, computeCapability, fastMathBenefit);
+  }
 }
@@ -0,0 +1,93 @@
+#include "HistogramOpToLLVM.h"
+
+using namespace mlir;
+using namespace mlir::triton;
+
+using ::mlir::LLVM::storeShared;
+using ::mlir::triton::gpu::getTotalElemsPerThread;
+
+struct HistogramOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::HistogramOp> {
+public:
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::HistogramOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  // The bins are privatized per CTA in shared memory:
+  //   1. the threads clear the bins,
+  //   2. every element in [0, numBins) increments its bin with red.shared,
+  //   3. the threads read the bins back in the layout of the result.
+  // Adding the counts of the CTA to a global histogram then takes a single
+  // atomic per bin, e.g. tl.atomic_add, which lowers to red.global.
+  LogicalResult
+  matchAndRewrite(triton::HistogramOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op.getLoc();
+    auto ctx = rewriter.getContext();
+    auto srcTy = op.getSrc().getType().cast<RankedTensorType>();
+    auto dstTy = op.getResult().getType().cast<RankedTensorType>();
+    unsigned numBins = dstTy.getNumElements();
+    Type smemPtrTy = ptr_ty(i32_ty, 3);
+    Value smemBase = bitcast(
+        getSharedMemoryBase(loc, rewriter, op.getOperation()), smemPtrTy);
+
+    // 1. Clear the bins
+    auto mod = op->getParentOfType<ModuleOp>();
+    unsigned numThreads =
+        triton::gpu::TritonGPUDialect::getNumWarps(mod) *
+        triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+    Value threadId = getThreadId(rewriter, loc);
+    for (unsigned first = 0; first < numBins; first += numThreads) {
+      Value bin = add(threadId, i32_val(first));
+      storeShared(rewriter, loc, gep(smemPtrTy, smemBase, bin), i32_val(0),
+                  icmp_slt(bin, i32_val(numBins)));
+    }
+    barrier();
+
+    // 2. Count the elements. The threads and registers holding copies of
+    // replicated elements skip them.
+    auto srcValues = getTypeConverter()->unpackLLElements(
+        loc, adaptor.getSrc(), rewriter, srcTy);
+    assert(srcValues.size() == getTotalElemsPerThread(srcTy));
+    auto offsets = emitOffsetForLayout(srcTy.getEncoding(), srcTy);
+    Value isOwner = getMask(srcTy, rewriter, loc);
+    bool isBool = srcTy.getElementType().isInteger(1);
+    std::set<SmallVector<unsigned>> counted;
+    for (unsigned i = 0; i < srcValues.size(); ++i) {
+      if (!counted.insert(offsets[i]).second)
+        continue;
+      Value val = srcValues[i];
+      if (!val.getType().isInteger(64))
+        val = isBool ? zext(i64_ty, val) : sext(i64_ty, val);
+      Value inRange = and_(icmp_sge(val, int_val(64, 0)),
+                           icmp_slt(val, int_val(64, numBins)));
+      Value bin = rewriter.create<LLVM::TruncOp>(loc, i32_ty, val);
+      PTXBuilder builder;
+      auto &red = builder.create<>("red")->shared().o("add").o("u32");
+      auto *ptrOpr =
+          builder.newAddrOperand(gep(smemPtrTy, smemBase, bin), "r");
+      auto *valOpr = builder.newOperand(i32_val(1), "r");
+      red(ptrOpr, valOpr).predicate(and_(isOwner, inRange), "b");
+      builder.launch(rewriter, loc, void_ty(ctx));
+    }
+    barrier();
+
+    // 3. Read the bins
+    auto dstIndices = emitIndices(loc, rewriter, dstTy.getEncoding(), dstTy);
+    SmallVector<Value> dstValues;
+    for (const auto &indices : dstIndices)
+      dstValues.push_back(load(gep(smemPtrTy, smemBase, indices[0])));
+    Value result =
+        getTypeConverter()->packLLElements(loc, dstValues, rewriter, dstTy);
+    rewriter.replaceOp(op, result);
+    return success();
+  }
+};
+
+void populateHistogramOpToLLVMPatterns(
+    TritonGPUToLLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
+    ModuleAllocation &allocation,
+    ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
+    PatternBenefit benefit) {
+  patterns.add<HistogramOpConversion>(typeConverter, allocation, indexCacheInfo,
+                                      benefit);
+}
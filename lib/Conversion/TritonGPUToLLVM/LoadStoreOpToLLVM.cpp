@@ -1,3 +1,4 @@
+#include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
 #include "mlir/IR/Matchers.h"
 #include "mlir/IR/TypeUtilities.h"
 
@@ -37,6 +38,122 @@ struct LoadStoreConversionBase {
     return axisAnalysisPass.getMaskAlignment(mask);
   }
 
+  bool isUniformMask(Value mask) const {
+    return axisAnalysisPass.isUniform(mask);
+  }
+
+  // Returns the PTX qualifiers ordering a load or store, e.g. {"acquire",
+  // "sys"}, or none for a weak access. A scope alone makes it relaxed.
+  static SmallVector<std::string>
+  getMemOrdering(std::optional<triton::MemSemantic> sem,
+                 std::optional<triton::MemSyncScope> scope) {
+    if (!sem && !scope)
+      return {};
+    return {stringifyMemSemantic(sem.value_or(MemSemantic::RELAXED)).str(),
+            stringifyMemSyncScope(scope.value_or(MemSyncScope::GPU)).str()};
+  }
+
+  // Returns the level of the `membar` fencing an atomic at `scope`.
+  static std::string getMembarLevel(std::optional<triton::MemSyncScope> scope) {
+    switch (scope.value_or(MemSyncScope::GPU)) {
+    case MemSyncScope::CTA:
+      return "cta";
+    case MemSyncScope::SYSTEM:
+      return "sys";
+    default:
+      return "gl";
+    }
+  }
+
+  // Returns the vector size of the accesses of `valueTy` to the block
+  // pointer `ptr`.
+  unsigned getTensorPtrVectorSize(
+      Value ptr, RankedTensorType valueTy,
+      std::optional<ArrayRef<int32_t>> boundaryCheck) const {
+    auto contiguity =
+        axisAnalysisPass.getTensorPtrContiguity(ptr, valueTy, boundaryCheck);
+    auto pointeeBitWidth = triton::getPointeeBitWidth(ptr.getType());
+    return std::min<unsigned>(128 / pointeeBitWidth, contiguity);
+  }
+
+  // Returns the addresses of the elements of the block pointer `llPtr`, the
+  // struct {base, shape..., strides..., offsets...}, at the coordinates
+  // `indices` of the block. The strides known at compile time are folded in
+  // the address computation. Appends to `maskElems` whether each element is
+  // in bounds along the dimensions in `boundaryCheck`.
+  SmallVector<Value>
+  getTensorPtrElems(ConversionPatternRewriter &rewriter, Location loc,
+                    Value ptr, Value llPtr,
+                    ArrayRef<SmallVector<Value>> indices,
+                    std::optional<ArrayRef<int32_t>> boundaryCheck,
+                    SmallVectorImpl<Value> &maskElems) const {
+    auto blockTy =
+        triton::getPointeeType(ptr.getType()).cast<RankedTensorType>();
+    unsigned rank = blockTy.getRank();
+    auto types = llPtr.getType().cast<LLVM::LLVMStructType>().getBody();
+    Value base = extract_val(types[0], llPtr, 0);
+    SmallVector<Value> shape, strides, offsets;
+    for (unsigned d = 0; d < rank; ++d) {
+      shape.push_back(extract_val(i64_ty, llPtr, 1 + d));
+      strides.push_back(extract_val(i64_ty, llPtr, 1 + rank + d));
+      offsets.push_back(extract_val(i32_ty, llPtr, 1 + 2 * rank + d));
+    }
+    if (auto makeTensorPtr = getMakeTensorPtrOp(ptr))
+      for (unsigned d = 0; d < rank; ++d) {
+        auto *axisInfo =
+            axisAnalysisPass.getAxisInfo(makeTensorPtr.getStrides()[d]);
+        if (axisInfo && axisInfo->getConstantValue())
+          strides[d] = int_val(64, *axisInfo->getConstantValue());
+      }
+    // The block starts at base + sum(offset * stride)
+    Value blockOffset = int_val(64, 0);
+    for (unsigned d = 0; d < rank; ++d)
+      blockOffset = add(blockOffset, mul(sext(i64_ty, offsets[d]), strides[d]));
+    Value blockBase = gep(types[0], base, blockOffset);
+
+    SmallVector<Value> ptrElems;
+    for (const auto &index : indices) {
+      Value elemOffset = int_val(64, 0);
+      for (unsigned d = 0; d < rank; ++d)
+        elemOffset = add(elemOffset, mul(sext(i64_ty, index[d]), strides[d]));
+      ptrElems.push_back(gep(types[0], blockBase, elemOffset));
+      if (!boundaryCheck || boundaryCheck->empty())
+        continue;
+      Value inBounds = int_val(1, 1);
+      for (int32_t d : *boundaryCheck) {
+        Value pos = sext(i64_ty, add(offsets[d], index[d]));
+        inBounds = and_(inBounds, and_(icmp_sge(pos, int_val(64, 0)),
+                                       icmp_slt(pos, shape[d])));
+      }
+      maskElems.push_back(inBounds);
+    }
+    return ptrElems;
+  }
+
+  // Creates the 64-bit L2 cache policy of the L2 eviction policies, or returns
+  // a null value for the other policies. The policy is created once per op and
+  // passed to every access through `.L2::cache_hint`; both require sm_80.
+  Value createL2CachePolicy(ConversionPatternRewriter &rewriter, Location loc,
+                            triton::EvictionPolicy evict) const {
+    std::string priority;
+    switch (evict) {
+    case triton::EvictionPolicy::L2_EVICT_FIRST:
+      priority = "L2::evict_first";
+      break;
+    case triton::EvictionPolicy::L2_EVICT_LAST:
+      priority = "L2::evict_last";
+      break;
+    default:
+      return Value();
+    }
+    PTXBuilder ptxBuilder;
+    auto &createPolicy =
+        ptxBuilder.create<>("createpolicy")->o("fractional").o(priority).b(64);
+    createPolicy(ptxBuilder.newOperand("=l"),
+                 ptxBuilder.newConstantOperand("1.0"));
+    return ptxBuilder.launch(rewriter, loc, i64_ty, /*hasSideEffect=*/false);
+  }
+
 protected:
   ModuleAxisInfoAnalysis &axisAnalysisPass;
 };
@@ -47,16 +164,19 @@ struct LoadOpConversion
   using ConvertTritonGPUOpToLLVMPattern<
       triton::LoadOp>::ConvertTritonGPUOpToLLVMPattern;
 
-  LoadOpConversion(TritonGPUToLLVMTypeConverter &converter,
-                   ModuleAxisInfoAnalysis &axisAnalysisPass,
-                   PatternBenefit benefit)
-      : ConvertTritonGPUOpToLLVMPattern<triton::LoadOp>(converter, benefit),
+  LoadOpConversion(
+      TritonGPUToLLVMTypeConverter &converter,
+      ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
+      ModuleAxisInfoAnalysis &axisAnalysisPass, PatternBenefit benefit)
+      : ConvertTritonGPUOpToLLVMPattern<triton::LoadOp>(
+            converter, indexCacheInfo, benefit),
         LoadStoreConversionBase(axisAnalysisPass) {}
 
   LogicalResult
   matchAndRewrite(triton::LoadOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
     auto loc = op->getLoc();
+    auto ordering = getMemOrdering(op.getSem(), op.getScope());
 
     // original values
     Value ptr = op.getPtr();
@@ -72,16 +192,47 @@ struct LoadOpConversion
     Type valueTy = op.getResult().getType();
     Type valueElemTy =
         typeConverter->convertType(getElementTypeOrSelf(valueTy));
-    unsigned vec = getVectorSize(ptr);
-    unsigned numElems = getTotalElemsPerThread(ptr.getType());
+    bool isTensorPtr = triton::isTensorPointerType(ptr.getType());
+    unsigned vec = isTensorPtr
+                       ? getTensorPtrVectorSize(
+                             ptr, valueTy.cast<RankedTensorType>(),
+                             op.getBoundaryCheck())
+                       : getVectorSize(ptr);
+    unsigned numElems = getTotalElemsPerThread(valueTy);
     if (llMask)
       vec = std::min<size_t>(vec, getMaskAlignment(mask));
 
-    // Get the LLVM values for pointers
-    auto ptrElems = getTypeConverter()->unpackLLElements(loc, llPtr, rewriter,
-                                                         ptr.getType());
+    // Get the LLVM values for pointers, block pointers are checked against
+    // their bounds
+    SmallVector<Value> ptrElems;
+    SmallVector<Value> boundsElems;
+    if (isTensorPtr) {
+      auto valueTensorTy = valueTy.cast<RankedTensorType>();
+      auto indices = emitIndices(loc, rewriter, valueTensorTy.getEncoding(),
+                                 valueTensorTy);
+      ptrElems = getTensorPtrElems(rewriter, loc, ptr, llPtr, indices,
+                                   op.getBoundaryCheck(), boundsElems);
+    } else {
+      ptrElems = getTypeConverter()->unpackLLElements(loc, llPtr, rewriter,
+                                                      ptr.getType());
+    }
     assert(ptrElems.size() == numElems);
 
+    // The elements of a parameter table are read with plain loads, the table
+    // is in the parameters of the launch. The frontend rejects masks there.
+    if (triton::isParamPointerType(ptr.getType())) {
+      if (llMask)
+        return failure();
+      SmallVector<Value> loadedVals;
+      for (Value ptrElem : ptrElems)
+        loadedVals.push_back(load(ptrElem));
+      Type llvmResultStructTy = getTypeConverter()->convertType(valueTy);
+      Value resultStruct = getTypeConverter()->packLLElements(
+          loc, loadedVals, rewriter, llvmResultStructTy);
+      rewriter.replaceOp(op, {resultStruct});
+      return success();
+    }
+
     // Get the LLVM values for mask
     SmallVector<Value> maskElems;
     if (llMask) {
@@ -89,6 +240,12 @@ struct LoadOpConversion
                                                        mask.getType());
       assert(maskElems.size() == numElems);
     }
+    for (auto inBounds : llvm::enumerate(boundsElems))
+      if (llMask)
+        maskElems[inBounds.index()] =
+            and_(maskElems[inBounds.index()], inBounds.value());
+      else
+        maskElems.push_back(inBounds.value());
 
     // Get the LLVM values for `other`
     // TODO: (goostavz) handle when other is const but not splat, which
@@ -106,6 +263,17 @@ struct LoadOpConversion
     if (other) {
       otherElems = getTypeConverter()->unpackLLElements(loc, llOther, rewriter,
                                                         other.getType());
+    } else if (!boundsElems.empty() && op.getPadding()) {
+      // The out-of-bounds elements of a block pointer are padded
+      Type elemTy = getElementTypeOrSelf(valueTy);
+      unsigned elemBits = valueElemTy.getIntOrFloatBitWidth();
+      Value pad = int_val(elemBits, 0);
+      if (*op.getPadding() == triton::PaddingOption::PAD_NAN) {
+        auto nan =
+            APFloat::getNaN(elemTy.cast<FloatType>().getFloatSemantics());
+        pad = int_val(elemBits, nan.bitcastToAPInt().getZExtValue());
+      }
+      otherElems.assign(numElems, bitcast(pad, valueElemTy));
     }
 
     // vectorized iteration through all the pointer/mask/other elements
@@ -113,6 +281,36 @@ struct LoadOpConversion
         std::max(8u, valueElemTy.getIntOrFloatBitWidth());
     const int numVecs = numElems / vec;
 
+    Value l2Policy = createL2CachePolicy(rewriter, loc, op.getEvict());
+    const bool hasL2EvictPolicy = static_cast<bool>(l2Policy);
+
+    // A mask that is the same for the whole tensor, e.g. the bounds check of
+    // a K step, guards all the loads with a branch instead of predicating
+    // each of them and moving `other` into the masked-off registers:
+    //
+    //   cond_br %mask, ^load, ^merge(%other...)
+    // ^load:
+    //   ld.global ...
+    //   br ^merge(%loaded...)
+    // ^merge(%vals...):
+    //   br ^tail
+    //
+    // The branch splits the block, so the parent must accept several blocks.
+    bool isUniformBranch = llMask && boundsElems.empty() &&
+                           valueElemTy.isIntOrFloat() && isUniformMask(mask) &&
+                           isa<FunctionOpInterface>(op->getParentOp());
+    Block *prevBlock = nullptr, *mergeBlock = nullptr;
+    if (isUniformBranch) {
+      prevBlock = op->getBlock();
+      Block *tailBlock = rewriter.splitBlock(prevBlock, op->getIterator());
+      mergeBlock = rewriter.createBlock(
+          tailBlock, SmallVector<Type>(numElems, valueElemTy),
+          SmallVector<Location>(numElems, loc));
+      rewriter.create<cf::BranchOp>(loc, tailBlock);
+      rewriter.createBlock(mergeBlock);
+    }
+    bool isPredicated = !maskElems.empty() && !isUniformBranch;
+
     SmallVector<Value> loadedVals;
     for (size_t vecStart = 0; vecStart < numElems; vecStart += vec) {
       // TODO: optimization when ptr is GEP with constant offset
@@ -126,13 +324,9 @@ struct LoadOpConversion
       const size_t movWidth = width < 16 ? 16 : width;
       assert(wordNElems * nWords * numVecs == numElems);
 
-      // TODO(Superjomn) Add cache policy fields to StoreOp.
-      // TODO(Superjomn) Deal with cache policy here.
-      const bool hasL2EvictPolicy = false;
-
       PTXBuilder ptxBuilder;
 
-      Value pred = mask ? maskElems[vecStart] : int_val(1, 1);
+      Value pred = isPredicated ? maskElems[vecStart] : int_val(1, 1);
 
       const std::string readConstraint =
           (width == 64) ? "l" : ((width == 32) ? "r" : "c");
@@ -150,32 +344,35 @@ struct LoadOpConversion
       auto *addrOpr =
           ptxBuilder.newAddrOperand(ptrElems[vecStart], "l", in_off);
 
-      // Define the instruction opcode
-      auto &ld = ptxBuilder.create<>("ld")
-                     ->o("volatile", op.getIsVolatile())
-                     .global()
-                     .o("ca", op.getCache() == triton::CacheModifier::CA)
-                     .o("cg", op.getCache() == triton::CacheModifier::CG)
-                     .o("L1::evict_first",
-                        op.getEvict() == triton::EvictionPolicy::EVICT_FIRST)
-                     .o("L1::evict_last",
-                        op.getEvict() == triton::EvictionPolicy::EVICT_LAST)
-                     .o("L1::cache_hint", hasL2EvictPolicy)
-                     .v(nWords)
-                     .b(width);
+      // Define the instruction opcode; an ordered load, e.g. ld.acquire.sys
+      // on a flag set by a peer device, has no cache modifier
+      auto &ld = ptxBuilder.create<>("ld")->o("volatile", op.getIsVolatile());
+      for (const std::string &qualifier : ordering)
+        ld.o(qualifier);
+      ld.global()
+          .o("ca", op.getCache() == triton::CacheModifier::CA)
+          .o("cg", op.getCache() == triton::CacheModifier::CG)
+          .o("cs", op.getCache() == triton::CacheModifier::CS)
+          .o("L1::evict_first",
+              op.getEvict() == triton::EvictionPolicy::EVICT_FIRST)
+          .o("L1::evict_last",
+              op.getEvict() == triton::EvictionPolicy::EVICT_LAST)
+          .o("L1::no_allocate",
+              op.getEvict() == triton::EvictionPolicy::NO_ALLOCATE)
+          .o("L2::cache_hint", hasL2EvictPolicy)
+          .v(nWords)
+          .b(width);
 
       PTXBuilder::Operand *evictOpr{};
-
-      // Here lack a mlir::Value to bind to this operation, so disabled.
-      // if (has_l2_evict_policy)
-      //   evictOpr = ptxBuilder.newOperand(l2Evict, "l");
+      if (hasL2EvictPolicy)
+        evictOpr = ptxBuilder.newOperand(l2Policy, "l");
 
       if (!evictOpr)
         ld(dstsOpr, addrOpr).predicate(pred, "b");
       else
         ld(dstsOpr, addrOpr, evictOpr).predicate(pred, "b");
 
-      if (other) {
+      if (isPredicated && !otherElems.empty()) {
         for (size_t ii = 0; ii < nWords; ++ii) {
           // PTX doesn't support mov.u8, so we need to use mov.u16
           PTXInstr &mov =
@@ -212,10 +409,6 @@ struct LoadOpConversion
                        ? LLVM::LLVMStructType::getLiteral(getContext(), retTys)
                        : retTys[0];
 
-      // TODO: if (has_l2_evict_policy)
-      // auto asmDialectAttr =
-      // LLVM::AsmDialectAttr::get(rewriter.getContext(),
-      //                                                 LLVM::AsmDialect::AD_ATT);
       Value ret = ptxBuilder.launch(rewriter, loc, retTy);
 
       // Extract and store return values
@@ -240,6 +433,24 @@ struct LoadOpConversion
       }
     } // end vec
 
+    if (isUniformBranch) {
+      Block *loadBlock = rewriter.getInsertionBlock();
+      rewriter.create<cf::BranchOp>(loc, mergeBlock, loadedVals);
+      // the masked-off values are `other`, or zeros as with the predicated
+      // loads
+      SmallVector<Value> maskedVals = otherElems;
+      rewriter.setInsertionPointToEnd(prevBlock);
+      if (maskedVals.empty()) {
+        unsigned elemBits = valueElemTy.getIntOrFloatBitWidth();
+        maskedVals.assign(numElems,
+                          bitcast(int_val(elemBits, 0), valueElemTy));
+      }
+      rewriter.create<cf::CondBranchOp>(loc, maskElems[0], loadBlock,
+                                        ValueRange{}, mergeBlock, maskedVals);
+      rewriter.setInsertionPoint(mergeBlock->getTerminator());
+      loadedVals.assign(mergeBlock->args_begin(), mergeBlock->args_end());
+    }
+
     Type llvmResultStructTy = getTypeConverter()->convertType(valueTy);
     Value resultStruct = getTypeConverter()->packLLElements(
         loc, loadedVals, rewriter, llvmResultStructTy);
@@ -254,10 +465,12 @@ struct StoreOpConversion
   using ConvertTritonGPUOpToLLVMPattern<
       triton::StoreOp>::ConvertTritonGPUOpToLLVMPattern;
 
-  StoreOpConversion(TritonGPUToLLVMTypeConverter &converter,
-                    ModuleAxisInfoAnalysis &axisAnalysisPass,
-                    PatternBenefit benefit)
-      : ConvertTritonGPUOpToLLVMPattern<triton::StoreOp>(converter, benefit),
+  StoreOpConversion(
+      TritonGPUToLLVMTypeConverter &converter,
+      ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
+      ModuleAxisInfoAnalysis &axisAnalysisPass, PatternBenefit benefit)
+      : ConvertTritonGPUOpToLLVMPattern<triton::StoreOp>(
+            converter, indexCacheInfo, benefit),
         LoadStoreConversionBase(axisAnalysisPass) {}
 
   LogicalResult
@@ -272,16 +485,32 @@ struct StoreOpConversion
 
     auto loc = op->getLoc();
     MLIRContext *ctx = rewriter.getContext();
+    auto ordering = getMemOrdering(op.getSem(), op.getScope());
 
     auto valueTy = value.getType();
     Type valueElemTy =
         typeConverter->convertType(getElementTypeOrSelf(valueTy));
 
-    unsigned vec = getVectorSize(ptr);
-    unsigned elemsPerThread = getTotalElemsPerThread(ptr.getType());
-
-    auto ptrElems = getTypeConverter()->unpackLLElements(loc, llPtr, rewriter,
-                                                         ptr.getType());
+    bool isTensorPtr = triton::isTensorPointerType(ptr.getType());
+    unsigned vec = isTensorPtr
+                       ? getTensorPtrVectorSize(
+                             ptr, valueTy.cast<RankedTensorType>(),
+                             op.getBoundaryCheck())
+                       : getVectorSize(ptr);
+    unsigned elemsPerThread = getTotalElemsPerThread(valueTy);
+
+    SmallVector<Value> ptrElems;
+    SmallVector<Value> boundsElems;
+    if (isTensorPtr) {
+      auto valueTensorTy = valueTy.cast<RankedTensorType>();
+      auto indices = emitIndices(loc, rewriter, valueTensorTy.getEncoding(),
+                                 valueTensorTy);
+      ptrElems = getTensorPtrElems(rewriter, loc, ptr, llPtr, indices,
+                                   op.getBoundaryCheck(), boundsElems);
+    } else {
+      ptrElems = getTypeConverter()->unpackLLElements(loc, llPtr, rewriter,
+                                                      ptr.getType());
+    }
     auto valueElems = getTypeConverter()->unpackLLElements(
         loc, llValue, rewriter, value.getType());
     assert(ptrElems.size() == valueElems.size());
@@ -297,12 +526,21 @@ struct StoreOpConversion
       unsigned maskAlign = getMaskAlignment(mask);
       vec = std::min(vec, maskAlign);
     }
+    for (auto inBounds : llvm::enumerate(boundsElems))
+      if (llMask)
+        maskElems[inBounds.index()] =
+            and_(maskElems[inBounds.index()], inBounds.value());
+      else
+        maskElems.push_back(inBounds.value());
 
     Value mask = getMask(valueTy, rewriter, loc);
     const size_t dtsize =
         std::max<int>(1, valueElemTy.getIntOrFloatBitWidth() / 8);
     const size_t valueElemNBits = dtsize * 8;
 
+    Value l2Policy = createL2CachePolicy(rewriter, loc, op.getEvict());
+    const bool hasL2EvictPolicy = static_cast<bool>(l2Policy);
+
     const int numVecs = elemsPerThread / vec;
     for (size_t vecStart = 0; vecStart < elemsPerThread; vecStart += vec) {
       // TODO: optimization when ptr is AddPtr with constant offset
@@ -315,9 +553,6 @@ struct StoreOpConversion
       const size_t wordNElems = width / valueElemNBits;
       assert(wordNElems * nWords * numVecs == elemsPerThread);
 
-      // TODO(Superjomn) Add cache policy fields to StoreOp.
-      // TODO(Superjomn) Deal with cache policy here.
-
       Type valArgTy = IntegerType::get(ctx, width);
       auto wordTy = vec_ty(valueElemTy, wordNElems);
 
@@ -346,14 +581,35 @@ struct StoreOpConversion
       PTXBuilder ptxBuilder;
       auto *asmArgList = ptxBuilder.newListOperand(asmArgs);
 
-      Value maskVal = llMask ? and_(mask, maskElems[vecStart]) : mask;
+      Value maskVal =
+          maskElems.empty() ? mask : and_(mask, maskElems[vecStart]);
 
       auto *asmAddr =
           ptxBuilder.newAddrOperand(ptrElems[vecStart], "l", in_off);
 
-      auto &ptxStoreInstr =
-          ptxBuilder.create<>("st")->global().v(nWords).b(width);
-      ptxStoreInstr(asmAddr, asmArgList).predicate(maskVal, "b");
+      auto &ptxStoreInstr = *ptxBuilder.create<>("st");
+      for (const std::string &qualifier : ordering)
+        ptxStoreInstr.o(qualifier);
+      ptxStoreInstr.global()
+          .o("wb", op.getCache() == triton::CacheModifier::WB)
+          .o("cg", op.getCache() == triton::CacheModifier::CG)
+          .o("cs", op.getCache() == triton::CacheModifier::CS)
+          .o("wt", op.getCache() == triton::CacheModifier::WT)
+          .o("L1::evict_first",
+              op.getEvict() == triton::EvictionPolicy::EVICT_FIRST)
+          .o("L1::evict_last",
+              op.getEvict() == triton::EvictionPolicy::EVICT_LAST)
+          .o("L1::no_allocate",
+              op.getEvict() == triton::EvictionPolicy::NO_ALLOCATE)
+          .o("L2::cache_hint", hasL2EvictPolicy)
+          .v(nWords)
+          .b(width);
+      if (hasL2EvictPolicy)
+        ptxStoreInstr(asmAddr, asmArgList,
+                      ptxBuilder.newOperand(l2Policy, "l"))
+            .predicate(maskVal, "b");
+      else
+        ptxStoreInstr(asmAddr, asmArgList).predicate(maskVal, "b");
 
       Type boolTy = getTypeConverter()->convertType(rewriter.getIntegerType(1));
       llvm::SmallVector<Type> argTys({boolTy, ptr.getType()});
@@ -374,12 +630,12 @@ struct AtomicCASOpConversion
   using ConvertTritonGPUOpToLLVMPattern<
       triton::AtomicCASOp>::ConvertTritonGPUOpToLLVMPattern;
 
-  AtomicCASOpConversion(TritonGPUToLLVMTypeConverter &converter,
-                        ModuleAllocation &allocation,
-                        ModuleAxisInfoAnalysis &axisAnalysisPass,
-                        PatternBenefit benefit)
+  AtomicCASOpConversion(
+      TritonGPUToLLVMTypeConverter &converter, ModuleAllocation &allocation,
+      ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
+      ModuleAxisInfoAnalysis &axisAnalysisPass, PatternBenefit benefit)
       : ConvertTritonGPUOpToLLVMPattern<triton::AtomicCASOp>(
-            converter, allocation, benefit),
+            converter, allocation, indexCacheInfo, benefit),
         LoadStoreConversionBase(axisAnalysisPass) {}
 
   LogicalResult
@@ -406,8 +662,12 @@ struct AtomicCASOpConversion
                  : valueTy;
     auto valueElemNBits = valueElemTy.getIntOrFloatBitWidth();
     Value mask = getMask(valueTy, rewriter, loc);
+    // the fences are at the scope of the atomic, e.g. membar.sys for a flag
+    // shared with peer devices
+    std::string membarLevel = getMembarLevel(op.getScope());
     PTXBuilder ptxBuilderMemfence;
-    auto memfence = ptxBuilderMemfence.create<PTXInstr>("membar")->o("gl");
+    auto memfence =
+        ptxBuilderMemfence.create<PTXInstr>("membar")->o(membarLevel);
     memfence();
     auto ASMReturnTy = void_ty(ctx);
     ptxBuilderMemfence.launch(rewriter, loc, ASMReturnTy);
@@ -424,7 +684,12 @@ struct AtomicCASOpConversion
     auto *cmpOpr = ptxBuilderAtomicCAS.newOperand(casCmp, "r");
     auto *valOpr = ptxBuilderAtomicCAS.newOperand(casVal, "r");
     auto &atom = *ptxBuilderAtomicCAS.create<PTXInstr>("atom");
-    atom.global().o("cas").o("b32");
+    atom.global();
+    if (op.getSem())
+      atom.o(stringifyMemSemantic(*op.getSem()).str());
+    if (op.getScope())
+      atom.o(stringifyMemSyncScope(*op.getScope()).str());
+    atom.o("cas").o("b32");
     atom(dstOpr, ptrOpr, cmpOpr, valOpr).predicate(mask);
     auto old = ptxBuilderAtomicCAS.launch(rewriter, loc, valueElemTy);
     barrier();
@@ -451,12 +716,12 @@ struct AtomicRMWOpConversion
   using ConvertTritonGPUOpToLLVMPattern<
       triton::AtomicRMWOp>::ConvertTritonGPUOpToLLVMPattern;
 
-  AtomicRMWOpConversion(TritonGPUToLLVMTypeConverter &converter,
-                        ModuleAllocation &allocation,
-                        ModuleAxisInfoAnalysis &axisAnalysisPass,
-                        PatternBenefit benefit)
+  AtomicRMWOpConversion(
+      TritonGPUToLLVMTypeConverter &converter, ModuleAllocation &allocation,
+      ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
+      ModuleAxisInfoAnalysis &axisAnalysisPass, PatternBenefit benefit)
       : ConvertTritonGPUOpToLLVMPattern<triton::AtomicRMWOp>(
-            converter, allocation, benefit),
+            converter, allocation, indexCacheInfo, benefit),
         LoadStoreConversionBase(axisAnalysisPass) {}
 
   LogicalResult
@@ -490,82 +755,124 @@ struct AtomicRMWOpConversion
                  : valueTy;
     const size_t valueElemNBits = valueElemTy.getIntOrFloatBitWidth();
     auto elemsPerThread = getTotalElemsPerThread(val.getType());
+    // red does not return the old value, and has no exchange nor acquire
+    // semantics
+    bool isAcquire = op.getSem() == MemSemantic::ACQUIRE ||
+                     op.getSem() == MemSemantic::ACQUIRE_RELEASE;
+    bool useRed = op.getResult().use_empty() &&
+                  atomicRmwAttr != RMWOp::XCHG && !isAcquire;
     // vec = 1, numElements = 1 for scalar
     auto vec = getVectorSize(ptr);
+    // number of consecutive elements of a thread with the same address,
+    // which are combined in registers before a single atomic
+    unsigned group = 1;
     int numElems = 1;
     // tensor
     if (tensorTy) {
       auto valTy = val.getType().cast<RankedTensorType>();
       vec = std::min<unsigned>(vec, valTy.getElementType().isF16() ? 2 : 1);
+      // the old values of the combined elements are not known
+      if (useRed && vec == 1) {
+        group = axisAnalysisPass.getConstancyPerThread(ptr);
+        if (llMask)
+          group = std::gcd(
+              group, axisAnalysisPass.getConstancyPerThread(op.getMask()));
+      }
       // mask
       numElems = tensorTy.getNumElements();
     }
     Value mask = getMask(valueTy, rewriter, loc);
 
+    auto rmwOp = stringifyRMWOp(atomicRmwAttr).str();
+    auto sBits = std::to_string(valueElemNBits);
+    std::string sTy;
+    switch (atomicRmwAttr) {
+    case RMWOp::AND:
+      sTy = "b" + sBits;
+      break;
+    case RMWOp::OR:
+      sTy = "b" + sBits;
+      break;
+    case RMWOp::XOR:
+      sTy = "b" + sBits;
+      break;
+    case RMWOp::ADD:
+      sTy = "s" + sBits;
+      break;
+    case RMWOp::FADD:
+      rmwOp = "add";
+      rmwOp += (valueElemNBits == 16 ? ".noftz" : "");
+      sTy = "f" + sBits;
+      sTy += (vec == 2 && valueElemNBits == 16) ? "x2" : "";
+      break;
+    case RMWOp::MAX:
+      sTy = "s" + sBits;
+      break;
+    case RMWOp::MIN:
+      sTy = "s" + sBits;
+      break;
+    case RMWOp::UMAX:
+      rmwOp = "max";
+      sTy = "u" + sBits;
+      break;
+    case RMWOp::UMIN:
+      rmwOp = "min";
+      sTy = "u" + sBits;
+      break;
+    case RMWOp::XCHG:
+      sTy = "b" + sBits;
+      break;
+    default:
+      return failure();
+    }
+
     auto vecTy = vec_ty(valueElemTy, vec);
     SmallVector<Value> resultVals(elemsPerThread);
-    for (size_t i = 0; i < elemsPerThread; i += vec) {
-      Value rmwVal = undef(vecTy);
-      for (int ii = 0; ii < vec; ++ii) {
-        Value iiVal = createIndexAttrConstant(
-            rewriter, loc, getTypeConverter()->getIndexType(), ii);
-        rmwVal = insert_element(vecTy, rmwVal, valElements[i + ii], iiVal);
+    for (size_t i = 0; i < elemsPerThread; i += vec * group) {
+      Value rmwVal;
+      if (group > 1) {
+        rmwVal = valElements[i];
+        for (unsigned ii = 1; ii < group; ++ii)
+          rmwVal = combine(loc, rewriter, atomicRmwAttr, rmwVal,
+                           valElements[i + ii]);
+      } else {
+        rmwVal = undef(vecTy);
+        for (int ii = 0; ii < vec; ++ii) {
+          Value iiVal = createIndexAttrConstant(
+              rewriter, loc, getTypeConverter()->getIndexType(), ii);
+          rmwVal = insert_element(vecTy, rmwVal, valElements[i + ii], iiVal);
+        }
       }
 
       Value rmwPtr = ptrElements[i];
       Value rmwMask = llMask ? and_(mask, maskElements[i]) : mask;
-      std::string sTy;
       PTXBuilder ptxBuilderAtomicRMW;
       std::string tyId = valueElemNBits * vec == 64
                              ? "l"
                              : (valueElemNBits * vec == 32 ? "r" : "h");
-      auto *dstOpr = ptxBuilderAtomicRMW.newOperand("=" + tyId, /*init=*/true);
       auto *ptrOpr = ptxBuilderAtomicRMW.newAddrOperand(rmwPtr, "l");
       auto *valOpr = ptxBuilderAtomicRMW.newOperand(rmwVal, tyId);
 
-      auto &atom = ptxBuilderAtomicRMW.create<>("atom")->global().o("gpu");
-      auto rmwOp = stringifyRMWOp(atomicRmwAttr).str();
-      auto sBits = std::to_string(valueElemNBits);
-      switch (atomicRmwAttr) {
-      case RMWOp::AND:
-        sTy = "b" + sBits;
-        break;
-      case RMWOp::OR:
-        sTy = "b" + sBits;
-        break;
-      case RMWOp::XOR:
-        sTy = "b" + sBits;
-        break;
-      case RMWOp::ADD:
-        sTy = "s" + sBits;
-        break;
-      case RMWOp::FADD:
-        rmwOp = "add";
-        rmwOp += (valueElemNBits == 16 ? ".noftz" : "");
-        sTy = "f" + sBits;
-        sTy += (vec == 2 && valueElemNBits == 16) ? "x2" : "";
-        break;
-      case RMWOp::MAX:
-        sTy = "s" + sBits;
-        break;
-      case RMWOp::MIN:
-        sTy = "s" + sBits;
-        break;
-      case RMWOp::UMAX:
-        rmwOp = "max";
-        sTy = "u" + sBits;
-        break;
-      case RMWOp::UMIN:
-        rmwOp = "min";
-        sTy = "u" + sBits;
-        break;
-      case RMWOp::XCHG:
-        sTy = "b" + sBits;
-        break;
-      default:
-        return failure();
-      }
+      auto &atom = ptxBuilderAtomicRMW.create<>(useRed ? "red" : "atom")
+                       ->global();
+      if (op.getSem())
+        atom.o(stringifyMemSemantic(*op.getSem()).str());
+      atom.o(stringifyMemSyncScope(op.getScope().value_or(MemSyncScope::GPU))
+                 .str());
       atom.o(rmwOp).o(sTy);
+      if (useRed) {
+        if (!tensorTy) {
+          PTXBuilder ptxBuilderMemfence;
+          auto memfenc = ptxBuilderMemfence.create<PTXInstr>("membar")->o(
+              getMembarLevel(op.getScope()));
+          memfenc();
+          ptxBuilderMemfence.launch(rewriter, loc, void_ty(ctx));
+        }
+        atom(ptrOpr, valOpr).predicate(rmwMask);
+        ptxBuilderAtomicRMW.launch(rewriter, loc, void_ty(ctx));
+        continue;
+      }
+      auto *dstOpr = ptxBuilderAtomicRMW.newOperand("=" + tyId, /*init=*/true);
       if (tensorTy) {
         atom(dstOpr, ptrOpr, valOpr).predicate(rmwMask);
         auto retType = vec == 1 ? valueElemTy : vecTy;
@@ -576,7 +883,8 @@ struct AtomicRMWOpConversion
         }
       } else {
         PTXBuilder ptxBuilderMemfence;
-        auto memfenc = ptxBuilderMemfence.create<PTXInstr>("membar")->o("gl");
+        auto memfenc = ptxBuilderMemfence.create<PTXInstr>("membar")->o(
+            getMembarLevel(op.getScope()));
         memfenc();
         auto ASMReturnTy = void_ty(ctx);
         ptxBuilderMemfence.launch(rewriter, loc, ASMReturnTy);
@@ -598,7 +906,9 @@ struct AtomicRMWOpConversion
         rewriter.replaceOp(op, {ret});
       }
     }
-    if (tensorTy) {
+    if (useRed) {
+      rewriter.eraseOp(op);
+    } else if (tensorTy) {
       Type structTy = getTypeConverter()->convertType(tensorTy);
       Value resultStruct = getTypeConverter()->packLLElements(
           loc, resultVals, rewriter, structTy);
@@ -606,6 +916,35 @@ struct AtomicRMWOpConversion
     }
     return success();
   }
+
+private:
+  // Applies the operation of an atomic to two values, to combine elements
+  // with the same address in registers.
+  Value combine(Location loc, ConversionPatternRewriter &rewriter,
+                RMWOp rmwOp, Value lhs, Value rhs) const {
+    switch (rmwOp) {
+    case RMWOp::AND:
+      return and_(lhs, rhs);
+    case RMWOp::OR:
+      return or_(lhs, rhs);
+    case RMWOp::XOR:
+      return xor_(lhs, rhs);
+    case RMWOp::ADD:
+      return add(lhs, rhs);
+    case RMWOp::FADD:
+      return fadd(lhs, rhs);
+    case RMWOp::MAX:
+      return smax(lhs, rhs);
+    case RMWOp::MIN:
+      return smin(lhs, rhs);
+    case RMWOp::UMAX:
+      return umax(lhs, rhs);
+    case RMWOp::UMIN:
+      return umin(lhs, rhs);
+    default:
+      llvm_unreachable("atomic cannot be combined");
+    }
+  }
 };
 
 struct InsertSliceOpConversion
@@ -705,7 +1044,12 @@ struct InsertSliceAsyncOpConversion
     assert(funcAllocation->getBufferId(res) == Allocation::InvalidBufferId &&
            "Only support in-place insert_slice_async for now");
 
-    auto srcTy = src.getType().cast<RankedTensorType>();
+    // A block pointer is copied with the layout of the mask
+    bool isTensorPtr = triton::isTensorPointerType(src.getType());
+    assert((!isTensorPtr || mask) &&
+           "insert_slice_async: a block pointer requires a mask");
+    auto srcTy = (isTensorPtr ? mask.getType() : src.getType())
+                     .cast<RankedTensorType>();
     auto resTy = dst.getType().cast<RankedTensorType>();
     auto resElemTy = getTypeConverter()->convertType(resTy.getElementType());
     auto srcBlockedLayout = srcTy.getEncoding().cast<BlockedEncodingAttr>();
@@ -721,8 +1065,16 @@ struct InsertSliceAsyncOpConversion
     Value llIndex = adaptor.getIndex();
 
     // %src
-    auto srcElems = getTypeConverter()->unpackLLElements(loc, llSrc, rewriter,
-                                                         src.getType());
+    SmallVector<Value> srcElems;
+    SmallVector<Value> boundsElems;
+    if (isTensorPtr) {
+      auto indices = emitIndices(loc, rewriter, srcBlockedLayout, srcTy);
+      srcElems = getTensorPtrElems(rewriter, loc, src, llSrc, indices,
+                                   op.getBoundaryCheck(), boundsElems);
+    } else {
+      srcElems = getTypeConverter()->unpackLLElements(loc, llSrc, rewriter,
+                                                      src.getType());
+    }
 
     // %dst
     auto dstTy = dst.getType().cast<RankedTensorType>();
@@ -752,6 +1104,9 @@ struct InsertSliceAsyncOpConversion
                                                        mask.getType());
       assert(srcElems.size() == maskElems.size());
     }
+    for (auto inBounds : llvm::enumerate(boundsElems))
+      maskElems[inBounds.index()] =
+          and_(maskElems[inBounds.index()], inBounds.value());
 
     // %other
     SmallVector<Value> otherElems;
@@ -768,9 +1123,11 @@ struct InsertSliceAsyncOpConversion
     // We don't use getVec() here because we are copying from memory to memory.
     // If contiguity > vector size, we can have one pointer maintaining the
     // start of the vector and the other pointer moving to the next vector.
-    unsigned inVec = getContiguity(src);
+    unsigned inVec = isTensorPtr ? axisAnalysisPass.getTensorPtrContiguity(
+                                       src, srcTy, op.getBoundaryCheck())
+                                 : getContiguity(src);
     unsigned outVec = resSharedLayout.getVec();
-    unsigned minVec = std::min(outVec, inVec);
+    unsigned minVec = getSharedAccessVec(inVec, resSharedLayout);
     unsigned numElems = getTotalElemsPerThread(srcTy);
     unsigned perPhase = resSharedLayout.getPerPhase();
     unsigned maxPhase = resSharedLayout.getMaxPhase();
@@ -821,7 +1178,7 @@ struct InsertSliceAsyncOpConversion
             ptxBuilder.newAddrOperand(srcElems[elemIdx + wordElemIdx], "l");
         auto *copySize = ptxBuilder.newConstantOperand(byteWidth);
         auto *srcSize = copySize;
-        if (op.getMask()) {
+        if (!maskElems.empty()) {
           // We don't use predicate in this case, setting src-size to 0
           // if there's any mask. cp.async will automatically fill the
           // remaining slots with 0 if cp-size > src-size.
@@ -840,17 +1197,119 @@ struct InsertSliceAsyncOpConversion
   }
 };
 
+// The bounds, in nanoseconds, of the exponential backoff between the polls
+// of a semaphore.
+static constexpr unsigned kSemaphoreMinBackoff = 32;
+static constexpr unsigned kSemaphoreMaxBackoff = 1024;
+
+struct SemaphoreWaitOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::SemaphoreWaitOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::SemaphoreWaitOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::SemaphoreWaitOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op.getLoc();
+    std::string sem = stringifyMemSemantic(op.getSem()).str();
+    std::string scope = stringifyMemSyncScope(op.getScope()).str();
+
+    // Thread 0 polls the semaphore, sleeping longer after each miss, while
+    // the other threads wait at the barrier:
+    // #prev
+    //   cond_br tid == 0, #poll(minBackoff), #tail
+    // #poll(backoff)
+    //   cond_br ld.<sem>.<scope>(ptr) == value, #tail, #sleep
+    // #sleep
+    //   nanosleep(backoff)
+    //   br #poll(min(2 * backoff, maxBackoff))
+    // #tail
+    //   bar.sync
+    Block *prevBlock = op->getBlock();
+    Block *tailBlock = rewriter.splitBlock(prevBlock, op->getIterator());
+    Block *sleepBlock = rewriter.createBlock(tailBlock);
+    Block *pollBlock = rewriter.createBlock(
+        sleepBlock, SmallVector<Type>{i32_ty}, SmallVector<Location>{loc});
+
+    rewriter.setInsertionPointToEnd(prevBlock);
+    rewriter.create<cf::CondBranchOp>(
+        loc, icmp_eq(tid_val(), i32_val(0)), pollBlock,
+        ValueRange{i32_val(kSemaphoreMinBackoff)}, tailBlock, ValueRange{});
+
+    rewriter.setInsertionPointToStart(pollBlock);
+    PTXBuilder ptxBuilderLoad;
+    auto *dstOpr = ptxBuilderLoad.newOperand("=r");
+    auto *ptrOpr = ptxBuilderLoad.newAddrOperand(adaptor.getPtr(), "l");
+    auto &ld = *ptxBuilderLoad.create<>("ld");
+    ld.o(sem).o(scope).global().b(32);
+    ld(dstOpr, ptrOpr);
+    Value current = ptxBuilderLoad.launch(rewriter, loc, i32_ty);
+    rewriter.create<cf::CondBranchOp>(loc,
+                                      icmp_eq(current, adaptor.getValue()),
+                                      tailBlock, sleepBlock);
+
+    rewriter.setInsertionPointToStart(sleepBlock);
+    Value backoff = pollBlock->getArgument(0);
+    PTXBuilder ptxBuilderSleep;
+    auto &sleep = *ptxBuilderSleep.create<>("nanosleep");
+    sleep.o("u32");
+    sleep(ptxBuilderSleep.newOperand(backoff, "r"));
+    ptxBuilderSleep.launch(rewriter, loc, void_ty(rewriter.getContext()));
+    Value next = umin(shl(backoff, i32_val(1)), i32_val(kSemaphoreMaxBackoff));
+    rewriter.create<cf::BranchOp>(loc, pollBlock, ValueRange{next});
+
+    rewriter.setInsertionPointToStart(tailBlock);
+    barrier();
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
+struct SemaphoreSignalOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::SemaphoreSignalOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::SemaphoreSignalOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::SemaphoreSignalOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op.getLoc();
+    std::string sem = stringifyMemSemantic(op.getSem()).str();
+    std::string scope = stringifyMemSyncScope(op.getScope()).str();
+
+    // the accesses of all the threads are done before thread 0 signals, so
+    // that the release ordering covers them
+    barrier();
+    PTXBuilder ptxBuilder;
+    auto *ptrOpr = ptxBuilder.newAddrOperand(adaptor.getPtr(), "l");
+    auto *valOpr = ptxBuilder.newOperand(adaptor.getValue(), "r");
+    auto &signal = *ptxBuilder.create<>(op.getAdd() ? "red" : "st");
+    if (op.getAdd())
+      signal.global().o(sem).o(scope).o("add").o("s32");
+    else
+      signal.o(sem).o(scope).global().b(32);
+    signal(ptrOpr, valOpr).predicate(icmp_eq(tid_val(), i32_val(0)));
+    ptxBuilder.launch(rewriter, loc, void_ty(rewriter.getContext()));
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
 void populateLoadStoreOpToLLVMPatterns(
     TritonGPUToLLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
     ModuleAxisInfoAnalysis &axisInfoAnalysis, ModuleAllocation &allocation,
     ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
     PatternBenefit benefit) {
-  patterns.add<LoadOpConversion>(typeConverter, axisInfoAnalysis, benefit);
-  patterns.add<StoreOpConversion>(typeConverter, axisInfoAnalysis, benefit);
-  patterns.add<AtomicCASOpConversion>(typeConverter, allocation,
+  patterns.add<LoadOpConversion>(typeConverter, indexCacheInfo,
+                                 axisInfoAnalysis, benefit);
+  patterns.add<StoreOpConversion>(typeConverter, indexCacheInfo,
+                                  axisInfoAnalysis, benefit);
+  patterns.add<AtomicCASOpConversion>(typeConverter, allocation, indexCacheInfo,
                                       axisInfoAnalysis, benefit);
-  patterns.add<AtomicRMWOpConversion>(typeConverter, allocation,
+  patterns.add<AtomicRMWOpConversion>(typeConverter, allocation, indexCacheInfo,
                                       axisInfoAnalysis, benefit);
+  patterns.add<SemaphoreWaitOpConversion>(typeConverter, benefit);
+  patterns.add<SemaphoreSignalOpConversion>(typeConverter, benefit);
   patterns.add<InsertSliceOpConversion>(typeConverter, allocation,
                                         indexCacheInfo, benefit);
   patterns.add<InsertSliceAsyncOpConversion>(
@@ -1,4 +1,5 @@
 #include "ReduceOpToLLVM.h"
+#include "llvm/ADT/TypeSwitch.h"
 
 using namespace mlir;
 using namespace mlir::triton;
@@ -11,8 +12,13 @@ using ::mlir::triton::gpu::getTotalElemsPerThread;
 struct ReduceOpConversion
     : public ConvertTritonGPUOpToLLVMPattern<triton::ReduceOp> {
 public:
-  using ConvertTritonGPUOpToLLVMPattern<
-      triton::ReduceOp>::ConvertTritonGPUOpToLLVMPattern;
+  ReduceOpConversion(
+      TritonGPUToLLVMTypeConverter &typeConverter, ModuleAllocation &allocation,
+      ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
+      int computeCapability, PatternBenefit benefit)
+      : ConvertTritonGPUOpToLLVMPattern<triton::ReduceOp>(
+            typeConverter, allocation, indexCacheInfo, benefit),
+        computeCapability(computeCapability) {}
 
   LogicalResult
   matchAndRewrite(triton::ReduceOp op, OpAdaptor adaptor,
@@ -59,6 +65,158 @@ private:
     rewriter.eraseOp(returnOp);
   }
 
+  // Returns the redux.sync operation and type equivalent to the combine
+  // region when it is a single integer add, min, max or bitwise op of at most
+  // 32 bits, which redux.sync reduces in one instruction on sm_80+.
+  std::optional<std::pair<StringRef, StringRef>>
+  getReduxSyncKind(triton::ReduceOp op) const {
+    if (computeCapability < 80 || op.getNumOperands() != 1)
+      return std::nullopt;
+    auto elemTy = op.getInputTypes()[0].getElementType();
+    if (!elemTy.isInteger(8) && !elemTy.isInteger(16) && !elemTy.isInteger(32))
+      return std::nullopt;
+    Block &block = op.getCombineOp().front();
+    if (block.getOperations().size() != 2)
+      return std::nullopt;
+    Operation *combine = &block.front();
+    if (combine->getNumOperands() != 2 || combine->getNumResults() != 1 ||
+        block.getTerminator()->getOperand(0) != combine->getResult(0))
+      return std::nullopt;
+    if (!llvm::is_contained(combine->getOperands(), block.getArgument(0)) ||
+        !llvm::is_contained(combine->getOperands(), block.getArgument(1)))
+      return std::nullopt;
+    using Kind = std::pair<StringRef, StringRef>;
+    return llvm::TypeSwitch<Operation *, std::optional<Kind>>(combine)
+        .Case<arith::AddIOp>([](auto) { return Kind("add", "s32"); })
+        .Case<arith::MinSIOp>([](auto) { return Kind("min", "s32"); })
+        .Case<arith::MaxSIOp>([](auto) { return Kind("max", "s32"); })
+        .Case<arith::MinUIOp>([](auto) { return Kind("min", "u32"); })
+        .Case<arith::MaxUIOp>([](auto) { return Kind("max", "u32"); })
+        .Case<arith::AndIOp>([](auto) { return Kind("and", "b32"); })
+        .Case<arith::OrIOp>([](auto) { return Kind("or", "b32"); })
+        .Case<arith::XOrIOp>([](auto) { return Kind("xor", "b32"); })
+        .Default([](auto) { return std::nullopt; });
+  }
+
+  Value reduxSync(Location loc, ConversionPatternRewriter &rewriter, Value val,
+                  std::pair<StringRef, StringRef> kind, Value mask) const {
+    Type ty = val.getType();
+    bool isNarrow = ty.getIntOrFloatBitWidth() < 32;
+    if (isNarrow)
+      val = kind.second == "s32" ? sext(i32_ty, val) : zext(i32_ty, val);
+    PTXBuilder builder;
+    auto &redux =
+        builder.create("redux.sync")->o(kind.first.str()).o(kind.second.str());
+    auto *dOpr = builder.newOperand("=r");
+    auto *aOpr = builder.newOperand(val, "r");
+    auto *maskOpr = builder.newOperand(mask, "r");
+    redux(dOpr, aOpr, maskOpr);
+    Value res = builder.launch(rewriter, loc, i32_ty, false);
+    if (isNarrow)
+      res = rewriter.create<LLVM::TruncOp>(loc, ty, res);
+    return res;
+  }
+
+  // Shuffles `vals` across the lanes with the butterfly pattern `N`. Pairs of
+  // consecutive 16-bit values share a 32-bit shuffle.
+  SmallVector<Value> shflSyncPacked(Location loc,
+                                    ConversionPatternRewriter &rewriter,
+                                    ArrayRef<Value> vals, unsigned N) const {
+    auto is16Bit = [](Type ty) {
+      return ty.isIntOrFloat() && ty.getIntOrFloatBitWidth() == 16;
+    };
+    auto toI16 = [&](Value val) {
+      return val.getType().isInteger(16) ? val : bitcast(val, i16_ty);
+    };
+    auto fromI16 = [&](Value val, Type ty) {
+      return ty.isInteger(16) ? val : bitcast(val, ty);
+    };
+    SmallVector<Value> shfl(vals.size());
+    for (unsigned i = 0; i < vals.size(); ++i) {
+      bool canPack = i + 1 < vals.size() && is16Bit(vals[i].getType()) &&
+                     is16Bit(vals[i + 1].getType());
+      if (!canPack) {
+        shfl[i] = shflSync(loc, rewriter, vals[i], N);
+        continue;
+      }
+      Type vecTy = vec_ty(i16_ty, 2);
+      Value vec = undef(vecTy);
+      vec = insert_element(vecTy, vec, toI16(vals[i]), i32_val(0));
+      vec = insert_element(vecTy, vec, toI16(vals[i + 1]), i32_val(1));
+      vec = bitcast(shflSync(loc, rewriter, bitcast(vec, i32_ty), N), vecTy);
+      shfl[i] = fromI16(extract_element(i16_ty, vec, i32_val(0)),
+                        vals[i].getType());
+      shfl[i + 1] = fromI16(extract_element(i16_ty, vec, i32_val(1)),
+                            vals[i + 1].getType());
+      ++i;
+    }
+    return shfl;
+  }
+
+  // Reduces each of `accs` across the groups of `numLanes` consecutive lanes
+  // of the warp. The accumulators are shuffled together so that 16-bit values
+  // can be packed, and redux.sync replaces the shuffles when it applies.
+  void warpReduce(ConversionPatternRewriter &rewriter, Location loc,
+                  triton::ReduceOp op, ArrayRef<SmallVector<Value> *> accs,
+                  unsigned numLanes, Value laneId) const {
+    if (numLanes == 1)
+      return;
+    // redux.sync reduces the lanes of a 32-thread warp
+    auto kind = numLanes <= 32 ? getReduxSyncKind(op) : std::nullopt;
+    if (kind) {
+      Value mask = numLanes == 32
+                       ? i32_val(-1)
+                       : shl(i32_val((1 << numLanes) - 1),
+                             and_(laneId, i32_val(~int(numLanes - 1))));
+      for (auto *acc : accs)
+        (*acc)[0] = reduxSync(loc, rewriter, (*acc)[0], *kind, mask);
+      return;
+    }
+    unsigned numOperands = op.getNumOperands();
+    for (unsigned N = numLanes / 2; N > 0; N >>= 1) {
+      // All the operands are exchanged at once
+      SmallVector<Value> vals;
+      for (unsigned i = 0; i < numOperands; ++i)
+        for (auto *acc : accs)
+          vals.push_back((*acc)[i]);
+      auto shflVals = shflSyncPacked(loc, rewriter, vals, N);
+      SmallVector<SmallVector<Value>> shfl(accs.size(),
+                                           SmallVector<Value>(numOperands));
+      for (unsigned i = 0; i < numOperands; ++i)
+        for (unsigned k = 0; k < accs.size(); ++k)
+          shfl[k][i] = shflVals[i * accs.size() + k];
+      for (unsigned k = 0; k < accs.size(); ++k)
+        accumulate(rewriter, op.getCombineOp(), *accs[k], shfl[k], false);
+    }
+  }
+
+  // Packs the results of a warp-synchronous reduction from the accumulators
+  // of the reduced rows, keyed by their offsets with the axis set to 0.
+  SmallVector<Value> packWarpSyncResults(
+      Location loc, ConversionPatternRewriter &rewriter, triton::ReduceOp op,
+      std::map<SmallVector<unsigned>, SmallVector<Value>> &accs) const {
+    unsigned axis = op.getAxis();
+    SmallVector<Value> results(op.getNumOperands());
+    for (unsigned i = 0; i < op.getNumOperands(); ++i) {
+      auto resultTy = op.getResult()[i].getType().dyn_cast<RankedTensorType>();
+      if (!resultTy) {
+        // 0d-tensor -> scalar
+        results[i] = accs.begin()->second[i];
+        continue;
+      }
+      auto resultLayout = resultTy.getEncoding().cast<SliceEncodingAttr>();
+      auto resultOffsets = emitOffsetForLayout(resultLayout, resultTy);
+      SmallVector<Value> resultVals;
+      for (auto key : resultOffsets) {
+        key.insert(key.begin() + axis, 0);
+        resultVals.push_back(accs[key][i]);
+      }
+      results[i] = getTypeConverter()->packLLElements(loc, resultVals,
+                                                      rewriter, resultTy);
+    }
+    return results;
+  }
+
   SmallVector<SmallVector<Value>>
   unpackInputs(Location loc, triton::ReduceOp op, OpAdaptor adaptor,
                ConversionPatternRewriter &rewriter) const {
@@ -110,7 +268,7 @@ private:
       // writeIdx[axis] = index[axis] / axisSizePerThread
       writeIdx[axis] = udiv(index[axis], axisSizePerThread);
     } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
-      if (!mmaLayout.isAmpere()) {
+      if (!mmaLayout.isAmpere() && !mmaLayout.isHopper()) {
         llvm::report_fatal_error("Unsupported layout");
       }
       if (axis == 0) {
@@ -323,19 +481,6 @@ private:
     auto llvmIndexTy = getTypeConverter()->getIndexType();
     auto indexPtrTy = LLVM::LLVMPointerType::get(llvmIndexTy, 3);
 
-    auto smemShapes = helper.getScratchConfigsFast();
-    unsigned elems = product<unsigned>(smemShapes[0]);
-    unsigned maxElems = std::max(elems, product<unsigned>(smemShapes[1]));
-
-    SmallVector<Value> smemBases(op.getNumOperands());
-    smemBases[0] = bitcast(
-        getSharedMemoryBase(loc, rewriter, op.getOperation()), elemPtrTys[0]);
-    for (unsigned i = 1; i < op.getNumOperands(); ++i) {
-      smemBases[i] =
-          bitcast(gep(elemPtrTys[i - 1], smemBases[i - 1], i32_val(maxElems)),
-                  elemPtrTys[i]);
-    }
-
     unsigned sizeIntraWarps = helper.getIntraWarpSize();
     unsigned sizeInterWarps = helper.getInterWarpSize();
 
@@ -363,7 +508,8 @@ private:
     }
 
     Value threadId = getThreadId(rewriter, loc);
-    Value warpSize = i32_val(32);
+    Value warpSize = i32_val(triton::gpu::TritonGPUDialect::getThreadsPerWarp(
+        op->getParentOfType<ModuleOp>()));
     Value warpId = udiv(threadId, warpSize);
     Value laneId = urem(threadId, warpSize);
 
@@ -381,19 +527,36 @@ private:
     Value zero = i32_val(0);
     Value laneZero = icmp_eq(laneIdAxis, zero);
 
+    // Reduce within warps
+    SmallVector<SmallVector<Value> *> warpAccs;
+    for (auto &it : accs)
+      warpAccs.push_back(&it.second);
+    warpReduce(rewriter, loc, op, warpAccs, sizeIntraWarps, laneId);
+
+    // Every lane holds the reduced values of its rows when no other warp
+    // takes part in the reduction, so the results need no shared memory.
+    if (helper.isWarpSynchronous()) {
+      rewriter.replaceOp(op, packWarpSyncResults(loc, rewriter, op, accs));
+      return success();
+    }
+
+    auto smemShapes = helper.getScratchConfigsFast();
+    unsigned elems = product<unsigned>(smemShapes[0]);
+    unsigned maxElems = std::max(elems, product<unsigned>(smemShapes[1]));
+
+    SmallVector<Value> smemBases(op.getNumOperands());
+    smemBases[0] = bitcast(
+        getSharedMemoryBase(loc, rewriter, op.getOperation()), elemPtrTys[0]);
+    for (unsigned i = 1; i < op.getNumOperands(); ++i) {
+      smemBases[i] =
+          bitcast(gep(elemPtrTys[i - 1], smemBases[i - 1], i32_val(maxElems)),
+                  elemPtrTys[i]);
+    }
+
     for (auto it : accs) {
       const SmallVector<unsigned> &key = it.first;
       SmallVector<Value> acc = it.second;
 
-      // Reduce within warps
-      for (unsigned N = sizeIntraWarps / 2; N > 0; N >>= 1) {
-        SmallVector<Value> shfl(op.getNumOperands());
-        for (unsigned i = 0; i < op.getNumOperands(); ++i) {
-          shfl[i] = shflSync(loc, rewriter, acc[i], N);
-        }
-        accumulate(rewriter, *combineOp, acc, shfl, false);
-      }
-
       SmallVector<Value> writeIdx = indices[key];
       writeIdx[axis] = (sizeInterWarps == 1) ? zero : warpIdAxis;
       Value writeOffset =
@@ -413,7 +576,9 @@ private:
     // Each thread needs to process:
     //   elemsPerThread = sizeInterWarps * s1 * s2 .. Sn / numThreads
     unsigned numThreads =
-        product<unsigned>(triton::gpu::getWarpsPerCTA(srcLayout)) * 32;
+        product<unsigned>(triton::gpu::getWarpsPerCTA(srcLayout)) *
+        triton::gpu::TritonGPUDialect::getThreadsPerWarp(
+            op->getParentOfType<ModuleOp>());
     unsigned elemsPerThread = std::max<unsigned>(elems / numThreads, 1);
     Value readOffset = threadId;
     for (unsigned round = 0; round < elemsPerThread; ++round) {
@@ -425,13 +590,7 @@ private:
         acc[i] = load(readPtr);
       }
 
-      for (unsigned N = sizeInterWarps / 2; N > 0; N >>= 1) {
-        SmallVector<Value> shfl(op.getNumOperands());
-        for (unsigned i = 0; i < op.getNumOperands(); ++i) {
-          shfl[i] = shflSync(loc, rewriter, acc[i], N);
-        }
-        accumulate(rewriter, *combineOp, acc, shfl, false);
-      }
+      warpReduce(rewriter, loc, op, {&acc}, sizeInterWarps, laneId);
 
       // only the first thread in each sizeInterWarps is writing
       Value writeOffset = readOffset;
@@ -491,13 +650,15 @@ private:
 
     return success();
   }
+
+  int computeCapability;
 };
 
 void populateReduceOpToLLVMPatterns(
     TritonGPUToLLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
     ModuleAllocation &allocation,
     ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
-    PatternBenefit benefit) {
+    int computeCapability, PatternBenefit benefit) {
   patterns.add<ReduceOpConversion>(typeConverter, allocation, indexCacheInfo,
-                                   benefit);
+                                   computeCapability, benefit);
 }
@@ -0,0 +1,276 @@
+#include "ScanOpToLLVM.h"
+#include "triton/Analysis/Utility.h"
+
+using namespace mlir;
+using namespace mlir::triton;
+
+using ::mlir::LLVM::shflUpSync;
+using ::mlir::LLVM::storeShared;
+using ::mlir::triton::gpu::getOrder;
+using ::mlir::triton::gpu::getTotalElemsPerThread;
+
+// Apply the combine region to (acc, cur) by inlining a new copy of it at the
+// current insertion point.
+static SmallVector<Value> accumulate(ConversionPatternRewriter &rewriter,
+                                     Region &combineOp, ValueRange acc,
+                                     ValueRange cur) {
+  // Create a new copy of the scan block, and inline it
+  Block *currentBlock = rewriter.getBlock();
+  Region &parent = *currentBlock->getParent();
+  rewriter.cloneRegionBefore(combineOp, &parent.front());
+  auto &newScan = parent.front();
+  auto returnOp = dyn_cast<triton::ScanReturnOp>(newScan.getTerminator());
+
+  SmallVector<Value> combineArgs(acc.begin(), acc.end());
+  combineArgs.append(cur.begin(), cur.end());
+  rewriter.inlineBlockBefore(&newScan, &*rewriter.getInsertionPoint(),
+                             combineArgs);
+
+  SmallVector<Value> results(returnOp.getResult().begin(),
+                             returnOp.getResult().end());
+  // Delete the terminator, which is no longer used
+  rewriter.eraseOp(returnOp);
+  return results;
+}
+
+static SmallVector<Value> selectValues(ConversionPatternRewriter &rewriter,
+                                       Location loc, Value cond,
+                                       ValueRange trueValues,
+                                       ValueRange falseValues) {
+  SmallVector<Value> results(trueValues.size());
+  for (unsigned i = 0; i < trueValues.size(); ++i)
+    results[i] = select(cond, trueValues[i], falseValues[i]);
+  return results;
+}
+
+struct ScanOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::ScanOp> {
+public:
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::ScanOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  // The scan is done in three steps:
+  //   1. every thread scans the elements it owns along the axis,
+  //   2. the thread totals are scanned across the lanes of a warp with
+  //      shuffles and the exclusive lane prefix is combined into the elements,
+  //   3. the warp totals are exchanged through shared memory and the
+  //      exclusive warp prefix is combined into the elements.
+  // When the CTA tile is repeated along the axis, the totals of the previous
+  // repetitions are carried into the prefix of the next one in step 3.
+  LogicalResult
+  matchAndRewrite(triton::ScanOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    ScanLoweringHelper helper(op);
+    if (!helper.isSupported())
+      return failure();
+
+    Location loc = op.getLoc();
+    unsigned axis = helper.getAxis();
+    unsigned numOperands = op.getNumOperands();
+    auto srcTys = op.getInputTypes();
+    auto srcLayout = helper.getEncoding();
+    auto order = getOrder(srcLayout);
+
+    unsigned axisSizePerThread = helper.getAxisNumElementsPerThread();
+    unsigned axisNumThreads = helper.getAxisNumThreadsPerWarp();
+    unsigned axisNumWarps = helper.getAxisNumWarps();
+    unsigned axisNumBlocks = helper.getAxisNumBlocks();
+    bool needsSharedMemory = axisNumWarps * axisNumBlocks > 1;
+
+    // srcValues[i] holds the values of all operands for the i-th element
+    unsigned srcElems = getTotalElemsPerThread(srcTys[0]);
+    SmallVector<SmallVector<Value>> srcValues(srcElems);
+    for (unsigned i = 0; i < numOperands; ++i) {
+      auto values = getTypeConverter()->unpackLLElements(
+          loc, adaptor.getOperands()[i], rewriter, srcTys[i]);
+      assert(values.size() == srcValues.size());
+      for (unsigned j = 0; j < srcElems; ++j)
+        srcValues[j].push_back(values[j]);
+    }
+    auto srcIndices = emitIndices(loc, rewriter, srcLayout, srcTys[0]);
+
+    // Group the elements of each thread by their position in the non-scanned
+    // dimensions, sorted along the scan axis.
+    // NOTE: Assumes offsets don't actually depend on type
+    SmallVector<SmallVector<unsigned>> offset =
+        emitOffsetForLayout(srcLayout, srcTys[0]);
+    std::map<SmallVector<unsigned>, SmallVector<unsigned>> rows;
+    for (unsigned i = 0; i < srcElems; ++i) {
+      SmallVector<unsigned> key = offset[i];
+      key[axis] = 0;
+      rows[key].push_back(i);
+    }
+    for (auto &it : rows)
+      llvm::sort(it.second, [&](unsigned lhs, unsigned rhs) {
+        return offset[lhs][axis] < offset[rhs][axis];
+      });
+
+    Value threadId = getThreadId(rewriter, loc);
+    Value warpSize = i32_val(triton::gpu::TritonGPUDialect::getThreadsPerWarp(
+        op->getParentOfType<ModuleOp>()));
+    Value warpId = udiv(threadId, warpSize);
+    Value laneId = urem(threadId, warpSize);
+    auto threadsPerWarp = triton::gpu::getThreadsPerWarp(srcLayout);
+    auto warpsPerCTA = triton::gpu::getWarpsPerCTA(srcLayout);
+    SmallVector<Value> multiDimLaneId =
+        delinearize(rewriter, loc, laneId, threadsPerWarp, order);
+    SmallVector<Value> multiDimWarpId =
+        delinearize(rewriter, loc, warpId, warpsPerCTA, order);
+    // Threads and warps beyond the unique data along the axis hold copies of
+    // the same elements and thus compute the same values.
+    Value laneIdAxis = urem(multiDimLaneId[axis], i32_val(axisNumThreads));
+    Value warpIdAxis = urem(multiDimWarpId[axis], i32_val(axisNumWarps));
+    Value zero = i32_val(0);
+    // Distance between two consecutive lanes along the axis
+    unsigned laneStride = 1;
+    for (unsigned d : order) {
+      if (d == axis)
+        break;
+      laneStride *= threadsPerWarp[d];
+    }
+
+    SmallVector<Type> elemPtrTys(numOperands);
+    SmallVector<Value> smemBases(numOperands);
+    auto smemShape = helper.getScratchConfig();
+    if (needsSharedMemory) {
+      for (unsigned i = 0; i < numOperands; ++i) {
+        auto llvmElemTy =
+            getTypeConverter()->convertType(srcTys[i].getElementType());
+        elemPtrTys[i] = LLVM::LLVMPointerType::get(llvmElemTy, 3);
+      }
+      unsigned elems = product<unsigned>(smemShape);
+      smemBases[0] =
+          bitcast(getSharedMemoryBase(loc, rewriter, op.getOperation()),
+                  elemPtrTys[0]);
+      for (unsigned i = 1; i < numOperands; ++i) {
+        smemBases[i] =
+            bitcast(gep(elemPtrTys[i - 1], smemBases[i - 1], i32_val(elems)),
+                    elemPtrTys[i]);
+      }
+    }
+
+    Region &combineOp = op.getCombineOp();
+    for (auto &it : rows) {
+      const SmallVector<unsigned> &elems = it.second;
+      unsigned numBlocks = elems.size() / axisSizePerThread;
+      for (unsigned blk = 0; blk < numBlocks; ++blk) {
+        unsigned first = blk * axisSizePerThread;
+        // 1. Scan within threads
+        for (unsigned e = 1; e < axisSizePerThread; ++e) {
+          srcValues[elems[first + e]] =
+              accumulate(rewriter, combineOp, srcValues[elems[first + e - 1]],
+                         srcValues[elems[first + e]]);
+        }
+
+        // 2. Scan within warps
+        SmallVector<Value> acc =
+            srcValues[elems[first + axisSizePerThread - 1]];
+        for (unsigned N = 1; N < axisNumThreads; N <<= 1) {
+          SmallVector<Value> shfl(numOperands);
+          for (unsigned i = 0; i < numOperands; ++i)
+            shfl[i] = shflUpSync(loc, rewriter, acc[i], N * laneStride);
+          auto combined = accumulate(rewriter, combineOp, shfl, acc);
+          acc = selectValues(rewriter, loc, icmp_uge(laneIdAxis, i32_val(N)),
+                             combined, acc);
+        }
+        if (axisNumThreads > 1) {
+          // The exclusive prefix of a lane is the inclusive one of the
+          // previous lane
+          SmallVector<Value> lanePrefix(numOperands);
+          for (unsigned i = 0; i < numOperands; ++i)
+            lanePrefix[i] = shflUpSync(loc, rewriter, acc[i], laneStride);
+          Value hasLanePrefix = icmp_ne(laneIdAxis, zero);
+          for (unsigned e = 0; e < axisSizePerThread; ++e) {
+            auto &cur = srcValues[elems[first + e]];
+            auto combined = accumulate(rewriter, combineOp, lanePrefix, cur);
+            cur = selectValues(rewriter, loc, hasLanePrefix, combined, cur);
+          }
+        }
+
+        // The last lane along the axis publishes the total of its warp
+        if (needsSharedMemory) {
+          SmallVector<Value> writeIdx = srcIndices[elems[first]];
+          writeIdx[axis] = add(i32_val(blk * axisNumWarps), warpIdAxis);
+          Value writeOffset =
+              linearize(rewriter, loc, writeIdx, smemShape, order);
+          Value isLastLane =
+              icmp_eq(laneIdAxis, i32_val(axisNumThreads - 1));
+          for (unsigned i = 0; i < numOperands; ++i) {
+            Value writePtr = gep(elemPtrTys[i], smemBases[i], writeOffset);
+            storeShared(rewriter, loc, writePtr, acc[i], isLastLane);
+          }
+        }
+      }
+    }
+
+    // 3. Scan across warps and repetitions of the CTA tile
+    if (needsSharedMemory) {
+      barrier();
+      for (auto &it : rows) {
+        const SmallVector<unsigned> &elems = it.second;
+        unsigned numBlocks = elems.size() / axisSizePerThread;
+        SmallVector<Value> readIdx = srcIndices[elems[0]];
+        // Combination of all the warp totals read so far
+        SmallVector<Value> running;
+        for (unsigned blk = 0; blk < numBlocks; ++blk) {
+          // Exclusive prefix of the warp of this thread
+          SmallVector<Value> warpPrefix;
+          for (unsigned w = 0; w < axisNumWarps; ++w) {
+            if (!running.empty()) {
+              warpPrefix = warpPrefix.empty()
+                               ? running
+                               : selectValues(rewriter, loc,
+                                              icmp_eq(warpIdAxis, i32_val(w)),
+                                              running, warpPrefix);
+            }
+            readIdx[axis] = i32_val(blk * axisNumWarps + w);
+            Value readOffset =
+                linearize(rewriter, loc, readIdx, smemShape, order);
+            SmallVector<Value> total(numOperands);
+            for (unsigned i = 0; i < numOperands; ++i) {
+              Value readPtr = gep(elemPtrTys[i], smemBases[i], readOffset);
+              total[i] = load(readPtr);
+            }
+            running = running.empty()
+                          ? total
+                          : accumulate(rewriter, combineOp, running, total);
+          }
+          if (warpPrefix.empty())
+            continue;
+          // Only the first warp of the first repetition has no prefix
+          Value hasWarpPrefix;
+          if (blk == 0)
+            hasWarpPrefix = icmp_ne(warpIdAxis, zero);
+          for (unsigned e = 0; e < axisSizePerThread; ++e) {
+            auto &cur = srcValues[elems[blk * axisSizePerThread + e]];
+            auto combined = accumulate(rewriter, combineOp, warpPrefix, cur);
+            cur = hasWarpPrefix ? selectValues(rewriter, loc, hasWarpPrefix,
+                                               combined, cur)
+                                : combined;
+          }
+        }
+      }
+    }
+
+    // set output values
+    SmallVector<Value> results(numOperands);
+    for (unsigned i = 0; i < numOperands; ++i) {
+      SmallVector<Value> resultVals(srcElems);
+      for (unsigned j = 0; j < srcElems; ++j)
+        resultVals[j] = srcValues[j][i];
+      results[i] = getTypeConverter()->packLLElements(loc, resultVals,
+                                                      rewriter, srcTys[i]);
+    }
+    rewriter.replaceOp(op, results);
+    return success();
+  }
+};
+
+void populateScanOpToLLVMPatterns(
+    TritonGPUToLLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
+    ModuleAllocation &allocation,
+    ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
+    PatternBenefit benefit) {
+  patterns.add<ScanOpConversion>(typeConverter, allocation, indexCacheInfo,
+                                 benefit);
+}
@@ -0,0 +1,210 @@
+#include "SortOpToLLVM.h"
+#include "triton/Analysis/Utility.h"
+
+using namespace mlir;
+using namespace mlir::triton;
+
+using ::mlir::LLVM::shflSync;
+using ::mlir::triton::gpu::getOrder;
+using ::mlir::triton::gpu::getTotalElemsPerThread;
+
+// Returns true if `lhs` comes before `rhs` in ascending order. bf16 values are
+// stored as i16 and compared as f32.
+static Value lessThan(ConversionPatternRewriter &rewriter, Location loc,
+                      Type elemTy, bool isUnsigned, Value lhs, Value rhs) {
+  if (elemTy.isBF16()) {
+    auto toF32 = [&](Value val) {
+      return bitcast(shl(zext(i32_ty, val), i32_val(16)), f32_ty);
+    };
+    return fcmp_olt(toF32(lhs), toF32(rhs));
+  }
+  if (elemTy.isa<FloatType>())
+    return fcmp_olt(lhs, rhs);
+  return isUnsigned ? icmp_ult(lhs, rhs) : icmp_slt(lhs, rhs);
+}
+
+template <typename SourceOp>
+struct SortOpConversion : public ConvertTritonGPUOpToLLVMPattern<SourceOp> {
+public:
+  using ConvertTritonGPUOpToLLVMPattern<
+      SourceOp>::ConvertTritonGPUOpToLLVMPattern;
+  using OpAdaptor = typename SourceOp::Adaptor;
+
+  // The operands are sorted along the axis by a bitonic network. For each
+  // size k of the bitonic sequences, the steps j = k/2, ..., 1
+  // compare-exchange the elements whose positions differ by j:
+  //   1. within threads when j is below the contiguous elements per thread,
+  //   2. across the lanes of a warp with shuffles when j is below the
+  //      elements per warp,
+  //   3. through shared memory otherwise.
+  // A top-k sorts in descending order and reads the first k elements along
+  // the axis back from shared memory in the layout of the results.
+  LogicalResult
+  matchAndRewrite(SourceOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    constexpr bool isTopK = std::is_same_v<SourceOp, triton::TopKOp>;
+    SortLoweringHelper helper(op);
+    Location loc = op.getLoc();
+    unsigned axis = helper.getAxis();
+    unsigned axisSize = helper.getSrcShape()[axis];
+    unsigned numOperands = op.getOperands().size();
+    auto srcLayout = helper.getEncoding();
+    auto order = getOrder(srcLayout);
+    bool descending = true;
+    if constexpr (!isTopK)
+      descending = op.getDescending();
+    bool isUnsigned = op.getIsUnsigned();
+
+    SmallVector<RankedTensorType> srcTys;
+    SmallVector<Type> elemTys;
+    for (auto operand : op.getOperands()) {
+      srcTys.push_back(operand.getType().template cast<RankedTensorType>());
+      elemTys.push_back(srcTys.back().getElementType());
+    }
+
+    // srcValues[i] holds the values of all operands for the i-th element
+    unsigned srcElems = getTotalElemsPerThread(srcTys[0]);
+    SmallVector<SmallVector<Value>> srcValues(srcElems);
+    for (unsigned i = 0; i < numOperands; ++i) {
+      auto values = this->getTypeConverter()->unpackLLElements(
+          loc, adaptor.getOperands()[i], rewriter, srcTys[i]);
+      assert(values.size() == srcValues.size());
+      for (unsigned j = 0; j < srcElems; ++j)
+        srcValues[j].push_back(values[j]);
+    }
+    auto srcIndices = this->emitIndices(loc, rewriter, srcLayout, srcTys[0]);
+    // NOTE: Assumes offsets don't actually depend on type
+    auto offset = this->emitOffsetForLayout(srcLayout, srcTys[0]);
+    std::map<SmallVector<unsigned>, unsigned> elemAtOffset;
+    for (unsigned i = 0; i < srcElems; ++i)
+      elemAtOffset[offset[i]] = i;
+
+    SmallVector<Type> elemPtrTys(numOperands);
+    SmallVector<Value> smemBases(numOperands);
+    auto smemShape = helper.getScratchConfig();
+    if (helper.needsSharedMemory()) {
+      for (unsigned i = 0; i < numOperands; ++i)
+        elemPtrTys[i] = LLVM::LLVMPointerType::get(
+            this->getTypeConverter()->convertType(elemTys[i]), 3);
+      unsigned elems = product<unsigned>(smemShape);
+      smemBases[0] = bitcast(
+          this->getSharedMemoryBase(loc, rewriter, op.getOperation()),
+          elemPtrTys[0]);
+      for (unsigned i = 1; i < numOperands; ++i)
+        smemBases[i] =
+            bitcast(gep(elemPtrTys[i - 1], smemBases[i - 1], i32_val(elems)),
+                    elemPtrTys[i]);
+    }
+    bool isSmemUsed = false;
+    auto storeElements = [&]() {
+      // The previous reads of the buffer must be done
+      if (isSmemUsed)
+        barrier();
+      isSmemUsed = true;
+      for (unsigned e = 0; e < srcElems; ++e) {
+        Value smemOffset =
+            linearize(rewriter, loc, srcIndices[e], smemShape, order);
+        for (unsigned i = 0; i < numOperands; ++i)
+          store(srcValues[e][i], gep(elemPtrTys[i], smemBases[i], smemOffset));
+      }
+      barrier();
+    };
+    auto loadElement = [&](ArrayRef<Value> indices) {
+      Value smemOffset = linearize(rewriter, loc, indices, smemShape, order);
+      SmallVector<Value> values(numOperands);
+      for (unsigned i = 0; i < numOperands; ++i)
+        values[i] = load(gep(elemPtrTys[i], smemBases[i], smemOffset));
+      return values;
+    };
+
+    unsigned axisSizePerThread = helper.getAxisNumElementsPerThread();
+    unsigned axisSizePerWarp = helper.getAxisNumElementsPerWarp();
+    Value zero = i32_val(0);
+    for (unsigned k = 2; k <= axisSize; k <<= 1) {
+      for (unsigned j = k / 2; j > 0; j >>= 1) {
+        SmallVector<SmallVector<Value>> partners(srcElems);
+        if (j < axisSizePerThread) {
+          for (unsigned e = 0; e < srcElems; ++e) {
+            SmallVector<unsigned> key = offset[e];
+            key[axis] ^= j;
+            partners[e] = srcValues[elemAtOffset.at(key)];
+          }
+        } else if (j < axisSizePerWarp) {
+          for (unsigned e = 0; e < srcElems; ++e)
+            for (unsigned i = 0; i < numOperands; ++i)
+              partners[e].push_back(shflSync(loc, rewriter, srcValues[e][i],
+                                             j / axisSizePerThread));
+        } else {
+          storeElements();
+          for (unsigned e = 0; e < srcElems; ++e) {
+            SmallVector<Value> indices = srcIndices[e];
+            indices[axis] = xor_(indices[axis], i32_val(j));
+            partners[e] = loadElement(indices);
+          }
+        }
+
+        // The lower position of a pair keeps the first of the two elements
+        // in the direction of its sequence, the upper one the other. An
+        // element is only replaced by a strictly ordered partner, so that
+        // the pair remains a permutation of the elements.
+        for (unsigned e = 0; e < srcElems; ++e) {
+          Value pos = srcIndices[e][axis];
+          Value isAscending = descending
+                                  ? icmp_ne(and_(pos, i32_val(k)), zero)
+                                  : icmp_eq(and_(pos, i32_val(k)), zero);
+          Value isLower = icmp_eq(and_(pos, i32_val(j)), zero);
+          Value keepFirst = icmp_eq(isAscending, isLower);
+          auto &cur = srcValues[e];
+          Value partnerFirst = lessThan(rewriter, loc, elemTys[0], isUnsigned,
+                                        partners[e][0], cur[0]);
+          Value curFirst = lessThan(rewriter, loc, elemTys[0], isUnsigned,
+                                    cur[0], partners[e][0]);
+          Value swap = select(keepFirst, partnerFirst, curFirst);
+          for (unsigned i = 0; i < numOperands; ++i)
+            cur[i] = select(swap, partners[e][i], cur[i]);
+        }
+      }
+    }
+
+    SmallVector<Value> results(numOperands);
+    if constexpr (isTopK) {
+      storeElements();
+      for (unsigned i = 0; i < numOperands; ++i) {
+        auto resultTy =
+            op.getResult()[i].getType().template cast<RankedTensorType>();
+        auto resultIndices = this->emitIndices(
+            loc, rewriter, resultTy.getEncoding(), resultTy);
+        SmallVector<Value> resultVals;
+        for (const auto &indices : resultIndices) {
+          Value smemOffset =
+              linearize(rewriter, loc, indices, smemShape, order);
+          resultVals.push_back(
+              load(gep(elemPtrTys[i], smemBases[i], smemOffset)));
+        }
+        results[i] = this->getTypeConverter()->packLLElements(
+            loc, resultVals, rewriter, resultTy);
+      }
+    } else {
+      for (unsigned i = 0; i < numOperands; ++i) {
+        SmallVector<Value> resultVals(srcElems);
+        for (unsigned j = 0; j < srcElems; ++j)
+          resultVals[j] = srcValues[j][i];
+        results[i] = this->getTypeConverter()->packLLElements(
+            loc, resultVals, rewriter, srcTys[i]);
+      }
+    }
+    rewriter.replaceOp(op, results);
+    return success();
+  }
+};
+
+void populateSortOpToLLVMPatterns(
+    TritonGPUToLLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
+    ModuleAllocation &allocation,
+    ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
+    PatternBenefit benefit) {
+  patterns.add<SortOpConversion<triton::SortOp>>(typeConverter, allocation,
+                                                 indexCacheInfo, benefit);
+  patterns.add<SortOpConversion<triton::TopKOp>>(typeConverter, allocation,
+                                                 indexCacheInfo, benefit);
+}
@@ -1,6 +1,8 @@
 #include "TritonGPUToLLVM.h"
 #include "Utility.h"
 #include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
+#include "triton/Conversion/TritonGPUToLLVM/TritonGPUToLLVMPass.h"
+#include "llvm/Support/xxhash.h"
 
 using namespace mlir;
 using namespace mlir::triton;
@@ -90,6 +92,35 @@ struct BroadcastOpConversion
   }
 };
 
+// The words of a value in a print record: 32-bit integers and floats take
+// one word, the 64-bit ones and the pointers two.
+static StringRef getPrintRecordKind(Type type) {
+  if (type.isa<triton::PointerType>())
+    return "ptr";
+  if (type.isa<FloatType>())
+    return type.getIntOrFloatBitWidth() <= 32 ? "f32" : "f64";
+  return type.getIntOrFloatBitWidth() <= 32 ? "i32" : "i64";
+}
+
+std::string mlir::triton::getPrintRecordFormat(triton::PrintOp op) {
+  std::string format;
+  llvm::raw_string_ostream os(format);
+  llvm::interleave(
+      op.getOperandTypes(), os,
+      [&](Type type) {
+        auto tensorTy = type.dyn_cast<RankedTensorType>();
+        os << getPrintRecordKind(getElementTypeOrSelf(type)) << "x"
+           << (tensorTy ? getTotalElemsPerThread(tensorTy) : 1);
+      },
+      ",");
+  os << "|" << op.getPrefix();
+  return os.str();
+}
+
+uint32_t mlir::triton::getPrintRecordId(StringRef format) {
+  return static_cast<uint32_t>(llvm::xxHash64(format));
+}
+
 struct PrintOpConversion
     : public ConvertTritonGPUOpToLLVMPattern<triton::PrintOp> {
   using ConvertTritonGPUOpToLLVMPattern<
@@ -107,6 +138,12 @@ struct PrintOpConversion
         operands.push_back(elem);
       }
     }
+    auto mod = op->getParentOfType<ModuleOp>();
+    if (triton::gpu::TritonGPUDialect::usesPrintBuffer(mod)) {
+      appendPrintRecord(op, operands, rewriter);
+      rewriter.eraseOp(op);
+      return success();
+    }
     std::string formatStr;
     llvm::raw_string_ostream os(formatStr);
     os << op.getPrefix();
@@ -122,6 +159,126 @@ struct PrintOpConversion
     return success();
   }
 
+  // Appends the record of each thread to the print buffer: the id of the
+  // format, the program id, the thread id and the words of the values. Lane 0
+  // allocates the records of its warp with a single atomic add. The records
+  // past the end of the buffer are dropped but still counted by the cursor.
+  //
+  // The buffer starts with the cursor and the capacity, in words, followed by
+  // the records. The runtime stores its address in triton_print_buffer when it
+  // loads the module.
+  void appendPrintRecord(triton::PrintOp op, ValueRange values,
+                         ConversionPatternRewriter &rewriter) const {
+    ConversionPatternRewriter::InsertionGuard guard(rewriter);
+    Location loc = op->getLoc();
+    auto moduleOp = op->getParentOfType<ModuleOp>();
+    SmallVector<Value> words{
+        i32_val(getPrintRecordId(getPrintRecordFormat(op)))};
+    for (auto dim : {::mlir::gpu::Dimension::x, ::mlir::gpu::Dimension::y,
+                     ::mlir::gpu::Dimension::z}) {
+      Value blockId = rewriter.create<::mlir::gpu::BlockIdOp>(loc, dim);
+      words.push_back(rewriter.create<arith::TruncIOp>(loc, i32_ty, blockId));
+    }
+    Value threadId = getThreadId(rewriter, loc);
+    words.push_back(threadId);
+    for (Value value : values)
+      appendRecordWords(rewriter, loc, value, words);
+    unsigned numWords = words.size();
+    unsigned warpSize =
+        triton::gpu::TritonGPUDialect::getThreadsPerWarp(moduleOp);
+
+    auto wordPtrTy = ptr_ty(i32_ty, 1);
+    Value bufferAddr =
+        load(address_of(getPrintBufferDeclaration(rewriter, moduleOp)));
+    Value cursor = inttoptr(wordPtrTy, bufferAddr);
+    Value capacity = gep(wordPtrTy, cursor, i32_val(1));
+    Value records = gep(wordPtrTy, cursor, i32_val(2));
+    Value laneId = urem(threadId, i32_val(warpSize));
+
+    // #prev
+    //   cond_br lane == 0, #alloc, #merge(0)
+    // #alloc
+    //   br #merge(atomic_add(cursor, warpSize * numWords))
+    // #merge(base)
+    //   offset = shfl(base, 0) + lane * numWords
+    //   cond_br offset + numWords <= capacity, #store, #tail
+    // #store
+    //   br #tail
+    // #tail
+    Block *prevBlock = op->getBlock();
+    Block *tailBlock = rewriter.splitBlock(prevBlock, op->getIterator());
+    Block *storeBlock = rewriter.createBlock(tailBlock);
+    Block *mergeBlock =
+        rewriter.createBlock(storeBlock, SmallVector<Type>{i32_ty},
+                             SmallVector<Location>{loc});
+    Block *allocBlock = rewriter.createBlock(mergeBlock);
+
+    rewriter.setInsertionPointToEnd(prevBlock);
+    rewriter.create<cf::CondBranchOp>(loc, icmp_eq(laneId, i32_val(0)),
+                                      allocBlock, ValueRange{}, mergeBlock,
+                                      ValueRange{i32_val(0)});
+
+    rewriter.setInsertionPointToStart(allocBlock);
+    Value warpBase = rewriter.create<LLVM::AtomicRMWOp>(
+        loc, LLVM::AtomicBinOp::add, cursor, i32_val(warpSize * numWords),
+        LLVM::AtomicOrdering::monotonic);
+    rewriter.create<cf::BranchOp>(loc, mergeBlock, ValueRange{warpBase});
+
+    rewriter.setInsertionPointToStart(mergeBlock);
+    Value base = LLVM::shflIdxSync(loc, rewriter, mergeBlock->getArgument(0),
+                                   i32_val(0));
+    Value offset = add(base, mul(laneId, i32_val(numWords)));
+    Value fits = icmp_ule(add(offset, i32_val(numWords)), load(capacity));
+    rewriter.create<cf::CondBranchOp>(loc, fits, storeBlock, tailBlock);
+
+    rewriter.setInsertionPointToStart(storeBlock);
+    Value record = gep(wordPtrTy, records, offset);
+    for (unsigned i = 0; i < numWords; ++i)
+      store(words[i], gep(wordPtrTy, record, i32_val(i)));
+    rewriter.create<cf::BranchOp>(loc, tailBlock);
+  }
+
+  // Appends the words of `value` as described by getPrintRecordKind
+  static void appendRecordWords(ConversionPatternRewriter &rewriter,
+                                Location loc, Value value,
+                                SmallVectorImpl<Value> &words) {
+    Type type = value.getType();
+    unsigned bitWidth =
+        type.isa<LLVM::LLVMPointerType>() ? 64 : type.getIntOrFloatBitWidth();
+    if (type.isa<LLVM::LLVMPointerType>())
+      value = ptrtoint(i64_ty, value);
+    else if (type.isa<FloatType>() && bitWidth < 32)
+      value = bitcast(fpext(f32_ty, value), i32_ty);
+    else if (type.isa<FloatType>())
+      value = bitcast(value, int_ty(bitWidth));
+    else if (bitWidth == 1)
+      value = zext(i32_ty, value);
+    else if (bitWidth < 32)
+      value = sext(i32_ty, value);
+    if (bitWidth <= 32) {
+      words.push_back(value);
+      return;
+    }
+    words.push_back(rewriter.create<LLVM::TruncOp>(loc, i32_ty, value));
+    words.push_back(rewriter.create<LLVM::TruncOp>(
+        loc, i32_ty, lshr(value, int_val(64, 32))));
+  }
+
+  // Defines the global that holds the address of the print buffer
+  static LLVM::GlobalOp
+  getPrintBufferDeclaration(ConversionPatternRewriter &rewriter,
+                            ModuleOp moduleOp) {
+    StringRef name("triton_print_buffer");
+    if (auto global = moduleOp.lookupSymbol<LLVM::GlobalOp>(name))
+      return global;
+    ConversionPatternRewriter::InsertionGuard guard(rewriter);
+    rewriter.setInsertionPointToStart(moduleOp.getBody());
+    return rewriter.create<LLVM::GlobalOp>(
+        UnknownLoc::get(rewriter.getContext()), i64_ty, /*isConstant=*/false,
+        LLVM::Linkage::External, name, rewriter.getI64IntegerAttr(0),
+        /*alignment=*/8, /*addrSpace=*/1);
+  }
+
   std::string getFormatSubstr(Value value) const {
     Type type = value.getType();
     if (type.isa<LLVM::LLVMPointerType>()) {
@@ -458,6 +615,50 @@ struct AddPtrOpConversion
   }
 };
 
+struct MakeTensorPtrOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::MakeTensorPtrOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::MakeTensorPtrOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::MakeTensorPtrOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    // {base, shape..., strides..., offsets...}
+    Location loc = op->getLoc();
+    SmallVector<Value> elems{adaptor.getBase()};
+    llvm::append_range(elems, adaptor.getShape());
+    llvm::append_range(elems, adaptor.getStrides());
+    llvm::append_range(elems, adaptor.getOffsets());
+    Value result =
+        getTypeConverter()->packLLElements(loc, elems, rewriter, op.getType());
+    rewriter.replaceOp(op, result);
+    return success();
+  }
+};
+
+struct AdvanceOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::AdvanceOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::AdvanceOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::AdvanceOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op->getLoc();
+    auto elems = getTypeConverter()->unpackLLElements(loc, adaptor.getPtr(),
+                                                      rewriter, op.getType());
+    auto offsets = adaptor.getOffsets();
+    unsigned offsetsIdx = elems.size() - offsets.size();
+    for (auto offset : llvm::enumerate(offsets))
+      elems[offsetsIdx + offset.index()] =
+          add(elems[offsetsIdx + offset.index()], offset.value());
+    Value result =
+        getTypeConverter()->packLLElements(loc, elems, rewriter, op.getType());
+    rewriter.replaceOp(op, result);
+    return success();
+  }
+};
+
 struct AllocTensorOpConversion
     : public ConvertTritonGPUOpToLLVMPattern<triton::gpu::AllocTensorOp> {
   using ConvertTritonGPUOpToLLVMPattern<
@@ -616,6 +817,7 @@ void populateTritonGPUToLLVMPatterns(
     ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
     PatternBenefit benefit) {
   patterns.add<AddPtrOpConversion>(typeConverter, benefit);
+  patterns.add<AdvanceOpConversion>(typeConverter, benefit);
   patterns.add<AllocTensorOpConversion>(typeConverter, moduleAllocation,
                                         benefit);
   patterns.add<AsyncCommitGroupOpConversion>(typeConverter, benefit);
@@ -627,6 +829,7 @@ void populateTritonGPUToLLVMPatterns(
   patterns.add<GetProgramIdOpConversion>(typeConverter, benefit);
   patterns.add<GetNumProgramsOpConversion>(typeConverter, benefit);
   patterns.add<MakeRangeOpConversion>(typeConverter, indexCacheInfo, benefit);
+  patterns.add<MakeTensorPtrOpConversion>(typeConverter, benefit);
   patterns.add<ReturnOpConversion>(typeConverter, benefit);
   patterns.add<PrintOpConversion>(typeConverter, benefit);
   patterns.add<AssertOpConversion>(typeConverter, benefit);
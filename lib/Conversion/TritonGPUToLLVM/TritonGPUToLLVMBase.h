@@ -15,6 +15,7 @@
 using namespace mlir;
 using namespace mlir::triton;
 
+using ::mlir::LLVM::getSharedAccessVec;
 using ::mlir::LLVM::SharedMemoryObject;
 using ::mlir::triton::gpu::BlockedEncodingAttr;
 using ::mlir::triton::gpu::DotOperandEncodingAttr;
@@ -141,42 +142,24 @@ protected:
   }
 };
 
-using IndexCacheKeyT = std::pair<Attribute, RankedTensorType>;
-
-struct CacheKeyDenseMapInfo {
-  static IndexCacheKeyT getEmptyKey() {
-    auto *pointer = llvm::DenseMapInfo<void *>::getEmptyKey();
-    return std::make_pair(
-        mlir::Attribute(static_cast<mlir::Attribute::ImplType *>(pointer)),
-        RankedTensorType{});
-  }
-  static IndexCacheKeyT getTombstoneKey() {
-    auto *pointer = llvm::DenseMapInfo<void *>::getTombstoneKey();
-    auto tombstone = llvm::DenseMapInfo<RankedTensorType>::getTombstoneKey();
-    return std::make_pair(
-        mlir::Attribute(static_cast<mlir::Attribute::ImplType *>(pointer)),
-        tombstone);
-  }
-  static unsigned getHashValue(IndexCacheKeyT key) {
-    auto shape = key.second.getShape();
-    return llvm::hash_combine(mlir::hash_value(key.first),
-                              mlir::hash_value(key.second));
-  }
-  static bool isEqual(IndexCacheKeyT LHS, IndexCacheKeyT RHS) {
-    return LHS == RHS;
-  }
-};
+// Key: (function, layout, shape). The values cached for a function are
+// emitted at its entry, so they dominate every op that shares them.
+using IndexCacheKeyT = std::tuple<Operation *, Attribute, RankedTensorType>;
+using CacheKeyDenseMapInfo = llvm::DenseMapInfo<IndexCacheKeyT>;
 
 class ConvertTritonGPUOpToLLVMPatternBase {
 public:
-  // Two levels of value cache in emitting indices calculation:
-  // Key: pair<layout, shape>
+  // Two levels of value cache in emitting indices calculation, plus the
+  // masks of redundant threads:
+  // Key: tuple<function, layout, shape>
   struct IndexCacheInfo {
     DenseMap<IndexCacheKeyT, SmallVector<Value>, CacheKeyDenseMapInfo>
         *baseIndexCache;
     DenseMap<IndexCacheKeyT, SmallVector<SmallVector<Value>>,
              CacheKeyDenseMapInfo> *indexCache;
-    OpBuilder::InsertPoint *indexInsertPoint;
+    DenseMap<IndexCacheKeyT, Value, CacheKeyDenseMapInfo> *maskCache;
+    // Where the next cached values of each function are emitted
+    DenseMap<Operation *, OpBuilder::InsertPoint> *indexInsertPoint;
   };
 
   explicit ConvertTritonGPUOpToLLVMPatternBase(
@@ -257,7 +240,7 @@ public:
                         SmallVectorImpl<Value> &srcStrides) const {
     // This utililty computes the pointers for accessing the provided swizzled
     // shared memory layout `resSharedLayout`. More specifically, it computes,
-    // for all indices (row, col) of `srcEncoding` such that idx % inVec = 0,
+    // for all indices (row, col) of `srcEncoding` such that idx % minVec = 0,
     // the pointer: ptr[(row, col)] = base + (rowOff * strides[ord[1]] +
     // colOff) where :
     //   compute phase = (row // perPhase) % maxPhase
@@ -281,6 +264,12 @@ public:
     // then (x + y) XOR z = 0byyyyxxxx XOR 0b00000zzzz = (x XOR z) + y
     // This means that we can use some immediate offsets for shared memory
     // operations.
+    //
+    // Note 3:
+    // -------
+    // minVec is the widest access of getSharedAccessVec. Without swizzling
+    // (maxPhase = 1), it can exceed outVec, in which case phase = 0 and
+    // colOff = col.
     auto dstPtrTy = ptr_ty(resElemTy, 3);
     auto dstOffset = dot(rewriter, loc, offsetVals, smemObj.strides);
     Value dstPtrBase = gep(dstPtrTy, smemObj.base, dstOffset);
@@ -301,7 +290,7 @@ public:
     DenseMap<unsigned, Value> ret;
     // cache for non-immediate offsets
     DenseMap<unsigned, Value> cacheCol, cacheRow;
-    unsigned minVec = std::min(outVec, inVec);
+    unsigned minVec = getSharedAccessVec(inVec, resSharedLayout);
     for (unsigned elemIdx = 0; elemIdx < numElems; elemIdx += minVec) {
       // extract multi dimensional index for current element
       auto idx = srcIndices[elemIdx];
@@ -385,7 +374,7 @@ public:
             ? triton::gpu::getContigPerThread(srcDistributedLayout)[inOrd[0]]
             : 1;
     unsigned outVec = dstSharedLayout.getVec();
-    unsigned minVec = std::min(outVec, inVec);
+    unsigned minVec = getSharedAccessVec(inVec, dstSharedLayout);
     unsigned perPhase = dstSharedLayout.getPerPhase();
     unsigned maxPhase = dstSharedLayout.getMaxPhase();
     unsigned numElems = triton::gpu::getTotalElemsPerThread(srcTy);
@@ -418,50 +407,140 @@ public:
     }
   }
 
+  SmallVector<Value>
+  loadSharedToDistributed(Value dst, Value src, SharedMemoryObject smemObj,
+                          Type elemTy, Location loc,
+                          ConversionPatternRewriter &rewriter) const {
+    auto dstTy = dst.getType().cast<RankedTensorType>();
+    auto dstShape = dstTy.getShape();
+    assert(dstShape.size() == 2 &&
+           "Unexpected rank of loadSharedToDistributed");
+    auto srcTy = src.getType().cast<RankedTensorType>();
+    auto dstDistributedLayout = dstTy.getEncoding();
+    if (auto mmaLayout = dstDistributedLayout.dyn_cast<MmaEncodingAttr>()) {
+      assert((!mmaLayout.isVolta()) &&
+             "ConvertLayout Shared->MMAv1 is not supported yet");
+    }
+    auto srcSharedLayout =
+        srcTy.getEncoding().cast<triton::gpu::SharedEncodingAttr>();
+    auto srcElemTy = srcTy.getElementType();
+    auto inOrd = srcSharedLayout.getOrder();
+    auto outOrd = triton::gpu::getOrder(dstDistributedLayout);
+    unsigned outVec =
+        inOrd == outOrd
+            ? triton::gpu::getContigPerThread(dstDistributedLayout)[outOrd[0]]
+            : 1;
+    unsigned minVec = getSharedAccessVec(outVec, srcSharedLayout);
+    unsigned numElems = triton::gpu::getTotalElemsPerThread(dstTy);
+    auto wordTy = vec_ty(elemTy, minVec);
+
+    // the base of the object already points to its offsets
+    SmallVector<Value> srcStrides(smemObj.strides.begin(),
+                                  smemObj.strides.end());
+    SmallVector<Value> offsetVals = {i32_val(0), i32_val(0)};
+    DenseMap<unsigned, Value> sharedPtrs =
+        getSwizzledSharedPtrs(loc, outVec, dstTy, srcSharedLayout, srcElemTy,
+                              smemObj, rewriter, offsetVals, srcStrides);
+
+    SmallVector<Value> outVals(numElems);
+    for (unsigned i = 0; i < numElems; i += minVec) {
+      Value smemAddr = bitcast(sharedPtrs[i], ptr_ty(wordTy, 3));
+      Value word = load(smemAddr);
+      for (unsigned v = 0; v < minVec; ++v)
+        outVals[i + v] = extract_element(elemTy, word, i32_val(v));
+    }
+    return outVals;
+  }
+
   // -----------------------------------------------------------------------
   // Utilities
   // -----------------------------------------------------------------------
+  // The threads of a warp of a blocked layout, 32 for the MMA layouts.
+  static unsigned getWarpSize(Attribute layout) {
+    if (auto blocked = layout.dyn_cast<BlockedEncodingAttr>())
+      return product<unsigned>(blocked.getThreadsPerWarp());
+    if (auto slice = layout.dyn_cast<SliceEncodingAttr>())
+      return getWarpSize(slice.getParent());
+    return 32;
+  }
+
   Value getMask(Type valueTy, ConversionPatternRewriter &rewriter,
                 Location loc) const {
     auto tensorTy = valueTy.dyn_cast<RankedTensorType>();
     Value mask = int_val(1, 1);
-    auto tid = tid_val();
-    if (tensorTy) {
-      auto layout = tensorTy.getEncoding();
-      auto shape = tensorTy.getShape();
-      unsigned rank = shape.size();
-      auto sizePerThread = triton::gpu::getSizePerThread(layout);
-      auto threadsPerWarp = triton::gpu::getThreadsPerWarp(layout);
-      auto warpsPerCTA = triton::gpu::getWarpsPerCTA(layout);
-      auto order = triton::gpu::getOrder(layout);
-      auto shapePerCTA = triton::gpu::getShapePerCTA(layout, shape);
-      Value warpSize = i32_val(32);
-      Value laneId = urem(tid, warpSize);
-      Value warpId = udiv(tid, warpSize);
-      SmallVector<Value> multiDimWarpId =
-          delinearize(rewriter, loc, warpId, warpsPerCTA, order);
-      SmallVector<Value> multiDimThreadId =
-          delinearize(rewriter, loc, laneId, threadsPerWarp, order);
-      for (unsigned dim = 0; dim < rank; ++dim) {
-        // if there is no data replication across threads on this dimension
-        if (shape[dim] >= shapePerCTA[dim])
-          continue;
-        // Otherwise, we need to mask threads that will replicate data on this
-        // dimension. Calculate the thread index on this dimension for the CTA
-        Value threadDim =
-            add(mul(multiDimWarpId[dim], i32_val(threadsPerWarp[dim])),
-                multiDimThreadId[dim]);
-        mask = and_(mask, icmp_slt(mul(threadDim, i32_val(sizePerThread[dim])),
-                                   i32_val(shape[dim])));
-      }
-    } else {
+    if (!tensorTy) {
       // If the tensor is not ranked, then it is a scalar and only thread 0 can
       // write
-      mask = and_(mask, icmp_eq(tid, i32_val(0)));
+      return and_(mask, icmp_eq(tid_val(), i32_val(0)));
+    }
+    auto layout = tensorTy.getEncoding();
+    auto cache = indexCacheInfo.maskCache;
+    IndexCacheKeyT key;
+    if (cache) {
+      key = IndexCacheKeyT(getIndexCacheScope(rewriter), layout, tensorTy);
+      if (cache->count(key) > 0)
+        return cache->lookup(key);
+    }
+    ConversionPatternRewriter::InsertionGuard guard(rewriter);
+    if (cache)
+      restoreIndexInsertionPoint(std::get<0>(key), rewriter);
+    auto shape = tensorTy.getShape();
+    unsigned rank = shape.size();
+    auto sizePerThread = triton::gpu::getSizePerThread(layout);
+    auto threadsPerWarp = triton::gpu::getThreadsPerWarp(layout);
+    auto warpsPerCTA = triton::gpu::getWarpsPerCTA(layout);
+    auto order = triton::gpu::getOrder(layout);
+    auto shapePerCTA = triton::gpu::getShapePerCTA(layout, shape);
+    Value tid = tid_val();
+    unsigned warpSize = getWarpSize(layout);
+    Value laneId = uremConst(rewriter, loc, tid, warpSize);
+    Value warpId = udivConst(rewriter, loc, tid, warpSize);
+    SmallVector<Value> multiDimWarpId =
+        delinearize(rewriter, loc, warpId, warpsPerCTA, order);
+    SmallVector<Value> multiDimThreadId =
+        delinearize(rewriter, loc, laneId, threadsPerWarp, order);
+    for (unsigned dim = 0; dim < rank; ++dim) {
+      // if there is no data replication across threads on this dimension
+      if (shape[dim] >= shapePerCTA[dim])
+        continue;
+      // Otherwise, we need to mask threads that will replicate data on this
+      // dimension. Calculate the thread index on this dimension for the CTA
+      Value threadDim =
+          add(mul(multiDimWarpId[dim], i32_val(threadsPerWarp[dim])),
+              multiDimThreadId[dim]);
+      mask = and_(mask, icmp_slt(mul(threadDim, i32_val(sizePerThread[dim])),
+                                 i32_val(shape[dim])));
+    }
+    if (cache) {
+      cache->insert(std::make_pair(key, mask));
+      (*indexCacheInfo.indexInsertPoint)[std::get<0>(key)] =
+          rewriter.saveInsertionPoint();
     }
     return mask;
   }
 
+  // x / d and x % d for unsigned x and a constant d. Powers of two, which
+  // all the thread and layout sizes are, become shifts and masks.
+  Value udivConst(ConversionPatternRewriter &rewriter, Location loc, Value x,
+                  unsigned d) const {
+    assert(d > 0 && "division by zero");
+    if (d == 1)
+      return x;
+    if (llvm::isPowerOf2_32(d))
+      return lshr(x, i32_val(llvm::Log2_32(d)));
+    return udiv(x, i32_val(d));
+  }
+
+  Value uremConst(ConversionPatternRewriter &rewriter, Location loc, Value x,
+                  unsigned d) const {
+    assert(d > 0 && "division by zero");
+    if (d == 1)
+      return i32_val(0);
+    if (llvm::isPowerOf2_32(d))
+      return and_(x, i32_val(d - 1));
+    return urem(x, i32_val(d));
+  }
+
   // Convert an \param index to a multi-dim coordinate given \param shape and
   // \param order.
   SmallVector<Value> delinearize(ConversionPatternRewriter &rewriter,
@@ -490,9 +569,8 @@ public:
     } else {
       Value remained = linear;
       for (auto &&en : llvm::enumerate(shape.drop_back())) {
-        Value dimSize = i32_val(en.value());
-        multiDim[en.index()] = urem(remained, dimSize);
-        remained = udiv(remained, dimSize);
+        multiDim[en.index()] = uremConst(rewriter, loc, remained, en.value());
+        remained = udivConst(rewriter, loc, remained, en.value());
       }
       multiDim[rank - 1] = remained;
     }
@@ -555,15 +633,16 @@ public:
                                             ConversionPatternRewriter &rewriter,
                                             Attribute layout,
                                             RankedTensorType type) const {
-    IndexCacheKeyT key = std::make_pair(layout, type);
     auto cache = indexCacheInfo.baseIndexCache;
-    auto insertPt = indexCacheInfo.indexInsertPoint;
+    IndexCacheKeyT key;
+    if (cache)
+      key = IndexCacheKeyT(getIndexCacheScope(rewriter), layout, type);
     if (cache && cache->count(key) > 0) {
       return cache->lookup(key);
     } else {
       ConversionPatternRewriter::InsertionGuard guard(rewriter);
       if (cache)
-        restoreInsertionPointIfSet(insertPt, rewriter);
+        restoreIndexInsertionPoint(std::get<0>(key), rewriter);
       SmallVector<Value> result;
       if (auto blockedLayout = layout.dyn_cast<BlockedEncodingAttr>()) {
         result =
@@ -571,7 +650,8 @@ public:
       } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
         if (mmaLayout.isVolta())
           result = emitBaseIndexForMmaLayoutV1(loc, rewriter, mmaLayout, type);
-        if (mmaLayout.isAmpere())
+        // Hopper accumulators are laid out like the Ampere ones
+        if (mmaLayout.isAmpere() || mmaLayout.isHopper())
           result = emitBaseIndexForMmaLayoutV2(loc, rewriter, mmaLayout, type);
       } else if (auto sliceLayout = layout.dyn_cast<SliceEncodingAttr>()) {
         auto parentLayout = sliceLayout.getParent();
@@ -585,7 +665,8 @@ public:
       }
       if (cache) {
         cache->insert(std::make_pair(key, result));
-        *insertPt = rewriter.saveInsertionPoint();
+        (*indexCacheInfo.indexInsertPoint)[std::get<0>(key)] =
+            rewriter.saveInsertionPoint();
       }
       return result;
     }
@@ -598,7 +679,7 @@ public:
     if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
       if (mmaLayout.isVolta())
         return emitOffsetForMmaLayoutV1(mmaLayout, type);
-      if (mmaLayout.isAmpere())
+      if (mmaLayout.isAmpere() || mmaLayout.isHopper())
         return emitOffsetForMmaLayoutV2(mmaLayout, type);
     }
     if (auto sliceLayout = layout.dyn_cast<SliceEncodingAttr>())
@@ -613,15 +694,16 @@ public:
                                               ConversionPatternRewriter &b,
                                               Attribute layout,
                                               RankedTensorType type) const {
-    IndexCacheKeyT key(layout, type);
     auto cache = indexCacheInfo.indexCache;
-    auto insertPt = indexCacheInfo.indexInsertPoint;
+    IndexCacheKeyT key;
+    if (cache)
+      key = IndexCacheKeyT(getIndexCacheScope(b), layout, type);
     if (cache && cache->count(key) > 0) {
       return cache->lookup(key);
     } else {
       ConversionPatternRewriter::InsertionGuard guard(b);
       if (cache)
-        restoreInsertionPointIfSet(insertPt, b);
+        restoreIndexInsertionPoint(std::get<0>(key), b);
       SmallVector<SmallVector<Value>> result;
       if (auto blocked = layout.dyn_cast<BlockedEncodingAttr>()) {
         result = emitIndicesForDistributedLayout(loc, b, blocked, type);
@@ -636,21 +718,31 @@ public:
       }
       if (cache) {
         cache->insert(std::make_pair(key, result));
-        *insertPt = b.saveInsertionPoint();
+        (*indexCacheInfo.indexInsertPoint)[std::get<0>(key)] =
+            b.saveInsertionPoint();
       }
       return result;
     }
   }
 
 private:
-  void restoreInsertionPointIfSet(OpBuilder::InsertPoint *insertPt,
+  // The function whose entry holds the cached values for the current op.
+  Operation *
+  getIndexCacheScope(ConversionPatternRewriter &rewriter) const {
+    return rewriter.getInsertionBlock()
+        ->getParent()
+        ->getParentOfType<LLVM::LLVMFuncOp>()
+        .getOperation();
+  }
+
+  void restoreIndexInsertionPoint(Operation *func,
                                   ConversionPatternRewriter &rewriter) const {
-    if (insertPt->isSet()) {
-      rewriter.restoreInsertionPoint(*insertPt);
+    auto &insertPt = (*indexCacheInfo.indexInsertPoint)[func];
+    if (insertPt.isSet()) {
+      rewriter.restoreInsertionPoint(insertPt);
     } else {
-      auto func =
-          rewriter.getInsertionPoint()->getParentOfType<LLVM::LLVMFuncOp>();
-      rewriter.setInsertionPointToStart(&func.getBody().front());
+      auto funcOp = cast<LLVM::LLVMFuncOp>(func);
+      rewriter.setInsertionPointToStart(&funcOp.getBody().front());
     }
   }
 
@@ -664,9 +756,9 @@ private:
       const BlockedEncodingAttr &blocked_layout, RankedTensorType type) const {
     auto shape = type.getShape();
     Value threadId = getThreadId(rewriter, loc);
-    Value warpSize = i32_val(32);
-    Value laneId = urem(threadId, warpSize);
-    Value warpId = udiv(threadId, warpSize);
+    unsigned warpSize = getWarpSize(blocked_layout);
+    Value laneId = uremConst(rewriter, loc, threadId, warpSize);
+    Value warpId = udivConst(rewriter, loc, threadId, warpSize);
     auto sizePerThread = blocked_layout.getSizePerThread();
     auto threadsPerWarp = blocked_layout.getThreadsPerWarp();
     auto warpsPerCTA = blocked_layout.getWarpsPerCTA();
@@ -682,12 +774,17 @@ private:
     SmallVector<Value> multiDimBase(rank);
     for (unsigned k = 0; k < rank; ++k) {
       // Wrap around multiDimWarpId/multiDimThreadId in case
-      // shape[k] > shapePerCTA[k]
+      // shape[k] < shapePerCTA[k]. The ids are below warpsPerCTA[k] and
+      // threadsPerWarp[k], so the wrap is a no-op when those fit the shape.
       auto maxWarps =
           ceil<unsigned>(shape[k], sizePerThread[k] * threadsPerWarp[k]);
       auto maxThreads = ceil<unsigned>(shape[k], sizePerThread[k]);
-      multiDimWarpId[k] = urem(multiDimWarpId[k], i32_val(maxWarps));
-      multiDimThreadId[k] = urem(multiDimThreadId[k], i32_val(maxThreads));
+      if (warpsPerCTA[k] > maxWarps)
+        multiDimWarpId[k] =
+            uremConst(rewriter, loc, multiDimWarpId[k], maxWarps);
+      if (threadsPerWarp[k] > maxThreads)
+        multiDimThreadId[k] =
+            uremConst(rewriter, loc, multiDimThreadId[k], maxThreads);
       // multiDimBase[k] = (multiDimThreadId[k] +
       //                    multiDimWarpId[k] * threadsPerWarp[k]) *
       //                   sizePerThread[k];
@@ -890,9 +987,8 @@ private:
     SmallVector<Value> warpsPerCTA = {i32_val(_warpsPerCTA[0]),
                                       i32_val(_warpsPerCTA[1])};
     Value threadId = getThreadId(rewriter, loc);
-    Value warpSize = i32_val(32);
-    Value laneId = urem(threadId, warpSize);
-    Value warpId = udiv(threadId, warpSize);
+    Value laneId = uremConst(rewriter, loc, threadId, 32);
+    Value warpId = udivConst(rewriter, loc, threadId, 32);
     Value warpId0 = urem(urem(warpId, warpsPerCTA[0]), i32_val(shape[0] / 16));
     Value warpId1 = urem(urem(udiv(warpId, warpsPerCTA[0]), warpsPerCTA[1]),
                          i32_val(shape[1] / 8));
@@ -900,8 +996,9 @@ private:
     Value offWarp1 = mul(warpId1, i32_val(8));
 
     SmallVector<Value> multiDimBase(2);
-    multiDimBase[0] = add(udiv(laneId, i32_val(4)), offWarp0);
-    multiDimBase[1] = add(mul(i32_val(2), urem(laneId, i32_val(4))), offWarp1);
+    multiDimBase[0] = add(udivConst(rewriter, loc, laneId, 4), offWarp0);
+    multiDimBase[1] =
+        add(mul(i32_val(2), uremConst(rewriter, loc, laneId, 4)), offWarp1);
     return multiDimBase;
   }
 
@@ -24,8 +24,11 @@
 #include "ConvertLayoutOpToLLVM.h"
 #include "DotOpToLLVM.h"
 #include "ElementwiseOpToLLVM.h"
+#include "HistogramOpToLLVM.h"
 #include "LoadStoreOpToLLVM.h"
 #include "ReduceOpToLLVM.h"
+#include "ScanOpToLLVM.h"
+#include "SortOpToLLVM.h"
 #include "TritonGPUToLLVM.h"
 #include "TypeConverter.h"
 #include "ViewOpToLLVM.h"
@@ -166,7 +169,10 @@ struct FuncOpConversion : public FuncOpConversionBase {
     }
     // Set an attribute for maxntidx, it could be used in latter LLVM codegen
     // for `nvvm.annotation` metadata.
-    newFuncOp->setAttr("nvvm.maxntid", rewriter.getI32ArrayAttr(32 * numWarps));
+    int threadsPerWarp = triton::gpu::TritonGPUDialect::getThreadsPerWarp(
+        funcOp->getParentOfType<ModuleOp>());
+    newFuncOp->setAttr("nvvm.maxntid",
+                       rewriter.getI32ArrayAttr(threadsPerWarp * numWarps));
     // The call graph is updated by mapping the old function to the new one.
     allocation.mapFuncOp(funcOp, newFuncOp);
 
@@ -292,8 +298,12 @@ class ConvertTritonGPUToLLVM
     : public ConvertTritonGPUToLLVMBase<ConvertTritonGPUToLLVM> {
 
 public:
-  explicit ConvertTritonGPUToLLVM(int computeCapability, bool isROCM)
-      : computeCapability(computeCapability), isROCM(isROCM) {}
+  explicit ConvertTritonGPUToLLVM(int computeCapability, bool isROCM,
+                                  bool fastMath) {
+    this->computeCapability = computeCapability;
+    this->isROCM = isROCM;
+    this->fastMath = fastMath;
+  }
 
   void runOnOperation() override {
     MLIRContext *context = &getContext();
@@ -353,25 +363,32 @@ public:
     // Rewrite ops
     RewritePatternSet patterns(context);
     // TritonGPU lowering patterns
-    OpBuilder::InsertPoint indexInsertPoint;
+    // The caches are keyed by function, so every function of the module
+    // shares its own index and mask computations.
     ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo indexCacheInfo{
-        &baseIndexCache, &indexCache, &indexInsertPoint};
-    // TODO: enable index cache if there are multiple functions
-    if (axisInfoAnalysis.getNumFunctions() > 1) {
-      indexCacheInfo = {nullptr, nullptr, nullptr};
-    }
+        &baseIndexCache, &indexCache, &maskCache, &indexInsertPoint};
     populateTritonGPUToLLVMPatterns(typeConverter, patterns, allocation,
                                     indexCacheInfo, /*benefit=*/1);
     populateConvertLayoutOpToLLVMPatterns(typeConverter, patterns, allocation,
                                           indexCacheInfo, /*benefit=*/1);
-    populateDotOpToLLVMPatterns(typeConverter, patterns, allocation,
+    populateDotOpToLLVMPatterns(typeConverter, patterns, allocation, isROCM,
                                 /*benefit=*/1);
-    populateElementwiseOpToLLVMPatterns(typeConverter, patterns, /*benefit=*/1);
+    // The approximate math lowerings emit PTX
+    populateElementwiseOpToLLVMPatterns(typeConverter, patterns,
+                                        computeCapability,
+                                        fastMath && !isROCM, /*benefit=*/1);
     populateLoadStoreOpToLLVMPatterns(typeConverter, patterns, axisInfoAnalysis,
                                       allocation, indexCacheInfo,
                                       /*benefit=*/1);
     populateReduceOpToLLVMPatterns(typeConverter, patterns, allocation,
-                                   indexCacheInfo, /*benefit=*/1);
+                                   indexCacheInfo, computeCapability,
+                                   /*benefit=*/1);
+    populateScanOpToLLVMPatterns(typeConverter, patterns, allocation,
+                                 indexCacheInfo, /*benefit=*/1);
+    populateSortOpToLLVMPatterns(typeConverter, patterns, allocation,
+                                 indexCacheInfo, /*benefit=*/1);
+    populateHistogramOpToLLVMPatterns(typeConverter, patterns, allocation,
+                                      indexCacheInfo, /*benefit=*/1);
     populateViewOpToLLVMPatterns(typeConverter, patterns, /*benefit=*/1);
 
     // Native lowering patterns
@@ -386,18 +403,77 @@ public:
                                                           patterns);
     if (failed(applyPartialConversion(mod, target, std::move(patterns))))
       return signalPassFailure();
+
+    if (failed(lowerParamTables(mod)))
+      return signalPassFailure();
+
+    if (fastMath)
+      setFastMathFlags(mod);
   }
 
 private:
-  using IndexCacheKeyT = std::pair<Attribute, RankedTensorType>;
   DenseMap<IndexCacheKeyT, SmallVector<Value>, CacheKeyDenseMapInfo>
       baseIndexCache;
   DenseMap<IndexCacheKeyT, SmallVector<SmallVector<Value>>,
            CacheKeyDenseMapInfo>
       indexCache;
+  DenseMap<IndexCacheKeyT, Value, CacheKeyDenseMapInfo> maskCache;
+  DenseMap<Operation *, OpBuilder::InsertPoint> indexInsertPoint;
+
+  // Lets LLVM reassociate, contract and approximate the floating-point ops.
+  // Not `fast`: nnan and ninf would make the -inf of the masked elements, e.g.
+  // of the max of a softmax, poison
+  void setFastMathFlags(ModuleOp mod) {
+    auto fastAttr = LLVM::FastmathFlagsAttr::get(
+        mod.getContext(), LLVM::FastmathFlags::afn |
+                              LLVM::FastmathFlags::contract |
+                              LLVM::FastmathFlags::reassoc);
+    mod.walk([&](LLVM::FastmathFlagsInterface op) {
+      op->setAttr(op.getFastmathAttrName(), fastAttr);
+    });
+  }
 
-  int computeCapability{};
-  bool isROCM{};
+  // The parameter tables of a kernel are passed by value: their arguments
+  // become pointers to arrays with the `byval` attribute, which the NVPTX
+  // backend reads from the parameter space as long as they are only loaded.
+  LogicalResult lowerParamTables(ModuleOp mod) const {
+    auto result = mod.walk([&](LLVM::LLVMFuncOp func) -> WalkResult {
+      if (func.isExternal())
+        return WalkResult::advance();
+      auto funcTy = func.getFunctionType();
+      SmallVector<Type> inputTys(funcTy.getParams());
+      Block &entry = func.getBody().front();
+      OpBuilder builder(&entry, entry.begin());
+      for (unsigned i = 0; i < func.getNumArguments(); ++i) {
+        auto size = func.getArgAttrOfType<IntegerAttr>(i, "tt.param_table");
+        if (!size)
+          continue;
+        if (isROCM) {
+          func.emitError("parameter tables are not supported on AMD GPUs");
+          return WalkResult::interrupt();
+        }
+        func.removeArgAttr(i, builder.getStringAttr("tt.param_table"));
+        BlockArgument arg = func.getArgument(i);
+        auto ptrTy = arg.getType().cast<LLVM::LLVMPointerType>();
+        Type elemTy = ptrTy.getElementType();
+        auto tableTy = LLVM::LLVMArrayType::get(elemTy, size.getInt());
+        auto byvalTy = LLVM::LLVMPointerType::get(tableTy);
+        arg.setType(byvalTy);
+        inputTys[i] = byvalTy;
+        auto cast = builder.create<LLVM::BitcastOp>(func.getLoc(), ptrTy, arg);
+        arg.replaceAllUsesExcept(cast, cast);
+        func.setArgAttr(i, LLVM::LLVMDialect::getByValAttrName(),
+                        TypeAttr::get(tableTy));
+        unsigned align = std::max(4u, elemTy.getIntOrFloatBitWidth() / 8);
+        func.setArgAttr(i, LLVM::LLVMDialect::getAlignAttrName(),
+                        builder.getI64IntegerAttr(align));
+      }
+      func.setFunctionType(LLVM::LLVMFunctionType::get(
+          funcTy.getReturnType(), inputTys, funcTy.isVarArg()));
+      return WalkResult::advance();
+    });
+    return failure(result.wasInterrupted());
+  }
 
   void initSharedMemory(ModuleAllocation &allocation,
                         TritonGPUToLLVMTypeConverter &typeConverter) {
@@ -409,9 +485,12 @@ private:
     // Set array size 0 and external linkage indicates that we use dynamic
     // shared allocation to allow a larger shared memory size for each kernel.
     auto arrayTy = LLVM::LLVMArrayType::get(elemTy, 0);
+    // The buffer offsets are aligned relative to the start of the array
+    auto alignment = allocation.getSharedMemoryAlignment();
     auto global = b.create<LLVM::GlobalOp>(
         loc, arrayTy, /*isConstant=*/false, LLVM::Linkage::External,
-        "global_smem", /*value=*/Attribute(), /*alignment=*/0,
+        "global_smem", /*value=*/Attribute(),
+        /*alignment=*/alignment > 1 ? alignment : 0,
         // Add ROCm support.
         static_cast<unsigned>(NVVM::NVVMMemorySpace::kSharedMemorySpace));
     mod.walk([&](FunctionOpInterface funcOp) {
@@ -515,16 +594,23 @@ private:
       // Get the vectorized load size
       auto src = insertSliceAsyncOp.getSrc();
       auto dst = insertSliceAsyncOp.getDst();
-      auto srcTy = src.getType().cast<RankedTensorType>();
+      // A block pointer is copied with the layout of the mask
+      bool isTensorPtr = triton::isTensorPointerType(src.getType());
+      auto srcTy = (isTensorPtr ? insertSliceAsyncOp.getMask().getType()
+                                : src.getType())
+                       .cast<RankedTensorType>();
       auto dstTy = dst.getType().cast<RankedTensorType>();
       auto srcBlocked =
           srcTy.getEncoding().dyn_cast<triton::gpu::BlockedEncodingAttr>();
       auto resSharedLayout =
           dstTy.getEncoding().dyn_cast<triton::gpu::SharedEncodingAttr>();
       auto resElemTy = dstTy.getElementType();
-      unsigned inVec = axisInfoAnalysis.getPtrContiguity(src);
-      unsigned outVec = resSharedLayout.getVec();
-      unsigned minVec = std::min(outVec, inVec);
+      unsigned inVec =
+          isTensorPtr
+              ? axisInfoAnalysis.getTensorPtrContiguity(
+                    src, srcTy, insertSliceAsyncOp.getBoundaryCheck())
+              : axisInfoAnalysis.getPtrContiguity(src);
+      unsigned minVec = getSharedAccessVec(inVec, resSharedLayout);
       auto maxBitWidth =
           std::max<unsigned>(128, resElemTy.getIntOrFloatBitWidth());
       auto vecBitWidth = resElemTy.getIntOrFloatBitWidth() * minVec;
@@ -538,14 +624,18 @@ private:
               .contains(byteWidth))
         return;
 
-      // load
+      // load, the out-of-bounds elements of a block pointer are zeros as
+      // with the async copy
       auto tmpTy =
           RankedTensorType::get(srcTy.getShape(), resElemTy, srcBlocked);
+      triton::PaddingOptionAttr padding;
+      if (isTensorPtr)
+        padding = triton::PaddingOptionAttr::get(
+            builder.getContext(), triton::PaddingOption::PAD_ZERO);
       auto loadOp = builder.create<triton::LoadOp>(
           insertSliceAsyncOp.getLoc(), tmpTy, insertSliceAsyncOp.getSrc(),
           insertSliceAsyncOp.getMask(), insertSliceAsyncOp.getOther(),
-          // TODO(Chenggang): confirm `boundaryCheck` and `padding`
-          /*boundaryCheck=*/nullptr, /*padding=*/nullptr,
+          insertSliceAsyncOp.getBoundaryCheckAttr(), padding,
           insertSliceAsyncOp.getCache(), insertSliceAsyncOp.getEvict(),
           insertSliceAsyncOp.getIsVolatile());
 
@@ -596,8 +686,10 @@ namespace mlir {
 namespace triton {
 
 std::unique_ptr<OperationPass<ModuleOp>>
-createConvertTritonGPUToLLVMPass(int computeCapability, bool isROCM) {
-  return std::make_unique<::ConvertTritonGPUToLLVM>(computeCapability, isROCM);
+createConvertTritonGPUToLLVMPass(int computeCapability, bool isROCM,
+                                 bool fastMath) {
+  return std::make_unique<::ConvertTritonGPUToLLVM>(computeCapability, isROCM,
+                                                    fastMath);
 }
 
 } // namespace triton
@@ -38,9 +38,25 @@ TritonGPUToLLVMTypeConverter::TritonGPUToLLVMTypeConverter(
 
 Type TritonGPUToLLVMTypeConverter::convertTritonPointerType(
     triton::PointerType type) {
+  // A block pointer is a struct of its base, shape, strides and offsets
+  if (auto blockType = type.getPointeeType().dyn_cast<RankedTensorType>()) {
+    auto ctx = type.getContext();
+    unsigned rank = blockType.getRank();
+    SmallVector<Type> types;
+    types.push_back(LLVM::LLVMPointerType::get(
+        convertType(blockType.getElementType()), type.getAddressSpace()));
+    types.append(2 * rank, IntegerType::get(ctx, 64));
+    types.append(rank, IntegerType::get(ctx, 32));
+    return LLVM::LLVMStructType::getLiteral(ctx, types);
+  }
+  // The parameter tables are read through generic pointers to the by-value
+  // arguments of the kernel, which the NVPTX backend turns into ld.param
+  unsigned addressSpace = type.getAddressSpace();
+  if (addressSpace == triton::kParamAddressSpace)
+    addressSpace = 0;
   // Recursively translate pointee type
   return LLVM::LLVMPointerType::get(convertType(type.getPointeeType()),
-                                    type.getAddressSpace());
+                                    addressSpace);
 }
 
 Value TritonGPUToLLVMTypeConverter::packLLElements(
@@ -104,7 +120,7 @@ Type TritonGPUToLLVMTypeConverter::getElementTypeForStruct(
   auto mmaParent = dotOpLayout.getParent().dyn_cast<MmaEncodingAttr>();
   if (!mmaParent)
     return elemTy;
-  if (mmaParent.isAmpere()) {
+  if (mmaParent.isAmpere() || mmaParent.isHopper()) {
     int bitwidth = elemTy.getIntOrFloatBitWidth();
     assert(bitwidth <= 32);
     return IntegerType::get(ctx, 32);
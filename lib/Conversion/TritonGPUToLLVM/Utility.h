@@ -28,6 +28,7 @@
 #define umin(...) rewriter.create<LLVM::UMinOp>(loc, __VA_ARGS__)
 #define fmin(...) rewriter.create<LLVM::MinNumOp>(loc, __VA_ARGS__)
 #define shl(...) rewriter.create<LLVM::ShlOp>(loc, __VA_ARGS__)
+#define lshr(...) rewriter.create<LLVM::LShrOp>(loc, __VA_ARGS__)
 #define and_(...) rewriter.create<LLVM::AndOp>(loc, __VA_ARGS__)
 #define xor_(...) rewriter.create<LLVM::XOrOp>(loc, __VA_ARGS__)
 #define or_(...) rewriter.create<LLVM::OrOp>(loc, __VA_ARGS__)
@@ -194,6 +195,15 @@ Value createLLVMIntegerConstant(OpBuilder &builder, Location loc, short width,
 SmallVector<Value>
 getStridesFromShapeAndOrder(ArrayRef<int64_t> shape, ArrayRef<unsigned> order,
                             Location loc, ConversionPatternRewriter &rewriter);
+
+/// The number of elements that a thread accesses at once in \param layout
+/// when it holds \param inVec contiguous elements along its fastest
+/// dimension. The swizzle permutes groups of `vec` elements, which bounds the
+/// vectors of a swizzled layout, while the rows of an unswizzled layout stay
+/// contiguous.
+unsigned getSharedAccessVec(unsigned inVec,
+                            triton::gpu::SharedEncodingAttr layout);
+
 struct SharedMemoryObject {
   Value base; // i32 ptr. The start address of the shared memory object.
   // We need to store strides as Values but not integers because the
@@ -264,6 +274,14 @@ Value storeShared(ConversionPatternRewriter &rewriter, Location loc, Value ptr,
 Value shflSync(Location loc, ConversionPatternRewriter &rewriter, Value val,
                int i);
 
+Value shflUpSync(Location loc, ConversionPatternRewriter &rewriter, Value val,
+                 int i);
+
+// Reads `val` from lane `i` of the warp. Unlike shflSync, every lane may read
+// from a different lane.
+Value shflIdxSync(Location loc, ConversionPatternRewriter &rewriter, Value val,
+                  Value i);
+
 Value addStringToModule(Location loc, ConversionPatternRewriter &rewriter,
                         StringRef key, StringRef content);
 
@@ -187,6 +187,9 @@ struct TransOpConversion
   matchAndRewrite(triton::TransOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
     Location loc = op->getLoc();
+    auto srcTy = op.getSrc().getType().cast<RankedTensorType>();
+    if (!srcTy.getEncoding().isa<SharedEncodingAttr>())
+      return lowerDistributedTrans(op, adaptor, rewriter);
     auto srcSmemObj =
         getSharedMemoryObjectFromStruct(loc, adaptor.getSrc(), rewriter);
     SmallVector<Value> dstStrides = {srcSmemObj.strides[1],
@@ -199,6 +202,35 @@ struct TransOpConversion
     rewriter.replaceOp(op, retVal);
     return success();
   }
+
+  // The transposed layout holds the elements of each thread at transposed
+  // offsets: the registers are relabeled without moving data.
+  LogicalResult
+  lowerDistributedTrans(triton::TransOp op, OpAdaptor adaptor,
+                        ConversionPatternRewriter &rewriter) const {
+    Location loc = op->getLoc();
+    auto srcTy = op.getSrc().getType().cast<RankedTensorType>();
+    auto resultTy = op.getType().cast<RankedTensorType>();
+    auto srcVals = getTypeConverter()->unpackLLElements(loc, adaptor.getSrc(),
+                                                        rewriter, srcTy);
+    auto srcOffsets = emitOffsetForLayout(srcTy.getEncoding(), srcTy);
+    auto resultOffsets = emitOffsetForLayout(resultTy.getEncoding(), resultTy);
+    DenseMap<SmallVector<unsigned>, Value, SmallVectorKeyInfo> srcValues;
+    for (size_t i = 0; i < srcOffsets.size(); i++)
+      srcValues[srcOffsets[i]] = srcVals[i];
+    SmallVector<Value> resultVals;
+    for (auto offset : resultOffsets) {
+      std::reverse(offset.begin(), offset.end());
+      Value val = srcValues.lookup(offset);
+      if (!val)
+        return failure();
+      resultVals.push_back(val);
+    }
+    Value ret = getTypeConverter()->packLLElements(loc, resultVals, rewriter,
+                                                   resultTy);
+    rewriter.replaceOp(op, ret);
+    return success();
+  }
 };
 
 void populateViewOpToLLVMPatterns(TritonGPUToLLVMTypeConverter &typeConverter,
@@ -242,54 +242,68 @@ struct TritonExpandDimsPattern
   }
 };
 
+// Converts the operands `a`, `b` and `c` of a dot to the layouts of the
+// conversion and returns the type of its result, or a null type if `a` or `b`
+// have no layout.
+static RankedTensorType
+convertDotOperands(ConversionPatternRewriter &rewriter,
+                   const TritonGPUTypeConverter *typeConverter,
+                   RankedTensorType origType, Value &a, Value &b, Value &c) {
+  MLIRContext *context = rewriter.getContext();
+  auto origShape = origType.getShape();
+  int numWarps = typeConverter->getNumWarps();
+  int threadsPerWarp = typeConverter->getThreadsPerWarp();
+  int numThreads = numWarps * threadsPerWarp;
+
+  SmallVector<unsigned> retSizePerThread = {1, 1};
+  if (origShape[0] * origShape[1] / numThreads >= 4)
+    retSizePerThread = {2, 2};
+  if (origShape[0] * origShape[1] / numThreads >= 16)
+    retSizePerThread = {4, 4};
+  SmallVector<unsigned> retOrder = {1, 0};
+  Attribute dEncoding = triton::gpu::BlockedEncodingAttr::get(
+      context, origShape, retSizePerThread, retOrder, numWarps, threadsPerWarp);
+  RankedTensorType retType =
+      RankedTensorType::get(origShape, origType.getElementType(), dEncoding);
+  // a & b must be of smem layout
+  auto aType = a.getType().cast<RankedTensorType>();
+  auto bType = b.getType().cast<RankedTensorType>();
+  Type aEltType = aType.getElementType();
+  Type bEltType = bType.getElementType();
+  Attribute aEncoding = aType.getEncoding();
+  Attribute bEncoding = bType.getEncoding();
+  if (!aEncoding || !bEncoding)
+    return {};
+  if (!aEncoding.isa<triton::gpu::DotOperandEncodingAttr>()) {
+    Attribute encoding = triton::gpu::DotOperandEncodingAttr::get(
+        context, 0, dEncoding, aEltType);
+    auto dstType = RankedTensorType::get(aType.getShape(), aEltType, encoding);
+    a = rewriter.create<triton::gpu::ConvertLayoutOp>(a.getLoc(), dstType, a);
+  }
+  if (!bEncoding.isa<triton::gpu::DotOperandEncodingAttr>()) {
+    Attribute encoding = triton::gpu::DotOperandEncodingAttr::get(
+        context, 1, dEncoding, bEltType);
+    auto dstType = RankedTensorType::get(bType.getShape(), bEltType, encoding);
+    b = rewriter.create<triton::gpu::ConvertLayoutOp>(b.getLoc(), dstType, b);
+  }
+  c = rewriter.create<triton::gpu::ConvertLayoutOp>(c.getLoc(), retType, c);
+  return retType;
+}
+
 struct TritonDotPattern : public OpConversionPattern<triton::DotOp> {
   using OpConversionPattern<triton::DotOp>::OpConversionPattern;
 
   LogicalResult
   matchAndRewrite(triton::DotOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
-    RankedTensorType origType = op.getType().cast<RankedTensorType>();
-    auto origShape = origType.getShape();
-    auto typeConverter = getTypeConverter<TritonGPUTypeConverter>();
-    int numWarps = typeConverter->getNumWarps();
-
-    SmallVector<unsigned> retSizePerThread = {1, 1};
-    if (origShape[0] * origShape[1] / (numWarps * 32) >= 4)
-      retSizePerThread = {2, 2};
-    if (origShape[0] * origShape[1] / (numWarps * 32) >= 16)
-      retSizePerThread = {4, 4};
-    SmallVector<unsigned> retOrder = {1, 0};
-    Attribute dEncoding = triton::gpu::BlockedEncodingAttr::get(
-        getContext(), origShape, retSizePerThread, retOrder, numWarps);
-    RankedTensorType retType =
-        RankedTensorType::get(origShape, origType.getElementType(), dEncoding);
-    // a & b must be of smem layout
-    auto aType = adaptor.getA().getType().cast<RankedTensorType>();
-    auto bType = adaptor.getB().getType().cast<RankedTensorType>();
-    Type aEltType = aType.getElementType();
-    Type bEltType = bType.getElementType();
-    Attribute aEncoding = aType.getEncoding();
-    Attribute bEncoding = bType.getEncoding();
-    if (!aEncoding || !bEncoding)
-      return failure();
     Value a = adaptor.getA();
     Value b = adaptor.getB();
     Value c = adaptor.getC();
-    if (!aEncoding.isa<triton::gpu::DotOperandEncodingAttr>()) {
-      Attribute encoding = triton::gpu::DotOperandEncodingAttr::get(
-          getContext(), 0, dEncoding, aEltType);
-      auto dstType =
-          RankedTensorType::get(aType.getShape(), aEltType, encoding);
-      a = rewriter.create<triton::gpu::ConvertLayoutOp>(a.getLoc(), dstType, a);
-    }
-    if (!bEncoding.isa<triton::gpu::DotOperandEncodingAttr>()) {
-      Attribute encoding = triton::gpu::DotOperandEncodingAttr::get(
-          getContext(), 1, dEncoding, bEltType);
-      auto dstType =
-          RankedTensorType::get(bType.getShape(), bEltType, encoding);
-      b = rewriter.create<triton::gpu::ConvertLayoutOp>(b.getLoc(), dstType, b);
-    }
-    c = rewriter.create<triton::gpu::ConvertLayoutOp>(c.getLoc(), retType, c);
+    RankedTensorType retType = convertDotOperands(
+        rewriter, getTypeConverter<TritonGPUTypeConverter>(),
+        op.getType().cast<RankedTensorType>(), a, b, c);
+    if (!retType)
+      return failure();
 
     addNamedAttrs(rewriter.replaceOpWithNewOp<triton::DotOp>(
                       op, retType, a, b, c, adaptor.getAllowTF32()),
@@ -298,6 +312,44 @@ struct TritonDotPattern : public OpConversionPattern<triton::DotOp> {
   }
 };
 
+struct TritonSparseDotPattern
+    : public OpConversionPattern<triton::SparseDotOp> {
+  using OpConversionPattern<triton::SparseDotOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::SparseDotOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Value a = adaptor.getA();
+    Value b = adaptor.getB();
+    Value c = adaptor.getC();
+    RankedTensorType retType = convertDotOperands(
+        rewriter, getTypeConverter<TritonGPUTypeConverter>(),
+        op.getType().cast<RankedTensorType>(), a, b, c);
+    if (!retType)
+      return failure();
+    // the metadata is read from shared memory by the threads that pass it
+    // to the tensor cores
+    Value meta = adaptor.getAMeta();
+    auto metaType = meta.getType().cast<RankedTensorType>();
+    if (!metaType.getEncoding())
+      return failure();
+    SmallVector<unsigned> order = {1, 0};
+    Attribute sharedEncoding =
+        triton::gpu::SharedEncodingAttr::get(getContext(), 1, 1, 1, order);
+    if (metaType.getEncoding() != sharedEncoding)
+      meta = rewriter.create<triton::gpu::ConvertLayoutOp>(
+          meta.getLoc(),
+          RankedTensorType::get(metaType.getShape(),
+                                metaType.getElementType(), sharedEncoding),
+          meta);
+
+    addNamedAttrs(rewriter.replaceOpWithNewOp<triton::SparseDotOp>(
+                      op, retType, a, b, c, meta),
+                  adaptor.getAttributes());
+    return success();
+  }
+};
+
 struct TritonCatPattern : public OpConversionPattern<triton::CatOp> {
 
   using OpConversionPattern<triton::CatOp>::OpConversionPattern;
@@ -327,6 +379,17 @@ struct TritonTransPattern : public OpConversionPattern<triton::TransOp> {
     Attribute srcEncoding = srcType.getEncoding();
     if (!srcEncoding)
       return failure();
+    // A blocked tensor is transposed in registers, unless it feeds a dot
+    // whose operands are read from shared memory anyway
+    bool feedsDot = llvm::any_of(op->getUsers(), [](Operation *user) {
+      return isa<triton::DotOp>(user);
+    });
+    if (srcEncoding.isa<triton::gpu::BlockedEncodingAttr>() && !feedsDot &&
+        srcType.getRank() == 2) {
+      addNamedAttrs(rewriter.replaceOpWithNewOp<triton::TransOp>(op, src),
+                    adaptor.getAttributes());
+      return success();
+    }
     if (!srcEncoding.isa<triton::gpu::SharedEncodingAttr>()) {
       // TODO: end-to-end correctness is broken if
       // the input is blocked and the output is shared
@@ -373,8 +436,8 @@ struct TritonStorePattern : public OpConversionPattern<triton::StoreOp> {
                   ConversionPatternRewriter &rewriter) const override {
     addNamedAttrs(rewriter.replaceOpWithNewOp<triton::StoreOp>(
                       op, adaptor.getPtr(), adaptor.getValue(),
-                      adaptor.getMask(), adaptor.getCache(),
-                      adaptor.getEvict()),
+                      adaptor.getMask(), adaptor.getBoundaryCheckAttr(),
+                      adaptor.getCache(), adaptor.getEvict()),
                   adaptor.getAttributes());
     return success();
   }
@@ -499,6 +562,85 @@ struct TritonReduceReturnPattern
   }
 };
 
+struct TritonScanPattern : public OpConversionPattern<triton::ScanOp> {
+  using OpConversionPattern<triton::ScanOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::ScanOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto newScan = rewriter.create<triton::ScanOp>(
+        op.getLoc(), adaptor.getOperands(), adaptor.getAxis());
+    addNamedAttrs(newScan, adaptor.getAttributes());
+
+    auto &newCombineOp = newScan.getCombineOp();
+    rewriter.cloneRegionBefore(op.getCombineOp(), newCombineOp,
+                               newCombineOp.end());
+    rewriter.replaceOp(op, newScan.getResult());
+    return success();
+  }
+};
+
+struct TritonScanReturnPattern
+    : public OpConversionPattern<triton::ScanReturnOp> {
+  using OpConversionPattern<triton::ScanReturnOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::ScanReturnOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    addNamedAttrs(rewriter.replaceOpWithNewOp<triton::ScanReturnOp>(
+                      op, adaptor.getResult()),
+                  adaptor.getAttributes());
+    return success();
+  }
+};
+
+struct TritonSortPattern : public OpConversionPattern<triton::SortOp> {
+  using OpConversionPattern<triton::SortOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::SortOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    addNamedAttrs(rewriter.replaceOpWithNewOp<triton::SortOp>(
+                      op, adaptor.getOperands(), adaptor.getAxis(),
+                      adaptor.getDescending(), adaptor.getIsUnsigned()),
+                  adaptor.getAttributes());
+    return success();
+  }
+};
+
+// The results keep the layout of the operands
+struct TritonTopKPattern : public OpConversionPattern<triton::TopKOp> {
+  using OpConversionPattern<triton::TopKOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::TopKOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    addNamedAttrs(rewriter.replaceOpWithNewOp<triton::TopKOp>(
+                      op, adaptor.getOperands(), adaptor.getAxis(),
+                      adaptor.getK(), adaptor.getIsUnsigned()),
+                  adaptor.getAttributes());
+    return success();
+  }
+};
+
+// The four words keep the layout of the counter
+struct TritonPhiloxPattern : public OpConversionPattern<triton::PhiloxOp> {
+  using OpConversionPattern<triton::PhiloxOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::PhiloxOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Type retType = adaptor.getC0().getType();
+    addNamedAttrs(rewriter.replaceOpWithNewOp<triton::PhiloxOp>(
+                      op, retType, retType, retType, retType,
+                      adaptor.getC0(), adaptor.getC1(), adaptor.getC2(),
+                      adaptor.getC3(), adaptor.getK0(), adaptor.getK1(),
+                      adaptor.getNRounds()),
+                  adaptor.getAttributes());
+    return success();
+  }
+};
+
 struct TritonPrintPattern : public OpConversionPattern<triton::PrintOp> {
   using OpConversionPattern<triton::PrintOp>::OpConversionPattern;
 
@@ -586,18 +728,55 @@ void populateTritonPatterns(TritonGPUTypeConverter &typeConverter,
           TritonGenericPattern<triton::FpToFpOp>,
           TritonGenericPattern<triton::IntToPtrOp>,
           TritonGenericPattern<triton::PtrToIntOp>,
+          TritonGenericPattern<triton::HistogramOp>,
           TritonGenericPattern<triton::SplatOp>, TritonBroadcastPattern,
           TritonGenericPattern<triton::AddPtrOp>, TritonCatPattern,
-          TritonReducePattern, TritonReduceReturnPattern, TritonTransPattern,
+          TritonReducePattern, TritonReduceReturnPattern, TritonScanPattern,
+          TritonScanReturnPattern, TritonSortPattern, TritonTopKPattern,
+          TritonTransPattern,
           TritonExpandDimsPattern, TritonMakeRangePattern, TritonDotPattern,
-          TritonLoadPattern, TritonStorePattern,
+          TritonSparseDotPattern, TritonLoadPattern, TritonStorePattern,
           TritonExternElementwisePattern<triton::PureExternElementwiseOp>,
           TritonExternElementwisePattern<triton::ImpureExternElementwiseOp>,
+          TritonGenericPattern<triton::ElementwiseInlineAsmOp>,
+          TritonPhiloxPattern,
           TritonPrintPattern, TritonAssertPattern, TritonAtomicRMWPattern,
           TritonFuncOpPattern, TritonReturnOpPattern, TritonCallOpPattern>(
           typeConverter, context);
 }
 
+//
+// TritonGPU patterns
+//
+// The shared memory buffers of the frontend already have their layouts,
+// unlike the pointers and masks copied into them and the tensors loaded out
+// of them.
+struct TritonGPUInsertSliceAsyncPattern
+    : public OpConversionPattern<triton::gpu::InsertSliceAsyncOp> {
+  using OpConversionPattern<
+      triton::gpu::InsertSliceAsyncOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::gpu::InsertSliceAsyncOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    addNamedAttrs(rewriter.replaceOpWithNewOp<triton::gpu::InsertSliceAsyncOp>(
+                      op, adaptor.getDst().getType(), adaptor.getSrc(),
+                      adaptor.getDst(), adaptor.getIndex(), adaptor.getMask(),
+                      adaptor.getOther(), op.getCache(), op.getEvict(),
+                      op.getIsVolatile(), op.getAxis(),
+                      op.getBoundaryCheckAttr()),
+                  adaptor.getAttributes());
+    return success();
+  }
+};
+
+void populateTritonGPUPatterns(TritonGPUTypeConverter &typeConverter,
+                               RewritePatternSet &patterns) {
+  MLIRContext *context = patterns.getContext();
+  patterns.add<GenericOpPattern<triton::gpu::ConvertLayoutOp>,
+               TritonGPUInsertSliceAsyncPattern>(typeConverter, context);
+}
+
 //
 // SCF patterns
 //
@@ -803,18 +982,53 @@ void populateCFPatterns(TritonGPUTypeConverter &typeConverter,
 }
 //
 
+// Returns the number of elements of the largest tensor of the module,
+// including the blocks of its tensor pointers.
+static int64_t getMaxNumElements(ModuleOp mod) {
+  int64_t maxNumElements = 1;
+  auto visit = [&](Type type) {
+    if (auto ptrTy = type.dyn_cast<triton::PointerType>())
+      type = ptrTy.getPointeeType();
+    if (auto tensorTy = type.dyn_cast<RankedTensorType>())
+      maxNumElements = std::max(maxNumElements, tensorTy.getNumElements());
+  };
+  mod.walk([&](Operation *op) {
+    for (Type type : op->getResultTypes())
+      visit(type);
+    for (Region &region : op->getRegions())
+      for (Block &block : region)
+        for (BlockArgument arg : block.getArguments())
+          visit(arg.getType());
+  });
+  return maxNumElements;
+}
+
 class ConvertTritonToTritonGPU
     : public ConvertTritonToTritonGPUBase<ConvertTritonToTritonGPU> {
 public:
   ConvertTritonToTritonGPU() = default;
   // constructor with some parameters set explicitly.
-  ConvertTritonToTritonGPU(int numWarps) { this->numWarps = numWarps; }
+  ConvertTritonToTritonGPU(int numWarps, int threadsPerWarp,
+                           bool autoNumWarps) {
+    this->numWarps = numWarps;
+    this->threadsPerWarp = threadsPerWarp;
+    this->autoNumWarps = autoNumWarps;
+  }
 
   void runOnOperation() override {
     MLIRContext *context = &getContext();
     ModuleOp mod = getOperation();
+    // With autoNumWarps, numWarps is an upper bound: the programs whose
+    // tensors are smaller than the CTA keep the warps that own elements
+    // rather than replicating the tensors, and their loads, in every warp.
+    int numCTAWarps = numWarps;
+    if (autoNumWarps) {
+      int64_t ownerWarps =
+          llvm::divideCeil(getMaxNumElements(mod), threadsPerWarp);
+      numCTAWarps = std::min<int64_t>(numWarps, llvm::PowerOf2Ceil(ownerWarps));
+    }
     // type converter
-    TritonGPUTypeConverter typeConverter(context, numWarps);
+    TritonGPUTypeConverter typeConverter(context, numCTAWarps, threadsPerWarp);
     TritonGPUConversionTarget target(*context, typeConverter);
     // rewrite patterns
     RewritePatternSet patterns(context);
@@ -823,6 +1037,7 @@ public:
     populateArithPatternsAndLegality(typeConverter, patterns, target);
     populateMathPatternsAndLegality(typeConverter, patterns, target);
     populateTritonPatterns(typeConverter, patterns);
+    populateTritonGPUPatterns(typeConverter, patterns);
     // TODO: can we use
     //    mlir::scf::populateSCFStructurealTypeConversionsAndLegality(...) here?
     populateSCFPatterns(typeConverter, patterns);
@@ -836,7 +1051,10 @@ public:
 
     mod->setAttr(
         AttrNumWarpsName,
-        IntegerAttr::get(i32_ty, llvm::APInt(32, numWarps.getValue())));
+        IntegerAttr::get(i32_ty, llvm::APInt(32, numCTAWarps)));
+    mod->setAttr(
+        AttrNumThreadsPerWarp,
+        IntegerAttr::get(i32_ty, llvm::APInt(32, threadsPerWarp.getValue())));
 
     // update layouts
     //  broadcast src => multicast, dst => broadcasted
@@ -848,8 +1066,11 @@ public:
 } // namespace
 
 std::unique_ptr<OperationPass<ModuleOp>>
-mlir::triton::createConvertTritonToTritonGPUPass(int numWarps) {
-  return std::make_unique<::ConvertTritonToTritonGPU>(numWarps);
+mlir::triton::createConvertTritonToTritonGPUPass(int numWarps,
+                                                 int threadsPerWarp,
+                                                 bool autoNumWarps) {
+  return std::make_unique<::ConvertTritonToTritonGPU>(
+      numWarps, threadsPerWarp, autoNumWarps);
 }
 
 std::unique_ptr<OperationPass<ModuleOp>>
@@ -4,6 +4,7 @@
 #include "mlir/IR/FunctionImplementation.h"
 #include "mlir/IR/FunctionInterfaces.h"
 #include "mlir/IR/OperationSupport.h"
+#include "mlir/IR/TypeUtilities.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/Triton/IR/Types.h"
 
@@ -309,6 +310,39 @@ mlir::LogicalResult mlir::triton::DotOp::inferReturnTypes(
   return mlir::success();
 }
 
+//-- SparseDotOp --
+mlir::LogicalResult mlir::triton::SparseDotOp::inferReturnTypes(
+    MLIRContext *context, std::optional<Location> location, ValueRange operands,
+    DictionaryAttr attributes, RegionRange regions,
+    SmallVectorImpl<Type> &inferredReturnTypes) {
+  // the operands of the dot and the accumulator have the same layouts as in
+  // the dense one
+  return DotOp::inferReturnTypes(context, location, operands.take_front(3),
+                                 attributes, regions, inferredReturnTypes);
+}
+
+mlir::LogicalResult mlir::triton::SparseDotOp::verify() {
+  auto aShape = getA().getType().cast<RankedTensorType>().getShape();
+  auto bShape = getB().getType().cast<RankedTensorType>().getShape();
+  auto metaTy = getAMeta().getType().cast<RankedTensorType>();
+  auto metaShape = metaTy.getShape();
+  if (aShape.size() != 2 || bShape.size() != 2 || metaShape.size() != 2)
+    return emitOpError() << "operands must be 2-D tensors";
+  if (2 * aShape[1] != bShape[0])
+    return emitOpError() << "$a must hold half of the " << bShape[0]
+                         << " columns of the dense matrix, but has "
+                         << aShape[1];
+  if (bShape[0] % 32 != 0)
+    return emitOpError() << "the reduction dimension must be a multiple of "
+                            "32, but got "
+                         << bShape[0];
+  if (!metaTy.getElementType().isInteger(16) || metaShape[0] != aShape[0] ||
+      metaShape[1] != bShape[0] / 16)
+    return emitOpError() << "$aMeta must be a " << aShape[0] << "x"
+                         << bShape[0] / 16 << " tensor of i16";
+  return success();
+}
+
 //-- ReduceOp --
 static mlir::LogicalResult
 inferReduceReturnShape(const RankedTensorType &argTy, const Type &retEltTy,
@@ -449,6 +483,225 @@ llvm::SmallVector<Type> ReduceOp::getElementTypes() {
 
 unsigned ReduceOp::getNumOperands() { return this->getOperands().size(); }
 
+//-- ScanOp --
+void ScanOp::build(mlir::OpBuilder &builder, mlir::OperationState &state,
+                   mlir::ValueRange operands, int axis) {
+  SmallVector<Type> inferredReturnTypes;
+  for (auto arg : operands)
+    inferredReturnTypes.push_back(arg.getType());
+  ScanOp::build(builder, state, inferredReturnTypes, operands, axis);
+}
+
+mlir::LogicalResult mlir::triton::ScanOp::inferReturnTypes(
+    MLIRContext *context, std::optional<Location> location, ValueRange operands,
+    DictionaryAttr attributes, RegionRange regions,
+    SmallVectorImpl<Type> &inferredReturnTypes) {
+  for (auto arg : operands)
+    inferredReturnTypes.push_back(arg.getType());
+  return success();
+}
+
+mlir::LogicalResult mlir::triton::ScanOp::verify() {
+  if (this->getOperands().size() < 1) {
+    return this->emitOpError() << "must have at least 1 operand";
+  }
+  for (const auto &operand : this->getOperands()) {
+    auto tensorTy = operand.getType().dyn_cast<RankedTensorType>();
+    if (!tensorTy) {
+      return this->emitOpError() << "operands must be RankedTensorType";
+    }
+    if (getAxis() < 0 || getAxis() >= tensorTy.getRank()) {
+      return this->emitOpError() << "scan axis " << getAxis()
+                                 << " is out of range for operand of rank "
+                                 << tensorTy.getRank();
+    }
+  }
+  return success();
+}
+
+mlir::LogicalResult mlir::triton::ScanOp::verifyRegions() {
+  auto argElementTypes = this->getElementTypes();
+  const auto &operands = this->getOperands();
+  const auto numArgs = 2 * operands.size();
+  auto &block = *this->getBody();
+  if (block.getNumArguments() != numArgs) {
+    return this->emitOpError() << "nested block must take " << numArgs
+                               << " arguments, but given block with "
+                               << block.getNumArguments() << " arguments";
+  }
+  const auto &blockArgTypes = block.getArgumentTypes();
+  for (unsigned i = 0; i < numArgs; ++i) {
+    const auto &blockArgTy = blockArgTypes[i];
+    const auto &argElemTy = argElementTypes[i % operands.size()];
+    if (blockArgTy != argElemTy) {
+      return this->emitOpError()
+             << "type mismatch on combine operation. Expected argument " << i
+             << " to have type " << argElemTy << " but got " << blockArgTy;
+    }
+  }
+
+  auto terminator =
+      dyn_cast<mlir::triton::ScanReturnOp>(block.getTerminator());
+  if (!terminator) {
+    return this->emitOpError()
+           << "combine operation must be terminated "
+           << "with a ScanReturnOp but got " << block.getTerminator();
+  }
+  const auto &combineResults = terminator->getOperands();
+  if (combineResults.size() != operands.size()) {
+    return this->emitOpError()
+           << "expected combine operation to return " << operands.size()
+           << " values but got " << combineResults.size();
+  }
+  for (unsigned i = 0; i < combineResults.size(); ++i) {
+    const auto &resultTy = combineResults[i].getType();
+    const auto &argElemTy = argElementTypes[i];
+    if (resultTy != argElemTy) {
+      return this->emitOpError()
+             << "type mismatch on combine operation. Expected argument " << i
+             << " to have type " << argElemTy << " but got " << resultTy;
+    }
+  }
+  return mlir::success();
+}
+
+llvm::SmallVector<mlir::RankedTensorType> ScanOp::getInputTypes() {
+  llvm::SmallVector<RankedTensorType> srcTys;
+  srcTys.reserve(this->getNumOperands());
+  for (const auto &ty : this->getOperands().getTypes()) {
+    srcTys.push_back(ty.cast<RankedTensorType>());
+  }
+  return srcTys;
+}
+
+llvm::SmallVector<Type> ScanOp::getElementTypes() {
+  llvm::SmallVector<Type> srcElemTys;
+  srcElemTys.reserve(this->getNumOperands());
+  for (const auto &op : this->getOperands()) {
+    srcElemTys.push_back(
+        op.getType().cast<RankedTensorType>().getElementType());
+  }
+  return srcElemTys;
+}
+
+unsigned ScanOp::getNumOperands() { return this->getOperands().size(); }
+
+//-- SortOp --
+// Checks the operands of a sort or top-k op along `axis`.
+static mlir::LogicalResult verifySortOperands(Operation *op,
+                                              ValueRange operands, int axis) {
+  if (operands.empty())
+    return op->emitOpError() << "must have at least 1 operand";
+  for (const auto &operand : operands) {
+    auto tensorTy = operand.getType().dyn_cast<RankedTensorType>();
+    if (!tensorTy)
+      return op->emitOpError() << "operands must be RankedTensorType";
+    if (axis < 0 || axis >= tensorTy.getRank())
+      return op->emitOpError() << "sort axis " << axis
+                               << " is out of range for operand of rank "
+                               << tensorTy.getRank();
+    auto elemTy = tensorTy.getElementType();
+    if (!elemTy.isIntOrFloat() ||
+        (elemTy.isa<FloatType>() && !elemTy.isF16() && !elemTy.isBF16() &&
+         !elemTy.isF32() && !elemTy.isF64()))
+      return op->emitOpError() << "operands must have integer, f16, bf16, "
+                                  "f32 or f64 elements";
+  }
+  auto size = operands[0].getType().cast<RankedTensorType>().getShape()[axis];
+  if (!llvm::isPowerOf2_64(size))
+    return op->emitOpError()
+           << "the size of the sort axis must be a power of 2, but got "
+           << size;
+  return success();
+}
+
+void SortOp::build(mlir::OpBuilder &builder, mlir::OperationState &state,
+                   mlir::ValueRange operands, int axis, bool descending,
+                   bool isUnsigned) {
+  SmallVector<Type> inferredReturnTypes;
+  for (auto arg : operands)
+    inferredReturnTypes.push_back(arg.getType());
+  SortOp::build(builder, state, inferredReturnTypes, operands, axis,
+                descending, isUnsigned);
+}
+
+mlir::LogicalResult mlir::triton::SortOp::inferReturnTypes(
+    MLIRContext *context, std::optional<Location> location, ValueRange operands,
+    DictionaryAttr attributes, RegionRange regions,
+    SmallVectorImpl<Type> &inferredReturnTypes) {
+  for (auto arg : operands)
+    inferredReturnTypes.push_back(arg.getType());
+  return success();
+}
+
+mlir::LogicalResult mlir::triton::SortOp::verify() {
+  return verifySortOperands(*this, getOperands(), getAxis());
+}
+
+//-- TopKOp --
+void TopKOp::build(mlir::OpBuilder &builder, mlir::OperationState &state,
+                   mlir::ValueRange operands, int axis, int k,
+                   bool isUnsigned) {
+  SmallVector<Type> inferredReturnTypes;
+  auto attributes = builder.getDictionaryAttr(
+      {builder.getNamedAttr("axis", builder.getI32IntegerAttr(axis)),
+       builder.getNamedAttr("k", builder.getI32IntegerAttr(k))});
+  (void)TopKOp::inferReturnTypes(builder.getContext(), state.location,
+                                 operands, attributes, {},
+                                 inferredReturnTypes);
+  TopKOp::build(builder, state, inferredReturnTypes, operands, axis, k,
+                isUnsigned);
+}
+
+mlir::LogicalResult mlir::triton::TopKOp::inferReturnTypes(
+    MLIRContext *context, std::optional<Location> location, ValueRange operands,
+    DictionaryAttr attributes, RegionRange regions,
+    SmallVectorImpl<Type> &inferredReturnTypes) {
+  int axis = attributes.get("axis").cast<IntegerAttr>().getInt();
+  int k = attributes.get("k").cast<IntegerAttr>().getInt();
+  for (auto arg : operands) {
+    auto argTy = arg.getType().cast<RankedTensorType>();
+    auto retShape = argTy.getShape().vec();
+    retShape[axis] = k;
+    inferredReturnTypes.push_back(RankedTensorType::get(
+        retShape, argTy.getElementType(), argTy.getEncoding()));
+  }
+  return success();
+}
+
+mlir::LogicalResult mlir::triton::TopKOp::verify() {
+  if (failed(verifySortOperands(*this, getOperands(), getAxis())))
+    return failure();
+  auto size =
+      getOperands()[0].getType().cast<RankedTensorType>().getShape()[getAxis()];
+  if (getK() < 1 || getK() > size || !llvm::isPowerOf2_32(getK()))
+    return emitOpError() << "k must be a power of 2 between 1 and " << size
+                         << ", but got " << getK();
+  return success();
+}
+
+//-- HistogramOp --
+mlir::LogicalResult mlir::triton::HistogramOp::verify() {
+  auto resultTy = getResult().getType().cast<RankedTensorType>();
+  if (resultTy.getRank() != 1)
+    return emitOpError() << "result must be a 1-D tensor of bins";
+  return success();
+}
+
+//-- SemaphoreWaitOp --
+mlir::LogicalResult mlir::triton::SemaphoreWaitOp::verify() {
+  if (getSem() != MemSemantic::RELAXED && getSem() != MemSemantic::ACQUIRE)
+    return emitOpError() << "waits with relaxed or acquire semantics";
+  return success();
+}
+
+//-- SemaphoreSignalOp --
+mlir::LogicalResult mlir::triton::SemaphoreSignalOp::verify() {
+  if (getSem() != MemSemantic::RELAXED && getSem() != MemSemantic::RELEASE)
+    return emitOpError() << "signals with relaxed or release semantics";
+  return success();
+}
+
 //-- SplatOp --
 OpFoldResult SplatOp::fold(FoldAdaptor adaptor) {
   auto value = adaptor.getSrc();
@@ -584,6 +837,31 @@ OpFoldResult BroadcastOp::fold(FoldAdaptor adaptor) {
   return {};
 }
 
+//-- ElementwiseInlineAsmOp --
+void ElementwiseInlineAsmOp::getEffects(
+    SmallVectorImpl<SideEffects::EffectInstance<MemoryEffects::Effect>>
+        &effects) {
+  if (getPure())
+    return;
+  effects.emplace_back(MemoryEffects::Write::get(),
+                       SideEffects::DefaultResource::get());
+  effects.emplace_back(MemoryEffects::Read::get(),
+                       SideEffects::DefaultResource::get());
+}
+
+LogicalResult ElementwiseInlineAsmOp::verify() {
+  unsigned packedElement = getPackedElement();
+  if (packedElement == 0 || !llvm::isPowerOf2_32(packedElement))
+    return emitOpError("packed_element must be a power of 2, got ")
+           << packedElement;
+  auto isBool = [](Type type) {
+    return getElementTypeOrSelf(type).isInteger(1);
+  };
+  if (isBool(getType()) || llvm::any_of(getOperandTypes(), isBool))
+    return emitOpError("operands and results of type i1 are not supported");
+  return success();
+}
+
 //-- MakeTensorPtrOp --
 void MakeTensorPtrOp::build(::mlir::OpBuilder &builder,
                             ::mlir::OperationState &state, ::mlir::Value base,
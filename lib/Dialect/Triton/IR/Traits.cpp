@@ -127,7 +127,16 @@ OpTrait::impl::verifySameLoadStoreOperandsAndResultShape(Operation *op) {
 bool OpTrait::impl::verifyLoadStorePointerAndValueType(Type valueType,
                                                        Type ptrType) {
   if (triton::isTensorPointerType(ptrType)) {
-    return ptrType.cast<triton::PointerType>().getPointeeType() == valueType;
+    // Block pointers carry no layout in TTGIR; the loaded or stored value does
+    auto pointeeType = ptrType.cast<triton::PointerType>()
+                           .getPointeeType()
+                           .cast<RankedTensorType>();
+    if (pointeeType == valueType)
+      return true;
+    auto valueTensorType = valueType.dyn_cast<RankedTensorType>();
+    return !pointeeType.getEncoding() && valueTensorType &&
+           valueTensorType.getShape() == pointeeType.getShape() &&
+           valueTensorType.getElementType() == pointeeType.getElementType();
   } else if (auto rankedType = ptrType.dyn_cast<RankedTensorType>()) {
     if (auto elementPtrType =
             dyn_cast<triton::PointerType>(rankedType.getElementType())) {
@@ -1,5 +1,6 @@
 #include "triton/Dialect/Triton/IR/Types.h"
 #include "mlir/IR/DialectImplementation.h" // required by `Types.cpp.inc`
+#include "mlir/IR/TypeUtilities.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "llvm/ADT/TypeSwitch.h" // required by `Types.cpp.inc`
 
@@ -27,15 +28,23 @@ Type PointerType::parse(AsmParser &parser) {
   if (parser.parseType(pointeeType))
     return Type();
 
+  // The address space is only spelled out when it is not the global one
+  int addressSpace = 1;
+  if (succeeded(parser.parseOptionalComma()) &&
+      parser.parseInteger(addressSpace))
+    return Type();
+
   if (parser.parseGreater())
     return Type();
 
-  // TODO: also print address space?
-  return PointerType::get(pointeeType, 1);
+  return PointerType::get(pointeeType, addressSpace);
 }
 
 void PointerType::print(AsmPrinter &printer) const {
-  printer << "<" << getPointeeType() << ">";
+  printer << "<" << getPointeeType();
+  if (getAddressSpace() != 1)
+    printer << ", " << getAddressSpace();
+  printer << ">";
 }
 
 namespace mlir {
@@ -99,6 +108,12 @@ bool isTensorPointerType(Type type) {
   return false;
 }
 
+bool isParamPointerType(Type type) {
+  if (auto ptrType = getElementTypeOrSelf(type).dyn_cast<PointerType>())
+    return ptrType.getAddressSpace() == kParamAddressSpace;
+  return false;
+}
+
 Type getElementTypeOfTensorPointerType(Type type) {
   if (auto ptrType = type.dyn_cast<PointerType>())
     if (auto tensorTy = ptrType.getPointeeType().dyn_cast<RankedTensorType>())
@@ -1,10 +1,12 @@
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/Matchers.h"
 #include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/TypeUtilities.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
+#include "triton/Analysis/Utility.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/Triton/Transforms/Passes.h"
 
@@ -48,6 +50,40 @@ DenseElementsAttr getConstantValue(Builder &builder, Attribute value,
   return res;
 }
 
+unsigned getOffsetBitWidth(Value offset) {
+  return getElementTypeOrSelf(offset.getType()).getIntOrFloatBitWidth();
+}
+
+// Returns whether the offsets of addptr(addptr(ptr, idx0), idx1) can be added
+// without overflow: in 64 bits, the width of the addresses, or as constants.
+bool isAddPtrOffsetCombinable(Value idx0, Value idx1) {
+  unsigned width = std::max(getOffsetBitWidth(idx0), getOffsetBitWidth(idx1));
+  if (width == 64)
+    return true;
+  APInt cst0, cst1;
+  if (!matchPattern(idx0, m_ConstantInt(&cst0)) ||
+      !matchPattern(idx1, m_ConstantInt(&cst1)))
+    return false;
+  bool overflow = false;
+  (void)cst0.sext(width).sadd_ov(cst1.sext(width), overflow);
+  return !overflow;
+}
+
+// Adds the offsets in the wider of their types, sign-extending the other one
+// as the lowering of addptr does.
+Value combineAddPtrOffsets(OpBuilder &builder, Location loc, Value idx0,
+                           Value idx1) {
+  Type type = getOffsetBitWidth(idx0) >= getOffsetBitWidth(idx1)
+                  ? idx0.getType()
+                  : idx1.getType();
+  auto widen = [&](Value idx) -> Value {
+    if (idx.getType() == type)
+      return idx;
+    return builder.create<arith::ExtSIOp>(loc, type, idx);
+  };
+  return builder.create<arith::AddIOp>(loc, widen(idx0), widen(idx1));
+}
+
 // TODO(csigg): remove after next LLVM integrate.
 using FastMathFlags = arith::FastMathFlags;
 
@@ -76,7 +112,8 @@ public:
 
     auto *loadOpCandidate = trueValue.getDefiningOp();
     auto loadOp = llvm::dyn_cast_or_null<triton::LoadOp>(loadOpCandidate);
-    if (!loadOp)
+    // the rewritten load would drop the ordering of the access
+    if (!loadOp || loadOp.getSem() || loadOp.getScope())
       return mlir::failure();
 
     mlir::Value mask = loadOp.getMask();
@@ -101,6 +138,86 @@ public:
   }
 };
 
+// cmpi(x, y) => true or false when the ranges of x and y decide the
+// comparison, e.g. for the masks of tiles within the bounds:
+//   make_range(0, BLOCK) < splat(N) with N >= BLOCK
+// The masked loads and stores are then canonicalized into unmasked ones.
+class CombineBoundedCmpPattern
+    : public mlir::OpRewritePattern<mlir::arith::CmpIOp> {
+public:
+  using OpRewritePattern<mlir::arith::CmpIOp>::OpRewritePattern;
+
+  mlir::LogicalResult
+  matchAndRewrite(mlir::arith::CmpIOp cmpOp,
+                  mlir::PatternRewriter &rewriter) const override {
+    auto lhs = getIntegerRange(cmpOp.getLhs());
+    auto rhs = getIntegerRange(cmpOp.getRhs());
+    if (!lhs || !rhs)
+      return mlir::failure();
+    std::optional<bool> result = evaluate(cmpOp.getPredicate(), *lhs, *rhs);
+    if (!result)
+      return mlir::failure();
+
+    Type resultType = cmpOp.getType();
+    TypedAttr attr = rewriter.getIntegerAttr(rewriter.getI1Type(), *result);
+    if (auto tensorType = resultType.dyn_cast<RankedTensorType>())
+      attr = DenseElementsAttr::get(tensorType, *result).cast<TypedAttr>();
+    rewriter.replaceOpWithNewOp<arith::ConstantOp>(cmpOp, resultType, attr);
+    return mlir::success();
+  }
+
+private:
+  static std::optional<bool> evaluate(arith::CmpIPredicate predicate,
+                                      IntegerRange lhs, IntegerRange rhs) {
+    using arith::CmpIPredicate;
+    // Unsigned comparisons of non-negative values are the signed ones
+    bool isNonNegative = lhs.first >= 0 && rhs.first >= 0;
+    switch (predicate) {
+    case CmpIPredicate::eq:
+      if (lhs.first == lhs.second && lhs == rhs)
+        return true;
+      if (lhs.second < rhs.first || rhs.second < lhs.first)
+        return false;
+      return std::nullopt;
+    case CmpIPredicate::ne: {
+      auto isEqual = evaluate(CmpIPredicate::eq, lhs, rhs);
+      if (!isEqual)
+        return std::nullopt;
+      return !*isEqual;
+    }
+    case CmpIPredicate::ult:
+      if (!isNonNegative)
+        return std::nullopt;
+      [[fallthrough]];
+    case CmpIPredicate::slt:
+      if (lhs.second < rhs.first)
+        return true;
+      if (lhs.first >= rhs.second)
+        return false;
+      return std::nullopt;
+    case CmpIPredicate::ule:
+      if (!isNonNegative)
+        return std::nullopt;
+      [[fallthrough]];
+    case CmpIPredicate::sle:
+      if (lhs.second <= rhs.first)
+        return true;
+      if (lhs.first > rhs.second)
+        return false;
+      return std::nullopt;
+    case CmpIPredicate::ugt:
+      return evaluate(CmpIPredicate::ult, rhs, lhs);
+    case CmpIPredicate::sgt:
+      return evaluate(CmpIPredicate::slt, rhs, lhs);
+    case CmpIPredicate::uge:
+      return evaluate(CmpIPredicate::ule, rhs, lhs);
+    case CmpIPredicate::sge:
+      return evaluate(CmpIPredicate::sle, rhs, lhs);
+    }
+    return std::nullopt;
+  }
+};
+
 // load(ptr, splat(1), ...)        -> load(ptr, ...)
 // load(ptr, splat(0), other, ...) -> other
 struct CanonicalizeMaskedLoadPattern
@@ -112,7 +229,7 @@ struct CanonicalizeMaskedLoadPattern
   matchAndRewrite(triton::LoadOp loadOp,
                   mlir::PatternRewriter &rewriter) const override {
     auto mask = loadOp.getMask();
-    if (!mask)
+    if (!mask || loadOp.getSem() || loadOp.getScope())
       return mlir::failure();
 
     auto constantMask =
@@ -160,7 +277,7 @@ struct CanonicalizeMaskedStorePattern
   matchAndRewrite(triton::StoreOp storeOp,
                   mlir::PatternRewriter &rewriter) const override {
     auto mask = storeOp.getMask();
-    if (!mask)
+    if (!mask || storeOp.getSem() || storeOp.getScope())
       return mlir::failure();
 
     auto constantMask =
@@ -190,6 +307,83 @@ void triton::StoreOp::getCanonicalizationPatterns(RewritePatternSet &results,
   results.add<CanonicalizeMaskedStorePattern>(context);
 }
 
+// dot(a, x * broadcast(s), c) => c + dot(a, x, 0) * broadcast(s)
+// dot(x * broadcast(s), b, c) => c + dot(x, b, 0) * broadcast(s)
+//   where x is converted from integers and s is a per-column (resp. per-row)
+//   scale, i.e. constant along the K dimension. Applying the scale to the
+//   accumulator makes the dot operand a plain conversion of the quantized
+//   values: they then go through shared memory in their storage type and are
+//   converted in registers, in the dot operand layout.
+//   Only f32 accumulators are supported: the unscaled products of the
+//   quantized values, e.g. up to 127 * 127 * K for int8, overflow an f16 one.
+class CombineDotScalePattern : public mlir::RewritePattern {
+public:
+  CombineDotScalePattern(mlir::MLIRContext *context)
+      : mlir::RewritePattern(mlir::triton::DotOp::getOperationName(), 1,
+                             context) {}
+
+  mlir::LogicalResult
+  matchAndRewrite(mlir::Operation *op,
+                  mlir::PatternRewriter &rewriter) const override {
+    auto dotOp = llvm::cast<mlir::triton::DotOp>(op);
+    auto accType = dotOp.getType().cast<RankedTensorType>();
+    if (!accType.getElementType().isF32())
+      return mlir::failure();
+    Value a = dotOp.getA();
+    Value b = dotOp.getB();
+    Value x, scale;
+    bool isB = matchScaledOperand(b, /*kDim=*/0, x, scale);
+    if (!isB && !matchScaledOperand(a, /*kDim=*/1, x, scale))
+      return mlir::failure();
+
+    Location loc = op->getLoc();
+    Value zero = rewriter.create<arith::ConstantOp>(
+        loc, accType, rewriter.getZeroAttr(accType));
+    Value ret = rewriter.create<mlir::triton::DotOp>(
+        loc, accType, isB ? a : x, isB ? x : b, zero, dotOp.getAllowTF32());
+    auto scaleType = scale.getType().cast<RankedTensorType>();
+    auto accElemType = accType.getElementType().cast<FloatType>();
+    auto scaleElemType = scaleType.getElementType().cast<FloatType>();
+    auto extType = RankedTensorType::get(scaleType.getShape(), accElemType);
+    if (scaleElemType.getWidth() < accElemType.getWidth())
+      scale = rewriter.create<arith::ExtFOp>(loc, extType, scale);
+    else if (scaleElemType.getWidth() > accElemType.getWidth())
+      scale = rewriter.create<arith::TruncFOp>(loc, extType, scale);
+    scale = rewriter.create<mlir::triton::BroadcastOp>(loc, accType, scale);
+    ret = rewriter.create<arith::MulFOp>(loc, ret, scale);
+    if (!isZero(dotOp.getC()))
+      ret = rewriter.create<arith::AddFOp>(loc, dotOp.getC(), ret);
+    rewriter.replaceOp(op, ret);
+    return mlir::success();
+  }
+
+private:
+  static bool matchScaledOperand(Value operand, int kDim, Value &x,
+                                 Value &scale) {
+    auto mulOp = operand.getDefiningOp<arith::MulFOp>();
+    if (!mulOp || !mulOp->hasOneUse())
+      return false;
+    for (int i = 0; i < 2; ++i) {
+      Value lhs = mulOp->getOperand(i);
+      Value rhs = mulOp->getOperand(1 - i);
+      if (!lhs.getDefiningOp<arith::SIToFPOp>() &&
+          !lhs.getDefiningOp<arith::UIToFPOp>())
+        continue;
+      auto broadcastOp = rhs.getDefiningOp<mlir::triton::BroadcastOp>();
+      if (!broadcastOp)
+        continue;
+      auto srcType =
+          broadcastOp.getSrc().getType().dyn_cast<RankedTensorType>();
+      if (!srcType || srcType.getRank() != 2 || srcType.getShape()[kDim] != 1)
+        continue;
+      x = lhs;
+      scale = broadcastOp.getSrc();
+      return true;
+    }
+    return false;
+  }
+};
+
 #define GEN_PASS_CLASSES
 #include "triton/Dialect/Triton/Transforms/Passes.h.inc"
 
@@ -205,9 +399,11 @@ public:
     patterns.add<CombineDotAddFPattern>(context);
     patterns.add<CombineDotAddIRevPattern>(context);
     patterns.add<CombineDotAddFRevPattern>(context);
+    patterns.add<CombineDotScalePattern>(context);
     // %}
     patterns.add<CombineSelectMaskedLoadPattern>(context);
-    // patterns.add<CombineAddPtrPattern>(context);
+    patterns.add<CombineBoundedCmpPattern>(context);
+    patterns.add<CombineAddPtrPattern>(context);
     patterns.add<CombineBroadcastConstantPattern>(context);
 
     if (applyPatternsAndFoldGreedily(m, std::move(patterns)).failed())
@@ -0,0 +1,121 @@
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/TypeUtilities.h"
+#include "mlir/Interfaces/CallInterfaces.h"
+#include "mlir/Pass/Pass.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+
+#include <memory>
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/Triton/Transforms/Passes.h.inc"
+
+namespace {
+
+/// Returns the pointer argument of `funcOp` that `ptr` is computed from, or
+/// null if it is not computed by pointer arithmetic from a single argument.
+Value getBasePointer(Value ptr, FunctionOpInterface funcOp) {
+  while (ptr) {
+    if (auto arg = ptr.dyn_cast<BlockArgument>()) {
+      Operation *parentOp = arg.getOwner()->getParentOp();
+      if (parentOp == funcOp.getOperation())
+        return arg;
+      // The loop-carried pointers start at their init value
+      auto forOp = dyn_cast<scf::ForOp>(parentOp);
+      if (!forOp || arg == forOp.getInductionVar())
+        return Value();
+      ptr = forOp.getOpOperandForRegionIterArg(arg).get();
+      continue;
+    }
+    Operation *defOp = ptr.getDefiningOp();
+    if (auto addPtrOp = dyn_cast<triton::AddPtrOp>(defOp))
+      ptr = addPtrOp.getPtr();
+    else if (auto advanceOp = dyn_cast<triton::AdvanceOp>(defOp))
+      ptr = advanceOp.getPtr();
+    else if (auto makeTensorPtrOp = dyn_cast<triton::MakeTensorPtrOp>(defOp))
+      ptr = makeTensorPtrOp.getBase();
+    else if (isa<triton::SplatOp, triton::BroadcastOp, triton::ExpandDimsOp,
+                 triton::ViewOp>(defOp))
+      ptr = defOp->getOperand(0);
+    else
+      return Value();
+  }
+  return Value();
+}
+
+bool isPointerLike(Type type) {
+  return getElementTypeOrSelf(type).isa<triton::PointerType>();
+}
+
+/// Marks the stores of a kernel as streaming (`.cs`) when the kernel never
+/// reads the memory they write, e.g. the output of an elementwise kernel or
+/// of the epilogue of a matmul, so that its lines are evicted first instead
+/// of the inputs that the next programs read.
+void markStreamingStores(triton::FuncOp funcOp) {
+  // The function arguments the kernel may read through, or null if some
+  // pointer is read whose base is unknown
+  DenseSet<Value> readBases;
+  bool readsUnknown = false;
+  SmallVector<triton::StoreOp> stores;
+  funcOp.walk([&](Operation *op) {
+    if (auto storeOp = dyn_cast<triton::StoreOp>(op)) {
+      stores.push_back(storeOp);
+      // Storing a pointer lets it escape
+      if (isPointerLike(storeOp.getValue().getType()))
+        readsUnknown = true;
+      return;
+    }
+    // The address computations and the loop-carried pointers do not access
+    // memory; `getBasePointer` looks through them
+    if (isa<triton::AddPtrOp, triton::AdvanceOp, triton::MakeTensorPtrOp,
+            triton::SplatOp, triton::BroadcastOp, triton::ExpandDimsOp,
+            triton::ViewOp, scf::ForOp, scf::YieldOp>(op))
+      return;
+    // Any other use of a pointer, a load, an atomic or a call, may read it
+    for (Value operand : op->getOperands()) {
+      if (!isPointerLike(operand.getType()))
+        continue;
+      if (Value base = getBasePointer(operand, funcOp))
+        readBases.insert(base);
+      else
+        readsUnknown = true;
+    }
+  });
+  if (readsUnknown)
+    return;
+  MLIRContext *ctx = funcOp.getContext();
+  for (triton::StoreOp storeOp : stores) {
+    // The hints of the user are kept
+    if (storeOp.getCache() != triton::CacheModifier::NONE ||
+        storeOp.getEvict() != triton::EvictionPolicy::NORMAL)
+      continue;
+    // Ordered stores publish data that other programs read
+    if (storeOp.getSem() || storeOp.getScope())
+      continue;
+    Value base = getBasePointer(storeOp.getPtr(), funcOp);
+    if (!base || readBases.contains(base))
+      continue;
+    storeOp.setCacheAttr(
+        triton::CacheModifierAttr::get(ctx, triton::CacheModifier::CS));
+  }
+}
+
+class MarkStreamingStoresPass
+    : public TritonMarkStreamingStoresBase<MarkStreamingStoresPass> {
+public:
+  void runOnOperation() override {
+    // The callers of the other functions may read what they write
+    getOperation().walk([](triton::FuncOp funcOp) {
+      if (funcOp.isPublic())
+        markStreamingStores(funcOp);
+    });
+  }
+};
+
+} // namespace
+
+std::unique_ptr<Pass> triton::createMarkStreamingStoresPass() {
+  return std::make_unique<MarkStreamingStoresPass>();
+}
@@ -0,0 +1,212 @@
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/Pass/Pass.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+
+#include <memory>
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/Triton/Transforms/Passes.h.inc"
+
+namespace {
+
+/// A loop-carried tensor of pointers `splat(base) + offsets` advanced by
+/// uniform `steps` per iteration, the splat offsets of its addptrs.
+struct RebasedPointer {
+  unsigned argIdx;
+  Value base;
+  Value offsets;
+  SmallVector<Value> steps;
+};
+
+/// Whether `value` is a splat tensor of integers whose scalar is defined
+/// before `forOp`: a splat of a value defined outside of the loop, a splat
+/// constant, or extensions, additions and multiplications of those, e.g. the
+/// offsets of triton-combine.
+bool isSplatScalar(Value value, scf::ForOp forOp) {
+  if (auto splatOp = value.getDefiningOp<triton::SplatOp>())
+    return forOp.isDefinedOutsideOfLoop(splatOp.getSrc());
+  Operation *op = value.getDefiningOp();
+  if (isa_and_nonnull<arith::ExtSIOp, arith::AddIOp, arith::MulIOp>(op))
+    return llvm::all_of(op->getOperands(), [&](Value operand) {
+      return isSplatScalar(operand, forOp);
+    });
+  auto constOp = value.getDefiningOp<arith::ConstantOp>();
+  return constOp && constOp.getValue().isa<SplatElementsAttr>();
+}
+
+/// Returns the scalar of `value`, for which isSplatScalar holds, built at the
+/// insertion point of `builder`.
+Value buildSplatScalar(OpBuilder &builder, Value value) {
+  if (auto splatOp = value.getDefiningOp<triton::SplatOp>())
+    return splatOp.getSrc();
+  Operation *op = value.getDefiningOp();
+  if (auto constOp = dyn_cast<arith::ConstantOp>(op)) {
+    auto attr = constOp.getValue().cast<SplatElementsAttr>();
+    return builder.create<arith::ConstantOp>(
+        constOp.getLoc(), attr.getSplatValue<Attribute>().cast<TypedAttr>());
+  }
+  SmallVector<Value> operands;
+  for (Value operand : op->getOperands())
+    operands.push_back(buildSplatScalar(builder, operand));
+  Type type = value.getType().cast<RankedTensorType>().getElementType();
+  OperationState state(op->getLoc(), op->getName(), operands, type,
+                       op->getAttrs());
+  return builder.create(state)->getResult(0);
+}
+
+std::optional<RebasedPointer> matchRebasedPointer(scf::ForOp forOp,
+                                                  unsigned argIdx) {
+  BlockArgument arg = forOp.getRegionIterArgs()[argIdx];
+  auto tensorTy = arg.getType().dyn_cast<RankedTensorType>();
+  if (!tensorTy || !tensorTy.getElementType().isa<triton::PointerType>())
+    return std::nullopt;
+  // The initial pointers, `splat(base) + offsets`
+  Value init = forOp.getIterOperands()[argIdx];
+  auto initOp = init.getDefiningOp<triton::AddPtrOp>();
+  if (!initOp)
+    return std::nullopt;
+  auto splatOp = initOp.getPtr().getDefiningOp<triton::SplatOp>();
+  if (!splatOp)
+    return std::nullopt;
+  // The pointers of the next iteration, `arg + splat(step0) + ...`, whose
+  // steps may be of different widths
+  auto yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
+  SmallVector<Value> steps;
+  Value next = yieldOp.getOperand(argIdx);
+  while (next != arg) {
+    auto nextOp = next.getDefiningOp<triton::AddPtrOp>();
+    if (!nextOp || !nextOp->hasOneUse())
+      return std::nullopt;
+    if (!isSplatScalar(nextOp.getOffset(), forOp))
+      return std::nullopt;
+    steps.push_back(nextOp.getOffset());
+    next = nextOp.getPtr();
+  }
+  if (steps.empty())
+    return std::nullopt;
+  std::reverse(steps.begin(), steps.end());
+  return RebasedPointer{argIdx, splatOp.getSrc(), initOp.getOffset(), steps};
+}
+
+/// Carries the scalar base pointers of the tensors of pointers advanced by a
+/// uniform step instead of the tensors, and rebuilds the tensors from the
+/// loop-invariant offsets in the body:
+///
+///   %p0 = addptr(splat(%base), %offsets)
+///   scf.for ... iter_args(%p = %p0) {
+///     load %p
+///     scf.yield addptr(%p, splat(%step))
+///   }
+///
+/// becomes
+///
+///   scf.for ... iter_args(%b = %base) {
+///     load addptr(splat(%b), %offsets)
+///     scf.yield addptr(%b, %step)
+///   }
+///
+/// Across the loop, each thread then holds the 32-bit offsets of its elements
+/// and one 64-bit base, instead of a 64-bit pointer per element; the
+/// addresses are formed next to the memory accesses.
+void rebaseLoopPointers(scf::ForOp forOp) {
+  SmallVector<RebasedPointer> rebased;
+  for (unsigned i = 0; i < forOp.getNumRegionIterArgs(); ++i)
+    if (auto ptr = matchRebasedPointer(forOp, i))
+      rebased.push_back(*ptr);
+  if (rebased.empty())
+    return;
+
+  OpBuilder builder(forOp);
+  Location loc = forOp.getLoc();
+  // The scalar steps, once all the pointers matched
+  DenseMap<Value, Value> scalarSteps;
+  for (const RebasedPointer &ptr : rebased)
+    for (Value step : ptr.steps)
+      if (!scalarSteps.count(step))
+        scalarSteps[step] = buildSplatScalar(builder, step);
+  SmallVector<Value> newLoopArgs(forOp.getIterOperands().begin(),
+                                 forOp.getIterOperands().end());
+  for (const RebasedPointer &ptr : rebased)
+    newLoopArgs[ptr.argIdx] = ptr.base;
+  auto newForOp =
+      builder.create<scf::ForOp>(loc, forOp.getLowerBound(),
+                                 forOp.getUpperBound(), forOp.getStep(),
+                                 newLoopArgs);
+  newForOp->setAttrs(forOp->getAttrs());
+  auto rebuild = [&](Value base, const RebasedPointer &ptr, Type type) {
+    Value splat = builder.create<triton::SplatOp>(loc, type, base);
+    return builder.create<triton::AddPtrOp>(loc, type, splat, ptr.offsets)
+        .getResult();
+  };
+
+  builder.setInsertionPointToStart(newForOp.getBody());
+  IRMapping mapping;
+  mapping.map(forOp.getInductionVar(), newForOp.getInductionVar());
+  for (const auto &arg : llvm::enumerate(forOp.getRegionIterArgs()))
+    mapping.map(arg.value(), newForOp.getRegionIterArgs()[arg.index()]);
+  for (const RebasedPointer &ptr : rebased) {
+    BlockArgument arg = forOp.getRegionIterArgs()[ptr.argIdx];
+    mapping.map(arg, rebuild(newForOp.getRegionIterArgs()[ptr.argIdx], ptr,
+                             arg.getType()));
+  }
+  auto yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
+  DenseSet<Operation *> nextOps;
+  for (const RebasedPointer &ptr : rebased) {
+    Value next = yieldOp.getOperand(ptr.argIdx);
+    for (size_t i = 0; i < ptr.steps.size(); ++i) {
+      Operation *nextOp = next.getDefiningOp();
+      nextOps.insert(nextOp);
+      next = cast<triton::AddPtrOp>(nextOp).getPtr();
+    }
+  }
+  for (Operation &op : forOp.getBody()->without_terminator())
+    if (!nextOps.contains(&op))
+      builder.clone(op, mapping);
+
+  SmallVector<Value> yieldValues;
+  for (Value v : yieldOp.getOperands())
+    yieldValues.push_back(mapping.lookupOrDefault(v));
+  for (const RebasedPointer &ptr : rebased) {
+    Value base = newForOp.getRegionIterArgs()[ptr.argIdx];
+    for (Value step : ptr.steps)
+      base = builder.create<triton::AddPtrOp>(loc, base.getType(), base,
+                                              scalarSteps.lookup(step));
+    yieldValues[ptr.argIdx] = base;
+  }
+  builder.create<scf::YieldOp>(yieldOp.getLoc(), yieldValues);
+
+  // The pointers after the loop
+  builder.setInsertionPointAfter(newForOp);
+  SmallVector<Value> results(newForOp.getResults());
+  for (const RebasedPointer &ptr : rebased) {
+    Value result = forOp.getResult(ptr.argIdx);
+    if (!result.use_empty())
+      results[ptr.argIdx] =
+          rebuild(newForOp.getResult(ptr.argIdx), ptr, result.getType());
+  }
+  forOp->replaceAllUsesWith(results);
+  forOp.erase();
+}
+
+class RebaseLoopPointersPass
+    : public TritonRebaseLoopPointersBase<RebaseLoopPointersPass> {
+public:
+  void runOnOperation() override {
+    // The inner loops first, so that an outer loop sees their new operands
+    SmallVector<scf::ForOp> forOps;
+    getOperation().walk([&](scf::ForOp forOp) { forOps.push_back(forOp); });
+    for (scf::ForOp forOp : forOps)
+      rebaseLoopPointers(forOp);
+  }
+};
+
+} // namespace
+
+std::unique_ptr<Pass> triton::createRebaseLoopPointersPass() {
+  return std::make_unique<RebaseLoopPointersPass>();
+}
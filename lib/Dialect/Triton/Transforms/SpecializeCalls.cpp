@@ -0,0 +1,150 @@
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/TypeUtilities.h"
+#include "mlir/Pass/Pass.h"
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Analysis/Utility.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+
+#include <map>
+#include <memory>
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/Triton/Transforms/Passes.h.inc"
+
+namespace {
+
+/// The specializations of a function, keyed by the axis info of the
+/// arguments at their call sites.
+struct Specializations {
+  /// The argument attributes of the function before any specialization
+  SmallVector<DictionaryAttr> argAttrs;
+  std::map<SmallVector<int64_t>, triton::FuncOp> funcs;
+  /// The clone shared by the call sites after `maxClones` specializations
+  triton::FuncOp generic;
+};
+
+/// Specializes the callees top-down along the call graph: the axis info of
+/// the arguments of a function is final once all its callers are done.
+class CallSpecializer : public CallGraph<Specializations> {
+public:
+  CallSpecializer(ModuleOp moduleOp, unsigned maxClones)
+      : CallGraph<Specializations>(moduleOp), maxClones(maxClones) {
+    SmallVector<FunctionOpInterface> funcs;
+    walk<WalkOrder::PreOrder, WalkOrder::PostOrder>(
+        // Pre-order edge walk callback
+        [](CallOpInterface callOp, FunctionOpInterface funcOp) {},
+        // Post-order node walk callback
+        [&](FunctionOpInterface funcOp) {
+          funcs.push_back(funcOp);
+          funcMap.try_emplace(funcOp, Specializations{});
+        });
+    SetVector<FunctionOpInterface> sortedFuncs(funcs.begin(), funcs.end());
+    worklist.insert(sortedFuncs.rbegin(), sortedFuncs.rend());
+  }
+
+  LogicalResult run() {
+    // The clones are appended to the worklist, after all their callers
+    for (unsigned i = 0; i < worklist.size(); ++i)
+      if (failed(specializeCallees(worklist[i])))
+        return failure();
+    return success();
+  }
+
+private:
+  LogicalResult specializeCallees(FunctionOpInterface funcOp) {
+    std::unique_ptr<DataFlowSolver> solver = createDataFlowSolver();
+    AxisInfoAnalysis *analysis = solver->load<AxisInfoAnalysis>();
+    if (failed(solver->initializeAndRun(funcOp)))
+      return failure();
+    SmallVector<triton::CallOp> callOps;
+    funcOp.walk([&](triton::CallOp callOp) { callOps.push_back(callOp); });
+    for (auto callOp : callOps) {
+      auto &symbolTable = symbolTables.getSymbolTable(moduleOp);
+      auto callee = symbolTable.lookup<triton::FuncOp>(callOp.getCallee());
+      if (!callee || callee.isExternal())
+        continue;
+      auto *specs = getFuncData(callee);
+      if (!specs)
+        continue;
+      if (specs->funcs.empty() && !specs->generic) {
+        for (unsigned i = 0; i < callee.getNumArguments(); ++i) {
+          auto attrs = callee.getArgAttrDict(i);
+          specs->argAttrs.push_back(
+              attrs ? attrs : DictionaryAttr::get(callee.getContext()));
+        }
+      }
+
+      // Float arguments don't take part in the addressing
+      SmallVector<AxisInfo> argInfos;
+      SmallVector<int64_t> key;
+      for (auto operand : callOp.getOperands()) {
+        auto info = analysis->getLatticeElement(operand)->getValue();
+        // The operands in dead code are not visited
+        if (info.getRank() == 0)
+          info = AxisInfo::getPessimisticValueState(operand);
+        argInfos.push_back(info);
+        if (getElementTypeOrSelf(operand.getType()).isa<FloatType>())
+          continue;
+        key.append(info.getContiguity().begin(), info.getContiguity().end());
+        key.append(info.getDivisibility().begin(),
+                   info.getDivisibility().end());
+        key.append(info.getConstancy().begin(), info.getConstancy().end());
+      }
+
+      triton::FuncOp target;
+      auto it = specs->funcs.find(key);
+      if (it != specs->funcs.end()) {
+        target = it->second;
+      } else if (specs->funcs.size() >= maxClones) {
+        if (!specs->generic)
+          specs->generic = cloneCallee(callee, *specs);
+        target = specs->generic;
+      } else {
+        target = specs->funcs.empty() ? callee : cloneCallee(callee, *specs);
+        for (auto entry : llvm::enumerate(argInfos))
+          entry.value().joinFuncArgAttrs(target, entry.index());
+        specs->funcs.emplace(key, target);
+      }
+      if (target != callee)
+        callOp.setCalleeAttr(FlatSymbolRefAttr::get(target));
+    }
+    return success();
+  }
+
+  triton::FuncOp cloneCallee(triton::FuncOp callee,
+                             const Specializations &specs) {
+    auto clone = cast<triton::FuncOp>(callee->clone());
+    for (auto entry : llvm::enumerate(specs.argAttrs))
+      clone.setArgAttrs(entry.index(), entry.value());
+    // The symbol table renames the clone
+    symbolTables.getSymbolTable(moduleOp).insert(clone, callee->getIterator());
+    worklist.insert(clone);
+    return clone;
+  }
+
+  unsigned maxClones;
+  SymbolTableCollection symbolTables;
+  SetVector<FunctionOpInterface> worklist;
+};
+
+class SpecializeCallsPass
+    : public TritonSpecializeCallsBase<SpecializeCallsPass> {
+public:
+  SpecializeCallsPass() = default;
+  SpecializeCallsPass(unsigned maxClones) { this->maxClones = maxClones; }
+
+  void runOnOperation() override {
+    CallSpecializer specializer(getOperation(), maxClones);
+    if (failed(specializer.run()))
+      signalPassFailure();
+  }
+};
+
+} // namespace
+
+std::unique_ptr<Pass> triton::createSpecializeCallsPass(unsigned maxClones) {
+  return std::make_unique<SpecializeCallsPass>(maxClones);
+}
@@ -4,6 +4,7 @@
 
 #include "mlir/IR/DialectImplementation.h"
 #include "mlir/IR/OpImplementation.h"
+#include "mlir/IR/TypeUtilities.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.cpp.inc"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
@@ -78,7 +79,7 @@ SmallVector<unsigned> getThreadsPerWarp(Attribute layout) {
   if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
     if (mmaLayout.isVolta())
       return {4, 8};
-    if (mmaLayout.isAmpere())
+    if (mmaLayout.isAmpere() || mmaLayout.isHopper())
       return {8, 4};
   }
   if (auto sliceLayout = layout.dyn_cast<SliceEncodingAttr>()) {
@@ -171,7 +172,7 @@ SmallVector<unsigned> getSizePerThread(Attribute layout) {
     sizePerThread.erase(sizePerThread.begin() + sliceLayout.getDim());
     return sizePerThread;
   } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
-    if (mmaLayout.isAmpere()) {
+    if (mmaLayout.isAmpere() || mmaLayout.isHopper()) {
       return {2, 2};
     } else if (mmaLayout.isVolta()) {
       return {1, 2};
@@ -182,7 +183,7 @@ SmallVector<unsigned> getSizePerThread(Attribute layout) {
     auto parentLayout = dotLayout.getParent();
     assert(parentLayout && "DotOperandEncodingAttr must have a parent");
     if (auto parentMmaLayout = parentLayout.dyn_cast<MmaEncodingAttr>()) {
-      assert(parentMmaLayout.isAmpere() &&
+      assert((parentMmaLayout.isAmpere() || parentMmaLayout.isHopper()) &&
              "mmaLayout version = 1 is not implemented yet");
       auto parentShapePerCTA = getShapePerCTA(parentLayout);
       auto opIdx = dotLayout.getOpIdx();
@@ -207,7 +208,7 @@ SmallVector<unsigned> getSizePerThread(Attribute layout) {
 
 SmallVector<unsigned> getContigPerThread(Attribute layout) {
   if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
-    assert(mmaLayout.isVolta() || mmaLayout.isAmpere());
+    assert(mmaLayout.isVolta() || mmaLayout.isAmpere() || mmaLayout.isHopper());
     return {1, 2};
   } else if (auto sliceLayout = layout.dyn_cast<SliceEncodingAttr>()) {
     auto parentLayout = sliceLayout.getParent();
@@ -253,7 +254,7 @@ SmallVector<unsigned> getThreadsPerCTA(Attribute layout) {
       threads.push_back(blockedLayout.getThreadsPerWarp()[d] *
                         blockedLayout.getWarpsPerCTA()[d]);
   } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
-    if (mmaLayout.isAmpere()) {
+    if (mmaLayout.isAmpere() || mmaLayout.isHopper()) {
       threads = {8 * mmaLayout.getWarpsPerCTA()[0],
                  4 * mmaLayout.getWarpsPerCTA()[1]};
     } else
@@ -282,7 +283,7 @@ SmallVector<unsigned> getShapePerCTA(Attribute layout,
       shape.push_back(getShapePerCTA(parent, tensorShape)[d]);
     }
   } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
-    if (mmaLayout.isAmpere())
+    if (mmaLayout.isAmpere() || mmaLayout.isHopper())
       return {16 * mmaLayout.getWarpsPerCTA()[0],
               8 * mmaLayout.getWarpsPerCTA()[1]};
     if (mmaLayout.isVolta()) {
@@ -298,7 +299,7 @@ SmallVector<unsigned> getShapePerCTA(Attribute layout,
     auto parentLayout = dotLayout.getParent();
     assert(parentLayout && "DotOperandEncodingAttr must have a parent");
     if (auto parentMmaLayout = parentLayout.dyn_cast<MmaEncodingAttr>()) {
-      assert(parentMmaLayout.isAmpere() &&
+      assert((parentMmaLayout.isAmpere() || parentMmaLayout.isHopper()) &&
              "mmaLayout version = 1 is not implemented yet");
       auto parentShapePerCTA = getShapePerCTA(parentLayout, tensorShape);
       auto opIdx = dotLayout.getOpIdx();
@@ -482,7 +483,8 @@ SmallVector<unsigned>
 MmaEncodingAttr::getElemsPerThread(ArrayRef<int64_t> shape, Type eltTy) const {
   size_t rank = shape.size();
   assert(rank == 2 && "Unexpected rank of mma layout");
-  assert((isVolta() || isAmpere()) && "Only version 1 and 2 is supported");
+  assert((isVolta() || isAmpere() || isHopper()) &&
+         "Only version 1, 2 and 3 are supported");
 
   SmallVector<unsigned> elemsPerThread(rank);
   if (isVolta()) {
@@ -500,7 +502,7 @@ MmaEncodingAttr::getElemsPerThread(ArrayRef<int64_t> shape, Type eltTy) const {
     unsigned resN = 2 * repN * std::max<int>(1, shape[1] / (spwN * wptN));
     elemsPerThread[0] = resM;
     elemsPerThread[1] = resN;
-  } else if (isAmpere()) {
+  } else if (isAmpere() || isHopper()) {
     unsigned elemsRow = ceil<unsigned>(shape[0], 16 * getWarpsPerCTA()[0]) * 2;
     unsigned elemsCol = ceil<unsigned>(shape[1], 8 * getWarpsPerCTA()[1]) * 2;
     elemsPerThread[0] = elemsRow;
@@ -535,7 +537,7 @@ DotOperandEncodingAttr::getMMAv2Rep(ArrayRef<int64_t> shape,
   auto mmaParent = getParent().cast<MmaEncodingAttr>();
   SmallVector<int> shapePerWarp = {16, 8, 4 * 64 / bitwidth};
   auto warpsPerCTA = getParent().cast<MmaEncodingAttr>().getWarpsPerCTA();
-  assert(mmaParent.isAmpere());
+  assert(mmaParent.isAmpere() || mmaParent.isHopper());
   if (getOpIdx() == 0)
     return {std::max<int64_t>(1, shape[0] / (shapePerWarp[0] * warpsPerCTA[0])),
             std::max<int64_t>(1, shape[1] / shapePerWarp[2])};
@@ -559,8 +561,8 @@ unsigned DotOperandEncodingAttr::getTotalElemsPerThread(ArrayRef<int64_t> shape,
   if (auto mmaParent = getParent().dyn_cast<MmaEncodingAttr>()) {
     int warpsPerCTAM = mmaParent.getWarpsPerCTA()[0];
     int warpsPerCTAN = mmaParent.getWarpsPerCTA()[1];
-    // A100
-    if (mmaParent.isAmpere()) {
+    // A100 and H100
+    if (mmaParent.isAmpere() || mmaParent.isHopper()) {
       auto rep = getMMAv2Rep(shape, eltTy.getIntOrFloatBitWidth());
       if (getOpIdx() == 0)
         return 4 * rep[0] * rep[1];
@@ -841,6 +843,8 @@ bool MmaEncodingAttr::isVolta() const { return getVersionMajor() == 1; }
 
 bool MmaEncodingAttr::isAmpere() const { return getVersionMajor() == 2; }
 
+bool MmaEncodingAttr::isHopper() const { return getVersionMajor() == 3; }
+
 // Get [isARow, isBRow, isAVec4, isBVec4, id] from versionMinor
 std::tuple<bool, bool, bool, bool, int>
 MmaEncodingAttr::decodeVoltaLayoutStates() const {
@@ -889,7 +893,7 @@ void DotOperandEncodingAttr::print(mlir::AsmPrinter &printer) const {
   auto mmaParent = getParent().dyn_cast<MmaEncodingAttr>();
   printer << "<{"
           << "opIdx = " << getOpIdx() << ", parent = " << getParent();
-  if (mmaParent && mmaParent.isAmpere())
+  if (mmaParent && (mmaParent.isAmpere() || mmaParent.isHopper()))
     printer << ", kWidth = " << getMMAv2kWidth();
   printer << "}>";
 }
@@ -953,12 +957,18 @@ int DotOperandEncodingAttr::getMMAv1NumOuter(ArrayRef<int64_t> shape) const {
 ParseResult InsertSliceAsyncOp::parse(OpAsmParser &parser,
                                       OperationState &result) {
   SmallVector<OpAsmParser::UnresolvedOperand, 8> allOperands;
-  Type srcType, dstType;
+  Type srcType, maskType, dstType;
   SMLoc allOperandLoc = parser.getCurrentLocation();
   if (parser.parseOperandList(allOperands) ||
       parser.parseOptionalAttrDict(result.attributes) || parser.parseColon() ||
-      parser.parseCustomTypeWithFallback(srcType) || parser.parseArrow() ||
-      parser.parseCustomTypeWithFallback(dstType))
+      parser.parseCustomTypeWithFallback(srcType))
+    return failure();
+  // A block pointer has no layout, the layout of the copy is given by the
+  // type of the mask
+  if (succeeded(parser.parseOptionalComma()) &&
+      parser.parseCustomTypeWithFallback(maskType))
+    return failure();
+  if (parser.parseArrow() || parser.parseCustomTypeWithFallback(dstType))
     return failure();
   result.addTypes(dstType);
 
@@ -970,11 +980,17 @@ ParseResult InsertSliceAsyncOp::parse(OpAsmParser &parser,
 
   int hasMask = 0, hasOther = 0;
   if (allOperands.size() >= 4) {
-    operandTypes.push_back(triton::getI1SameShape(srcType)); // mask
+    if (!maskType)
+      maskType = triton::getI1SameShape(srcType);
+    operandTypes.push_back(maskType); // mask
     hasMask = 1;
   }
   if (allOperands.size() >= 5) {
-    operandTypes.push_back(triton::getPointeeType(srcType)); // other
+    auto maskTensorType = maskType.cast<RankedTensorType>();
+    operandTypes.push_back(RankedTensorType::get(
+        maskTensorType.getShape(),
+        getElementTypeOrSelf(triton::getPointeeType(srcType)),
+        maskTensorType.getEncoding())); // other
     hasOther = 1;
   }
 
@@ -999,6 +1015,10 @@ void InsertSliceAsyncOp::print(OpAsmPrinter &printer) {
                                 {getOperandSegmentSizesAttrName()});
   printer << " : ";
   printer.printStrippedAttrOrType(getSrc().getType());
+  if (triton::isTensorPointerType(getSrc().getType()) && getMask()) {
+    printer << ", ";
+    printer.printStrippedAttrOrType(getMask().getType());
+  }
   printer << " -> ";
   printer.printStrippedAttrOrType(getResult().getType());
 }
@@ -1043,6 +1063,24 @@ struct TritonGPUInferLayoutInterface
 
   LogicalResult inferTransOpEncoding(Attribute operandEncoding,
                                      Attribute &resultEncoding) const override {
+    // A transposed blocked layout swaps the dimensions of its threads and
+    // warps: each thread keeps its registers, under transposed indices.
+    if (auto blockedEncoding =
+            operandEncoding.dyn_cast<BlockedEncodingAttr>()) {
+      auto reversed = [](ArrayRef<unsigned> values) {
+        return SmallVector<unsigned>(values.rbegin(), values.rend());
+      };
+      unsigned rank = blockedEncoding.getOrder().size();
+      SmallVector<unsigned> retOrder;
+      for (unsigned dim : blockedEncoding.getOrder())
+        retOrder.push_back(rank - 1 - dim);
+      resultEncoding = BlockedEncodingAttr::get(
+          getDialect()->getContext(),
+          reversed(blockedEncoding.getSizePerThread()),
+          reversed(blockedEncoding.getThreadsPerWarp()),
+          reversed(blockedEncoding.getWarpsPerCTA()), retOrder);
+      return mlir::success();
+    }
     SharedEncodingAttr sharedEncoding =
         operandEncoding.dyn_cast<SharedEncodingAttr>();
     if (!sharedEncoding)
@@ -1097,6 +1135,10 @@ LogicalResult ConvertLayoutOp::canonicalize(ConvertLayoutOp op,
   // this is a heuristics to accommodate fused attention
   auto srcType = op.getOperand().getType().cast<RankedTensorType>();
   auto dstType = op.getType().cast<RankedTensorType>();
+  // the loads of shared memory buffers in the frontend have no layout until
+  // the conversion to TritonGPU assigns one
+  if (!dstType.getEncoding())
+    return mlir::failure();
   if (dstType.getEncoding().isa<triton::gpu::DotOperandEncodingAttr>() &&
       srcType.getEncoding().isa<triton::gpu::MmaEncodingAttr>())
     return mlir::failure();
@@ -1150,7 +1192,7 @@ LogicalResult ConvertLayoutOp::canonicalize(ConvertLayoutOp op,
         insert_slice.getIndex(), insert_slice.getMask(),
         insert_slice.getOther(), insert_slice.getCache(),
         insert_slice.getEvict(), insert_slice.getIsVolatile(),
-        insert_slice.getAxis());
+        insert_slice.getAxis(), insert_slice.getBoundaryCheckAttr());
     return mlir::success();
   }
   // cvt(extract_slice(x), type2) -> extract_slice(cvt(x, type2))
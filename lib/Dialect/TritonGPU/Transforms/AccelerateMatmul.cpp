@@ -22,8 +22,7 @@ int computeCapabilityToMMAVersion(int computeCapability) {
   } else if (computeCapability < 90) {
     return 2;
   } else if (computeCapability < 100) {
-    // FIXME: temporarily add this to pass unis tests
-    return 2;
+    return 3;
   } else {
     assert(false && "computeCapability > 100 not supported");
     return 3;
@@ -33,7 +32,7 @@ int computeCapabilityToMMAVersion(int computeCapability) {
 SmallVector<int64_t, 2> mmaVersionToShapePerWarp(int version) {
   if (version == 1)
     return {16, 16};
-  else if (version == 2)
+  else if (version == 2 || version == 3)
     return {16, 8};
   else {
     assert(false && "version not supported");
@@ -41,14 +40,25 @@ SmallVector<int64_t, 2> mmaVersionToShapePerWarp(int version) {
   }
 }
 
-SmallVector<unsigned, 2> warpsPerTileV2(triton::DotOp dotOp,
+// `dotOp` is a tt.dot or a tt.sparse_dot, whose first operand is $a.
+SmallVector<unsigned, 2> warpsPerTileV2(Operation *dotOp,
                                         const ArrayRef<int64_t> shape,
                                         int numWarps) {
+  // The dots of a chain split their rows over all the warps, so that the
+  // result of a dot is read in registers as $a of the next one (see
+  // isMmaToDotShortcut)
+  auto isDot = [](Operation *op) {
+    return isa<triton::DotOp, triton::SparseDotOp>(op);
+  };
   SetVector<Operation *> slices;
-  mlir::getForwardSlice(dotOp.getResult(), &slices);
-  if (llvm::find_if(slices, [](Operation *op) {
-        return isa<triton::DotOp>(op);
-      }) != slices.end())
+  mlir::getForwardSlice(dotOp->getResult(0), &slices);
+  if (llvm::any_of(slices, isDot))
+    return {(unsigned)numWarps, 1};
+  SetVector<Operation *> aSlices;
+  mlir::getBackwardSlice(dotOp->getOperand(0), &aSlices, [&](Operation *op) {
+    return op->getBlock() == dotOp->getBlock();
+  });
+  if (llvm::any_of(aSlices, isDot))
     return {(unsigned)numWarps, 1};
 
   SmallVector<unsigned, 2> ret = {1, 1};
@@ -75,6 +85,33 @@ SmallVector<unsigned, 2> warpsPerTileV2(triton::DotOp dotOp,
   return ret;
 }
 
+// wgmma reads $b in place when a row of its shared memory tile is one swizzle
+// atom (see getWGMMAOperandB); the other dots use the Ampere instructions.
+bool supportWGMMA(triton::DotOp dotOp, int numWarps) {
+  auto aType = dotOp.getA().getType().cast<RankedTensorType>();
+  auto bType = dotOp.getB().getType().cast<RankedTensorType>();
+  auto dType = dotOp.getD().getType().cast<RankedTensorType>();
+  auto elemTy = bType.getElementType();
+  if (!(elemTy.isF16() || elemTy.isBF16()) ||
+      aType.getElementType() != elemTy || !dType.getElementType().isF32())
+    return false;
+  auto bShape = bType.getShape();
+  if (numWarps % 4 != 0 || dType.getShape()[0] % (16 * numWarps) != 0 ||
+      bShape[0] % 16 != 0 || bShape[1] % 8 != 0 || bShape[1] > 256)
+    return false;
+  // The shared memory tile of $b gets the order of the layout it is converted
+  // from
+  SmallVector<unsigned> order;
+  if (auto cvt = dotOp.getB().getDefiningOp<ConvertLayoutOp>())
+    order = triton::gpu::getOrder(
+        cvt.getSrc().getType().cast<RankedTensorType>().getEncoding());
+  else
+    order = triton::gpu::getOrder(
+        bType.getEncoding().cast<DotOperandEncodingAttr>().getParent());
+  unsigned rowBytes = bShape[order[0]] * elemTy.getIntOrFloatBitWidth() / 8;
+  return rowBytes == 32 || rowBytes == 64 || rowBytes == 128;
+}
+
 class BlockedToMMA : public mlir::RewritePattern {
   int computeCapability;
   mutable int mmaV1Counter{}; // used to generate ID for MMAv1 encoding
@@ -105,6 +142,8 @@ public:
     auto retShape = oldRetType.getShape();
     auto mod = op->getParentOfType<mlir::ModuleOp>();
     int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
+    if (versionMajor == 3 && !supportWGMMA(dotOp, numWarps))
+      versionMajor = 2;
 
     // operands
     Value a = dotOp.getA();
@@ -149,8 +188,14 @@ public:
       mmaEnc = triton::gpu::MmaEncodingAttr::get(
           oldRetType.getContext(), versionMajor, 0 /*versionMinor*/,
           warpsPerTile);
+    } else if (versionMajor == 3) {
+      // The warpgroups are stacked along M and each computes the whole N
+      SmallVector<unsigned, 2> warpsPerTile = {(unsigned)numWarps, 1};
+      mmaEnc = triton::gpu::MmaEncodingAttr::get(
+          oldRetType.getContext(), versionMajor, 0 /*versionMinor*/,
+          warpsPerTile);
     } else {
-      llvm_unreachable("Mma layout only supports versionMajor in {1, 2}");
+      llvm_unreachable("Mma layout only supports versionMajor in {1, 2, 3}");
     }
     auto newRetType =
         RankedTensorType::get(retShape, oldRetType.getElementType(), mmaEnc);
@@ -192,6 +237,55 @@ public:
     return success();
   }
 };
+
+// The sparse dots are lowered to mma.sp, which only has the layouts of MMA v2:
+// $a and $b are dot operands of it and the metadata stays in shared memory.
+class SparseBlockedToMMA : public mlir::RewritePattern {
+public:
+  SparseBlockedToMMA(mlir::MLIRContext *context)
+      : mlir::RewritePattern(triton::SparseDotOp::getOperationName(), 2,
+                             context) {}
+
+  mlir::LogicalResult
+  matchAndRewrite(mlir::Operation *op,
+                  mlir::PatternRewriter &rewriter) const override {
+    auto dotOp = cast<triton::SparseDotOp>(op);
+    auto oldRetType = dotOp.getResult().getType().cast<RankedTensorType>();
+    if (!oldRetType.getEncoding() ||
+        oldRetType.getEncoding().isa<triton::gpu::MmaEncodingAttr>())
+      return failure();
+
+    auto retShape = oldRetType.getShape();
+    auto mod = op->getParentOfType<mlir::ModuleOp>();
+    int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
+    auto mmaEnc = triton::gpu::MmaEncodingAttr::get(
+        oldRetType.getContext(), 2, 0 /*versionMinor*/,
+        warpsPerTileV2(op, retShape, numWarps));
+    auto newRetType =
+        RankedTensorType::get(retShape, oldRetType.getElementType(), mmaEnc);
+
+    auto convertOperand = [&](Value v, unsigned opIdx) -> Value {
+      auto oldType = v.getType().cast<RankedTensorType>();
+      auto encoding = triton::gpu::DotOperandEncodingAttr::get(
+          oldType.getContext(), opIdx, mmaEnc, oldType.getElementType());
+      auto newType = RankedTensorType::get(
+          oldType.getShape(), oldType.getElementType(), encoding);
+      return rewriter.create<triton::gpu::ConvertLayoutOp>(v.getLoc(), newType,
+                                                           v);
+    };
+    Value oldAcc = dotOp.getC();
+    Value newAcc = rewriter.create<triton::gpu::ConvertLayoutOp>(
+        oldAcc.getLoc(), newRetType, oldAcc);
+    Value a = convertOperand(dotOp.getA(), 0);
+    Value b = convertOperand(dotOp.getB(), 1);
+    auto newDot = rewriter.create<triton::SparseDotOp>(
+        dotOp.getLoc(), newRetType, a, b, newAcc, dotOp.getAMeta());
+
+    rewriter.replaceOpWithNewOp<triton::gpu::ConvertLayoutOp>(
+        op, oldRetType, newDot.getResult());
+    return success();
+  }
+};
 } // namespace
 
 #define GEN_PASS_CLASSES
@@ -208,8 +302,21 @@ public:
     MLIRContext *context = &getContext();
     ModuleOp m = getOperation();
 
+    // mma.sp is available from Ampere on
+    if (computeCapability < 80) {
+      WalkResult result = m.walk([&](triton::SparseDotOp dotOp) {
+        dotOp.emitError() << "sparse dots need compute capability 80 or "
+                             "more, but got "
+                          << computeCapability;
+        return WalkResult::interrupt();
+      });
+      if (result.wasInterrupted())
+        return signalPassFailure();
+    }
+
     mlir::RewritePatternSet patterns(context);
     patterns.add<::BlockedToMMA>(context, computeCapability);
+    patterns.add<::SparseBlockedToMMA>(context);
     if (applyPatternsAndFoldGreedily(m, std::move(patterns)).failed()) {
       signalPassFailure();
     }
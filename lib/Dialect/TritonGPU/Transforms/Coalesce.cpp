@@ -23,7 +23,8 @@ typedef DenseMap<Value, std::function<Type(Type)>> LayoutMap;
 
 struct CoalescePass : public TritonGPUCoalesceBase<CoalescePass> {
   Attribute getCoalescedEncoding(ModuleAxisInfoAnalysis &axisInfoAnalysis,
-                                 Value ptr, int numWarps) {
+                                 Value ptr, int numWarps,
+                                 int threadsPerWarp) {
     auto origType = ptr.getType().cast<RankedTensorType>();
     // Get the shape of the tensor.
     size_t rank = origType.getRank();
@@ -46,7 +47,7 @@ struct CoalescePass : public TritonGPUCoalesceBase<CoalescePass> {
         }
       }
     int numElems = product(origType.getShape());
-    int numThreads = numWarps * 32;
+    int numThreads = numWarps * threadsPerWarp;
     int numElemsPerThread = std::max(numElems / numThreads, 1);
     // Thread tile size depends on memory alignment
     SmallVector<unsigned, 4> sizePerThread(rank, 1);
@@ -68,14 +69,77 @@ struct CoalescePass : public TritonGPUCoalesceBase<CoalescePass> {
     std::iota(dims.begin(), dims.end(), 0);
     // create encoding
     Attribute encoding = triton::gpu::BlockedEncodingAttr::get(
-        &getContext(), origType.getShape(), sizePerThread, order, numWarps);
+        &getContext(), origType.getShape(), sizePerThread, order, numWarps,
+        threadsPerWarp);
     return encoding;
   }
 
-  std::function<Type(Type)>
-  getTypeConverter(ModuleAxisInfoAnalysis &axisInfoAnalysis, Value ptr,
-                   int numWarps) {
-    Attribute encoding = getCoalescedEncoding(axisInfoAnalysis, ptr, numWarps);
+  // Block pointers have no layout: the accessed block is distributed along
+  // the contiguous dimension of its `tt.make_tensor_ptr`, whose strides are
+  // known without looking at the addresses of the elements.
+  Attribute getTensorPtrEncoding(ModuleAxisInfoAnalysis &axisInfoAnalysis,
+                                 Value ptr,
+                                 std::optional<ArrayRef<int32_t>> boundaryCheck,
+                                 int numWarps, int threadsPerWarp) {
+    auto blockType =
+        triton::getPointeeType(ptr.getType()).cast<RankedTensorType>();
+    size_t rank = blockType.getRank();
+    SmallVector<unsigned, 4> order(rank);
+    std::iota(order.rbegin(), order.rend(), 0);
+    if (auto makeTensorPtr = getMakeTensorPtrOp(ptr))
+      order.assign(makeTensorPtr.getOrder().begin(),
+                   makeTensorPtr.getOrder().end());
+    int numElems = product(blockType.getShape());
+    int numElemsPerThread =
+        std::max(numElems / (numWarps * threadsPerWarp), 1);
+    unsigned elemNumBits = blockType.getElementType().getIntOrFloatBitWidth();
+    unsigned alignment =
+        axisInfoAnalysis.getTensorPtrAlignment(ptr, boundaryCheck);
+    unsigned perThread = std::min(alignment, 128 / elemNumBits);
+    SmallVector<unsigned, 4> sizePerThread(rank, 1);
+    sizePerThread[order[0]] = std::min<int>(perThread, numElemsPerThread);
+    return triton::gpu::BlockedEncodingAttr::get(
+        &getContext(), blockType.getShape(), sizePerThread, order, numWarps,
+        threadsPerWarp);
+  }
+
+  // Stores of MMA accumulators take a conversion to the coalesced layout,
+  // which goes through shared memory. It is not worth it when storing
+  // straight from the MMA layout already writes whole 32B sectors: the quads
+  // of lanes holding the consecutive elements of a row then store with
+  // `st.global.v2` instead of `st.global.v4`, but skip the round trip.
+  Attribute getMmaStoreEncoding(ModuleAxisInfoAnalysis &axisInfoAnalysis,
+                                triton::StoreOp store) {
+    auto cvt = store.getValue().getDefiningOp<triton::gpu::ConvertLayoutOp>();
+    if (!cvt)
+      return {};
+    auto srcType = cvt.getOperand().getType().cast<RankedTensorType>();
+    auto mmaLayout =
+        srcType.getEncoding().dyn_cast<triton::gpu::MmaEncodingAttr>();
+    if (!mmaLayout || !(mmaLayout.isAmpere() || mmaLayout.isHopper()))
+      return {};
+    Value ptr = store.getPtr();
+    auto ptrType = ptr.getType().cast<RankedTensorType>();
+    if (ptrType.getRank() != 2)
+      return {};
+    unsigned elemNumBits = triton::getPointeeBitWidth(ptrType);
+    unsigned elemNumBytes = std::max(elemNumBits / 8, 1u);
+    unsigned vec = triton::gpu::getContigPerThread(mmaLayout)[1];
+    unsigned rowElems = vec * triton::gpu::getThreadsPerWarp(mmaLayout)[1];
+    if (rowElems * elemNumBytes < 32)
+      return {};
+    // The rows of a quad must be contiguous, and the vectors aligned
+    AxisInfo *info = axisInfoAnalysis.getAxisInfo(ptr);
+    if (info->getContiguity(1) < rowElems ||
+        info->getDivisibility(1) < vec * elemNumBytes)
+      return {};
+    if (Value mask = store.getMask())
+      if (axisInfoAnalysis.getMaskAlignment(mask) < vec)
+        return {};
+    return mmaLayout;
+  }
+
+  std::function<Type(Type)> getTypeConverter(Attribute encoding) {
     return [encoding](Type _type) {
       RankedTensorType type = _type.cast<RankedTensorType>();
       return RankedTensorType::get(type.getShape(), type.getElementType(),
@@ -86,26 +150,38 @@ struct CoalescePass : public TritonGPUCoalesceBase<CoalescePass> {
   template <class T>
   void coalesceOp(LayoutMap &layoutMap, Operation *op, Value ptr,
                   OpBuilder builder) {
-    RankedTensorType ty = ptr.getType().template dyn_cast<RankedTensorType>();
-    if (!ty)
+    if (!layoutMap.count(ptr))
       return;
     auto convertType = layoutMap.lookup(ptr);
     // convert operands
     SmallVector<Value, 4> newArgs;
+    bool changed = false;
     for (auto v : op->getOperands()) {
       auto vTy = v.getType().dyn_cast<RankedTensorType>();
-      if (vTy && !vTy.getEncoding().isa<triton::gpu::SharedEncodingAttr>())
-        newArgs.push_back(builder.create<triton::gpu::ConvertLayoutOp>(
-            op->getLoc(), convertType(v.getType()), v));
-      else
+      if (!vTy || vTy.getEncoding().isa<triton::gpu::SharedEncodingAttr>() ||
+          convertType(vTy) == vTy) {
         newArgs.push_back(v);
+        continue;
+      }
+      changed = true;
+      // don't convert back and forth
+      auto cvt = v.getDefiningOp<triton::gpu::ConvertLayoutOp>();
+      if (cvt && cvt.getOperand().getType() == convertType(vTy))
+        newArgs.push_back(cvt.getOperand());
+      else
+        newArgs.push_back(builder.create<triton::gpu::ConvertLayoutOp>(
+            op->getLoc(), convertType(vTy), v));
     }
     // convert output types
     SmallVector<Type, 4> newTypes;
     for (auto t : op->getResultTypes()) {
       bool is_async = std::is_same<T, triton::gpu::InsertSliceAsyncOp>::value;
       newTypes.push_back(is_async ? t : convertType(t));
+      changed |= newTypes.back() != t;
     }
+    // the op is already coalesced
+    if (!changed)
+      return;
     // construct new op with the new encoding
     Operation *newOp =
         builder.create<T>(op->getLoc(), newTypes, newArgs, op->getAttrs());
@@ -131,25 +207,45 @@ struct CoalescePass : public TritonGPUCoalesceBase<CoalescePass> {
     LayoutMap layoutMap;
     moduleOp.walk([&](Operation *curr) {
       Value ptr;
-      if (auto op = dyn_cast<triton::LoadOp>(curr))
+      std::optional<ArrayRef<int32_t>> boundaryCheck;
+      if (auto op = dyn_cast<triton::LoadOp>(curr)) {
         ptr = op.getPtr();
+        boundaryCheck = op.getBoundaryCheck();
+      }
       if (auto op = dyn_cast<triton::AtomicRMWOp>(curr))
         ptr = op.getPtr();
       if (auto op = dyn_cast<triton::AtomicCASOp>(curr))
         ptr = op.getPtr();
-      if (auto op = dyn_cast<triton::gpu::InsertSliceAsyncOp>(curr))
+      if (auto op = dyn_cast<triton::gpu::InsertSliceAsyncOp>(curr)) {
         ptr = op.getSrc();
-      if (auto op = dyn_cast<triton::StoreOp>(curr))
+        boundaryCheck = op.getBoundaryCheck();
+      }
+      if (auto op = dyn_cast<triton::StoreOp>(curr)) {
         ptr = op.getPtr();
+        boundaryCheck = op.getBoundaryCheck();
+      }
       if (!ptr)
         return;
+      auto mod = curr->getParentOfType<ModuleOp>();
+      int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
+      int threadsPerWarp =
+          triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+      if (triton::isTensorPointerType(ptr.getType())) {
+        layoutMap[ptr] = getTypeConverter(getTensorPtrEncoding(
+            axisInfoAnalysis, ptr, boundaryCheck, numWarps, threadsPerWarp));
+        return;
+      }
       RankedTensorType ty = ptr.getType().template dyn_cast<RankedTensorType>();
       if (!ty || !ty.getElementType().isa<PointerType>())
         return;
-      auto mod = curr->getParentOfType<ModuleOp>();
-      int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
-      auto convertType = getTypeConverter(axisInfoAnalysis, ptr, numWarps);
-      layoutMap[ptr] = convertType;
+      if (auto store = dyn_cast<triton::StoreOp>(curr))
+        if (Attribute encoding = getMmaStoreEncoding(axisInfoAnalysis, store)) {
+          layoutMap[ptr] = getTypeConverter(encoding);
+          return;
+        }
+      layoutMap[ptr] = getTypeConverter(
+          getCoalescedEncoding(axisInfoAnalysis, ptr, numWarps,
+                               threadsPerWarp));
     });
 
     // For each memory op that has a layout L1:
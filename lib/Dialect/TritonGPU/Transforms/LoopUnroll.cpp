@@ -0,0 +1,159 @@
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/Pass/Pass.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+//===----------------------------------------------------------------------===//
+//
+// This file implements the unrolling of the scf.for loops that carry a
+// `tt.num_unroll` factor. The unrolled loop runs the body `num_unroll` times
+// per iteration and a remainder loop, marked with `tt.unroll_remainder`, runs
+// the iterations left over when the trip count is not a multiple of the
+// factor.
+//
+// The upstream scf unrolling utility is not used, as it builds the bounds of
+// the unrolled loop with `index` constants, while Triton loops count with
+// integers.
+//
+//===----------------------------------------------------------------------===//
+
+using namespace mlir;
+
+static constexpr char kNumUnrollAttr[] = "tt.num_unroll";
+static constexpr char kUnrollRemainderAttr[] = "tt.unroll_remainder";
+
+static Value intCst(OpBuilder &builder, Location loc, Type type,
+                    int64_t value) {
+  return builder.create<arith::ConstantOp>(loc,
+                                           builder.getIntegerAttr(type, value));
+}
+
+// Emits `factor` copies of the body of `forOp` for the induction variable
+// values `iv`, `iv + step`, ..., `iv + (factor - 1) * step`, and returns the
+// values yielded by the last copy.
+static SmallVector<Value> cloneBody(OpBuilder &builder, scf::ForOp forOp,
+                                    Value iv, ValueRange iterArgs,
+                                    int64_t factor) {
+  Location loc = forOp.getLoc();
+  Type type = iv.getType();
+  std::optional<int64_t> step = getConstantIntValue(forOp.getStep());
+  auto yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
+  SmallVector<Value> args(iterArgs.begin(), iterArgs.end());
+  for (int64_t i = 0; i < factor; ++i) {
+    Value ivI = iv;
+    if (i > 0) {
+      Value offset =
+          step ? intCst(builder, loc, type, i * *step)
+               : builder.create<arith::MulIOp>(loc, forOp.getStep(),
+                                               intCst(builder, loc, type, i));
+      ivI = builder.create<arith::AddIOp>(loc, iv, offset);
+    }
+    IRMapping mapping;
+    mapping.map(forOp.getInductionVar(), ivI);
+    for (unsigned j = 0; j < args.size(); ++j)
+      mapping.map(forOp.getRegionIterArgs()[j], args[j]);
+    for (Operation &op : forOp.getBody()->without_terminator())
+      builder.clone(op, mapping);
+    for (unsigned j = 0; j < args.size(); ++j)
+      args[j] = mapping.lookupOrDefault(yieldOp.getOperand(j));
+  }
+  return args;
+}
+
+// Replaces `forOp` by a loop whose iterations each run `factor` iterations
+// of `forOp`, followed by a remainder loop running the iterations left over.
+static void unrollLoop(scf::ForOp forOp, int64_t factor) {
+  OpBuilder builder(forOp);
+  Location loc = forOp.getLoc();
+  Value lb = forOp.getLowerBound();
+  Value ub = forOp.getUpperBound();
+  Value step = forOp.getStep();
+  Type type = lb.getType();
+  std::optional<int64_t> lbCst = getConstantIntValue(lb);
+  std::optional<int64_t> ubCst = getConstantIntValue(ub);
+  std::optional<int64_t> stepCst = getConstantIntValue(step);
+
+  // the unrolled loop stops at lb + (tripCount - tripCount % factor) * step
+  Value ubUnrolled;
+  Value stepUnrolled;
+  bool hasRemainder = true;
+  if (lbCst && ubCst && stepCst && *stepCst > 0) {
+    int64_t tripCount =
+        *ubCst > *lbCst ? llvm::divideCeil(*ubCst - *lbCst, *stepCst) : 0;
+    int64_t unrolled = tripCount - tripCount % factor;
+    // the loop runs fewer iterations than the factor: it is all remainder
+    if (unrolled == 0) {
+      forOp->setAttr(kUnrollRemainderAttr, builder.getUnitAttr());
+      return;
+    }
+    hasRemainder = unrolled != tripCount;
+    ubUnrolled = intCst(builder, loc, type, *lbCst + unrolled * *stepCst);
+    stepUnrolled = intCst(builder, loc, type, *stepCst * factor);
+  } else {
+    Value one = intCst(builder, loc, type, 1);
+    Value factorVal = intCst(builder, loc, type, factor);
+    Value diff = builder.create<arith::SubIOp>(loc, ub, lb);
+    Value stepMinusOne = builder.create<arith::SubIOp>(loc, step, one);
+    Value tripCount = builder.create<arith::DivSIOp>(
+        loc, builder.create<arith::AddIOp>(loc, diff, stepMinusOne), step);
+    Value rem = builder.create<arith::RemSIOp>(loc, tripCount, factorVal);
+    Value unrolled = builder.create<arith::SubIOp>(loc, tripCount, rem);
+    ubUnrolled = builder.create<arith::AddIOp>(
+        loc, lb, builder.create<arith::MulIOp>(loc, unrolled, step));
+    stepUnrolled = builder.create<arith::MulIOp>(loc, step, factorVal);
+  }
+
+  auto buildBody = [&](int64_t copies) {
+    return [&forOp, copies](OpBuilder &b, Location loc, Value iv,
+                            ValueRange args) {
+      b.create<scf::YieldOp>(loc, cloneBody(b, forOp, iv, args, copies));
+    };
+  };
+  auto unrolledLoop =
+      builder.create<scf::ForOp>(loc, lb, ubUnrolled, stepUnrolled,
+                                 forOp.getInitArgs(), buildBody(factor));
+  unrolledLoop->setAttrs(forOp->getAttrs());
+  ValueRange results = unrolledLoop.getResults();
+  if (hasRemainder) {
+    auto remainderLoop = builder.create<scf::ForOp>(
+        loc, ubUnrolled, ub, step, unrolledLoop.getResults(), buildBody(1));
+    remainderLoop->setAttrs(forOp->getAttrs());
+    remainderLoop->setAttr(kUnrollRemainderAttr, builder.getUnitAttr());
+    results = remainderLoop.getResults();
+  }
+  forOp->replaceAllUsesWith(results);
+  forOp->erase();
+}
+
+class TritonGPULoopUnrollPass
+    : public TritonGPULoopUnrollBase<TritonGPULoopUnrollPass> {
+public:
+  TritonGPULoopUnrollPass() = default;
+
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    // the walk is post-order: nested loops are unrolled before the loops
+    // whose unrolling clones them
+    SmallVector<scf::ForOp> loops;
+    mod.walk([&](scf::ForOp forOp) {
+      if (forOp->hasAttr(kNumUnrollAttr))
+        loops.push_back(forOp);
+    });
+    for (scf::ForOp forOp : loops) {
+      auto factorAttr = forOp->getAttrOfType<IntegerAttr>(kNumUnrollAttr);
+      forOp->removeAttr(kNumUnrollAttr);
+      int64_t factor = factorAttr ? factorAttr.getInt() : 1;
+      if (factor > 1)
+        unrollLoop(forOp, factor);
+    }
+  }
+};
+
+std::unique_ptr<Pass> mlir::createTritonGPULoopUnrollPass() {
+  return std::make_unique<TritonGPULoopUnrollPass>();
+}
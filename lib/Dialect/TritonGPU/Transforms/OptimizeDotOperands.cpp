@@ -47,8 +47,12 @@ public:
     auto ZType = dstOp.getResult().getType().cast<RankedTensorType>();
     // encodings
     auto argEncoding = argType.getEncoding();
+    // The transposition of registers, in a blocked layout, is not a view of
+    // shared memory that can be reordered
     auto XEncoding =
-        XType.getEncoding().cast<triton::gpu::SharedEncodingAttr>();
+        XType.getEncoding().dyn_cast<triton::gpu::SharedEncodingAttr>();
+    if (!XEncoding)
+      return mlir::failure();
     auto ZEncoding =
         ZType.getEncoding().dyn_cast<triton::gpu::DotOperandEncodingAttr>();
     if (!ZEncoding)
@@ -0,0 +1,225 @@
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Pass/Pass.h"
+#include "triton/Analysis/Allocation.h"
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+//===----------------------------------------------------------------------===//
+//
+// This file implements a lint of the TritonGPU IR, which emits optimization
+// remarks on the patterns that usually cost performance. The remarks are
+// attached to the locations of the ops, i.e. to the source lines of the
+// kernel when the IR comes from the JIT:
+//   - the loads and stores of tensors of pointers whose accesses are
+//     narrower than their layout allows, according to the axis info;
+//   - the layout conversions through shared memory left inside loops, with
+//     their size from the allocation analysis;
+//   - the loops with a dot whose operand loads were not pipelined, with the
+//     reasons of the candidate checks of the pipeliner.
+//
+//===----------------------------------------------------------------------===//
+
+using namespace mlir;
+namespace ttg = triton::gpu;
+
+static constexpr char kUnrollRemainderAttr[] = "tt.unroll_remainder";
+
+// Remarks on the load or store `op` of the tensor of pointers `ptr` if its
+// accesses are narrower than 128 bits while each thread holds more
+// elements.
+static void lintAccess(Operation *op, Value ptr, Value mask,
+                       ModuleAxisInfoAnalysis &axisInfoAnalysis) {
+  auto tensorTy = ptr.getType().dyn_cast<RankedTensorType>();
+  if (!tensorTy ||
+      !tensorTy.getEncoding().isa_and_nonnull<ttg::BlockedEncodingAttr>())
+    return;
+  unsigned elemBits = triton::getPointeeBitWidth(tensorTy);
+  unsigned maxVec = std::min(std::max(128 / elemBits, 1u),
+                             ttg::getTotalElemsPerThread(tensorTy));
+  unsigned vec = axisInfoAnalysis.getPtrContiguity(ptr);
+  unsigned maskAlignment = mask ? axisInfoAnalysis.getMaskAlignment(mask) : 0;
+  if (mask)
+    vec = std::min(vec, maskAlignment);
+  if (vec >= maxVec)
+    return;
+
+  unsigned dim = ttg::getOrder(tensorTy.getEncoding())[0];
+  AxisInfo *axisInfo = axisInfoAnalysis.getAxisInfo(ptr);
+  auto diag = op->emitRemark()
+              << op->getName().stripDialect() << " is not "
+              << (vec == 1 ? "vectorized: " : "fully vectorized: ")
+              << vec * elemBits << "-bit accesses instead of "
+              << maxVec * elemBits << " bits";
+  if (axisInfo)
+    diag << ", as the pointers have contiguity="
+         << axisInfo->getContiguity(dim)
+         << " and divisibility=" << axisInfo->getDivisibility(dim)
+         << " along dim " << dim;
+  if (mask && maskAlignment < maxVec)
+    diag << ", and the mask is constant over " << maskAlignment
+         << " elements";
+}
+
+// Returns the number of bytes of shared memory that the conversion `cvt`
+// goes through, or 0.
+static size_t getSharedMemoryBytes(ttg::ConvertLayoutOp cvt,
+                                   Allocation *allocation) {
+  if (!allocation)
+    return 0;
+  auto bufferId = allocation->getBufferId(cvt.getOperation());
+  if (bufferId == Allocation::InvalidBufferId)
+    bufferId = allocation->getBufferId(cvt.getResult());
+  if (bufferId == Allocation::InvalidBufferId ||
+      allocation->isVirtualBuffer(bufferId))
+    return 0;
+  return allocation->getAllocatedSize(bufferId);
+}
+
+// Remarks on the layout conversions of the body of `forOp`, outside of its
+// nested loops, that go through shared memory.
+static void lintConversions(scf::ForOp forOp, ModuleAllocation &allocation) {
+  auto funcOp = forOp->getParentOfType<FunctionOpInterface>();
+  Allocation *funcAllocation = allocation.getFuncData(funcOp);
+  SmallVector<std::pair<ttg::ConvertLayoutOp, size_t>> cvts;
+  size_t maxBytes = 0;
+  forOp.getBody()->walk([&](ttg::ConvertLayoutOp cvt) {
+    if (cvt->getParentOfType<scf::ForOp>() != forOp)
+      return;
+    // the conversions of the dot operands from shared memory read the
+    // buffers of the conversions to shared memory
+    if (cvt.getSrc()
+            .getType()
+            .cast<RankedTensorType>()
+            .getEncoding()
+            .isa<ttg::SharedEncodingAttr>())
+      return;
+    if (size_t bytes = getSharedMemoryBytes(cvt, funcAllocation)) {
+      cvts.push_back({cvt, bytes});
+      maxBytes = std::max(maxBytes, bytes);
+    }
+  });
+  if (cvts.empty())
+    return;
+  auto diag = forOp.emitRemark()
+              << cvts.size()
+              << (cvts.size() > 1 ? " layout conversions inside the loop go"
+                                  : " layout conversion inside the loop goes")
+              << " through shared memory, " << maxBytes
+              << " bytes at most each";
+  for (auto [cvt, bytes] : cvts)
+    diag.attachNote(cvt.getLoc())
+        << "conversion through " << bytes << " bytes of shared memory";
+}
+
+// Returns why the pipeliner does not pipeline `loadOp`, following the checks
+// of LoopPipeliner::initialize, or an empty string if it is a candidate.
+static std::string getNotPipelinedReason(
+    triton::LoadOp loadOp, ModuleAxisInfoAnalysis &axisInfoAnalysis) {
+  if (loadOp.getSem() || loadOp.getScope())
+    return "the load is ordered by its memory semantics";
+  Value ptr = loadOp.getPtr();
+  unsigned vec = axisInfoAnalysis.getPtrContiguity(ptr);
+  if (triton::isTensorPointerType(ptr.getType())) {
+    if (loadOp.getPadding() == triton::PaddingOption::PAD_NAN)
+      return "the load pads with NaNs";
+    vec = axisInfoAnalysis.getTensorPtrContiguity(
+        ptr, loadOp.getType().cast<RankedTensorType>(),
+        loadOp.getBoundaryCheck());
+  }
+  if (Value mask = loadOp.getMask())
+    vec = std::min<unsigned>(vec, axisInfoAnalysis.getMaskAlignment(mask));
+  auto tensorTy = loadOp.getType().cast<RankedTensorType>();
+  unsigned width = vec * tensorTy.getElementType().getIntOrFloatBitWidth();
+  if (width < 32)
+    return "its accesses are " + std::to_string(width) +
+           "-bit wide, asynchronous copies need 32 bits or more";
+
+  // the result reaches a conversion to a dot operand through single uses
+  Value result = loadOp.getResult();
+  while (result.hasOneUse()) {
+    Operation *use = *result.getUsers().begin();
+    if (auto cvt = dyn_cast<ttg::ConvertLayoutOp>(use))
+      if (cvt.getType()
+              .cast<RankedTensorType>()
+              .getEncoding()
+              .isa<ttg::DotOperandEncodingAttr>())
+        return "";
+    if (use->getNumResults() != 1)
+      break;
+    auto useTy = use->getResult(0).getType().dyn_cast<RankedTensorType>();
+    if (!useTy || !useTy.getEncoding().isa<ttg::SharedEncodingAttr>())
+      break;
+    result = use->getResult(0);
+  }
+  return "its result is not only converted to a dot operand";
+}
+
+struct PerfLintPass : public TritonGPUPerfLintBase<PerfLintPass> {
+  PerfLintPass() = default;
+  PerfLintPass(int numStages) { this->numStages = numStages; }
+
+  // Remarks on `forOp` if it computes a dot but none of its loads were
+  // pipelined.
+  void lintPipelining(scf::ForOp forOp,
+                      ModuleAxisInfoAnalysis &axisInfoAnalysis) {
+    Block *body = forOp.getBody();
+    if (llvm::none_of(*body,
+                      [](Operation &op) { return isa<triton::DotOp>(op); }))
+      return;
+    // pipelined loops copy their loads asynchronously
+    if (llvm::any_of(*body, [](Operation &op) {
+          return isa<ttg::InsertSliceAsyncOp, ttg::AsyncWaitOp>(op);
+        }))
+      return;
+    SmallVector<triton::LoadOp> loads;
+    for (Operation &op : *body)
+      if (auto loadOp = dyn_cast<triton::LoadOp>(op)) {
+        auto tensorTy = loadOp.getType().dyn_cast<RankedTensorType>();
+        if (tensorTy && tensorTy.getRank() >= 2)
+          loads.push_back(loadOp);
+      }
+    if (loads.empty())
+      return;
+
+    auto diag = forOp.emitRemark() << "pipelining skipped: ";
+    if (numStages <= 1) {
+      diag << "num_stages is " << numStages;
+      return;
+    }
+    if (forOp->hasAttr(kUnrollRemainderAttr)) {
+      diag << "the loop is the remainder of an unrolled loop";
+      return;
+    }
+    diag << "none of the " << loads.size() << " loads can be pipelined";
+    for (triton::LoadOp loadOp : loads) {
+      std::string reason = getNotPipelinedReason(loadOp, axisInfoAnalysis);
+      if (reason.empty())
+        reason = "it depends on another load of a dot operand";
+      diag.attachNote(loadOp.getLoc()) << "load not pipelined: " << reason;
+    }
+  }
+
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    ModuleAxisInfoAnalysis axisInfoAnalysis(mod);
+    ModuleAllocation allocation(mod);
+
+    mod.walk([&](Operation *op) {
+      if (auto loadOp = dyn_cast<triton::LoadOp>(op))
+        lintAccess(op, loadOp.getPtr(), loadOp.getMask(), axisInfoAnalysis);
+      else if (auto storeOp = dyn_cast<triton::StoreOp>(op))
+        lintAccess(op, storeOp.getPtr(), storeOp.getMask(), axisInfoAnalysis);
+    });
+    mod.walk([&](scf::ForOp forOp) {
+      lintConversions(forOp, allocation);
+      lintPipelining(forOp, axisInfoAnalysis);
+    });
+  }
+};
+
+std::unique_ptr<Pass> mlir::createTritonGPUPerfLintPass(int numStages) {
+  return std::make_unique<PerfLintPass>(numStages);
+}
@@ -1,6 +1,7 @@
 #include "Utility.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/IR/IRMapping.h"
+#include "mlir/IR/Matchers.h"
 #include "mlir/IR/TypeUtilities.h"
 #include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
@@ -32,6 +33,29 @@ static void addNamedAttrs(Operation *op, DictionaryAttr dictAttrs) {
 
 #define int_attr(num) builder.getI64IntegerAttr(num)
 
+// mask of a load issued at an iteration that may be out of the loop
+static Value getLoadMask(triton::LoadOp loadOp, Value mappedMask,
+                         Value loopCond, OpBuilder &builder) {
+  Type maskType = triton::getI1SameShape(loadOp.getType());
+  Value mask = loadOp.getMask();
+  Value newMask;
+  if (mask) {
+    Value cond = loopCond;
+    if (isa<RankedTensorType>(maskType)) {
+      cond = builder.create<triton::SplatOp>(mask.getLoc(), maskType, loopCond);
+    }
+    newMask = builder.create<arith::AndIOp>(mask.getLoc(), mappedMask, cond);
+  } else {
+    if (isa<RankedTensorType>(maskType)) {
+      newMask = builder.create<triton::SplatOp>(loopCond.getLoc(), maskType,
+                                                loopCond);
+    } else {
+      newMask = loopCond;
+    }
+  }
+  return newMask;
+}
+
 namespace {
 
 class LoopPipeliner {
@@ -92,6 +116,16 @@ class LoopPipeliner {
   /// Operations (inside the loop body) that loads depend on
   SetVector<Operation *> depOps;
 
+  /// Loads (inside the loop body) that the addresses of the pipelined loads
+  /// depend on, e.g. the indices of a gather. They are prefetched one
+  /// iteration ahead into loop-carried values instead of being reissued right
+  /// before the async copies that need them.
+  SetVector<Value> indexLoads;
+  /// index load => ops (inside the loop body) that its operands depend on
+  DenseMap<Value, SmallVector<Operation *>> indexLoadDeps;
+  /// index load => value at the first iteration of the new loop
+  DenseMap<Value, Value> indexLoadsNext;
+
   /// collect values that v depends on and are defined inside the loop
   void collectDeps(Value v, int stages, SetVector<Value> &deps);
 
@@ -99,8 +133,15 @@ class LoopPipeliner {
 
   Value lookupOrDefault(Value origin, int stage);
 
-  Value getLoadMask(triton::LoadOp loadOp, Value mappedMask, Value loopCond,
-                    OpBuilder &builder);
+  /// collect the ops the operands of an index load depend on. Fails if the
+  /// load cannot be issued one iteration ahead
+  LogicalResult collectIndexLoadDeps(triton::LoadOp loadOp,
+                                     SmallVector<Operation *> &deps);
+
+  /// emit an index load of iteration `iv`, `mapping` holds the values of the
+  /// block arguments at that iteration
+  Value emitIndexLoad(triton::LoadOp loadOp, IRMapping &mapping, Value iv,
+                      OpBuilder &builder);
 
   /// Returns a empty buffer of size <numStages, ...>
   ttg::AllocTensorOp allocateEmptyBuffer(Operation *op, OpBuilder &builder);
@@ -180,7 +221,9 @@ ttg::AllocTensorOp LoopPipeliner::allocateEmptyBuffer(Operation *op,
 }
 
 /// A load instruction can be pipelined if:
-///   - the load doesn't depend on any other loads (after loop peeling)
+///   - the load doesn't depend on any other pipelined loads (after loop
+///     peeling). The loads it depends on are index loads if their own
+///     addresses don't depend on other loads.
 ///   - (?) this load is not a loop-invariant value (we should run LICM before
 ///                                                  this pass?)
 LogicalResult LoopPipeliner::initialize() {
@@ -192,19 +235,32 @@ LogicalResult LoopPipeliner::initialize() {
   SmallVector<triton::LoadOp, 2> validLoads;
   for (Operation &op : *loop)
     if (auto loadOp = dyn_cast<triton::LoadOp>(&op)) {
+      // an asynchronous copy would not order the load
+      if (loadOp.getSem() || loadOp.getScope())
+        continue;
       auto ptr = loadOp.getPtr();
+      // cp.async only copies from the global memory
+      if (triton::isParamPointerType(ptr.getType()))
+        continue;
       unsigned vec = axisInfoAnalysis.getPtrContiguity(ptr);
+      // The copy of a block pointer fills the out-of-bounds elements with
+      // zeros
+      if (triton::isTensorPointerType(ptr.getType())) {
+        if (loadOp.getPadding() == triton::PaddingOption::PAD_NAN)
+          continue;
+        vec = axisInfoAnalysis.getTensorPtrContiguity(
+            ptr, loadOp.getType().cast<RankedTensorType>(),
+            loadOp.getBoundaryCheck());
+      }
 
       if (auto mask = loadOp.getMask())
         vec = std::min<unsigned>(vec, axisInfoAnalysis.getMaskAlignment(mask));
 
-      auto tensorTy = ptr.getType().dyn_cast<RankedTensorType>();
+      auto tensorTy =
+          triton::getPointeeType(ptr.getType()).dyn_cast<RankedTensorType>();
       if (!tensorTy || tensorTy.getRank() < 2)
         continue;
-      auto ty = tensorTy.getElementType()
-                    .cast<triton::PointerType>()
-                    .getPointeeType();
-      unsigned width = vec * ty.getIntOrFloatBitWidth();
+      unsigned width = vec * tensorTy.getElementType().getIntOrFloatBitWidth();
       // cp.async's cp-size can only be 4, 8 and 16.
       if (width >= 32)
         validLoads.push_back(loadOp);
@@ -223,23 +279,11 @@ LogicalResult LoopPipeliner::initialize() {
     loadDeps[loadOp] = deps;
   }
 
-  // Don't pipeline valid loads that depend on other valid loads
-  // (Because if a valid load depends on another valid load, this load needs to
-  // wait on the other load in the prologue, which is against the point of the
-  // pipeline pass)
+  // We only pipeline loads that have one covert_layout (to dot_op) use
+  // TODO: lift this constraint in the future
+  DenseMap<Value, Value> dotOperandCvts;
   for (triton::LoadOp loadOp : validLoads) {
-    bool isCandidate = true;
-    for (triton::LoadOp other : validLoads) {
-      if (loadDeps[loadOp].contains(other)) {
-        isCandidate = false;
-        break;
-      }
-    }
-
-    // We only pipeline loads that have one covert_layout (to dot_op) use
-    // TODO: lift this constraint in the future
-    if (isCandidate && loadOp.getResult().hasOneUse()) {
-      isCandidate = false;
+    if (loadOp.getResult().hasOneUse()) {
       Operation *use = *loadOp.getResult().getUsers().begin();
 
       // advance to the first conversion as long
@@ -266,15 +310,26 @@ LogicalResult LoopPipeliner::initialize() {
           tensorType.getEncoding().dyn_cast<ttg::DotOperandEncodingAttr>();
       if (!dotOpEnc)
         continue;
-      isCandidate = true;
-      loadsMapping[loadOp] = convertLayout;
+      dotOperandCvts[loadOp] = convertLayout;
     }
+  }
 
-    else
-      isCandidate = false;
-
-    if (isCandidate)
+  // Don't pipeline loads that depend on other pipelined loads
+  // (Because if a pipelined load depends on another pipelined load, this load
+  // needs to wait on the other load in the prologue, which is against the
+  // point of the pipeline pass). The other loads they depend on, e.g. the
+  // indices of a gather, become index loads.
+  for (triton::LoadOp loadOp : validLoads) {
+    auto it = dotOperandCvts.find(loadOp);
+    if (it == dotOperandCvts.end())
+      continue;
+    bool isCandidate = llvm::none_of(validLoads, [&](triton::LoadOp other) {
+      return dotOperandCvts.count(other) && loadDeps[loadOp].contains(other);
+    });
+    if (isCandidate) {
+      loadsMapping[loadOp] = it->second;
       loads.insert(loadOp);
+    }
   }
 
   // we need to find the smallest ocmmon dtype
@@ -328,6 +383,21 @@ LogicalResult LoopPipeliner::initialize() {
           depOps.insert(dep.getDefiningOp());
       }
     }
+
+    for (Operation &op : *loop) {
+      auto loadOp = dyn_cast<triton::LoadOp>(&op);
+      if (!loadOp || !depOps.contains(loadOp) || loadOp.getIsVolatile() ||
+          loadOp.getSem() || loadOp.getScope())
+        continue;
+      // The loop-carried loads are reissued along with their users
+      if (llvm::is_contained(yieldOp->getOperands(), loadOp.getResult()))
+        continue;
+      SmallVector<Operation *> deps;
+      if (failed(collectIndexLoadDeps(loadOp, deps)))
+        continue;
+      indexLoads.insert(loadOp);
+      indexLoadDeps[loadOp] = deps;
+    }
     return success();
   }
 
@@ -341,26 +411,55 @@ LogicalResult LoopPipeliner::initialize() {
   return failure();
 }
 
-Value LoopPipeliner::getLoadMask(triton::LoadOp loadOp, Value mappedMask,
-                                 Value loopCond, OpBuilder &builder) {
-  Type maskType = triton::getI1SameShape(loadOp.getType());
-  Value mask = loadOp.getMask();
-  Value newMask;
-  if (mask) {
-    Value cond = loopCond;
-    if (isa<RankedTensorType>(maskType)) {
-      cond = builder.create<triton::SplatOp>(mask.getLoc(), maskType, loopCond);
-    }
-    newMask = builder.create<arith::AndIOp>(mask.getLoc(), mappedMask, cond);
-  } else {
-    if (isa<RankedTensorType>(maskType)) {
-      newMask = builder.create<triton::SplatOp>(loopCond.getLoc(), maskType,
-                                                loopCond);
-    } else {
-      newMask = loopCond;
+LogicalResult
+LoopPipeliner::collectIndexLoadDeps(triton::LoadOp loadOp,
+                                    SmallVector<Operation *> &deps) {
+  // The addresses of the next iteration are computed from the block arguments
+  // that are carried at the stage of the prefetched iteration, i.e. the ones
+  // that are not immediate dependencies
+  SetVector<Operation *> ops;
+  SmallVector<Value> worklist(loadOp->getOperands());
+  while (!worklist.empty()) {
+    Value v = worklist.pop_back_val();
+    if (v.getParentRegion() != &forOp.getLoopBody())
+      continue;
+    if (auto arg = v.dyn_cast<BlockArgument>()) {
+      if (arg.getArgNumber() > 0 &&
+          (!depArgs.contains(arg) || immedidateDepArgs.contains(arg)))
+        return failure();
+      continue;
     }
+    // One level only: the addresses must not depend on other loads of the
+    // same iteration
+    Operation *op = v.getDefiningOp();
+    if (op->getNumRegions() > 0 || !isMemoryEffectFree(op))
+      return failure();
+    if (ops.insert(op))
+      worklist.append(op->operand_begin(), op->operand_end());
   }
-  return newMask;
+  for (Operation &op : forOp.getLoopBody().front())
+    if (ops.contains(&op))
+      deps.push_back(&op);
+  return success();
+}
+
+Value LoopPipeliner::emitIndexLoad(triton::LoadOp loadOp, IRMapping &mapping,
+                                   Value iv, OpBuilder &builder) {
+  mapping.map(forOp.getInductionVar(), iv);
+  Value loopCond = builder.create<arith::CmpIOp>(
+      iv.getLoc(), arith::CmpIPredicate::slt, iv, forOp.getUpperBound());
+  for (Operation *op : indexLoadDeps[loadOp])
+    builder.clone(*op, mapping);
+  Value newMask = getLoadMask(loadOp, mapping.lookupOrDefault(loadOp.getMask()),
+                              loopCond, builder);
+  auto newOp = builder.create<triton::LoadOp>(
+      loadOp.getLoc(), loadOp.getResult().getType(),
+      mapping.lookupOrDefault(loadOp.getPtr()), newMask,
+      mapping.lookupOrDefault(loadOp.getOther()), loadOp.getBoundaryCheckAttr(),
+      loadOp.getPaddingAttr(), loadOp.getCache(), loadOp.getEvict(),
+      loadOp.getIsVolatile());
+  addNamedAttrs(newOp, loadOp->getAttrDictionary());
+  return newOp.getResult();
 }
 
 void LoopPipeliner::emitPrologue() {
@@ -412,7 +511,8 @@ void LoopPipeliner::emitPrologue() {
               lookupOrDefault(loadOp.getPtr(), stage),
               loadStageBuffer[loadOp][stage], pipelineIterIdx, newMask,
               lookupOrDefault(loadOp.getOther(), stage), loadOp.getCache(),
-              loadOp.getEvict(), loadOp.getIsVolatile(), /*axis*/ 0);
+              loadOp.getEvict(), loadOp.getIsVolatile(), /*axis*/ 0,
+              loadOp.getBoundaryCheckAttr());
           builder.create<triton::gpu::AsyncCommitGroupOp>(op->getLoc());
           loadStageBuffer[loadOp].push_back(newOp->getResult(0));
         } else
@@ -471,6 +571,20 @@ void LoopPipeliner::emitPrologue() {
         builder.create<arith::ConstantIntOp>(iv.getLoc(), 1, 32));
   } // for (int stage = 0; stage < numStages - 1; ++stage)
 
+  // Index loads of the first iteration of the new loop
+  if (!indexLoads.empty()) {
+    Value nextIV =
+        builder.create<arith::AddIOp>(iv.getLoc(), iv, forOp.getStep());
+    for (Value indexLoad : indexLoads) {
+      IRMapping mapping;
+      for (BlockArgument arg : depArgs)
+        if (!immedidateDepArgs.contains(arg))
+          mapping.map(arg, valueMapping[arg][numStages - 1]);
+      indexLoadsNext[indexLoad] = emitIndexLoad(
+          indexLoad.getDefiningOp<triton::LoadOp>(), mapping, nextIV, builder);
+    }
+  }
+
   // async.wait & extract_slice
   builder.create<ttg::AsyncWaitOp>(loads[0].getLoc(),
                                    loads.size() * (numStages - 2));
@@ -522,6 +636,7 @@ scf::ForOp LoopPipeliner::createNewForOp() {
   //   (iv at stage numStages - 2)
   //   (pipeline iteration index)
   //   (loop iteration index)
+  //   (index load at stage numStages - 1) for each index load
   SmallVector<Value> newLoopArgs;
   // We need this to update operands for yield
   // original block arg => new arg's idx
@@ -550,6 +665,10 @@ scf::ForOp LoopPipeliner::createNewForOp() {
   newLoopArgs.push_back(pipelineIterIdx);
   newLoopArgs.push_back(loopIterIdx);
 
+  size_t indexLoadIdx = newLoopArgs.size();
+  for (Value indexLoad : indexLoads)
+    newLoopArgs.push_back(indexLoadsNext[indexLoad]);
+
   for (size_t i = 0; i < newLoopArgs.size(); ++i)
     assert(newLoopArgs[i]);
 
@@ -641,6 +760,14 @@ scf::ForOp LoopPipeliner::createNewForOp() {
 
   for (Operation *op : orderedDeps)
     if (!loads.contains(op->getResult(0))) {
+      // The index loads of this iteration were issued by the previous one
+      if (indexLoads.contains(op->getResult(0))) {
+        auto it = llvm::find(indexLoads, op->getResult(0));
+        size_t i = std::distance(indexLoads.begin(), it);
+        nextMapping.map(op->getResult(0),
+                        newForOp.getRegionIterArgs()[indexLoadIdx + i]);
+        continue;
+      }
       Operation *nextOp;
       if (auto loadOp = dyn_cast<triton::LoadOp>(op)) {
         auto newMask =
@@ -695,7 +822,8 @@ scf::ForOp LoopPipeliner::createNewForOp() {
           newForOp.getRegionIterArgs()[bufferIdx + nextBuffers.size()],
           insertSliceIndex, newMask,
           nextMapping.lookupOrDefault(loadOp.getOther()), loadOp.getCache(),
-          loadOp.getEvict(), loadOp.getIsVolatile(), /*axis*/ 0);
+          loadOp.getEvict(), loadOp.getIsVolatile(), /*axis*/ 0,
+          loadOp.getBoundaryCheckAttr());
       builder.create<triton::gpu::AsyncCommitGroupOp>(op->getLoc());
       nextBuffers.push_back(insertAsyncOp);
       // ExtractSlice
@@ -733,6 +861,24 @@ scf::ForOp LoopPipeliner::createNewForOp() {
     }
   }
 
+  // Issue the index loads of the next iteration before waiting on the copies
+  SmallVector<Value> nextIndexLoads;
+  if (!indexLoads.empty()) {
+    Value indexIV = builder.create<arith::AddIOp>(nextIV.getLoc(), nextIV,
+                                                  newForOp.getStep());
+    for (Value indexLoad : indexLoads) {
+      IRMapping indexMapping;
+      for (BlockArgument arg : depArgs)
+        if (!immedidateDepArgs.contains(arg)) {
+          auto newArg = newForOp.getRegionIterArgs()[depArgsIdx[arg]];
+          indexMapping.map(arg, depArgsMapping.lookup(newArg));
+        }
+      nextIndexLoads.push_back(
+          emitIndexLoad(indexLoad.getDefiningOp<triton::LoadOp>(),
+                        indexMapping, indexIV, builder));
+    }
+  }
+
   // async.wait & extract_slice
   Operation *asyncWait = builder.create<ttg::AsyncWaitOp>(
       loads[0].getLoc(), loads.size() * (numStages - 2));
@@ -766,6 +912,8 @@ scf::ForOp LoopPipeliner::createNewForOp() {
   yieldValues.push_back(nextIV);
   yieldValues.push_back(pipelineIterIdx);
   yieldValues.push_back(loopIterIdx);
+  for (Value nextIndexLoad : nextIndexLoads)
+    yieldValues.push_back(nextIndexLoad);
 
   builder.setInsertionPointToEnd(newForOp.getBody());
   builder.create<scf::YieldOp>(forOp.getBody()->getTerminator()->getLoc(),
@@ -773,6 +921,247 @@ scf::ForOp LoopPipeliner::createNewForOp() {
   return newForOp;
 }
 
+// Registers per thread that the loads double-buffered in registers may take
+static constexpr unsigned kMaxPrefetchRegisters = 64;
+
+/// Returns true if `v` can be recomputed at the start of an iteration from the
+/// induction variable, the loop-carried values and the loop invariants. With
+/// `isNext`, `v` is taken at the next iteration, i.e. the loop-carried values
+/// are the yielded values of the current one.
+static bool isRecomputable(scf::ForOp forOp, Value v, bool isNext,
+                           unsigned depth = 0) {
+  if (v.getParentRegion() != &forOp.getLoopBody())
+    return true;
+  if (depth > 12)
+    return false;
+  if (auto arg = v.dyn_cast<BlockArgument>()) {
+    if (!isNext || arg.getArgNumber() == 0)
+      return true;
+    Value yielded =
+        forOp.getBody()->getTerminator()->getOperand(arg.getArgNumber() - 1);
+    return isRecomputable(forOp, yielded, /*isNext=*/false, depth + 1);
+  }
+  Operation *op = v.getDefiningOp();
+  if (op->getNumRegions() > 0 || !isMemoryEffectFree(op))
+    return false;
+  return llvm::all_of(op->getOperands(), [&](Value operand) {
+    return isRecomputable(forOp, operand, isNext, depth + 1);
+  });
+}
+
+/// Clones the ops that `v` depends on in the loop body. `mapping` holds the
+/// induction variable and the loop-carried values it is taken at, the
+/// loop-carried values missing from it are the yielded values of `prev`.
+static Value recompute(scf::ForOp forOp, Value v, IRMapping &mapping,
+                       IRMapping *prev, OpBuilder &builder) {
+  if (Value mapped = mapping.lookupOrNull(v))
+    return mapped;
+  if (v.getParentRegion() != &forOp.getLoopBody())
+    return v;
+  if (auto arg = v.dyn_cast<BlockArgument>()) {
+    assert(prev && "Missing loop-carried value");
+    Value yielded =
+        forOp.getBody()->getTerminator()->getOperand(arg.getArgNumber() - 1);
+    Value next = recompute(forOp, yielded, *prev, nullptr, builder);
+    mapping.map(v, next);
+    return next;
+  }
+  Operation *op = v.getDefiningOp();
+  for (Value operand : op->getOperands())
+    recompute(forOp, operand, mapping, prev, builder);
+  builder.clone(*op, mapping);
+  return mapping.lookup(v);
+}
+
+/// Issues `loadOp` at the iteration whose induction variable and
+/// loop-carried values are in `mapping`.
+static Value prefetchLoad(scf::ForOp forOp, triton::LoadOp loadOp,
+                          IRMapping &mapping, IRMapping *prev,
+                          OpBuilder &builder) {
+  Value iv = mapping.lookup(forOp.getInductionVar());
+  Value loopCond = builder.create<arith::CmpIOp>(
+      iv.getLoc(), arith::CmpIPredicate::slt, iv, forOp.getUpperBound());
+  auto get = [&](Value v) {
+    return v ? recompute(forOp, v, mapping, prev, builder) : v;
+  };
+  Value ptr = get(loadOp.getPtr());
+  Value mask = get(loadOp.getMask());
+  Value other = get(loadOp.getOther());
+  auto newOp = builder.create<triton::LoadOp>(
+      loadOp.getLoc(), loadOp.getResult().getType(), ptr,
+      getLoadMask(loadOp, mask, loopCond, builder), other,
+      loadOp.getBoundaryCheckAttr(), loadOp.getPaddingAttr(),
+      loadOp.getCache(), loadOp.getEvict(), loadOp.getIsVolatile());
+  addNamedAttrs(newOp, loadOp->getAttrDictionary());
+  return newOp.getResult();
+}
+
+/// Double-buffers the loads of a loop in registers when it has no dot operands
+/// to pipeline through shared memory, e.g. the streaming loops of reductions
+/// and normalizations. The loads of the next iteration are issued at the
+/// start of the current one and carried to it, so that their latency is
+/// hidden behind a whole iteration. The loads only qualify if their addresses
+/// can be recomputed without other loads, and as long as the prefetched
+/// values fit in kMaxPrefetchRegisters. Loops that write memory are skipped,
+/// since the prefetched addresses may alias the stores.
+static void prefetchLoadsToRegisters(scf::ForOp forOp) {
+  bool hasWrites = false;
+  forOp.getBody()->walk([&](Operation *op) {
+    auto memOp = dyn_cast<MemoryEffectOpInterface>(op);
+    if (memOp ? memOp.hasEffect<MemoryEffects::Write>()
+              : !op->hasTrait<OpTrait::HasRecursiveMemoryEffects>())
+      hasWrites = true;
+  });
+  if (hasWrites)
+    return;
+
+  SmallVector<triton::LoadOp> loads;
+  unsigned numRegisters = 0;
+  for (Operation &op : forOp.getBody()->without_terminator()) {
+    auto loadOp = dyn_cast<triton::LoadOp>(&op);
+    if (!loadOp || loadOp.getIsVolatile() ||
+        triton::isTensorPointerType(loadOp.getPtr().getType()))
+      continue;
+    Type elemTy = getElementTypeOrSelf(loadOp.getType());
+    if (!elemTy.isIntOrFloat() || loadOp.getResult().use_empty())
+      continue;
+    unsigned numElems = 1;
+    if (auto tensorTy = loadOp.getType().dyn_cast<RankedTensorType>())
+      numElems = ttg::getTotalElemsPerThread(tensorTy);
+    unsigned loadRegisters =
+        ceil<unsigned>(numElems * elemTy.getIntOrFloatBitWidth(), 32);
+    if (numRegisters + loadRegisters > kMaxPrefetchRegisters)
+      continue;
+    if (!llvm::all_of(loadOp->getOperands(), [&](Value operand) {
+          return isRecomputable(forOp, operand, /*isNext=*/true);
+        }))
+      continue;
+    numRegisters += loadRegisters;
+    loads.push_back(loadOp);
+  }
+  if (loads.empty())
+    return;
+
+  // The loads of the first iteration
+  OpBuilder builder(forOp);
+  IRMapping initMapping;
+  initMapping.map(forOp.getInductionVar(), forOp.getLowerBound());
+  for (auto [arg, init] :
+       llvm::zip(forOp.getRegionIterArgs(), forOp.getIterOperands()))
+    initMapping.map(arg, init);
+  SmallVector<Value> newLoopArgs(forOp.getIterOperands().begin(),
+                                 forOp.getIterOperands().end());
+  size_t prefetchIdx = newLoopArgs.size();
+  for (triton::LoadOp loadOp : loads)
+    newLoopArgs.push_back(
+        prefetchLoad(forOp, loadOp, initMapping, nullptr, builder));
+
+  auto newForOp = builder.create<scf::ForOp>(
+      forOp.getLoc(), forOp.getLowerBound(), forOp.getUpperBound(),
+      forOp.getStep(), newLoopArgs);
+  builder.setInsertionPointToStart(newForOp.getBody());
+  IRMapping mapping;
+  mapping.map(forOp.getInductionVar(), newForOp.getInductionVar());
+  for (const auto &arg : llvm::enumerate(forOp.getRegionIterArgs()))
+    mapping.map(arg.value(), newForOp.getRegionIterArgs()[arg.index()]);
+
+  // The loads of the next iteration come first, the ones of this iteration
+  // are the loop-carried values
+  IRMapping curMapping = mapping;
+  IRMapping nextMapping;
+  Value nextIV = builder.create<arith::AddIOp>(
+      forOp.getLoc(), newForOp.getInductionVar(), newForOp.getStep());
+  nextMapping.map(forOp.getInductionVar(), nextIV);
+  SmallVector<Value> nextLoads;
+  for (auto loadOp : llvm::enumerate(loads)) {
+    nextLoads.push_back(prefetchLoad(forOp, loadOp.value(), nextMapping,
+                                     &curMapping, builder));
+    mapping.map(loadOp.value().getResult(),
+                newForOp.getRegionIterArgs()[prefetchIdx + loadOp.index()]);
+  }
+
+  DenseSet<Operation *> prefetched;
+  for (triton::LoadOp loadOp : loads)
+    prefetched.insert(loadOp);
+  for (Operation &op : forOp.getBody()->without_terminator())
+    if (!prefetched.contains(&op))
+      builder.clone(op, mapping);
+
+  SmallVector<Value> yieldValues;
+  for (Value v : forOp.getBody()->getTerminator()->getOperands())
+    yieldValues.push_back(mapping.lookupOrDefault(v));
+  yieldValues.append(nextLoads.begin(), nextLoads.end());
+  builder.create<scf::YieldOp>(forOp.getBody()->getTerminator()->getLoc(),
+                               yieldValues);
+
+  for (unsigned i = 0; i < forOp->getNumResults(); ++i)
+    forOp->getResult(i).replaceAllUsesWith(newForOp->getResult(i));
+  forOp->erase();
+}
+
+/// Rewrites a while loop that counts up to a loop-invariant bound into a for
+/// loop, so that data-dependent trip counts (e.g. causal or variable-length
+/// attention) are pipelined like the other loops. The prologue and the
+/// prefetches of the pipeliner are masked by the loop condition, which guards
+/// the iterations past the bound. The counter stays a loop-carried value as
+/// well, since its final value is a result of the while loop.
+static void convertWhileToFor(scf::WhileOp whileOp) {
+  Block *before = whileOp.getBeforeBody();
+  Block *after = whileOp.getAfterBody();
+  scf::ConditionOp condOp = whileOp.getConditionOp();
+  if (before->getOperations().size() != 2 ||
+      !llvm::equal(condOp.getArgs(), before->getArguments()))
+    return;
+  auto cmpOp = condOp.getCondition().getDefiningOp<arith::CmpIOp>();
+  if (!cmpOp)
+    return;
+  Value lhs = cmpOp.getLhs();
+  Value ub = cmpOp.getRhs();
+  if (cmpOp.getPredicate() == arith::CmpIPredicate::sgt)
+    std::swap(lhs, ub);
+  else if (cmpOp.getPredicate() != arith::CmpIPredicate::slt)
+    return;
+  auto ivArg = lhs.dyn_cast<BlockArgument>();
+  if (!ivArg || ivArg.getOwner() != before ||
+      !ub.getParentRegion()->isAncestor(whileOp->getParentRegion()))
+    return;
+
+  // The counter must be incremented by a positive constant step
+  unsigned ivIdx = ivArg.getArgNumber();
+  Value afterIV = after->getArgument(ivIdx);
+  auto addOp = whileOp.getYieldOp()
+                   .getOperand(ivIdx)
+                   .getDefiningOp<arith::AddIOp>();
+  if (!addOp)
+    return;
+  Value step = addOp.getLhs() == afterIV ? addOp.getRhs() : addOp.getLhs();
+  APInt stepValue;
+  if ((addOp.getLhs() != afterIV && addOp.getRhs() != afterIV) ||
+      !matchPattern(step, m_ConstantInt(&stepValue)) ||
+      !stepValue.isStrictlyPositive())
+    return;
+
+  OpBuilder builder(whileOp);
+  SmallVector<Value> inits(whileOp.getInits().begin(),
+                           whileOp.getInits().end());
+  auto forOp = builder.create<scf::ForOp>(whileOp.getLoc(), inits[ivIdx], ub,
+                                          step, inits);
+  builder.setInsertionPointToStart(forOp.getBody());
+  IRMapping mapping;
+  for (const auto &arg : llvm::enumerate(after->getArguments()))
+    mapping.map(arg.value(), forOp.getRegionIterArgs()[arg.index()]);
+  mapping.map(afterIV, forOp.getInductionVar());
+  for (Operation &op : after->without_terminator())
+    builder.clone(op, mapping);
+  SmallVector<Value> yieldValues;
+  for (Value v : whileOp.getYieldOp().getOperands())
+    yieldValues.push_back(mapping.lookupOrDefault(v));
+  builder.create<scf::YieldOp>(whileOp.getYieldOp().getLoc(), yieldValues);
+
+  whileOp->replaceAllUsesWith(forOp->getResults());
+  whileOp->erase();
+}
+
 // ref: mlir/lib/Dialect/SCF/Transforms/LoopPipelining.cpp
 struct PipelinePass : public TritonGPUPipelineBase<PipelinePass> {
   PipelinePass() = default;
@@ -785,6 +1174,13 @@ struct PipelinePass : public TritonGPUPipelineBase<PipelinePass> {
       return;
 
     // Pre-processing
+    // while loops counting up to a loop-invariant bound become for loops
+    SmallVector<scf::WhileOp> whileOps;
+    getOperation()->walk(
+        [&](scf::WhileOp whileOp) { whileOps.push_back(whileOp); });
+    for (scf::WhileOp whileOp : whileOps)
+      convertWhileToFor(whileOp);
+
     // we make sure element-wise ops are done *after* the conversion
     // to dot operands
     // we can achieve this with simple recursive pattern matching
@@ -796,10 +1192,16 @@ struct PipelinePass : public TritonGPUPipelineBase<PipelinePass> {
 
     // Do the pipelining
     getOperation()->walk([&](scf::ForOp forOp) -> void {
+      // the remainder of an unrolled loop runs too few iterations to fill
+      // the pipeline
+      if (forOp->hasAttr("tt.unroll_remainder"))
+        return;
       LoopPipeliner pipeliner(forOp, numStages);
 
-      if (pipeliner.initialize().failed())
+      if (pipeliner.initialize().failed()) {
+        prefetchLoadsToRegisters(forOp);
         return;
+      }
 
       pipeliner.emitPrologue();
 
@@ -39,32 +39,45 @@ using namespace mlir;
 namespace {
 
 class Prefetcher {
+  /// The shared memory source of a dot operand
+  struct OperandPrefetch {
+    /// values from the shared memory source (front) to the dot operand
+    SmallVector<Value> vals;
+    /// shared memory source at the first iteration
+    Value headerDef;
+    /// shared memory source at the next iteration, null if loop-invariant
+    Value yield;
+    /// prefetched operand at the first iteration
+    Value headPrefetch;
+    /// index of the prefetched operand in the args of the new loop
+    size_t argIdx = 0;
+  };
+
   /// cache the ForOp we are working on
   scf::ForOp forOp;
   /// cache the YieldOp of this ForOp
   scf::YieldOp yieldOp;
-  ///
-  // TODO: add a hook to infer prefetchWidth
-  unsigned prefetchWidth = 32;
 
-  /// dots to be prefetched
+  /// dots whose operands are prefetched slice by slice along k
   SetVector<Value> dots;
+  /// dots with a single operand in shared memory (e.g. the P @ V of flash
+  /// attention), which is prefetched whole for the next iteration
+  SetVector<Value> wholeDots;
+  /// dot => width (along k) of the prefetched slices
+  DenseMap<Value, unsigned> dot2prefetchWidth;
+  /// dot => operand prefetched whole
+  DenseMap<Value, unsigned> dot2wholeOpIdx;
   /// dot => dot operand
-  DenseMap<Value, Value> dot2aLoopArg;
-  DenseMap<Value, Value> dot2aHeaderDef;
-  DenseMap<Value, Value> dot2bLoopArg;
-  DenseMap<Value, Value> dot2bHeaderDef;
-  DenseMap<Value, Value> dot2aYield;
-  DenseMap<Value, Value> dot2bYield;
-  DenseMap<Value, SmallVector<Value>> dot2aVals;
-  DenseMap<Value, SmallVector<Value>> dot2bVals;
-  /// operand => defining
-  DenseMap<Value, Value> operand2headPrefetch;
-
-  LogicalResult isForOpOperand(Value v);
+  DenseMap<Value, OperandPrefetch> dot2a;
+  DenseMap<Value, OperandPrefetch> dot2b;
+
+  OperandPrefetch &getOperand(Value dot, unsigned opIdx) {
+    return opIdx == 0 ? dot2a[dot] : dot2b[dot];
+  }
 
   Value generatePrefetch(Value v, unsigned opIdx, bool isPrologue,
-                         Attribute dotEncoding, OpBuilder &builder,
+                         Attribute dotEncoding, unsigned prefetchWidth,
+                         OpBuilder &builder,
                          std::optional<int64_t> offsetK = std::nullopt,
                          std::optional<int64_t> shapeK = std::nullopt);
 
@@ -104,7 +117,8 @@ void Prefetcher::cloneElementwiseOps(Value &ret, const SmallVector<Value> &vals,
 }
 
 Value Prefetcher::generatePrefetch(Value v, unsigned opIdx, bool isPrologue,
-                                   Attribute dotEncoding, OpBuilder &builder,
+                                   Attribute dotEncoding,
+                                   unsigned prefetchWidth, OpBuilder &builder,
                                    std::optional<int64_t> offsetK,
                                    std::optional<int64_t> shapeK) {
   // opIdx: 0 => a, 1 => b
@@ -152,17 +166,12 @@ LogicalResult Prefetcher::initialize() {
   if (dotsInFor.empty())
     return failure();
 
-  // TODO: segfault (original for still has uses)
-  // when used in flash attention that has 2 dots in the loop
-  if (dotsInFor.size() > 1)
-    return failure();
-
-  // returns source of cvt
-
   // returns source of cvt
   auto getPrefetchSrc = [](Value v) -> SmallVector<Value> {
     // walk back to conversion
     Operation *op = v.getDefiningOp();
+    if (!op)
+      return {};
     bool foundConvertFromShared = false;
     SmallVector<Value> rets;
     rets.push_back(op->getResult(0));
@@ -186,20 +195,39 @@ LogicalResult Prefetcher::initialize() {
     return {};
   };
 
-  auto getIncomingOp = [this](Value v) -> Value {
-    if (auto arg = v.dyn_cast<BlockArgument>())
-      if (arg.getOwner()->getParentOp() == forOp.getOperation())
-        return forOp.getOpOperandForRegionIterArg(arg).get();
-    return Value();
-  };
-
-  auto getYieldOp = [this](Value v) -> Value {
-    auto arg = v.cast<BlockArgument>();
-    unsigned yieldIdx = arg.getArgNumber() - forOp.getNumInductionVars();
-    return yieldOp.getOperand(yieldIdx);
+  // The shared memory source is either a loop argument or loop-invariant,
+  // and the conversion from it happens in the loop
+  auto getOperandPrefetch =
+      [this](const SmallVector<Value> &vals) -> std::optional<OperandPrefetch> {
+    if (vals.size() < 2 || !forOp->isProperAncestor(vals[1].getDefiningOp()))
+      return std::nullopt;
+    OperandPrefetch operand;
+    operand.vals = vals;
+    Value smem = vals.front();
+    if (auto arg = smem.dyn_cast<BlockArgument>()) {
+      if (arg.getOwner()->getParentOp() != forOp.getOperation() ||
+          arg.getArgNumber() < forOp.getNumInductionVars())
+        return std::nullopt;
+      operand.headerDef = forOp.getOpOperandForRegionIterArg(arg).get();
+      operand.yield = yieldOp.getOperand(arg.getArgNumber() -
+                                         forOp.getNumInductionVars());
+      return operand;
+    }
+    if (!forOp.isDefinedOutsideOfLoop(smem))
+      return std::nullopt;
+    operand.headerDef = smem;
+    return operand;
   };
 
   for (triton::DotOp dot : dotsInFor) {
+    // wgmma reads $b from shared memory, slicing it along K would only
+    // force mma.sync
+    auto dstEnc = dot.getType()
+                      .cast<RankedTensorType>()
+                      .getEncoding()
+                      .dyn_cast<triton::gpu::MmaEncodingAttr>();
+    if (dstEnc && dstEnc.isHopper())
+      continue;
     auto aType = dot.getA().getType().cast<RankedTensorType>();
     auto bType = dot.getB().getType().cast<RankedTensorType>();
     auto aEnc = aType.getEncoding().cast<triton::gpu::DotOperandEncodingAttr>();
@@ -212,37 +240,34 @@ LogicalResult Prefetcher::initialize() {
 
     // works better with nvidia tensor cores
     unsigned elementWidth = aType.getElementTypeBitWidth();
+    unsigned prefetchWidth;
     if (aKWidth == 0)
       prefetchWidth = 256 / elementWidth;
     else
       prefetchWidth = 8 * aKWidth;
 
-    // Skip prefetching if kSize is less than prefetchWidth
-    if (kSize < prefetchWidth)
-      continue;
-    auto aVals = getPrefetchSrc(dot.getA());
-    auto bVals = getPrefetchSrc(dot.getB());
-
-    if (aVals.size() && bVals.size()) {
-      Value aSmem = aVals.front();
-      Value bSmem = bVals.front();
-      Value aHeaderDef = getIncomingOp(aSmem);
-      Value bHeaderDef = getIncomingOp(bSmem);
-      // Only prefetch loop arg
-      if (aHeaderDef && bHeaderDef) {
-        dots.insert(dot);
-        dot2aVals[dot] = aVals;
-        dot2bVals[dot] = bVals;
-        dot2aHeaderDef[dot] = aHeaderDef;
-        dot2bHeaderDef[dot] = bHeaderDef;
-        dot2aLoopArg[dot] = aSmem;
-        dot2bLoopArg[dot] = bSmem;
-        dot2aYield[dot] = getYieldOp(aSmem);
-        dot2bYield[dot] = getYieldOp(bSmem);
-      }
+    auto a = getOperandPrefetch(getPrefetchSrc(dot.getA()));
+    auto b = getOperandPrefetch(getPrefetchSrc(dot.getB()));
+    // Only the loop args can be prefetched for the next iteration
+    if (a && b && (a->yield || b->yield) && kSize >= prefetchWidth &&
+        kSize % prefetchWidth == 0) {
+      dots.insert(dot);
+      dot2prefetchWidth[dot] = prefetchWidth;
+      dot2a[dot] = *a;
+      dot2b[dot] = *b;
+    } else if (a && a->yield && !b) {
+      wholeDots.insert(dot);
+      dot2wholeOpIdx[dot] = 0;
+      dot2a[dot] = *a;
+    } else if (b && b->yield && !a) {
+      wholeDots.insert(dot);
+      dot2wholeOpIdx[dot] = 1;
+      dot2b[dot] = *b;
     }
   }
 
+  if (dots.empty() && wholeDots.empty())
+    return failure();
   return success();
 }
 
@@ -252,31 +277,44 @@ void Prefetcher::emitPrologue() {
   for (Value dot : dots) {
     Attribute dotEncoding =
         dot.getType().cast<RankedTensorType>().getEncoding();
-    Value aPrefetched =
-        generatePrefetch(dot2aHeaderDef[dot], 0, true, dotEncoding, builder);
-    cloneElementwiseOps(aPrefetched, dot2aVals[dot], builder);
-    Value bPrefetched =
-        generatePrefetch(dot2bHeaderDef[dot], 1, true, dotEncoding, builder);
-    cloneElementwiseOps(bPrefetched, dot2bVals[dot], builder);
-
-    operand2headPrefetch[dot.getDefiningOp<triton::DotOp>().getA()] =
-        aPrefetched;
-    operand2headPrefetch[dot.getDefiningOp<triton::DotOp>().getB()] =
-        bPrefetched;
+    for (unsigned opIdx : {0, 1}) {
+      OperandPrefetch &operand = getOperand(dot, opIdx);
+      Value prefetched =
+          generatePrefetch(operand.headerDef, opIdx, true, dotEncoding,
+                           dot2prefetchWidth[dot], builder);
+      cloneElementwiseOps(prefetched, operand.vals, builder);
+      operand.headPrefetch = prefetched;
+    }
+  }
+
+  for (Value dot : wholeDots) {
+    OperandPrefetch &operand = getOperand(dot, dot2wholeOpIdx[dot]);
+    Value prefetched = operand.headerDef;
+    cloneElementwiseOps(prefetched, operand.vals, builder);
+    operand.headPrefetch = prefetched;
   }
 }
 
 scf::ForOp Prefetcher::createNewForOp() {
   OpBuilder builder(forOp);
 
+  // The prefetched slices of loop-invariant operands are used as is
   SmallVector<Value> loopArgs;
   for (auto v : forOp.getIterOperands())
     loopArgs.push_back(v);
   for (Value dot : dots) {
-    loopArgs.push_back(
-        operand2headPrefetch[dot.getDefiningOp<triton::DotOp>().getA()]);
-    loopArgs.push_back(
-        operand2headPrefetch[dot.getDefiningOp<triton::DotOp>().getB()]);
+    for (unsigned opIdx : {0, 1}) {
+      OperandPrefetch &operand = getOperand(dot, opIdx);
+      if (!operand.yield)
+        continue;
+      operand.argIdx = loopArgs.size();
+      loopArgs.push_back(operand.headPrefetch);
+    }
+  }
+  for (Value dot : wholeDots) {
+    OperandPrefetch &operand = getOperand(dot, dot2wholeOpIdx[dot]);
+    operand.argIdx = loopArgs.size();
+    loopArgs.push_back(operand.headPrefetch);
   }
 
   auto newForOp = builder.create<scf::ForOp>(
@@ -289,20 +327,27 @@ scf::ForOp Prefetcher::createNewForOp() {
     mapping.map(arg.value(), newForOp.getRegionIterArgs()[arg.index()]);
   mapping.map(forOp.getInductionVar(), newForOp.getInductionVar());
 
+  auto getHeadOperand = [&](Value dot, unsigned opIdx) -> Value {
+    OperandPrefetch &operand = getOperand(dot, opIdx);
+    if (!operand.yield)
+      return operand.headPrefetch;
+    return newForOp.getRegionIterArgs()[operand.argIdx];
+  };
+
   for (Operation &op : forOp.getBody()->without_terminator()) {
     Operation *newOp = builder.clone(op, mapping);
     auto dot = dyn_cast<triton::DotOp>(&op);
-    if (dot && dots.contains(dot)) {
+    if (dot && wholeDots.contains(dot)) {
+      unsigned opIdx = dot2wholeOpIdx[dot];
+      newOp->setOperand(opIdx, getHeadOperand(dot, opIdx));
+    } else if (dot && dots.contains(dot)) {
       Attribute dotEncoding =
           dot.getType().cast<RankedTensorType>().getEncoding();
+      unsigned prefetchWidth = dot2prefetchWidth[dot];
       // prefetched dot
-      Operation *firstDot = builder.clone(*dot, mapping);
-      if (Value a = operand2headPrefetch.lookup(dot.getA()))
-        firstDot->setOperand(
-            0, newForOp.getRegionIterArgForOpOperand(*a.use_begin()));
-      if (Value b = operand2headPrefetch.lookup(dot.getB()))
-        firstDot->setOperand(
-            1, newForOp.getRegionIterArgForOpOperand(*b.use_begin()));
+      Operation *firstDot = newOp;
+      firstDot->setOperand(0, getHeadOperand(dot, 0));
+      firstDot->setOperand(1, getHeadOperand(dot, 1));
 
       // remaining part
       int64_t kOff = prefetchWidth;
@@ -315,18 +360,19 @@ scf::ForOp Prefetcher::createNewForOp() {
         int64_t kShape = prefetchWidth;
         auto insertionPoint = builder.saveInsertionPoint();
         builder.setInsertionPoint(prevDot);
-        Value aRem =
-            generatePrefetch(mapping.lookup(dot2aLoopArg[dot]), 0, false,
-                             dotEncoding, builder, kOff, kShape);
-        cloneElementwiseOps(aRem, dot2aVals[dot], builder);
-        Value bRem =
-            generatePrefetch(mapping.lookup(dot2bLoopArg[dot]), 1, false,
-                             dotEncoding, builder, kOff, kShape);
-        cloneElementwiseOps(bRem, dot2bVals[dot], builder);
+        SmallVector<Value, 2> rems;
+        for (unsigned opIdx : {0, 1}) {
+          OperandPrefetch &operand = getOperand(dot, opIdx);
+          Value rem = generatePrefetch(
+              mapping.lookupOrDefault(operand.vals.front()), opIdx, false,
+              dotEncoding, prefetchWidth, builder, kOff, kShape);
+          cloneElementwiseOps(rem, operand.vals, builder);
+          rems.push_back(rem);
+        }
         builder.restoreInsertionPoint(insertionPoint);
         newOp = builder.clone(*dot, mapping);
-        newOp->setOperand(0, aRem);
-        newOp->setOperand(1, bRem);
+        newOp->setOperand(0, rems[0]);
+        newOp->setOperand(1, rems[1]);
         newOp->setOperand(2, prevDot->getResult(0));
         prevDot = newOp;
         kOff += kShape;
@@ -345,15 +391,22 @@ scf::ForOp Prefetcher::createNewForOp() {
   for (Value dot : dots) {
     Attribute dotEncoding =
         dot.getType().cast<RankedTensorType>().getEncoding();
-    Value aToYield = generatePrefetch(mapping.lookup(dot2aYield[dot]), 0, true,
-                                      dotEncoding, builder);
-    cloneElementwiseOps(aToYield, dot2aVals[dot], builder);
-    yieldValues.push_back(aToYield);
-    // bToYield
-    Value bToYield = generatePrefetch(mapping.lookup(dot2bYield[dot]), 1, true,
-                                      dotEncoding, builder);
-    cloneElementwiseOps(bToYield, dot2bVals[dot], builder);
-    yieldValues.push_back(bToYield);
+    for (unsigned opIdx : {0, 1}) {
+      OperandPrefetch &operand = getOperand(dot, opIdx);
+      if (!operand.yield)
+        continue;
+      Value toYield =
+          generatePrefetch(mapping.lookup(operand.yield), opIdx, true,
+                           dotEncoding, dot2prefetchWidth[dot], builder);
+      cloneElementwiseOps(toYield, operand.vals, builder);
+      yieldValues.push_back(toYield);
+    }
+  }
+  for (Value dot : wholeDots) {
+    OperandPrefetch &operand = getOperand(dot, dot2wholeOpIdx[dot]);
+    Value toYield = mapping.lookup(operand.yield);
+    cloneElementwiseOps(toYield, operand.vals, builder);
+    yieldValues.push_back(toYield);
   }
   // Update ops of yield
   if (!yieldValues.empty())
@@ -7,6 +7,7 @@
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/Verifier.h"
 #include "mlir/Interfaces/InferTypeOpInterface.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/LogicalResult.h"
@@ -17,9 +18,12 @@
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
 #include "triton/Dialect/TritonGPU/Transforms/TritonGPUConversion.h"
+#include "llvm/Support/Debug.h"
 
 #include <memory>
 
+#define DEBUG_TYPE "tritongpu-remove-layout-conversions"
+
 using namespace mlir;
 namespace {
 using triton::DotOp;
@@ -461,6 +465,7 @@ public:
     auto newForOp = rewriter.create<scf::ForOp>(
         forOp.getLoc(), forOp.getLowerBound(), forOp.getUpperBound(),
         forOp.getStep(), newInitArgs);
+    newForOp->setAttrs(forOp->getAttrs());
     newForOp->moveBefore(forOp);
     rewriter.setInsertionPointToStart(newForOp.getBody());
     IRMapping mapping;
@@ -619,6 +624,122 @@ public:
   }
 };
 
+// -----------------------------------------------------------------------------
+// Cost model
+// -----------------------------------------------------------------------------
+
+// Upper bound on the number of conversions removed by the cost model, which
+// guards against rematerializations that keep adding conversions to each
+// other's slices.
+constexpr unsigned kMaxCostModelSteps = 64;
+
+// A layout conversion stores its operand to shared memory and loads it back,
+// so it costs two shared memory accesses per byte of the tensor. Conversions
+// within warps only shuffle registers, once per byte.
+int64_t getConversionCost(Value value, Attribute targetEncoding) {
+  auto tensorType = value.getType().dyn_cast<RankedTensorType>();
+  if (!tensorType)
+    return 0;
+  Type elemTy = tensorType.getElementType();
+  int64_t bitWidth =
+      elemTy.isIntOrFloat() ? std::max(8u, elemTy.getIntOrFloatBitWidth()) : 64;
+  int64_t bytes = tensorType.getNumElements() * bitWidth / 8;
+  auto targetType = RankedTensorType::get(tensorType.getShape(), elemTy,
+                                          targetEncoding);
+  return isWarpLocalCvtLayout(tensorType, targetType) ? bytes : 2 * bytes;
+}
+
+// Rematerialized ops only touch registers: they cost one unit per element
+// they compute.
+int64_t getRematerializationCost(Operation *op) {
+  int64_t cost = 0;
+  for (Type type : op->getResultTypes())
+    if (auto tensorType = type.dyn_cast<RankedTensorType>())
+      cost += tensorType.getNumElements();
+  return cost;
+}
+
+// Computes the cost of removing `cvt` by rematerializing its backward slice
+// in the target layout: the ops of the slice plus the conversions left at its
+// boundary. Returns failure if the slice cannot be rematerialized.
+LogicalResult
+getBackwardRematCost(triton::gpu::ConvertLayoutOp cvt,
+                     SetVector<Operation *> &processed,
+                     llvm::MapVector<Value, Attribute> &toConvert,
+                     int64_t &cost) {
+  // same restrictions as RematerializeBackward
+  if (!cvt.getOperand().getDefiningOp())
+    return failure();
+  if (isSharedEncoding(cvt.getResult()) || isSharedEncoding(cvt.getOperand()))
+    return failure();
+  auto targetType = cvt.getResult().getType().cast<RankedTensorType>();
+  if (targetType.getEncoding().isa<triton::gpu::DotOperandEncodingAttr>())
+    return failure();
+  SetVector<Attribute> layout;
+  if (simulateBackwardRematerialization(cvt, processed, layout, toConvert,
+                                        targetType.getEncoding()) == INT_MAX)
+    return failure();
+  cost = 0;
+  for (Operation *op : processed)
+    if (!isa<triton::gpu::ConvertLayoutOp>(op))
+      cost += getRematerializationCost(op);
+  for (auto &item : toConvert) {
+    Operation *def = item.first.getDefiningOp();
+    if (def && (processed.contains(def) || canFoldConversion(def)))
+      continue;
+    cost += getConversionCost(item.first, item.second);
+  }
+  return success();
+}
+
+// Removes conversions by rematerializing their backward slices, most
+// profitable first, as long as the rematerialization is cheaper than the
+// conversion. Unlike RematerializeBackward, which rejects any slice that adds
+// a conversion, this accepts slices whose boundary conversions move less
+// data through shared memory than the one they replace, e.g. a conversion of
+// a row vector instead of the 2D tensor it is broadcast to.
+void rematerializeByCost(ModuleOp m) {
+  for (unsigned step = 0; step < kMaxCostModelSteps; ++step) {
+    triton::gpu::ConvertLayoutOp best;
+    int64_t bestSaving = 0;
+    m.walk([&](triton::gpu::ConvertLayoutOp cvt) {
+      SetVector<Operation *> processed;
+      llvm::MapVector<Value, Attribute> toConvert;
+      auto dstType = cvt.getResult().getType().cast<RankedTensorType>();
+      int64_t keepCost =
+          getConversionCost(cvt.getOperand(), dstType.getEncoding());
+      int64_t rematCost;
+      if (failed(getBackwardRematCost(cvt, processed, toConvert, rematCost))) {
+        LLVM_DEBUG(llvm::dbgs() << "[cost] " << cvt << ": keep = " << keepCost
+                                << ", remat = n/a\n");
+        return;
+      }
+      LLVM_DEBUG(llvm::dbgs() << "[cost] " << cvt << ": keep = " << keepCost
+                              << ", remat = " << rematCost << "\n");
+      if (keepCost - rematCost > bestSaving) {
+        best = cvt;
+        bestSaving = keepCost - rematCost;
+      }
+    });
+    if (!best)
+      return;
+    LLVM_DEBUG(llvm::dbgs() << "[cost] rematerializing " << best
+                            << ", saving = " << bestSaving << "\n");
+    SetVector<Operation *> processed;
+    llvm::MapVector<Value, Attribute> toConvert;
+    int64_t rematCost;
+    (void)getBackwardRematCost(best, processed, toConvert, rematCost);
+    OpBuilder builder(best);
+    IRMapping mapping;
+    rematerializeConversionChain(toConvert, builder, processed, mapping);
+    best.getResult().replaceAllUsesWith(mapping.lookup(best.getOperand()));
+    // `processed` starts at `best` and lists users before their operands
+    for (Operation *op : processed)
+      if (isOpTriviallyDead(op))
+        op->erase();
+  }
+}
+
 } // namespace
 
 #define GEN_PASS_CLASSES
@@ -629,11 +750,17 @@ class TritonGPURemoveLayoutConversionsPass
           TritonGPURemoveLayoutConversionsPass> {
 public:
   TritonGPURemoveLayoutConversionsPass() = default;
+  TritonGPURemoveLayoutConversionsPass(bool costModel) {
+    this->costModel = costModel;
+  }
 
   void runOnOperation() override {
     MLIRContext *context = &getContext();
     ModuleOp m = getOperation();
 
+    if (costModel)
+      rematerializeByCost(m);
+
     mlir::RewritePatternSet patterns(context);
 
     patterns.add<SimplifyConversion>(context);
@@ -655,6 +782,7 @@ public:
   }
 };
 
-std::unique_ptr<Pass> mlir::createTritonGPURemoveLayoutConversionsPass() {
-  return std::make_unique<TritonGPURemoveLayoutConversionsPass>();
+std::unique_ptr<Pass>
+mlir::createTritonGPURemoveLayoutConversionsPass(bool costModel) {
+  return std::make_unique<TritonGPURemoveLayoutConversionsPass>(costModel);
 }
@@ -6,6 +6,7 @@
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/Verifier.h"
 #include "mlir/Interfaces/InferTypeOpInterface.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/LogicalResult.h"
@@ -16,9 +17,12 @@
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
 #include "triton/Dialect/TritonGPU/Transforms/TritonGPUConversion.h"
+#include "llvm/Support/Debug.h"
 #define GEN_PASS_CLASSES
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
 
+#define DEBUG_TYPE "tritongpu-reorder-instructions"
+
 using namespace mlir;
 
 static inline bool
@@ -34,11 +38,259 @@ willIncreaseRegisterPressure(triton::gpu::ConvertLayoutOp op) {
   return false;
 }
 
+// -----------------------------------------------------------------------------
+// Register-pressure-aware list scheduling of loop bodies
+// -----------------------------------------------------------------------------
+
+// Number of 32-bit registers each thread needs to hold `value`. Tensors in
+// shared memory do not occupy registers.
+static int64_t getRegisters(Value value) {
+  Type type = value.getType();
+  if (auto tensorType = type.dyn_cast<RankedTensorType>()) {
+    if (!tensorType.getEncoding() || isSharedEncoding(value))
+      return 0;
+    Type elemTy = tensorType.getElementType();
+    int64_t bitWidth = elemTy.isIntOrFloat() ? elemTy.getIntOrFloatBitWidth()
+                                             : 64;
+    int64_t elems = triton::gpu::getTotalElemsPerThread(type);
+    return (elems * bitWidth + 31) / 32;
+  }
+  if (type.isa<triton::PointerType>())
+    return 2;
+  return type.isIntOrIndexOrFloat() ? 1 : 0;
+}
+
+// Default register budget of a thread: the register file of an SM split
+// between the threads of one CTA, capped by the per-thread limit of PTX.
+static int64_t getDefaultRegisterBudget(ModuleOp mod) {
+  int64_t numWarps = 4;
+  if (auto attr = mod->getAttrOfType<IntegerAttr>("triton_gpu.num-warps"))
+    numWarps = attr.getInt();
+  return std::min<int64_t>(255, 65536 / (numWarps * 32));
+}
+
+// Reads of memory that may be written by other ops of the block: ops with a
+// read effect and ops consuming a shared memory tensor, whose contents depend
+// on `async_wait` and `insert_slice_async`.
+static bool isMemoryRead(Operation *op) {
+  if (llvm::any_of(op->getOperands(), isSharedEncoding))
+    return true;
+  auto iface = dyn_cast<MemoryEffectOpInterface>(op);
+  return iface && iface.hasEffect<MemoryEffects::Read>() &&
+         !iface.hasEffect<MemoryEffects::Write>() &&
+         !iface.hasEffect<MemoryEffects::Allocate>() &&
+         !iface.hasEffect<MemoryEffects::Free>();
+}
+
+namespace {
+
+// List scheduler for the body of a loop. Ops become ready once the ops they
+// depend on are scheduled; among the ready ops, the scheduler keeps the
+// original order as long as the registers live after the op fit the budget,
+// and otherwise picks the op that leaves the fewest registers live.
+class RegisterPressureScheduler {
+public:
+  RegisterPressureScheduler(Block *block, int64_t budget)
+      : block(block), budget(budget) {
+    for (Operation &op : block->without_terminator()) {
+      index[&op] = ops.size();
+      ops.push_back(&op);
+    }
+    collectDependencies();
+  }
+
+  // Registers live in the original order at its most constrained point.
+  int64_t getOriginalPeak() const { return originalPeak; }
+
+  // Computes a new order of the ops of the block and returns its peak.
+  int64_t schedule(SmallVectorImpl<Operation *> &order);
+
+private:
+  void collectDependencies();
+
+  int64_t getLiveAfter(Operation *op, int64_t live,
+                       const DenseMap<Value, unsigned> &remainingUses) const;
+
+  void scheduleOp(Operation *op, DenseMap<Value, unsigned> &remainingUses);
+
+  Block *block;
+  int64_t budget;
+  // Registers live throughout the body: loop-carried values and values
+  // defined outside of the loop.
+  int64_t invariant = 0;
+  int64_t originalPeak = 0;
+  SmallVector<Operation *> ops;
+  DenseMap<Operation *, unsigned> index;
+  DenseMap<Operation *, SetVector<Operation *>> predecessors;
+  DenseMap<Operation *, SmallVector<Operation *>> successors;
+  // Values of the block read by each op, including from nested regions.
+  DenseMap<Operation *, SetVector<Value>> operands;
+  // Number of ops of the block (or the terminator) using each value.
+  DenseMap<Value, unsigned> numUses;
+};
+
+void RegisterPressureScheduler::collectDependencies() {
+  SetVector<Value> outsideValues;
+  Operation *lastWrite = nullptr;
+  SmallVector<Operation *> readsSinceWrite;
+  auto addDependency = [&](Operation *from, Operation *to) {
+    if (predecessors[to].insert(from))
+      successors[from].push_back(to);
+  };
+  for (Operation *op : ops) {
+    op->walk([&](Operation *nested) {
+      for (Value operand : nested->getOperands()) {
+        // skip values defined in the regions of `op`
+        if (op->isAncestor(operand.getParentBlock()->getParentOp()))
+          continue;
+        Operation *def = operand.getDefiningOp();
+        Operation *defInBlock =
+            def ? block->findAncestorOpInBlock(*def) : nullptr;
+        if (defInBlock)
+          addDependency(defInBlock, op);
+        else if (operand.getParentBlock() != block)
+          outsideValues.insert(operand);
+        if (defInBlock && operands[op].insert(operand))
+          numUses[operand]++;
+      }
+    });
+    // Keep memory reads and writes ordered with respect to each other. Ops
+    // reading shared memory operands are reads even if they have no effects.
+    if (isMemoryRead(op)) {
+      if (lastWrite)
+        addDependency(lastWrite, op);
+      readsSinceWrite.push_back(op);
+      continue;
+    }
+    if (isMemoryEffectFree(op))
+      continue;
+    if (lastWrite)
+      addDependency(lastWrite, op);
+    for (Operation *read : readsSinceWrite)
+      addDependency(read, op);
+    readsSinceWrite.clear();
+    lastWrite = op;
+  }
+  // Values used by the terminator stay live until the end of the body.
+  Operation *terminator = block->getTerminator();
+  for (Value operand : terminator->getOperands())
+    if (operand.getParentBlock() == block && !operand.isa<BlockArgument>())
+      numUses[operand]++;
+  for (Value arg : block->getArguments())
+    invariant += getRegisters(arg);
+  for (Value value : outsideValues)
+    invariant += getRegisters(value);
+
+  DenseMap<Value, unsigned> remainingUses = numUses;
+  int64_t live = invariant;
+  originalPeak = live;
+  for (Operation *op : ops) {
+    live = getLiveAfter(op, live, remainingUses);
+    originalPeak = std::max(originalPeak, live);
+    scheduleOp(op, remainingUses);
+  }
+}
+
+int64_t RegisterPressureScheduler::getLiveAfter(
+    Operation *op, int64_t live,
+    const DenseMap<Value, unsigned> &remainingUses) const {
+  for (Value result : op->getResults())
+    if (numUses.lookup(result) > 0)
+      live += getRegisters(result);
+  auto it = operands.find(op);
+  if (it != operands.end())
+    for (Value operand : it->second)
+      if (remainingUses.lookup(operand) == 1)
+        live -= getRegisters(operand);
+  return live;
+}
+
+void RegisterPressureScheduler::scheduleOp(
+    Operation *op, DenseMap<Value, unsigned> &remainingUses) {
+  auto it = operands.find(op);
+  if (it != operands.end())
+    for (Value operand : it->second)
+      remainingUses[operand]--;
+}
+
+int64_t
+RegisterPressureScheduler::schedule(SmallVectorImpl<Operation *> &order) {
+  DenseMap<Value, unsigned> remainingUses = numUses;
+  DenseMap<Operation *, unsigned> numPending;
+  SmallVector<Operation *> ready;
+  for (Operation *op : ops) {
+    numPending[op] = predecessors.lookup(op).size();
+    if (numPending[op] == 0)
+      ready.push_back(op);
+  }
+  int64_t live = invariant;
+  int64_t peak = live;
+  while (!ready.empty()) {
+    // `ready` is sorted by original position
+    Operation *best = nullptr;
+    int64_t bestLive = 0;
+    for (Operation *op : ready) {
+      int64_t liveAfter = getLiveAfter(op, live, remainingUses);
+      if (liveAfter <= budget) {
+        best = op;
+        bestLive = liveAfter;
+        break;
+      }
+      if (!best || liveAfter < bestLive) {
+        best = op;
+        bestLive = liveAfter;
+      }
+    }
+    ready.erase(llvm::find(ready, best));
+    scheduleOp(best, remainingUses);
+    order.push_back(best);
+    live = bestLive;
+    peak = std::max(peak, live);
+    for (Operation *succ : successors.lookup(best)) {
+      if (--numPending[succ] != 0)
+        continue;
+      auto pos =
+          llvm::upper_bound(ready, succ, [&](Operation *a, Operation *b) {
+            return index.lookup(a) < index.lookup(b);
+          });
+      ready.insert(pos, succ);
+    }
+  }
+  assert(order.size() == ops.size() && "cyclic dependencies in a block");
+  return peak;
+}
+
+} // namespace
+
+// Reorders the body of `forOp` if its original order needs more registers
+// than `budget`.
+static void scheduleLoopBody(scf::ForOp forOp, int64_t budget) {
+  Block *body = forOp.getBody();
+  RegisterPressureScheduler scheduler(body, budget);
+  int64_t originalPeak = scheduler.getOriginalPeak();
+  if (originalPeak <= budget)
+    return;
+  SmallVector<Operation *> order;
+  int64_t peak = scheduler.schedule(order);
+  LLVM_DEBUG(llvm::dbgs() << "[schedule] loop at " << forOp.getLoc()
+                          << ": budget = " << budget
+                          << ", original peak = " << originalPeak
+                          << ", scheduled peak = " << peak << "\n");
+  if (peak >= originalPeak)
+    return;
+  Operation *terminator = body->getTerminator();
+  for (Operation *op : order)
+    op->moveBefore(terminator);
+}
+
 class TritonGPUReorderInstructionsPass
     : public TritonGPUReorderInstructionsBase<
           TritonGPUReorderInstructionsPass> {
 public:
   TritonGPUReorderInstructionsPass() = default;
+  TritonGPUReorderInstructionsPass(int regBudget) {
+    this->regBudget = regBudget;
+  }
 
   void runOnOperation() override {
     ModuleOp m = getOperation();
@@ -99,10 +351,19 @@ public:
         return;
       op->moveBefore(BOp);
     });
+    // Schedule the innermost loops under the register budget
+    int64_t budget = regBudget > 0 ? regBudget : getDefaultRegisterBudget(m);
+    m.walk([&](scf::ForOp forOp) {
+      bool innermost = true;
+      forOp.getBody()->walk([&](scf::ForOp) { innermost = false; });
+      if (innermost)
+        scheduleLoopBody(forOp, budget);
+    });
     return;
   }
 };
 
-std::unique_ptr<Pass> mlir::createTritonGPUReorderInstructionsPass() {
-  return std::make_unique<TritonGPUReorderInstructionsPass>();
+std::unique_ptr<Pass>
+mlir::createTritonGPUReorderInstructionsPass(int regBudget) {
+  return std::make_unique<TritonGPUReorderInstructionsPass>(regBudget);
 }
@@ -12,8 +12,9 @@ using namespace mlir::triton::gpu;
 // TypeConverter
 //
 TritonGPUTypeConverter::TritonGPUTypeConverter(MLIRContext *context,
-                                               int numWarps)
-    : context(context), numWarps(numWarps) {
+                                               int numWarps,
+                                               int threadsPerWarp)
+    : context(context), numWarps(numWarps), threadsPerWarp(threadsPerWarp) {
   addConversion([](Type type) { return type; });
   addConversion([this](RankedTensorType tensorType) -> RankedTensorType {
     // types with encoding are already in the right format
@@ -29,7 +30,8 @@ TritonGPUTypeConverter::TritonGPUTypeConverter(MLIRContext *context,
     std::iota(order.begin(), order.end(), 0);
     llvm::SmallVector<unsigned> sizePerThread(rank, 1);
     Attribute encoding = triton::gpu::BlockedEncodingAttr::get(
-        this->context, shape, sizePerThread, order, this->numWarps);
+        this->context, shape, sizePerThread, order, this->numWarps,
+        this->threadsPerWarp);
     return RankedTensorType::get(shape, tensorType.getElementType(), encoding);
   });
 
@@ -95,6 +97,12 @@ TritonGPUConversionTarget::TritonGPUConversionTarget(
     return false;
   });
 
+  // The shared memory ops of the frontend copy from and load into tensors
+  // without layouts
+  addDynamicallyLegalOp<triton::gpu::ConvertLayoutOp,
+                        triton::gpu::InsertSliceAsyncOp>(
+      [&](Operation *op) { return typeConverter.isLegal(op); });
+
   // We have requirements for the data layouts
   addDynamicallyLegalOp<triton::DotOp>([](triton::DotOp dotOp) -> bool {
     Attribute aEncoding =
@@ -106,4 +114,16 @@ TritonGPUConversionTarget::TritonGPUConversionTarget(
       return true;
     return false;
   });
+  addDynamicallyLegalOp<triton::SparseDotOp>([](triton::SparseDotOp dotOp) {
+    auto getEncoding = [](Value v) {
+      return v.getType().cast<RankedTensorType>().getEncoding();
+    };
+    Attribute aEncoding = getEncoding(dotOp.getA());
+    Attribute bEncoding = getEncoding(dotOp.getB());
+    Attribute metaEncoding = getEncoding(dotOp.getAMeta());
+    return aEncoding && aEncoding.isa<triton::gpu::DotOperandEncodingAttr>() &&
+           bEncoding && bEncoding.isa<triton::gpu::DotOperandEncodingAttr>() &&
+           metaEncoding &&
+           metaEncoding.isa<triton::gpu::SharedEncodingAttr>();
+  });
 }
@@ -37,6 +37,7 @@ public:
     scf::ForOp newForOp = rewriter.create<scf::ForOp>(
         forOp.getLoc(), forOp.getLowerBound(), forOp.getUpperBound(),
         forOp.getStep(), newInitArgs);
+    newForOp->setAttrs(forOp->getAttrs());
     newForOp->moveBefore(forOp);
     rewriter.setInsertionPointToStart(newForOp.getBody());
     IRMapping mapping;
@@ -82,6 +83,15 @@ LogicalResult invertEncoding(Attribute targetEncoding, Operation *op,
       return failure();
     ret = sliceEncoding.getParent();
   }
+  if (isa<triton::TransOp>(op)) {
+    // transposing is its own inverse
+    if (!targetEncoding.isa<triton::gpu::BlockedEncodingAttr>())
+      return failure();
+    auto inferLayoutInterface =
+        dyn_cast<triton::DialectInferLayoutInterface>(
+            &targetEncoding.getDialect());
+    return inferLayoutInterface->inferTransOpEncoding(targetEncoding, ret);
+  }
   if (isa<triton::ViewOp, triton::CatOp>(op)) {
     return failure();
   }
@@ -89,6 +99,10 @@ LogicalResult invertEncoding(Attribute targetEncoding, Operation *op,
 }
 
 bool expensiveLoadOrStore(Operation *op, Attribute &targetEncoding) {
+  // A block pointer has no layout: accessing it in another layout issues
+  // the whole access again
+  if (triton::isTensorPointerType(op->getOperand(0).getType()))
+    return true;
   // Case 1: A size 1 tensor is not expensive since all threads will load the
   // same
   if (isSingleValue(op->getOperand(0)))
@@ -116,6 +130,16 @@ bool expensiveToRemat(Operation *op, Attribute &targetEncoding) {
           triton::gpu::InsertSliceAsyncOp, triton::AtomicRMWOp,
           triton::AtomicCASOp, triton::DotOp>(op))
     return true;
+  // The scan lowering only supports blocked layouts
+  if (isa<triton::ScanOp>(op))
+    return true;
+  // The layout decides which steps of a sort exchange data through shared
+  // memory
+  if (isa<triton::SortOp, triton::TopKOp>(op))
+    return true;
+  // The rematerialization only retypes the first result of an op
+  if (isa<triton::PhiloxOp>(op))
+    return true;
   if (isa<scf::YieldOp, scf::ForOp, scf::IfOp, scf::WhileOp, scf::ConditionOp>(
           op))
     return true;
@@ -222,7 +246,7 @@ Operation *cloneWithInferType(mlir::OpBuilder &rewriter, Operation *op,
 
 void rematerializeConversionChain(
     const llvm::MapVector<Value, Attribute> &toConvert,
-    mlir::PatternRewriter &rewriter, SetVector<Operation *> &processed,
+    mlir::OpBuilder &rewriter, SetVector<Operation *> &processed,
     IRMapping &mapping) {
   SmallVector<Value, 4> sortedValues;
   SetVector<Operation *> tmp;
@@ -16,6 +16,8 @@ bool expensiveLoadOrStore(Operation *op, Attribute &targetEncoding);
 
 bool expensiveToRemat(Operation *op, Attribute &targetEncoding);
 
+bool canFoldConversion(Operation *op);
+
 int simulateBackwardRematerialization(
     Operation *initOp, SetVector<Operation *> &processed,
     SetVector<Attribute> &layout, llvm::MapVector<Value, Attribute> &toConvert,
@@ -26,7 +28,7 @@ Operation *cloneWithInferType(mlir::OpBuilder &rewriter, Operation *op,
 
 void rematerializeConversionChain(
     const llvm::MapVector<Value, Attribute> &toConvert,
-    mlir::PatternRewriter &rewriter, SetVector<Operation *> &processed,
+    mlir::OpBuilder &rewriter, SetVector<Operation *> &processed,
     IRMapping &mapping);
 } // namespace mlir
 
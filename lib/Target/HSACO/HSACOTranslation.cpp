@@ -23,6 +23,9 @@
 #include "llvm/MC/TargetRegistry.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/raw_ostream.h"
@@ -30,10 +33,15 @@
 #include "llvm/Target/TargetOptions.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Utils/Cloning.h"
-#include <filesystem>
 #include <iostream>
 #include <memory>
-#include <random>
+#include <mutex>
+
+#ifdef TRITON_HAS_LLD
+#include "lld/Common/Driver.h"
+
+LLD_HAS_DRIVER(elf)
+#endif
 
 namespace {
 
@@ -97,58 +105,94 @@ std::string generate_amdgcn_assembly(llvm::Module *module,
   return amdgcn;
 }
 
-std::string generate_hsaco(llvm::Module *module, const std::string &triple,
-                           const std::string &proc,
-                           const std::string &features) {
-  auto machine = initialize_module(module, triple, proc, features);
-
-  // create unique dir for kernel's binary and hsaco
-  std::error_code ec;
-  std::string kernel_name_base = "amd_triton_kernel";
-  std::filesystem::path tmp = std::filesystem::temp_directory_path();
-  std::filesystem::path kernel_dir_base(kernel_name_base);
-  llvm::SmallString<256> unique_dir;
-  ec = llvm::sys::fs::createUniqueDirectory((tmp / kernel_dir_base).string(),
-                                            unique_dir);
-  if (ec) {
-    std::cerr << "Directory for " << kernel_name_base
-              << " was not created. error code: " << ec << std::endl;
-  }
-  std::filesystem::path kernel_dir(unique_dir.data());
-  std::string kernel_name = kernel_dir.stem();
-
-  // Save GCN ISA binary.
-  std::filesystem::path isa_binary(kernel_name + ".o");
-  std::string isabin_path = (kernel_dir / isa_binary).string();
-  std::unique_ptr<llvm::raw_fd_ostream> isabin_fs(
-      new llvm::raw_fd_ostream(isabin_path, ec, llvm::sys::fs::OF_Text));
-  if (ec) {
-    std::cerr << isabin_path << " was not created. error code: " << ec
-              << std::endl;
+#ifndef TRITON_HAS_LLD
+// Returns the ld.lld to link the code objects with when lld is not linked
+// in: $TRITON_HIP_LLD_PATH, the ld.lld of $ROCM_PATH or /opt/rocm, or the
+// first one in $PATH.
+std::string find_lld() {
+  if (const char *path = std::getenv("TRITON_HIP_LLD_PATH"))
+    return path;
+  llvm::SmallVector<std::string, 2> candidates;
+  if (const char *rocm = std::getenv("ROCM_PATH"))
+    candidates.push_back(std::string(rocm) + "/llvm/bin/ld.lld");
+  candidates.push_back("/opt/rocm/llvm/bin/ld.lld");
+  for (const std::string &candidate : candidates)
+    if (llvm::sys::fs::can_execute(candidate))
+      return candidate;
+  if (llvm::ErrorOr<std::string> path = llvm::sys::findProgramByName("ld.lld"))
+    return *path;
+  return candidates.back();
+}
+#endif
+
+// Links the relocatable object `isabin` into a code object. lld only reads
+// and writes files, so both go through temporary files, removed on return.
+std::string link_hsaco(llvm::StringRef isabin) {
+  llvm::SmallString<128> isabin_path, hsaco_path;
+  if (std::error_code ec = llvm::sys::fs::createTemporaryFile(
+          "amd_triton_kernel", "o", isabin_path))
+    llvm::report_fatal_error("failed to create a temporary file: " +
+                             ec.message());
+  llvm::FileRemover isabin_remover(isabin_path);
+  if (std::error_code ec = llvm::sys::fs::createTemporaryFile(
+          "amd_triton_kernel", "hsaco", hsaco_path))
+    llvm::report_fatal_error("failed to create a temporary file: " +
+                             ec.message());
+  llvm::FileRemover hsaco_remover(hsaco_path);
+  {
+    std::error_code ec;
+    llvm::raw_fd_ostream isabin_fs(isabin_path, ec, llvm::sys::fs::OF_None);
+    if (ec)
+      llvm::report_fatal_error(llvm::Twine(isabin_path) +
+                               " was not created: " + ec.message());
+    isabin_fs << isabin;
   }
 
-  // emit
-  llvm::legacy::PassManager pass;
-  machine->addPassesToEmitFile(pass, *isabin_fs, nullptr,
-                               llvm::CGFT_ObjectFile);
-  pass.run(*module);
-
-  // generate HASCO file
-  std::filesystem::path hsaco(kernel_name + ".hsaco");
-  std::string hsaco_path = (kernel_dir / hsaco).string();
   std::string error_message;
-  std::string lld_path = "/opt/rocm/llvm/bin/ld.lld";
+#ifdef TRITON_HAS_LLD
+  {
+    // lld keeps global state: one link at a time
+    static std::mutex lld_mutex;
+    std::lock_guard<std::mutex> lock(lld_mutex);
+    llvm::raw_string_ostream errs(error_message);
+    std::vector<const char *> args{"ld.lld",           "-shared",
+                                   "-o",               hsaco_path.c_str(),
+                                   isabin_path.c_str()};
+    lld::Result result = lld::lldMain(args, llvm::nulls(), errs,
+                                      {{lld::Gnu, &lld::elf::link}});
+    if (result.retCode)
+      llvm::report_fatal_error("ld.lld failed: " + errs.str());
+  }
+#else
+  std::string lld_path = find_lld();
   int lld_result = llvm::sys::ExecuteAndWait(
       lld_path,
       {lld_path, "-flavor", "gnu", "-shared", "-o", hsaco_path, isabin_path},
       std::nullopt, {}, 0, 0, &error_message);
-  if (lld_result) {
-    std::cout << "ld.lld execute fail: " << std::endl;
-    std::cout << error_message << std::endl;
-    std::cout << lld_result << std::endl;
-  }
+  if (lld_result)
+    llvm::report_fatal_error(lld_path + " failed: " + error_message);
+#endif
+
+  auto hsaco = llvm::MemoryBuffer::getFile(hsaco_path, /*IsText=*/false);
+  if (!hsaco)
+    llvm::report_fatal_error(llvm::Twine(hsaco_path) + " was not read: " +
+                             hsaco.getError().message());
+  return (*hsaco)->getBuffer().str();
+}
+
+std::string generate_hsaco(llvm::Module *module, const std::string &triple,
+                           const std::string &proc,
+                           const std::string &features) {
+  auto machine = initialize_module(module, triple, proc, features);
+
+  // emit the GCN ISA binary
+  llvm::SmallVector<char, 0> buffer;
+  llvm::raw_svector_ostream stream(buffer);
+  llvm::legacy::PassManager pass;
+  machine->addPassesToEmitFile(pass, stream, nullptr, llvm::CGFT_ObjectFile);
+  pass.run(*module);
 
-  return hsaco_path;
+  return link_hsaco(llvm::StringRef(buffer.data(), buffer.size()));
 }
 
 std::tuple<std::string, std::string>
@@ -161,10 +205,10 @@ llir_to_amdgcn_and_hsaco(llvm::Module *module, std::string gfx_arch,
   auto module_obj = llvm::CloneModule(*module);
   auto amdgcn =
       generate_amdgcn_assembly(module, gfx_triple, gfx_arch, gfx_features);
-  auto hsaco_path =
+  auto hsaco =
       generate_hsaco(module_obj.get(), gfx_triple, gfx_arch, gfx_features);
 
-  return std::make_tuple(amdgcn, hsaco_path);
+  return std::make_tuple(amdgcn, hsaco);
 }
 
 } // namespace
@@ -1,18 +1,22 @@
 #include "triton/Target/PTX/PTXTranslation.h"
 #include "triton/Target/LLVMIR/LLVMIRTranslation.h"
 
+#include "llvm/IR/Constants.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/MC/TargetRegistry.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/CodeGen.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Target/TargetMachine.h"
 
 #include <mutex>
 #include <optional>
+#include <vector>
 
 namespace triton {
 
@@ -23,6 +27,13 @@ static void initLLVM() {
     LLVMInitializeNVPTXTarget();
     LLVMInitializeNVPTXTargetMC();
     LLVMInitializeNVPTXAsmPrinter();
+    // Options are global: set them once rather than on every translation,
+    // which may run concurrently.
+    auto options = llvm::cl::getRegisteredOptions();
+    auto *shortPtr =
+        static_cast<llvm::cl::opt<bool> *>(options["nvptx-short-ptr"]);
+    assert(shortPtr);
+    shortPtr->setValue(true);
   });
 }
 
@@ -38,18 +49,52 @@ static bool findAndReplace(std::string &str, const std::string &begin,
   return true;
 }
 
-std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version) {
+// Annotates the kernels with the register and block bounds that
+// `__launch_bounds__` and `-maxrregcount` give CUDA kernels. The NVPTX
+// backend turns them into the `.maxnreg` and `.minnctapersm` directives.
+static void addLaunchBounds(llvm::Module &module, int maxNReg,
+                            int minBlocksPerSM) {
+  llvm::NamedMDNode *annotations =
+      module.getNamedMetadata("nvvm.annotations");
+  if (!annotations)
+    return;
+  std::vector<llvm::Function *> kernels;
+  for (llvm::MDNode *node : annotations->operands()) {
+    if (node->getNumOperands() < 2)
+      continue;
+    auto *key = llvm::dyn_cast<llvm::MDString>(node->getOperand(1));
+    if (!key || key->getString() != "kernel")
+      continue;
+    auto *value =
+        llvm::dyn_cast_or_null<llvm::ValueAsMetadata>(node->getOperand(0));
+    if (auto *func = value ? llvm::dyn_cast<llvm::Function>(value->getValue())
+                           : nullptr)
+      kernels.push_back(func);
+  }
+  auto &ctx = module.getContext();
+  auto annotate = [&](llvm::Function *func, llvm::StringRef key, int value) {
+    llvm::Metadata *args[] = {
+        llvm::ValueAsMetadata::get(func), llvm::MDString::get(ctx, key),
+        llvm::ValueAsMetadata::get(
+            llvm::ConstantInt::get(llvm::Type::getInt32Ty(ctx), value))};
+    annotations->addOperand(llvm::MDNode::get(ctx, args));
+  };
+  for (llvm::Function *func : kernels) {
+    if (maxNReg > 0)
+      annotate(func, "maxnreg", maxNReg);
+    if (minBlocksPerSM > 0)
+      annotate(func, "minctasm", minBlocksPerSM);
+  }
+}
+
+std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version,
+                                 int optLevel, int maxNReg,
+                                 int minBlocksPerSM) {
   // LLVM version in use may not officially support target hardware.
   // Supported versions for LLVM 14 are here:
   // https://github.com/llvm/llvm-project/blob/f28c006a5895fc0e329fe15fead81e37457cb1d1/clang/include/clang/Basic/BuiltinsNVPTX.def
   int maxPTX = std::min(80, version);
   int maxCC = std::min(90, cc);
-  // options
-  auto options = llvm::cl::getRegisteredOptions();
-  auto *shortPtr =
-      static_cast<llvm::cl::opt<bool> *>(options["nvptx-short-ptr"]);
-  assert(shortPtr);
-  shortPtr->setValue(true);
   std::string sm = cc == 90 ? "sm_90a" : "sm_" + std::to_string(cc);
   // max PTX version
   int ptxMajor = maxPTX / 10;
@@ -66,6 +111,7 @@ std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version) {
   pm.add(llvm::createVerifierPass());
   pm.run(module);
   // module->print(llvm::outs(), nullptr);
+  addLaunchBounds(module, maxNReg, minBlocksPerSM);
 
   // create machine
   module.setTargetTriple(triple);
@@ -77,9 +123,11 @@ std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version) {
   opt.UnsafeFPMath = false;
   opt.NoInfsFPMath = false;
   opt.NoNaNsFPMath = true;
+  auto codeGenOptLevel = llvm::CodeGenOpt::getLevel(optLevel);
+  assert(codeGenOptLevel && "invalid optimization level");
   llvm::TargetMachine *machine = target->createTargetMachine(
       module.getTargetTriple(), proc, features, opt, llvm::Reloc::PIC_,
-      std::nullopt, llvm::CodeGenOpt::Aggressive);
+      std::nullopt, *codeGenOptLevel);
   // set data layout
   if (layout.empty())
     module.setDataLayout(machine->createDataLayout());
@@ -121,12 +121,25 @@ def download_and_copy_ptxas():
             curr_version = subprocess.check_output([dst_path, "--version"]).decode("utf-8").strip()
             curr_version = re.search(r"V([.|\d]+)", curr_version).group(1)
             download = curr_version != version
+    # The in-process PTX compiler ships in the same package as ptxas
+    lib_paths = []
+    if check_env_flag("TRITON_BUILD_WITH_NVPTXCOMPILER"):
+        lib_paths = ["include/nvPTXCompiler.h", "lib/libnvptxcompiler_static.a"]
+    cuda_dir = os.path.join(dst_prefix, "third_party", "cuda")
+    if is_linux and any(not os.path.exists(os.path.join(cuda_dir, p)) for p in lib_paths):
+        download = True
     if download:
         print(f'downloading and extracting {url} ...')
         ftpstream = urllib.request.urlopen(url)
         file = tarfile.open(fileobj=ftpstream, mode="r|*")
         with tempfile.TemporaryDirectory() as temp_dir:
             file.extractall(path=temp_dir)
+            for path in lib_paths:
+                src = os.path.join(temp_dir, path)
+                if os.path.exists(src):
+                    dst = os.path.join(cuda_dir, path)
+                    os.makedirs(os.path.split(dst)[0], exist_ok=True)
+                    shutil.copy(src, dst)
             src_path = os.path.join(temp_dir, src_path)
             os.makedirs(os.path.split(dst_path)[0], exist_ok=True)
             shutil.copy(src_path, dst_path)
@@ -204,6 +217,8 @@ class CMakeBuild(build_ext):
         ]
         if lit_dir is not None:
             cmake_args.append("-DLLVM_EXTERNAL_LIT=" + lit_dir)
+        if check_env_flag("TRITON_BUILD_WITH_NVPTXCOMPILER"):
+            cmake_args.append("-DTRITON_USE_NVPTXCOMPILER=ON")
         cmake_args.extend(thirdparty_cmake_args)
 
         # configuration
@@ -9,6 +9,11 @@ define i64 @globaltimer() #0 {
   ret i64 %1
 }
 
+define i64 @clock64() #0 {
+  %1 = call i64 asm sideeffect "mov.u64 $0, %clock64;", "=l"() nounwind
+  ret i64 %1
+}
+
 define i32 @smid() #0 {
   %1 = call i32 asm "mov.u32 $0, %smid;", "=r"() nounwind
   ret i32 %1
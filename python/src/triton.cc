@@ -1,10 +1,12 @@
 ﻿#include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/IR/Verifier.h"
 
 #include "mlir/Conversion/Passes.h"
 #include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassInstrumentation.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Transforms/Passes.h"
 
@@ -17,11 +19,13 @@
 #include "mlir/Dialect/Index/IR/IndexOps.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "triton/Analysis/Allocation.h"
+#include "triton/Analysis/RegisterUsage.h"
 #include "triton/Conversion/TritonGPUToLLVM/TritonGPUToLLVMPass.h"
 #include "triton/Conversion/TritonToTritonGPU/TritonToTritonGPUPass.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/Triton/IR/Types.h"
 #include "triton/Dialect/Triton/Transforms/Passes.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
 #include "triton/Target/HSACO/HSACOTranslation.h"
 #include "triton/Target/LLVMIR/LLVMIRTranslation.h"
@@ -38,9 +42,16 @@
 
 #include "llvm/Support/SourceMgr.h"
 
+#ifdef TRITON_USE_NVPTXCOMPILER
+#include <nvPTXCompiler.h>
+#endif
+
 #include <Python.h>
 #include <cctype>
+#include <chrono>
 #include <fstream>
+#include <map>
+#include <mutex>
 #include <optional>
 #include <pybind11/buffer_info.h>
 #include <pybind11/functional.h>
@@ -61,6 +72,265 @@ enum backend_t {
   ROCM,
 };
 
+/*****************************************************************************/
+/* Launch fast path of JITFunction.run                                       */
+/*****************************************************************************/
+
+// How the key of an argument is computed, derived from its annotation.
+enum arg_kind_t {
+  ANY,    // no annotation
+  TENSOR, // annotation containing `Tensor`
+  BOOL,
+  FLOAT,
+  INT,
+  OTHER, // any other annotation
+};
+
+// Computes the cache key of a JITFunction launch the same way the Python
+// launcher used to, looks it up in the kernel cache and, on a hit, calls the
+// launcher stub of the compiled kernel directly.
+class JITDispatcher {
+public:
+  JITDispatcher(py::object versionKey, std::vector<bool> isConstexpr,
+                std::vector<arg_kind_t> argKinds,
+                std::vector<bool> specialize, int64_t divisibility)
+      : versionKey(versionKey), isConstexpr(std::move(isConstexpr)),
+        argKinds(std::move(argKinds)), specialize(std::move(specialize)),
+        divisibility(divisibility) {
+    for (bool constexprArg : this->isConstexpr)
+      numRegularArgs += !constexprArg;
+    assert(this->argKinds.size() == numRegularArgs);
+    assert(this->specialize.size() == numRegularArgs);
+  }
+
+  // Returns the cache key of a launch with the given arguments, in the order
+  // of the signature of the JIT function.
+  py::object getKey(py::object numWarps, py::object numStages,
+                    py::object debug, py::object externLibs,
+                    py::args args) {
+    checkNumArgs(args);
+    size_t numSpecialized =
+        std::count(specialize.begin(), specialize.end(), true);
+    py::tuple sigKey(numRegularArgs);
+    py::tuple constexprKey(args.size() - numRegularArgs);
+    py::tuple specKey(numSpecialized);
+    size_t regularIdx = 0, constexprIdx = 0, specIdx = 0;
+    for (size_t i = 0; i < args.size(); ++i) {
+      py::handle arg = PyTuple_GET_ITEM(args.ptr(), i);
+      if (isConstexpr[i]) {
+        constexprKey[constexprIdx++] = arg;
+        continue;
+      }
+      auto kind = argKinds[regularIdx];
+      sigKey[regularIdx] = getSigKey(arg, kind);
+      if (specialize[regularIdx])
+        specKey[specIdx++] = getSpecKey(arg, kind);
+      ++regularIdx;
+    }
+    py::object key = py::make_tuple(versionKey, sigKey, constexprKey, specKey,
+                                    numWarps, numStages, debug);
+    if (!externLibs.is_none())
+      key = py::make_tuple(key, py::tuple(externLibs.attr("items")()));
+    return key;
+  }
+
+  // Launches the cached kernel matching the arguments on `device` and returns
+  // it, or returns None when the kernel has not been compiled yet.
+  py::object launch(py::dict cache, py::object device, py::object numWarps,
+                    py::object numStages, py::object debug,
+                    py::object externLibs, py::object gridX, py::object gridY,
+                    py::object gridZ, py::object stream, bool warmup,
+                    py::object enterHook, py::object exitHook,
+                    py::args args) {
+    auto key = getKey(numWarps, numStages, debug, externLibs, args);
+    PyObject *bin = PyDict_GetItemWithError(cache.ptr(), key.ptr());
+    if (!bin) {
+      if (PyErr_Occurred())
+        throw py::error_already_set();
+      return py::none();
+    }
+    auto kernel = py::reinterpret_borrow<py::object>(bin);
+    if (warmup)
+      return kernel;
+    py::object resident = kernel.attr(residentModulesStr);
+    if (!resident.attr(maxBytesStr).is_none()) {
+      // With a bound on the resident modules, the kernel pins its module for
+      // the launch: _run(device, grid_0, grid_1, grid_2, stream,
+      //                  *regular_args)
+      py::object run = kernel.attr(runStr);
+      llvm::SmallVector<PyObject *, 32> runArgs = {
+          device.ptr(), gridX.ptr(), gridY.ptr(), gridZ.ptr(), stream.ptr()};
+      appendRegularArgs(args, runArgs);
+      call(run, runArgs);
+      return kernel;
+    }
+    py::object kernelNumWarps = kernel.attr(numWarpsStr);
+    py::object shared = kernel.attr(sharedStr);
+    py::object function = getFunction(kernel, device);
+    py::object cWrapper = kernel.attr(cWrapperStr);
+    // c_wrapper(grid_0, grid_1, grid_2, num_warps, shared, stream, function,
+    //           enter_hook, exit_hook, kernel, *regular_args), called
+    //           without packing the arguments into a tuple
+    llvm::SmallVector<PyObject *, 32> launchArgs = {
+        gridX.ptr(),    gridY.ptr(),     gridZ.ptr(),    kernelNumWarps.ptr(),
+        shared.ptr(),   stream.ptr(),    function.ptr(), enterHook.ptr(),
+        exitHook.ptr(), kernel.ptr()};
+    appendRegularArgs(args, launchArgs);
+    call(cWrapper, launchArgs);
+    return kernel;
+  }
+
+private:
+  static PyObject *vectorcall(PyObject *callable, PyObject *const *args,
+                              size_t nargs) {
+#if PY_VERSION_HEX >= 0x03090000
+    return PyObject_Vectorcall(callable, args, nargs, nullptr);
+#elif PY_VERSION_HEX >= 0x03080000
+    return _PyObject_Vectorcall(callable, args, nargs, nullptr);
+#else
+    return _PyObject_FastCall(callable, const_cast<PyObject **>(args),
+                              nargs);
+#endif
+  }
+
+  // Calls `callable` without packing the arguments into a tuple
+  static void call(py::handle callable,
+                   const llvm::SmallVectorImpl<PyObject *> &callArgs) {
+    PyObject *ret =
+        vectorcall(callable.ptr(), callArgs.data(), callArgs.size());
+    if (!ret)
+      throw py::error_already_set();
+    Py_DECREF(ret);
+  }
+
+  void appendRegularArgs(const py::args &args,
+                         llvm::SmallVectorImpl<PyObject *> &callArgs) const {
+    for (size_t i = 0; i < args.size(); ++i) {
+      if (!isConstexpr[i])
+        callArgs.push_back(PyTuple_GET_ITEM(args.ptr(), i));
+    }
+  }
+
+  // The function of the kernel on `device`, read from the handle table of the
+  // kernel once it is loaded. Without a bound on the resident modules, the
+  // handles of a kernel are never unloaded.
+  py::object getFunction(py::handle kernel, py::handle device) const {
+    py::object handles = kernel.attr(handlesStr);
+    PyObject *entry = PyDict_GetItemWithError(handles.ptr(), device.ptr());
+    if (entry)
+      return py::reinterpret_borrow<py::object>(PyTuple_GET_ITEM(entry, 1));
+    if (PyErr_Occurred())
+      throw py::error_already_set();
+    py::tuple loaded = kernel.attr(initHandlesStr)(device);
+    return loaded[1];
+  }
+
+  void checkNumArgs(const py::args &args) const {
+    if (args.size() != isConstexpr.size())
+      throw py::type_error("expected " + std::to_string(isConstexpr.size()) +
+                           " arguments, got " + std::to_string(args.size()));
+  }
+
+  // Mirrors JITFunction._key_of
+  py::object getSigKey(py::handle arg, arg_kind_t kind) const {
+    if (kind == TENSOR)
+      return arg.attr("dtype");
+    if (kind == BOOL)
+      return i1Str;
+    if (kind == FLOAT)
+      return fp32Str;
+    if (py::hasattr(arg, "dtype"))
+      return arg.attr("dtype");
+    if (PyBool_Check(arg.ptr()))
+      return i1Str;
+    if (PyLong_Check(arg.ptr())) {
+      int overflow = 0;
+      long long value = PyLong_AsLongLongAndOverflow(arg.ptr(), &overflow);
+      if (overflow == 0 && value >= std::numeric_limits<int32_t>::min() &&
+          value <= std::numeric_limits<int32_t>::max())
+        return i32Str;
+      if (overflow > 0) {
+        // [2**63, 2**64 - 1] is the only range that doesn't fit in i64
+        PyLong_AsUnsignedLongLong(arg.ptr());
+        if (!PyErr_Occurred())
+          return u64Str;
+        PyErr_Clear();
+      }
+      return i64Str;
+    }
+    if (PyFloat_Check(arg.ptr()))
+      return fp32Str;
+    if (py::hasattr(arg, "param_type"))
+      return arg.attr("param_type");
+    if (arg.is_none())
+      return py::none();
+    throw py::type_error("Unsupported type " +
+                         py::str(arg.get_type()).cast<std::string>() + " for " +
+                         py::str(arg).cast<std::string>());
+  }
+
+  // Mirrors the specialization keys of JITFunction._spec_of
+  py::object getSpecKey(py::handle arg, arg_kind_t kind) const {
+    if (kind == TENSOR)
+      return py::bool_(isDivisible(arg.attr("data_ptr")()));
+    if (kind == INT)
+      return getIntSpecKey(arg);
+    if (kind == ANY) {
+      if (py::hasattr(arg, "data_ptr"))
+        return py::bool_(isDivisible(arg.attr("data_ptr")()));
+      if (PyLong_Check(arg.ptr()))
+        return getIntSpecKey(arg);
+    }
+    return py::make_tuple(false);
+  }
+
+  py::object getIntSpecKey(py::handle arg) const {
+    int overflow = 0;
+    if (PyLong_Check(arg.ptr())) {
+      long long value = PyLong_AsLongLongAndOverflow(arg.ptr(), &overflow);
+      if (overflow == 0)
+        return py::make_tuple(value % divisibility == 0, value == 1);
+    }
+    return py::make_tuple(isDivisible(arg), arg.equal(py::int_(1)));
+  }
+
+  bool isDivisible(py::handle value) const {
+    int overflow = 0;
+    if (PyLong_Check(value.ptr())) {
+      long long v = PyLong_AsLongLongAndOverflow(value.ptr(), &overflow);
+      if (overflow == 0)
+        return v % divisibility == 0;
+    }
+    auto remainder = py::reinterpret_steal<py::object>(
+        PyNumber_Remainder(value.ptr(), py::int_(divisibility).ptr()));
+    if (!remainder)
+      throw py::error_already_set();
+    return remainder.equal(py::int_(0));
+  }
+
+  py::object versionKey;
+  std::vector<bool> isConstexpr;
+  std::vector<arg_kind_t> argKinds;
+  std::vector<bool> specialize;
+  int64_t divisibility;
+  size_t numRegularArgs = 0;
+
+  py::str i1Str = py::str("i1");
+  py::str i32Str = py::str("i32");
+  py::str i64Str = py::str("i64");
+  py::str u64Str = py::str("u64");
+  py::str fp32Str = py::str("fp32");
+  // the attributes of CompiledKernel read by every launch
+  py::str numWarpsStr = py::str("num_warps");
+  py::str sharedStr = py::str("shared");
+  py::str cWrapperStr = py::str("c_wrapper");
+  py::str handlesStr = py::str("_handles");
+  py::str initHandlesStr = py::str("_init_handles");
+  py::str runStr = py::str("_run");
+  py::str residentModulesStr = py::str("resident_modules");
+  py::str maxBytesStr = py::str("max_bytes");
+};
+
 void init_triton_runtime(py::module &&m) {
   // wrap backend_t
   py::enum_<backend_t>(m, "backend")
@@ -68,12 +338,189 @@ void init_triton_runtime(py::module &&m) {
       .value("CUDA", CUDA)
       .value("ROCM", ROCM)
       .export_values();
+
+  py::enum_<arg_kind_t>(m, "arg_kind")
+      .value("ANY", ANY)
+      .value("TENSOR", TENSOR)
+      .value("BOOL", BOOL)
+      .value("FLOAT", FLOAT)
+      .value("INT", INT)
+      .value("OTHER", OTHER)
+      .export_values();
+
+  py::class_<JITDispatcher>(m, "dispatcher")
+      .def(py::init<py::object, std::vector<bool>, std::vector<arg_kind_t>,
+                    std::vector<bool>, int64_t>())
+      .def("key", &JITDispatcher::getKey)
+      .def("launch", &JITDispatcher::launch);
 }
 
 /*****************************************************************************/
 /* Python bindings for triton::ir                                            */
 /*****************************************************************************/
 
+// Accumulates the wall time of the passes of a pass manager by pass name. The
+// passes nested under a pass manager may run on several threads.
+class PassTimer : public mlir::PassInstrumentation {
+public:
+  using Seconds = std::chrono::duration<double>;
+
+  void runBeforePass(mlir::Pass *pass, mlir::Operation *op) override {
+    std::lock_guard<std::mutex> lock(mutex);
+    starts[{pass, op}] = std::chrono::steady_clock::now();
+  }
+
+  void runAfterPass(mlir::Pass *pass, mlir::Operation *op) override {
+    auto end = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = starts.find({pass, op});
+    if (it == starts.end())
+      return;
+    times[pass->getName().str()] += Seconds(end - it->second).count();
+    starts.erase(it);
+  }
+
+  void runAfterPassFailed(mlir::Pass *pass, mlir::Operation *op) override {
+    runAfterPass(pass, op);
+  }
+
+  std::map<std::string, double> getTimes() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return times;
+  }
+
+  void reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    times.clear();
+  }
+
+private:
+  std::mutex mutex;
+  std::map<std::pair<mlir::Pass *, mlir::Operation *>,
+           std::chrono::steady_clock::time_point>
+      starts;
+  std::map<std::string, double> times;
+};
+
+// The pass manager owns its instrumentations; Python reads the times through
+// this handle.
+struct PassTimerHandle {
+  PassTimer *timer;
+};
+
+// The builder of the code generator, which creates the ops at the location
+// of the AST node being visited
+class TritonOpBuilder : public mlir::OpBuilder {
+public:
+  explicit TritonOpBuilder(mlir::MLIRContext *context)
+      : mlir::OpBuilder(context), lastLoc(getUnknownLoc()) {}
+
+  mlir::Location getLastLoc() const { return lastLoc; }
+
+  void setLastLoc(mlir::Location loc) { lastLoc = loc; }
+
+private:
+  mlir::Location lastLoc;
+};
+
+// Sets the memory ordering of a load, store or atomic, when it has one.
+static void setMemOrdering(mlir::Operation *op,
+                           std::optional<mlir::triton::MemSemantic> sem,
+                           std::optional<mlir::triton::MemSyncScope> scope) {
+  mlir::MLIRContext *ctx = op->getContext();
+  if (sem)
+    op->setAttr("sem", mlir::triton::MemSemanticAttr::get(ctx, *sem));
+  if (scope)
+    op->setAttr("scope", mlir::triton::MemSyncScopeAttr::get(ctx, *scope));
+}
+
+// Loads the dialects of all the stages of the compiler, so that passes don't
+// load any while they run.
+static void loadCompilerDialects(mlir::MLIRContext &context) {
+  // note: we initialize llvm for undef
+  mlir::DialectRegistry registry;
+  registry.insert<mlir::triton::TritonDialect,
+                  mlir::triton::gpu::TritonGPUDialect, mlir::math::MathDialect,
+                  mlir::arith::ArithDialect, mlir::index::IndexDialect,
+                  mlir::scf::SCFDialect, mlir::cf::ControlFlowDialect,
+                  mlir::gpu::GPUDialect, mlir::LLVM::LLVMDialect>();
+  context.appendDialectRegistry(registry);
+  context.loadAllAvailableDialects();
+}
+
+// Contexts with the dialects of the compiler loaded, reused across
+// compilations. A context is acquired by one compilation at a time, which
+// also reuses the pass managers built for the context, keyed by the
+// configuration of their pipeline. The modules created in a context are
+// owned by the pool and erased when the context is released, so no IR of a
+// compilation outlives it. The contexts are never destroyed.
+class ContextPool {
+public:
+  struct PassManagerEntry {
+    std::unique_ptr<mlir::PassManager> passManager;
+    PassTimer *timer;
+  };
+
+  static ContextPool &get() {
+    static ContextPool *pool = new ContextPool();
+    return *pool;
+  }
+
+  mlir::MLIRContext *acquire() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!idle.empty()) {
+      mlir::MLIRContext *context = idle.back();
+      idle.pop_back();
+      return context;
+    }
+    auto context = std::make_unique<mlir::MLIRContext>();
+    loadCompilerDialects(*context);
+    mlir::MLIRContext *ret = context.get();
+    contexts[ret].context = std::move(context);
+    return ret;
+  }
+
+  void release(mlir::MLIRContext *context) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = contexts.find(context);
+    assert(it != contexts.end() && "the context isn't pooled");
+    for (mlir::Operation *module : it->second.modules)
+      module->erase();
+    it->second.modules.clear();
+    idle.push_back(context);
+  }
+
+  // Hands a detached module to the pool if its context is pooled.
+  mlir::ModuleOp own(mlir::ModuleOp module) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = contexts.find(module.getContext());
+    if (it != contexts.end())
+      it->second.modules.push_back(module.getOperation());
+    return module;
+  }
+
+  // Returns the pass manager of `key` for a pooled context, or null.
+  PassManagerEntry *lookup(mlir::MLIRContext *context,
+                           const std::string &key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = contexts.find(context);
+    if (it == contexts.end())
+      return nullptr;
+    return &it->second.passManagers[key];
+  }
+
+private:
+  struct ContextEntry {
+    std::unique_ptr<mlir::MLIRContext> context;
+    std::map<std::string, PassManagerEntry> passManagers;
+    std::vector<mlir::Operation *> modules;
+  };
+
+  std::mutex mutex;
+  std::map<mlir::MLIRContext *, ContextEntry> contexts;
+  std::vector<mlir::MLIRContext *> idle;
+};
+
 void init_triton_ir(py::module &&m) {
   using ret = py::return_value_policy;
   using namespace pybind11::literals;
@@ -87,12 +534,18 @@ void init_triton_ir(py::module &&m) {
       .value("NONE", mlir::triton::CacheModifier::NONE)
       .value("CA", mlir::triton::CacheModifier::CA)
       .value("CG", mlir::triton::CacheModifier::CG)
+      .value("WB", mlir::triton::CacheModifier::WB)
+      .value("CS", mlir::triton::CacheModifier::CS)
+      .value("WT", mlir::triton::CacheModifier::WT)
       .export_values();
 
   py::enum_<mlir::triton::EvictionPolicy>(m, "EVICTION_POLICY")
       .value("NORMAL", mlir::triton::EvictionPolicy::NORMAL)
       .value("EVICT_FIRST", mlir::triton::EvictionPolicy::EVICT_FIRST)
       .value("EVICT_LAST", mlir::triton::EvictionPolicy::EVICT_LAST)
+      .value("L2_EVICT_FIRST", mlir::triton::EvictionPolicy::L2_EVICT_FIRST)
+      .value("L2_EVICT_LAST", mlir::triton::EvictionPolicy::L2_EVICT_LAST)
+      .value("NO_ALLOCATE", mlir::triton::EvictionPolicy::NO_ALLOCATE)
       .export_values();
 
   py::enum_<mlir::triton::RMWOp>(m, "ATOMIC_OP")
@@ -107,6 +560,19 @@ void init_triton_ir(py::module &&m) {
       .value("UMIN", mlir::triton::RMWOp::UMIN)
       .value("UMAX", mlir::triton::RMWOp::UMAX);
 
+  py::enum_<mlir::triton::MemSemantic>(m, "MEM_SEMANTIC")
+      .value("RELAXED", mlir::triton::MemSemantic::RELAXED)
+      .value("ACQUIRE", mlir::triton::MemSemantic::ACQUIRE)
+      .value("RELEASE", mlir::triton::MemSemantic::RELEASE)
+      .value("ACQUIRE_RELEASE", mlir::triton::MemSemantic::ACQUIRE_RELEASE)
+      .export_values();
+
+  py::enum_<mlir::triton::MemSyncScope>(m, "MEM_SYNC_SCOPE")
+      .value("GPU", mlir::triton::MemSyncScope::GPU)
+      .value("CTA", mlir::triton::MemSyncScope::CTA)
+      .value("SYSTEM", mlir::triton::MemSyncScope::SYSTEM)
+      .export_values();
+
   py::class_<mlir::MLIRContext>(m, "context")
       .def(py::init<>())
       .def("load_triton", [](mlir::MLIRContext &self) {
@@ -118,6 +584,14 @@ void init_triton_ir(py::module &&m) {
         // some placeholders
         self.getOrLoadDialect<mlir::LLVM::LLVMDialect>();
       });
+  m.def(
+      "acquire_context",
+      []() -> mlir::MLIRContext * { return ContextPool::get().acquire(); },
+      ret::reference);
+  m.def("release_context", [](mlir::MLIRContext *context) {
+    ContextPool::get().release(context);
+  });
+
   // .def(py::init([](){
   //   mlir::MLIRContext context;
   //   context.getOrLoadDialect<mlir::triton.TritonDialect>();
@@ -363,6 +837,12 @@ void init_triton_ir(py::module &&m) {
               std::string &funcName) -> mlir::triton::FuncOp {
              return self.lookupSymbol<mlir::triton::FuncOp>(funcName);
            })
+      .def(
+          "clone",
+          [](mlir::ModuleOp &self) {
+            return ContextPool::get().own(self.clone());
+          },
+          ret::take_ownership)
       .def("get_single_function",
            [](mlir::ModuleOp &self) -> mlir::triton::FuncOp {
              llvm::SmallVector<mlir::triton::FuncOp> funcs;
@@ -371,6 +851,55 @@ void init_triton_ir(py::module &&m) {
              if (funcs.size() != 1)
                throw std::runtime_error("Expected a single function");
              return funcs[0];
+           })
+      // Returns the function `funcName` and the functions it calls,
+      // transitively, as the source of a module of their own, canonicalized
+      // and with their locations, and their names.
+      .def("extract_functions",
+           [](mlir::ModuleOp &self, const std::string &funcName)
+               -> std::pair<std::string, std::vector<std::string>> {
+             mlir::OpBuilder builder(self.getContext());
+             mlir::OwningOpRef<mlir::ModuleOp> callees =
+                 mlir::ModuleOp::create(self.getLoc());
+             builder.setInsertionPointToEnd(callees->getBody());
+             std::vector<std::string> names{funcName};
+             for (size_t i = 0; i < names.size(); ++i) {
+               auto func = self.lookupSymbol<mlir::triton::FuncOp>(names[i]);
+               if (!func)
+                 throw std::runtime_error("Unknown function " + names[i]);
+               builder.clone(*func.getOperation());
+               func.walk([&](mlir::triton::CallOp call) {
+                 std::string callee = call.getCallee().str();
+                 if (llvm::find(names, callee) == names.end())
+                   names.push_back(callee);
+               });
+             }
+             mlir::PassManager pm(self.getContext());
+             pm.addPass(mlir::createCanonicalizerPass());
+             pm.addPass(mlir::createCSEPass());
+             if (failed(pm.run(callees.get())))
+               throw std::runtime_error("Failed to canonicalize " + funcName);
+             std::string src;
+             llvm::raw_string_ostream os(src);
+             callees->print(os, mlir::OpPrintingFlags().enableDebugInfo());
+             return {os.str(), names};
+           })
+      // Moves the functions of the module source `src` that this module does
+      // not define yet, e.g. from extract_functions, into this module.
+      .def("splice_functions",
+           [](mlir::ModuleOp &self, const std::string &src) -> void {
+             mlir::OwningOpRef<mlir::ModuleOp> callees =
+                 mlir::parseSourceString<mlir::ModuleOp>(src,
+                                                         self.getContext());
+             if (!callees)
+               throw std::runtime_error("Failed to parse the functions");
+             for (auto func : llvm::make_early_inc_range(
+                      callees->getOps<mlir::triton::FuncOp>())) {
+               if (self.lookupSymbol(func.getName()))
+                 continue;
+               func->remove();
+               self.push_back(func);
+             }
            });
 
   m.def("make_attr",
@@ -386,16 +915,7 @@ void init_triton_ir(py::module &&m) {
   m.def(
       "parse_mlir_module",
       [](const std::string &inputFilename, mlir::MLIRContext &context) {
-        // initialize registry
-        // note: we initialize llvm for undef
-        mlir::DialectRegistry registry;
-        registry.insert<
-            mlir::triton::TritonDialect, mlir::triton::gpu::TritonGPUDialect,
-            mlir::math::MathDialect, mlir::arith::ArithDialect,
-            mlir::index::IndexDialect, mlir::scf::SCFDialect,
-            mlir::cf::ControlFlowDialect, mlir::LLVM::LLVMDialect>();
-        context.appendDialectRegistry(registry);
-        context.loadAllAvailableDialects();
+        loadCompilerDialects(context);
 
         // parse module
         mlir::OwningOpRef<mlir::ModuleOp> module =
@@ -407,7 +927,7 @@ void init_triton_ir(py::module &&m) {
           op->setLoc(mlir::UnknownLoc::get(op->getContext()));
         });
 
-        return module->clone();
+        return ContextPool::get().own(module->clone());
       },
       ret::take_ownership);
 
@@ -457,44 +977,55 @@ void init_triton_ir(py::module &&m) {
 
   py::class_<mlir::OpBuilder::InsertPoint>(m, "InsertPoint");
 
-  py::class_<mlir::OpBuilder>(m, "builder", py::dynamic_attr())
+  py::class_<TritonOpBuilder>(m, "builder", py::dynamic_attr())
       .def(py::init<mlir::MLIRContext *>())
       // // getters
       .def_property_readonly("context", &mlir::OpBuilder::getContext,
                              ret::reference)
+      // locations
+      .def("set_loc",
+           [](TritonOpBuilder &self, const std::string &fileName, int line,
+              int column) {
+             self.setLastLoc(mlir::FileLineColLoc::get(
+                 self.getContext(), fileName, line, column));
+           })
+      .def("set_unknown_loc",
+           [](TritonOpBuilder &self) {
+             self.setLastLoc(self.getUnknownLoc());
+           })
       .def("create_module",
-           [](mlir::OpBuilder &self) -> mlir::ModuleOp {
-             auto loc = self.getUnknownLoc();
-             return self.create<mlir::ModuleOp>(loc);
+           [](TritonOpBuilder &self) -> mlir::ModuleOp {
+             auto loc = self.getLastLoc();
+             return ContextPool::get().own(self.create<mlir::ModuleOp>(loc));
            })
       .def("ret",
-           [](mlir::OpBuilder &self, std::vector<mlir::Value> &vals) -> void {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, std::vector<mlir::Value> &vals) -> void {
+             auto loc = self.getLastLoc();
              self.create<mlir::triton::ReturnOp>(loc, vals);
            })
       .def("call",
-           [](mlir::OpBuilder &self, mlir::triton::FuncOp &func,
+           [](TritonOpBuilder &self, mlir::triton::FuncOp &func,
               std::vector<mlir::Value> &args) -> mlir::OpState {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              auto callOp = self.create<mlir::triton::CallOp>(loc, func, args);
              return callOp;
            })
       // insertion block/point
       .def("set_insertion_point_to_start",
-           [](mlir::OpBuilder &self, mlir::Block &block) -> void {
+           [](TritonOpBuilder &self, mlir::Block &block) -> void {
              self.setInsertionPointToStart(&block);
            })
       .def("set_insertion_point_to_end",
-           [](mlir::OpBuilder &self, mlir::Block &block) {
+           [](TritonOpBuilder &self, mlir::Block &block) {
              self.setInsertionPointToEnd(&block);
            })
       .def("set_insertion_point_after",
-           [](mlir::OpBuilder &self, mlir::Operation &op) {
+           [](TritonOpBuilder &self, mlir::Operation &op) {
              self.setInsertionPointAfter(&op);
            })
       .def(
           "get_insertion_block",
-          [](mlir::OpBuilder &self) -> mlir::Block * {
+          [](TritonOpBuilder &self) -> mlir::Block * {
             return self.getInsertionBlock();
           },
           ret::reference)
@@ -520,38 +1051,38 @@ void init_triton_ir(py::module &&m) {
       // Use arith.ConstantOp to create constants
       // Constants
       .def("get_int1",
-           [](mlir::OpBuilder &self, bool v) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, bool v) -> mlir::Value {
+             auto loc = self.getLastLoc();
              return mlir::Value(self.create<mlir::arith::ConstantIntOp>(
                  loc, v, self.getI1Type()));
            })
       .def("get_int8",
-           [](mlir::OpBuilder &self, int64_t v) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, int64_t v) -> mlir::Value {
+             auto loc = self.getLastLoc();
              return mlir::Value(self.create<mlir::arith::ConstantIntOp>(
                  loc, v, self.getI8Type()));
            })
       .def("get_int16",
-           [](mlir::OpBuilder &self, int64_t v) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, int64_t v) -> mlir::Value {
+             auto loc = self.getLastLoc();
              return mlir::Value(self.create<mlir::arith::ConstantIntOp>(
                  loc, v, self.getI16Type()));
            })
       .def("get_int32",
-           [](mlir::OpBuilder &self, int64_t v) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, int64_t v) -> mlir::Value {
+             auto loc = self.getLastLoc();
              return mlir::Value(self.create<mlir::arith::ConstantIntOp>(
                  loc, v, self.getI32Type()));
            })
       .def("get_int64",
-           [](mlir::OpBuilder &self, int64_t v) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, int64_t v) -> mlir::Value {
+             auto loc = self.getLastLoc();
              return mlir::Value(self.create<mlir::arith::ConstantIntOp>(
                  loc, v, self.getI64Type()));
            })
       .def("get_bf16",
-           [](mlir::OpBuilder &self, float v) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, float v) -> mlir::Value {
+             auto loc = self.getLastLoc();
              auto type = self.getBF16Type();
              return self.create<mlir::arith::ConstantFloatOp>(
                  loc,
@@ -559,26 +1090,26 @@ void init_triton_ir(py::module &&m) {
                  type);
            })
       .def("get_fp16",
-           [](mlir::OpBuilder &self, float v) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, float v) -> mlir::Value {
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::ConstantOp>(
                  loc, self.getF16FloatAttr(v));
            })
       .def("get_fp32",
-           [](mlir::OpBuilder &self, float v) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, float v) -> mlir::Value {
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::ConstantOp>(
                  loc, self.getF32FloatAttr(v));
            })
       .def("get_fp64",
-           [](mlir::OpBuilder &self, double v) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, double v) -> mlir::Value {
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::ConstantOp>(
                  loc, self.getF64FloatAttr(v));
            })
       .def("get_null_value",
-           [](mlir::OpBuilder &self, mlir::Type type) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, mlir::Type type) -> mlir::Value {
+             auto loc = self.getLastLoc();
              if (auto floatTy = type.dyn_cast<mlir::FloatType>())
                return self.create<mlir::arith::ConstantFloatOp>(
                    loc, mlir::APFloat(floatTy.getFloatSemantics(), 0), floatTy);
@@ -588,8 +1119,8 @@ void init_triton_ir(py::module &&m) {
                throw std::runtime_error("Not implemented");
            })
       .def("get_all_ones_value",
-           [](mlir::OpBuilder &self, mlir::Type type) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, mlir::Type type) -> mlir::Value {
+             auto loc = self.getLastLoc();
              uint64_t val = 0xFFFFFFFFFFFFFFFF;
              if (auto intTy = type.dyn_cast<mlir::IntegerType>())
                return self.create<mlir::arith::ConstantIntOp>(loc, val, intTy);
@@ -599,70 +1130,79 @@ void init_triton_ir(py::module &&m) {
 
       // Types
       .def("get_void_ty",
-           [](mlir::OpBuilder &self) -> mlir::Type {
+           [](TritonOpBuilder &self) -> mlir::Type {
              return self.getNoneType();
            })
       .def("get_int1_ty",
-           [](mlir::OpBuilder &self) -> mlir::Type {
+           [](TritonOpBuilder &self) -> mlir::Type {
              return self.getI1Type();
            }) // or ret::copy?
       .def("get_int8_ty",
-           [](mlir::OpBuilder &self) -> mlir::Type { return self.getI8Type(); })
+           [](TritonOpBuilder &self) -> mlir::Type { return self.getI8Type(); })
       .def("get_int16_ty",
-           [](mlir::OpBuilder &self) -> mlir::Type {
+           [](TritonOpBuilder &self) -> mlir::Type {
              return self.getType<mlir::IntegerType>(16);
            })
       .def(
           "get_int32_ty",
-          [](mlir::OpBuilder &self) -> mlir::Type { return self.getI32Type(); })
+          [](TritonOpBuilder &self) -> mlir::Type { return self.getI32Type(); })
       .def(
           "get_int64_ty",
-          [](mlir::OpBuilder &self) -> mlir::Type { return self.getI64Type(); })
+          [](TritonOpBuilder &self) -> mlir::Type { return self.getI64Type(); })
       .def("get_fp8e4_ty",
-           [](mlir::OpBuilder &self) -> mlir::Type {
+           [](TritonOpBuilder &self) -> mlir::Type {
              return self.getType<mlir::Float8E4M3FNType>();
            })
       .def("get_fp8e5_ty",
-           [](mlir::OpBuilder &self) -> mlir::Type {
+           [](TritonOpBuilder &self) -> mlir::Type {
              return self.getType<mlir::Float8E5M2Type>();
            })
       .def(
           "get_half_ty",
-          [](mlir::OpBuilder &self) -> mlir::Type { return self.getF16Type(); })
+          [](TritonOpBuilder &self) -> mlir::Type { return self.getF16Type(); })
       .def("get_bf16_ty",
-           [](mlir::OpBuilder &self) -> mlir::Type {
+           [](TritonOpBuilder &self) -> mlir::Type {
              return self.getBF16Type();
            })
       .def(
           "get_float_ty",
-          [](mlir::OpBuilder &self) -> mlir::Type { return self.getF32Type(); })
+          [](TritonOpBuilder &self) -> mlir::Type { return self.getF32Type(); })
       .def(
           "get_double_ty",
-          [](mlir::OpBuilder &self) -> mlir::Type { return self.getF64Type(); })
+          [](TritonOpBuilder &self) -> mlir::Type { return self.getF64Type(); })
       .def("get_ptr_ty",
-           [](mlir::OpBuilder &self, mlir::Type &type,
+           [](TritonOpBuilder &self, mlir::Type &type,
               int addrSpace) -> mlir::Type {
              return mlir::triton::PointerType::get(type, addrSpace);
            })
       .def("get_block_ty",
-           [](mlir::OpBuilder &self, mlir::Type &elementType,
+           [](TritonOpBuilder &self, mlir::Type &elementType,
               std::vector<int64_t> &shape) -> mlir::Type {
              return mlir::RankedTensorType::get(shape, elementType);
            })
+      // The buffers of shared memory of the frontend, whose tiles are the
+      // last 2 dims and row-major
+      .def("get_shared_block_ty",
+           [](TritonOpBuilder &self, mlir::Type &elementType,
+              std::vector<int64_t> &shape) -> mlir::Type {
+             auto encoding = mlir::triton::gpu::SharedEncodingAttr::get(
+                 self.getContext(), 1, 1, 1, {1, 0});
+             return mlir::RankedTensorType::get(shape, elementType, encoding);
+           })
       .def("get_function_ty",
-           [](mlir::OpBuilder &self, std::vector<mlir::Type> inTypes,
+           [](TritonOpBuilder &self, std::vector<mlir::Type> inTypes,
               std::vector<mlir::Type> outTypes) -> mlir::Type {
              return self.getFunctionType(inTypes, outTypes);
            })
 
       // Ops
       .def("get_or_insert_function",
-           [](mlir::OpBuilder &self, mlir::ModuleOp &module,
+           [](TritonOpBuilder &self, mlir::ModuleOp &module,
               std::string &funcName, mlir::Type &funcType,
               std::string &visibility, bool noinline) -> mlir::triton::FuncOp {
              if (mlir::Operation *funcOperation = module.lookupSymbol(funcName))
                return llvm::dyn_cast<mlir::triton::FuncOp>(funcOperation);
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              if (auto funcTy = funcType.dyn_cast<mlir::FunctionType>()) {
                llvm::SmallVector<mlir::NamedAttribute> attrs = {
                    mlir::NamedAttribute(self.getStringAttr("sym_visibility"),
@@ -676,14 +1216,14 @@ void init_triton_ir(py::module &&m) {
            })
       .def(
           "create_block",
-          [](mlir::OpBuilder &self) -> mlir::Block * {
+          [](TritonOpBuilder &self) -> mlir::Block * {
             mlir::Region *parent = self.getBlock()->getParent();
             return self.createBlock(parent);
           },
           ret::reference)
       .def(
           "create_block_with_parent",
-          [](mlir::OpBuilder &self, mlir::Region &parent,
+          [](TritonOpBuilder &self, mlir::Region &parent,
              std::vector<mlir::Type> &argTypes) -> mlir::Block * {
             auto argLoc = self.getUnknownLoc();
             llvm::SmallVector<mlir::Location, 8> argLocs(argTypes.size(),
@@ -693,64 +1233,64 @@ void init_triton_ir(py::module &&m) {
           ret::reference)
       .def(
           "new_block",
-          [](mlir::OpBuilder &self) -> mlir::Block * {
+          [](TritonOpBuilder &self) -> mlir::Block * {
             return new mlir::Block();
           },
           ret::reference)
       // Unstructured control flow
       .def("create_cond_branch",
-           [](mlir::OpBuilder &self, mlir::Value condition,
+           [](TritonOpBuilder &self, mlir::Value condition,
               mlir::Block *trueDest, mlir::Block *falseDest) {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              self.create<mlir::cf::CondBranchOp>(loc, condition, trueDest,
                                                  falseDest);
              return;
            })
       .def("create_branch",
-           [](mlir::OpBuilder &self, mlir::Block *dest,
+           [](TritonOpBuilder &self, mlir::Block *dest,
               std::vector<mlir::Value> &args) {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              self.create<mlir::cf::BranchOp>(loc, dest, args);
              return;
            })
       // Structured control flow
       .def("create_for_op",
-           [](mlir::OpBuilder &self, mlir::Value &lb, mlir::Value &ub,
+           [](TritonOpBuilder &self, mlir::Value &lb, mlir::Value &ub,
               mlir::Value &step,
               std::vector<mlir::Value> &initArgs) -> mlir::scf::ForOp {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::scf::ForOp>(loc, lb, ub, step, initArgs);
            })
       .def("create_if_op",
-           [](mlir::OpBuilder &self, std::vector<mlir::Type> &retTypes,
+           [](TritonOpBuilder &self, std::vector<mlir::Type> &retTypes,
               mlir::Value &condition, bool withElse) -> mlir::scf::IfOp {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::scf::IfOp>(loc, retTypes, condition,
                                                  withElse);
            })
       .def("create_yield_op",
-           [](mlir::OpBuilder &self,
+           [](TritonOpBuilder &self,
               std::vector<mlir::Value> &yields) -> mlir::scf::YieldOp {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::scf::YieldOp>(loc, yields);
            })
       .def("create_while_op",
-           [](mlir::OpBuilder &self, std::vector<mlir::Type> &retTypes,
+           [](TritonOpBuilder &self, std::vector<mlir::Type> &retTypes,
               std::vector<mlir::Value> &initArgs) -> mlir::scf::WhileOp {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::scf::WhileOp>(loc, retTypes, initArgs);
            })
       .def("create_condition_op",
-           [](mlir::OpBuilder &self, mlir::Value &cond,
+           [](TritonOpBuilder &self, mlir::Value &cond,
               std::vector<mlir::Value> &args) -> mlir::scf::ConditionOp {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::scf::ConditionOp>(loc, cond, args);
            })
 
       // miscellaneous
       .def("create_make_range",
-           [](mlir::OpBuilder &self, int start, int end) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, int start, int end) -> mlir::Value {
+             auto loc = self.getLastLoc();
              auto retType =
                  mlir::RankedTensorType::get({end - start}, self.getI32Type());
              return self.create<mlir::triton::MakeRangeOp>(loc, retType, start,
@@ -760,58 +1300,58 @@ void init_triton_ir(py::module &&m) {
       // Cast instructions
       // Conversions for custom FP types (FP8)
       .def("create_fp_to_fp",
-           [](mlir::OpBuilder &self, mlir::Value &src,
+           [](TritonOpBuilder &self, mlir::Value &src,
               mlir::Type &dstType) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::triton::FpToFpOp>(loc, dstType, src);
            })
       // Conversions for standard LLVM builtin types
       .def("create_bitcast",
-           [](mlir::OpBuilder &self, mlir::Value &src,
+           [](TritonOpBuilder &self, mlir::Value &src,
               mlir::Type &dstType) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::triton::BitcastOp>(loc, dstType, src);
            })
       .def("create_si_to_fp",
-           [](mlir::OpBuilder &self, mlir::Value &src,
+           [](TritonOpBuilder &self, mlir::Value &src,
               mlir::Type &dstType) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::SIToFPOp>(loc, dstType, src);
            })
       .def("create_ui_to_fp",
-           [](mlir::OpBuilder &self, mlir::Value &src,
+           [](TritonOpBuilder &self, mlir::Value &src,
               mlir::Type &dstType) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::UIToFPOp>(loc, dstType, src);
            })
       .def("create_fp_to_si",
-           [](mlir::OpBuilder &self, mlir::Value &src,
+           [](TritonOpBuilder &self, mlir::Value &src,
               mlir::Type &dstType) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::FPToSIOp>(loc, dstType, src);
            })
       .def("create_fp_to_ui",
-           [](mlir::OpBuilder &self, mlir::Value &src,
+           [](TritonOpBuilder &self, mlir::Value &src,
               mlir::Type &dstType) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::FPToUIOp>(loc, dstType, src);
            })
       .def("create_fp_ext",
-           [](mlir::OpBuilder &self, mlir::Value &src,
+           [](TritonOpBuilder &self, mlir::Value &src,
               mlir::Type &dstType) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::ExtFOp>(loc, dstType, src);
            })
       .def("create_fp_trunc",
-           [](mlir::OpBuilder &self, mlir::Value &src,
+           [](TritonOpBuilder &self, mlir::Value &src,
               mlir::Type &dstType) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::TruncFOp>(loc, dstType, src);
            })
       .def("create_int_cast",
-           [](mlir::OpBuilder &self, mlir::Value &src, mlir::Type &dstType,
+           [](TritonOpBuilder &self, mlir::Value &src, mlir::Type &dstType,
               bool isSigned) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              // get element type if necessary
              mlir::Type srcType = src.getType();
              auto srcTensorType = srcType.dyn_cast<mlir::RankedTensorType>();
@@ -834,356 +1374,368 @@ void init_triton_ir(py::module &&m) {
                return self.create<mlir::arith::ExtUIOp>(loc, dstType, src);
            })
       .def("create_to_index",
-           [](mlir::OpBuilder &self, mlir::Value &input) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, mlir::Value &input) -> mlir::Value {
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::IndexCastOp>(
                  loc, self.getIndexType(), input);
            })
       .def("create_index_to_si",
-           [](mlir::OpBuilder &self, mlir::Value &input) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, mlir::Value &input) -> mlir::Value {
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::IndexCastOp>(
                  loc, self.getI64Type(), input);
            })
       .def("create_fmul",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::MulFOp>(loc, lhs, rhs);
            })
       .def("create_fdiv",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::DivFOp>(loc, lhs, rhs);
            })
       .def("create_frem",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::RemFOp>(loc, lhs, rhs);
            })
       .def("create_fadd",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::AddFOp>(loc, lhs, rhs);
            })
       .def("create_fsub",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::SubFOp>(loc, lhs, rhs);
            })
       .def("create_mul",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::MulIOp>(loc, lhs, rhs);
            })
       .def("create_sdiv",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::DivSIOp>(loc, lhs, rhs);
            })
       .def("create_udiv",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::DivUIOp>(loc, lhs, rhs);
            })
       .def("create_srem",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::RemSIOp>(loc, lhs, rhs);
            })
       .def("create_urem",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::RemUIOp>(loc, lhs, rhs);
            })
       .def("create_add",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::AddIOp>(loc, lhs, rhs);
            })
       .def("create_sub",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return mlir::Value(
                  self.create<mlir::arith::SubIOp>(loc, lhs, rhs));
            })
       .def("create_shl",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return mlir::Value(
                  self.create<mlir::arith::ShLIOp>(loc, lhs, rhs));
            })
       .def("create_lshr",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return mlir::Value(
                  self.create<mlir::arith::ShRUIOp>(loc, lhs, rhs));
            })
       .def("create_ashr",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return mlir::Value(
                  self.create<mlir::arith::ShRSIOp>(loc, lhs, rhs));
            })
       // AddPtr (similar to GEP)
       .def("create_addptr",
-           [](mlir::OpBuilder &self, mlir::Value &ptr,
+           [](TritonOpBuilder &self, mlir::Value &ptr,
               mlir::Value &offset) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::triton::AddPtrOp>(loc, ptr.getType(), ptr,
                                                         offset);
            })
       // Comparison (int)
       .def("create_icmpSLE",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::CmpIOp>(
                  loc, mlir::arith::CmpIPredicate::sle, lhs, rhs);
            })
       .def("create_icmpSLT",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::CmpIOp>(
                  loc, mlir::arith::CmpIPredicate::slt, lhs, rhs);
            })
       .def("create_icmpSGE",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::CmpIOp>(
                  loc, mlir::arith::CmpIPredicate::sge, lhs, rhs);
            })
       .def("create_icmpSGT",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::CmpIOp>(
                  loc, mlir::arith::CmpIPredicate::sgt, lhs, rhs);
            })
       .def("create_icmpULE",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::CmpIOp>(
                  loc, mlir::arith::CmpIPredicate::ule, lhs, rhs);
            })
       .def("create_icmpULT",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::CmpIOp>(
                  loc, mlir::arith::CmpIPredicate::ult, lhs, rhs);
            })
       .def("create_icmpUGE",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::CmpIOp>(
                  loc, mlir::arith::CmpIPredicate::uge, lhs, rhs);
            })
       .def("create_icmpUGT",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::CmpIOp>(
                  loc, mlir::arith::CmpIPredicate::ugt, lhs, rhs);
            })
       .def("create_icmpEQ",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::CmpIOp>(
                  loc, mlir::arith::CmpIPredicate::eq, lhs, rhs);
            })
       .def("create_icmpNE",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::CmpIOp>(
                  loc, mlir::arith::CmpIPredicate::ne, lhs, rhs);
            })
       // Comparison (float)
       .def("create_fcmpOLT",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::CmpFOp>(
                  loc, mlir::arith::CmpFPredicate::OLT, lhs, rhs);
            })
       .def("create_fcmpOGT",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::CmpFOp>(
                  loc, mlir::arith::CmpFPredicate::OGT, lhs, rhs);
            })
       .def("create_fcmpOLE",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::CmpFOp>(
                  loc, mlir::arith::CmpFPredicate::OLE, lhs, rhs);
            })
       .def("create_fcmpOGE",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::CmpFOp>(
                  loc, mlir::arith::CmpFPredicate::OGE, lhs, rhs);
            })
       .def("create_fcmpOEQ",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::CmpFOp>(
                  loc, mlir::arith::CmpFPredicate::OEQ, lhs, rhs);
            })
       .def("create_fcmpONE",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::CmpFOp>(
                  loc, mlir::arith::CmpFPredicate::ONE, lhs, rhs);
            })
       .def("create_fcmpULT",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::CmpFOp>(
                  loc, mlir::arith::CmpFPredicate::ULT, lhs, rhs);
            })
       .def("create_fcmpUGT",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::CmpFOp>(
                  loc, mlir::arith::CmpFPredicate::UGT, lhs, rhs);
            })
       .def("create_fcmpULE",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::CmpFOp>(
                  loc, mlir::arith::CmpFPredicate::ULE, lhs, rhs);
            })
       .def("create_fcmpUGE",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::CmpFOp>(
                  loc, mlir::arith::CmpFPredicate::UGE, lhs, rhs);
            })
       .def("create_fcmpUEQ",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::CmpFOp>(
                  loc, mlir::arith::CmpFPredicate::UEQ, lhs, rhs);
            })
       .def("create_fcmpUNE",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::CmpFOp>(
                  loc, mlir::arith::CmpFPredicate::UNE, lhs, rhs);
            })
       // // Logical
       .def("create_and",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::AndIOp>(loc, lhs, rhs);
            })
       .def("create_xor",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::XOrIOp>(loc, lhs, rhs);
            })
       .def("create_or",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::OrIOp>(loc, lhs, rhs);
            })
       // Input/Output
       .def("create_load",
-           [](mlir::OpBuilder &self, mlir::Value &ptrs,
+           [](TritonOpBuilder &self, mlir::Value &ptrs,
               mlir::triton::CacheModifier cacheModifier,
-              mlir::triton::EvictionPolicy evictionPolicy,
-              bool isVolatile) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
-             return self.create<mlir::triton::LoadOp>(
+              mlir::triton::EvictionPolicy evictionPolicy, bool isVolatile,
+              std::optional<mlir::triton::MemSemantic> sem,
+              std::optional<mlir::triton::MemSyncScope> scope) -> mlir::Value {
+             auto loc = self.getLastLoc();
+             auto op = self.create<mlir::triton::LoadOp>(
                  loc, ptrs, cacheModifier, evictionPolicy, isVolatile);
+             setMemOrdering(op, sem, scope);
+             return op;
            })
       .def("create_store",
-           [](mlir::OpBuilder &self, mlir::Value &ptrs, mlir::Value &value,
+           [](TritonOpBuilder &self, mlir::Value &ptrs, mlir::Value &value,
               mlir::triton::CacheModifier cacheModifier,
-              mlir::triton::EvictionPolicy evictionPolicy) -> void {
-             auto loc = self.getUnknownLoc();
-             self.create<mlir::triton::StoreOp>(loc, ptrs, value, cacheModifier,
-                                                evictionPolicy);
+              mlir::triton::EvictionPolicy evictionPolicy,
+              std::optional<mlir::triton::MemSemantic> sem,
+              std::optional<mlir::triton::MemSyncScope> scope) -> void {
+             auto loc = self.getLastLoc();
+             auto op = self.create<mlir::triton::StoreOp>(
+                 loc, ptrs, value, cacheModifier, evictionPolicy);
+             setMemOrdering(op, sem, scope);
            })
       .def("create_tensor_pointer_load",
-           [](mlir::OpBuilder &self, mlir::Value &ptr,
+           [](TritonOpBuilder &self, mlir::Value &ptr,
               std::vector<int32_t> &boundaryCheck,
               std::optional<mlir::triton::PaddingOption> paddingOption,
               mlir::triton::CacheModifier cacheModifier,
               mlir::triton::EvictionPolicy evictionPolicy,
               bool isVolatile) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::triton::LoadOp>(
                  loc, ptr, boundaryCheck, paddingOption, cacheModifier,
                  evictionPolicy, isVolatile);
            })
       .def("create_tensor_pointer_store",
-           [](mlir::OpBuilder &self, mlir::Value &ptr, mlir::Value &val,
+           [](TritonOpBuilder &self, mlir::Value &ptr, mlir::Value &val,
               std::vector<int32_t> &boundaryCheck,
               mlir::triton::CacheModifier cacheModifier,
               mlir::triton::EvictionPolicy evictionPolicy) -> void {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              self.create<mlir::triton::StoreOp>(loc, ptr, val, boundaryCheck,
                                                 cacheModifier, evictionPolicy);
            })
       .def("create_masked_load",
-           [](mlir::OpBuilder &self, mlir::Value &ptrs, mlir::Value &mask,
+           [](TritonOpBuilder &self, mlir::Value &ptrs, mlir::Value &mask,
               std::optional<mlir::Value> &other,
               mlir::triton::CacheModifier cacheModifier,
-              mlir::triton::EvictionPolicy evictionPolicy,
-              bool isVolatile) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
-             return self.create<mlir::triton::LoadOp>(
+              mlir::triton::EvictionPolicy evictionPolicy, bool isVolatile,
+              std::optional<mlir::triton::MemSemantic> sem,
+              std::optional<mlir::triton::MemSyncScope> scope) -> mlir::Value {
+             auto loc = self.getLastLoc();
+             auto op = self.create<mlir::triton::LoadOp>(
                  loc, ptrs, mask, other.value_or(mlir::Value()), cacheModifier,
                  evictionPolicy, isVolatile);
+             setMemOrdering(op, sem, scope);
+             return op;
            })
       .def("create_masked_store",
-           [](mlir::OpBuilder &self, mlir::Value &ptrs, mlir::Value &val,
+           [](TritonOpBuilder &self, mlir::Value &ptrs, mlir::Value &val,
               mlir::Value &mask, mlir::triton::CacheModifier cacheModifier,
-              mlir::triton::EvictionPolicy evictionPolicy) -> void {
-             auto loc = self.getUnknownLoc();
-             self.create<mlir::triton::StoreOp>(loc, ptrs, val, mask,
-                                                cacheModifier, evictionPolicy);
+              mlir::triton::EvictionPolicy evictionPolicy,
+              std::optional<mlir::triton::MemSemantic> sem,
+              std::optional<mlir::triton::MemSyncScope> scope) -> void {
+             auto loc = self.getLastLoc();
+             auto op = self.create<mlir::triton::StoreOp>(
+                 loc, ptrs, val, mask, cacheModifier, evictionPolicy);
+             setMemOrdering(op, sem, scope);
            })
       .def("create_view",
-           [](mlir::OpBuilder &self, mlir::Value &arg,
+           [](TritonOpBuilder &self, mlir::Value &arg,
               std::vector<int64_t> &shape) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              auto argType = arg.getType()
                                 .dyn_cast<mlir::RankedTensorType>()
                                 .getElementType();
@@ -1192,8 +1744,8 @@ void init_triton_ir(py::module &&m) {
            })
       .def(
           "create_expand_dims",
-          [](mlir::OpBuilder &self, mlir::Value &arg, int axis) -> mlir::Value {
-            auto loc = self.getUnknownLoc();
+          [](TritonOpBuilder &self, mlir::Value &arg, int axis) -> mlir::Value {
+            auto loc = self.getLastLoc();
             auto argType = arg.getType().dyn_cast<mlir::RankedTensorType>();
             auto argEltType = argType.getElementType();
             std::vector<int64_t> retShape = argType.getShape();
@@ -1203,9 +1755,9 @@ void init_triton_ir(py::module &&m) {
                 axis);
           })
       .def("create_cat",
-           [](mlir::OpBuilder &self, mlir::Value &lhs,
+           [](TritonOpBuilder &self, mlir::Value &lhs,
               mlir::Value &rhs) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              auto lhsType = lhs.getType().dyn_cast<mlir::RankedTensorType>();
              auto rhsType = rhs.getType().dyn_cast<mlir::RankedTensorType>();
              if (!(lhsType.getShape().size() == 1 &&
@@ -1220,8 +1772,8 @@ void init_triton_ir(py::module &&m) {
                  lhs, rhs);
            })
       .def("create_trans",
-           [](mlir::OpBuilder &self, mlir::Value &arg) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, mlir::Value &arg) -> mlir::Value {
+             auto loc = self.getLastLoc();
              auto argType = arg.getType().dyn_cast<mlir::RankedTensorType>();
              auto argEltType = argType.getElementType();
              std::vector<int64_t> retShape = argType.getShape();
@@ -1230,9 +1782,9 @@ void init_triton_ir(py::module &&m) {
                  loc, mlir::RankedTensorType::get(retShape, argEltType), arg);
            })
       .def("create_broadcast",
-           [](mlir::OpBuilder &self, mlir::Value &arg,
+           [](TritonOpBuilder &self, mlir::Value &arg,
               std::vector<int64_t> &shape) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              if (auto argType =
                      arg.getType().dyn_cast<mlir::RankedTensorType>())
                return self.createOrFold<mlir::triton::BroadcastOp>(
@@ -1243,9 +1795,9 @@ void init_triton_ir(py::module &&m) {
                  "arg is not of RankedTensorType, use create_splat");
            })
       .def("create_splat",
-           [](mlir::OpBuilder &self, mlir::Value &arg,
+           [](TritonOpBuilder &self, mlir::Value &arg,
               std::vector<int64_t> &shape) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              auto argType = arg.getType();
              auto ret = self.createOrFold<mlir::triton::SplatOp>(
                  loc, mlir::RankedTensorType::get(shape, argType), arg);
@@ -1253,9 +1805,10 @@ void init_triton_ir(py::module &&m) {
            })
       // // atomic
       .def("create_atomic_cas",
-           [](mlir::OpBuilder &self, mlir::Value &ptr, mlir::Value &cmp,
-              mlir::Value &val) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, mlir::Value &ptr, mlir::Value &cmp,
+              mlir::Value &val, std::optional<mlir::triton::MemSemantic> sem,
+              std::optional<mlir::triton::MemSyncScope> scope) -> mlir::Value {
+             auto loc = self.getLastLoc();
              mlir::Type dstType;
              if (auto srcTensorType =
                      ptr.getType().dyn_cast<mlir::RankedTensorType>()) {
@@ -1269,14 +1822,17 @@ void init_triton_ir(py::module &&m) {
                                   .cast<mlir::triton::PointerType>();
                dstType = ptrType.getPointeeType();
              }
-             return self.create<mlir::triton::AtomicCASOp>(loc, dstType, ptr,
-                                                           cmp, val);
+             auto op = self.create<mlir::triton::AtomicCASOp>(loc, dstType,
+                                                              ptr, cmp, val);
+             setMemOrdering(op, sem, scope);
+             return op;
            })
       .def("create_atomic_rmw",
-           [](mlir::OpBuilder &self, mlir::triton::RMWOp rmwOp,
-              mlir::Value &ptr, mlir::Value &val,
-              mlir::Value &mask) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, mlir::triton::RMWOp rmwOp,
+              mlir::Value &ptr, mlir::Value &val, mlir::Value &mask,
+              std::optional<mlir::triton::MemSemantic> sem,
+              std::optional<mlir::triton::MemSyncScope> scope) -> mlir::Value {
+             auto loc = self.getLastLoc();
              mlir::Type dstType;
              if (auto srcTensorType =
                      ptr.getType().dyn_cast<mlir::RankedTensorType>()) {
@@ -1290,16 +1846,34 @@ void init_triton_ir(py::module &&m) {
                                   .cast<mlir::triton::PointerType>();
                dstType = ptrType.getPointeeType();
              }
-             return self.create<mlir::triton::AtomicRMWOp>(loc, dstType, rmwOp,
-                                                           ptr, val, mask);
+             auto op = self.create<mlir::triton::AtomicRMWOp>(
+                 loc, dstType, rmwOp, ptr, val, mask);
+             setMemOrdering(op, sem, scope);
+             return op;
+           })
+      .def("create_semaphore_wait",
+           [](TritonOpBuilder &self, mlir::Value &ptr, mlir::Value &value,
+              mlir::triton::MemSemantic sem,
+              mlir::triton::MemSyncScope scope) -> void {
+             auto loc = self.getLastLoc();
+             self.create<mlir::triton::SemaphoreWaitOp>(loc, ptr, value, sem,
+                                                        scope);
+           })
+      .def("create_semaphore_signal",
+           [](TritonOpBuilder &self, mlir::Value &ptr, mlir::Value &value,
+              bool add, mlir::triton::MemSemantic sem,
+              mlir::triton::MemSyncScope scope) -> void {
+             auto loc = self.getLastLoc();
+             self.create<mlir::triton::SemaphoreSignalOp>(loc, ptr, value, add,
+                                                          sem, scope);
            })
       // External
       .def("create_extern_elementwise",
-           [](mlir::OpBuilder &self, const std::string &libName,
+           [](TritonOpBuilder &self, const std::string &libName,
               const std::string &libPath, const std::string &symbol,
               std::vector<mlir::Value> &argList, mlir::Type retType,
               bool isPure) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              if (isPure)
                return self.create<mlir::triton::PureExternElementwiseOp>(
                    loc, retType, argList, libName, libPath, symbol);
@@ -1307,70 +1881,96 @@ void init_triton_ir(py::module &&m) {
                return self.create<mlir::triton::ImpureExternElementwiseOp>(
                    loc, retType, argList, libName, libPath, symbol);
            })
+      .def("create_inline_asm",
+           [](TritonOpBuilder &self, const std::string &asmString,
+              const std::string &constraints,
+              std::vector<mlir::Value> &values, mlir::Type &type, bool isPure,
+              int pack) -> mlir::Value {
+             auto loc = self.getLastLoc();
+             return self.create<mlir::triton::ElementwiseInlineAsmOp>(
+                 loc, type, asmString, constraints, isPure, pack, values);
+           })
+      .def("create_philox",
+           [](TritonOpBuilder &self, mlir::Value &c0, mlir::Value &c1,
+              mlir::Value &c2, mlir::Value &c3, mlir::Value &k0,
+              mlir::Value &k1, int nRounds) -> mlir::OpState {
+             auto loc = self.getLastLoc();
+             mlir::Type type = c0.getType();
+             return self.create<mlir::triton::PhiloxOp>(
+                 loc, type, type, type, type, c0, c1, c2, c3, k0, k1,
+                 nRounds);
+           })
       // Built-in instruction
       .def("create_get_program_id",
-           [](mlir::OpBuilder &self, int axis) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, int axis) -> mlir::Value {
+             auto loc = self.getLastLoc();
              return self.create<mlir::triton::GetProgramIdOp>(
                  loc, self.getI32Type(), self.getI32IntegerAttr(axis));
            })
       .def("create_get_num_programs",
-           [](mlir::OpBuilder &self, int axis) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, int axis) -> mlir::Value {
+             auto loc = self.getLastLoc();
              return self.create<mlir::triton::GetNumProgramsOp>(
                  loc, self.getI32Type(), self.getI32IntegerAttr(axis));
            })
       .def("create_dot",
-           [](mlir::OpBuilder &self, mlir::Value &a, mlir::Value &b,
+           [](TritonOpBuilder &self, mlir::Value &a, mlir::Value &b,
               mlir::Value &c, bool allowTF32) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::triton::DotOp>(loc, c.getType(), a, b, c,
                                                      allowTF32);
            })
+      .def("create_sparse_dot",
+           [](TritonOpBuilder &self, mlir::Value &a, mlir::Value &b,
+              mlir::Value &c, mlir::Value &aMeta) -> mlir::Value {
+             auto loc = self.getLastLoc();
+             return self.create<mlir::triton::SparseDotOp>(loc, c.getType(), a,
+                                                           b, c, aMeta);
+           })
       .def("create_exp",
-           [](mlir::OpBuilder &self, mlir::Value &val) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, mlir::Value &val) -> mlir::Value {
+             auto loc = self.getLastLoc();
              return self.create<mlir::math::ExpOp>(loc, val);
            })
       .def("create_cos",
-           [](mlir::OpBuilder &self, mlir::Value &val) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, mlir::Value &val) -> mlir::Value {
+             auto loc = self.getLastLoc();
              return self.create<mlir::math::CosOp>(loc, val);
            })
       .def("create_sin",
-           [](mlir::OpBuilder &self, mlir::Value &val) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, mlir::Value &val) -> mlir::Value {
+             auto loc = self.getLastLoc();
              return self.create<mlir::math::SinOp>(loc, val);
            })
       .def("create_log",
-           [](mlir::OpBuilder &self, mlir::Value &val) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, mlir::Value &val) -> mlir::Value {
+             auto loc = self.getLastLoc();
              return self.create<mlir::math::LogOp>(loc, val);
            })
       .def("create_sqrt",
-           [](mlir::OpBuilder &self, mlir::Value &val) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, mlir::Value &val) -> mlir::Value {
+             auto loc = self.getLastLoc();
              return self.create<mlir::math::SqrtOp>(loc, val);
            })
       .def("create_fabs",
-           [](mlir::OpBuilder &self, mlir::Value &val) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, mlir::Value &val) -> mlir::Value {
+             auto loc = self.getLastLoc();
              return self.create<mlir::math::AbsFOp>(loc, val);
            })
       .def("create_iabs",
-           [](mlir::OpBuilder &self, mlir::Value &val) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, mlir::Value &val) -> mlir::Value {
+             auto loc = self.getLastLoc();
              return self.create<mlir::math::AbsIOp>(loc, val);
            })
       .def("create_reduce",
-           [](mlir::OpBuilder &self, std::vector<mlir::Value> operands,
+           [](TritonOpBuilder &self, std::vector<mlir::Value> operands,
               int axis) -> mlir::OpState {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::triton::ReduceOp>(loc, operands, axis);
            })
       .def("create_reduce_ret",
-           [](mlir::OpBuilder &self, py::args args) -> mlir::OpState {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, py::args args) -> mlir::OpState {
+             auto loc = self.getLastLoc();
              llvm::SmallVector<mlir::Value> return_values;
              for (const auto &arg : args) {
                return_values.push_back(py::cast<mlir::Value>(arg));
@@ -1378,29 +1978,68 @@ void init_triton_ir(py::module &&m) {
              return self.create<mlir::triton::ReduceReturnOp>(loc,
                                                               return_values);
            })
+      .def("create_scan",
+           [](TritonOpBuilder &self, std::vector<mlir::Value> operands,
+              int axis) -> mlir::OpState {
+             auto loc = self.getLastLoc();
+             return self.create<mlir::triton::ScanOp>(loc, operands, axis);
+           })
+      .def("create_scan_ret",
+           [](TritonOpBuilder &self, py::args args) -> mlir::OpState {
+             auto loc = self.getLastLoc();
+             llvm::SmallVector<mlir::Value> return_values;
+             for (const auto &arg : args) {
+               return_values.push_back(py::cast<mlir::Value>(arg));
+             }
+             return self.create<mlir::triton::ScanReturnOp>(loc,
+                                                            return_values);
+           })
+      .def("create_sort",
+           [](TritonOpBuilder &self, std::vector<mlir::Value> operands,
+              int axis, bool descending, bool isUnsigned) -> mlir::OpState {
+             auto loc = self.getLastLoc();
+             return self.create<mlir::triton::SortOp>(loc, operands, axis,
+                                                      descending, isUnsigned);
+           })
+      .def("create_topk",
+           [](TritonOpBuilder &self, std::vector<mlir::Value> operands,
+              int axis, int k, bool isUnsigned) -> mlir::OpState {
+             auto loc = self.getLastLoc();
+             return self.create<mlir::triton::TopKOp>(loc, operands, axis, k,
+                                                      isUnsigned);
+           })
+      .def("create_histogram",
+           [](TritonOpBuilder &self, mlir::Value operand,
+              int numBins) -> mlir::Value {
+             auto loc = self.getLastLoc();
+             auto resultTy =
+                 mlir::RankedTensorType::get({numBins}, self.getI32Type());
+             return self.create<mlir::triton::HistogramOp>(loc, resultTy,
+                                                           operand);
+           })
       .def("create_ptr_to_int",
-           [](mlir::OpBuilder &self, mlir::Value &val,
+           [](TritonOpBuilder &self, mlir::Value &val,
               mlir::Type &type) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::triton::PtrToIntOp>(loc, type, val);
            })
       .def("create_int_to_ptr",
-           [](mlir::OpBuilder &self, mlir::Value &val,
+           [](TritonOpBuilder &self, mlir::Value &val,
               mlir::Type &type) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::triton::IntToPtrOp>(loc, type, val);
            })
       .def("create_select",
-           [](mlir::OpBuilder &self, mlir::Value &condition,
+           [](TritonOpBuilder &self, mlir::Value &condition,
               mlir::Value &trueValue, mlir::Value &falseValue) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::arith::SelectOp>(loc, condition,
                                                        trueValue, falseValue);
            })
       .def("create_print",
-           [](mlir::OpBuilder &self, const std::string &prefix,
+           [](TritonOpBuilder &self, const std::string &prefix,
               const std::vector<mlir::Value> &values) -> void {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              self.create<mlir::triton::PrintOp>(
                  loc,
                  mlir::StringAttr::get(self.getContext(),
@@ -1408,10 +2047,10 @@ void init_triton_ir(py::module &&m) {
                  values);
            })
       .def("create_assert",
-           [](mlir::OpBuilder &self, mlir::Value &condition,
+           [](TritonOpBuilder &self, mlir::Value &condition,
               const std::string &message, const std::string &fileName,
               const std::string &funcName, unsigned lineNo) -> void {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              auto messageAttr = mlir::StringAttr::get(self.getContext(),
                                                       llvm::StringRef(message));
              auto fileNameAttr = mlir::StringAttr::get(
@@ -1425,39 +2064,138 @@ void init_triton_ir(py::module &&m) {
            })
       // Undef
       .def("create_undef",
-           [](mlir::OpBuilder &self, mlir::Type &type) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self, mlir::Type &type) -> mlir::Value {
+             auto loc = self.getLastLoc();
              return self.create<::mlir::LLVM::UndefOp>(loc, type);
            })
       // Force GPU barrier
       .def("create_barrier",
-           [](mlir::OpBuilder &self) {
-             auto loc = self.getUnknownLoc();
+           [](TritonOpBuilder &self) {
+             auto loc = self.getLastLoc();
              self.create<mlir::gpu::BarrierOp>(loc);
            })
+      // Shared memory buffers and asynchronous copies, for manual pipelining
+      .def("create_alloc_tensor",
+           [](TritonOpBuilder &self, mlir::Type &type) -> mlir::Value {
+             auto loc = self.getLastLoc();
+             return self.create<mlir::triton::gpu::AllocTensorOp>(loc, type);
+           })
+      .def("create_insert_slice_async",
+           [](TritonOpBuilder &self, mlir::Value &ptrs, mlir::Value &buffer,
+              mlir::Value &index, std::optional<mlir::Value> &mask,
+              std::optional<mlir::Value> &other,
+              mlir::triton::CacheModifier cacheModifier,
+              mlir::triton::EvictionPolicy evictionPolicy,
+              bool isVolatile) -> mlir::Value {
+             auto loc = self.getLastLoc();
+             return self.create<mlir::triton::gpu::InsertSliceAsyncOp>(
+                 loc, buffer.getType(), ptrs, buffer, index,
+                 mask.value_or(mlir::Value()), other.value_or(mlir::Value()),
+                 cacheModifier, evictionPolicy, isVolatile, /*axis=*/0,
+                 mlir::DenseI32ArrayAttr());
+           })
+      .def("create_async_commit_group",
+           [](TritonOpBuilder &self) {
+             auto loc = self.getLastLoc();
+             self.create<mlir::triton::gpu::AsyncCommitGroupOp>(loc);
+           })
+      .def("create_async_wait",
+           [](TritonOpBuilder &self, int numPending) {
+             auto loc = self.getLastLoc();
+             self.create<mlir::triton::gpu::AsyncWaitOp>(loc, numPending);
+           })
+      // The tile `index` of the first dim of `buffer`, in shared memory
+      .def("create_extract_slice",
+           [](TritonOpBuilder &self, mlir::Value &buffer,
+              mlir::Value &index) -> mlir::Value {
+             auto loc = self.getLastLoc();
+             auto bufferTy = buffer.getType().cast<mlir::RankedTensorType>();
+             auto tileShape = bufferTy.getShape().drop_front();
+             auto tileTy = mlir::RankedTensorType::get(
+                 tileShape, bufferTy.getElementType(), bufferTy.getEncoding());
+             auto one = self.getI64IntegerAttr(1);
+             llvm::SmallVector<mlir::OpFoldResult> offsets = {index};
+             llvm::SmallVector<mlir::OpFoldResult> sizes = {one};
+             llvm::SmallVector<mlir::OpFoldResult> strides(bufferTy.getRank(),
+                                                           one);
+             for (int64_t size : tileShape) {
+               offsets.push_back(self.getI64IntegerAttr(0));
+               sizes.push_back(self.getI64IntegerAttr(size));
+             }
+             return self.create<mlir::triton::gpu::ExtractSliceOp>(
+                 loc, tileTy, buffer, offsets, sizes, strides);
+           })
+      .def("create_convert_layout",
+           [](TritonOpBuilder &self, mlir::Value &src,
+              mlir::Type &type) -> mlir::Value {
+             auto loc = self.getLastLoc();
+             return self.create<mlir::triton::gpu::ConvertLayoutOp>(loc, type,
+                                                                     src);
+           })
       // Make a block pointer (tensor pointer in Triton IR)
       .def("create_make_block_ptr",
-           [](mlir::OpBuilder &self, mlir::Value &base,
+           [](TritonOpBuilder &self, mlir::Value &base,
               std::vector<mlir::Value> &shape,
               std::vector<mlir::Value> &strides,
               std::vector<mlir::Value> &offsets,
               std::vector<int32_t> &tensorShape,
               std::vector<int32_t> &order) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::triton::MakeTensorPtrOp>(
                  loc, base, shape, strides, offsets, tensorShape, order);
            })
       // Advance a block pointer
       .def("create_advance",
-           [](mlir::OpBuilder &self, mlir::Value &ptr,
+           [](TritonOpBuilder &self, mlir::Value &ptr,
               std::vector<mlir::Value> &offsets) -> mlir::Value {
-             auto loc = self.getUnknownLoc();
+             auto loc = self.getLastLoc();
              return self.create<mlir::triton::AdvanceOp>(loc, ptr.getType(),
                                                          ptr, offsets);
            });
 
+  py::class_<PassTimerHandle>(m, "pass_timer")
+      .def("get_times",
+           [](PassTimerHandle &self) -> py::dict {
+             py::dict times;
+             for (auto &[name, seconds] : self.timer->getTimes())
+               times[py::str(name)] = seconds;
+             return times;
+           })
+      .def("reset", [](PassTimerHandle &self) { self.timer->reset(); });
+
   py::class_<mlir::PassManager>(m, "pass_manager")
       .def(py::init<mlir::MLIRContext *>())
+      // Returns the pass manager of the pipeline `key` with its timer, and
+      // whether the passes of the pipeline remain to be added. Only pooled
+      // contexts keep their pass managers, and not while MLIR_ENABLE_DUMP is
+      // set, so that the IR printing of enable_debug follows the environment.
+      .def_static(
+          "get",
+          [](mlir::MLIRContext *context, const std::string &key) {
+            auto create = [&](PassTimer *&timer) {
+              auto passManager = std::make_unique<mlir::PassManager>(context);
+              auto newTimer = std::make_unique<PassTimer>();
+              timer = newTimer.get();
+              passManager->addInstrumentation(std::move(newTimer));
+              return passManager;
+            };
+            auto *entry =
+                ::triton::tools::getBoolEnv("MLIR_ENABLE_DUMP")
+                    ? nullptr
+                    : ContextPool::get().lookup(context, key);
+            if (!entry) {
+              PassTimer *timer;
+              py::object passManager = py::cast(create(timer));
+              return py::make_tuple(passManager, PassTimerHandle{timer}, true);
+            }
+            bool isNew = !entry->passManager;
+            if (isNew)
+              entry->passManager = create(entry->timer);
+            return py::make_tuple(
+                py::cast(entry->passManager.get(), ret::reference),
+                PassTimerHandle{entry->timer}, isNew);
+          },
+          py::keep_alive<0, 1>())
       .def("enable_debug",
            [](mlir::PassManager &self) {
              auto printingFlags = mlir::OpPrintingFlags();
@@ -1475,9 +2213,16 @@ void init_triton_ir(py::module &&m) {
            })
       .def("run",
            [](mlir::PassManager &self, mlir::ModuleOp &mod) {
+             // Passes never call back into Python; releasing the GIL lets
+             // several modules be compiled concurrently.
+             bool success;
+             {
+               py::gil_scoped_release allow_threads;
+               success = mlir::succeeded(self.run(mod.getOperation()));
+             }
              // TODO: maybe dump module to file and print error for better
              // diagnostics
-             if (mlir::failed(self.run(mod.getOperation())))
+             if (!success)
                throw std::runtime_error("PassManager::run failed");
            })
       .def(
@@ -1514,15 +2259,36 @@ void init_triton_ir(py::module &&m) {
              self.addPass(mlir::triton::createRewriteTensorPointerPass(
                  computeCapability));
            })
+      .def("add_triton_specialize_calls_pass",
+           [](mlir::PassManager &self) {
+             self.addPass(mlir::triton::createSpecializeCallsPass());
+           })
+      .def("add_triton_rebase_loop_pointers_pass",
+           [](mlir::PassManager &self) {
+             self.addPass(mlir::triton::createRebaseLoopPointersPass());
+           })
+      .def("add_triton_mark_streaming_stores_pass",
+           [](mlir::PassManager &self) {
+             self.addPass(mlir::triton::createMarkStreamingStoresPass());
+           })
       .def("add_convert_triton_to_tritongpu_pass",
-           [](mlir::PassManager &self, int numWarps) {
-             self.addPass(
-                 mlir::triton::createConvertTritonToTritonGPUPass(numWarps));
+           [](mlir::PassManager &self, int numWarps, int threadsPerWarp,
+              bool autoNumWarps) {
+             self.addPass(mlir::triton::createConvertTritonToTritonGPUPass(
+                 numWarps, threadsPerWarp, autoNumWarps));
            })
       .def("add_tritongpu_pipeline_pass",
            [](mlir::PassManager &self, int numStages) {
              self.addPass(mlir::createTritonGPUPipelinePass(numStages));
            })
+      .def("add_tritongpu_perf_lint_pass",
+           [](mlir::PassManager &self, int numStages) {
+             self.addPass(mlir::createTritonGPUPerfLintPass(numStages));
+           })
+      .def("add_tritongpu_loop_unroll_pass",
+           [](mlir::PassManager &self) {
+             self.addPass(mlir::createTritonGPULoopUnrollPass());
+           })
       .def("add_tritongpu_prefetch_pass",
            [](mlir::PassManager &self) {
              self.addPass(mlir::createTritonGPUPrefetchPass());
@@ -1537,8 +2303,9 @@ void init_triton_ir(py::module &&m) {
              self.addPass(mlir::createTritonGPUOptimizeDotOperandsPass());
            })
       .def("add_tritongpu_remove_layout_conversions_pass",
-           [](mlir::PassManager &self) {
-             self.addPass(mlir::createTritonGPURemoveLayoutConversionsPass());
+           [](mlir::PassManager &self, bool costModel) {
+             self.addPass(
+                 mlir::createTritonGPURemoveLayoutConversionsPass(costModel));
            })
       .def("add_tritongpu_reorder_instructions_pass",
            [](mlir::PassManager &self) {
@@ -1565,13 +2332,80 @@ void init_triton_translation(py::module &m) {
     return shared.getInt();
   });
 
+  m.def("get_allocation_size", [](mlir::ModuleOp mod) {
+    mlir::ModuleAllocation allocation(mod);
+    return allocation.getSharedMemorySize();
+  });
+
+  m.def("estimate_register_usage", [](mlir::ModuleOp mod) {
+    return mlir::estimateRegisterUsage(mod);
+  });
+
+  // The (id, format) of the records of the prints, for TRITON_PRINT_BUFFER
+  m.def("get_print_formats", [](mlir::ModuleOp mod) {
+    std::vector<std::tuple<uint32_t, std::string>> formats;
+    mod.walk([&](mlir::triton::PrintOp op) {
+      std::string format = mlir::triton::getPrintRecordFormat(op);
+      formats.emplace_back(mlir::triton::getPrintRecordId(format), format);
+    });
+    return formats;
+  });
+
+  // The remarks of the performance lint of a TritonGPU module, as
+  // "file:line:col: message" strings followed by their notes
+  m.def("get_perf_remarks", [](mlir::ModuleOp mod, int numStages) {
+    auto format = [](mlir::Location loc, llvm::StringRef message) {
+      std::string str;
+      llvm::raw_string_ostream os(str);
+      // the innermost location, i.e. the call site in the inlined function
+      mlir::FileLineColLoc fileLoc;
+      loc->walk([&](mlir::Location l) {
+        if ((fileLoc = l.dyn_cast<mlir::FileLineColLoc>()))
+          return mlir::WalkResult::interrupt();
+        return mlir::WalkResult::advance();
+      });
+      if (fileLoc)
+        os << fileLoc.getFilename().getValue() << ":" << fileLoc.getLine()
+           << ":" << fileLoc.getColumn() << ": ";
+      os << message;
+      return os.str();
+    };
+    std::vector<std::string> remarks;
+    mlir::ScopedDiagnosticHandler handler(
+        mod.getContext(), [&](mlir::Diagnostic &diag) {
+          if (diag.getSeverity() != mlir::DiagnosticSeverity::Remark)
+            return mlir::failure();
+          std::string remark = format(diag.getLocation(), diag.str());
+          for (mlir::Diagnostic &note : diag.getNotes())
+            remark += "\n  " + format(note.getLocation(), note.str());
+          remarks.push_back(remark);
+          return mlir::success();
+        });
+    mlir::PassManager pm(mod.getContext());
+    pm.addPass(mlir::createTritonGPUPerfLintPass(numStages));
+    if (mlir::failed(pm.run(mod.getOperation())))
+      throw std::runtime_error("the performance lint failed");
+    return remarks;
+  });
+
   m.def(
       "translate_triton_gpu_to_llvmir",
-      [](mlir::ModuleOp op, int computeCapability, bool isROCM) {
+      [](mlir::ModuleOp op, int computeCapability, bool isROCM,
+         bool fastMath, int optLevel, bool usePrintBuffer) {
         py::gil_scoped_release allow_threads;
+        // tt.print appends to the print buffer, see TRITON_PRINT_BUFFER
+        if (usePrintBuffer)
+          op->setAttr(
+              mlir::triton::gpu::TritonGPUDialect::getPrintBufferAttrName(),
+              mlir::UnitAttr::get(op->getContext()));
+        // the source locations of the ops are only for the remarks on the
+        // TritonGPU IR: locations are incompatible with ptx < 7.5 !
+        op->walk([](mlir::Operation *op) {
+          op->setLoc(mlir::UnknownLoc::get(op->getContext()));
+        });
         llvm::LLVMContext llvmContext;
         auto llvmModule = ::mlir::triton::translateTritonGPUToLLVMIR(
-            &llvmContext, op, computeCapability, isROCM);
+            &llvmContext, op, computeCapability, isROCM, fastMath, optLevel);
         if (!llvmModule)
           llvm::report_fatal_error("Failed to translate TritonGPU to LLVM IR.");
 
@@ -1585,7 +2419,8 @@ void init_triton_translation(py::module &m) {
 
   m.def(
       "translate_llvmir_to_ptx",
-      [](const std::string llvmIR, int capability, int version) -> std::string {
+      [](const std::string llvmIR, int capability, int version, int optLevel,
+         int maxNReg, int minBlocksPerSM) -> std::string {
         py::gil_scoped_release allow_threads;
         // create LLVM module from C++
         llvm::LLVMContext context;
@@ -1601,8 +2436,8 @@ void init_triton_translation(py::module &m) {
         }
 
         // translate module to PTX
-        auto ptxCode =
-            triton::translateLLVMIRToPTX(*module, capability, version);
+        auto ptxCode = triton::translateLLVMIRToPTX(
+            *module, capability, version, optLevel, maxNReg, minBlocksPerSM);
         return ptxCode;
       },
       ret::take_ownership);
@@ -1665,6 +2500,79 @@ void init_triton_translation(py::module &m) {
           return std::move(bytes);
         });
 
+  m.def("has_nvptxcompiler", []() -> bool {
+#ifdef TRITON_USE_NVPTXCOMPILER
+    return true;
+#else
+    return false;
+#endif
+  });
+
+  m.def("get_nvptxcompiler_version", []() -> std::string {
+#ifdef TRITON_USE_NVPTXCOMPILER
+    unsigned major, minor;
+    if (nvPTXCompilerGetVersion(&major, &minor) != NVPTXCOMPILE_SUCCESS)
+      throw std::runtime_error("Failed to query the nvPTXCompiler version");
+    return std::to_string(major) + "." + std::to_string(minor);
+#else
+    throw std::runtime_error("Triton was built without nvPTXCompiler");
+#endif
+  });
+
+  // Compiles the PTX in the process with the nvPTXCompiler library instead of
+  // spawning ptxas. Every call has its own compiler handle, so concurrent
+  // compilations are safe once the GIL is released.
+  m.def("compile_ptx_to_cubin_in_process",
+        [](const std::string &ptxCode, int capability) -> py::object {
+#ifdef TRITON_USE_NVPTXCOMPILER
+          std::string cubin;
+          std::string error;
+          {
+            py::gil_scoped_release allow_threads;
+
+            nvPTXCompilerHandle compiler;
+            std::string gpuName = "--gpu-name=sm_" +
+                                  std::to_string(capability) +
+                                  (capability == 90 ? "a" : "");
+            const char *options[] = {gpuName.c_str(), "-v"};
+            auto getLog = [&]() {
+              size_t size = 0;
+              nvPTXCompilerGetErrorLogSize(compiler, &size);
+              std::string log(size, '\0');
+              if (size > 0)
+                nvPTXCompilerGetErrorLog(compiler, log.data());
+              return log;
+            };
+            if (nvPTXCompilerCreate(&compiler, ptxCode.size(),
+                                    ptxCode.c_str()) != NVPTXCOMPILE_SUCCESS) {
+              error = "Failed to create an nvPTXCompiler handle";
+            } else {
+              nvPTXCompileResult result =
+                  nvPTXCompilerCompile(compiler, 2, options);
+              if (result == NVPTXCOMPILE_ERROR_COMPILATION_FAILURE) {
+                error = "Internal Triton PTX codegen error: \n" + getLog();
+              } else if (result != NVPTXCOMPILE_SUCCESS) {
+                error = "nvPTXCompiler failed with error code " +
+                        std::to_string(result) + ": \n" + getLog();
+              } else {
+                size_t size = 0;
+                nvPTXCompilerGetCompiledProgramSize(compiler, &size);
+                cubin.resize(size);
+                nvPTXCompilerGetCompiledProgram(compiler, cubin.data());
+              }
+              nvPTXCompilerDestroy(&compiler);
+            }
+            // Exit the gil scope before throwing
+          }
+          if (!error.empty())
+            throw std::runtime_error(error);
+          py::bytes bytes(cubin);
+          return std::move(bytes);
+#else
+          throw std::runtime_error("Triton was built without nvPTXCompiler");
+#endif
+        });
+
   m.def("add_external_libs",
         [](mlir::ModuleOp &op, const std::vector<std::string> &names,
            const std::vector<std::string> &paths) {
@@ -1674,7 +2582,7 @@ void init_triton_translation(py::module &m) {
   m.def(
       "translate_llvmir_to_hsaco",
       [](const std::string llvmIR, std::string gfx_arch, std::string gfx_triple,
-         std::string gfx_features) -> std::tuple<std::string, std::string> {
+         std::string gfx_features) -> std::tuple<std::string, py::bytes> {
         // create LLVM module from C++
         llvm::LLVMContext context;
         std::unique_ptr<llvm::MemoryBuffer> buffer =
@@ -1683,9 +2591,9 @@ void init_triton_translation(py::module &m) {
         std::unique_ptr<llvm::Module> module =
             llvm::parseIR(buffer->getMemBufferRef(), error, context);
         // translate module to HSACO
-        auto hsacoCode = triton::translateLLVMIRToHSACO(
+        auto [amdgcn, hsaco] = triton::translateLLVMIRToHSACO(
             *module, gfx_arch, gfx_triple, gfx_features);
-        return hsacoCode;
+        return std::make_tuple(amdgcn, py::bytes(hsaco));
       },
       ret::take_ownership);
 }
@@ -0,0 +1,225 @@
+"""
+A benchmark suite of the common kernels, compared against the stored
+baselines of the device in :code:`baselines/<device>.json`.
+
+The results of a run are written to :code:`results/<device>.json`, or to
+:code:`$TRITON_BENCHMARK_RESULTS`, for :code:`triton.tools.compare_benchmarks`
+to compare the results of two compiler commits. With
+:code:`TRITON_UPDATE_BASELINES=1` the results become the new baselines.
+The runtimes depend on the clocks, which should be locked, e.g. with
+:code:`nvidia-smi --lock-gpu-clocks`.
+"""
+
+import os
+import re
+import time
+
+import pytest
+import torch
+
+import triton
+import triton.language as tl
+import triton.ops
+from triton.tools import compare_benchmarks
+
+DEVICE = re.sub(r'[^\w.-]', '_', torch.cuda.get_device_name()).lower()
+DIR = os.path.dirname(os.path.realpath(__file__))
+BASELINE_PATH = os.path.join(DIR, "baselines", f"{DEVICE}.json")
+RESULTS_PATH = os.getenv("TRITON_BENCHMARK_RESULTS", os.path.join(DIR, "results", f"{DEVICE}.json"))
+
+_baselines = compare_benchmarks.load(BASELINE_PATH)["benchmarks"] if os.path.exists(BASELINE_PATH) else {}
+_results = {}
+
+
+@pytest.fixture(scope="module", autouse=True)
+def save_results():
+    yield
+    if not _results:
+        return
+    paths = [RESULTS_PATH]
+    if os.getenv("TRITON_UPDATE_BASELINES", "0") == "1":
+        paths.append(BASELINE_PATH)
+    for path in paths:
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        compare_benchmarks.save(path, torch.cuda.get_device_name(), _results, triton_version=triton.__version__,
+                                commit=os.getenv("TRITON_COMMIT", ""))
+
+
+def check(name, stats):
+    """Records the :code:`BenchStats` of a benchmark and compares it against the baseline."""
+    result = {"mean": stats.mean, "std": stats.std, "num_samples": stats.num_samples}
+    _results[name] = result
+    print(f'{name}: {stats.mean:.4f} ms [{stats.ci_low:.4f}, {stats.ci_high:.4f}]', end='\t')
+    if name not in _baselines:
+        pytest.skip(f"no baseline for {name} on {DEVICE}")
+    row, = compare_benchmarks.compare({"benchmarks": {name: _baselines[name]}}, {"benchmarks": {name: result}})
+    assert row["status"] != "regression", \
+        f"{name} is {row['ratio']:.3f}x slower than the baseline ({row['baseline']:.4f} ms)"
+
+
+def bench(fn):
+    return triton.testing.do_bench_cudagraph(fn, return_mode="stats")
+
+
+#######################
+# Matrix Multiplication
+#######################
+
+
+@pytest.mark.parametrize("M, N, K", [(1024, 1024, 1024), (4096, 4096, 4096), (16, 4096, 4096), (4096, 64, 4096)])
+@pytest.mark.parametrize("dtype_str", ["float16"])
+def test_matmul(M, N, K, dtype_str):
+    dtype = getattr(torch, dtype_str)
+    torch.manual_seed(0)
+    a = torch.randn((M, K), dtype=dtype, device='cuda')
+    b = torch.randn((K, N), dtype=dtype, device='cuda')
+    check(f"matmul-{M}x{N}x{K}-{dtype_str}", bench(lambda: triton.ops.matmul(a, b)))
+
+
+#######################
+# Flash-Attention
+#######################
+
+
+@pytest.mark.parametrize("Z, H, N_CTX, D_HEAD", [(4, 16, 2048, 64)])
+@pytest.mark.parametrize("mode", ["forward", "backward"])
+def test_flash_attention(Z, H, N_CTX, D_HEAD, mode):
+    if torch.cuda.get_device_capability()[0] < 8:
+        pytest.skip("Flash attention only supported for compute capability >= 80")
+    torch.manual_seed(20)
+    shape = (Z, H, N_CTX, D_HEAD)
+    q = torch.randn(shape, dtype=torch.float16, device="cuda").requires_grad_()
+    k = torch.randn(shape, dtype=torch.float16, device="cuda").requires_grad_()
+    v = torch.randn(shape, dtype=torch.float16, device="cuda").requires_grad_()
+    fn = lambda: triton.ops.attention(q, k, v, 0.2)
+    if mode == "backward":
+        o = fn()
+        do = torch.randn_like(o)
+        fn = lambda: o.backward(do, retain_graph=True)
+    check(f"attention-{Z}x{H}x{N_CTX}x{D_HEAD}-{mode}", bench(fn))
+
+
+#######################
+# Softmax
+#######################
+
+
+@triton.jit
+def _softmax(X, Y, stride, N, BLOCK: tl.constexpr):
+    row = tl.program_id(0)
+    cols = tl.arange(0, BLOCK)
+    x = tl.load(X + row * stride + cols, mask=cols < N, other=-float('inf')).to(tl.float32)
+    x = tl.exp(x - tl.max(x, axis=0))
+    y = x / tl.sum(x, axis=0)
+    tl.store(Y + row * stride + cols, y.to(Y.dtype.element_ty), mask=cols < N)
+
+
+@pytest.mark.parametrize("M, N", [(4096, 1024), (4096, 8192)])
+def test_softmax(M, N):
+    x = torch.randn((M, N), dtype=torch.float16, device='cuda')
+    y = torch.empty_like(x)
+    BLOCK = triton.next_power_of_2(N)
+    num_warps = min(max(BLOCK // 256, 1), 16)
+    check(f"softmax-{M}x{N}", bench(lambda: _softmax[(M,)](x, y, x.stride(0), N, BLOCK=BLOCK, num_warps=num_warps)))
+
+
+#######################
+# Layer-Norm
+#######################
+
+
+@triton.jit
+def _layer_norm(X, Y, W, B, stride, N, eps, BLOCK: tl.constexpr):
+    row = tl.program_id(0)
+    cols = tl.arange(0, BLOCK)
+    mask = cols < N
+    x = tl.load(X + row * stride + cols, mask=mask, other=0.).to(tl.float32)
+    mean = tl.sum(x, axis=0) / N
+    xc = tl.where(mask, x - mean, 0.)
+    rstd = 1 / tl.sqrt(tl.sum(xc * xc, axis=0) / N + eps)
+    w = tl.load(W + cols, mask=mask)
+    b = tl.load(B + cols, mask=mask)
+    tl.store(Y + row * stride + cols, (xc * rstd * w + b).to(Y.dtype.element_ty), mask=mask)
+
+
+@pytest.mark.parametrize("M, N", [(4096, 1024), (4096, 8192)])
+def test_layer_norm(M, N):
+    x = torch.randn((M, N), dtype=torch.float16, device='cuda')
+    w = torch.randn((N,), dtype=torch.float16, device='cuda')
+    b = torch.randn((N,), dtype=torch.float16, device='cuda')
+    y = torch.empty_like(x)
+    BLOCK = triton.next_power_of_2(N)
+    num_warps = min(max(BLOCK // 256, 1), 16)
+    fn = lambda: _layer_norm[(M,)](x, y, w, b, x.stride(0), N, 1e-5, BLOCK=BLOCK, num_warps=num_warps)
+    check(f"layer_norm-{M}x{N}", bench(fn))
+
+
+#######################
+# Reductions
+#######################
+
+
+@triton.jit
+def _sum_cols(X, Y, M, N, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr):
+    cols = tl.program_id(0) * BLOCK_N + tl.arange(0, BLOCK_N)
+    acc = tl.zeros([BLOCK_M, BLOCK_N], dtype=tl.float32)
+    for start in range(0, M, BLOCK_M):
+        rows = start + tl.arange(0, BLOCK_M)
+        mask = (rows[:, None] < M) & (cols[None, :] < N)
+        acc += tl.load(X + rows[:, None] * N + cols[None, :], mask=mask, other=0.)
+    tl.store(Y + cols, tl.sum(acc, axis=0), mask=cols < N)
+
+
+@pytest.mark.parametrize("M, N", [(4096, 4096), (65536, 256)])
+def test_reduction(M, N):
+    x = torch.randn((M, N), dtype=torch.float32, device='cuda')
+    y = torch.empty((N,), dtype=torch.float32, device='cuda')
+    fn = lambda: _sum_cols[(triton.cdiv(N, 64),)](x, y, M, N, BLOCK_M=64, BLOCK_N=64)
+    check(f"reduction-{M}x{N}", bench(fn))
+
+
+#######################
+# Atomics
+#######################
+
+
+@triton.jit
+def _histogram(X, HIST, N, BLOCK: tl.constexpr):
+    offs = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+    mask = offs < N
+    bins = tl.load(X + offs, mask=mask)
+    tl.atomic_add(HIST + bins, 1, mask=mask)
+
+
+@pytest.mark.parametrize("N, num_bins", [(1 << 24, 1024), (1 << 24, 16)])
+def test_atomics(N, num_bins):
+    x = torch.randint(0, num_bins, (N,), dtype=torch.int32, device='cuda')
+    hist = torch.zeros(num_bins, dtype=torch.int32, device='cuda')
+    fn = lambda: _histogram[(triton.cdiv(N, 1024),)](x, hist, N, BLOCK=1024)
+    check(f"atomics-{N}-{num_bins}bins", bench(fn))
+
+
+#######################
+# Launch Overhead
+#######################
+
+
+@triton.jit
+def _empty(X, Y, Z, N, M, BLOCK: tl.constexpr):
+    pass
+
+
+def test_launch_overhead():
+    # the host time per launch, so the launches are not captured in a graph
+    x = torch.empty(1, device='cuda')
+    _empty[(1,)](x, x, x, 1, 1, BLOCK=32)
+    torch.cuda.synchronize()
+    n_launches = 1000
+    times = []
+    for _ in range(20):
+        start = time.perf_counter()
+        for _ in range(n_launches):
+            _empty[(1,)](x, x, x, 1, 1, BLOCK=32)
+        times.append((time.perf_counter() - start) * 1e3 / n_launches)
+        torch.cuda.synchronize()
+    check("launch_overhead", triton.testing.get_bench_stats(times))
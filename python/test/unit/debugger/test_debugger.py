@@ -1,5 +1,6 @@
 import random
 
+import pytest
 import torch
 
 import triton
@@ -67,3 +68,63 @@ def test_atomic():
 
     atomic[(nb_dim, )](a)
     assert torch.allclose(a, torch.full_like(a, 2))
+
+
+@triton.jit(interpret=True)
+def _row_sums(x_ptr, out_ptr, n_cols, BLOCK_SIZE: tl.constexpr):
+    row = tl.program_id(axis=0)
+    offsets = tl.arange(0, BLOCK_SIZE)
+    cols = offsets[None, :]
+    x = tl.load(x_ptr + row * n_cols + cols, mask=cols < n_cols, other=0.)
+    tl.store(out_ptr + row, tl.sum(x, axis=1))
+    tl.atomic_add(out_ptr + 64, 1.)
+
+
+@pytest.mark.parametrize("device", ["cpu", "cuda"])
+@pytest.mark.parametrize("batch_size", ["1", "16", "4096"])
+def test_batched(device, batch_size, monkeypatch):
+    if device == "cuda" and not torch.cuda.is_available():
+        pytest.skip("no GPU")
+    monkeypatch.setenv("TRITON_INTERPRET_BATCH_SIZE", batch_size)
+    x = torch.rand((64, 20), device=device)
+    out = torch.zeros((65, ), device=device)
+    _row_sums[(64, )](x, out, 20, BLOCK_SIZE=32)
+    assert torch.allclose(out[:64], x.sum(1), atol=1e-5)
+    # the atomics of all the programs on the same address accumulate
+    assert out[64] == 64
+
+
+def test_divergent_programs():
+
+    @triton.jit(interpret=True)
+    def kernel(x_ptr):
+        pid = tl.program_id(axis=0)
+        if pid == 0:
+            tl.store(x_ptr + pid, 1)
+        else:
+            tl.store(x_ptr + pid, 2)
+        # the order of the exchanges is that of the programs
+        tl.atomic_xchg(x_ptr + 8, pid)
+
+    x = torch.zeros((9, ), dtype=torch.int32)
+    kernel[(8, )](x)
+    assert x[:8].tolist() == [1] + [2] * 7
+    assert 0 <= x[8] < 8
+
+
+@pytest.mark.parametrize("batch_size", ["1", "16", "4096"])
+def test_atomic_tickets(batch_size, monkeypatch):
+
+    @triton.jit(interpret=True)
+    def kernel(counter_ptr, out_ptr):
+        pid = tl.program_id(axis=0)
+        ticket = tl.atomic_add(counter_ptr, 1)
+        tl.store(out_ptr + pid, ticket)
+
+    monkeypatch.setenv("TRITON_INTERPRET_BATCH_SIZE", batch_size)
+    counter = torch.zeros((1, ), dtype=torch.int32)
+    out = torch.zeros((64, ), dtype=torch.int32)
+    kernel[(64, )](counter, out)
+    # every program gets the count of the programs before it
+    assert sorted(out.tolist()) == list(range(64))
+    assert counter[0] == 64
@@ -647,6 +647,64 @@ def test_unary_op(dtype_x, expr, device='cuda'):
 def test_math_op(dtype_x, expr, device='cuda'):
     _test_unary(dtype_x, f'tl.{expr}(x)', f'np.{expr}(x) ', device=device)
 
+
+@pytest.mark.parametrize("expr, ref, instr", [
+    ('tl.log(x)', np.log, 'lg2.approx.f32'),
+    ('tl.sin(x)', np.sin, 'sin.approx.f32'),
+    ('tl.math.tanh(x)', np.tanh, 'tanh.approx.f32'),
+    ('1.0 / x', np.reciprocal, 'rcp.approx.f32'),
+])
+def test_fast_math(expr, ref, instr, device='cuda'):
+    if torch.cuda.get_device_capability() < (7, 5):
+        pytest.skip("tanh.approx.f32 needs sm_75")
+
+    @triton.jit
+    def kernel(Z, X, SIZE: tl.constexpr):
+        off = tl.arange(0, SIZE)
+        x = tl.load(X + off)
+        z = GENERATE_TEST_HERE
+        tl.store(Z + off, z)
+
+    kernel = patch_kernel(kernel, {'GENERATE_TEST_HERE': expr})
+    kernel.fast_math = True
+    x = np.abs(numpy_random((128,), dtype_str='float32')) + 0.5
+    z_ref = ref(x)
+    x_tri = to_triton(x, device=device)
+    z_tri = to_triton(np.empty_like(z_ref), device=device)
+    pgm = kernel[(1,)](z_tri, x_tri, SIZE=128)
+    assert instr in pgm.asm["ptx"]
+    # tanh.approx.f32 has a relative error of about 2^-11
+    np.testing.assert_allclose(z_ref, to_numpy(z_tri), rtol=1e-3, atol=1e-3)
+
+
+def test_fast_math_masked_softmax(device='cuda'):
+    # fast math keeps the infinities: the max of the -inf padding of the rows
+    # shorter than the block must not turn the softmax into NaNs
+    @triton.jit
+    def kernel(Z, X, N, BLOCK: tl.constexpr):
+        row = tl.program_id(0)
+        off = tl.arange(0, BLOCK)
+        mask = off < N
+        x = tl.load(X + row * N + off, mask=mask, other=-float('inf'))
+        x = x - tl.max(x, axis=0)
+        num = tl.exp(x)
+        z = num / tl.sum(num, axis=0)
+        tl.store(Z + row * N + off, z, mask=mask)
+
+    kernel.fast_math = True
+    M, N = 16, 100
+    x = numpy_random((M, N), dtype_str='float32')
+    # a row of -inf but one element
+    x[3, 1:] = -np.inf
+    z_ref = np.exp(x - x.max(axis=1, keepdims=True))
+    z_ref /= z_ref.sum(axis=1, keepdims=True)
+    x_tri = to_triton(x, device=device)
+    z_tri = to_triton(np.empty_like(x), device=device)
+    kernel[(M,)](z_tri, x_tri, N, BLOCK=128)
+    z_tri = to_numpy(z_tri)
+    assert not np.isnan(z_tri).any()
+    np.testing.assert_allclose(z_ref, z_tri, rtol=1e-3, atol=1e-5)
+
 # ----------------
 # test abs
 # ----------------
@@ -1037,6 +1095,129 @@ def test_atomic_cas():
     np.testing.assert_allclose(to_numpy(data), to_numpy(ref))
 
 
+@pytest.mark.parametrize("scope", ["gpu", "sys"])
+def test_signal_wait(scope):
+    # the second program reads the data of the first one once it is signaled
+    @triton.jit
+    def kernel(X, Y, Flag, SCOPE: tl.constexpr):
+        offs = tl.arange(0, 128)
+        if tl.program_id(0) == 0:
+            tl.store(Y + offs, tl.load(X + offs) * 2)
+            tl.signal(Flag, 1, scope=SCOPE)
+        else:
+            tl.wait(Flag, 1, scope=SCOPE)
+            tl.store(Y + 128 + offs, tl.load(Y + offs) + 1)
+
+    x = torch.randn(128, device='cuda')
+    y = torch.zeros(256, device='cuda')
+    flag = torch.zeros(1, device='cuda', dtype=torch.int32)
+    h = kernel[(2,)](x, y, flag, SCOPE=scope)
+    torch.testing.assert_close(y[:128], 2 * x)
+    torch.testing.assert_close(y[128:], 2 * x + 1)
+    assert flag.item() == 1
+    assert f"ld.acquire.{scope}.global.b32" in h.asm["ptx"]
+    assert f"st.release.{scope}.global.b32" in h.asm["ptx"]
+
+
+def test_load_store_sem():
+    @triton.jit
+    def kernel(X, Y):
+        offs = tl.arange(0, 128)
+        x = tl.load(X + offs, sem="acquire", scope="sys")
+        tl.store(Y + offs, x, sem="release", scope="sys")
+
+    x = torch.randn(128, device='cuda')
+    y = torch.zeros(128, device='cuda')
+    h = kernel[(1,)](x, y)
+    torch.testing.assert_close(y, x)
+    assert "ld.acquire.sys.global" in h.asm["ptx"]
+    assert "st.release.sys.global" in h.asm["ptx"]
+
+
+def test_semaphore():
+    # every program adds its part to the counter, the last program waits for
+    # all of them and sums the partial results
+    @triton.jit
+    def kernel(X, Partials, Z, Counter, BLOCK: tl.constexpr):
+        pid = tl.program_id(0)
+        offs = tl.arange(0, BLOCK)
+        tl.store(Partials + pid * BLOCK + offs, tl.load(X + pid * BLOCK + offs) * 2)
+        tl.semaphore_signal(Counter, 1, add=True)
+        if pid == tl.num_programs(0) - 1:
+            tl.semaphore_wait(Counter, tl.num_programs(0))
+            acc = tl.zeros((BLOCK,), dtype=tl.float32)
+            for i in range(0, tl.num_programs(0)):
+                acc += tl.load(Partials + i * BLOCK + offs)
+            tl.store(Z + offs, acc)
+
+    BLOCK, num_pids = 128, 16
+    x = torch.randn((num_pids, BLOCK), device='cuda')
+    partials = torch.empty_like(x)
+    z = torch.empty((BLOCK,), device='cuda')
+    counter = torch.zeros((1,), device='cuda', dtype=torch.int32)
+    h = kernel[(num_pids,)](x, partials, z, counter, BLOCK=BLOCK)
+    torch.testing.assert_close(z, 2 * x.sum(0), rtol=1e-4, atol=1e-4)
+    assert counter.item() == num_pids
+    ptx = h.asm["ptx"]
+    assert "ld.acquire.gpu.global.b32" in ptx
+    assert "red.global.release.gpu.add.s32" in ptx
+    assert "nanosleep.u32" in ptx
+
+
+# enough programs to be spread over all the SMs
+@pytest.mark.parametrize("grid", [(1,), (64,), (8, 4, 2), (4096,)])
+def test_grid_sum(grid):
+    @triton.jit
+    def kernel(X, Z, Partials, Counter, BLOCK: tl.constexpr):
+        pid = tl.program_id(0) + (tl.program_id(1) + tl.program_id(2) * tl.num_programs(1)) * tl.num_programs(0)
+        x = tl.load(X + pid * BLOCK + tl.arange(0, BLOCK))
+        z, is_last = tl.grid_sum(x, Partials, Counter)
+        if is_last:
+            tl.store(Z + tl.arange(0, BLOCK), z)
+
+    BLOCK = 128
+    num_pids = int(np.prod(grid))
+    x = torch.randn((num_pids, BLOCK), device='cuda', dtype=torch.float32)
+    z = torch.empty((BLOCK,), device='cuda', dtype=torch.float32)
+    partials = torch.empty((num_pids, BLOCK), device='cuda', dtype=torch.float32)
+    counter = torch.zeros((1,), device='cuda', dtype=torch.int32)
+    h = kernel[grid](x, z, partials, counter, BLOCK=BLOCK)
+    np.testing.assert_allclose(to_numpy(z), to_numpy(x.sum(0)), rtol=1e-4, atol=1e-3)
+    # the ticket orders the partials of the other programs
+    assert "atom.global.acq_rel.gpu.add.s32" in h.asm["ptx"]
+    # the counter is reset for the next launch, and the result is the same
+    assert counter.item() == 0
+    z_ref = z.clone()
+    for _ in range(10):
+        kernel[grid](x, z, partials, counter, BLOCK=BLOCK)
+        assert torch.equal(z, z_ref)
+
+
+@pytest.mark.parametrize("chunk_size", [64, 1024])
+def test_multi_tensor_chunk(chunk_size):
+    @triton.jit
+    def axpy(XS, YS, alpha, BLOCK: tl.constexpr):
+        chunk = tl.program_id(0)
+        x, n = tl.multi_tensor_chunk(XS, chunk, tl.float32)
+        y, _ = tl.multi_tensor_chunk(YS, chunk, tl.float16)
+        for start in range(0, n, BLOCK):
+            offs = start + tl.arange(0, BLOCK)
+            mask = offs < n
+            y_new = tl.load(y + offs, mask=mask) + alpha * tl.load(x + offs, mask=mask)
+            tl.store(y + offs, y_new.to(tl.float16), mask=mask)
+
+    shapes = [(3,), (100, 7), (1000,), (0,), (33, 65)]
+    xs = [torch.randn(shape, device='cuda') for shape in shapes]
+    ys = [torch.randn(shape, device='cuda', dtype=torch.float16) for shape in shapes]
+    refs = [y + 2 * x for x, y in zip(xs, ys)]
+    x_list = triton.runtime.TensorList(xs, chunk_size)
+    y_list = triton.runtime.TensorList(ys, chunk_size)
+    assert x_list.num_chunks == sum(triton.cdiv(x.numel(), chunk_size) for x in xs)
+    axpy[x_list.grid](x_list, y_list, 2., BLOCK=64)
+    for y, ref in zip(ys, refs):
+        torch.testing.assert_close(y, ref.to(torch.float16))
+
+
 # ---------------
 # test cast
 # ---------------
@@ -1694,6 +1875,215 @@ def test_generic_reduction(device='cuda'):
     torch.testing.assert_close(out_var, expect_var)
 
 
+# ---------------
+# test scan
+# ---------------
+
+
+scan2d_shapes = [(8, 32), (16, 32), (32, 16), (2, 1024), (1024, 2), (32, 32), (1, 1024)]
+
+scan_configs = [
+    (op, type, shape, axis)
+    for type in ['int32', 'float32']
+    for axis in [1, 0]
+    for shape in scan2d_shapes
+    for op in ['cumsum', 'cumprod']
+]
+
+
+@pytest.mark.parametrize("op, dtype_str, shape, axis", scan_configs)
+def test_scan2d(op, dtype_str, shape, axis, device='cuda'):
+    check_type_supported(dtype_str)
+
+    # triton kernel
+    @triton.jit
+    def kernel(X, Z, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, AXIS: tl.constexpr):
+        range_m = tl.arange(0, BLOCK_M)
+        range_n = tl.arange(0, BLOCK_N)
+        x = tl.load(X + range_m[:, None] * BLOCK_N + range_n[None, :])
+        z = GENERATE_TEST_HERE
+        tl.store(Z + range_m[:, None] * BLOCK_N + range_n[None, :], z)
+
+    kernel = patch_kernel(kernel, {'GENERATE_TEST_HERE': f'tl.{op}(x, axis={axis})'})
+    # input
+    rs = RandomState(17)
+    x = numpy_random(shape, dtype_str=dtype_str, rs=rs)
+    z = np.empty_like(x)
+    x_tri = to_triton(x, device=device)
+    numpy_op = {'cumsum': np.cumsum, 'cumprod': np.cumprod}[op]
+    z_dtype_str = dtype_str
+    z_ref = numpy_op(x, axis=axis).astype(getattr(np, z_dtype_str))
+    # triton result
+    z_tri = to_triton(z, device=device)
+    kernel[(1,)](x_tri, z_tri, BLOCK_M=shape[0], BLOCK_N=shape[1], AXIS=axis)
+    z_tri = to_numpy(z_tri)
+    # compare
+    if dtype_str == 'float32':
+        if op == 'cumprod':
+            np.testing.assert_allclose(z_ref, z_tri, rtol=0.01, atol=1e-3)
+        else:
+            np.testing.assert_allclose(z_ref, z_tri, rtol=0.01)
+    else:
+        np.testing.assert_equal(z_ref, z_tri)
+
+
+@pytest.mark.parametrize("M, N", [[32, 16], [32, 32], [32, 64], [64, 32]])
+@pytest.mark.parametrize("src_layout", [BlockedLayout([1, 4], [4, 8], [4, 1], [0, 1]),
+                                        BlockedLayout([1, 4], [4, 8], [4, 1], [1, 0]),
+                                        BlockedLayout([2, 2], [8, 4], [2, 2], [1, 0])])
+@pytest.mark.parametrize("axis", [0, 1])
+def test_scan_layouts(M, N, src_layout, axis, device='cuda'):
+    ir = f"""
+    #blocked = {src_layout}
+    module attributes {{"triton_gpu.num-warps" = 4 : i32}} {{
+    tt.func public @kernel_0d1d(%arg0: !tt.ptr<i32> {{tt.divisibility = 16 : i32}}, %arg1: !tt.ptr<i32> {{tt.divisibility = 16 : i32}}) {{
+      %cst = arith.constant dense<{N}> : tensor<{M}x1xi32, #blocked>
+      %0 = tt.make_range {{end = {M} : i32, start = 0 : i32}} : tensor<{M}xi32, #triton_gpu.slice<{{dim = 1, parent = #blocked}}>>
+      %1 = tt.expand_dims %0 {{axis = 1 : i32}} : (tensor<{M}xi32, #triton_gpu.slice<{{dim = 1, parent = #blocked}}>>) -> tensor<{M}x1xi32, #blocked>
+      %2 = arith.muli %1, %cst : tensor<{M}x1xi32, #blocked>
+      %3 = tt.splat %arg0 : (!tt.ptr<i32>) -> tensor<{M}x1x!tt.ptr<i32>, #blocked>
+      %4 = tt.addptr %3, %2 : tensor<{M}x1x!tt.ptr<i32>, #blocked>, tensor<{M}x1xi32, #blocked>
+      %5 = tt.make_range {{end = {N} : i32, start = 0 : i32}} : tensor<{N}xi32, #triton_gpu.slice<{{dim = 0, parent = #blocked}}>>
+      %6 = tt.expand_dims %5 {{axis = 0 : i32}} : (tensor<{N}xi32, #triton_gpu.slice<{{dim = 0, parent = #blocked}}>>) -> tensor<1x{N}xi32, #blocked>
+      %7 = tt.broadcast %4 : (tensor<{M}x1x!tt.ptr<i32>, #blocked>) -> tensor<{M}x{N}x!tt.ptr<i32>, #blocked>
+      %8 = tt.broadcast %6 : (tensor<1x{N}xi32, #blocked>) -> tensor<{M}x{N}xi32, #blocked>
+      %9 = tt.addptr %7, %8 : tensor<{M}x{N}x!tt.ptr<i32>, #blocked>, tensor<{M}x{N}xi32, #blocked>
+      %10 = tt.load %9 {{cache = 1 : i32, evict = 1 : i32, isVolatile = false}} : tensor<{M}x{N}xi32, #blocked>
+      %11 = "tt.scan"(%10) ({{
+      ^bb0(%arg2: i32, %arg3: i32):
+        %16 = arith.addi %arg2, %arg3 : i32
+        tt.scan.return %16 : i32
+      }}) {{axis = {axis} : i32}} : (tensor<{M}x{N}xi32, #blocked>) -> tensor<{M}x{N}xi32, #blocked>
+      %12 = tt.splat %arg1 : (!tt.ptr<i32>) -> tensor<{M}x1x!tt.ptr<i32>, #blocked>
+      %13 = tt.addptr %12, %2 : tensor<{M}x1x!tt.ptr<i32>, #blocked>, tensor<{M}x1xi32, #blocked>
+      %14 = tt.broadcast %13 : (tensor<{M}x1x!tt.ptr<i32>, #blocked>) -> tensor<{M}x{N}x!tt.ptr<i32>, #blocked>
+      %15 = tt.addptr %14, %8 : tensor<{M}x{N}x!tt.ptr<i32>, #blocked>, tensor<{M}x{N}xi32, #blocked>
+      tt.store %15, %11 {{cache = 1 : i32, evict = 1 : i32}} : tensor<{M}x{N}xi32, #blocked>
+      tt.return
+    }}
+    }}
+    """
+
+    import tempfile
+    with tempfile.NamedTemporaryFile(mode='w', suffix='.ttgir') as f:
+        f.write(ir)
+        f.flush()
+        kernel = triton.compile(f.name)
+    rs = RandomState(17)
+    x = rs.randint(-100, 100, (M, N)).astype('int32')
+
+    z = np.zeros((M, N)).astype('int32')
+    x_tri = torch.tensor(x, device=device)
+    z_tri = torch.tensor(z, device=device)
+
+    kernel[(1, 1, 1)](x_tri, z_tri)
+
+    z_ref = np.cumsum(x, axis=axis)
+
+    np.testing.assert_equal(z_ref, z_tri.cpu().numpy())
+
+
+# ---------------
+# test sort
+# ---------------
+
+
+@pytest.mark.parametrize("M, N", [[1, 512], [8, 64], [4, 2048], [32, 32]])
+@pytest.mark.parametrize("descending", [False, True])
+@pytest.mark.parametrize("dtype_str", ['int32', 'uint32', 'float16', 'float32'])
+def test_sort(M, N, descending, dtype_str, device='cuda'):
+    check_type_supported(dtype_str)
+
+    @triton.jit
+    def kernel(X, Z, I, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, DESCENDING: tl.constexpr):
+        offs_m = tl.arange(0, BLOCK_M)[:, None]
+        offs_n = tl.arange(0, BLOCK_N)[None, :]
+        x = tl.load(X + offs_m * BLOCK_N + offs_n)
+        index = tl.broadcast_to(offs_n, (BLOCK_M, BLOCK_N))
+        z, i = tl.sort((x, index), descending=DESCENDING)
+        tl.store(Z + offs_m * BLOCK_N + offs_n, z)
+        tl.store(I + offs_m * BLOCK_N + offs_n, i)
+
+    rs = RandomState(17)
+    x = numpy_random((M, N), dtype_str=dtype_str, rs=rs)
+    z_ref = np.sort(x, axis=1)
+    if descending:
+        z_ref = z_ref[:, ::-1]
+    x_tri = to_triton(x, device=device)
+    z_tri = to_triton(np.empty_like(x), device=device)
+    i_tri = to_triton(np.empty((M, N), dtype=np.int32), device=device)
+    kernel[(1,)](x_tri, z_tri, i_tri, BLOCK_M=M, BLOCK_N=N, DESCENDING=descending)
+    z_tri = to_numpy(z_tri)
+    np.testing.assert_equal(z_ref, z_tri)
+    # the indices are a permutation that gathers the sorted values
+    np.testing.assert_equal(np.take_along_axis(x, to_numpy(i_tri).astype(np.int64), axis=1), z_tri)
+
+
+@pytest.mark.parametrize("M, N, K", [[1, 512, 8], [8, 64, 4], [4, 2048, 32], [16, 16, 16]])
+def test_topk(M, N, K, device='cuda'):
+
+    @triton.jit
+    def kernel(X, Z, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, K: tl.constexpr):
+        offs_m = tl.arange(0, BLOCK_M)[:, None]
+        x = tl.load(X + offs_m * BLOCK_N + tl.arange(0, BLOCK_N)[None, :])
+        z = tl.topk(x, K)
+        tl.store(Z + offs_m * K + tl.arange(0, K)[None, :], z)
+
+    rs = RandomState(17)
+    x = numpy_random((M, N), dtype_str='float32', rs=rs)
+    z_ref = np.sort(x, axis=1)[:, ::-1][:, :K]
+    x_tri = to_triton(x, device=device)
+    z_tri = to_triton(np.empty((M, K), dtype=np.float32), device=device)
+    kernel[(1,)](x_tri, z_tri, BLOCK_M=M, BLOCK_N=N, K=K)
+    np.testing.assert_equal(z_ref, to_numpy(z_tri))
+
+
+# ---------------
+# test histogram
+# ---------------
+
+
+@pytest.mark.parametrize("N, num_bins", [[512, 64], [2048, 16], [128, 512]])
+@pytest.mark.parametrize("dtype_str", ['int8', 'int32', 'int64'])
+def test_histogram(N, num_bins, dtype_str, device='cuda'):
+
+    @triton.jit
+    def kernel(X, Z, N: tl.constexpr, NUM_BINS: tl.constexpr):
+        x = tl.load(X + tl.arange(0, N))
+        z = tl.histogram(x, NUM_BINS)
+        tl.atomic_add(Z + tl.arange(0, NUM_BINS), z)
+
+    rs = RandomState(17)
+    # values outside of [0, num_bins) are not counted
+    x = rs.randint(-4, min(num_bins + 4, 127), size=(N,)).astype(dtype_str)
+    z_ref = np.bincount(x[(x >= 0) & (x < num_bins)], minlength=num_bins)
+    x_tri = to_triton(x, device=device)
+    z_tri = to_triton(np.zeros((num_bins,), dtype=np.int32), device=device)
+    kernel[(1,)](x_tri, z_tri, N=N, NUM_BINS=num_bins)
+    np.testing.assert_equal(z_ref, to_numpy(z_tri))
+
+
+@pytest.mark.parametrize("dtype_str", ['uint8', 'uint16', 'uint32'])
+def test_histogram_unsigned(dtype_str, device='cuda'):
+
+    @triton.jit
+    def kernel(X, Z, N: tl.constexpr, NUM_BINS: tl.constexpr):
+        x = tl.load(X + tl.arange(0, N))
+        z = tl.histogram(x, NUM_BINS)
+        tl.atomic_add(Z + tl.arange(0, NUM_BINS), z)
+
+    N, num_bins = 1024, 256
+    rs = RandomState(17)
+    # the values above 127 count in their bins, the ones above 255 in none
+    x = rs.randint(0, 300 if dtype_str != 'uint8' else 256, size=(N,)).astype(dtype_str)
+    x[:4] = [128, 200, 255, 255]
+    z_ref = np.bincount(x[x < num_bins], minlength=num_bins)
+    x_tri = to_triton(x, device=device)
+    z_tri = to_triton(np.zeros((num_bins,), dtype=np.int32), device=device)
+    kernel[(1,)](x_tri, z_tri, N=N, NUM_BINS=num_bins)
+    np.testing.assert_equal(z_ref, to_numpy(z_tri))
+
+
 # ---------------
 # test permute
 # ---------------
@@ -1743,6 +2133,25 @@ def test_permute(dtype_str, shape, perm, device='cuda'):
     assert 'ld.global.v4' in ptx
     assert 'st.global.v4' in ptx
 
+
+@pytest.mark.parametrize("dtype_str, shape", [(dtype, shape)
+                                              for dtype in ['float16', 'float32']
+                                              for shape in [(16, 64), (64, 64), (128, 32)]])
+def test_trans(dtype_str, shape, device='cuda'):
+
+    @triton.jit
+    def kernel(X, Z, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr):
+        off_m = tl.arange(0, BLOCK_M)
+        off_n = tl.arange(0, BLOCK_N)
+        x = tl.load(X + off_m[:, None] * BLOCK_N + off_n[None, :])
+        tl.store(Z + off_n[:, None] * BLOCK_M + off_m[None, :], tl.trans(x))
+
+    x = numpy_random(shape, dtype_str=dtype_str)
+    x_tri = to_triton(x, device=device, dst_type=dtype_str)
+    z_tri = to_triton(np.empty_like(x.T), device=device, dst_type=dtype_str)
+    kernel[(1,)](x_tri, z_tri, BLOCK_M=shape[0], BLOCK_N=shape[1])
+    np.testing.assert_equal(to_numpy(z_tri), x.T)
+
 # ---------------
 # test dot
 # ---------------
@@ -1934,6 +2343,248 @@ def test_dot(M, N, K, num_warps, col_a, col_b, epilogue, allow_tf32, in_dtype, o
         assert 'mma.sync.aligned.m16n8k16.row.col.f16.f16.f16.f16' in ptx
 
 
+@pytest.mark.parametrize("M, N, K, P, dtype", [(64, N, 32, P, dtype)
+                                              for N, P in [(64, 64), (32, 128), (128, 32)]
+                                              for dtype in ['float16', 'float32', 'int8']])
+def test_chained_dot(M, N, K, P, dtype, device='cuda'):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 8:
+        pytest.skip("Only test chained dots on devices with sm >= 80")
+
+    # the result of the first dot is $a of the second one, in registers
+    @triton.jit
+    def kernel(X, Y, W, Z, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr,
+               BLOCK_P: tl.constexpr):
+        rm = tl.arange(0, BLOCK_M)
+        rn = tl.arange(0, BLOCK_N)
+        rk = tl.arange(0, BLOCK_K)
+        rp = tl.arange(0, BLOCK_P)
+        x = tl.load(X + rm[:, None] * BLOCK_K + rk[None, :])
+        y = tl.load(Y + rk[:, None] * BLOCK_N + rn[None, :])
+        w = tl.load(W + rn[:, None] * BLOCK_P + rp[None, :])
+        xy = tl.dot(x, y)
+        z = tl.dot(xy.to(w.dtype), w)
+        tl.store(Z + rm[:, None] * BLOCK_P + rp[None, :], z)
+
+    rs = RandomState(17)
+    if dtype == 'int8':
+        # small values so that the intermediate result fits in int8
+        x = rs.randint(-2, 3, (M, K)).astype(np.int8)
+        y = rs.randint(0, 2, (K, N)).astype(np.int8)
+        w = rs.randint(-3, 4, (N, P)).astype(np.int8)
+        xy = np.matmul(x.astype(np.int32), y.astype(np.int32)).astype(np.int8)
+        z_ref = np.matmul(xy.astype(np.int32), w.astype(np.int32))
+    else:
+        x = numpy_random((M, K), dtype_str=dtype, rs=rs)
+        y = numpy_random((K, N), dtype_str=dtype, rs=rs)
+        w = numpy_random((N, P), dtype_str=dtype, rs=rs)
+        xy = np.matmul(x.astype(np.float32), y.astype(np.float32)).astype(dtype)
+        z_ref = np.matmul(xy.astype(np.float32), w.astype(np.float32))
+    z_dtype = np.int32 if dtype == 'int8' else np.float32
+    x_tri, y_tri, w_tri = to_triton(x, device=device), to_triton(y, device=device), to_triton(w, device=device)
+    z_tri = to_triton(np.empty((M, P), dtype=z_dtype), device=device)
+    kernel[(1,)](x_tri, y_tri, w_tri, z_tri, BLOCK_M=M, BLOCK_N=N, BLOCK_K=K, BLOCK_P=P)
+    if dtype == 'int8':
+        np.testing.assert_equal(z_ref, to_numpy(z_tri))
+    else:
+        np.testing.assert_allclose(z_ref, to_numpy(z_tri), rtol=0.01, atol=1e-2)
+
+
+@pytest.mark.parametrize("M, N, K", [(64, 64, 64), (128, 64, 32)])
+def test_dot_scaled_int8(M, N, K, device='cuda'):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 8:
+        pytest.skip("Only test int8 weights on devices with sm >= 80")
+
+    # weight-only quantization: B is stored as int8 with one scale per column
+    @triton.jit
+    def kernel(X, W, S, Z, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr):
+        rm = tl.arange(0, BLOCK_M)
+        rn = tl.arange(0, BLOCK_N)
+        rk = tl.arange(0, BLOCK_K)
+        x = tl.load(X + rm[:, None] * BLOCK_K + rk[None, :])
+        w = tl.load(W + rk[:, None] + rn[None, :] * BLOCK_K)
+        s = tl.load(S + rn)
+        z = tl.dot(x, w.to(tl.float16) * s[None, :])
+        tl.store(Z + rm[:, None] * BLOCK_N + rn[None, :], z)
+
+    x = torch.randn((M, K), device=device, dtype=torch.float16)
+    w = torch.randint(-128, 128, (N, K), device=device, dtype=torch.int8)
+    s = torch.rand((N,), device=device, dtype=torch.float16) / 64
+    z = torch.empty((M, N), device=device, dtype=torch.float32)
+    pgm = kernel[(1,)](x, w, s, z, BLOCK_M=M, BLOCK_N=N, BLOCK_K=K)
+    z_ref = torch.matmul(x.float(), (w.float() * s.float()[:, None]).t())
+    torch.testing.assert_close(z, z_ref, rtol=1e-2, atol=1e-2)
+    # the weights reach the dot operand layout as int8
+    assert re.search(rf"arith.sitofp %\S+ : tensor<{K}x{N}xi8, #triton_gpu.dot_op<{{opIdx = 1", pgm.asm['ttgir'])
+    assert 'mma.sync.aligned.m16n8k16.row.col.f32.f16.f16.f32' in pgm.asm['ptx']
+
+
+@pytest.mark.parametrize("input_precision", ["tf32", "tf32x3", "ieee"])
+def test_dot_input_precision(input_precision, device='cuda'):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 8 and input_precision != "ieee":
+        pytest.skip("Only test tf32 on devices with sm >= 80")
+
+    @triton.jit
+    def kernel(X, Y, Z, BLOCK: tl.constexpr, INPUT_PRECISION: tl.constexpr):
+        off = tl.arange(0, BLOCK)
+        x = tl.load(X + off[:, None] * BLOCK + off[None, :])
+        y = tl.load(Y + off[:, None] * BLOCK + off[None, :])
+        z = tl.dot(x, y, input_precision=INPUT_PRECISION)
+        tl.store(Z + off[:, None] * BLOCK + off[None, :], z)
+
+    BLOCK = 64
+    x = torch.randn((BLOCK, BLOCK), device=device, dtype=torch.float32)
+    y = torch.randn((BLOCK, BLOCK), device=device, dtype=torch.float32)
+    z = torch.empty_like(x)
+    pgm = kernel[(1,)](x, y, z, BLOCK=BLOCK, INPUT_PRECISION=input_precision)
+    z_ref = torch.matmul(x.double(), y.double())
+    error = (z.double() - z_ref).abs().max().item()
+    if input_precision == "tf32":
+        assert error > 1e-4
+    else:
+        # the three TF32 products are about as accurate as fp32
+        assert error < 1e-4
+    num_dots = pgm.asm['ttir'].count('tt.dot')
+    assert num_dots == (3 if input_precision == "tf32x3" else 1)
+    if input_precision != "ieee":
+        assert 'mma.sync.aligned.m16n8k8.row.col.f32.tf32.tf32.f32' in pgm.asm['ptx']
+
+
+@pytest.mark.parametrize("M, N, K, trans_b", [(64, 64, 32, False), (128, 128, 64, True)])
+def test_dot_wgmma(M, N, K, trans_b, device='cuda'):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 9:
+        pytest.skip("Only test wgmma on devices with sm >= 90")
+
+    @triton.jit
+    def kernel(X, Y, Z, stride_yk, stride_yn, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr):
+        rm = tl.arange(0, BLOCK_M)
+        rn = tl.arange(0, BLOCK_N)
+        rk = tl.arange(0, BLOCK_K)
+        x = tl.load(X + rm[:, None] * BLOCK_K + rk[None, :])
+        y = tl.load(Y + rk[:, None] * stride_yk + rn[None, :] * stride_yn)
+        z = tl.dot(x, y)
+        tl.store(Z + rm[:, None] * BLOCK_N + rn[None, :], z)
+
+    x = torch.randn((M, K), device=device, dtype=torch.float16)
+    y = torch.randn((N, K), device=device, dtype=torch.float16).t() if trans_b else \
+        torch.randn((K, N), device=device, dtype=torch.float16)
+    z = torch.empty((M, N), device=device, dtype=torch.float32)
+    pgm = kernel[(1,)](x, y, z, y.stride(0), y.stride(1), BLOCK_M=M, BLOCK_N=N, BLOCK_K=K, num_warps=4)
+    torch.testing.assert_close(z, torch.matmul(x.float(), y.float()), rtol=1e-2, atol=1e-2)
+    assert f'wgmma.mma_async.sync.aligned.m64n{N}k16.f32.f16.f16' in pgm.asm['ptx']
+
+
+@pytest.mark.parametrize("M, N, K, BLOCK_K", [(64, 64, 128, 32), (32, 64, 96, 16)])
+def test_manual_pipelining(M, N, K, BLOCK_K, device='cuda'):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 8:
+        pytest.skip("Only test asynchronous copies on devices with sm >= 80")
+
+    # the tiles of the next iteration are copied while the current ones are
+    # multiplied, the loop is not pipelined by the compiler
+    @triton.jit
+    def kernel(X, Y, Z, K, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr):
+        rm = tl.arange(0, BLOCK_M)
+        rn = tl.arange(0, BLOCK_N)
+        rk = tl.arange(0, BLOCK_K)
+        x_ptrs = X + rm[:, None] * K + rk[None, :]
+        y_ptrs = Y + rk[:, None] * BLOCK_N + rn[None, :]
+        x_buf = tl.smem_alloc((BLOCK_M, BLOCK_K), tl.float16, stages=2)
+        y_buf = tl.smem_alloc((BLOCK_K, BLOCK_N), tl.float16, stages=2)
+        x_buf = tl.async_copy(x_buf, 0, x_ptrs)
+        y_buf = tl.async_copy(y_buf, 0, y_ptrs)
+        acc = tl.zeros((BLOCK_M, BLOCK_N), dtype=tl.float32)
+        for k in range(0, K // BLOCK_K):
+            x_ptrs += BLOCK_K
+            y_ptrs += BLOCK_K * BLOCK_N
+            has_next = k + 1 < K // BLOCK_K
+            x_buf = tl.async_copy(x_buf, (k + 1) % 2, x_ptrs, mask=has_next)
+            y_buf = tl.async_copy(y_buf, (k + 1) % 2, y_ptrs, mask=has_next)
+            tl.async_wait(2)
+            x = tl.smem_load(x_buf, k % 2)
+            y = tl.smem_load(y_buf, k % 2)
+            acc += tl.dot(x, y)
+        tl.store(Z + rm[:, None] * BLOCK_N + rn[None, :], acc)
+
+    x = torch.randn((M, K), device=device, dtype=torch.float16)
+    y = torch.randn((K, N), device=device, dtype=torch.float16)
+    z = torch.empty((M, N), device=device, dtype=torch.float32)
+    pgm = kernel[(1,)](x, y, z, K, BLOCK_M=M, BLOCK_N=N, BLOCK_K=BLOCK_K, num_warps=4, num_stages=1)
+    torch.testing.assert_close(z, torch.matmul(x.float(), y.float()), rtol=1e-2, atol=1e-2)
+    assert 'cp.async' in pgm.asm['ptx']
+
+
+def test_smem_load_blocked(device='cuda'):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 8:
+        pytest.skip("Only test asynchronous copies on devices with sm >= 80")
+
+    # the tiles are read from shared memory into registers, and the masked
+    # out elements of a copy are zeros
+    @triton.jit
+    def kernel(X, Z, BLOCK: tl.constexpr):
+        offs = tl.arange(0, BLOCK)[:, None] * BLOCK + tl.arange(0, BLOCK)[None, :]
+        buf = tl.smem_alloc((BLOCK, BLOCK), tl.float32, stages=2)
+        buf = tl.async_copy(buf, 0, X + offs)
+        buf = tl.async_copy(buf, 1, X + offs, mask=offs < BLOCK * BLOCK // 2)
+        tl.async_wait(0)
+        tl.store(Z + offs, tl.smem_load(buf, 0) + 2 * tl.smem_load(buf, 1))
+
+    x = torch.randn((32, 32), device=device, dtype=torch.float32)
+    z = torch.empty_like(x)
+    kernel[(1,)](x, z, BLOCK=32)
+    ref = x.clone()
+    ref[:16] *= 3
+    torch.testing.assert_close(z, ref)
+
+
+def _compress_2_4(x):
+    # keeps the 2 largest values of every group of 4 of the rows of x, and
+    # returns them with their int16 metadata in the format of tl.dot
+    M, K = x.shape
+    groups = x.reshape(M, K // 4, 4)
+    idx = groups.abs().topk(2, dim=-1).indices.sort(dim=-1).values
+    values = groups.gather(-1, idx).reshape(M, K // 2)
+    nibbles = (idx[..., 0] | (idx[..., 1] << 2)).reshape(M, K // 16, 4)
+    meta = sum(nibbles[..., q] << (4 * q) for q in range(4))
+    meta = torch.where(meta >= 1 << 15, meta - (1 << 16), meta).to(torch.int16)
+    dense = torch.zeros_like(groups).scatter(-1, idx, groups.gather(-1, idx)).reshape(M, K)
+    return values, meta, dense
+
+
+@pytest.mark.parametrize("M, N, K, num_warps", [(16, 16, 32, 1), (64, 64, 64, 4), (128, 64, 128, 8)])
+@pytest.mark.parametrize("dtype_str", ['float16', 'bfloat16'])
+def test_sparse_dot(M, N, K, num_warps, dtype_str, device='cuda'):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 8:
+        pytest.skip("Only test sparse dots on devices with sm >= 80")
+
+    @triton.jit
+    def kernel(X, E, Y, Z, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr):
+        rm = tl.arange(0, BLOCK_M)
+        rn = tl.arange(0, BLOCK_N)
+        rk = tl.arange(0, BLOCK_K)
+        rh = tl.arange(0, BLOCK_K // 2)
+        re = tl.arange(0, BLOCK_K // 16)
+        x = tl.load(X + rm[:, None] * (BLOCK_K // 2) + rh[None, :])
+        e = tl.load(E + rm[:, None] * (BLOCK_K // 16) + re[None, :])
+        y = tl.load(Y + rk[:, None] * BLOCK_N + rn[None, :])
+        z = tl.dot(x, y, sparse_meta=e)
+        tl.store(Z + rm[:, None] * BLOCK_N + rn[None, :], z)
+
+    dtype = getattr(torch, dtype_str)
+    values, meta, dense = _compress_2_4(torch.randn((M, K), device=device, dtype=dtype))
+    y = torch.randn((K, N), device=device, dtype=dtype)
+    z = torch.empty((M, N), device=device, dtype=torch.float32)
+    pgm = kernel[(1,)](values.contiguous(), meta.contiguous(), y, z, BLOCK_M=M, BLOCK_N=N, BLOCK_K=K,
+                       num_warps=num_warps)
+    torch.testing.assert_close(z, torch.matmul(dense.float(), y.float()), rtol=1e-2, atol=1e-2)
+    assert 'mma.sp.sync.aligned.m16n8k32' in pgm.asm['ptx']
+
+
 @pytest.mark.parametrize("dtype_str", int_dtypes + float_dtypes + ['bfloat16'])
 def test_full(dtype_str):
     dtype = getattr(torch, dtype_str)
@@ -2088,6 +2739,102 @@ def test_masked_load_shared_memory(dtype, device='cuda'):
     torch.testing.assert_allclose(out, reference_out, atol=1e-2, rtol=0)
 
 
+def test_inline_asm():
+    x = torch.randint(-2**31, 2**31 - 1, (128,), dtype=torch.int32, device='cuda')
+    y = torch.randint(-2**31, 2**31 - 1, (128,), dtype=torch.int32, device='cuda')
+    z = torch.empty_like(x)
+
+    @triton.jit
+    def kernel(X, Y, Z, n: tl.constexpr, BLOCK: tl.constexpr):
+        x = tl.load(X + tl.arange(0, BLOCK))
+        y = tl.load(Y + tl.arange(0, BLOCK))
+        s = tl.full([BLOCK], n, tl.int32)
+        z = tl.inline_asm_elementwise("shf.l.wrap.b32 $0, $1, $2, $3;", "=r,r,r,r", [x, y, s], dtype=tl.int32,
+                                      is_pure=True, pack=1)
+        tl.store(Z + tl.arange(0, BLOCK), z)
+
+    n = 17
+    kernel[(1,)](x, y, z, n, BLOCK=128)
+    # the funnel shift of y:x
+    x, y = x.cpu().numpy().view(np.uint32), y.cpu().numpy().view(np.uint32)
+    np.testing.assert_equal((y << n) | (x >> (32 - n)), z.cpu().numpy().view(np.uint32))
+
+
+@pytest.mark.parametrize("pack", [1, 2, 4, 8])
+def test_inline_asm_packed(pack):
+    x = torch.randint(0, 256, (512,), dtype=torch.uint8, device='cuda')
+    y = torch.empty_like(x)
+
+    @triton.jit
+    def kernel(X, Y, BLOCK: tl.constexpr, PACK: tl.constexpr, ASM: tl.constexpr, CONSTRAINTS: tl.constexpr):
+        x = tl.load(X + tl.arange(0, BLOCK))
+        y = tl.inline_asm_elementwise(ASM, CONSTRAINTS, [x], dtype=tl.uint8, is_pure=True, pack=PACK)
+        tl.store(Y + tl.arange(0, BLOCK), y)
+
+    # the low nibble of every byte, on whole registers of bytes
+    if pack == 1:
+        asm, constraints = "and.b16 $0, $1, 0x0f;", "=c,c"
+    elif pack == 2:
+        asm, constraints = "and.b16 $0, $1, 0x0f0f;", "=h,h"
+    else:
+        regs = pack // 4
+        asm = " ".join(f"and.b32 ${i}, ${i + regs}, 0x0f0f0f0f;" for i in range(regs))
+        constraints = ",".join(["=r"] * regs + ["r"] * regs)
+    # 16 elements per thread
+    pgm = kernel[(1,)](x, y, BLOCK=512, PACK=pack, ASM=asm, CONSTRAINTS=constraints, num_warps=1)
+    assert torch.equal(y, x & 0x0f)
+    if pack >= 4:
+        assert "and.b16" not in pgm.asm["ptx"]
+
+
+@pytest.mark.parametrize("dtype_str", ["float32", "float16", "int8"])
+def test_param_table(dtype_str):
+    dtype = getattr(torch, dtype_str)
+    codebook = torch.arange(16, device='cuda').to(dtype) * 3 - 7
+    idx = torch.randint(0, 16, (256,), dtype=torch.int32, device='cuda')
+    y = torch.empty(256, dtype=dtype, device='cuda')
+    y_scalar = torch.empty(1, dtype=dtype, device='cuda')
+
+    @triton.jit
+    def kernel(Idx, Table, Y, Y_scalar, BLOCK: tl.constexpr):
+        offs = tl.arange(0, BLOCK)
+        tl.store(Y + offs, tl.load(Table + tl.load(Idx + offs)))
+        tl.store(Y_scalar, tl.load(Table + 5))
+
+    pgm = kernel[(1,)](idx, triton.ParamTable(codebook), y, y_scalar, BLOCK=256)
+    assert torch.equal(y, codebook[idx.long()])
+    assert torch.equal(y_scalar, codebook[5:6])
+    # the table is an array in the parameters of the launch, which is read
+    # in place rather than copied to the local memory
+    ptx = pgm.asm["ptx"]
+    assert f".b8 {pgm.metadata['name']}_param_1[{codebook.numel() * codebook.element_size()}]" in ptx
+    assert "__local_depot" not in ptx
+    # the tables of other sizes are other specializations
+    kernel[(1,)](idx % 8, triton.ParamTable(codebook[:8]), y, y_scalar, BLOCK=256)
+    assert torch.equal(y, codebook[(idx % 8).long()])
+    assert len(kernel.cache[torch.cuda.current_device()]) == 2
+
+
+def test_param_table_errors():
+    @triton.jit
+    def store_kernel(Table):
+        tl.store(Table, 1.0)
+
+    @triton.jit
+    def masked_load_kernel(Table, Y):
+        offs = tl.arange(0, 16)
+        tl.store(Y + offs, tl.load(Table + offs, mask=offs < 8))
+
+    table = triton.ParamTable(torch.ones(16))
+    y = torch.empty(16, device='cuda')
+    with pytest.raises(triton.CompilationError, match="read-only"):
+        store_kernel[(1,)](table)
+    with pytest.raises(triton.CompilationError, match="parameter table"):
+        masked_load_kernel[(1,)](table, y)
+    with pytest.raises(ValueError, match="bytes"):
+        triton.ParamTable(torch.ones(4096))
+
+
 @pytest.mark.parametrize("cache", ["", ".ca", ".cg"])
 def test_load_cache_modifier(cache):
     src = torch.empty(128, device='cuda')
@@ -2112,6 +2859,109 @@ def test_load_cache_modifier(cache):
         assert 'ld.global.cg' not in ptx
 
 
+@pytest.mark.parametrize("eviction_policy", ["l2_evict_first", "l2_evict_last"])
+def test_l2_eviction_policy(eviction_policy):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 8:
+        pytest.skip("L2 cache hints require sm_80")
+    src = torch.randn(128, device='cuda')
+    dst = torch.empty(128, device='cuda')
+
+    @triton.jit
+    def _kernel(dst, src, POLICY: tl.constexpr):
+        offsets = tl.arange(0, 128)
+        x = tl.load(src + offsets, eviction_policy=POLICY)
+        tl.store(dst + offsets, x, eviction_policy=POLICY)
+
+    pgm = _kernel[(1,)](dst, src, POLICY=eviction_policy)
+    ptx = pgm.asm['ptx']
+    assert f'createpolicy.fractional.L2::{eviction_policy[3:]}.b64' in ptx
+    assert 'ld.global.L2::cache_hint' in ptx
+    assert 'st.global.L2::cache_hint' in ptx
+    assert torch.equal(dst, src)
+
+
+@pytest.mark.parametrize("cache, eviction_policy", [(".wb", ""), (".cg", ""), (".cs", ""), (".wt", ""),
+                                                    ("", "evict_first"), ("", "no_allocate")])
+def test_store_cache_modifier(cache, eviction_policy):
+    src = torch.randn(128, device='cuda')
+    dst = torch.empty(128, device='cuda')
+
+    @triton.jit
+    def _kernel(dst, src, CACHE: tl.constexpr, POLICY: tl.constexpr):
+        offsets = tl.arange(0, 128)
+        x = tl.load(src + offsets)
+        tl.store(dst + offsets, x, cache_modifier=CACHE, eviction_policy=POLICY)
+
+    pgm = _kernel[(1,)](dst, src, CACHE=cache, POLICY=eviction_policy)
+    ptx = pgm.asm['ptx']
+    if cache:
+        assert f'st.global{cache}' in ptx
+    else:
+        assert f'st.global.L1::{eviction_policy}' in ptx
+    assert torch.equal(dst, src)
+
+
+def test_store_cache_modifier_with_eviction_policy():
+
+    @triton.jit
+    def _kernel(dst, src):
+        offsets = tl.arange(0, 128)
+        x = tl.load(src + offsets)
+        tl.store(dst + offsets, x, cache_modifier=".cs", eviction_policy="evict_first")
+
+    src = torch.randn(128, device='cuda')
+    dst = torch.empty(128, device='cuda')
+    with pytest.raises(triton.CompilationError, match="cannot be combined with eviction policy"):
+        _kernel[(1,)](dst, src)
+
+
+def test_streaming_stores(monkeypatch):
+    monkeypatch.setenv("TRITON_STREAMING_STORES", "1")
+    x = torch.randn(1024, device='cuda')
+    y = torch.empty(1024, device='cuda')
+
+    @triton.jit
+    def _kernel(X, Y, BLOCK: tl.constexpr):
+        offsets = tl.arange(0, BLOCK)
+        x = tl.load(X + offsets)
+        tl.store(Y + offsets, x * 2)
+        # X is read, so its stores keep the default cache policy
+        tl.store(X + offsets, x + 1)
+
+    pgm = _kernel[(1,)](x, y, BLOCK=1024)
+    ptx = pgm.asm['ptx']
+    assert ptx.count('st.global.cs') == ptx.count('st.global') // 2
+    assert torch.equal(y, (x - 1) * 2)
+
+
+def test_print_buffer(monkeypatch):
+    monkeypatch.setenv("TRITON_PRINT_BUFFER", "1")
+    from triton.runtime import print_buffer
+    x = torch.arange(256, dtype=torch.int32, device='cuda')
+
+    @triton.jit
+    def _kernel(X, BLOCK: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        x = tl.load(X + offsets)
+        tl.device_print(" x: ", x, x.to(tl.float32) * 0.5)
+
+    print_buffer.drain()
+    pgm = _kernel[(2,)](x, BLOCK=128, num_warps=4)
+    assert 'vprintf' not in pgm.asm['ptx']
+    records = print_buffer.drain()
+    # one record per thread and program, with the values the thread holds
+    assert len(records) == 2 * 128
+    seen = set()
+    for record in records:
+        assert record.prefix == " x: "
+        ints, floats = record.values[:len(record.values) // 2], record.values[len(record.values) // 2:]
+        assert [0.5 * v for v in ints] == floats
+        seen.update(ints)
+    assert seen == set(range(256))
+    assert print_buffer.drain() == []
+
+
 @pytest.mark.parametrize("N", [16, 10, 11, 1024])
 def test_vectorization(N):
     src = torch.empty(1024, device='cuda')
@@ -2526,6 +3376,31 @@ def test_for_iv(lo, hi, iv):
     assert out[0] == sum(range(lo, hi, iv))
 
 
+@pytest.mark.parametrize("n, unroll, num_stages", [(n, unroll, num_stages)
+                                                   for n in [0, 3, 8, 13]
+                                                   for unroll in [1, 2, 4]
+                                                   for num_stages in [1, 3]])
+def test_for_unroll(n, unroll, num_stages):
+
+    @triton.jit
+    def kernel(X, Out, n, UNROLL: tl.constexpr, BLOCK: tl.constexpr):
+        offs = tl.arange(0, BLOCK)
+        acc = tl.zeros([BLOCK], dtype=tl.float32)
+        for i in tl.range(0, n, unroll=UNROLL):
+            acc += tl.load(X + i * BLOCK + offs) * (i + 1)
+        tl.store(Out + offs, acc)
+
+    BLOCK = 128
+    x = torch.randn((max(n, 1), BLOCK), device='cuda', dtype=torch.float32)
+    out = torch.empty((BLOCK,), device='cuda', dtype=torch.float32)
+    h = kernel[(1,)](x, out, n, UNROLL=unroll, BLOCK=BLOCK, num_stages=num_stages)
+    ref = (x[:n] * torch.arange(1, n + 1, device='cuda', dtype=torch.float32)[:, None]).sum(0)
+    torch.testing.assert_close(out, ref)
+    assert "tt.num_unroll" not in h.asm["ttgir"]
+    if unroll > 1:
+        assert "tt.unroll_remainder" in h.asm["ttgir"]
+
+
 def test_if_else():
 
     @triton.jit
@@ -2770,6 +3645,33 @@ def test_smid():
     assert out.sort()[0].unique().shape[0] > 0
     assert h.asm["ptx"].count("%smid") == 2
 
+
+def test_clock64():
+
+    @triton.jit
+    def kernel(Out, Times, n, NUM_REGIONS: tl.constexpr):
+        off = tl.arange(0, 128)
+        loop = tl.extra.cuda.clock64() * 0
+        for i in range(n):
+            start = tl.extra.cuda.clock64()
+            tl.store(Out + off, tl.load(Out + off) + 1)
+            loop += tl.extra.cuda.clock64() - start
+        start = tl.extra.cuda.clock64()
+        tl.store(Out + off, tl.load(Out + off) * 2)
+        tl.extra.cuda.record_region(Times, 0, loop, NUM_REGIONS)
+        tl.extra.cuda.record_region(Times, 1, tl.extra.cuda.clock64() - start, NUM_REGIONS)
+
+    out = to_triton(np.zeros((4, 128), dtype=np.int64), device='cuda')
+    timer = triton.profiler.RegionTimer((4,), ["loop", "epilogue"])
+    h = kernel[(4,)](out, timer.buffer, 100, NUM_REGIONS=timer.num_regions)
+    assert "%clock64" in h.asm["ptx"]
+    cycles = timer.cycles()
+    assert cycles.shape == (4, 2) and (cycles > 0).all()
+    summary = timer.summary()
+    assert summary["loop"]["mean"] > summary["epilogue"]["mean"]
+    assert abs(sum(stats["share"] for stats in summary.values()) - 1) < 1e-6
+    assert sum(sum(c) for c in timer.per_sm().values()) == cycles.sum().item()
+
 # -----------------------
 # test layout conversions
 # -----------------------
@@ -134,6 +134,34 @@ def test_randint(size, seed, device='cuda'):
     out_ref = [gen.random_raw()[0] for _ in out_tri]
     assert out_tri == out_ref
 
+# all four words of a round match the reference
+
+
+@pytest.mark.parametrize('size, seed',
+                         [(size, seed) for size in ['10', '10000']
+                          for seed in [0, 42, 0xdeadbeefcafeb0ba]]
+                         )
+def test_randint4x(size, seed, device='cuda'):
+    size = list(map(int, size.split(',')))
+
+    @triton.jit
+    def kernel(X, N, seed):
+        offset = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        r0, r1, r2, r3 = tl.randint4x(seed, offset)
+        mask = offset < N
+        tl.store(X + 4 * offset, r0, mask=mask)
+        tl.store(X + 4 * offset + 1, r1, mask=mask)
+        tl.store(X + 4 * offset + 2, r2, mask=mask)
+        tl.store(X + 4 * offset + 3, r3, mask=mask)
+    x = torch.empty(size + [4], dtype=torch.int32, device=device)
+    N = x.numel() // 4
+    grid = (triton.cdiv(N, BLOCK),)
+    kernel[grid](x, N, seed)
+    out_tri = x.cpu().numpy().astype(np.uint32).reshape(-1, 4).tolist()
+    gen = CustomPhilox4x(seed, config=PHILOX_32)
+    out_ref = [gen.random_raw().tolist() for _ in out_tri]
+    assert out_tri == out_ref
+
 # test uniform PRNG
 
 
@@ -196,3 +224,24 @@ def test_rand_limits():
 
     assert output[0] == output[1]
     assert 1.0 - torch.finfo(torch.float32).eps <= output[0].item() < 1.0
+
+
+@pytest.mark.parametrize('p', [0.0, 0.25, 0.5])
+@pytest.mark.parametrize('dtype', ['float32', 'float16'])
+def test_dropout(p, dtype, device='cuda'):
+    @triton.jit
+    def kernel(X, Y, N, p, seed):
+        offset = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        mask = offset < N
+        x = tl.load(X + offset, mask=mask)
+        tl.store(Y + offset, tl.dropout(x, p, seed, offset), mask=mask)
+    x = torch.ones(100000, dtype=getattr(torch, dtype), device=device)
+    y = torch.empty_like(x)
+    grid = (triton.cdiv(x.numel(), BLOCK),)
+    kernel[grid](x, y, x.numel(), p, 42)
+    assert torch.all((y == 0) | (y == torch.full_like(x, 1 / (1 - p))))
+    assert abs((y == 0).float().mean().item() - p) < 1e-2
+    # the same seed and offsets regenerate the mask
+    y2 = torch.empty_like(x)
+    kernel[grid](x, y2, x.numel(), p, 42)
+    assert torch.equal(y, y2)
@@ -1,3 +1,6 @@
+import collections
+import importlib
+
 import pytest
 import torch
 
@@ -91,6 +94,31 @@ def test_matmul(MODE, TRANS_A, TRANS_B, BLOCK, DTYPE, Z=3, H=2, M=512, N=384, K=
     torch.testing.assert_allclose(db_ref, db_tri)
 
 
+@pytest.mark.parametrize("MODE", ["sdd", "dds", "dsd"])
+def test_matmul_dynamic_layout(MODE, monkeypatch, BLOCK=32, Z=2, H=2, M=256, N=384, K=128):
+    matmul_module = importlib.import_module("triton.ops.blocksparse.matmul")
+    monkeypatch.setattr(matmul_module, "_lut_cache", collections.OrderedDict())
+    torch.manual_seed(0)
+    a_shape, b_shape = (Z, H, M, K), (Z, H, K, N)
+    shape = {"sdd": (M, N), "dsd": (M, K), "dds": (K, N)}[MODE]
+    base = torch.ones((H, shape[0] // BLOCK, shape[1] // BLOCK), dtype=torch.int64)
+    op = triton.ops.blocksparse.matmul(base, BLOCK, MODE, device="cuda")
+    a = torch.randn(a_shape, dtype=torch.float16, device="cuda") * .1
+    b = torch.randn(b_shape, dtype=torch.float16, device="cuda") * .1
+    # a new layout per call, with one repeat
+    layouts = [torch.randint(2, base.shape) for _ in range(3)]
+    layouts.append(layouts[0].clone())
+    for layout in layouts:
+        layout[:, 0, 0] = 1
+        sparsify = lambda x: sparsify_tensor(x, layout, BLOCK)
+        mask = lambda x: mask_tensor(x, layout, BLOCK)
+        c_ref = torch.matmul(mask(a) if MODE == "dsd" else a, mask(b) if MODE == "dds" else b)
+        c_ref = sparsify(c_ref) if MODE == "sdd" else c_ref
+        c_tri = op(sparsify(a) if MODE == "dsd" else a, sparsify(b) if MODE == "dds" else b, layout=layout)
+        torch.testing.assert_allclose(c_ref, c_tri)
+    # the tables of the repeated layout are reused
+    assert len(matmul_module._lut_cache) == 1 + 3
+
 configs = [
     (16, 256),
     (32, 576),
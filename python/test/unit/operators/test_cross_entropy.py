@@ -37,3 +37,30 @@ def test_op(M, N, dtype, mode):
         th_y.backward(dy)
         th_dx = x.grad.clone()
         torch.testing.assert_allclose(th_dx, tt_dx)
+
+
+@pytest.mark.parametrize("M, N, label_smoothing, z_loss",
+                         [
+                             (M, N, label_smoothing, z_loss) for M in [64, 37]
+                             for N in [1000, 32000, 131072, 151936]
+                             for label_smoothing in [0., 0.1]
+                             for z_loss in [0., 1e-4]
+                         ]
+                         )
+def test_op_large_vocab(M, N, label_smoothing, z_loss, dtype=torch.float32):
+    # create inputs
+    x = torch.randn(M, N, dtype=dtype, device='cuda', requires_grad=True)
+    idx = torch.randint(0, N, (M,), dtype=torch.int64, device='cuda')
+    # forward pass
+    tt_y = triton.ops.cross_entropy(x, idx, label_smoothing, z_loss)
+    th_y = torch.nn.CrossEntropyLoss(reduction="none", label_smoothing=label_smoothing)(x, idx)
+    th_y = th_y + z_loss * torch.logsumexp(x, dim=-1) ** 2
+    torch.testing.assert_allclose(th_y, tt_y)
+    # backward pass
+    dy = torch.randn_like(tt_y)
+    tt_y.backward(dy)
+    tt_dx = x.grad.clone()
+    x.grad.zero_()
+    th_y.backward(dy)
+    th_dx = x.grad.clone()
+    torch.testing.assert_allclose(th_dx, tt_dx)
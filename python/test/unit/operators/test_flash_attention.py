@@ -44,3 +44,83 @@ def test_op(Z, H, N_CTX, D_HEAD, dtype):
     torch.testing.assert_allclose(ref_dv, tri_dv, atol=atol, rtol=0)
     torch.testing.assert_allclose(ref_dk, tri_dk, atol=atol, rtol=0)
     torch.testing.assert_allclose(ref_dq, tri_dq, atol=atol, rtol=0)
+
+
+@pytest.mark.parametrize('window', [1, 100, 128, 300, 1024])
+def test_op_window(window, Z=2, H=4, N_CTX=1024, D_HEAD=64, dtype=torch.float16):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 8:
+        pytest.skip("Flash attention only supported for compute capability >= 80")
+    torch.manual_seed(20)
+    q = torch.empty((Z, H, N_CTX, D_HEAD), dtype=dtype, device="cuda").normal_(mean=0.1, std=0.2).requires_grad_()
+    k = torch.empty((Z, H, N_CTX, D_HEAD), dtype=dtype, device="cuda").normal_(mean=0.4, std=0.2).requires_grad_()
+    v = torch.empty((Z, H, N_CTX, D_HEAD), dtype=dtype, device="cuda").normal_(mean=0.3, std=0.2).requires_grad_()
+    sm_scale = 0.2
+    dout = torch.randn_like(q)
+    # reference implementation: a query sees the `window` keys up to itself
+    idx = torch.arange(N_CTX, device="cuda")
+    dist = idx[:, None] - idx[None, :]
+    M = (dist >= 0) & (dist < window)
+    p = torch.matmul(q, k.transpose(2, 3)) * sm_scale
+    p[:, :, ~M] = float("-inf")
+    p = torch.softmax(p.float(), dim=-1).to(dtype)
+    ref_out = torch.matmul(p, v)
+    ref_out.backward(dout)
+    ref_dv, v.grad = v.grad.clone(), None
+    ref_dk, k.grad = k.grad.clone(), None
+    ref_dq, q.grad = q.grad.clone(), None
+    # triton implementation
+    tri_out = triton.ops.attention(q, k, v, sm_scale, window)
+    tri_out.backward(dout)
+    tri_dv, v.grad = v.grad.clone(), None
+    tri_dk, k.grad = k.grad.clone(), None
+    tri_dq, q.grad = q.grad.clone(), None
+    # compare
+    atol = 1e-2
+    torch.testing.assert_allclose(ref_out, tri_out, atol=atol, rtol=0)
+    torch.testing.assert_allclose(ref_dv, tri_dv, atol=atol, rtol=0)
+    torch.testing.assert_allclose(ref_dk, tri_dk, atol=atol, rtol=0)
+    torch.testing.assert_allclose(ref_dq, tri_dq, atol=atol, rtol=0)
+
+
+@pytest.mark.parametrize('q_lens, k_lens', [([1, 1, 1], [37, 300, 1]),  # decode
+                                            ([50, 17, 128], [50, 100, 200])])  # prefill
+@pytest.mark.parametrize('H, H_KV', [(8, 8), (8, 2), (4, 1)])
+@pytest.mark.parametrize('causal', [True, False])
+@pytest.mark.parametrize('num_splits', [1, 3, None])
+def test_paged_attention(q_lens, k_lens, H, H_KV, causal, num_splits, D_HEAD=64, page_size=16, dtype=torch.float16):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 8:
+        pytest.skip("Flash attention only supported for compute capability >= 80")
+    torch.manual_seed(20)
+    B = len(q_lens)
+    max_pages = triton.cdiv(max(k_lens), page_size)
+    # the pages of the sequences are scattered over the cache
+    num_blocks = B * max_pages
+    block_table = torch.randperm(num_blocks, device="cuda", dtype=torch.int32).reshape(B, max_pages)
+    k_cache = torch.randn((num_blocks, page_size, H_KV, D_HEAD), dtype=dtype, device="cuda")
+    v_cache = torch.randn((num_blocks, page_size, H_KV, D_HEAD), dtype=dtype, device="cuda")
+    q = torch.randn((sum(q_lens), H, D_HEAD), dtype=dtype, device="cuda")
+    cu_seqlens_q = torch.tensor([0] + q_lens, device="cuda", dtype=torch.int32).cumsum(0).to(torch.int32)
+    seq_lens_k = torch.tensor(k_lens, device="cuda", dtype=torch.int32)
+    sm_scale = 0.3
+    tri_out, tri_lse = triton.ops.paged_attention(q, k_cache, v_cache, block_table, cu_seqlens_q, seq_lens_k,
+                                                  max(q_lens), sm_scale=sm_scale, causal=causal,
+                                                  num_splits=num_splits)
+    # reference implementation, one sequence at a time
+    for b in range(B):
+        q_b = q[cu_seqlens_q[b]:cu_seqlens_q[b + 1]].float().transpose(0, 1)
+        k_b = k_cache[block_table[b].long()].reshape(-1, H_KV, D_HEAD)[:k_lens[b]].float()
+        v_b = v_cache[block_table[b].long()].reshape(-1, H_KV, D_HEAD)[:k_lens[b]].float()
+        k_b = k_b.repeat_interleave(H // H_KV, dim=1).transpose(0, 1)
+        v_b = v_b.repeat_interleave(H // H_KV, dim=1).transpose(0, 1)
+        p = torch.matmul(q_b, k_b.transpose(1, 2)) * sm_scale
+        if causal:
+            q_pos = torch.arange(k_lens[b] - q_lens[b], k_lens[b], device="cuda")
+            mask = q_pos[:, None] >= torch.arange(k_lens[b], device="cuda")[None, :]
+            p[:, ~mask] = float("-inf")
+        ref_lse = torch.logsumexp(p, dim=-1).transpose(0, 1)
+        ref_out = torch.matmul(torch.softmax(p, dim=-1), v_b).transpose(0, 1).to(dtype)
+        rows = slice(cu_seqlens_q[b], cu_seqlens_q[b + 1])
+        torch.testing.assert_close(tri_out[rows], ref_out, atol=1e-2, rtol=0)
+        torch.testing.assert_close(tri_lse[rows], ref_lse, atol=1e-2, rtol=1e-3)
@@ -4,6 +4,7 @@ import pytest
 import torch
 
 import triton
+import triton.language as tl
 import triton.ops
 
 
@@ -100,3 +101,213 @@ def test_op(BLOCK_M, BLOCK_N, BLOCK_K, SPLIT_K, NWARP, NSTAGE, M, N, K, AT, BT,
         torch.testing.assert_allclose(th_c, tt_c, atol=1e-2, rtol=0)
     except triton.OutOfResources as e:
         pytest.skip(str(e))
+
+
+@pytest.mark.parametrize(
+    "BLOCK_M, BLOCK_N, BLOCK_K, NWARP, NSTAGE, M, N, K, SCHEDULE, DTYPE",
+    [
+        (BLOCK_M, BLOCK_N, BLOCK_K, 4, 2, M, N, K, SCHEDULE, DTYPE)
+        for BLOCK_M, BLOCK_N, BLOCK_K in [(64, 64, 32), (128, 64, 32)]
+        for M, N, K in [(1024, 1024, 1024), (384, 128, 640), (107, 233, 311), (4000, 1000, 96)]
+        for SCHEDULE in ["row_major", "grouped", "stream_k"]
+        for DTYPE in ["float16", "bfloat16", "float32"]
+    ],
+)
+def test_persistent_op(BLOCK_M, BLOCK_N, BLOCK_K, NWARP, NSTAGE, M, N, K, SCHEDULE, DTYPE):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 7:
+        pytest.skip("Only test tl.dot() on devices with sm >= 70")
+    if capability[0] < 8 and DTYPE == "bfloat16":
+        pytest.skip("Only test bfloat16 on devices with sm >= 80")
+    torch.manual_seed(0)
+    # nuke kernel decorators -- will set meta-parameters manually
+    kwargs = {'BLOCK_M': BLOCK_M, 'BLOCK_N': BLOCK_N, 'BLOCK_K': BLOCK_K}
+    pre_hook = None if SCHEDULE != "stream_k" else lambda nargs: nargs['C'].zero_()
+    configs = [triton.Config(kwargs=kwargs, num_warps=NWARP, num_stages=NSTAGE, pre_hook=pre_hook)]
+    for kernel in triton.ops._matmul.persistent_kernels.values():
+        kernel.configs = configs
+    # allocate inputs
+    DTYPE = {"float16": torch.float16, "bfloat16": torch.bfloat16, "float32": torch.float32}[DTYPE]
+    a = .1 * torch.randn((M, K), device="cuda", dtype=DTYPE)
+    b = .1 * torch.randn((K, N), device="cuda", dtype=DTYPE)
+    # run test
+    th_c = torch.matmul(a, b)
+    try:
+        tt_c = triton.ops.matmul(a, b, None, SCHEDULE)
+        torch.testing.assert_allclose(th_c, tt_c, atol=1e-2, rtol=0)
+    except triton.OutOfResources as e:
+        pytest.skip(str(e))
+
+
+@pytest.mark.parametrize(
+    "SPLIT_K, M, N, K, DTYPE",
+    [
+        (SPLIT_K, M, N, K, DTYPE)
+        for SPLIT_K in [2, 4, 8]
+        for M, N, K in [(64, 64, 4096), (107, 33, 3001)]
+        for DTYPE in ["float16", "bfloat16", "float32"]
+    ],
+)
+def test_deterministic_split_k(SPLIT_K, M, N, K, DTYPE):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 7:
+        pytest.skip("Only test tl.dot() on devices with sm >= 70")
+    if capability[0] < 8 and DTYPE == "bfloat16":
+        pytest.skip("Only test bfloat16 on devices with sm >= 80")
+    torch.manual_seed(0)
+    # nuke kernel decorators -- will set meta-parameters manually
+    kwargs = {'BLOCK_M': 64, 'BLOCK_N': 64, 'BLOCK_K': 32, 'SPLIT_K': SPLIT_K}
+    configs = [triton.Config(kwargs=kwargs, num_warps=4, num_stages=2)]
+    triton.ops._matmul.kernel.configs = configs
+    # allocate inputs
+    DTYPE = {"float16": torch.float16, "bfloat16": torch.bfloat16, "float32": torch.float32}[DTYPE]
+    a = .1 * torch.randn((M, K), device="cuda", dtype=DTYPE)
+    b = .1 * torch.randn((K, N), device="cuda", dtype=DTYPE)
+    # run test
+    th_c = torch.matmul(a, b)
+    tt_c = triton.ops.matmul(a, b, None, None, True)
+    torch.testing.assert_allclose(th_c, tt_c, atol=2e-2, rtol=0)
+    # the partial results are summed in the same order on every run
+    for _ in range(3):
+        assert torch.equal(tt_c, triton.ops.matmul(a, b, None, None, True))
+
+
+@pytest.mark.parametrize(
+    "M, N, K, FP8_DTYPE, ROW_SCALE, OUT_DTYPE",
+    [
+        (M, N, K, FP8_DTYPE, ROW_SCALE, OUT_DTYPE)
+        for M, N, K in [(1024, 1024, 1024), (107, 233, 311), (1, 4096, 512)]
+        for FP8_DTYPE in ["float8e4", "float8e5"]
+        for ROW_SCALE in [False, True]
+        for OUT_DTYPE in ["float16", "bfloat16", "float32"]
+    ],
+)
+def test_scaled_op(M, N, K, FP8_DTYPE, ROW_SCALE, OUT_DTYPE):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 8:
+        pytest.skip("Only test fp8 matmuls on devices with sm >= 80")
+    torch.manual_seed(0)
+    # nuke kernel decorators -- will set meta-parameters manually
+    kwargs = {'BLOCK_M': 64, 'BLOCK_N': 64, 'BLOCK_K': 32}
+    triton.ops._matmul.scaled_kernel.configs = [triton.Config(kwargs=kwargs, num_warps=4, num_stages=2)]
+
+    @triton.jit
+    def copy_kernel(input_ptr, output_ptr, n_elements, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(axis=0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        mask = offsets < n_elements
+        tl.store(output_ptr + offsets, tl.load(input_ptr + offsets, mask=mask), mask=mask)
+
+    def to_fp8(x):
+        # returns x in fp8, and the fp8 values in fp16 for the reference
+        x_f8 = triton.reinterpret(torch.empty(x.shape, device="cuda", dtype=torch.int8), getattr(tl, FP8_DTYPE))
+        x_f16 = torch.empty_like(x)
+        grid = lambda meta: (triton.cdiv(x.numel(), meta['BLOCK_SIZE']),)
+        copy_kernel[grid](x, x_f8, x.numel(), BLOCK_SIZE=1024)
+        copy_kernel[grid](x_f8, x_f16, x.numel(), BLOCK_SIZE=1024)
+        return x_f8, x_f16
+
+    a, a_f16 = to_fp8(torch.randn((M, K), device="cuda", dtype=torch.float16))
+    b, b_f16 = to_fp8(torch.randn((K, N), device="cuda", dtype=torch.float16))
+    if ROW_SCALE:
+        scale_a = torch.rand((M,), device="cuda") + 0.5
+        scale_b = torch.rand((N,), device="cuda") + 0.5
+    else:
+        scale_a = torch.tensor([0.5], device="cuda")
+        scale_b = torch.tensor([0.25], device="cuda")
+    OUT_DTYPE = {"float16": torch.float16, "bfloat16": torch.bfloat16, "float32": torch.float32}[OUT_DTYPE]
+    # run test
+    th_c = torch.matmul(a_f16.float(), b_f16.float()) * scale_a[:, None] * scale_b[None, :]
+    tt_c = triton.ops.scaled_matmul(a, b, scale_a, scale_b, out_dtype=OUT_DTYPE)
+    assert tt_c.dtype == OUT_DTYPE
+    torch.testing.assert_allclose(th_c, tt_c.float(), atol=1e-1, rtol=1e-2)
+
+
+@triton.jit
+def _bias_relu_residual(acc, rm, rn, M, N, BIAS, RESIDUAL, E2, E3):
+    bias = tl.load(BIAS + rn, mask=rn < N, other=0.)
+    residual = tl.load(RESIDUAL + rm[:, None] * N + rn[None, :], mask=(rm < M)[:, None] & (rn < N)[None, :], other=0.)
+    return tl.maximum(acc + bias[None, :], 0.) + residual
+
+
+@pytest.mark.parametrize(
+    "SPLIT_K, M, N, K, DTYPE",
+    [
+        (SPLIT_K, M, N, K, DTYPE)
+        for SPLIT_K in [1, 4]
+        for M, N, K in [(256, 256, 512), (107, 233, 311)]
+        for DTYPE in ["float16", "float32"]
+    ],
+)
+def test_epilogue(SPLIT_K, M, N, K, DTYPE):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 7:
+        pytest.skip("Only test tl.dot() on devices with sm >= 70")
+    torch.manual_seed(0)
+    # nuke kernel decorators -- will set meta-parameters manually
+    kwargs = {'BLOCK_M': 64, 'BLOCK_N': 64, 'BLOCK_K': 32, 'SPLIT_K': SPLIT_K}
+    triton.ops._matmul.kernel.configs = [triton.Config(kwargs=kwargs, num_warps=4, num_stages=2)]
+    # allocate inputs
+    DTYPE = {"float16": torch.float16, "float32": torch.float32}[DTYPE]
+    a = .1 * torch.randn((M, K), device="cuda", dtype=DTYPE)
+    b = .1 * torch.randn((K, N), device="cuda", dtype=DTYPE)
+    bias = torch.randn((N,), device="cuda", dtype=DTYPE)
+    residual = torch.randn((M, N), device="cuda", dtype=DTYPE)
+    # run test
+    th_c = torch.relu(torch.matmul(a, b) + bias) + residual
+    tt_c = triton.ops.matmul(a, b, epilogue=_bias_relu_residual, epilogue_args=(bias, residual))
+    torch.testing.assert_allclose(th_c, tt_c, atol=2e-2, rtol=0)
+
+
+@pytest.mark.parametrize(
+    "SHAPES, DTYPE",
+    [
+        (SHAPES, DTYPE)
+        for SHAPES in [
+            [(128, 128, 128)] * 4,
+            [(1, 256, 512), (37, 256, 512), (300, 256, 512), (0, 256, 512)],  # experts
+            [(1024, 16, 1024), (1024, 1024, 16)],  # low-rank adapters
+            [(17, 33, 65), (250, 3, 129), (64, 64, 64)],
+        ]
+        for DTYPE in ["float16", "bfloat16", "float32"]
+    ],
+)
+def test_grouped_op(SHAPES, DTYPE):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 7:
+        pytest.skip("Only test tl.dot() on devices with sm >= 70")
+    if capability[0] < 8 and DTYPE == "bfloat16":
+        pytest.skip("Only test bfloat16 on devices with sm >= 80")
+    torch.manual_seed(0)
+    # nuke kernel decorators -- will set meta-parameters manually
+    kwargs = {'BLOCK_M': 64, 'BLOCK_N': 64, 'BLOCK_K': 32}
+    triton.ops._matmul.grouped_kernel.configs = [triton.Config(kwargs=kwargs, num_warps=4, num_stages=2)]
+    # allocate inputs
+    DTYPE = {"float16": torch.float16, "bfloat16": torch.bfloat16, "float32": torch.float32}[DTYPE]
+    a_list = [.1 * torch.randn((M, K), device="cuda", dtype=DTYPE) for M, N, K in SHAPES]
+    b_list = [.1 * torch.randn((K, N), device="cuda", dtype=DTYPE) for M, N, K in SHAPES]
+    # run test
+    tt_c_list = triton.ops.grouped_matmul(a_list, b_list)
+    for a, b, tt_c in zip(a_list, b_list, tt_c_list):
+        torch.testing.assert_allclose(torch.matmul(a, b), tt_c, atol=1e-2, rtol=0)
+
+
+def test_calibration(tmp_path, monkeypatch):
+    from triton.ops import calibration, matmul_perf_model
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path))
+    monkeypatch.setattr(calibration, "_calibrations", {})
+    device = torch.cuda.current_device()
+    assert calibration.get_calibration(device) is None
+    nominal = matmul_perf_model.get_bandwidths(None, device)
+    # the calibration is saved and loaded back by the other processes
+    measured = calibration.calibrate(device)
+    for key in ["dram_gbps", "store_gbps", "l2_gbps"]:
+        assert measured[key] > 0
+    assert measured["mma_tflops"][str(torch.float16)] > 0
+    monkeypatch.setattr(calibration, "_calibrations", {})
+    assert calibration.get_calibration(device) == measured
+    # the perf model uses the measured numbers
+    assert matmul_perf_model.get_bandwidths(None, device) == (measured["dram_gbps"], measured["l2_gbps"],
+                                                              measured["store_gbps"])
+    assert matmul_perf_model.get_bandwidths(None, device) != nominal
+    assert matmul_perf_model.get_peak_tensorcore_tflops(None, device, torch.float16) == \
+        measured["mma_tflops"][str(torch.float16)]
@@ -0,0 +1,77 @@
+import pytest
+import torch
+
+import triton
+import triton.ops
+
+
+def _rms_norm_ref(x, weight, eps):
+    x = x.float()
+    return (x * torch.rsqrt(x.pow(2).mean(-1, keepdim=True) + eps) * weight.float())
+
+
+@pytest.mark.parametrize("M, N, dtype, is_rms, has_residual",
+                         [
+                             (M, N, dtype, is_rms, has_residual) for M in [1, 37, 4096]
+                             for N in [64, 1000, 4096, 8192]
+                             for dtype in ['float16', 'float32']
+                             for is_rms in [False, True]
+                             for has_residual in [False, True]
+                         ]
+                         )
+def test_op(M, N, dtype, is_rms, has_residual):
+    dtype = {'float16': torch.float16, 'float32': torch.float32}[dtype]
+    atol, rtol = (1e-2, 1e-2) if dtype == torch.float16 else (1e-4, 1e-4)
+    # create inputs
+    x = torch.randn(M, N, dtype=dtype, device='cuda', requires_grad=True)
+    weight = torch.rand(N, dtype=dtype, device='cuda', requires_grad=True)
+    bias = None if is_rms else torch.randn(N, dtype=dtype, device='cuda', requires_grad=True)
+    residual = torch.randn(M, N, dtype=dtype, device='cuda', requires_grad=True) if has_residual else None
+    params = [x, weight] + ([bias] if bias is not None else []) + ([residual] if residual is not None else [])
+    # forward pass
+    if is_rms:
+        tt_y = triton.ops.rms_norm(x, weight, 1e-6, residual=residual)
+    else:
+        tt_y = triton.ops.layer_norm(x, weight, bias, 1e-5, residual=residual)
+    if has_residual:
+        tt_y, tt_h = tt_y
+    h = x + residual if has_residual else x
+    if is_rms:
+        th_y = _rms_norm_ref(h, weight, 1e-6).to(dtype)
+    else:
+        th_y = torch.nn.functional.layer_norm(h, (N, ), weight, bias, 1e-5)
+    torch.testing.assert_close(tt_y, th_y, atol=atol, rtol=rtol)
+    if has_residual:
+        torch.testing.assert_close(tt_h, h, atol=atol, rtol=rtol)
+    # backward pass, through the sum too when it is returned
+    dy = torch.randn_like(tt_y)
+    tt_loss = (tt_y * dy).sum() + (tt_h.float().sum() if has_residual else 0)
+    th_loss = (th_y * dy).sum() + (h.float().sum() if has_residual else 0)
+    tt_grads = torch.autograd.grad(tt_loss, params)
+    th_grads = torch.autograd.grad(th_loss, params)
+    for tt_grad, th_grad in zip(tt_grads, th_grads):
+        # the gradients of the weight and of the bias sum all the rows
+        torch.testing.assert_close(tt_grad, th_grad, atol=atol * max(1, M // 64), rtol=rtol)
+
+
+@pytest.mark.parametrize("out_dtype", ['float8_e4m3fn', 'float8_e5m2'])
+@pytest.mark.parametrize("is_rms", [False, True])
+def test_op_fp8_output(out_dtype, is_rms, M=128, N=1024):
+    out_dtype = getattr(torch, out_dtype, None)
+    if out_dtype is None:
+        pytest.skip("fp8 dtypes are not supported by this version of torch")
+    x = torch.randn(M, N, dtype=torch.float16, device='cuda')
+    residual = torch.randn(M, N, dtype=torch.float16, device='cuda')
+    weight = torch.rand(N, dtype=torch.float16, device='cuda')
+    scale = torch.tensor([4.], device='cuda')
+    if is_rms:
+        tt_y, tt_h = triton.ops.rms_norm(x, weight, residual=residual, out_dtype=out_dtype, out_scale=scale)
+        th_y = _rms_norm_ref(x + residual, weight, 1e-6)
+    else:
+        tt_y, tt_h = triton.ops.layer_norm(x, weight, eps=1e-5, residual=residual, out_dtype=out_dtype,
+                                           out_scale=scale)
+        th_y = torch.nn.functional.layer_norm((x + residual).float(), (N, ), weight.float(), None, 1e-5)
+    assert tt_y.dtype == out_dtype
+    torch.testing.assert_close(tt_h, x + residual)
+    # the outputs are scaled, and rounded to 2 or 3 bits of mantissa
+    torch.testing.assert_close(tt_y.float(), (th_y * 4).to(out_dtype).float(), atol=0.5, rtol=0.25)
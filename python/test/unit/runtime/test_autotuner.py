@@ -1,7 +1,10 @@
+import builtins
+
 import torch
 
 import triton
 import triton.language as tl
+from triton.runtime import autotuner
 
 
 def test_kwargs():
@@ -20,3 +23,229 @@ def test_kwargs():
     grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']),)
     _kernel[grid](dst, src, N)
     _kernel[grid](dst=dst, src=src, N=N)
+
+
+def test_precompile(monkeypatch):
+    monkeypatch.setenv("TRITON_AUTOTUNE_COMPILE_THREADS", "4")
+    N = 1024
+    src = torch.empty(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': block}, num_warps=num_warps)
+               for block in [32, 64, 128] for num_warps in [1, 2]]
+
+    @triton.autotune(configs=configs, key=['N'])
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+    device = torch.cuda.current_device()
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']),)
+    _kernel._precompile(configs, dst, src, N, grid=grid)
+    assert len(_kernel.fn.cache[device]) == len(configs)
+    # benchmarking reuses the compiled kernels
+    _kernel[grid](dst, src, N)
+    assert len(_kernel.fn.cache[device]) == len(configs)
+
+
+def test_tuning_file(tmp_path):
+    N = 1024
+    src = torch.empty(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 32}), triton.Config(kwargs={'BLOCK_SIZE': 128})]
+
+    def make_kernel():
+        @triton.autotune(configs=configs, key=['N'])
+        @triton.jit
+        def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+            offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+            x = tl.load(src + offsets, mask=offsets < N)
+            tl.store(dst + offsets, x, mask=offsets < N)
+        return _kernel
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']),)
+    tuned = make_kernel()
+    tuned[grid](dst, src, N)
+    assert hasattr(tuned, 'configs_timings')
+    path = str(tmp_path / "tuning.json")
+    autotuner.save_tuning_file(path)
+    autotuner._tuning_records.clear()
+    autotuner.load_tuning_file(path)
+    # a fresh autotuner picks the saved config without benchmarking
+    preloaded = make_kernel()
+    preloaded[grid](dst, src, N)
+    assert not hasattr(preloaded, 'configs_timings')
+    assert preloaded.best_config is tuned.best_config
+
+
+def test_resource_prune():
+    N = 1024
+    src = torch.empty(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 128}, num_warps=1),
+               triton.Config(kwargs={'BLOCK_SIZE': 128}, num_warps=2)]
+    usages = {}
+
+    def resource_prune(configs, config_usages):
+        usages.update(config_usages)
+        return [config for config in configs if config.num_warps == 1]
+
+    @triton.autotune(configs=configs, key=['N'], prune_configs_by={'resource_prune': resource_prune})
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']),)
+    _kernel[grid](dst, src, N)
+    # the configs are pruned by the usage of their kernels before benchmarking
+    assert set(usages) == set(configs)
+    assert all(usage["n_spills"] == 0 and usage["occupancy"] > 0 for usage in usages.values())
+    assert list(_kernel.configs_timings) == [configs[0]]
+
+
+def test_reject_costly_configs():
+    configs = [triton.Config({}, num_warps=4), triton.Config({}, num_warps=8), triton.Config({}, num_warps=16)]
+    usages = {configs[0]: {"n_spills": 0, "occupancy": 32},
+              configs[1]: {"n_spills": 12, "occupancy": 32},
+              configs[2]: {"n_spills": 0, "occupancy": 0}}
+    prune = autotuner.reject_costly_configs()
+    assert prune(configs, usages) == [configs[0]]
+    # a config is rejected only if another one is kept
+    assert prune(configs[1:], usages) == configs[1:]
+
+
+def test_successive_halving():
+    configs = [triton.Config({'BLOCK_SIZE': block}) for block in [16, 32, 64, 128, 256, 512, 1024, 2048]]
+    runtimes = {config: 1.0 + abs(i - 5) for i, config in enumerate(configs)}
+    calls = []
+
+    def bench(config, warmup=25, rep=100):
+        calls.append((config, rep))
+        return [runtimes[config]] * 3
+    timings = autotuner.successive_halving(eta=2, min_rep=10, max_rep=100)(configs, bench)
+    assert builtins.min(timings, key=timings.get) is configs[5]
+    # 8 short benchmarks, then 4, 2 and finally the full one of the best config
+    assert [rep for _, rep in calls] == [10] * 8 + [20] * 4 + [40] * 2 + [100]
+    assert calls[-1] == (configs[5], 100)
+
+
+def test_time_budget():
+    N = 1024
+    src = torch.empty(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': block}) for block in [32, 64, 128]]
+
+    @triton.autotune(configs=configs, key=['N'], time_budget=0)
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']),)
+    _kernel[grid](dst, src, N)
+    # only the first config is benchmarked before the budget runs out
+    timings = _kernel.configs_timings
+    assert timings[configs[0]][0] != float('inf')
+    assert all(timings[config][0] == float('inf') for config in configs[1:])
+    assert _kernel.best_config is configs[0]
+
+
+def test_rank_by_resources():
+    configs = [triton.Config({}, num_warps=4), triton.Config({}, num_warps=4), triton.Config({}, num_warps=4)]
+    num_sms = triton.runtime.driver.utils.get_device_properties(torch.cuda.current_device())["multiprocessor_count"]
+    # a full wave, a wave and one program, and spills
+    usages = {configs[0]: {"n_spills": 0, "occupancy": 16, "num_programs": num_sms * 4},
+              configs[1]: {"n_spills": 0, "occupancy": 16, "num_programs": num_sms * 4 + 1},
+              configs[2]: {"n_spills": 32, "occupancy": 16, "num_programs": num_sms * 4}}
+    prune = autotuner.rank_by_resources(top_k=2)
+    assert prune(configs, usages) == [configs[0], configs[2]]
+    assert autotuner.rank_by_resources(top_k=1)(configs, {}) == [configs[0]]
+
+
+def test_estimate_prune():
+    N = 256
+    a = torch.randn((N, N), device='cuda')
+    out = torch.empty((N, N), device='cuda')
+
+    # The operands of the largest config take 512KB of shared memory
+    configs = [triton.Config(kwargs={'BLOCK': 32}, num_stages=1),
+               triton.Config(kwargs={'BLOCK': 256}, num_stages=1)]
+
+    @triton.autotune(configs=configs, key=['N'], prune_configs_by={'resource_prune': None})
+    @triton.jit
+    def _kernel(A, Out, N, BLOCK: tl.constexpr):
+        offs = tl.arange(0, BLOCK)
+        ptrs = offs[:, None] * N + offs[None, :]
+        x = tl.load(A + ptrs)
+        tl.store(Out + ptrs, tl.dot(x, x, allow_tf32=False))
+    _kernel[(1,)](a, out, N)
+    assert list(_kernel.configs_timings) == [configs[0]]
+
+
+def test_async_compile():
+    src = torch.randn(4096, device='cuda')
+    dst = torch.empty_like(src)
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 32}), triton.Config(kwargs={'BLOCK_SIZE': 128})]
+
+    @triton.autotune(configs=configs, key=['N'], async_compile=True)
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+    grid = lambda META: (triton.cdiv(META['N'], META['BLOCK_SIZE']),)
+    # the first key is tuned synchronously
+    _kernel[grid](dst, src, 1024)
+    tuned = _kernel.best_config
+    assert (1024, ) in _kernel.cache
+    # a new key launches the tuned config until its configs are compiled
+    _kernel[grid](dst, src, 4096)
+    assert (4096, ) not in _kernel.cache and _kernel.best_config is tuned
+    assert torch.equal(dst, src)
+    _kernel._pending[(4096, )].result()
+    _kernel[grid](dst, src, 4096)
+    assert (4096, ) in _kernel.cache
+
+
+def test_key_buckets():
+    src = torch.randn(4096, device='cuda')
+    dst = torch.empty_like(src)
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 32}), triton.Config(kwargs={'BLOCK_SIZE': 128})]
+
+    @triton.autotune(configs=configs, key=['N'], key_buckets={'N': triton.next_power_of_2})
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+    grid = lambda META: (triton.cdiv(META['N'], META['BLOCK_SIZE']),)
+    for n in [1000, 1024, 3000, 4000]:
+        _kernel[grid](dst, src, n)
+        assert torch.equal(dst[:n], src[:n])
+    assert sorted(_kernel.cache) == [(1024, ), (4096, )]
+
+
+def test_reuse_nearest():
+    src = torch.randn(4096, device='cuda')
+    dst = torch.empty_like(src)
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 32}), triton.Config(kwargs={'BLOCK_SIZE': 128})]
+
+    @triton.autotune(configs=configs, key=['N'], reuse_nearest=True)
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+    grid = lambda META: (triton.cdiv(META['N'], META['BLOCK_SIZE']),)
+    _kernel[grid](dst, src, 1024)
+    tuned = _kernel.cache[(1024, )]
+    timings = _kernel.configs_timings
+    for n in [1000, 4000]:
+        _kernel[grid](dst, src, n)
+        assert torch.equal(dst[:n], src[:n])
+        assert _kernel.cache[(n, )] is tuned
+    # the new keys borrow the config without benchmarking
+    assert _kernel.configs_timings is timings
@@ -1,3 +1,4 @@
+import json
 import multiprocessing
 import os
 import shutil
@@ -8,6 +9,8 @@ import torch
 
 import triton
 import triton.language as tl
+from triton.compiler.compiler import _kernel_cache
+from triton.runtime.cache import PackedCacheManager, RemoteCacheBackend, RemoteCacheManager
 from triton.runtime.jit import JITFunction
 
 tmpdir = ".tmp"
@@ -106,6 +109,26 @@ def test_specialize(mode):
     assert counter == target
 
 
+def test_dispatch_key():
+    @triton.jit
+    def kernel_key(X, i, f, N: tl.constexpr):
+        tl.store(X, N)
+
+    device = torch.cuda.current_device()
+    x = torch.empty(32, dtype=torch.int32, device='cuda')
+    for i in [1, 16, 17, 33, 2**31]:
+        kernel_key[(1,)](x, i, 1.0, N=3)
+    keys = list(kernel_key.cache[device].keys())
+    assert len(keys) == 4
+    assert [key[1][1] for key in keys] == ['i32', 'i32', 'i32', 'i64']
+    assert all(key[1][0] == torch.int32 and key[1][2] == 'fp32' for key in keys)
+    assert all(key[2] == (3,) for key in keys)
+    assert [key[3][1] for key in keys] == [(False, True), (True, False), (False, False), (True, False)]
+    # launching again hits the cache
+    kernel_key[(1,)](x, 33, 1.0, N=3)
+    assert len(kernel_key.cache[device]) == 4
+
+
 def test_constexpr_not_callable() -> None:
     @triton.jit
     def kernel(X, c: tl.constexpr):
@@ -126,6 +149,72 @@ def test_constexpr_not_callable() -> None:
     assert error is True
 
 
+def test_constexpr_jit_function(tmp_path, monkeypatch) -> None:
+    @triton.jit
+    def kernel(X, FN: tl.constexpr):
+        tl.store(X, FN(tl.load(X)))
+
+    @triton.jit
+    def add_one(x):
+        return x + 1
+
+    @triton.jit
+    def double(x):
+        return x * 2
+
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path))
+    x = torch.ones(1, dtype=torch.int32, device='cuda')
+    kernel[(1, )](x, add_one)
+    kernel[(1, )](x, double)
+    assert x.item() == 4
+    assert len(kernel.cache[0]) == 2
+    # the function is keyed by its source, not its name
+    kwargs = dict(signature={0: "*i32"}, constants={1: double}, configs=[instance_descriptor([0], [])])
+    key = triton.compiler.compiler.make_hash(kernel, 80, **kwargs)
+    double.src = double.src.replace("x * 2", "x * 3")
+    assert key != triton.compiler.compiler.make_hash(kernel, 80, **kwargs)
+
+
+@triton.jit
+def callee_scale(x, SCALE: tl.constexpr):
+    return function_2(x) * SCALE
+
+
+def test_callee_cache(tmp_path, monkeypatch) -> None:
+    @triton.jit
+    def kernel_callee(X, BLOCK: tl.constexpr):
+        offsets = tl.arange(0, BLOCK)
+        tl.store(X + offsets, callee_scale(tl.load(X + offsets), 2))
+
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path))
+    # count the generations of the callee, not the parses of its hash
+    kernel_callee.cache_key
+    parses = []
+    parse = callee_scale.parse
+    monkeypatch.setattr(callee_scale, "parse", lambda: parses.append(1) or parse())
+    x = torch.ones(4, dtype=torch.int32, device='cuda')
+    kernel_callee[(1,)](x, BLOCK=4)
+    # the other specializations of the kernel splice the TTIR of the callee
+    y = torch.ones(8, dtype=torch.int32, device='cuda')
+    kernel_callee[(1,)](y, BLOCK=8)
+    z = torch.ones(5, dtype=torch.int32, device='cuda')
+    kernel_callee[(1,)](z[1:], BLOCK=4)
+    assert len(parses) == 2
+    assert torch.all(x == 4) and torch.all(y == 4)
+    assert torch.equal(z, torch.tensor([1, 4, 4, 4, 4], dtype=torch.int32, device='cuda'))
+
+
+def test_callee_cache_key_target(monkeypatch) -> None:
+    from triton.compiler import code_generator
+    from triton.compiler.code_generator import _CalleeCache
+    key = _CalleeCache.key(callee_scale, "callee_scale")
+    # the callees generated for another compute capability or backend are not reused
+    monkeypatch.setattr(code_generator, "get_device_capability", lambda device: (1, 0))
+    assert _CalleeCache.key(callee_scale, "callee_scale") != key
+    monkeypatch.setattr(torch.version, "hip", "5.6")
+    assert _CalleeCache.key(callee_scale, "callee_scale")[-1] == ("hip",)
+
+
 def test_jit_warmup_cache() -> None:
     @triton.jit
     def kernel_add(a, b, o, N: tl.constexpr):
@@ -148,6 +237,24 @@ def test_jit_warmup_cache() -> None:
     assert len(kernel_add.cache) == 1
 
 
+def test_cache_hit_reads_binary_only() -> None:
+    @triton.jit
+    def kernel_lazy(X, N: tl.constexpr):
+        tl.store(X, N)
+
+    device = torch.cuda.current_device()
+    x = torch.empty(1, dtype=torch.int32, device='cuda')
+    kernel_lazy[(1,)](x, N=1)
+    ttir = list(kernel_lazy.cache[device].values())[0].asm['ttir']
+    # drop the in-memory copies so that the kernel is loaded from the disk cache
+    _kernel_cache.clear()
+    kernel_lazy.cache[device].clear()
+    kernel_lazy[(1,)](x, N=1)
+    asm = list(kernel_lazy.cache[device].values())[0].asm
+    assert not dict.__contains__(asm, 'ttir')
+    assert asm['ttir'] == ttir
+
+
 def test_jit_debug() -> None:
     @triton.jit
     def kernel_add(a, b, o, N: tl.constexpr):
@@ -241,3 +348,410 @@ def test_memory_leak() -> None:
         x0 = xindex
         tmp0 = tl.load(in_ptr0 + (x0), xmask)
         tl.store(out_ptr0 + (x0 + tl.zeros([XBLOCK], tl.int32)), tmp0, xmask)
+
+
+class DictRemoteCacheBackend(RemoteCacheBackend):
+    store = {}
+
+    def __init__(self, key):
+        self._key = key
+
+    def get(self, filenames):
+        return {f: self.store[(self._key, f)] for f in filenames if (self._key, f) in self.store}
+
+    def put(self, filename, data):
+        self.store[(self._key, filename)] = data
+
+
+def test_remote_cache(tmp_path, monkeypatch):
+    monkeypatch.setenv("TRITON_REMOTE_CACHE_BACKEND", f"{__name__}:DictRemoteCacheBackend")
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path / "node0"))
+    writer = RemoteCacheManager("key")
+    group = {"kernel.ptx": writer.put("ptx", "kernel.ptx"),
+             "kernel.cubin": writer.put(b"cubin", "kernel.cubin")}
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path / "node1"))
+    reader = RemoteCacheManager("key")
+    # the group is not visible before it is published
+    assert reader.get_group("kernel.json") is None
+    writer.put_group("kernel.json", group)
+    paths = reader.get_group("kernel.json")
+    assert sorted(paths) == ["kernel.cubin", "kernel.ptx"]
+    assert paths["kernel.ptx"].startswith(str(tmp_path / "node1"))
+    with open(paths["kernel.cubin"], "rb") as f:
+        assert f.read() == b"cubin"
+
+
+def test_packed_cache(tmp_path, monkeypatch):
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path))
+    monkeypatch.setenv("TRITON_CACHE_MAX_SIZE", "4K")
+    writer = PackedCacheManager("key0")
+    group = {"kernel.ptx": writer.put("ptx", "kernel.ptx"),
+             "kernel.cubin": writer.put(b"cubin", "kernel.cubin")}
+    # the group is not visible before it is published
+    assert PackedCacheManager("key0").get_group("kernel.json") is None
+    writer.put_group("kernel.json", group)
+    paths = PackedCacheManager("key0").get_group("kernel.json")
+    assert sorted(paths) == ["kernel.cubin", "kernel.ptx"]
+    with open(paths["kernel.cubin"], "rb") as f:
+        assert f.read() == b"cubin"
+    # each key is a single archive
+    assert sorted(os.listdir(tmp_path / "packed")) == ["index.json", "key0.zip", "lock"]
+    # the least recently used archives are evicted beyond the maximum size
+    PackedCacheManager("key1").put(b"1" * 2048, "kernel.cubin")
+    os.utime(tmp_path / "packed" / "key1.zip", (0, 0))
+    PackedCacheManager("key2").put(b"2" * 2048, "kernel.cubin")
+    assert not (tmp_path / "packed" / "key1.zip").exists()
+    assert PackedCacheManager("key1").get_file("kernel.cubin") is None
+    assert PackedCacheManager("key0").get_group("kernel.json") is not None
+    with open(tmp_path / "packed" / "index.json") as f:
+        assert sorted(json.load(f)) == ["key0", "key2"]
+
+
+def test_cache_ir(tmp_path, monkeypatch) -> None:
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path))
+    monkeypatch.setenv("TRITON_CACHE_IR", "0")
+
+    @triton.jit
+    def kernel_no_ir(X, N: tl.constexpr):
+        tl.store(X, N)
+
+    device = torch.cuda.current_device()
+    x = torch.empty(1, dtype=torch.int32, device='cuda')
+    kernel_no_ir[(1,)](x, N=1)
+    files = [f for _, _, files in os.walk(tmp_path) for f in files if f.startswith("kernel_no_ir.")]
+    assert sorted(f.split(".")[-1] for f in files if not f.endswith(".so")) == ["cubin", "json"]
+    # the entry without IRs is a cache hit
+    _kernel_cache.clear()
+    kernel_no_ir.cache[device].clear()
+    kernel_no_ir[(1,)](x, N=1)
+    assert "ttir" not in list(kernel_no_ir.cache[device].values())[0].asm
+
+
+def test_num_stages_within_shared() -> None:
+    @triton.jit
+    def kernel_dot(a, b, o, K, BLOCK: tl.constexpr):
+        offs = tl.arange(0, BLOCK)
+        a_ptrs = a + offs[:, None] * K + offs[None, :]
+        b_ptrs = b + offs[:, None] * BLOCK + offs[None, :]
+        acc = tl.zeros((BLOCK, BLOCK), dtype=tl.float32)
+        for _ in range(0, K, BLOCK):
+            acc += tl.dot(tl.load(a_ptrs), tl.load(b_ptrs))
+            a_ptrs += BLOCK
+            b_ptrs += BLOCK * BLOCK
+        tl.store(o + offs[:, None] * BLOCK + offs[None, :], acc)
+
+    kwargs = dict(signature={0: "*fp16", 1: "*fp16", 2: "*fp32", 3: "i32"},
+                  device=0, constants={4: 64}, num_stages=6,
+                  configs=[instance_descriptor([0, 1, 2, 3], [])])
+    unbounded = triton.compile(kernel_dot, **kwargs)
+    bounded = triton.compile(kernel_dot, max_shared=unbounded.shared // 2, **kwargs)
+    assert unbounded.num_stages == 6
+    assert 1 <= bounded.num_stages < 6
+    assert bounded.shared < unbounded.shared
+
+
+def test_opt_level(tmp_path, monkeypatch) -> None:
+    @triton.jit
+    def kernel_add(a, b, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx, tl.load(a + idx) + tl.load(b + idx))
+
+    kwargs = dict(signature={0: "*fp32", 1: "*fp32", 2: "*fp32"},
+                  device=0, constants={3: 32},
+                  configs=[instance_descriptor([0, 1, 2], [])])
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path))
+    fast = triton.compile(kernel_add, opt_level=1, **kwargs)
+    default = triton.compile(kernel_add, **kwargs)
+    assert fast.metadata["opt_level"] == 1
+    assert default.metadata["opt_level"] == 3
+    # The compiled stages report their time
+    assert fast.metadata["compile_times"].keys() >= {"ttir", "ttgir", "llir", "ptx", "cubin"}
+
+
+def test_launch_bounds(tmp_path, monkeypatch) -> None:
+    @triton.jit
+    def kernel_add(a, b, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx, tl.load(a + idx) + tl.load(b + idx))
+
+    kwargs = dict(signature={0: "*fp32", 1: "*fp32", 2: "*fp32"},
+                  device=0, constants={3: 1024},
+                  configs=[instance_descriptor([0, 1, 2], [])])
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path))
+    bounded = triton.compile(kernel_add, maxnreg=32, min_blocks_per_sm=2, **kwargs)
+    default = triton.compile(kernel_add, **kwargs)
+    assert ".maxnreg 32" in bounded.asm["ptx"]
+    assert ".minnctapersm 2" in bounded.asm["ptx"]
+    assert ".maxnreg" not in default.asm["ptx"]
+    assert bounded.metadata["maxnreg"] == 32
+    bounded._init_handles()
+    assert bounded.n_regs <= 32
+
+
+def test_fatbin(tmp_path, monkeypatch) -> None:
+    @triton.jit
+    def kernel_fat(X, N: tl.constexpr):
+        tl.store(X, N)
+
+    major, minor = torch.cuda.get_device_capability()
+    capability = major * 10 + minor
+    if capability < 80:
+        pytest.skip("the test needs an sm_80 or newer device")
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path))
+    device = torch.cuda.current_device()
+    x = torch.empty(1, dtype=torch.int32, device='cuda')
+    kwargs = dict(signature={0: "*i32"}, device=device, constants={1: 1})
+    fat = triton.compile(kernel_fat, fatbin_archs=[capability, 80], **kwargs)
+    assert fat.metadata["fatbin_archs"] == sorted({80, capability})
+    assert ".target sm_80" in fat.asm["ptx"]
+    if capability != 80:
+        assert fat._get_binary(device) == fat.asm[f"cubin_{capability}"]
+    fat[(1, 1, 1)](x)
+    assert x.item() == 1
+    # the devices without a cubin of their major version compile the PTX
+    kwargs["constants"] = {1: 2}
+    ptx = triton.compile(kernel_fat, fatbin_archs=[70], **kwargs)
+    assert ptx._get_binary(device) == ptx.asm["ptx"].encode("utf-8") + b"\0"
+    ptx[(1, 1, 1)](x)
+    assert x.item() == 2
+
+
+def test_compile_target(tmp_path, monkeypatch) -> None:
+    @triton.jit
+    def kernel_dot(a, b, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        offs = idx[:, None] * N + idx[None, :]
+        tl.store(o + offs, tl.dot(tl.load(a + offs), tl.load(b + offs)))
+
+    kwargs = dict(signature={0: "*fp16", 1: "*fp16", 2: "*fp32"},
+                  device=0, constants={3: 64},
+                  configs=[instance_descriptor([0, 1, 2], [])])
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path))
+    estimate = triton.compile(kernel_dot, target="ttgir", **kwargs)
+    assert isinstance(estimate, triton.compiler.EstimatedKernel)
+    assert "ttgir" in estimate.asm and "ptx" not in estimate.asm
+    assert estimate.n_regs > 0
+    assert estimate.fits()
+    llir_estimate = triton.compile(kernel_dot, target="llir", **kwargs)
+    assert "llir" in llir_estimate.asm and "ptx" not in llir_estimate.asm
+    # The estimates don't stand in for the compiled kernel in the cache
+    kernel = triton.compile(kernel_dot, **kwargs)
+    assert isinstance(kernel, triton.compiler.CompiledKernel)
+    assert estimate.shared == llir_estimate.shared == kernel.shared > 0
+
+
+def test_perf_lint(tmp_path, monkeypatch) -> None:
+    @triton.jit
+    def kernel_strided(a, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx, tl.load(a + 2 * idx))
+
+    kwargs = dict(signature={0: "*fp32", 1: "*fp32"}, device=0, constants={2: 1024},
+                  configs=[instance_descriptor([0, 1], [])])
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path))
+    with pytest.warns(triton.compiler.PerformanceWarning, match="load is not vectorized"):
+        kernel = triton.compile(kernel_strided, perf_lint=True, **kwargs)
+    remarks = kernel.metadata["perf_remarks"]
+    assert len(remarks) == 1
+    # the remark points at the line of the load
+    line = kernel_strided.src.splitlines().index("        tl.store(o + idx, tl.load(a + 2 * idx))")
+    assert f"test_cache.py:{kernel_strided.starting_line_number + line}:" in remarks[0]
+    assert "contiguity=1" in remarks[0]
+    # the lint doesn't run by default
+    assert "perf_remarks" not in triton.compile(kernel_strided, **kwargs).metadata
+
+
+def test_compile_trace(tmp_path, monkeypatch) -> None:
+    @triton.jit
+    def kernel_copy(a, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx, tl.load(a + idx))
+
+    trace_path = tmp_path / "trace.jsonl"
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path / "cache"))
+    monkeypatch.setenv("TRITON_COMPILE_TRACE", str(trace_path))
+    kernel = triton.compile(kernel_copy, signature={0: "*fp32", 1: "*fp32"},
+                            device=0, constants={2: 32},
+                            configs=[instance_descriptor([0, 1], [])])
+    assert "TritonGPURemoveLayoutConversions" in kernel.metadata["pass_times"]["ttgir"]
+    with open(trace_path) as f:
+        reports = [json.loads(line) for line in f]
+    assert len(reports) == 1
+    assert reports[0]["name"] == kernel.metadata["name"]
+    assert reports[0]["compile_times"] == kernel.metadata["compile_times"]
+
+
+def test_context_pool() -> None:
+    ir = triton._C.libtriton.triton.ir
+    context = ir.acquire_context()
+    try:
+        _, _, is_new = ir.pass_manager.get(context, "test-pipeline")
+        assert is_new
+        _, _, is_new = ir.pass_manager.get(context, "test-pipeline")
+        assert not is_new
+    finally:
+        ir.release_context(context)
+    # Other contexts don't keep their pipelines
+    fresh = ir.context()
+    assert ir.pass_manager.get(fresh, "test-pipeline")[2]
+    assert ir.pass_manager.get(fresh, "test-pipeline")[2]
+
+
+def test_resident_modules(monkeypatch) -> None:
+    from triton.compiler.compiler import CompiledKernel, _ResidentModules
+
+    @triton.jit
+    def kernel_fill(o, VALUE: tl.constexpr):
+        tl.store(o, VALUE)
+
+    # A single module stays loaded
+    monkeypatch.setattr(CompiledKernel, "resident_modules", _ResidentModules(max_bytes=1))
+    out = torch.zeros(1, device="cuda")
+    first = kernel_fill[(1,)](out, VALUE=1)
+    second = kernel_fill[(1,)](out, VALUE=2)
+    assert first.cu_module is None and second.cu_module is not None
+    assert out.item() == 2
+    kernel_fill[(1,)](out, VALUE=1)
+    assert out.item() == 1
+    assert first.cu_module is not None and second.cu_module is None
+
+
+def test_resident_modules_pinned(monkeypatch) -> None:
+    from types import SimpleNamespace
+
+    from triton.compiler import compiler
+
+    class Kernel:
+        def __init__(self):
+            self._handles = dict()
+
+    unloaded = []
+    utils = SimpleNamespace(unload_binary=lambda mod, device: unloaded.append(mod))
+    monkeypatch.setattr(compiler, "driver", SimpleNamespace(utils=utils))
+    resident = compiler._ResidentModules(max_bytes=1)
+    first, second = Kernel(), Kernel()
+    # the module of a launch in flight stays loaded past the bound
+    assert resident.add(first, 0, ("first", None), 1, pin=True) == ("first", None)
+    assert resident.add(second, 0, ("second", None), 1) == ("second", None)
+    assert resident.acquire(first, 0) == ("first", None)
+    assert unloaded == []
+    # and the least recently launched module is unloaded once it is released
+    resident.release(first, 0)
+    assert unloaded == ["second"]
+    assert resident.acquire(second, 0) is None
+    # of two concurrent loads, the second one is unloaded
+    assert resident.add(first, 0, ("reloaded", None), 1) == ("first", None)
+    assert unloaded == ["second", "reloaded"]
+    assert resident.num_bytes == 1
+
+
+def test_preload() -> None:
+
+    @triton.jit
+    def kernel_fill(o, VALUE: tl.constexpr):
+        tl.store(o, VALUE)
+
+    devices = list(range(torch.cuda.device_count()))
+    bins = kernel_fill.preload(torch.float32, devices=devices, VALUE=3)
+    assert sorted(bins) == devices
+    # one compilation for the devices of the same target
+    capability = torch.cuda.get_device_capability(0)
+    shared = [bins[d] for d in devices if torch.cuda.get_device_capability(d) == capability]
+    assert all(bin is shared[0] for bin in shared)
+    for device in devices:
+        assert device in bins[device]._handles
+        out = torch.zeros(1, device=f"cuda:{device}")
+        with torch.cuda.device(device):
+            assert kernel_fill[(1,)](out, VALUE=3) is bins[device]
+        assert out.item() == 3
+
+
+@pytest.mark.skipif(torch.cuda.device_count() < 2, reason="requires two devices")
+def test_handles_per_device() -> None:
+
+    @triton.jit
+    def kernel_add(o, VALUE: tl.constexpr):
+        tl.store(o, tl.load(o) + VALUE)
+
+    outs = [torch.zeros(1, device=f"cuda:{device}") for device in range(2)]
+    with torch.cuda.device(0):
+        bin = kernel_add[(1,)](outs[0], VALUE=1)
+    # the kernel is loaded on the second device at its first launch there
+    assert 1 not in bin._handles
+    with torch.cuda.device(1):
+        bin[(1,)](outs[1])
+        assert bin._handles[1] != bin._handles[0]
+        assert bin.cu_module == bin._handles[1][0]
+    assert [out.item() for out in outs] == [1, 1]
+    # the JIT shares the kernel across the devices of the same target
+    if torch.cuda.get_device_capability(0) == torch.cuda.get_device_capability(1):
+        with torch.cuda.device(1):
+            assert kernel_add[(1,)](outs[1], VALUE=1) is bin
+        assert outs[1].item() == 2
+
+
+def test_async_compile() -> None:
+
+    @triton.jit(async_compile=True)
+    def kernel_copy(dst, src, n, BLOCK: tl.constexpr):
+        offs = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        tl.store(dst + offs, tl.load(src + offs, mask=offs < n), mask=offs < n)
+
+    src = torch.randn(1024, device='cuda')
+    dst = torch.empty_like(src)
+    device = torch.cuda.current_device()
+    # the first launch runs the unspecialized variant
+    fallback = kernel_copy[(8,)](dst, src, 1024, BLOCK=128)
+    assert fallback.constants == {3: 128}
+    assert torch.equal(dst, src)
+    kernel_copy.wait_for_compilations()
+    assert len(kernel_copy.cache[device]) == 1
+    bin, = kernel_copy.cache[device].values()
+    assert bin is not fallback
+    dst.zero_()
+    assert kernel_copy[(8,)](dst, src, 1024, BLOCK=128) is bin
+    assert torch.equal(dst, src)
+    # a new specialization of the signature launches the same fallback
+    assert kernel_copy[(1,)](dst[1:], src[1:], 1, BLOCK=128) is fallback
+    kernel_copy.wait_for_compilations()
+    assert len(kernel_copy.cache[device]) == 2
+
+
+def test_buckets() -> None:
+
+    @triton.jit(buckets={"MAX_N": [64, 256, 1024]})
+    def kernel_sum(out, x, n, MAX_N: tl.constexpr):
+        offs = tl.arange(0, MAX_N)
+        tl.store(out, tl.sum(tl.load(x + offs, mask=offs < n, other=0.), axis=0))
+
+    x = torch.ones(1024, device='cuda')
+    out = torch.empty(1, device='cuda')
+    device = torch.cuda.current_device()
+    # the sizes of a bucket share its kernel
+    for n in [16, 32, 48, 64, 80, 224]:
+        bin = kernel_sum[(1,)](out, x, n, MAX_N=n)
+        assert out.item() == n
+    assert len(kernel_sum.cache[device]) == 2
+    assert bin.constants[3] == 256
+    with pytest.raises(ValueError, match="largest bucket"):
+        kernel_sum[(1,)](out, x, 1024, MAX_N=2048)
+    with pytest.raises(AssertionError, match="constexpr"):
+        triton.jit(kernel_sum.fn, buckets={"n": [16]})
+
+
+def test_auto_num_warps() -> None:
+
+    @triton.jit(auto_num_warps=True)
+    def kernel_bias(x, bias, N: tl.constexpr):
+        offs = tl.arange(0, N)
+        tl.store(x + offs, tl.load(x + offs) + tl.load(bias))
+
+    x = torch.zeros(1024, device='cuda')
+    bias = torch.ones(1, device='cuda')
+    # the tensors smaller than the warps keep the warps that own elements
+    for n, num_warps in [(16, 1), (64, 2), (1024, 8)]:
+        bin = kernel_bias[(1,)](x, bias, N=n, num_warps=8)
+        assert bin.num_warps == num_warps
+        assert f'"triton_gpu.num-warps" = {num_warps}' in bin.asm["ttgir"]
+    assert torch.equal(x[:16], torch.full((16,), 3., device='cuda'))
+    assert torch.equal(x[64:], torch.ones(960, device='cuda'))
@@ -12,3 +12,18 @@ def test_is_lazy():
     assert triton.runtime.driver._obj is None
     utils = triton.runtime.driver.utils  # noqa: F841
     assert issubclass(triton.runtime.driver._obj.__class__, getattr(mod, "DriverBase"))
+
+
+def test_occupancy():
+    # The limits of an A100
+    props = {"max_regs_per_sm": 65536, "max_threads_per_sm": 2048, "max_blocks_per_sm": 32,
+             "max_shared_mem_per_sm": 167936, "reserved_shared_mem": 1024}
+    usage = triton.runtime.occupancy(128, 0, 4, properties=props)
+    assert usage == {"blocks": 4, "warps": 16, "occupancy": 0.25, "limiter": "registers"}
+    usage = triton.runtime.occupancy(32, 65536, 4, properties=props)
+    assert usage["blocks"] == 2 and usage["limiter"] == "shared memory"
+    assert triton.runtime.occupancy(16, 0, 1, properties=props)["limiter"] == "blocks"
+    assert triton.runtime.max_regs_for_occupancy(4, 4, properties=props) == 128
+    assert triton.runtime.max_regs_for_occupancy(4, 8, properties=props) == 64
+    assert triton.runtime.max_regs_for_occupancy(8, 8, properties=props) == 32
+    assert triton.runtime.max_regs_for_occupancy(8, 9, properties=props) == 0
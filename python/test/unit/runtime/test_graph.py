@@ -0,0 +1,72 @@
+import torch
+
+import triton
+import triton.language as tl
+
+
+@triton.jit
+def add_kernel(X, Y, Z, N, BLOCK: tl.constexpr):
+    offs = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+    mask = offs < N
+    x = tl.load(X + offs, mask=mask)
+    y = tl.load(Y + offs, mask=mask)
+    tl.store(Z + offs, x + y, mask=mask)
+
+
+@triton.autotune(configs=[triton.Config({'BLOCK': 128}), triton.Config({'BLOCK': 256})], key=['N'])
+@triton.jit
+def scale_kernel(X, Z, N, BLOCK: tl.constexpr):
+    offs = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+    mask = offs < N
+    tl.store(Z + offs, tl.load(X + offs, mask=mask) * 2, mask=mask)
+
+
+def test_replay():
+    N = 1000
+    x = torch.randn(N, device='cuda')
+    y = torch.randn(N, device='cuda')
+    z = torch.empty_like(x)
+    w = torch.empty_like(x)
+
+    def step(x, y):
+        add_kernel[(triton.cdiv(N, 256),)](x, y, z, N, BLOCK=256)
+        grid = lambda meta: (triton.cdiv(N, meta['BLOCK']),)
+        scale_kernel[grid](z, w, N)
+        return w
+
+    graph = triton.runtime.KernelGraph()
+    out = graph.capture(step, x, y)
+    for _ in range(3):
+        new_x = torch.randn(N, device='cuda')
+        out = graph.replay(new_x, y)
+        torch.cuda.synchronize()
+        torch.testing.assert_close(out, (new_x + y) * 2)
+    # replaying without arguments reuses the last inputs
+    out = graph.replay()
+    torch.cuda.synchronize()
+    torch.testing.assert_close(out, (new_x + y) * 2)
+
+
+def test_do_bench_cudagraph():
+    N = 1024 * 1024
+    x = torch.randn(N, device='cuda')
+    y = torch.randn(N, device='cuda')
+    z = torch.empty_like(x)
+    fn = lambda: add_kernel[(triton.cdiv(N, 1024),)](x, y, z, N, BLOCK=1024)
+    stats = triton.testing.do_bench_cudagraph(fn, rep=5, num_samples=10, return_mode="stats")
+    assert stats.num_samples == 10
+    assert 0 < stats.ci_low <= stats.mean <= stats.ci_high
+    # the back-to-back launches ran on the inputs
+    torch.testing.assert_close(z, x + y)
+    ms = triton.testing.do_bench_cudagraph(fn, rep=5, quantiles=[0.5])
+    assert ms > 0
+    util = triton.testing.get_utilization(ms, num_bytes=3 * N * x.element_size())
+    assert util["gbps"] > 0 and util["dram_util"] > 0
+
+
+def test_bench_stats():
+    stats = triton.testing.get_bench_stats([1., 2., 3.])
+    assert stats.mean == 2. and stats.median == 2. and stats.std == 1.
+    # t(0.975, 2) * std / sqrt(3)
+    assert abs(stats.ci_high - stats.mean - 4.303 / 3 ** 0.5) < 1e-6
+    assert stats.as_tuple() == (stats.mean, stats.ci_low, stats.ci_high)
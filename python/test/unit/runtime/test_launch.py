@@ -7,6 +7,7 @@ import gc
 # import time
 import tracemalloc
 
+import pytest
 import torch
 
 import triton
@@ -104,3 +105,160 @@ def test_memory_leak() -> None:
 
 #     # Run empty, which would run empty_kernel internally
 #     empty(*kernel_args)
+
+
+def test_launcher_arguments() -> None:
+
+    @triton.jit
+    def kernel(X, Y, scale, n, BLOCK: tl.constexpr):
+        offs = tl.arange(0, BLOCK)
+        mask = offs < n
+        tl.store(Y + offs, tl.load(X + offs, mask=mask) * scale, mask=mask)
+
+    x = torch.randn(100, device='cuda')
+    y = torch.empty_like(x)
+    bin = kernel[(1,)](x, y, 2., 100, BLOCK=128)
+    torch.testing.assert_close(y, x * 2)
+    # the compiled kernel takes raw pointers too
+    bin[(1,)](x.data_ptr(), y, 3., 100)
+    torch.testing.assert_close(y, x * 3)
+    # the hooks get the launch arguments, the kernel at index 9
+    launches = []
+    triton.compiler.CompiledKernel.launch_enter_hook = lambda *args: launches.append(args)
+    try:
+        kernel[(1,)](x, y, 4., 100, BLOCK=128)
+        bin[(1,)](x, y, 4., 100)
+    finally:
+        triton.compiler.CompiledKernel.launch_enter_hook = None
+    assert len(launches) == 2
+    assert all(args[9] is bin and args[10] is x and args[12] == 4. for args in launches)
+    with pytest.raises(ValueError, match="cpu tensor"):
+        bin[(1,)](x.cpu(), y, 1., 100)
+    with pytest.raises(TypeError, match="data_ptr"):
+        bin[(1,)](object(), y, 1., 100)
+    with pytest.raises(TypeError, match="arguments"):
+        bin[(1,)](x, y, 1.)
+    # the 32-bit integers are range-checked
+    with pytest.raises(OverflowError):
+        bin[(1,)](x, y, 1., 2**31)
+    with pytest.raises(OverflowError):
+        bin[(2**31,)](x, y, 1., 100)
+
+
+def test_launch_plan() -> None:
+
+    @triton.jit
+    def axpy(X, Y, alpha, n, BLOCK: tl.constexpr):
+        offs = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        mask = offs < n
+        y = tl.load(Y + offs, mask=mask)
+        tl.store(Y + offs, y + alpha * tl.load(X + offs, mask=mask), mask=mask)
+
+    sizes = [100, 1000, 5000]
+    xs = [torch.randn(n, device='cuda') for n in sizes]
+    ys = [torch.zeros(n, device='cuda') for n in sizes]
+    plan = triton.runtime.LaunchPlan()
+    for x, y in zip(xs, ys):
+        plan.add(axpy, (triton.cdiv(x.numel(), 256),), x, y, 2., x.numel(), BLOCK=256)
+    assert len(plan) == 3
+    plan.launch()
+    plan.launch()
+    for x, y in zip(xs, ys):
+        torch.testing.assert_close(y, 4 * x)
+    # the slots of a launch are rebound
+    z = torch.zeros(sizes[0], device='cuda')
+    plan.set_args(0, xs[0], z, -1., sizes[0])
+    plan.launch()
+    torch.testing.assert_close(z, -xs[0])
+    torch.testing.assert_close(ys[1], 6 * xs[1])
+    # a grid covering half of the elements
+    plan.set_grid(2, (triton.cdiv(sizes[2], 512),))
+    ys[2].zero_()
+    plan.launch()
+    torch.testing.assert_close(ys[2][:sizes[2] // 2 + 56], 2 * xs[2][:sizes[2] // 2 + 56])
+    assert (ys[2][-100:] == 0).all()
+    # the launches of the compiled kernels, seen by the hooks one by one
+    bin = axpy[(1,)](xs[0], z, 0., sizes[0], BLOCK=256)
+    launches = []
+    triton.compiler.CompiledKernel.launch_enter_hook = lambda *args: launches.append(args)
+    try:
+        triton.runtime.launch_batch([(bin, (1,), (xs[0], z, 1., sizes[0])), (bin, (1,), (xs[0], z, 1., sizes[0]))])
+    finally:
+        triton.compiler.CompiledKernel.launch_enter_hook = None
+    assert len(launches) == 2
+    torch.testing.assert_close(z, xs[0])
+
+
+def test_horizontal_fusion() -> None:
+
+    @triton.jit
+    def add_bias(X, B, n, BLOCK: tl.constexpr):
+        offs = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        mask = offs < n
+        tl.store(X + offs, tl.load(X + offs, mask=mask) + tl.load(B), mask=mask)
+
+    @triton.jit
+    def transpose(X, Y, M, N, BLOCK: tl.constexpr):
+        rm = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        rn = tl.program_id(1) * BLOCK + tl.arange(0, BLOCK)
+        mask = (rm[:, None] < M) & (rn[None, :] < N)
+        x = tl.load(X + rm[:, None] * N + rn[None, :], mask=mask)
+        tl.store(Y + rn[None, :] * M + rm[:, None], x, mask=mask)
+
+    xs = [torch.randn(n, device='cuda') for n in [100, 3000]]
+    biases = [torch.randn(1, device='cuda') for _ in xs]
+    a = torch.randn((50, 70), device='cuda')
+    b = torch.empty((70, 50), device='cuda')
+    expected = [x + bias for x, bias in zip(xs, biases)]
+    fusion = triton.runtime.HorizontalFusion()
+    for x, bias in zip(xs, biases):
+        fusion.add(add_bias, (triton.cdiv(x.numel(), 256),), x, bias, x.numel(), BLOCK=256)
+    fusion.add(transpose, lambda args: (triton.cdiv(args['M'], 16), triton.cdiv(args['N'], 16)), a, b, 50, 70,
+               BLOCK=16)
+    assert fusion.grid == (1 + 12 + 4 * 5,)
+    fusion.launch()
+    for x, y in zip(xs, expected):
+        torch.testing.assert_close(x, y)
+    torch.testing.assert_close(b, a.t())
+    # the fused kernel is generated once for the same kernels
+    assert triton.runtime.fusion.fuse([add_bias, add_bias, transpose]) is fusion.kernel
+
+
+def test_profiler(tmp_path) -> None:
+    import json
+
+    @triton.jit
+    def scale(X, n, BLOCK: tl.constexpr):
+        offs = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        mask = offs < n
+        tl.store(X + offs, tl.load(X + offs, mask=mask) * 2, mask=mask)
+
+    x = torch.ones(4096, device='cuda')
+    launches = []
+    triton.compiler.CompiledKernel.launch_enter_hook = lambda *args: launches.append(args)
+    try:
+        with triton.profiler.Profiler(sample_every=4) as prof:
+            for _ in range(10):
+                scale[(16,)](x, 4096, BLOCK=256)
+            scale[(8,)](x, 4096, BLOCK=512)
+    finally:
+        triton.compiler.CompiledKernel.launch_enter_hook = None
+    # the hooks installed before the profiler are chained
+    assert len(launches) == 11
+    assert triton.compiler.CompiledKernel.launch_exit_hook is None
+    assert (x == 2**11).all()
+    # one entry per specialization
+    stats = sorted(prof.stats.values(), key=lambda stats: stats.calls)
+    assert [(s.calls, s.timed_calls) for s in stats] == [(1, 1), (10, 3)]
+    assert stats[1].grids == {(16, 1, 1): 10}
+    assert stats[1].constants != stats[0].constants
+    assert stats[1].gpu_ms > 0 and stats[1].num_bytes == 3 * 4096 * 4
+    assert "scale" in prof.table()
+    prof.export_json(tmp_path / "stats.json")
+    with open(tmp_path / "stats.json") as f:
+        assert sorted(entry["calls"] for entry in json.load(f)) == [1, 10]
+    prof.export_chrome_trace(tmp_path / "trace.json")
+    with open(tmp_path / "trace.json") as f:
+        events = json.load(f)["traceEvents"]
+    assert len(events) == 4
+    assert all(event["ph"] == "X" and event["ts"] >= 0 and event["dur"] > 0 for event in events)
@@ -0,0 +1,57 @@
+import ctypes
+import os
+import subprocess
+import tempfile
+
+import pytest
+import torch
+
+import triton
+import triton.language as tl
+from triton.common.build import libcuda_dirs
+from triton.tools.aot import AOTKernel, build_library
+
+
+@triton.jit
+def add_kernel(x_ptr, y_ptr, out_ptr, n, BLOCK: tl.constexpr):
+    offsets = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+    mask = offsets < n
+    x = tl.load(x_ptr + offsets, mask=mask)
+    y = tl.load(y_ptr + offsets, mask=mask)
+    tl.store(out_ptr + offsets, x + y, mask=mask)
+
+
+def test_build_library():
+    if torch.version.hip is not None:
+        pytest.skip("the test links against libcuda")
+    kernel = AOTKernel(add_kernel, "*fp32, *fp32, *fp32, i32", constants={"BLOCK": [128, 256]},
+                       num_warps=[4], specialize=["x_ptr", "out_ptr", "n"])
+    with tempfile.TemporaryDirectory() as tmpdir:
+        header, source = build_library("add_lib", [kernel], tmpdir)
+        with open(header) as f:
+            src = f.read()
+        assert "CUresult add_kernel_BLOCK128_w4_s3(" in src
+        assert "CUresult add_kernel_BLOCK256_w4_s3(" in src
+        cuda_include = os.path.join(os.path.dirname(triton.__file__), "third_party", "cuda", "include")
+        so = os.path.join(tmpdir, "libadd_lib.so")
+        subprocess.check_call(["gcc", source, "-O2", "-shared", "-fPIC", f"-I{cuda_include}", "-o", so] +
+                              [f"-L{d}" for d in libcuda_dirs()] + ["-lcuda"])
+        lib = ctypes.CDLL(so)
+    # make the context of the current device current
+    torch.cuda.init()
+    torch.cuda.synchronize()
+    assert lib.add_lib_load() == 0
+    stream = torch.cuda.current_stream().cuda_stream
+    for n, offset in [(1024, 0), (1000, 0), (1000, 1)]:
+        x = torch.randn(n + offset, device='cuda')[offset:]
+        y = torch.randn(n, device='cuda')
+        out = torch.empty(n + offset, device='cuda')[offset:]
+        for block, launch in [(128, lib.add_kernel_BLOCK128_w4_s3), (256, lib.add_kernel_BLOCK256_w4_s3)]:
+            out.zero_()
+            ret = launch(ctypes.c_void_p(stream), ctypes.c_uint(triton.cdiv(n, block)), ctypes.c_uint(1),
+                         ctypes.c_uint(1), ctypes.c_uint64(x.data_ptr()), ctypes.c_uint64(y.data_ptr()),
+                         ctypes.c_uint64(out.data_ptr()), ctypes.c_int32(n))
+            assert ret == 0
+            torch.cuda.synchronize()
+            torch.testing.assert_close(out, x + y)
+    lib.add_lib_unload()
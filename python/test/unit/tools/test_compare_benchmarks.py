@@ -0,0 +1,31 @@
+from triton.tools import compare_benchmarks
+
+
+def results(**benchmarks):
+    return {"version": compare_benchmarks.RESULTS_VERSION, "device": "gpu",
+            "benchmarks": {name: {"mean": mean, "std": std, "num_samples": 20}
+                           for name, (mean, std) in benchmarks.items()}}
+
+
+def test_compare():
+    baseline = results(slower=(1.0, 0.01), faster=(1.0, 0.01), noisy=(1.0, 0.5), small=(1.0, 0.001),
+                       removed=(1.0, 0.01))
+    current = results(slower=(1.1, 0.01), faster=(0.9, 0.01), noisy=(1.1, 0.5), small=(1.01, 0.001),
+                      added=(1.0, 0.01))
+    rows = {row["name"]: row for row in compare_benchmarks.compare(baseline, current)}
+    assert set(rows) == {"slower", "faster", "noisy", "small"}
+    assert rows["slower"]["status"] == "regression"
+    assert rows["faster"]["status"] == "improvement"
+    # within the noise of the measurements
+    assert rows["noisy"]["status"] == "unchanged"
+    # significant, but under the threshold
+    assert rows["small"]["status"] == "unchanged"
+
+
+def test_main(tmp_path):
+    baseline, current = tmp_path / "baseline.json", tmp_path / "current.json"
+    compare_benchmarks.save(baseline, "gpu", results(matmul=(1.0, 0.01))["benchmarks"])
+    compare_benchmarks.save(current, "gpu", results(matmul=(1.2, 0.01))["benchmarks"], commit="abc")
+    assert compare_benchmarks.load(current)["commit"] == "abc"
+    assert compare_benchmarks.main([str(baseline), str(current)]) == 1
+    assert compare_benchmarks.main([str(baseline), str(baseline)]) == 0
@@ -0,0 +1,59 @@
+import torch
+
+import triton
+import triton.language as tl
+from triton.tools.instruction_mix import analyze
+
+SASS = """Function:kernel
+--:-:-:Y:4\tMOV R1, c[0x0][0x28];
+--:-:0:Y:2\t@!P0 LDG.E.128 R4, [R2.64];
+--:-:0:Y:2\tLDG.E R8, [R2.64];
+--:-:-:Y:2\t@PT LDG.E R9, [R2.64];
+--:-:-:Y:2\tSTS.128 [R0], R4;
+--:-:-:Y:2\tBAR.SYNC 0x0;
+--:-:-:Y:2\tLDSM.16.M88.4 R12, [R0];
+--:-:-:Y:2\tLDS.U16 R12, [R0];
+--:-:-:Y:2\tHMMA.16816.F32 R16, R12, R14, R16;
+--:-:-:Y:2\tF2FP.PACK_AB R3, R2, R1;
+LBB0:
+--:-:-:Y:2\tSHFL.BFLY PT, R3, R2, 0x1, 0x1f;
+--:-:-:Y:2\tEXIT;
+--:-:-:Y:2\tBRA LBB0;
+--:-:-:Y:2\tNOP;
+"""
+
+
+def test_analyze():
+    mix = analyze(SASS)
+    assert mix.counts["mma"] == 1
+    assert mix.counts["lds"] == 2 and mix.counts["sts"] == 1
+    assert mix.counts["ldg"] == 3 and mix.counts["stg"] == 0
+    assert mix.counts["bar"] == 1 and mix.counts["shfl"] == 1 and mix.counts["cvt"] == 1
+    assert mix.counts["branch"] == 2 and mix.counts["other"] == 1
+    # NOPs are not counted
+    assert mix.num_instructions == 13
+    # @PT is always true
+    assert mix.predicated_loads == 1
+    # STS.128 and LDSM.x4 take 4 wavefronts, LDS.U16 one
+    assert mix.smem_wavefronts == 9
+    total = mix + mix
+    assert total.counts["ldg"] == 6 and total.counts["stg"] == 0
+    assert total.predicated_load_ratio == mix.predicated_load_ratio
+
+
+def test_kernel_instruction_mix():
+    @triton.jit
+    def kernel(X, Y, N, BLOCK: tl.constexpr):
+        offs = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        x = tl.load(X + offs, mask=offs < N)
+        tl.store(Y + offs, x.to(tl.float16), mask=offs < N)
+
+    x = torch.randn(1000, device='cuda')
+    y = torch.empty(1000, device='cuda', dtype=torch.float16)
+    with triton.testing.record_kernels() as kernels:
+        kernel[(4,)](x, y, 1000, BLOCK=256)
+    assert len(kernels) == 1
+    mix = triton.testing.get_instruction_mix(kernels)
+    assert mix.counts["ldg"] > 0 and mix.counts["stg"] > 0 and mix.counts["cvt"] > 0
+    # The loads are masked
+    assert mix.predicated_load_ratio == 1.0
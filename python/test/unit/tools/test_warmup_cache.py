@@ -0,0 +1,42 @@
+import os
+
+import torch
+
+import triton
+import triton.language as tl
+from triton.compiler.compiler import _kernel_cache
+from triton.tools import warmup_cache
+
+
+@triton.jit
+def _scale(X, Y, n, SCALE: tl.constexpr, BLOCK: tl.constexpr):
+    offs = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+    tl.store(Y + offs, tl.load(X + offs, mask=offs < n) * SCALE, mask=offs < n)
+
+
+def test_warmup_cache(tmp_path, monkeypatch):
+    manifest = tmp_path / "kernels.jsonl"
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path / "cache"))
+    monkeypatch.setenv("TRITON_COMPILE_MANIFEST", str(manifest))
+    x = torch.randn(1000, device='cuda')
+    y = torch.empty_like(x)
+    for n, num_warps in [(1000, 4), (1000, 2), (999, 4), (1000, 4)]:
+        _scale[(8,)](x, y, n, SCALE=2., BLOCK=128, num_warps=num_warps)
+    records = warmup_cache.load_manifest(manifest)
+    assert len(records) == 3
+    assert records[0]["kernel"] == f"{__name__}:_scale"
+    assert records[0]["constants"] == {"3": 2., "4": 128}
+    # the kernels are compiled again into an empty cache
+    monkeypatch.delenv("TRITON_COMPILE_MANIFEST")
+    bundle = tmp_path / "cache.tar.gz"
+    _kernel_cache.clear()
+    assert warmup_cache.main([str(manifest), "--cache-dir", str(tmp_path / "warm"), "--bundle", str(bundle)]) == 0
+    assert len(os.listdir(tmp_path / "warm")) >= 3
+    assert bundle.exists()
+    # the kernels served from the warm cache are not compiled
+    _kernel_cache.clear()
+    monkeypatch.setenv("TRITON_COMPILE_TRACE", str(tmp_path / "trace.jsonl"))
+    for record in records:
+        kernel, stale = warmup_cache.compile_record(record)
+        assert not stale
+    assert not (tmp_path / "trace.jsonl").exists()
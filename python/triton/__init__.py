@@ -15,6 +15,7 @@ from .runtime import (
     TensorWrapper,
     OutOfResources,
     MockTensor,
+    ParamTable,
 )
 from .runtime.jit import jit
 from .compiler import compile, CompilationError
@@ -22,6 +23,7 @@ from .debugger.debugger import program_ids_from_grid
 
 from . import language
 from . import testing
+from . import profiler
 
 __all__ = [
     "autotune",
@@ -39,10 +41,12 @@ __all__ = [
     "next_power_of_2",
     "ops",
     "OutOfResources",
+    "ParamTable",
     "reinterpret",
     "runtime",
     "TensorWrapper",
     "testing",
+    "profiler",
     "program_ids_from_grid",
 ]
 
@@ -1,4 +1,4 @@
-from .compiler import CompiledKernel, compile
-from .errors import CompilationError
+from .compiler import CompiledKernel, EstimatedKernel, compile
+from .errors import CompilationError, PerformanceWarning
 
-__all__ = ["compile", "CompiledKernel", "CompilationError"]
+__all__ = ["compile", "CompiledKernel", "EstimatedKernel", "CompilationError", "PerformanceWarning"]
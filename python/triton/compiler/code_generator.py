@@ -1,14 +1,18 @@
 import ast
 import inspect
+import os
 import re
 import sys
+import threading
 import warnings
+from collections import OrderedDict
 from typing import Any, Callable, Dict, Optional, Tuple, Type, Union
 
 from .. import language
 from ..language import constexpr, tensor
 # ideally we wouldn't need any runtime component
 from ..runtime import JITFunction
+from ..runtime.jit import get_current_device, get_device_capability
 from .errors import (CompilationError, CompileTimeAssertionFailure,
                      UnsupportedLanguageConstruct)
 from triton._C.libtriton.triton import ir
@@ -16,7 +20,8 @@ from triton._C.libtriton.triton import ir
 
 def mangle_ty(ty):
     if ty.is_ptr():
-        return 'P' + mangle_ty(ty.element_ty)
+        # the callees taking a parameter table are specialized apart
+        return ('C' if ty.is_param() else 'P') + mangle_ty(ty.element_ty)
     if ty.is_int():
         SIGNED = language.dtype.SIGNEDNESS.SIGNED
         prefix = 'i' if ty.int_signedness == SIGNED else 'u'
@@ -52,6 +57,56 @@ def mangle_fn(name, arg_tys, constants):
     return ret
 
 
+class _CalleeCache:
+    """
+    The TTIR of the @triton.jit functions called by the kernels, generated and
+    canonicalized once per process for their argument types and constexprs,
+    and spliced into the modules of the next specializations that call them
+    instead of being generated again. The entries hold the source of the
+    function and of its callees, and their return types. TRITON_CALLEE_CACHE=0
+    disables it.
+    """
+
+    def __init__(self, max_entries=4096):
+        self.max_entries = max_entries
+        self.entries = OrderedDict()
+        self.lock = threading.Lock()
+
+    @staticmethod
+    def key(fn, fn_name):
+        if os.environ.get("TRITON_CALLEE_CACHE", "1") != "1":
+            return None
+        # the environment variables change the generated code, e.g. of the prints
+        env = tuple(sorted((k, v) for k, v in os.environ.items() if k.startswith("TRITON_")))
+        return (fn.cache_key, fn_name, fn.debug, fn.noinline, env, _CalleeCache.target())
+
+    @staticmethod
+    def target():
+        # The target that the generated code depends on, as read by the
+        # language: the backend, e.g. of the libdevice calls, and on CUDA the
+        # compute capability of the current device, e.g. of the dots
+        import torch
+        if torch.version.hip is not None:
+            return ("hip",)
+        return ("cuda", get_device_capability(get_current_device()))
+
+    def get(self, key):
+        with self.lock:
+            entry = self.entries.get(key)
+            if entry is not None:
+                self.entries.move_to_end(key)
+            return entry
+
+    def put(self, key, entry):
+        with self.lock:
+            self.entries[key] = entry
+            if len(self.entries) > self.max_entries:
+                self.entries.popitem(last=False)
+
+
+_callee_cache = _CalleeCache()
+
+
 def _is_triton_tensor(o: Any) -> bool:
     return isinstance(o, tensor)
 
@@ -89,14 +144,22 @@ class enter_sub_region:
 class CodeGenerator(ast.NodeVisitor):
     def __init__(self, context, prototype, gscope, attributes, constants, function_name,
                  module=None, is_kernel=False, function_types: Optional[Dict] = None,
-                 debug=False, noinline=False):
+                 debug=False, noinline=False, fused_part=None, file_name=None, begin_line=0,
+                 param_tables: Optional[Dict] = None):
         self.builder = ir.builder(context)
+        # the ops are created at the location of the innermost AST node being
+        # visited, in the file of the function starting at `begin_line`
+        self.file_name = file_name
+        self.begin_line = begin_line
+        self.cur_loc = None
         self.module = self.builder.create_module() if module is None else module
         self.function_ret_types = {} if function_types is None else function_types
         self.prototype = prototype
         self.gscope = gscope
         self.lscope = dict()
         self.attributes = attributes
+        # the number of elements of the parameter tables of the kernel
+        self.param_tables = {} if param_tables is None else param_tables
         self.constants = constants
         self.function_name = function_name
         self.is_kernel = is_kernel
@@ -105,6 +168,11 @@ class CodeGenerator(ast.NodeVisitor):
         self.noinline = noinline
         self.scf_stack = []
         self.last_ret_type = None
+        # in a part of a horizontally fused kernel (see runtime/fusion.py):
+        # True when the program ids and grid of the part are the last 6
+        # arguments of the function, False when the function has none of them
+        self.fused_part = fused_part
+        self.program_ids = None
         # SSA-construction
         # name => language.tensor
         self.local_defs: Dict[str, tensor] = {}
@@ -274,9 +342,14 @@ class CodeGenerator(ast.NodeVisitor):
             else:
                 if i in self.attributes:
                     fn.set_arg_attr(idx, "tt.divisibility", self.attributes[i][1])
+                if i in self.param_tables:
+                    fn.set_arg_attr(idx, "tt.param_table", self.param_tables[i])
                 arg_values.append(tensor(fn.args(idx), self.prototype.param_types[idx]))
                 idx += 1
 
+        if self.fused_part:
+            self.program_ids = [tensor(fn.args(idx + i), self.prototype.param_types[idx + i]) for i in range(6)]
+
         insert_pt = self.builder.get_insertion_block()
         for arg_name, arg_value in zip(arg_names, arg_values):
             self.set_value(arg_name, arg_value)
@@ -670,15 +743,21 @@ class CodeGenerator(ast.NodeVisitor):
                     ast.NodeVisitor.generic_visit(self, stmt)
             return
 
-        if IteratorClass is not range:
-            raise RuntimeError('Only `range` and `static_range` iterators are currently supported')
+        unroll = 1
+        if IteratorClass is language.range:
+            iter_kwargs = {kw.arg: self.visit(kw.value) for kw in node.iter.keywords}
+            iterator = IteratorClass(*iter_args, **iter_kwargs)
+            lb, ub, step = iterator.start, iterator.end, iterator.step
+            unroll = iterator.unroll
+        elif IteratorClass is range:
+            # visit iterator arguments
+            # collect lower bound (lb), upper bound (ub), and step
+            lb = iter_args[0] if len(iter_args) > 1 else self.visit(ast.Num(0))
+            ub = iter_args[1] if len(iter_args) > 1 else self.visit(node.iter.args[0])
+            step = iter_args[2] if len(iter_args) > 2 else self.visit(ast.Num(1))
+        else:
+            raise RuntimeError('Only `range`, `tl.range` and `static_range` iterators are currently supported')
 
-        # visit iterator arguments
-        # note: only `range` iterator is supported now
-        # collect lower bound (lb), upper bound (ub), and step
-        lb = iter_args[0] if len(iter_args) > 1 else self.visit(ast.Num(0))
-        ub = iter_args[1] if len(iter_args) > 1 else self.visit(node.iter.args[0])
-        step = iter_args[2] if len(iter_args) > 2 else self.visit(ast.Num(1))
         # handle negative constant step (not supported by scf.for in MLIR)
         negative_step = False
         if _is_constexpr(step) and step.value < 0:
@@ -739,6 +818,9 @@ class CodeGenerator(ast.NodeVisitor):
             # create ForOp
             self.builder.restore_insertion_point(ip)
             for_op = self.builder.create_for_op(lb, ub, step, [arg.handle for arg in init_args])
+            if unroll > 1:
+                # unrolled by the tritongpu-loop-unroll pass, before pipelining
+                for_op.set_attr("tt.num_unroll", self.builder.get_int32_attr(unroll))
 
             self.scf_stack.append(node)
             self.builder.set_insertion_point_to_start(for_op.get_body(0))
@@ -794,7 +876,7 @@ class CodeGenerator(ast.NodeVisitor):
         # Convert assert to triton's device_assert which happens on the device
         return language.core.device_assert(test, msg, _builder=self.builder)
 
-    def call_JitFunction(self, fn: JITFunction, args, kwargs):
+    def call_JitFunction(self, fn: JITFunction, args, kwargs, program_ids=None):
         args = inspect.getcallargs(fn.fn, *args, **kwargs)
         args = [args[name] for name in fn.arg_names]
         args = [arg if _is_triton_tensor(arg)
@@ -808,14 +890,40 @@ class CodeGenerator(ast.NodeVisitor):
         arg_vals = [arg.handle for arg in args if arg is not None]
         arg_types = [arg.type for arg in args if arg is not None]
         fn_name = mangle_fn(fn.__name__, arg_types, constants)
+        # the callees of a part of a fused kernel get the program ids of the
+        # part as extra arguments, as they may read them themselves or through
+        # their own callees
+        fused_part = None
+        if program_ids is None and self.fused_part is not None:
+            program_ids = self.program_ids
+            fused_part = program_ids is not None
+        elif program_ids is not None:
+            fused_part = True
+        if fused_part is not None:
+            fn_name += '__pids' if fused_part else '__part'
+        if fused_part:
+            arg_vals += [pid.handle for pid in program_ids]
+            arg_types += [pid.type for pid in program_ids]
         # generate function def if necessary
+        cache_key = None
+        if not self.module.has_function(fn_name):
+            cache_key = _callee_cache.key(fn, fn_name)
+            cached = _callee_cache.get(cache_key) if cache_key is not None else None
+            if cached is not None:
+                src, ret_types = cached
+                self.module.splice_functions(src)
+                self.function_ret_types.update(ret_types)
         if not self.module.has_function(fn_name):
             prototype = language.function_type([], arg_types)
             gscope = sys.modules[fn.fn.__module__].__dict__
-            generator = CodeGenerator(self.builder.context, prototype, gscope, attributes, constants, module=self.module, function_name=fn_name, function_types=self.function_ret_types, debug=fn.debug, noinline=fn.noinline)
+            generator = CodeGenerator(self.builder.context, prototype, gscope, attributes, constants, module=self.module, function_name=fn_name, function_types=self.function_ret_types, debug=fn.debug, noinline=fn.noinline, fused_part=fused_part,
+                                      file_name=fn.file_name, begin_line=fn.starting_line_number)
             generator.visit(fn.parse())
             callee_ret_type = generator.last_ret_type
             self.function_ret_types[fn_name] = callee_ret_type
+            if cache_key is not None:
+                src, names = self.module.extract_functions(fn_name)
+                _callee_cache.put(cache_key, (src, {name: self.function_ret_types[name] for name in names}))
         else:
             callee_ret_type = self.function_ret_types[fn_name]
         symbol = self.module.get_function(fn_name)
@@ -845,6 +953,12 @@ class CodeGenerator(ast.NodeVisitor):
                 return
         if isinstance(fn, JITFunction):
             return self.call_JitFunction(fn, args, kws)
+        if fn in (language.program_id, language.num_programs) and self.fused_part is not None:
+            if self.program_ids is None:
+                raise UnsupportedLanguageConstruct(None, node, f"{fn.__name__} in a fused kernel only reaches the functions whose callers read the program ids too; "
+                                                   "pass them as arguments")
+            axis = _unwrap_if_constexpr(args[0] if args else kws['axis'])
+            return self.program_ids[axis if fn is language.program_id else 3 + axis]
         if (hasattr(fn, '__self__') and _is_triton_tensor(fn.__self__)) or language.core.is_builtin(fn):
             extra_kwargs = dict(_builder=self.builder)
             sig = inspect.signature(fn)
@@ -908,15 +1022,30 @@ class CodeGenerator(ast.NodeVisitor):
                 raise AssertionError("encountered unexpected node of type {} in a JoinedStr node".format(type(value)))
         return ''.join(values)
 
+    def _set_loc(self, loc):
+        if loc == self.cur_loc:
+            return
+        self.cur_loc = loc
+        if loc is None:
+            self.builder.set_unknown_loc()
+        else:
+            self.builder.set_loc(*loc)
+
     def visit(self, node):
         if node is not None:
             self.last_node = node
-        with warnings.catch_warnings():
-            # The ast library added visit_Constant and deprecated some other
-            # methods but we can't move to that without breaking Python 3.6 and 3.7.
-            warnings.simplefilter("ignore", DeprecationWarning)  # python 3.9
-            warnings.simplefilter("ignore", PendingDeprecationWarning)  # python 3.8
-            return super().visit(node)
+        last_loc = self.cur_loc
+        if self.file_name is not None and hasattr(node, "lineno"):
+            self._set_loc((self.file_name, self.begin_line + node.lineno - 1, node.col_offset))
+        try:
+            with warnings.catch_warnings():
+                # The ast library added visit_Constant and deprecated some other
+                # methods but we can't move to that without breaking Python 3.6 and 3.7.
+                warnings.simplefilter("ignore", DeprecationWarning)  # python 3.9
+                warnings.simplefilter("ignore", PendingDeprecationWarning)  # python 3.8
+                return super().visit(node)
+        finally:
+            self._set_loc(last_loc)
 
     def generic_visit(self, node):
         raise UnsupportedLanguageConstruct(None, node, "unsupported AST node type: {}".format(type(node).__name__))
@@ -954,10 +1083,20 @@ class CodeGenerator(ast.NodeVisitor):
     }
 
 
+def param_table_size(name):
+    # the number of elements of a parameter table "[Nxty]", None for the other types
+    if name[0] != "[":
+        return None
+    return int(name[1:].split("x", 1)[0])
+
+
 def str_to_ty(name):
     if name[0] == "*":
         ty = str_to_ty(name[1:])
         return language.pointer_type(ty)
+    if name[0] == "[":
+        ty = str_to_ty(name[1:-1].split("x", 1)[1])
+        return language.pointer_type(ty, language.core.PARAM_ADDRESS_SPACE)
     tys = {
         "fp8e5": language.float8e5,
         "fp8e4": language.float8e4,
@@ -992,12 +1131,13 @@ def kernel_suffix(signature, specialization):
     return suffix
 
 
-def ast_to_ttir(fn, signature, specialization, constants, debug):
+def ast_to_ttir(fn, signature, specialization, constants, debug, context=None):
     # canonicalize signature
     if isinstance(signature, str):
         signature = {k: v.strip() for k, v in enumerate(signature.split(","))}
-    context = ir.context()
-    context.load_triton()
+    if context is None:
+        context = ir.context()
+        context.load_triton()
     # create kernel prototype
     cst_key = lambda i: fn.arg_names.index(i) if isinstance(i, str) else i
     constants = {cst_key(key): value for key, value in constants.items()}
@@ -1010,11 +1150,13 @@ def ast_to_ttir(fn, signature, specialization, constants, debug):
     all_constants = constants.copy()
     all_constants.update(new_constants)
     arg_types = [str_to_ty(v) for k, v in signature.items() if k not in constants]
+    param_tables = {k: param_table_size(v) for k, v in signature.items() if param_table_size(v) is not None}
 
     prototype = language.function_type([], arg_types)
     generator = CodeGenerator(context, prototype, gscope=gscope, constants=all_constants,
                               function_name=function_name, attributes=new_attrs,
-                              is_kernel=True, debug=debug)
+                              param_tables=param_tables, is_kernel=True, debug=debug, file_name=fn.file_name,
+                              begin_line=fn.starting_line_number)
     try:
         generator.visit(fn.parse())
     except CompilationError as e:
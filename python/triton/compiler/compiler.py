@@ -7,83 +7,148 @@ import os
 import re
 import subprocess
 import tempfile
-from collections import namedtuple
+import threading
+import time
+import warnings
+from collections import OrderedDict, namedtuple
 from pathlib import Path
 from typing import Any, Tuple
 
 import triton
 import triton._C.libtriton.triton as _triton
-from ..runtime import driver
+from ..runtime import driver, print_buffer
 # TODO: runtime.errors
 from ..runtime.autotuner import OutOfResources
 from ..runtime.cache import get_cache_manager
+from ..runtime.occupancy import occupancy
 from ..tools.disasm import extract
+from ..tools.instruction_mix import analyze
 from .code_generator import ast_to_ttir
+from .errors import PerformanceWarning
 from .make_launcher import make_stub
 
 
-def inline_triton_ir(mod):
-    pm = _triton.ir.pass_manager(mod.context)
-    pm.enable_debug()
-    pm.add_inliner_pass()
+# The times of the MLIR passes run by the thread, by pass name, while compile()
+# runs a stage
+_pass_times = threading.local()
+
+
+def _get_pass_manager(mod, *key):
+    '''
+    Returns the pass manager of the pipeline configured by `key` for the context
+    of `mod`, its timer and whether its passes remain to be added. The contexts
+    pooled by compile() keep their pipelines across compilations.
+    '''
+    return _triton.ir.pass_manager.get(mod.context, "-".join(str(k) for k in key))
+
+
+def _run_passes(pm, timer, mod):
+    times = getattr(_pass_times, "times", None)
+    timer.reset()
     pm.run(mod)
+    if times is not None:
+        for name, seconds in timer.get_times().items():
+            times[name] = times.get(name, 0.0) + seconds
+
+
+def inline_triton_ir(mod):
+    pm, timer, is_new = _get_pass_manager(mod, "inline")
+    if is_new:
+        pm.enable_debug()
+        pm.add_inliner_pass()
+    _run_passes(pm, timer, mod)
     return mod
 
 
 def ttir_compute_capability_rewrite(mod, arch):
-    # For hardware without support, we must rewrite all load/store
-    # with block (tensor) pointers into tensors of pointers
-    pm = _triton.ir.pass_manager(mod.context)
-    pm.enable_debug()
-    if _is_cuda(arch):
-        pm.add_rewrite_tensor_pointer_pass(arch)
-    pm.run(mod)
+    # Block (tensor) pointers are kept through TTGIR and lowered to base and
+    # offset address computations. TRITON_EXPAND_BLOCK_POINTERS=1 rewrites
+    # their loads and stores into tensors of pointers instead
+    expand = _is_cuda(arch) and os.environ.get("TRITON_EXPAND_BLOCK_POINTERS", "0") == "1"
+    pm, timer, is_new = _get_pass_manager(mod, "rewrite", arch if expand else None)
+    if is_new:
+        pm.enable_debug()
+        if expand:
+            pm.add_rewrite_tensor_pointer_pass(arch)
+    _run_passes(pm, timer, mod)
     return mod
 
 
 def optimize_ttir(mod, arch):
     mod = inline_triton_ir(mod)
     mod = ttir_compute_capability_rewrite(mod, arch)
-    pm = _triton.ir.pass_manager(mod.context)
-    pm.enable_debug()
-    pm.add_inliner_pass()
-    pm.add_triton_combine_pass()
-    pm.add_canonicalizer_pass()
-    pm.add_cse_pass()
-    pm.add_licm_pass()
-    pm.add_symbol_dce_pass()
-    pm.run(mod)
+    # TRITON_STREAMING_STORES=1 marks the stores to the memory that a kernel
+    # never reads as streaming, so that the outputs do not evict the inputs
+    streaming = _is_cuda(arch) and os.environ.get("TRITON_STREAMING_STORES", "0") == "1"
+    pm, timer, is_new = _get_pass_manager(mod, "ttir", "streaming" if streaming else "")
+    if is_new:
+        pm.enable_debug()
+        pm.add_inliner_pass()
+        pm.add_triton_combine_pass()
+        pm.add_canonicalizer_pass()
+        pm.add_cse_pass()
+        pm.add_licm_pass()
+        pm.add_triton_rebase_loop_pointers_pass()
+        pm.add_triton_specialize_calls_pass()
+        pm.add_symbol_dce_pass()
+        if streaming:
+            pm.add_triton_mark_streaming_stores_pass()
+    _run_passes(pm, timer, mod)
     return mod
 
 
-def ttir_to_ttgir(mod, num_warps):
-    pm = _triton.ir.pass_manager(mod.context)
-    pm.add_convert_triton_to_tritongpu_pass(num_warps)
-    pm.run(mod)
+def ttir_to_ttgir(mod, num_warps, threads_per_warp=32, auto_num_warps=False):
+    pm, timer, is_new = _get_pass_manager(mod, "ttir-to-ttgir", num_warps, threads_per_warp, auto_num_warps)
+    if is_new:
+        pm.add_convert_triton_to_tritongpu_pass(num_warps, threads_per_warp, auto_num_warps)
+    _run_passes(pm, timer, mod)
     return mod
 
 
 def optimize_ttgir(mod, num_stages, arch):
-    pm = _triton.ir.pass_manager(mod.context)
-    pm.enable_debug()
-    pm.add_tritongpu_coalesce_pass()
-    pm.add_tritongpu_remove_layout_conversions_pass()
-    if isinstance(arch, int):
-        pm.add_tritongpu_accelerate_matmul_pass(arch)
-    pm.add_tritongpu_remove_layout_conversions_pass()
-    pm.add_tritongpu_optimize_dot_operands_pass()
-    pm.add_tritongpu_pipeline_pass(num_stages)
-    pm.add_tritongpu_prefetch_pass()
-    pm.add_tritongpu_optimize_dot_operands_pass()
-    pm.add_tritongpu_remove_layout_conversions_pass()
-    pm.add_tritongpu_decompose_conversions_pass()
-    pm.add_tritongpu_reorder_instructions_pass()
-    pm.add_cse_pass()
-    pm.add_symbol_dce_pass()
-    pm.run(mod)
+    # TRITON_LAYOUT_COST_MODEL=1 removes layout conversions by minimizing their
+    # shared memory cost before applying the heuristic patterns
+    cost_model = os.environ.get("TRITON_LAYOUT_COST_MODEL", "0") == "1"
+    pm, timer, is_new = _get_pass_manager(mod, "ttgir", num_stages, arch, cost_model)
+    if is_new:
+        pm.enable_debug()
+        pm.add_tritongpu_coalesce_pass()
+        pm.add_tritongpu_remove_layout_conversions_pass(cost_model)
+        if isinstance(arch, int):
+            pm.add_tritongpu_accelerate_matmul_pass(arch)
+        pm.add_tritongpu_remove_layout_conversions_pass(cost_model)
+        # Stores of the MMA accumulators may skip their conversion
+        pm.add_tritongpu_coalesce_pass()
+        pm.add_tritongpu_remove_layout_conversions_pass(cost_model)
+        pm.add_tritongpu_optimize_dot_operands_pass()
+        pm.add_tritongpu_loop_unroll_pass()
+        pm.add_tritongpu_pipeline_pass(num_stages)
+        pm.add_tritongpu_prefetch_pass()
+        pm.add_tritongpu_optimize_dot_operands_pass()
+        pm.add_tritongpu_remove_layout_conversions_pass(cost_model)
+        pm.add_tritongpu_decompose_conversions_pass()
+        pm.add_tritongpu_reorder_instructions_pass()
+        pm.add_cse_pass()
+        pm.add_symbol_dce_pass()
+    _run_passes(pm, timer, mod)
     return mod
 
 
+def ttir_to_ttgir_within_shared(mod, num_warps, num_stages, arch, max_shared, metadata, threads_per_warp=32,
+                                auto_num_warps=False):
+    # Lowers with the largest stage count up to `num_stages` whose shared
+    # memory, as computed by the allocation analysis, fits in `max_shared`
+    # bytes. The stage count is recorded in the metadata
+    for stages in range(num_stages, 0, -1):
+        clone = mod.clone()
+        clone.context = mod.context
+        ttgir = optimize_ttgir(ttir_to_ttgir(clone, num_warps, threads_per_warp, auto_num_warps), stages, arch)
+        if stages == 1 or _triton.get_allocation_size(ttgir) <= max_shared:
+            break
+    metadata["num_stages"] = stages
+    return ttgir
+
+
 def _add_external_libs(mod, libs):
     for name, path in libs.items():
         if len(name) == 0 or len(path) == 0:
@@ -91,14 +156,14 @@ def _add_external_libs(mod, libs):
     _triton.add_external_libs(mod, list(libs.keys()), list(libs.values()))
 
 
-def ttgir_to_llir(mod, extern_libs, arch):
+def ttgir_to_llir(mod, extern_libs, arch, fast_math=False, opt_level=3, use_print_buffer=False):
     if extern_libs:
         _add_external_libs(mod, extern_libs)
     # TODO: separate tritongpu_to_llvmir for different backends
     if _is_cuda(arch):
-        return _triton.translate_triton_gpu_to_llvmir(mod, arch, False)
+        return _triton.translate_triton_gpu_to_llvmir(mod, arch, False, fast_math, opt_level, use_print_buffer)
     else:
-        return _triton.translate_triton_gpu_to_llvmir(mod, 0, True)
+        return _triton.translate_triton_gpu_to_llvmir(mod, 0, True, fast_math, opt_level, use_print_buffer)
 
 
 # PTX translation
@@ -137,16 +202,31 @@ def path_to_ptxas():
     raise RuntimeError("Cannot find ptxas")
 
 
-def llir_to_ptx(mod: Any, arch: int, ptx_version: int = None) -> str:
+def use_nvptxcompiler():
+    '''
+    Whether PTX is compiled in-process by the nvPTXCompiler library linked into
+    libtriton. An explicit TRITON_PTXAS_PATH selects the ptxas binary instead.
+    '''
+    return _triton.has_nvptxcompiler() and not os.environ.get("TRITON_PTXAS_PATH")
+
+
+def llir_to_ptx(mod: Any, arch: int, ptx_version: int = None, opt_level: int = 3,
+                maxnreg: int = None, min_blocks_per_sm: int = None) -> str:
     '''
     Translate TritonGPU module to PTX code.
     :param mod: a TritonGPU dialect module
+    :param opt_level: optimization level of the code generator (0-3)
+    :param maxnreg: maximum number of registers per thread of the kernel
+    :param min_blocks_per_sm: minimum number of blocks that must fit on a multiprocessor
     :return: PTX code
     '''
     if ptx_version is None:
-        _, cuda_version = path_to_ptxas()
+        if use_nvptxcompiler():
+            cuda_version = _triton.get_nvptxcompiler_version()
+        else:
+            _, cuda_version = path_to_ptxas()
         ptx_version = ptx_get_version(cuda_version)
-    return _triton.translate_llvmir_to_ptx(mod, arch, ptx_version)
+    return _triton.translate_llvmir_to_ptx(mod, arch, ptx_version, opt_level, maxnreg or 0, min_blocks_per_sm or 0)
 
 
 def ptx_to_cubin(ptx: str, arch: int):
@@ -156,6 +236,8 @@ def ptx_to_cubin(ptx: str, arch: int):
     :param compute_capability: compute capability
     :return: str
     '''
+    if use_nvptxcompiler():
+        return _triton.compile_ptx_to_cubin_in_process(ptx, arch)
     ptxas, _ = path_to_ptxas()
     return _triton.compile_ptx_to_cubin(ptx, ptxas, arch)
 
@@ -221,7 +303,7 @@ def llir_to_amdgcn_and_hsaco(mod: Any, gfx_arch: str, gfx_triple: str, gfx_featu
     :param mod: a TritonGPU dialect module
     :return:
         - AMDGCN code
-        - Path to HSACO object
+        - HSACO code object
     '''
     return _triton.translate_llvmir_to_hsaco(mod, gfx_arch, gfx_triple, gfx_features)
 
@@ -254,13 +336,58 @@ def make_hash(fn, arch, **kwargs):
         configs = kwargs["configs"]
         signature = kwargs["signature"]
         constants = kwargs.get("constants", dict())
+        # the @triton.jit functions passed as constexprs are keyed by source
+        constants = {k: v.cache_key if isinstance(v, triton.runtime.JITFunction) else v for k, v in constants.items()}
         num_warps = kwargs.get("num_warps", 4)
+        threads_per_warp = kwargs.get("threads_per_warp", None)
         num_stages = kwargs.get("num_stages", 3)
         debug = kwargs.get("debug", False)
+        fast_math = kwargs.get("fast_math", False)
+        max_shared = kwargs.get("max_shared", None)
+        opt_level = kwargs.get("opt_level", 3)
+        maxnreg = kwargs.get("maxnreg", None)
+        min_blocks_per_sm = kwargs.get("min_blocks_per_sm", None)
+        auto_num_warps = kwargs.get("auto_num_warps", False)
         # Get unique key for the compiled code
         get_conf_key = lambda conf: (sorted(conf.divisible_by_16), sorted(conf.equal_to_1))
         configs_key = [get_conf_key(conf) for conf in configs]
         key = f"{fn.cache_key}-{''.join(signature.values())}-{configs_key}-{constants}-{num_warps}-{num_stages}-{debug}-{arch}"
+        if fast_math:
+            key += "-fast-math"
+        if max_shared is not None:
+            key += f"-max-shared-{max_shared}"
+        if opt_level != 3:
+            key += f"-O{opt_level}"
+        if maxnreg:
+            key += f"-maxnreg-{maxnreg}"
+        if min_blocks_per_sm:
+            key += f"-min-blocks-{min_blocks_per_sm}"
+        if threads_per_warp is not None:
+            key += f"-threads-per-warp-{threads_per_warp}"
+        if auto_num_warps:
+            key += "-auto-num-warps"
+        fatbin_archs = get_fatbin_archs(kwargs)
+        if fatbin_archs:
+            key += f"-fatbin-{'-'.join(map(str, fatbin_archs))}"
+        # The lint only adds its remarks to the metadata
+        if kwargs.get("perf_lint", False) or os.environ.get("TRITON_PERF_LINT", "0") == "1":
+            key += "-perf-lint"
+        # The shared memory allocator changes the generated code
+        smem_allocator = os.environ.get("TRITON_SMEM_ALLOCATOR", "")
+        if smem_allocator:
+            key += f"-{smem_allocator}"
+        # So do the layout cost model and swizzled layout conversions
+        if os.environ.get("TRITON_LAYOUT_COST_MODEL", "0") == "1":
+            key += "-layout-cost"
+        if os.environ.get("TRITON_SWIZZLE_CVT_LAYOUT", "0") == "1":
+            key += "-swizzle-cvt"
+        if os.environ.get("TRITON_EXPAND_BLOCK_POINTERS", "0") == "1":
+            key += "-expand-block-ptr"
+        if os.environ.get("TRITON_STREAMING_STORES", "0") == "1":
+            key += "-streaming-stores"
+        # tl.device_print appends binary records to the print buffer
+        if print_buffer.enabled():
+            key += "-print-buffer"
         return hashlib.md5(key.encode("utf-8")).hexdigest()
     assert isinstance(fn, str)
     return hashlib.md5((Path(fn).read_text() + triton.runtime.jit.version_key()).encode("utf-8")).hexdigest()
@@ -290,6 +417,7 @@ arg_type_pattern = {
 }
 
 ttgir_num_warps_pattern = r'"triton_gpu.num-warps"\s?=\s?(\d+)\s?:'
+ttgir_threads_per_warp_pattern = r'"triton_gpu.threads-per-warp"\s?=\s?(\d+)\s?:'
 
 
 def _get_jsonable_constants(constants):
@@ -321,6 +449,17 @@ def _is_cuda(arch):
     return isinstance(arch, int)
 
 
+def get_fatbin_archs(kwargs):
+    """
+    The sorted compute capabilities of the fat binary requested by the
+    :code:`fatbin_archs` option of compile() or by TRITON_FATBIN_ARCHS.
+    """
+    archs = kwargs.get("fatbin_archs", None)
+    if archs is None:
+        archs = [arch for arch in os.environ.get("TRITON_FATBIN_ARCHS", "").split(",") if arch.strip()]
+    return sorted(set(int(arch) for arch in archs))
+
+
 def get_architecture_descriptor(capability):
     try:
         import torch
@@ -353,37 +492,211 @@ def add_rocm_stages(arch, extern_libs, stages):
                                                              gfx_arch_full_details[2]))
 
 
-def add_cuda_stages(arch, extern_libs, stages):
+def add_cuda_stages(arch, extern_libs, stages, opt_level=3, maxnreg=None, min_blocks_per_sm=None):
 
     stages["ptx"] = (lambda path: Path(path).read_text(),
-                     lambda src: llir_to_ptx(src, arch))
+                     lambda src: llir_to_ptx(src, arch, opt_level=opt_level, maxnreg=maxnreg,
+                                             min_blocks_per_sm=min_blocks_per_sm))
     stages["cubin"] = (lambda path: Path(path).read_bytes(),
                        lambda src: ptx_to_cubin(src, arch))
 
 
+class _LazyAsm(dict):
+    """
+    asm dict whose entries are read from the cache on first access
+    """
+
+    def __init__(self, paths):
+        super().__init__()
+        # ir -> (path, reader)
+        self._paths = paths
+
+    def __missing__(self, ir):
+        if ir not in self._paths:
+            raise KeyError(ir)
+        path, read = self._paths.pop(ir)
+        self[ir] = read(path)
+        return self[ir]
+
+    def __contains__(self, ir):
+        return super().__contains__(ir) or ir in self._paths
+
+    def get(self, ir, default=None):
+        return self[ir] if ir in self else default
+
+
+# Kernels compiled or loaded by this process: hash -> (metadata, asm)
+_kernel_cache = dict()
+
+
+def _load_cached_asm(fn, name, stage_names, metadata_group, optional=()):
+    # Only the final binary is needed to launch the kernel: the intermediate
+    # IRs are read if and when they are accessed. The `optional` ones may be
+    # missing from the cache.
+    paths = dict()
+    for ir in stage_names:
+        if ir == "ast":
+            continue
+        ir_filenames = {ir: f"{name}.{ir}"}
+        if ir == "amdgcn":
+            ir_filenames["hsaco"] = f"{name}.hsaco"
+        for key, ir_filename in ir_filenames.items():
+            path = metadata_group.get(ir_filename)
+            if path is None and ir in optional:
+                continue
+            if path is None:
+                return None
+            binary = key.startswith("cubin") or key == "hsaco"
+            read = (lambda path: Path(path).read_bytes()) if binary else (lambda path: Path(path).read_text())
+            paths[key] = (path, read)
+    asm = _LazyAsm(paths)
+    asm["ast"] = str(fn)
+    return asm
+
+
+# The environment variables that change the generated code, see make_hash
+CODEGEN_ENV_VARS = ("TRITON_SMEM_ALLOCATOR", "TRITON_LAYOUT_COST_MODEL", "TRITON_SWIZZLE_CVT_LAYOUT",
+                    "TRITON_EXPAND_BLOCK_POINTERS", "TRITON_STREAMING_STORES", "TRITON_PRINT_BUFFER",
+                    "TRITON_FATBIN_ARCHS")
+
+# The compilations already written to the TRITON_COMPILE_MANIFEST file
+_recorded_compilations = set()
+_recorded_compilations_lock = threading.Lock()
+
+
+def _record_compilation(path, fn, kwargs):
+    # Appends the arguments of a compilation of a @triton.jit function to a
+    # JSON lines file, once per process, for triton.tools.warmup_cache to
+    # replay them
+    def jit_name(f):
+        return f"{f.fn.__module__}:{f.fn.__qualname__}"
+    constants = {str(k): {"jit": jit_name(v)} if isinstance(v, triton.runtime.JITFunction) else v
+                 for k, v in kwargs.get("constants", dict()).items()}
+    configs = kwargs.get("configs", None) or [instance_descriptor()]
+    max_shared = kwargs.get("max_shared", None)
+    if max_shared is None and kwargs.get("auto_num_stages", False):
+        device = kwargs.get("device", None)
+        if device is None:
+            device = triton.runtime.jit.get_current_device()
+        max_shared = driver.utils.get_device_properties(device)["max_shared_mem"]
+    signature = kwargs["signature"]
+    if isinstance(signature, str):
+        signature = {k: v.strip() for k, v in enumerate(signature.split(","))}
+    options = {name: kwargs[name] for name in ("num_warps", "num_stages", "extern_libs", "debug", "fast_math",
+                                               "opt_level", "maxnreg", "min_blocks_per_sm", "auto_num_stages",
+                                               "threads_per_warp", "auto_num_warps", "fatbin_archs")
+               if name in kwargs}
+    record = {"kernel": jit_name(fn), "cache_key": hashlib.md5(fn.cache_key.encode("utf-8")).hexdigest(),
+              "cc": get_architecture_descriptor(kwargs.get("cc", None)),
+              "signature": {str(k): v for k, v in signature.items()}, "constants": constants,
+              "divisible_by_16": sorted(configs[0].divisible_by_16), "equal_to_1": sorted(configs[0].equal_to_1),
+              "max_shared": max_shared, "options": options,
+              "env": {name: os.environ[name] for name in CODEGEN_ENV_VARS if name in os.environ}}
+    try:
+        line = json.dumps(record, sort_keys=True)
+    except TypeError:
+        # constants that are not JSON values cannot be replayed
+        return
+    with _recorded_compilations_lock:
+        if (path, line) in _recorded_compilations:
+            return
+        _recorded_compilations.add((path, line))
+        with open(path, "a") as f:
+            f.write(line + "\n")
+
+
 def compile(fn, **kwargs):
+    # The contexts are pooled: creating one and loading its dialects is a
+    # measurable share of the time of compiling a small kernel
+    context = _triton.ir.acquire_context()
+    try:
+        kernel = _compile(fn, context, **kwargs)
+    finally:
+        _triton.ir.release_context(context)
+    # TRITON_COMPILE_MANIFEST records the compilations of the @triton.jit
+    # functions, including the ones served by the caches
+    manifest_path = os.environ.get("TRITON_COMPILE_MANIFEST", "")
+    if manifest_path and isinstance(fn, triton.runtime.JITFunction) and kwargs.get("target", None) is None:
+        _record_compilation(manifest_path, fn, kwargs)
+    return kernel
+
+
+def _compile(fn, context, **kwargs):
     arch = get_architecture_descriptor(kwargs.get("cc", None))
     is_cuda = _is_cuda(arch)
-    context = _triton.ir.context()
+    # With fatbin_archs (or TRITON_FATBIN_ARCHS, e.g. "80,86,89,90"), the
+    # kernel is compiled for the lowest of the archs and its PTX is assembled
+    # for each of them: the kernel loads the cubin that best matches its
+    # device, and newer devices compile the PTX in the driver. The code of
+    # the newer archs is scheduled for them but uses no feature they add.
+    fatbin_archs = get_fatbin_archs(kwargs) if is_cuda else []
+    if fatbin_archs:
+        arch = fatbin_archs[0]
     asm = dict()
     constants = kwargs.get("constants", dict())
     num_warps = kwargs.get("num_warps", 4)
+    # The lanes of a warp that the layouts are built for: the wavefronts of
+    # AMD GPUs hold 64 threads, or 32 on the wave32 ones
+    threads_per_warp = kwargs.get("threads_per_warp", 32 if is_cuda else 64)
+    assert threads_per_warp == 32 or (not is_cuda and threads_per_warp == 64), \
+        "threads_per_warp must be 32 on NVIDIA GPUs and 32 or 64 on AMD GPUs"
+    # With auto_num_warps, num_warps is an upper bound: the kernels whose
+    # tensors are smaller than num_warps warps, e.g. of bias adds and per-row
+    # scalars, keep the warps that own elements and launch with fewer threads
+    auto_num_warps = kwargs.get("auto_num_warps", False)
     num_stages = kwargs.get("num_stages", 3 if is_cuda and arch >= 75 else 2)
     extern_libs = kwargs.get("extern_libs", dict())
     if extern_libs is None:
         extern_libs = dict()
     debug = kwargs.get("debug", False)
+    fast_math = kwargs.get("fast_math", False)
+    # The optimization level (0-3) of the LLVM IR and of the PTX code generator,
+    # e.g. 1 to compile the candidates of an autotuner faster
+    opt_level = kwargs.get("opt_level", 3)
+    assert opt_level in range(4), "opt_level must be in [0, 3]"
+    # The launch bounds of the kernel: ptxas keeps the registers per thread
+    # under maxnreg and fits at least min_blocks_per_sm blocks on a
+    # multiprocessor, spilling if needed. See triton.runtime.occupancy.
+    maxnreg = kwargs.get("maxnreg", None)
+    min_blocks_per_sm = kwargs.get("min_blocks_per_sm", None)
+    # With perf_lint (or TRITON_PERF_LINT=1), the remarks of the performance
+    # lint of the TritonGPU IR, e.g. on the accesses that are not vectorized
+    # and the loops that are not pipelined, are warned about and recorded in
+    # the metadata
+    perf_lint = kwargs.get("perf_lint", False) or os.environ.get("TRITON_PERF_LINT", "0") == "1"
+    # With TRITON_PRINT_BUFFER, tl.device_print appends to the print buffer
+    use_print_buffer = print_buffer.enabled()
+    # With a target stage, only the stages up to it run and compile() returns
+    # the resource estimates of an EstimatedKernel, without code generation
+    target = kwargs.get("target", None)
+    assert target in (None, "ttgir", "llir"), "target must be 'ttgir' or 'llir'"
+    # With auto_num_stages, num_stages is an upper bound on the stage count and
+    # the compiler picks the largest one that fits the shared memory of the
+    # device (or max_shared bytes)
+    max_shared = kwargs.get("max_shared", None)
+    if max_shared is None and kwargs.get("auto_num_stages", False):
+        device = kwargs.get("device", None)
+        if device is None:
+            device = triton.runtime.jit.get_current_device()
+        max_shared = driver.utils.get_device_properties(device)["max_shared_mem"]
+        kwargs["max_shared"] = max_shared
     # build compilation stages
     stages = dict()
     stages["ast"] = (lambda path: fn, None)
     stages["ttir"] = (lambda path: parse_mlir_module(path, context),
-                      lambda src: optimize_ttir(ast_to_ttir(src, signature, configs[0], constants, debug=debug), arch))
-    stages["ttgir"] = (lambda path: parse_mlir_module(path, context),
-                       lambda src: optimize_ttgir(ttir_to_ttgir(src, num_warps), num_stages, arch))
+                      lambda src: optimize_ttir(ast_to_ttir(src, signature, configs[0], constants, debug=debug, context=context), arch))
+    if max_shared is None:
+        stages["ttgir"] = (lambda path: parse_mlir_module(path, context),
+                           lambda src: optimize_ttgir(ttir_to_ttgir(src, num_warps, threads_per_warp, auto_num_warps),
+                                                      num_stages, arch))
+    else:
+        stages["ttgir"] = (lambda path: parse_mlir_module(path, context),
+                           lambda src: ttir_to_ttgir_within_shared(src, num_warps, num_stages, arch, max_shared,
+                                                                  metadata, threads_per_warp, auto_num_warps))
     stages["llir"] = (lambda path: Path(path).read_text(),
-                      lambda src: ttgir_to_llir(src, extern_libs, arch))
+                      lambda src: ttgir_to_llir(src, extern_libs, arch, fast_math, opt_level, use_print_buffer))
     if is_cuda:
-        add_cuda_stages(arch, extern_libs, stages)
+        add_cuda_stages(arch, extern_libs, stages, opt_level, maxnreg, min_blocks_per_sm)
     else:
         add_rocm_stages(arch, extern_libs, stages)
 
@@ -413,14 +726,21 @@ def compile(fn, **kwargs):
             assert len(num_warps_matches) == 1, "Expected exactly one match for num_warps"
             assert "num_warps" not in kwargs or int(num_warps_matches[0]) == num_warps, "num_warps in ttgir does not match num_warps in compile"
             num_warps = int(num_warps_matches[0])
+            threads_per_warp_matches = re.findall(ttgir_threads_per_warp_pattern, src)
+            if threads_per_warp_matches:
+                threads_per_warp = int(threads_per_warp_matches[0])
         param_tys = [convert_type_repr(ty) for ty in types]
         signature = {k: v for k, v in enumerate(param_tys)}
         first_stage = list(stages.keys()).index(ir)
 
     # cache manager
-    so_path = make_stub(name, signature, constants)
+    so_path = make_stub(name, signature, constants, threads_per_warp) if target is None else None
+    kernel_hash = make_hash(fn, arch, **kwargs)
+    if kernel_hash in _kernel_cache and target is None:
+        metadata, asm = _kernel_cache[kernel_hash]
+        return CompiledKernel(fn, so_path, metadata, asm)
     # create cache manager
-    fn_cache_manager = get_cache_manager(make_hash(fn, arch, **kwargs))
+    fn_cache_manager = get_cache_manager(kernel_hash)
     # determine name and extension type of provided function
     if isinstance(fn, triton.runtime.JITFunction):
         name, ext = fn.__name__, "ast"
@@ -431,6 +751,12 @@ def compile(fn, **kwargs):
     metadata = None
     metadata_filename = f"{name}.json"
 
+    # TRITON_CACHE_IR=0 only caches the final binary of the kernels, not
+    # their intermediate IRs, except the PTX of the fat binaries
+    cache_ir = os.environ.get("TRITON_CACHE_IR", "1") == "1"
+    final_ir = list(stages.keys())[-1]
+    fatbin_irs = [f"cubin_{fatbin_arch}" for fatbin_arch in fatbin_archs[1:]]
+
     # The group is addressed by the metadata
     metadata_group = fn_cache_manager.get_group(
         metadata_filename
@@ -441,9 +767,21 @@ def compile(fn, **kwargs):
     if metadata_path is not None:
         with open(metadata_path) as f:
             metadata = json.load(f)
+        if ext == "ast" and target is None:
+            kept = (final_ir, "ptx") if fatbin_archs else (final_ir,)
+            optional = [] if cache_ir else [ir for ir in stages if ir not in kept]
+            asm = _load_cached_asm(fn, name, list(stages) + fatbin_irs, metadata_group, optional)
+            if asm is not None:
+                _kernel_cache[kernel_hash] = (metadata, asm)
+                return CompiledKernel(fn, so_path, metadata, asm)
     else:
         metadata = {"num_warps": num_warps,
+                    "threads_per_warp": threads_per_warp,
                     "num_stages": num_stages,
+                    "fast_math": fast_math,
+                    "opt_level": opt_level,
+                    "maxnreg": maxnreg,
+                    "min_blocks_per_sm": min_blocks_per_sm,
                     "constants": _get_jsonable_constants(constants),
                     "debug": debug}
         if ext == "ptx":
@@ -453,6 +791,8 @@ def compile(fn, **kwargs):
     first_stage = list(stages.keys()).index(ext)
     asm = dict()
     module = fn
+    stage_times = dict()
+    pass_times = dict()
     # run compilation pipeline  and populate metadata
     for ir, (parse, compile_kernel) in list(stages.items())[first_stage:]:
         ir_filename = f"{name}.{ir}"
@@ -462,20 +802,29 @@ def compile(fn, **kwargs):
         else:
             path = metadata_group.get(ir_filename)
             if path is None:
-                next_module = compile_kernel(module)
+                start = time.perf_counter()
+                _pass_times.times = dict()
+                try:
+                    next_module = compile_kernel(module)
+                finally:
+                    stage_pass_times, _pass_times.times = _pass_times.times, None
+                # The time of each stage and of its MLIR passes, in seconds
+                stage_times[ir] = time.perf_counter() - start
+                if stage_pass_times:
+                    pass_times[ir] = stage_pass_times
                 if ir == "amdgcn":
-                    extra_file_name = f"{name}.hsaco_path"
+                    extra_file_name = f"{name}.hsaco"
                     metadata_group[ir_filename] = fn_cache_manager.put(next_module[0], ir_filename)
                     metadata_group[extra_file_name] = fn_cache_manager.put(next_module[1], extra_file_name)
-                else:
+                elif cache_ir or ir == final_ir or (fatbin_archs and ir == "ptx"):
                     metadata_group[ir_filename] = fn_cache_manager.put(next_module, ir_filename)
                     fn_cache_manager.put(next_module, ir_filename)
             else:
                 if ir == "amdgcn":
-                    extra_file_name = f"{name}.hsaco_path"
-                    hasco_path = metadata_group.get(extra_file_name)
-                    assert hasco_path is not None, "Expected to have hsaco_path in metadata when we have the amdgcn"
-                    next_module = (parse(path), parse(hasco_path))
+                    extra_file_name = f"{name}.hsaco"
+                    hsaco_path = metadata_group.get(extra_file_name)
+                    assert hsaco_path is not None, "Expected to have hsaco in metadata when we have the amdgcn"
+                    next_module = (parse(path), Path(hsaco_path).read_bytes())
                 else:
                     next_module = parse(path)
 
@@ -485,40 +834,218 @@ def compile(fn, **kwargs):
             asm[ir] = str(next_module[0])
         else:
             asm[ir] = str(next_module)
+        if ir == "ttgir" and auto_num_warps:
+            metadata["num_warps"] = int(re.findall(ttgir_num_warps_pattern, asm[ir])[0])
+        if ir == "ttgir" and use_print_buffer:
+            # the runtime decodes the print records with the formats
+            metadata["print_formats"] = _triton.get_print_formats(next_module)
+        if ir == "ttgir" and perf_lint:
+            metadata["perf_remarks"] = _triton.get_perf_remarks(next_module, metadata["num_stages"])
+            for remark in metadata["perf_remarks"]:
+                warnings.warn(f"{name}: {remark}", PerformanceWarning)
         if ir == "llir" and "shared" not in metadata:
             metadata["shared"] = _triton.get_shared_memory_size(module)
         if ir == "ptx":
             metadata["name"] = get_kernel_name(next_module, pattern='// .globl')
         if ir == "amdgcn":
             metadata["name"] = get_kernel_name(next_module[0], pattern='.globl')
-            asm["hsaco_path"] = next_module[1]
+            asm["hsaco"] = next_module[1]
+        if target is not None and ir == "ttgir":
+            # The lowering to LLVM rewrites the TritonGPU module in place
+            metadata["n_regs_estimate"] = _triton.estimate_register_usage(next_module)
+            if target == "ttgir":
+                metadata["shared"] = _triton.get_allocation_size(next_module)
         module = next_module
-    # write-back metadata, if it didn't come from the cache
-    if metadata_path is None:
+        if ir == target:
+            metadata["compile_times"] = stage_times
+            return EstimatedKernel(metadata, asm)
+    # the cubins of the other archs of a fat binary, assembled from the PTX
+    for fatbin_ir in fatbin_irs:
+        ir_filename = f"{name}.{fatbin_ir}"
+        path = metadata_group.get(ir_filename)
+        if path is None:
+            start = time.perf_counter()
+            asm[fatbin_ir] = ptx_to_cubin(asm["ptx"], int(fatbin_ir[len("cubin_"):]))
+            stage_times[fatbin_ir] = time.perf_counter() - start
+            metadata_group[ir_filename] = fn_cache_manager.put(asm[fatbin_ir], ir_filename)
+        else:
+            asm[fatbin_ir] = Path(path).read_bytes()
+    if fatbin_archs:
+        metadata["fatbin_archs"] = fatbin_archs
+    if stage_times:
+        metadata.setdefault("compile_times", dict()).update(stage_times)
+        metadata.setdefault("pass_times", dict()).update(pass_times)
+        # TRITON_COMPILE_TRACE appends the timing report of every compilation
+        # to a JSON lines file
+        trace_path = os.environ.get("TRITON_COMPILE_TRACE", "")
+        if trace_path:
+            report = {"name": metadata.get("name", name), "hash": kernel_hash,
+                      "compile_times": stage_times, "pass_times": pass_times}
+            with open(trace_path, "a") as f:
+                f.write(json.dumps(report) + "\n")
+    # write-back metadata, if it didn't come from the cache or the cached
+    # group lacked IRs
+    if metadata_path is None or stage_times:
         metadata_group[metadata_filename] = fn_cache_manager.put(json.dumps(metadata), metadata_filename, binary=False)
         fn_cache_manager.put_group(metadata_filename, metadata_group)
 
     # return handle to compiled kernel
+    _kernel_cache[kernel_hash] = (metadata, asm)
     return CompiledKernel(fn, so_path, metadata, asm)
 
 
+class EstimatedKernel:
+    '''
+    The resources of a kernel compiled up to its TritonGPU IR (or LLVM IR) by
+    compile(..., target=...): the exact shared memory of the kernel and the
+    registers per thread estimated from the TritonGPU layouts, which
+    usually underestimate the allocation of ptxas. The kernel cannot be
+    launched.
+    '''
+
+    def __init__(self, metadata, asm):
+        self.metadata = metadata
+        self.asm = asm
+        self.shared = metadata["shared"]
+        self.n_regs = metadata["n_regs_estimate"]
+        self.num_warps = metadata["num_warps"]
+        self.num_stages = metadata["num_stages"]
+
+    def fits(self, device=None):
+        '''
+        Returns whether the shared memory of the kernel fits the device and
+        a program with the estimated registers fits a multiprocessor.
+        '''
+        if device is None:
+            device = triton.runtime.jit.get_current_device()
+        properties = driver.utils.get_device_properties(device)
+        if self.shared > properties["max_shared_mem"]:
+            return False
+        n_regs = min(self.n_regs, 255)
+        return occupancy(n_regs, self.shared, self.num_warps, properties=properties)["blocks"] > 0
+
+
+class _ResidentModules:
+    '''
+    The modules loaded by the compiled kernels on each device, from the least
+    to the most recently launched. Past `max_bytes` of binaries, the modules of
+    the least recently launched kernels are unloaded; the kernels load them
+    again from their binary on their next launch. The modules of the launches
+    in flight are pinned and stay loaded. No bound is kept with
+    `max_bytes=None`.
+
+    The handles of the kernels are looked up, touched, added and removed with
+    the lock held.
+    '''
+
+    def __init__(self, max_bytes):
+        self.max_bytes = max_bytes
+        self.kernels = OrderedDict()
+        self.num_bytes = 0
+        # (kernel, device) -> launches in flight
+        self.pins = dict()
+        self.lock = threading.Lock()
+
+    def acquire(self, kernel, device, pin=False):
+        # The handles of `kernel` on `device`, or None if its module is not
+        # loaded (anymore)
+        with self.lock:
+            handles = kernel._handles.get(device)
+            if handles is not None:
+                self.kernels.move_to_end((kernel, device))
+                if pin:
+                    self._pin(kernel, device)
+            return handles
+
+    def add(self, kernel, device, handles, num_bytes, pin=False):
+        # Records the module that `kernel` loaded on `device` and returns the
+        # handles to launch: those of a concurrent load that was recorded
+        # first, in which case the module of `handles` is unloaded
+        with self.lock:
+            key = (kernel, device)
+            loaded = kernel._handles.get(device)
+            if loaded is None:
+                kernel._handles[device] = handles
+                self.kernels[key] = num_bytes
+                self.num_bytes += num_bytes
+                evicted = self._evict()
+            else:
+                self.kernels.move_to_end(key)
+                evicted = [(handles, device)]
+                handles = loaded
+            if pin:
+                self._pin(kernel, device)
+        self._unload(evicted)
+        return handles
+
+    def release(self, kernel, device):
+        # Unpins the module of a launch of `kernel` on `device`
+        with self.lock:
+            key = (kernel, device)
+            self.pins[key] -= 1
+            if self.pins[key] > 0:
+                return
+            del self.pins[key]
+            evicted = self._evict()
+        self._unload(evicted)
+
+    def _pin(self, kernel, device):
+        key = (kernel, device)
+        self.pins[key] = self.pins.get(key, 0) + 1
+
+    def _evict(self):
+        # With the lock held, removes the handles of the unpinned modules of
+        # the least recently launched kernels past `max_bytes`, keeping the
+        # most recent one
+        evicted = []
+        if self.num_bytes <= self.max_bytes:
+            return evicted
+        for key in list(self.kernels)[:-1]:
+            if self.num_bytes <= self.max_bytes:
+                break
+            if key in self.pins:
+                continue
+            self.num_bytes -= self.kernels.pop(key)
+            cold, cold_device = key
+            evicted.append((cold._handles.pop(cold_device), cold_device))
+        return evicted
+
+    @staticmethod
+    def _unload(evicted):
+        for handles, device in evicted:
+            driver.utils.unload_binary(handles[0], device)
+
+
 class CompiledKernel:
 
     # Hooks for external tools to monitor the execution of triton kernels
     launch_enter_hook = None
     launch_exit_hook = None
 
+    # TRITON_MAX_RESIDENT_KERNEL_BYTES bounds the size of the binaries loaded on
+    # the device, e.g. for servers compiling many specializations
+    _max_resident_bytes = os.environ.get("TRITON_MAX_RESIDENT_KERNEL_BYTES", "")
+    resident_modules = _ResidentModules(int(_max_resident_bytes) if _max_resident_bytes else None)
+
+    # Launchers loaded by this process: so_path -> launcher module
+    launchers = dict()
+
     def __init__(self, fn, so_path, metadata, asm):
         # initialize launcher
-        import importlib.util
-        spec = importlib.util.spec_from_file_location("__triton_launcher", so_path)
-        mod = importlib.util.module_from_spec(spec)
         self.fn = fn
-        spec.loader.exec_module(mod)
-        self.c_wrapper = getattr(mod, "launch")
+        if so_path not in CompiledKernel.launchers:
+            import importlib.util
+            spec = importlib.util.spec_from_file_location("__triton_launcher", so_path)
+            mod = importlib.util.module_from_spec(spec)
+            spec.loader.exec_module(mod)
+            CompiledKernel.launchers[so_path] = mod
+        self.c_wrapper = CompiledKernel.launchers[so_path].launch
+        # packs the arguments for triton.runtime.LaunchPlan
+        self.c_pack = CompiledKernel.launchers[so_path].pack
         # initialize metadata
         self.shared = metadata["shared"]
         self.num_warps = metadata["num_warps"]
+        self.threads_per_warp = metadata.get("threads_per_warp", 32)
         self.num_stages = metadata["num_stages"]
         self.constants = metadata["constants"]
         # initialize asm dict
@@ -527,31 +1054,109 @@ class CompiledKernel:
         # because it involves doing runtime things
         # (e.g., checking amount of shared memory on current device)
         self.metadata = metadata
-        self.cu_module = None
-        self.cu_function = None
+        # the module and function loaded on each device
+        self._handles = dict()
 
-    def _init_handles(self):
-        if self.cu_module is not None:
-            return
-        device = triton.runtime.jit.get_current_device()
-        bin_path = {
-            driver.HIP: "hsaco_path",
-            driver.CUDA: "cubin"
-        }[driver.backend]
+    def _init_handles(self, device=None, pin=False):
+        # With a bound on the resident modules and `pin`, the module stays
+        # loaded until `resident_modules.release(self, device)`
+        if device is None:
+            device = triton.runtime.jit.get_current_device()
+        resident = CompiledKernel.resident_modules
+        if resident.max_bytes is None:
+            handles = self._handles.get(device)
+        else:
+            handles = resident.acquire(self, device, pin)
+        if handles is not None:
+            return handles
         max_shared = driver.utils.get_device_properties(device)["max_shared_mem"]
         if self.shared > max_shared:
             raise OutOfResources(self.shared, max_shared, "shared memory")
-        mod, func, n_regs, n_spills = driver.utils.load_binary(self.metadata["name"], self.asm[bin_path], self.shared, device)
+        binary = self._get_binary(device)
+        mod, func, n_regs, n_spills, local_bytes = driver.utils.load_binary(self.metadata["name"], binary,
+                                                                            self.shared, device)
 
         self.n_spills = n_spills
         self.n_regs = n_regs
-        self.cu_module = mod
-        self.cu_function = func
-
-    def __getattribute__(self, name):
-        if name == 'c_wrapper':
-            self._init_handles()
-        return super().__getattribute__(name)
+        self.local_bytes = local_bytes
+        handles = (mod, func)
+        if self.metadata.get("print_formats"):
+            print_buffer.attach(mod, self.metadata["print_formats"], device)
+        if resident.max_bytes is None:
+            self._handles[device] = handles
+            return handles
+        num_bytes = len(binary) if isinstance(binary, bytes) else os.path.getsize(binary)
+        return resident.add(self, device, handles, num_bytes, pin)
+
+    def _get_binary(self, device):
+        # The binary to load on `device`: of a fat binary, the cubin of the
+        # most recent arch of the major version of the device that it can
+        # run, or else the PTX.
+        if driver.backend == driver.HIP:
+            return self.asm["hsaco"]
+        archs = self.metadata.get("fatbin_archs", None)
+        if not archs:
+            return self.asm["cubin"]
+        major, minor = triton.runtime.jit.get_device_capability(device)
+        capability = major * 10 + minor
+        compatible = [arch for arch in archs if arch // 10 == major and arch <= capability]
+        if compatible:
+            arch = max(compatible)
+            return self.asm["cubin"] if arch == archs[0] else self.asm[f"cubin_{arch}"]
+        if capability < archs[0]:
+            raise RuntimeError(f"{self.metadata['name']} was compiled for sm_{archs[0]} and newer, "
+                               f"not for the sm_{capability} of device {device}")
+        # the driver JIT reads null-terminated PTX
+        return self.asm["ptx"].encode("utf-8") + b"\0"
+
+    def preload(self, devices=None):
+        '''
+        Loads the kernel on each of the given devices, all the visible ones by
+        default, e.g. at warmup so that the first launch on each device of a
+        multi-GPU process doesn't load it. The devices must be able to run the
+        binary, i.e. share the target it was compiled for.
+        '''
+        if devices is None:
+            import torch
+            devices = range(torch.cuda.device_count())
+        for device in devices:
+            self._init_handles(device)
+
+    @property
+    def cu_module(self):
+        '''The module of the kernel on the current device, None if not loaded.'''
+        handles = self._handles.get(triton.runtime.jit.get_current_device())
+        return handles[0] if handles is not None else None
+
+    @property
+    def cu_function(self):
+        '''The function of the kernel on the current device, loaded on demand.'''
+        return self._init_handles()[1]
+
+    def get_resource_usage(self):
+        '''
+        Returns the resources used by the kernel on the current device:
+        registers per thread, spilled words and local memory bytes per thread,
+        shared memory bytes per program, and the number of warps that can be
+        resident on a multiprocessor.
+        '''
+        function = self.cu_function
+        max_blocks = driver.utils.get_max_active_blocks(function, self.num_warps * self.threads_per_warp, self.shared)
+        return {"n_regs": self.n_regs, "n_spills": self.n_spills, "local_bytes": self.local_bytes,
+                "shared": self.shared, "occupancy": max_blocks * self.num_warps}
+
+    def _run(self, device, grid_0, grid_1, grid_2, stream, *args):
+        # Launches the kernel on `device`, whose module stays loaded for the
+        # launch with a bound on the resident modules
+        resident = CompiledKernel.resident_modules
+        pin = resident.max_bytes is not None
+        function = self._init_handles(device, pin)[1]
+        try:
+            self.c_wrapper(grid_0, grid_1, grid_2, self.num_warps, self.shared, stream, function,
+                           CompiledKernel.launch_enter_hook, CompiledKernel.launch_exit_hook, self, *args)
+        finally:
+            if pin:
+                resident.release(self, device)
 
     def __getitem__(self, grid):
         self._init_handles()
@@ -559,8 +1164,8 @@ class CompiledKernel:
         def runner(*args, stream=None):
             if stream is None:
                 stream = triton.runtime.jit.get_cuda_stream()
-            self.c_wrapper(grid[0], grid[1], grid[2], self.num_warps, self.shared, stream, self.cu_function,
-                           CompiledKernel.launch_enter_hook, CompiledKernel.launch_exit_hook, self, *args)
+            # the function of the device that is current at launch
+            self._run(triton.runtime.jit.get_current_device(), grid[0], grid[1], grid[2], stream, *args)
         return runner
 
     def get_sass(self, fun=None):
@@ -575,3 +1180,11 @@ class CompiledKernel:
             os.remove(path)
         self.asm['sass'] = self.sass
         return self.sass
+
+    def get_instruction_mix(self):
+        '''
+        Returns the :code:`InstructionMix` of the SASS of the kernel: the
+        instruction counts by class, the ratio of predicated global loads and
+        the conflict-free shared memory wavefronts.
+        '''
+        return analyze(self.get_sass())
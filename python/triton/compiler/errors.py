@@ -50,3 +50,8 @@ class CompileTimeAssertionFailure(CompilationError):
 
 class UnsupportedLanguageConstruct(CompilationError):
     pass
+
+
+class PerformanceWarning(UserWarning):
+    """The remarks of compile(..., perf_lint=True) on likely performance problems"""
+    pass
@@ -15,32 +15,42 @@ def is_hip():
 # ----- stub --------
 
 
-def make_so_cache_key(version_hash, signature, constants):
+def make_so_cache_key(version_hash, signature, constants, threads_per_warp=None):
     # Get unique key for the compiled code
-    signature = {k: 'ptr' if v[0] == '*' else v for k, v in signature.items()}
+    # the stubs pass any parameter table as a pointer to its bytes
+    signature = {k: 'ptr' if v[0] == '*' else 'table' if v[0] == '[' else v for k, v in signature.items()}
     key = f"{version_hash}-{''.join(signature.values())}{constants}"
+    if threads_per_warp is not None:
+        key += f"-{threads_per_warp}"
     key = hashlib.md5(key.encode("utf-8")).hexdigest()
     return key
 
 
-def make_stub(name, signature, constants):
+# Stubs found or built by this process: (so_cache_key, name) -> path
+_stub_paths = dict()
+
+
+def make_stub(name, signature, constants, threads_per_warp=None):
     # name of files that are cached
-    so_cache_key = make_so_cache_key(version_key(), signature, constants)
+    so_cache_key = make_so_cache_key(version_key(), signature, constants, threads_per_warp)
+    cache_path = _stub_paths.get((so_cache_key, name), None)
+    if cache_path is not None and os.path.exists(cache_path):
+        return cache_path
     so_cache_manager = get_cache_manager(so_cache_key)
     so_name = f"{name}.so"
     # retrieve stub from cache if it exists
     cache_path = so_cache_manager.get_file(so_name)
     if cache_path is None:
         with tempfile.TemporaryDirectory() as tmpdir:
-            src = generate_launcher(constants, signature)
+            src = generate_launcher(constants, signature, threads_per_warp)
             src_path = os.path.join(tmpdir, "main.c")
             with open(src_path, "w") as f:
                 f.write(src)
             so = _build(name, src_path, tmpdir)
             with open(so, "rb") as f:
-                return so_cache_manager.put(f.read(), so_name, binary=True)
-    else:
-        return cache_path
+                cache_path = so_cache_manager.put(f.read(), so_name, binary=True)
+    _stub_paths[(so_cache_key, name)] = cache_path
+    return cache_path
 
 # ----- source code generation --------
 
@@ -48,6 +58,8 @@ def make_stub(name, signature, constants):
 def ty_to_cpp(ty):
     if ty[0] == '*':
         return "hipDeviceptr_t" if is_hip() else "CUdeviceptr"
+    if ty[0] == '[':
+        return "const void*"
     return {
         "i1": "int32_t",
         "i8": "int8_t",
@@ -64,12 +76,22 @@ def ty_to_cpp(ty):
     }[ty]
 
 
-def generate_launcher(constants, signature):
+# The launch arguments before the kernel arguments: grid_0, grid_1, grid_2,
+# num_warps, shared, stream, function, enter_hook, exit_hook, compiled_kernel
+NUM_LAUNCH_ARGS = 10
+
+
+def generate_launcher(constants, signature, threads_per_warp=None):
     arg_decls = ', '.join(f"{ty_to_cpp(ty)} arg{i}" for i, ty in signature.items())
+    num_args = NUM_LAUNCH_ARGS + len(signature)
+    hip = is_hip()
+    # the threads of a warp as laid out by the compiler: a wavefront of 64 on
+    # AMD GPUs unless the kernel was compiled for wave32
+    if threads_per_warp is None:
+        threads_per_warp = 64 if hip else 32
+    ptr_ty = "hipDeviceptr_t" if hip else "CUdeviceptr"
 
     def _extracted_type(ty):
-        if ty[0] == '*':
-            return "PyObject*"
         return {
             'i1': 'int32_t',
             'i32': 'int32_t',
@@ -83,261 +105,171 @@ def generate_launcher(constants, signature):
             'fp64': 'double',
         }[ty]
 
-    def format_of(ty):
+    def convert(ty, obj):
+        # the conversions of PyArg_ParseTuple for the formats "ifdIKL"
         return {
-            "PyObject*": "O",
-            "float": "f",
-            "double": "d",
-            "long": "l",
-            "uint32_t": "I",
-            "int32_t": "i",
-            "uint64_t": "K",
-            "int64_t": "L",
+            "int32_t": f"asInt32({obj})",
+            "int64_t": f"PyLong_AsLongLong({obj})",
+            "uint32_t": f"(uint32_t)PyLong_AsUnsignedLongMask({obj})",
+            "uint64_t": f"PyLong_AsUnsignedLongLongMask({obj})",
+            "float": f"(float)PyFloat_AsDouble({obj})",
+            "double": f"PyFloat_AsDouble({obj})",
         }[ty]
 
-    format = "iiiiiKKOOO" + ''.join([format_of(_extracted_type(ty)) for ty in signature.values()])
-
-    # generate glue code
-    if is_hip():
-        src = f"""
-    #define __HIP_PLATFORM_AMD__
-    #include <hip/hip_runtime.h>
-    #include <Python.h>
-    #include <stdio.h>
-
-    static inline void gpuAssert(hipError_t code, const char *file, int line)
-    {{
-      if (code != HIP_SUCCESS)
-      {{
-         const char* prefix = "Triton Error [HIP]: ";
-         const char* str = hipGetErrorString(code);
-         char err[1024] = {{0}};
-         snprintf(err, 1024, "%s Code: %d, Messsage: %s", prefix, code, str );
-         PyErr_SetString(PyExc_RuntimeError, err);
-      }}
-    }}
-
-    #define HIP_CHECK(ans) {{ gpuAssert((ans), __FILE__, __LINE__); }}
-
-    static void _launch(int gridX, int gridY, int gridZ, int num_warps, int shared_memory, hipStream_t stream, hipFunction_t function, {arg_decls}) {{
-      void *params[] = {{ {', '.join(f"&arg{i}" for i in signature.keys() if i not in constants)} }};
-      if (gridX*gridY*gridZ > 0) {{
-          HIP_CHECK(hipModuleLaunchKernel(function, gridX, gridY, gridZ, 64*num_warps, 1, 1, shared_memory, stream, params, 0));
-      }}
-    }}
-
-    typedef struct _DevicePtrInfo {{
-      hipDeviceptr_t dev_ptr;
-      bool valid;
-    }} DevicePtrInfo;
-
-    static inline DevicePtrInfo getPointer(PyObject *obj, int idx) {{
-      DevicePtrInfo ptr_info;
-      ptr_info.dev_ptr = 0;
-      ptr_info.valid = true;
-
-      if (PyLong_Check(obj)) {{
-        ptr_info.dev_ptr = (hipDeviceptr_t)PyLong_AsUnsignedLongLong(obj);
-        return ptr_info;
-      }}
-
-      if (obj == Py_None) {{
-        // valid nullptr
-        return ptr_info;
-      }}
-
-      PyObject *ptr = PyObject_GetAttrString(obj, "data_ptr");
-
-      if (ptr) {{
-        PyObject *empty_tuple = PyTuple_New(0);
-        PyObject *ret = PyObject_Call(ptr, empty_tuple, NULL);
-        Py_DECREF(empty_tuple);
-        Py_DECREF(ptr);
-
-        if (!PyLong_Check(ret)) {{
-          PyErr_SetString(PyExc_TypeError, "data_ptr method of Pointer object must return 64-bit int");
-          ptr_info.valid = false;
-          return ptr_info;
-        }}
-
-        ptr_info.dev_ptr = (hipDeviceptr_t)PyLong_AsUnsignedLongLong(ret);
-
-        if (!ptr_info.dev_ptr)
-          return ptr_info;
-
-        uint64_t dev_ptr;
-        hipError_t status = hipPointerGetAttribute(&dev_ptr, HIP_POINTER_ATTRIBUTE_DEVICE_POINTER, ptr_info.dev_ptr);
-        if (status == hipErrorInvalidValue) {{
-            PyErr_Format(PyExc_ValueError,
-                         "Pointer argument (at %d) cannot be accessed from Triton (cpu tensor?)", idx);
-            ptr_info.valid = false;
-        }}
-
-        ptr_info.dev_ptr = (hipDeviceptr_t)dev_ptr;
-        return ptr_info;
-      }}
-
-      PyErr_SetString(PyExc_TypeError, "Pointer argument must be either uint64 or have data_ptr method");
-      return ptr_info;
-    }}
-
-    static PyObject* launch(PyObject* self, PyObject* args) {{
-
-      int gridX, gridY, gridZ;
-      uint64_t _stream;
-      uint64_t _function;
-      int num_warps;
-      int shared_memory;
-      PyObject *launch_enter_hook = NULL;
-      PyObject *launch_exit_hook = NULL;
-      PyObject *compiled_kernel = NULL;
-
-      {' '.join([f"{_extracted_type(ty)} _arg{i}; " for i, ty in signature.items()])}
-      if (!PyArg_ParseTuple(args, \"{format}\", &gridX, &gridY, &gridZ, &num_warps, &shared_memory, &_stream, &_function, &launch_enter_hook, &launch_exit_hook, &compiled_kernel, {', '.join(f"&_arg{i}" for i, ty in signature.items())})) {{
-        return NULL;
-      }}
-
-      if (launch_enter_hook != Py_None) {{
-        PyObject_CallObject(launch_enter_hook, args);
-      }}
-
-      // raise exception asap
-      {"; ".join([f"DevicePtrInfo ptr_info{i} = getPointer(_arg{i}, {i}); if (!ptr_info{i}.valid) return NULL;" if ty[0] == "*" else "" for i, ty in signature.items()])};
-      _launch(gridX, gridY, gridZ, num_warps, shared_memory, (hipStream_t)_stream, (hipFunction_t)_function, {', '.join(f"ptr_info{i}.dev_ptr" if ty[0]=="*" else f"_arg{i}" for i, ty in signature.items())});
-      if (launch_exit_hook != Py_None) {{
-        PyObject_CallObject(launch_exit_hook, args);
-      }}
-      if (PyErr_Occurred()) {{
-        return NULL;
-      }}
-
-      // return None
-      Py_INCREF(Py_None);
-      return Py_None;
-    }}
-
-    static PyMethodDef ModuleMethods[] = {{
-      {{"launch", launch, METH_VARARGS, "Entry point for all kernels with this signature"}},
-      {{NULL, NULL, 0, NULL}} // sentinel
-    }};
-
-    static struct PyModuleDef ModuleDef = {{
-      PyModuleDef_HEAD_INIT,
-      \"__triton_launcher\",
-      NULL, //documentation
-      -1, //size
-      ModuleMethods
-    }};
-
-    PyMODINIT_FUNC PyInit___triton_launcher(void) {{
-      PyObject *m = PyModule_Create(&ModuleDef);
-      if(m == NULL) {{
-        return NULL;
-      }}
-      PyModule_AddFunctions(m, ModuleMethods);
-      return m;
-    }}
-    """
-    else:
-        src = f"""
-#include \"cuda.h\"
-#include <stdbool.h>
-#include <Python.h>
-
-static inline void gpuAssert(CUresult code, const char *file, int line)
-{{
-   if (code != CUDA_SUCCESS)
-   {{
-      const char* prefix = "Triton Error [CUDA]: ";
-      const char* str;
-      cuGetErrorString(code, &str);
-      char err[1024] = {{0}};
-      strcat(err, prefix);
-      strcat(err, str);
-      PyErr_SetString(PyExc_RuntimeError, err);
-   }}
-}}
-
-#define CUDA_CHECK(ans) {{ gpuAssert((ans), __FILE__, __LINE__); }}
-
-static void _launch(int gridX, int gridY, int gridZ, int num_warps, int shared_memory, CUstream stream, CUfunction function, {arg_decls}) {{
-  void *params[] = {{ {', '.join(f"&arg{i}" for i in signature.keys() if i not in constants)} }};
-  if(gridX*gridY*gridZ > 0){{
-    CUDA_CHECK(cuLaunchKernel(function, gridX, gridY, gridZ, 32*num_warps, 1, 1, shared_memory, stream, params, 0));
-  }}
-}}
-
+    def parse_args(offset):
+        # the conversions of the kernel arguments, from args[offset]
+        positions = {i: offset + pos for pos, i in enumerate(signature.keys())}
+        scalar_args = '\n  '.join(f"{_extracted_type(ty)} _arg{i} = "
+                                  f"{convert(_extracted_type(ty), f'args[{positions[i]}]')};"
+                                  for i, ty in signature.items() if ty[0] not in '*[')
+        table_args = '\n  '.join(f"const void *_arg{i} = getParamTable(args[{positions[i]}], {i});"
+                                 for i, ty in signature.items() if ty[0] == '[')
+        scalar_args = '\n  '.join(filter(None, [scalar_args, table_args]))
+        ptr_args = '\n  '.join(f"DevicePtrInfo ptr_info{i} = getPointer(args[{positions[i]}], {i}); "
+                               f"if (!ptr_info{i}.valid) return NULL;"
+                               for i, ty in signature.items() if ty[0] == '*')
+        return scalar_args, ptr_args
+
+    # the kernel arguments follow the launch arguments
+    scalar_args, ptr_args = parse_args(NUM_LAUNCH_ARGS)
+    pack_scalar_args, pack_ptr_args = parse_args(0)
+    launch_args = ', '.join(f"ptr_info{i}.dev_ptr" if ty[0] == "*" else f"_arg{i}" for i, ty in signature.items())
+    # the parameters of the kernel, without the specialized constants
+    params = [f"ptr_info{i}.dev_ptr" if ty[0] == "*" else f"_arg{i}" for i, ty in signature.items() if i not in constants]
+    num_slots = max(len(params), 1)
+    pack_slots = '\n  '.join(f"memcpy(&slots[{k}], &{param}, sizeof({param}));" for k, param in enumerate(params))
+    # the parameter tables do not fit in the 8-byte slots
+    if any(ty[0] == '[' for ty in signature.values()):
+        pack_scalar_args, pack_ptr_args = '', ''
+        pack_slots = ('PyErr_SetString(PyExc_TypeError, "kernels taking parameter tables cannot be packed");\n'
+                      '  return NULL;')
+    # the parameters are the addresses of the arguments, or the bytes of the
+    # parameter tables, which the driver copies when the kernel is launched
+    kernel_params = ', '.join(f"(void *)arg{i}" if ty[0] == '[' else f"&arg{i}"
+                              for i, ty in signature.items() if i not in constants)
+
+    # the argument parsing, the hooks and the module are shared by the backends
+    common = f"""
 typedef struct _DevicePtrInfo {{
-    CUdeviceptr dev_ptr;
-    bool valid;
+  {ptr_ty} dev_ptr;
+  bool valid;
 }} DevicePtrInfo;
 
+// interned at module initialization
+static PyObject *data_ptr_str = NULL;
+
 static inline DevicePtrInfo getPointer(PyObject *obj, int idx) {{
   DevicePtrInfo ptr_info;
   ptr_info.dev_ptr = 0;
   ptr_info.valid = true;
   if (PyLong_Check(obj)) {{
-    ptr_info.dev_ptr = PyLong_AsUnsignedLongLong(obj);
+    ptr_info.dev_ptr = ({ptr_ty})PyLong_AsUnsignedLongLong(obj);
     return ptr_info;
   }}
   if (obj == Py_None) {{
     // valid nullptr
     return ptr_info;
   }}
-  PyObject *ptr = PyObject_GetAttrString(obj, "data_ptr");
-  if(ptr){{
-    PyObject *empty_tuple = PyTuple_New(0);
-    PyObject *ret = PyObject_Call(ptr, empty_tuple, NULL);
-    Py_DECREF(empty_tuple);
-    Py_DECREF(ptr);
-    if (!PyLong_Check(ret)) {{
-      PyErr_SetString(PyExc_TypeError, "data_ptr method of Pointer object must return 64-bit int");
-      ptr_info.valid = false;
-      return ptr_info;
-    }}
-    ptr_info.dev_ptr = PyLong_AsUnsignedLongLong(ret);
-    if(!ptr_info.dev_ptr)
-      return ptr_info;
-    uint64_t dev_ptr;
-    int status = cuPointerGetAttribute(&dev_ptr, CU_POINTER_ATTRIBUTE_DEVICE_POINTER, ptr_info.dev_ptr);
-    if (status == CUDA_ERROR_INVALID_VALUE) {{
-        PyErr_Format(PyExc_ValueError,
-                     "Pointer argument (at %d) cannot be accessed from Triton (cpu tensor?)", idx);
-        ptr_info.valid = false;
+  // calls the method without binding it first, e.g. torch.Tensor.data_ptr
+  PyObject *ret = PyObject_CallMethodObjArgs(obj, data_ptr_str, NULL);
+  if (!ret) {{
+    if (PyErr_ExceptionMatches(PyExc_AttributeError)) {{
+      PyErr_Clear();
+      PyErr_SetString(PyExc_TypeError, "Pointer argument must be either uint64 or have data_ptr method");
     }}
-    ptr_info.dev_ptr = dev_ptr;
-    Py_DECREF(ret);  // Thanks ChatGPT!
+    ptr_info.valid = false;
+    return ptr_info;
+  }}
+  if (!PyLong_Check(ret)) {{
+    Py_DECREF(ret);
+    PyErr_SetString(PyExc_TypeError, "data_ptr method of Pointer object must return 64-bit int");
+    ptr_info.valid = false;
     return ptr_info;
   }}
-  PyErr_SetString(PyExc_TypeError, "Pointer argument must be either uint64 or have data_ptr method");
+  ptr_info.dev_ptr = ({ptr_ty})PyLong_AsUnsignedLongLong(ret);
+  Py_DECREF(ret);
+  if (!ptr_info.dev_ptr)
+    return ptr_info;
+  if (!checkDevicePointer(&ptr_info.dev_ptr)) {{
+    PyErr_Format(PyExc_ValueError,
+                 "Pointer argument (at %d) cannot be accessed from Triton (cpu tensor?)", idx);
+    ptr_info.valid = false;
+  }}
   return ptr_info;
 }}
 
-static PyObject* launch(PyObject* self, PyObject* args) {{
-  int gridX, gridY, gridZ;
-  uint64_t _stream;
-  uint64_t _function;
-  int num_warps;
-  int shared_memory;
-  PyObject *launch_enter_hook = NULL;
-  PyObject *launch_exit_hook = NULL;
-  PyObject *compiled_kernel = NULL;
-  {' '.join([f"{_extracted_type(ty)} _arg{i}; " for i, ty in signature.items()])}
-  if(!PyArg_ParseTuple(args, \"{format}\", &gridX, &gridY, &gridZ, &num_warps, &shared_memory, &_stream, &_function, &launch_enter_hook, &launch_exit_hook, &compiled_kernel, {', '.join(f"&_arg{i}" for i, ty in signature.items())})) {{
+// The format "i" of PyArg_ParseTuple: raises an OverflowError if the value does
+// not fit in 32 bits
+static inline int32_t asInt32(PyObject *obj) {{
+  long value = PyLong_AsLong(obj);
+  if (value == -1 && PyErr_Occurred())
+    return -1;
+  if (value < INT32_MIN || value > INT32_MAX) {{
+    PyErr_SetString(PyExc_OverflowError, "signed integer is out of the range of int32");
+    return -1;
+  }}
+  return (int32_t)value;
+}}
+
+// Returns the bytes of a parameter table, which live as long as the table
+static inline const void *getParamTable(PyObject *obj, int idx) {{
+  PyObject *data = PyObject_GetAttrString(obj, "data");
+  if (!data || !PyBytes_Check(data)) {{
+    Py_XDECREF(data);
+    PyErr_Format(PyExc_TypeError, "Parameter table argument (at %d) must be a triton.ParamTable", idx);
     return NULL;
   }}
+  const void *bytes = PyBytes_AS_STRING(data);
+  Py_DECREF(data);
+  return bytes;
+}}
+
+// The hooks take the arguments of the launch as a tuple, which is only built
+// when a hook is installed
+static bool callHook(PyObject *hook, PyObject *const *args, Py_ssize_t nargs) {{
+  PyObject *tuple = PyTuple_New(nargs);
+  if (!tuple)
+    return false;
+  for (Py_ssize_t i = 0; i < nargs; ++i) {{
+    Py_INCREF(args[i]);
+    PyTuple_SET_ITEM(tuple, i, args[i]);
+  }}
+  PyObject *ret = PyObject_Call(hook, tuple, NULL);
+  Py_DECREF(tuple);
+  Py_XDECREF(ret);
+  return ret != NULL;
+}}
 
-  if (launch_enter_hook != Py_None) {{
-    PyObject_CallObject(launch_enter_hook, args);
+// METH_FASTCALL: the arguments are not packed into a tuple
+static PyObject* launch(PyObject* self, PyObject *const *args, Py_ssize_t nargs) {{
+  if (nargs != {num_args}) {{
+    PyErr_Format(PyExc_TypeError, "launch expected {num_args} arguments, got %zd", nargs);
+    return NULL;
+  }}
+  int gridX = asInt32(args[0]);
+  int gridY = asInt32(args[1]);
+  int gridZ = asInt32(args[2]);
+  int num_warps = asInt32(args[3]);
+  int shared_memory = asInt32(args[4]);
+  uint64_t _stream = PyLong_AsUnsignedLongLongMask(args[5]);
+  uint64_t _function = PyLong_AsUnsignedLongLongMask(args[6]);
+  PyObject *launch_enter_hook = args[7];
+  PyObject *launch_exit_hook = args[8];
+  {scalar_args}
+  if (PyErr_Occurred()) {{
+    return NULL;
   }}
 
+  if (launch_enter_hook != Py_None && !callHook(launch_enter_hook, args, nargs)) {{
+    return NULL;
+  }}
 
   // raise exception asap
-  {"; ".join([f"DevicePtrInfo ptr_info{i} = getPointer(_arg{i}, {i}); if (!ptr_info{i}.valid) return NULL;" if ty[0] == "*" else "" for i, ty in signature.items()])};
-  _launch(gridX, gridY, gridZ, num_warps, shared_memory, (CUstream)_stream, (CUfunction)_function, {', '.join(f"ptr_info{i}.dev_ptr" if ty[0]=="*" else f"_arg{i}"for i, ty in signature.items())});
+  {ptr_args}
+  _launch(gridX, gridY, gridZ, num_warps, shared_memory, (STREAM_T)_stream, (FUNCTION_T)_function{', ' if launch_args else ''}{launch_args});
 
-  if (launch_exit_hook != Py_None) {{
-    PyObject_CallObject(launch_exit_hook, args);
+  if (launch_exit_hook != Py_None && !callHook(launch_exit_hook, args, nargs)) {{
+    return NULL;
   }}
 
   if(PyErr_Occurred()) {{
@@ -348,8 +280,26 @@ static PyObject* launch(PyObject* self, PyObject* args) {{
   return Py_None;
 }}
 
+// Converts the kernel arguments once into the parameters of the kernel, one
+// 8-byte slot each, for the launch_batch of the driver utils
+static PyObject* pack(PyObject* self, PyObject *const *args, Py_ssize_t nargs) {{
+  if (nargs != {len(signature)}) {{
+    PyErr_Format(PyExc_TypeError, "pack expected {len(signature)} arguments, got %zd", nargs);
+    return NULL;
+  }}
+  {pack_scalar_args}
+  if (PyErr_Occurred()) {{
+    return NULL;
+  }}
+  {pack_ptr_args}
+  uint64_t slots[{num_slots}] = {{0}};
+  {pack_slots}
+  return PyBytes_FromStringAndSize((const char *)slots, {len(params)} * sizeof(uint64_t));
+}}
+
 static PyMethodDef ModuleMethods[] = {{
-  {{"launch", launch, METH_VARARGS, "Entry point for all kernels with this signature"}},
+  {{"launch", (PyCFunction)(void(*)(void))launch, METH_FASTCALL, "Entry point for all kernels with this signature"}},
+  {{"pack", (PyCFunction)(void(*)(void))pack, METH_FASTCALL, "Packs the arguments of a kernel with this signature"}},
   {{NULL, NULL, 0, NULL}} // sentinel
 }};
 
@@ -362,6 +312,10 @@ static struct PyModuleDef ModuleDef = {{
 }};
 
 PyMODINIT_FUNC PyInit___triton_launcher(void) {{
+  data_ptr_str = PyUnicode_InternFromString("data_ptr");
+  if (data_ptr_str == NULL) {{
+    return NULL;
+  }}
   PyObject *m = PyModule_Create(&ModuleDef);
   if(m == NULL) {{
     return NULL;
@@ -370,4 +324,88 @@ PyMODINIT_FUNC PyInit___triton_launcher(void) {{
   return m;
 }}
 """
+
+    # generate glue code
+    if hip:
+        src = f"""
+#define __HIP_PLATFORM_AMD__
+#include <hip/hip_runtime.h>
+#include <stdbool.h>
+#include <string.h>
+#include <Python.h>
+#include <stdio.h>
+
+typedef hipStream_t STREAM_T;
+typedef hipFunction_t FUNCTION_T;
+
+static inline void gpuAssert(hipError_t code, const char *file, int line)
+{{
+  if (code != HIP_SUCCESS)
+  {{
+     const char* prefix = "Triton Error [HIP]: ";
+     const char* str = hipGetErrorString(code);
+     char err[1024] = {{0}};
+     snprintf(err, 1024, "%s Code: %d, Messsage: %s", prefix, code, str );
+     PyErr_SetString(PyExc_RuntimeError, err);
+  }}
+}}
+
+#define HIP_CHECK(ans) {{ gpuAssert((ans), __FILE__, __LINE__); }}
+
+static void _launch(int gridX, int gridY, int gridZ, int num_warps, int shared_memory, hipStream_t stream, hipFunction_t function{', ' if arg_decls else ''}{arg_decls}) {{
+  void *params[] = {{ {kernel_params} }};
+  if (gridX*gridY*gridZ > 0) {{
+      HIP_CHECK(hipModuleLaunchKernel(function, gridX, gridY, gridZ, {threads_per_warp}*num_warps, 1, 1, shared_memory, stream, params, 0));
+  }}
+}}
+
+// Replaces the pointer with its device pointer, returns false for host memory
+static inline bool checkDevicePointer(hipDeviceptr_t *ptr) {{
+  uint64_t dev_ptr;
+  hipError_t status = hipPointerGetAttribute(&dev_ptr, HIP_POINTER_ATTRIBUTE_DEVICE_POINTER, *ptr);
+  *ptr = (hipDeviceptr_t)dev_ptr;
+  return status != hipErrorInvalidValue;
+}}
+{common}"""
+    else:
+        src = f"""
+#include \"cuda.h\"
+#include <stdbool.h>
+#include <string.h>
+#include <Python.h>
+
+typedef CUstream STREAM_T;
+typedef CUfunction FUNCTION_T;
+
+static inline void gpuAssert(CUresult code, const char *file, int line)
+{{
+   if (code != CUDA_SUCCESS)
+   {{
+      const char* prefix = "Triton Error [CUDA]: ";
+      const char* str;
+      cuGetErrorString(code, &str);
+      char err[1024] = {{0}};
+      strcat(err, prefix);
+      strcat(err, str);
+      PyErr_SetString(PyExc_RuntimeError, err);
+   }}
+}}
+
+#define CUDA_CHECK(ans) {{ gpuAssert((ans), __FILE__, __LINE__); }}
+
+static void _launch(int gridX, int gridY, int gridZ, int num_warps, int shared_memory, CUstream stream, CUfunction function{', ' if arg_decls else ''}{arg_decls}) {{
+  void *params[] = {{ {kernel_params} }};
+  if(gridX*gridY*gridZ > 0){{
+    CUDA_CHECK(cuLaunchKernel(function, gridX, gridY, gridZ, {threads_per_warp}*num_warps, 1, 1, shared_memory, stream, params, 0));
+  }}
+}}
+
+// Replaces the pointer with its device pointer, returns false for host memory
+static inline bool checkDevicePointer(CUdeviceptr *ptr) {{
+  uint64_t dev_ptr;
+  int status = cuPointerGetAttribute(&dev_ptr, CU_POINTER_ATTRIBUTE_DEVICE_POINTER, *ptr);
+  *ptr = dev_ptr;
+  return status != CUDA_ERROR_INVALID_VALUE;
+}}
+{common}"""
     return src
@@ -5,5 +5,16 @@ import dataclasses
 
 @dataclasses.dataclass
 class ExecutionContext:
-    program_id: Tuple[int]
+    # the ids of the programs along each axis, one tensor per axis holding the
+    # ids of the programs executed together
+    program_id: Tuple
     program_size: Tuple[int]
+    batched: bool = False
+
+
+class DivergentExecution(Exception):
+    """
+    Raised when the programs executed together take different paths, e.g. a
+    branch on the program id, so that they must be executed one by one.
+    """
+    pass
@@ -1,13 +1,14 @@
 import itertools
+import os
 import random
 from typing import Tuple
 
 import triton
 import triton.language as tl
-from .core import ExecutionContext
+from .core import DivergentExecution, ExecutionContext
 from .memory_map import MemoryMap
 from .tl_lang import (TritonLangProxy, WrappedTensor, _primitive_to_tensor,
-                      debugger_constexpr)
+                      debugger_constexpr, set_device)
 from triton.debugger import torch_wrapper
 
 torch = torch_wrapper.torch
@@ -83,12 +84,15 @@ class DebuggerFunction:
         self._assert_constexpr(**kwargs)
 
         memory = MemoryMap()
+        tensors = [v for v in list(args) + list(kwargs.values()) if torch.is_tensor(v)]
+        device = tensors[0].device if tensors else ("cuda" if torch.cuda.is_available() else "cpu")
+        set_device(device)
 
         def convert_arg(v):
             name, arg = v
             if torch.is_tensor(arg):
                 ptr = memory.add_tensor(arg)
-                return WrappedTensor(torch.tensor([ptr], dtype=torch.int64, device="cuda"))
+                return WrappedTensor(torch.tensor([ptr], dtype=torch.int64, device=device))
             if self._is_constexpr(name):
                 return debugger_constexpr(arg)
             return WrappedTensor(_primitive_to_tensor(arg))
@@ -96,13 +100,42 @@ class DebuggerFunction:
         new_args = tuple(map(convert_arg, zip(self.func.__code__.co_varnames, args)))
         new_kwargs = {k: convert_arg((k, v)) for (k, v) in kwargs.items() if k not in ["num_warps", "num_stages"]}
 
-        grid = self._get_grid(**kwargs)
+        grid = tuple(self._get_grid(**kwargs))
+        batch_size = int(os.getenv("TRITON_INTERPRET_BATCH_SIZE", "4096"))
+        if batch_size > 1:
+            snapshot = memory.snapshot()
+            try:
+                self._run_batched(memory, grid, batch_size, device, new_args, new_kwargs)
+                return
+            except DivergentExecution:
+                # undo the stores of the batches and execute the programs one by one
+                memory.restore(snapshot)
         for program_id in program_ids_from_grid(grid):
-            proxy = TritonLangProxy(memory, ExecutionContext(program_id, grid))
-            attach_triton(tl, proxy)
-            self.func(*new_args, **new_kwargs)
+            program_id = tuple(torch.tensor([i], dtype=torch.int32, device=device) for i in reversed(program_id))
+            self._run(memory, ExecutionContext(program_id, grid), new_args, new_kwargs)
+
+    def _run(self, memory, context, args, kwargs):
+        proxy = TritonLangProxy(memory, context)
+        attach_triton(tl, proxy)
+        try:
+            self.func(*args, **kwargs)
+        finally:
             detach_triton(tl)
 
+    def _run_batched(self, memory, grid, batch_size, device, args, kwargs):
+        # executes up to batch_size programs together, the program ids being
+        # the leading dimension of the tensors
+        num_programs = 1
+        for size in grid:
+            num_programs *= size
+        for start in range(0, num_programs, batch_size):
+            linear = torch.arange(start, min(start + batch_size, num_programs), dtype=torch.int32, device=device)
+            program_id = []
+            for size in grid:
+                program_id.append(linear % size)
+                linear = linear // size
+            self._run(memory, ExecutionContext(tuple(program_id), grid, batched=True), args, kwargs)
+
 
 class GridSelector:
     """
@@ -50,45 +50,52 @@ class MemoryMap:
         self.storages.append(RegisteredStorage(storage, t.dtype, storage.size(), storage.data_ptr()))
         return t.data_ptr()
 
+    def snapshot(self):
+        """Copies the registered storages, to undo the stores of an execution."""
+        return [registered.storage.clone() for registered in self.storages]
+
+    def restore(self, snapshot):
+        for registered, storage in zip(self.storages, snapshot):
+            registered.storage.copy_(storage)
+
+    @staticmethod
+    def _broadcast(pointer, mask, *values):
+        # the pointers, the mask and the values of the programs of a batch
+        # broadcast against each other
+        assert pointer.dtype == torch.int64
+        if mask is None:
+            mask = torch.ones_like(pointer).bool()
+        assert mask.dtype == torch.bool
+        tensors = [pointer, mask] + [v for v in values if torch.is_tensor(v)]
+        shape = torch.broadcast_shapes(*(t.shape for t in tensors))
+        return pointer.expand(shape), mask.expand(shape), shape
+
     def load(
         self,
         pointer: torch.Tensor,
         mask: torch.Tensor = None,
         other=0.0,
     ):
-        assert pointer.is_cuda
-        assert 0 < pointer.dim() < 3
-        assert pointer.dtype == torch.int64
-
-        if mask is None:
-            mask = torch.ones_like(pointer).bool()
-        assert mask.is_cuda
-        assert 0 < mask.dim() < 3
-        assert mask.dtype == torch.bool
-        mask = mask.expand(pointer.size())
+        pointer, mask, shape = self._broadcast(pointer, mask, other)
 
         if torch.all(~mask):
             # Todo: The type is wrong here, we can't determine the correct type
-            return torch.full_like(pointer, fill_value=other, dtype=torch.float16, device="cuda")
+            block = torch.empty(shape, dtype=torch.float16, device=pointer.device)
+            block[...] = other
+            return block
 
         registered_storage = self._get_registered_storage(pointer[mask])
         access_tensor = registered_storage.access_tensor
 
         index_tensor = pointer - registered_storage.ptr
 
-        block = torch.full_like(pointer, fill_value=other, dtype=access_tensor.dtype, device="cuda")
+        block = torch.empty(shape, dtype=access_tensor.dtype, device=pointer.device)
+        block[...] = other
         block[mask] = access_tensor[index_tensor[mask]]
         return block
 
     def store(self, pointer: torch.Tensor, value: torch.Tensor, mask=None):
-        assert 0 < pointer.dim() < 3
-        assert pointer.dtype == torch.int64
-
-        if mask is None:
-            mask = torch.ones_like(pointer).bool()
-        assert 0 < mask.dim() < 3
-        assert mask.dtype == torch.bool
-        mask = mask.expand(pointer.size())
+        pointer, mask, shape = self._broadcast(pointer, mask, value)
 
         if torch.all(~mask):
             return
@@ -97,4 +104,57 @@ class MemoryMap:
         access_tensor = registered_storage.access_tensor
 
         index_tensor = pointer - registered_storage.ptr
+        value = torch.as_tensor(value, device=pointer.device).expand(shape)
         access_tensor[index_tensor[mask]] = value[mask].to(access_tensor.dtype)
+
+    def has_conflicts(self, pointer: torch.Tensor, mask=None):
+        """Returns whether several of the unmasked pointers are the same."""
+        pointer, mask, _ = self._broadcast(pointer, mask)
+        pointer = pointer[mask]
+        return torch.unique(pointer).numel() != pointer.numel()
+
+    def reduce(self, pointer: torch.Tensor, value: torch.Tensor, mask=None, reduce="sum"):
+        """
+        Combines the values into the memory with :code:`reduce`, as atomics
+        would, one element after the other: the programs of a batch in order,
+        then the elements of their blocks. Returns the value of the memory
+        each element was combined with, 0 for the masked elements.
+        """
+        pointer, mask, shape = self._broadcast(pointer, mask, value)
+
+        if torch.all(~mask):
+            # the type is wrong here too, see load
+            return torch.zeros(shape, dtype=torch.float16, device=pointer.device)
+
+        registered_storage = self._get_registered_storage(pointer[mask])
+        access_tensor = registered_storage.access_tensor
+
+        index_tensor = (pointer - registered_storage.ptr)[mask]
+        value = torch.as_tensor(value, device=pointer.device).expand(shape)[mask].to(access_tensor.dtype)
+        combine = {"sum": torch.add, "amax": torch.maximum, "amin": torch.minimum}[reduce]
+        # the elements of each address, in order, combine the values of the
+        # elements before them: an inclusive scan of the sorted addresses
+        index_sorted, order = torch.sort(index_tensor, stable=True)
+        scan = value[order]
+        step = 1
+        while step < scan.numel():
+            same = index_sorted[step:] == index_sorted[:-step]
+            combined = combine(scan[step:], scan[:-step])
+            scan = torch.cat([scan[:step], torch.where(same, combined, scan[step:])])
+            step *= 2
+        initial = access_tensor[index_sorted]
+        has_prev = torch.zeros_like(index_sorted, dtype=torch.bool)
+        has_prev[1:] = index_sorted[1:] == index_sorted[:-1]
+        prev = torch.zeros_like(scan)
+        prev[1:] = scan[:-1]
+        old_sorted = torch.where(has_prev, combine(initial, prev), initial)
+        old = torch.empty_like(old_sorted)
+        old[order] = old_sorted
+
+        if reduce == "sum":
+            access_tensor.index_put_((index_tensor, ), value, accumulate=True)
+        else:
+            access_tensor.scatter_reduce_(0, index_tensor, value, reduce=reduce)
+        block = torch.zeros(shape, dtype=access_tensor.dtype, device=pointer.device)
+        block[mask] = old
+        return block
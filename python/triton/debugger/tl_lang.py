@@ -1,16 +1,29 @@
 import triton
-from .core import ExecutionContext
+from .core import DivergentExecution, ExecutionContext
 from .memory_map import MemoryMap
 from triton.debugger import torch_wrapper
 
 torch = torch_wrapper.torch
 
+# The tensors of the interpreted programs have a leading dimension over the
+# programs executed together; the scalars are tensors of one element per
+# program and the blocks of shape S are tensors of shape [programs, *S]. The
+# values shared by the programs have a leading dimension of 1.
+
+# the device of the tensors of the kernel being interpreted
+_device = "cuda"
+
+
+def set_device(device):
+    global _device
+    _device = device
+
 
 def _primitive_to_tensor(x):
     """
     Converts various Python primitive data types to PyTorch tensor.
     """
-    tensor_args = {"device": "cuda"}
+    tensor_args = {"device": _device}
     if isinstance(x, bool):
         return torch.tensor([x], dtype=torch.bool, **tensor_args)
     elif isinstance(x, int):
@@ -50,10 +63,30 @@ def _infer_tensor(func):
     return wrapper
 
 
+def _align(tensors):
+    """
+    Inserts unit dimensions after the leading program dimension of the tensors
+    so that their block dimensions broadcast against each other.
+    """
+    tensors = [t.reshape(1) if t.dim() == 0 else t for t in tensors]
+    rank = max(t.dim() for t in tensors)
+    return [t.reshape(t.shape[:1] + (1, ) * (rank - t.dim()) + t.shape[1:]) for t in tensors]
+
+
+def _reduce(fn, input, axis):
+    # the reductions of the blocks of each program
+    if input.dim() == 1:
+        return input
+    if axis is None:
+        return fn(input.reshape(input.shape[0], -1), dim=1)
+    return fn(input, dim=axis if axis < 0 else axis + 1)
+
+
 def _tensor_operation(func):
     """
     A decorator function to unwrap WrappedTensors and debugger_constexpr before calling the function.
     Can be combined with _infer_tensor decorator to harmonize args (everything to torch tensor).
+    The tensors are aligned on their leading program dimension.
     """
     def wrapper(*args, **kwargs):
         for arg in args:
@@ -66,10 +99,19 @@ def _tensor_operation(func):
                 return v.value
             return v
 
-        new_args = tuple(map(unwrap_tensor, args))
+        new_args = list(map(unwrap_tensor, args))
         new_kwargs = {k: unwrap_tensor(v) for k, v in kwargs.items()}
-
-        result = func(args[0], *new_args[1:], **new_kwargs)
+        positions = [i for i, v in enumerate(new_args) if torch.is_tensor(v)]
+        names = [k for k, v in new_kwargs.items() if torch.is_tensor(v)]
+        aligned = _align([new_args[i] for i in positions] + [new_kwargs[k] for k in names]) \
+            if positions or names else []
+        for i, t in zip(positions, aligned):
+            new_args[i] = t
+        for k, t in zip(names, aligned[len(positions):]):
+            new_kwargs[k] = t
+
+        this = WrappedTensor(new_args[0]) if isinstance(args[0], WrappedTensor) else args[0]
+        result = func(this, *new_args[1:], **new_kwargs)
         return WrappedTensor(result) if torch.is_tensor(result) else result
 
     return wrapper
@@ -143,14 +185,20 @@ class WrappedTensor:
     def __init__(self, tensor):
         self.tensor = tensor
 
+    def _uniform(self):
+        # the value of the first program, the programs must agree on it
+        if self.tensor.dim() > 0 and self.tensor.shape[0] > 1 and not torch.all(self.tensor == self.tensor[:1]):
+            raise DivergentExecution("the programs take different paths")
+        return self.tensor[0] if self.tensor.dim() > 0 else self.tensor
+
     def __index__(self) -> int:
-        return self.tensor.item()
+        return self._uniform().item()
 
     def __str__(self) -> str:
         return "wrapped_" + str(self.tensor)
 
     def __bool__(self) -> bool:
-        return torch.all(self.tensor == True).item()  # noqa: E712
+        return torch.all(self._uniform() == True).item()  # noqa: E712
 
     @property
     def dtype(self):
@@ -294,16 +342,19 @@ class WrappedTensor:
     @_infer_tensor
     @_tensor_operation
     def __eq__(self, other):
-        return torch.equal(self.tensor, other)
+        return self.tensor == other
 
     @_infer_tensor
     @_tensor_operation
     def __ne__(self, other):
-        return not torch.equal(self.tensor, other)
+        return self.tensor != other
 
     @_tensor_operation
     def __getitem__(self, slices):
-        return self.tensor.__getitem__(slices)
+        if not isinstance(slices, tuple):
+            slices = (slices, )
+        # keep the program dimension
+        return self.tensor.__getitem__((slice(None), ) + slices)
         # if isinstance(slices, slice):
         #     slices = [slices]
         # src_shape = self.shape
@@ -368,16 +419,16 @@ class TritonLangProxy:
     @_tensor_operation
     def program_id(self, axis):
         assert axis < len(self._context.program_id)
-        return torch.tensor([self._context.program_id[axis]], dtype=torch.int32, device="cuda")
+        return self._context.program_id[axis]
 
     @_tensor_operation
     def num_programs(self, axis):
         assert axis < len(self._context.program_size)
-        return torch.tensor([self._context.program_size[axis]], dtype=torch.int32, device="cuda")
+        return torch.tensor([self._context.program_size[axis]], dtype=torch.int32, device=_device)
 
     @_tensor_operation
     def arange(self, start, end):
-        return torch.arange(start=start, end=end, dtype=torch.int32, device="cuda")
+        return torch.arange(start=start, end=end, dtype=torch.int32, device=_device)[None]
 
     @_tensor_operation
     def zeros(self, shape, dtype):
@@ -402,7 +453,7 @@ class TritonLangProxy:
                 dtype = torch.int8
             else:
                 raise TypeError(f"Unsupported dtype {dtype}")
-        return torch.zeros(size=shape, dtype=dtype, device="cuda")
+        return torch.zeros(size=[1] + shape, dtype=dtype, device=_device)
 
     @_tensor_operation
     def dequantize(self, input, scale, shift, nbit, dst_ty=torch.float16):
@@ -428,72 +479,68 @@ class TritonLangProxy:
     def dot(self, input, other, trans_a=False, trans_b=False, allow_tf32=True):
         assert input.dtype == other.dtype
         if trans_a:
-            input = input.T
+            input = input.transpose(-1, -2)
         if trans_b:
-            other = other.T
+            other = other.transpose(-1, -2)
         return torch.matmul(input=input, other=other)
 
+    def _check_conflicts(self, pointer, mask=None):
+        # the atomics of several programs on the same address depend on their
+        # order, which only the sequential execution reproduces
+        if self._context.batched and self._memory_map.has_conflicts(pointer, mask):
+            raise DivergentExecution("the programs update the same address")
+
+    def _atomic_reduce(self, pointer, val, mask, reduce):
+        # the memory map orders the programs of a batch on the addresses they
+        # share, so each of them sees the value its predecessors left
+        return self._memory_map.reduce(pointer, val, mask, reduce)
+
+    def _atomic_binary(self, pointer, val, mask, op):
+        self._check_conflicts(pointer, mask)
+        stored = self._memory_map.load(pointer, mask, 0)
+        self._memory_map.store(pointer, op(stored, val), mask)
+        return stored
+
     @_tensor_operation
     def atomic_cas(self, pointer, cmp, val):
+        self._check_conflicts(pointer)
         stored = self._memory_map.load(pointer, None, 0.0)
         if not isinstance(cmp, torch.Tensor):
-            cmp = torch.tensor([cmp], dtype=stored.dtype, device="cuda")
+            cmp = torch.tensor([cmp], dtype=stored.dtype, device=_device)
         if not isinstance(val, torch.Tensor):
-            val = torch.tensor([val], dtype=stored.dtype, device="cuda")
-        if stored == cmp:
-            self._memory_map.store(pointer, val, None)
+            val = torch.tensor([val], dtype=stored.dtype, device=_device)
+        self._memory_map.store(pointer, torch.where(stored == cmp, val.to(stored.dtype), stored), None)
         return stored
 
     @_tensor_operation
     def atomic_xchg(self, pointer, val, mask=None):
         if isinstance(val, int):
-            val = torch.tensor([val], dtype=torch.int32, device="cuda")
-        stored = self._memory_map.load(pointer, mask, 0.0)
-        self._memory_map.store(pointer, val, mask)
-        return stored
+            val = torch.tensor([val], dtype=torch.int32, device=_device)
+        return self._atomic_binary(pointer, val, mask, lambda stored, val: val)
 
     @_tensor_operation
     def atomic_add(self, pointer, val, mask=None):
-        # arbitrary other value as it will masked during storing
-        stored = self._memory_map.load(pointer, mask, 0.0)
-        result = stored + val
-        self._memory_map.store(pointer, result, mask)
-        return stored
+        return self._atomic_reduce(pointer, val, mask, "sum")
 
     @_tensor_operation
     def atomic_max(self, pointer, val, mask=None):
-        stored = self._memory_map.load(pointer, mask, 0.0)
-        result = torch.maximum(stored, val)
-        self._memory_map.store(pointer, result, mask)
-        return stored
+        return self._atomic_reduce(pointer, val, mask, "amax")
 
     @_tensor_operation
     def atomic_min(self, pointer, val, mask=None):
-        stored = self._memory_map.load(pointer, mask, 0.0)
-        result = torch.minimum(stored, val)
-        self._memory_map.store(pointer, result, mask)
-        return stored
+        return self._atomic_reduce(pointer, val, mask, "amin")
 
     @_tensor_operation
     def atomic_and(self, pointer, val, mask=None):
-        stored = self._memory_map.load(pointer, mask, 0)
-        result = torch.bitwise_and(stored, val)
-        self._memory_map.store(pointer, result, mask)
-        return stored
+        return self._atomic_binary(pointer, val, mask, torch.bitwise_and)
 
     @_tensor_operation
     def atomic_or(self, pointer, val, mask=None):
-        stored = self._memory_map.load(pointer, mask, 0)
-        result = torch.bitwise_or(stored, val)
-        self._memory_map.store(pointer, result, mask)
-        return stored
+        return self._atomic_binary(pointer, val, mask, torch.bitwise_or)
 
     @_tensor_operation
     def atomic_xor(self, pointer, val, mask=None):
-        stored = self._memory_map.load(pointer, mask, 0)
-        result = torch.bitwise_xor(stored, val)
-        self._memory_map.store(pointer, result, mask)
-        return stored
+        return self._atomic_binary(pointer, val, mask, torch.bitwise_xor)
 
     @_tensor_operation
     def where(self, condition, x, y):
@@ -560,10 +607,7 @@ class TritonLangProxy:
 
     @_tensor_operation
     def minimum(self, x, y):
-        if isinstance(x, int):
-            x = torch.tensor(x, device="cuda")
-        if isinstance(y, int):
-            y = torch.tensor(y, device="cuda")
+        x, y = _align([_primitive_to_tensor(x), _primitive_to_tensor(y)])
         return torch.minimum(x, y)
 
     @_tensor_operation
@@ -592,9 +636,7 @@ class TritonLangProxy:
 
     @_tensor_operation
     def max(self, input, axis=None):
-        if axis is None:
-            return torch.max(input)
-        return torch.max(input, dim=axis).values
+        return _reduce(torch.amax, input, axis)
 
     @_tensor_operation
     def argmax(self, input, axis):
@@ -602,9 +644,7 @@ class TritonLangProxy:
 
     @_tensor_operation
     def min(self, input, axis=None):
-        if axis is None:
-            return torch.min(input)
-        return torch.min(input, dim=axis).values
+        return _reduce(torch.amin, input, axis)
 
     @_tensor_operation
     def argmin(self, input, axis):
@@ -612,9 +652,7 @@ class TritonLangProxy:
 
     @_tensor_operation
     def sum(self, input, axis=None):
-        if axis is None:
-            return torch.sum(input)
-        return torch.sum(input, dim=axis)
+        return _reduce(torch.sum, input, axis)
 
     @_tensor_operation
     def xor_sum(self, input, axis):
@@ -5,10 +5,14 @@ from . import math
 from . import extra
 from .standard import (
     cdiv,
+    grid_sum,
+    multi_tensor_chunk,
     sigmoid,
     softmax,
     ravel,
+    signal,
     swizzle2d,
+    wait,
     zeros,
     zeros_like,
 )
@@ -18,6 +22,9 @@ from .core import (
     arange,
     argmin,
     argmax,
+    associative_scan,
+    async_copy,
+    async_wait,
     atomic_add,
     atomic_and,
     atomic_cas,
@@ -33,6 +40,8 @@ from .core import (
     cat,
     constexpr,
     cos,
+    cumprod,
+    cumsum,
     debug_barrier,
     device_assert,
     device_print,
@@ -41,6 +50,7 @@ from .core import (
     exp,
     expand_dims,
     full,
+    histogram,
     fdiv,
     float16,
     float32,
@@ -48,6 +58,7 @@ from .core import (
     float8e4,
     float8e5,
     function_type,
+    inline_asm_elementwise,
     int1,
     int16,
     int32,
@@ -66,9 +77,16 @@ from .core import (
     pi32_t,
     pointer_type,
     program_id,
+    range,
     reduce,
     reshape,
+    semaphore_signal,
+    semaphore_wait,
+    shared_block_type,
     sin,
+    smem_alloc,
+    smem_load,
+    sort,
     sqrt,
     static_assert,
     static_print,
@@ -76,6 +94,7 @@ from .core import (
     sum,
     static_range,
     tensor,
+    topk,
     trans,
     triton,
     uint16,
@@ -89,6 +108,7 @@ from .core import (
     xor_sum,
 )
 from .random import (
+    dropout,
     pair_uniform_to_normal,
     philox,
     philox_impl,
@@ -108,6 +128,9 @@ __all__ = [
     "arange",
     "argmin",
     "argmax",
+    "associative_scan",
+    "async_copy",
+    "async_wait",
     "atomic_add",
     "atomic_and",
     "atomic_cas",
@@ -125,10 +148,13 @@ __all__ = [
     "cdiv",
     "constexpr",
     "cos",
+    "cumprod",
+    "cumsum",
     "debug_barrier",
     "device_assert",
     "device_print",
     "dot",
+    "dropout",
     "dtype",
     "exp",
     "expand_dims",
@@ -140,7 +166,10 @@ __all__ = [
     "float8e4",
     "float8e5",
     "full",
+    "histogram",
     "function_type",
+    "grid_sum",
+    "inline_asm_elementwise",
     "int1",
     "int16",
     "int32",
@@ -156,6 +185,7 @@ __all__ = [
     "maximum",
     "min",
     "minimum",
+    "multi_tensor_chunk",
     "multiple_of",
     "num_programs",
     "pair_uniform_to_normal",
@@ -170,12 +200,20 @@ __all__ = [
     "randint4x",
     "randn",
     "randn4x",
+    "range",
     "ravel",
     "reduce",
     "reshape",
+    "semaphore_signal",
+    "semaphore_wait",
+    "shared_block_type",
     "sigmoid",
+    "signal",
     "sin",
+    "smem_alloc",
+    "smem_load",
     "softmax",
+    "sort",
     "sqrt",
     "static_range",
     "static_assert",
@@ -184,6 +222,7 @@ __all__ = [
     "sum",
     "swizzle2d",
     "tensor",
+    "topk",
     "trans",
     "triton",
     "uint16",
@@ -194,6 +233,7 @@ __all__ = [
     "umulhi",
     "view",
     "void",
+    "wait",
     "where",
     "xor_sum",
     "zeros",
@@ -1,5 +1,6 @@
 from __future__ import annotations
 
+import builtins
 from contextlib import contextmanager
 from enum import Enum
 from functools import wraps
@@ -13,6 +14,10 @@ T = TypeVar('T')
 
 TRITON_MAX_TENSOR_NUMEL = 131072
 
+# The address space of the pointers to the parameter tables of a kernel (see
+# `triton.ParamTable`), the parameter space of the NVPTX backend
+PARAM_ADDRESS_SPACE = 101
+
 TRITON_BUILTIN = "__triton_builtin__"
 
 
@@ -237,6 +242,8 @@ class dtype:
 
 class pointer_type(dtype):
     def __init__(self, element_ty: dtype, address_space: int = 1):
+        # e.g. the dtype of a constexpr argument of a kernel
+        element_ty = _constexpr_to_value(element_ty)
         if not isinstance(element_ty, dtype):
             raise TypeError('element_ty is a {type(element_ty).__name__}.')
         self.element_ty = element_ty
@@ -245,7 +252,7 @@ class pointer_type(dtype):
         self.name = self.__str__()
 
     def to_ir(self, builder: ir.builder) -> ir.pointer_type:
-        return builder.get_ptr_ty(self.element_ty.to_ir(builder), 1)
+        return builder.get_ptr_ty(self.element_ty.to_ir(builder), self.address_space)
 
     def __str__(self):
         return f'pointer<{self.element_ty}>'
@@ -256,6 +263,9 @@ class pointer_type(dtype):
     def is_ptr(self):
         return True
 
+    def is_param(self):
+        return self.address_space == PARAM_ADDRESS_SPACE
+
     def __eq__(self, other: pointer_type) -> bool:
         if not isinstance(other, pointer_type):
             return False
@@ -309,6 +319,8 @@ class block_type(dtype):
     def __eq__(self, other: block_type) -> bool:
         if not isinstance(other, block_type):
             return False
+        if isinstance(self, shared_block_type) != isinstance(other, shared_block_type):
+            return False
         return self.element_ty == other.element_ty and self.shape == other.shape
 
     def __ne__(self, other: block_type) -> bool:
@@ -319,6 +331,16 @@ class block_type(dtype):
         return self.element_ty
 
 
+class shared_block_type(block_type):
+    # The buffers of shared memory of `smem_alloc`: `shape[0]` stages of a
+    # tile of `shape[1:]`
+    def to_ir(self, builder: ir.builder) -> ir.block_type:
+        return builder.get_shared_block_ty(self.element_ty.to_ir(builder), self.shape)
+
+    def __str__(self):
+        return f'<shared {self.shape}, {self.element_ty}>'
+
+
 class function_type(dtype):
     def __init__(self, ret_types: List[dtype], param_types: List[dtype]) -> None:
         self.ret_types = ret_types
@@ -924,20 +946,38 @@ def expand_dims(input, axis, _builder=None):
 
 
 @builtin
-def dot(input, other, allow_tf32=True, out_dtype=float32, _builder=None):
+def dot(input, other, allow_tf32=True, out_dtype=float32, input_precision=None, sparse_meta=None, _builder=None):
     """
     Returns the matrix product of two blocks.
 
     The two blocks must be two-dimensional and have compatible inner dimensions.
 
+    With :code:`sparse_meta`, :code:`input` is a 2:4 structured-sparse block, each group of 4 consecutive
+    elements of its rows holding at most 2 non-zeros, which is multiplied on the sparse tensor cores of
+    sm_80+. :code:`input` then holds the 2 values of every group, so its shape is :code:`[M, K // 2]`
+    for :code:`other` of shape :code:`[K, N]`, and :code:`sparse_meta` is the :code:`int16` block of their
+    positions, of shape :code:`[M, K // 16]`: its element :code:`(i, j)` describes the 4 groups of the
+    columns :code:`16 * j` to :code:`16 * j + 15` of the row :code:`i` from its low bits, with 4 bits per
+    group, the 2-bit index in the group of its first value then of its second one. :code:`K` must be a
+    multiple of 32, the blocks :code:`float16` or :code:`bfloat16` and the result is :code:`float32`.
+
     :param input: The first tensor to be multiplied.
     :type input: 2D tensor of scalar-type in {:code:`float16`, :code:`bfloat16`, :code:`float32`}
     :param other: The second tensor to be multiplied.
     :type other: 2D tensor of scalar-type in {:code:`float16`, :code:`bfloat16`, :code:`float32`}
+    :param input_precision: How to multiply :code:`float32` blocks, overriding :code:`allow_tf32`:
+        :code:`"tf32"` on TF32 tensor cores, :code:`"ieee"` in fp32, or :code:`"tf32x3"` with three
+        TF32 products of the high and low parts of the operands, which is about as accurate as fp32
+        and runs on tensor cores.
+    :type input_precision: str, optional
+    :param sparse_meta: The positions of the values of a 2:4 structured-sparse :code:`input`.
+    :type sparse_meta: 2D tensor of :code:`int16`, optional
     """
     allow_tf32 = _constexpr_to_value(allow_tf32)
     out_dtype = _constexpr_to_value(out_dtype)
-    return semantic.dot(input, other, allow_tf32, out_dtype, _builder)
+    input_precision = _constexpr_to_value(input_precision)
+    sparse_meta = _constexpr_to_value(sparse_meta)
+    return semantic.dot(input, other, allow_tf32, out_dtype, _builder, input_precision, sparse_meta)
 
 
 # -----------------------
@@ -947,7 +987,7 @@ def dot(input, other, allow_tf32=True, out_dtype=float32, _builder=None):
 
 @builtin
 def load(pointer, mask=None, other=None, boundary_check=tuple(), padding_option="", cache_modifier="",
-         eviction_policy="", volatile=False, _builder=None):
+         eviction_policy="", volatile=False, sem=None, scope=None, _builder=None):
     """
     Return a tensor of data whose values are loaded from memory at location defined by `pointer`:
         (1) `pointer` could be a single element pointer, then a scalar will be loaded
@@ -972,12 +1012,21 @@ def load(pointer, mask=None, other=None, boundary_check=tuple(), padding_option=
     :param boundary_check: tuple of integers, indicating the dimensions which should do the boundary check
     :type boundary_check: tuple of ints, optional
     :param padding_option: should be one of {"", "zero", "nan"}, do padding while out of bound
-    :param cache_modifier: changes cache option in NVIDIA PTX
+    :param cache_modifier: changes cache option in NVIDIA PTX: ".ca", ".cg" or ".cs" (streaming, for data read
+        once)
     :type cache_modifier: str, optional
-    :param eviction_policy: changes eviction policy in NVIDIA PTX
+    :param eviction_policy: changes eviction policy in NVIDIA PTX. "evict_first", "evict_last" and "no_allocate" are
+        L1 hints; "l2_evict_first" and "l2_evict_last" attach an L2 cache policy to the access (sm_80+)
     :type eviction_policy: str, optional
     :param volatile: changes volatile option in NVIDIA PTX
     :type volatile: bool, optional
+    :param sem: orders the load with the other memory accesses: "relaxed" or "acquire", e.g. to read the data
+        released by the programs of a peer device. Cannot be combined with :code:`cache_modifier` or
+        :code:`volatile`, nor used with block pointers.
+    :type sem: str, optional
+    :param scope: the scope the load is ordered at: "cta", "gpu" (the default) or "sys", for the memory of the
+        host or of the peer devices
+    :type scope: str, optional
     """
     # `mask` and `other` can be constexpr
     if _constexpr_to_value(mask) is not None:
@@ -988,12 +1037,15 @@ def load(pointer, mask=None, other=None, boundary_check=tuple(), padding_option=
     cache_modifier = _constexpr_to_value(cache_modifier)
     eviction_policy = _constexpr_to_value(eviction_policy)
     volatile = _constexpr_to_value(volatile)
+    sem = _constexpr_to_value(sem)
+    scope = _constexpr_to_value(scope)
     return semantic.load(pointer, mask, other, boundary_check, padding_option, cache_modifier, eviction_policy,
-                         volatile, _builder)
+                         volatile, sem, scope, _builder)
 
 
 @builtin
-def store(pointer, value, mask=None, boundary_check=(), cache_modifier="", eviction_policy="", _builder=None):
+def store(pointer, value, mask=None, boundary_check=(), cache_modifier="", eviction_policy="", sem=None, scope=None,
+          _builder=None):
     """
     Store a tensor of data into memory locations defined by `pointer`:
         (1) `pointer` could be a single element pointer, then a scalar will be stored
@@ -1015,10 +1067,19 @@ def store(pointer, value, mask=None, boundary_check=(), cache_modifier="", evict
     :type mask: Block of triton.int1, optional
     :param boundary_check: tuple of integers, indicating the dimensions which should do the boundary check
     :type boundary_check: tuple of ints, optional
-    :param cache_modifier: changes cache option in NVIDIA PTX
+    :param cache_modifier: changes cache option in NVIDIA PTX: ".wb", ".cg", ".cs" (streaming, for outputs that
+        are not read again soon, so that they do not evict the inputs from the caches) or ".wt"
     :type cache_modifier: str, optional
-    :param eviction_policy: changes eviction policy in NVIDIA PTX
+    :param eviction_policy: changes eviction policy in NVIDIA PTX. "evict_first", "evict_last" and "no_allocate" are
+        L1 hints, which cannot be combined with :code:`cache_modifier`; "l2_evict_first" and "l2_evict_last"
+        attach an L2 cache policy to the access (sm_80+)
     :type eviction_policy: str, optional
+    :param sem: orders the store with the other memory accesses: "relaxed" or "release", e.g. to publish data to
+        the programs of a peer device. Cannot be combined with :code:`cache_modifier`, nor used with block pointers.
+    :type sem: str, optional
+    :param scope: the scope the store is ordered at: "cta", "gpu" (the default) or "sys", for the memory of the
+        host or of the peer devices
+    :type scope: str, optional
     """
     # `value` can be constexpr
     value = _to_tensor(value, _builder)
@@ -1026,7 +1087,10 @@ def store(pointer, value, mask=None, boundary_check=(), cache_modifier="", evict
         mask = _to_tensor(mask, _builder)
     cache_modifier = _constexpr_to_value(cache_modifier)
     eviction_policy = _constexpr_to_value(eviction_policy)
-    return semantic.store(pointer, value, mask, boundary_check, cache_modifier, eviction_policy, _builder)
+    sem = _constexpr_to_value(sem)
+    scope = _constexpr_to_value(scope)
+    return semantic.store(pointer, value, mask, boundary_check, cache_modifier, eviction_policy, sem, scope,
+                          _builder)
 
 
 @builtin
@@ -1054,6 +1118,104 @@ def advance(base: tensor, offsets, _builder=None):
     """
     return semantic.advance(base, offsets, _builder)
 
+# -----------------------
+# Shared Memory Operations
+# -----------------------
+
+
+@builtin
+def smem_alloc(shape, dtype, stages=1, _builder=None):
+    """
+    Returns a buffer of shared memory of :code:`stages` tiles of the given
+    :code:`shape` and :code:`dtype`, for the kernels that pipeline their
+    loads by hand rather than leaving it to :code:`num_stages`.
+
+    The tiles are written by :code:`async_copy` and read by
+    :code:`smem_load`. The buffer is accounted for in the shared memory of the
+    kernel, like the buffers of the compiler.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        buf = tl.smem_alloc((BLOCK_M, BLOCK_K), tl.float16, stages=2)
+        buf = tl.async_copy(buf, 0, a_ptrs)
+        for k in range(0, K, BLOCK_K):
+            a_ptrs += BLOCK_K
+            buf = tl.async_copy(buf, (k // BLOCK_K + 1) % 2, a_ptrs, mask=k + BLOCK_K < K)
+            tl.async_wait(1)
+            a = tl.smem_load(buf, (k // BLOCK_K) % 2)
+            acc += tl.dot(a, b)
+
+    :param shape: the shape of a tile, 2D
+    :type shape: tuple of ints
+    :param dtype: the element type of the tiles
+    :type dtype: dtype
+    :param stages: the number of tiles of the buffer
+    :type stages: int
+    """
+    shape = _shape_check_impl(shape)
+    dtype = _constexpr_to_value(dtype)
+    stages = _constexpr_to_value(stages)
+    return semantic.smem_alloc(shape, dtype, stages, _builder)
+
+
+@builtin
+def async_copy(buffer, index, pointer, mask=None, _builder=None):
+    """
+    Starts to copy the tensor at the locations of :code:`pointer` into the
+    tile :code:`index` of :code:`buffer`, asynchronously, and returns the
+    buffer holding the copy, which must replace :code:`buffer` for the copy
+    to be kept. The copy completes after a matching :code:`async_wait`.
+
+    Each copy is a group of its own for :code:`async_wait`. The elements
+    where :code:`mask` is false are filled with zeros. The accesses of each
+    thread must be at least 32 bits wide, e.g. of contiguous pointers, which
+    requires an NVIDIA GPU with compute capability 8.0 or more.
+
+    :param buffer: a buffer of :code:`smem_alloc`
+    :param index: the tile of the buffer copied into
+    :type index: int32
+    :param pointer: the locations copied from, of the shape of a tile
+    :type pointer: Block of dtype=triton.PointerType
+    :param mask: if :code:`mask[idx]` is false, do not read :code:`pointer[idx]`
+    :type mask: Block of triton.int1, optional
+    """
+    index = _to_tensor(index, _builder)
+    if _constexpr_to_value(mask) is not None:
+        mask = _to_tensor(mask, _builder)
+    return semantic.async_copy(buffer, index, pointer, mask, _builder)
+
+
+@builtin
+def async_wait(num_pending=0, _builder=None):
+    """
+    Waits until at most :code:`num_pending` of the copies of
+    :code:`async_copy` of the program are in flight, in their issue order.
+
+    :param num_pending: the number of the last copies not waited for
+    :type num_pending: int
+    """
+    num_pending = _constexpr_to_value(num_pending)
+    return semantic.async_wait(num_pending, _builder)
+
+
+@builtin
+def smem_load(buffer, index, _builder=None):
+    """
+    Returns the tile :code:`index` of :code:`buffer`, from shared memory.
+
+    The compiler chooses the layout of the result in registers from its uses:
+    a tile used as an operand of :code:`dot` is read into the layout of the
+    operand directly.
+
+    :param buffer: a buffer of :code:`smem_alloc`
+    :param index: the tile of the buffer to load
+    :type index: int32
+    """
+    index = _to_tensor(index, _builder)
+    return semantic.smem_load(buffer, index, _builder)
+
+
 # -----------------------
 # Atomic Memory Operations
 # -----------------------
@@ -1073,6 +1235,12 @@ def _add_atomic_docstr(name: str) -> Callable[[T], T]:
     :type cmp: Block of dtype=`pointer.dtype.element_ty`
     :param val: The values to copy in case the expected value matches the contained value.
     :type val: Block of dtype=`pointer.dtype.element_ty`
+    :param sem: orders the atomic with the other memory accesses: "relaxed" (the default), "acquire", "release"
+        or "acq_rel"
+    :type sem: str, optional
+    :param scope: the scope of the atomic: "cta", "gpu" (the default) or "sys", e.g. for a flag in the memory of
+        the host or of a peer device
+    :type scope: str, optional
     """
         func.__doc__ = docstr.format(name=name)
         return func
@@ -1082,59 +1250,122 @@ def _add_atomic_docstr(name: str) -> Callable[[T], T]:
 
 @builtin
 @_add_atomic_docstr("compare-and-swap")
-def atomic_cas(pointer, cmp, val, _builder=None):
+def atomic_cas(pointer, cmp, val, sem=None, scope=None, _builder=None):
     cmp = _to_tensor(cmp, _builder)
     val = _to_tensor(val, _builder)
-    return semantic.atomic_cas(pointer, cmp, val, _builder)
+    sem = _constexpr_to_value(sem)
+    scope = _constexpr_to_value(scope)
+    return semantic.atomic_cas(pointer, cmp, val, sem, scope, _builder)
 
 
 @builtin
 @_add_atomic_docstr("exchange")
-def atomic_xchg(pointer, val, mask=None, _builder=None):
+def atomic_xchg(pointer, val, mask=None, sem=None, scope=None, _builder=None):
     val = _to_tensor(val, _builder)
-    return semantic.atomic_xchg(pointer, val, mask, _builder)
+    sem = _constexpr_to_value(sem)
+    scope = _constexpr_to_value(scope)
+    return semantic.atomic_xchg(pointer, val, mask, sem, scope, _builder)
 
 
 @builtin
 @_add_atomic_docstr("add")
-def atomic_add(pointer, val, mask=None, _builder=None):
+def atomic_add(pointer, val, mask=None, sem=None, scope=None, _builder=None):
     val = _to_tensor(val, _builder)
-    return semantic.atomic_add(pointer, val, mask, _builder)
+    sem = _constexpr_to_value(sem)
+    scope = _constexpr_to_value(scope)
+    return semantic.atomic_add(pointer, val, mask, sem, scope, _builder)
 
 
 @builtin
 @_add_atomic_docstr("max")
-def atomic_max(pointer, val, mask=None, _builder=None):
+def atomic_max(pointer, val, mask=None, sem=None, scope=None, _builder=None):
     val = _to_tensor(val, _builder)
-    return semantic.atomic_max(pointer, val, mask, _builder)
+    sem = _constexpr_to_value(sem)
+    scope = _constexpr_to_value(scope)
+    return semantic.atomic_max(pointer, val, mask, sem, scope, _builder)
 
 
 @builtin
 @_add_atomic_docstr("min")
-def atomic_min(pointer, val, mask=None, _builder=None):
+def atomic_min(pointer, val, mask=None, sem=None, scope=None, _builder=None):
     val = _to_tensor(val, _builder)
-    return semantic.atomic_min(pointer, val, mask, _builder)
+    sem = _constexpr_to_value(sem)
+    scope = _constexpr_to_value(scope)
+    return semantic.atomic_min(pointer, val, mask, sem, scope, _builder)
 
 
 @builtin
 @_add_atomic_docstr("logical and")
-def atomic_and(pointer, val, mask=None, _builder=None):
+def atomic_and(pointer, val, mask=None, sem=None, scope=None, _builder=None):
     val = _to_tensor(val, _builder)
-    return semantic.atomic_and(pointer, val, mask, _builder)
+    sem = _constexpr_to_value(sem)
+    scope = _constexpr_to_value(scope)
+    return semantic.atomic_and(pointer, val, mask, sem, scope, _builder)
 
 
 @builtin
 @_add_atomic_docstr("logical or")
-def atomic_or(pointer, val, mask=None, _builder=None):
+def atomic_or(pointer, val, mask=None, sem=None, scope=None, _builder=None):
     val = _to_tensor(val, _builder)
-    return semantic.atomic_or(pointer, val, mask, _builder)
+    sem = _constexpr_to_value(sem)
+    scope = _constexpr_to_value(scope)
+    return semantic.atomic_or(pointer, val, mask, sem, scope, _builder)
 
 
 @builtin
 @_add_atomic_docstr("logical xor")
-def atomic_xor(pointer, val, mask=None, _builder=None):
+def atomic_xor(pointer, val, mask=None, sem=None, scope=None, _builder=None):
     val = _to_tensor(val, _builder)
-    return semantic.atomic_xor(pointer, val, mask, _builder)
+    sem = _constexpr_to_value(sem)
+    scope = _constexpr_to_value(scope)
+    return semantic.atomic_xor(pointer, val, mask, sem, scope, _builder)
+
+
+@builtin
+def semaphore_wait(pointer, value, sem="acquire", scope="gpu", _builder=None):
+    """
+    Waits until the int32 semaphore at :code:`pointer` is :code:`value`, e.g. set by
+    :code:`semaphore_signal` in another program.
+
+    A single thread of the program polls the semaphore, backing off with :code:`nanosleep` between the polls, then
+    all the threads of the program synchronize; with the default acquire semantics, their memory accesses after the
+    wait see the accesses of the signaling program before the signal.
+
+    :param pointer: pointer to the scalar int32 semaphore
+    :param value: the value to wait for
+    :param sem: "acquire" (the default) or "relaxed"
+    :type sem: str, optional
+    :param scope: the scope of the signaling programs: "cta", "gpu" (the default) or "sys", for the host or the peer
+        devices
+    :type scope: str, optional
+    """
+    value = _to_tensor(value, _builder)
+    sem = _constexpr_to_value(sem)
+    scope = _constexpr_to_value(scope)
+    return semantic.semaphore_wait(pointer, value, sem, scope, _builder)
+
+
+@builtin
+def semaphore_signal(pointer, value, add=False, sem="release", scope="gpu", _builder=None):
+    """
+    Sets the int32 semaphore at :code:`pointer` to :code:`value`, or adds :code:`value` to it, once all the threads
+    of the program are done with their prior memory accesses. A single thread of the program updates the semaphore.
+
+    :param pointer: pointer to the scalar int32 semaphore
+    :param value: the new value of the semaphore, or the value to add to it
+    :param add: whether to add :code:`value` to the semaphore, e.g. to count the programs done with their part
+    :type add: bool, optional
+    :param sem: "release" (the default) or "relaxed"
+    :type sem: str, optional
+    :param scope: the scope of the waiting programs: "cta", "gpu" (the default) or "sys", for the host or the peer
+        devices
+    :type scope: str, optional
+    """
+    value = _to_tensor(value, _builder)
+    add = _constexpr_to_value(add)
+    sem = _constexpr_to_value(sem)
+    scope = _constexpr_to_value(scope)
+    return semantic.semaphore_signal(pointer, value, add, sem, scope, _builder)
 
 
 # -----------------------
@@ -1292,6 +1523,115 @@ def reduce(input, axis, combine_fn, _builder=None, _generator=None):
     return semantic.reduction(input, axis, make_combine_region, _builder)
 
 
+# -----------------------
+# Scans
+# -----------------------
+
+def _add_scan_docstr(name: str) -> Callable[[T], T]:
+
+    def _decorator(func: T) -> T:
+        docstr = """
+    Returns the {name} of all elements in the :code:`input` tensor along the provided :code:`axis`
+
+    :param input: the input values
+    :param axis: the dimension along which the scan should be done
+    """
+        func.__doc__ = docstr.format(name=name)
+        return func
+
+    return _decorator
+
+
+@builtin
+def associative_scan(input, axis, combine_fn, _builder=None, _generator=None):
+    """Computes the inclusive prefix of :code:`input` tensors along the provided :code:`axis`, combining elements with combine_fn
+
+    :param input: the input tensor, or tuple of tensors
+    :param axis: the dimension along which the scan should be done
+    :param combine_fn: an associative function to combine two groups of scalar tensors (must be marked with @triton.jit)
+
+    """
+    if isinstance(input, tensor):
+        return associative_scan((input,), axis, combine_fn,
+                                _builder=_builder, _generator=_generator)[0]
+
+    def make_combine_region(scan_op):
+        in_scalar_tys = [t.type.scalar for t in input]
+        prototype = function_type(in_scalar_tys, in_scalar_tys * 2)
+
+        region = scan_op.get_region(0)
+        with _insertion_guard(_builder):
+            param_types = [ty.to_ir(_builder) for ty in prototype.param_types]
+            block = _builder.create_block_with_parent(region, param_types)
+            args = [tensor(block.arg(i), ty)
+                    for i, ty in enumerate(prototype.param_types)]
+            results = _generator.call_JitFunction(combine_fn, args, kwargs={})
+            if isinstance(results, tensor):
+                handles = [results.handle]
+            else:
+                handles = [r.handle for r in results]
+            _builder.create_scan_ret(*handles)
+
+    axis = _constexpr_to_value(axis)
+    return semantic.associative_scan(input, axis, make_combine_region, _builder)
+
+
+@builtin
+def sort(input, dim=None, descending=False, _builder=None):
+    """
+    Sorts :code:`input` along :code:`dim` in ascending order.
+
+    :param input: the input tensor, or a tuple of tensors sorted by the values of the first one
+    :param dim: the dimension to sort along, the last one by default. Its size must be a power of 2.
+    :param descending: if set, sorts in descending order
+    """
+    if isinstance(input, tensor):
+        return sort((input,), dim, descending, _builder=_builder)[0]
+    dim = _constexpr_to_value(dim)
+    dim = len(input[0].shape) - 1 if dim is None else dim
+    descending = _constexpr_to_value(descending)
+    return semantic.sort(input, dim, descending, _builder)
+
+
+@builtin
+def topk(input, k, dim=None, _builder=None):
+    """
+    Returns the :code:`k` largest values of :code:`input` along :code:`dim`, in descending order.
+
+    Passing a tuple such as :code:`(x, index)` returns the matching elements of the other tensors
+    as well, e.g. the positions of the largest values.
+
+    :param input: the input tensor, or a tuple of tensors selected by the values of the first one
+    :param k: the number of values to keep, a power of 2
+    :type k: constexpr
+    :param dim: the dimension to select along, the last one by default
+    """
+    if isinstance(input, tensor):
+        return topk((input,), k, dim, _builder=_builder)[0]
+    k = _constexpr_to_value(k)
+    dim = _constexpr_to_value(dim)
+    dim = len(input[0].shape) - 1 if dim is None else dim
+    return semantic.topk(input, k, dim, _builder)
+
+
+@builtin
+def histogram(input, num_bins, _builder=None):
+    """
+    Counts the elements of :code:`input` equal to each integer in [0, :code:`num_bins`).
+    The other values are ignored.
+
+    The bins are counted for the whole program in shared memory. Adding them to a global
+    histogram, e.g. with :code:`tl.atomic_add`, takes a single atomic per bin and program.
+
+    :param input: the input tensor of integers
+    :param num_bins: the number of bins, a power of 2
+    :type num_bins: constexpr
+    :return: a 1-D tensor of :code:`num_bins` int32 counts
+    """
+    num_bins = _constexpr_to_value(num_bins)
+    return semantic.histogram(input, num_bins, _builder)
+
+
 @builtin
 def _promote_reduction_input(t, _builder=None):
     scalar_ty = t.type.scalar
@@ -1316,7 +1656,7 @@ def _argreduce(input, axis, combine_fn, _builder=None, _generator=None):
 
     if len(input.shape) > 1:
         # Broadcast index across the non-reduced axes
-        axes_to_expand = [constexpr(d) for d in range(len(input.shape))]
+        axes_to_expand = [constexpr(d) for d in builtins.range(len(input.shape))]
         del axes_to_expand[axis]
         index = expand_dims(index, axes_to_expand, _builder=_builder)
         index = broadcast_to(index, input.shape, _builder=_builder)
@@ -1428,6 +1768,25 @@ def _xor_combine(a, b):
     return a ^ b
 
 
+@triton.jit
+@_add_scan_docstr("cumsum")
+def cumsum(input, axis=0):
+    input = _promote_reduction_input(input)
+    return associative_scan(input, axis, _sum_combine)
+
+
+@triton.jit
+def _prod_combine(a, b):
+    return a * b
+
+
+@triton.jit
+@_add_scan_docstr("cumprod")
+def cumprod(input, axis=0):
+    input = _promote_reduction_input(input)
+    return associative_scan(input, axis, _prod_combine)
+
+
 @builtin
 @_add_reduction_docstr("xor sum")
 def xor_sum(input, axis, _builder=None, _generator=None):
@@ -1564,6 +1923,39 @@ class static_range:
         raise RuntimeError("static_range can only be used in @triton.jit'd functions")
 
 
+class range:
+    """
+    Iterator that counts upward like Python's :code:`range`, and whose loop
+    is unrolled by the compiler.
+
+    :param unroll: the number of iterations of the body run by each
+        iteration of the unrolled loop; the iterations left over run in a
+        remainder loop, which is not pipelined.
+    :type unroll: int, optional
+    """
+
+    def __init__(self, arg1, arg2=None, step=None, unroll=None):
+        if step is None:
+            self.step = constexpr(1)
+        else:
+            self.step = step
+        if arg2 is None:
+            self.start = constexpr(0)
+            self.end = arg1
+        else:
+            self.start = arg1
+            self.end = arg2
+        self.unroll = _constexpr_to_value(unroll) or 1
+        assert isinstance(self.unroll, int) and self.unroll >= 1, \
+            f"unroll must be a positive integer, got {unroll}"
+
+    def __iter__(self):
+        raise RuntimeError("tl.range can only be used in @triton.jit'd functions")
+
+    def __next__(self):
+        raise RuntimeError("tl.range can only be used in @triton.jit'd functions")
+
+
 # -----------------------
 # Extern functions
 # -----------------------
@@ -1625,7 +2017,7 @@ def extern_elementwise(lib_name: str, lib_path: str, args: list, arg_type_symbol
     all_scalar = True
     ret_shape = None
     arg_types = []
-    for i in range(len(dispatch_args)):
+    for i in builtins.range(len(dispatch_args)):
         dispatch_args[i] = _to_tensor(dispatch_args[i], _builder)
         arg_types.append(dispatch_args[i].dtype)
         if dispatch_args[i].type.is_block():
@@ -1642,7 +2034,7 @@ def extern_elementwise(lib_name: str, lib_path: str, args: list, arg_type_symbol
             _, broadcast_arg = semantic.binary_op_type_checking_impl(
                 item, broadcast_arg, _builder, arithmetic_check=arithmetic_check)
         # Change the shape of each argument based on the broadcast shape
-        for i in range(len(dispatch_args)):
+        for i in builtins.range(len(dispatch_args)):
             dispatch_args[i], _ = semantic.binary_op_type_checking_impl(
                 dispatch_args[i], broadcast_arg, _builder, arithmetic_check=arithmetic_check)
         if not all_scalar:
@@ -1651,6 +2043,66 @@ def extern_elementwise(lib_name: str, lib_path: str, args: list, arg_type_symbol
     return dispatch(func, lib_name, lib_path, dispatch_args, arg_type_symbol_dict, ret_shape, is_pure, _builder)
 
 
+@builtin
+def inline_asm_elementwise(asm: str, constraints: str, args: list, dtype, is_pure: bool, pack: int, _builder=None):
+    '''
+        Runs an inline assembly snippet on the elements of the arguments, e.g. the
+        :code:`prmt`, :code:`lop3` or :code:`cvt` instructions that no operator maps to.
+
+        The snippet runs once per group of :code:`pack` consecutive elements held by a
+        thread. The elements of a group narrower than 32 bits are packed into 32-bit
+        registers (or into one narrower register, e.g. 16 bits for two int8), and each
+        such register, or each element of 32 bits or more, is an operand of the snippet.
+        :code:`$0`, :code:`$1`, ... refer to the result registers and then to the
+        registers of each argument, in the order of :code:`constraints`:
+
+        .. highlight:: python
+        .. code-block:: python
+
+            # the low nibbles of four int8 per instruction
+            y = tl.inline_asm_elementwise("and.b32 $0, $1, 0x0f0f0f0f;", "=r,r", [x],
+                                          dtype=tl.int8, is_pure=True, pack=4)
+
+        :param asm: the assembly, PTX on NVIDIA GPUs
+        :param constraints: the LLVM constraints of the result registers (:code:`=r`,
+            :code:`=h`, ...) and then of the argument registers, comma separated
+        :param args: the arguments, broadcast to a common shape
+        :param dtype: the element type of the result
+        :param is_pure: whether the snippet has no side effects, so that it can be
+            removed or moved like an arithmetic op
+        :param pack: the elements per invocation of the snippet, a power of 2
+        :return: the result, of the shape of the arguments
+    '''
+    asm = _constexpr_to_value(asm)
+    constraints = _constexpr_to_value(constraints)
+    dtype = _constexpr_to_value(dtype)
+    is_pure = _constexpr_to_value(is_pure)
+    pack = _constexpr_to_value(pack)
+    if pack <= 0 or pack & (pack - 1) != 0:
+        raise ValueError(f"pack must be a power of 2, got {pack}")
+    if dtype == int1:
+        raise ValueError("inline_asm_elementwise does not support int1 results")
+    dispatch_args = [_to_tensor(arg, _builder) for arg in args]
+    ret_shape = None
+    if dispatch_args:
+        if any(arg.dtype == int1 for arg in dispatch_args):
+            raise ValueError("inline_asm_elementwise does not support int1 arguments")
+        # Broadcast the arguments to a common shape
+        broadcast_arg = dispatch_args[0]
+        for item in dispatch_args:
+            _, broadcast_arg = semantic.binary_op_type_checking_impl(item, broadcast_arg, _builder,
+                                                                     arithmetic_check=False)
+        for i in builtins.range(len(dispatch_args)):
+            dispatch_args[i], _ = semantic.binary_op_type_checking_impl(dispatch_args[i], broadcast_arg, _builder,
+                                                                        arithmetic_check=False)
+        if broadcast_arg.type.is_block():
+            ret_shape = broadcast_arg.shape
+    ret_type = block_type(dtype, ret_shape) if ret_shape else dtype
+    handle = _builder.create_inline_asm(asm, constraints, [arg.handle for arg in dispatch_args],
+                                        ret_type.to_ir(_builder), is_pure, pack)
+    return tensor(handle, ret_type)
+
+
 def extern(fn):
     """A decorator for external functions."""
     return builtin(fn)
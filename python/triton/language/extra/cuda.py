@@ -1,6 +1,7 @@
 import os
 
 from .. import core
+from ...runtime.jit import jit
 
 __path__ = os.path.dirname(os.path.abspath(__file__))
 
@@ -17,3 +18,29 @@ def smid(_builder=None):
     return core.extern_elementwise("cuda", os.path.join(__path__, "cuda.bc"), [],
                                    {tuple(): ("smid", core.dtype("int32")),
                                     }, is_pure=True, _builder=_builder)
+
+
+@core.extern
+def clock64(_builder=None):
+    """
+    Returns the cycle counter of the SM. The counters of different SMs are not
+    synchronized, so only the differences of the clocks read by a program are
+    meaningful; see :code:`triton.profiler.RegionTimer`.
+    """
+    return core.extern_elementwise("cuda", os.path.join(__path__, "cuda.bc"), [],
+                                   {tuple(): ("clock64", core.dtype("int64")),
+                                    }, is_pure=False, _builder=_builder)
+
+
+@jit
+def record_region(Times, region, cycles, NUM_REGIONS: core.constexpr):
+    """
+    Stores the cycles that the program spent in :code:`region`, e.g. the sum
+    of the :code:`clock64()` differences around a loop body, in the row of the
+    program of a :code:`triton.profiler.RegionTimer` buffer. The SM of the
+    program is stored with it.
+    """
+    pid = core.program_id(0) + core.num_programs(0) * (core.program_id(1) + core.num_programs(1) * core.program_id(2))
+    row = Times + pid.to(core.int64) * (NUM_REGIONS + 1)
+    core.store(row, smid().to(core.int64))
+    core.store(row + 1 + region, cycles)
@@ -1,5 +1,6 @@
 import triton
 from . import core as tl
+from . import semantic
 
 PHILOX_KEY_A: tl.constexpr = 0x9E3779B9
 PHILOX_KEY_B: tl.constexpr = 0xBB67AE85
@@ -12,25 +13,21 @@ N_ROUNDS_DEFAULT = 10  # Default number of rounds for philox
 # -------------------
 
 
+@tl.builtin
+def _philox(c0, c1, c2, c3, k0, k1, n_rounds, _builder=None):
+    args = [tl._to_tensor(arg, _builder) for arg in (c0, c1, c2, c3, k0, k1)]
+    n_rounds = tl._constexpr_to_value(n_rounds)
+    return semantic.philox(*args, n_rounds, _builder)
+
+
 @triton.jit
 def philox_impl(c0, c1, c2, c3, k0, k1, n_rounds: tl.constexpr = N_ROUNDS_DEFAULT):
     """
     Run `n_rounds` rounds of Philox for state (c0, c1, c2, c3) and key (k0, k1).
+
+    The rounds are a single op, lowered to one wide multiply per product.
     """
-    for _ in tl.static_range(n_rounds):
-        # for _ in range(n_rounds):
-        # update random state
-        A = PHILOX_ROUND_A
-        B = PHILOX_ROUND_B
-        _c0, _c2 = c0, c2
-        c0 = tl.umulhi(B, _c2) ^ c1 ^ k0
-        c2 = tl.umulhi(A, _c0) ^ c3 ^ k1
-        c1 = B * _c2
-        c3 = A * _c0
-        # raise key
-        k0 = k0 + PHILOX_KEY_A
-        k1 = k1 + PHILOX_KEY_B
-    return c0, c1, c2, c3
+    return _philox(c0, c1, c2, c3, k0, k1, n_rounds)
 
 
 @triton.jit
@@ -133,6 +130,25 @@ def rand4x(seed, offsets, n_rounds: tl.constexpr = N_ROUNDS_DEFAULT):
     u4 = uint32_to_uniform_float(i4)
     return u1, u2, u3, u4
 
+
+@triton.jit
+def dropout(x, p, seed, offset, n_rounds: tl.constexpr = N_ROUNDS_DEFAULT):
+    """
+    Given a block :code:`x`, a probability :code:`p`, a :code:`seed` scalar
+    and an :code:`offset` block, zeroes each element of :code:`x` with
+    probability :code:`p` and scales the others by :code:`1 / (1 - p)`.
+
+    The mask is not stored: the same :code:`seed` and :code:`offset`
+    regenerate it, e.g. in the backward pass.
+
+    :param x: The values to drop out.
+    :param p: The probability to zero an element.
+    :param seed: The seed for generating random numbers.
+    :param offset: The offsets to generate random numbers for.
+    """
+    keep = rand(seed, offset, n_rounds) > p
+    return tl.where(keep, x / (1 - p), 0.0).to(x.dtype)
+
 # -------------------
 # randn
 # -------------------
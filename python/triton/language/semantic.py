@@ -776,13 +776,31 @@ def cast(input: tl.tensor,
 # ===----------------------------------------------------------------------===//
 
 
-def _str_to_cache_modifier(cache_modifier):
+def _str_to_load_cache_modifier(cache_modifier):
     cache = ir.CACHE_MODIFIER.NONE  # default
     if cache_modifier:
         if cache_modifier == ".ca":
             cache = ir.CACHE_MODIFIER.CA
         elif cache_modifier == ".cg":
             cache = ir.CACHE_MODIFIER.CG
+        elif cache_modifier == ".cs":
+            cache = ir.CACHE_MODIFIER.CS
+        else:
+            raise ValueError(f"Cache modifier {cache_modifier} not supported")
+    return cache
+
+
+def _str_to_store_cache_modifier(cache_modifier):
+    cache = ir.CACHE_MODIFIER.NONE  # default
+    if cache_modifier:
+        if cache_modifier == ".wb":
+            cache = ir.CACHE_MODIFIER.WB
+        elif cache_modifier == ".cg":
+            cache = ir.CACHE_MODIFIER.CG
+        elif cache_modifier == ".cs":
+            cache = ir.CACHE_MODIFIER.CS
+        elif cache_modifier == ".wt":
+            cache = ir.CACHE_MODIFIER.WT
         else:
             raise ValueError(f"Cache modifier {cache_modifier} not supported")
     return cache
@@ -795,6 +813,12 @@ def _str_to_eviction_policy(eviction_policy):
             eviction = ir.EVICTION_POLICY.EVICT_LAST
         elif eviction_policy == "evict_first":
             eviction = ir.EVICTION_POLICY.EVICT_FIRST
+        elif eviction_policy == "l2_evict_last":
+            eviction = ir.EVICTION_POLICY.L2_EVICT_LAST
+        elif eviction_policy == "l2_evict_first":
+            eviction = ir.EVICTION_POLICY.L2_EVICT_FIRST
+        elif eviction_policy == "no_allocate":
+            eviction = ir.EVICTION_POLICY.NO_ALLOCATE
         else:
             raise ValueError(f"Eviction policy {eviction_policy} not supported")
     return eviction
@@ -812,6 +836,25 @@ def _str_to_padding_option(padding_option):
     return padding
 
 
+def _str_to_sem(sem, allowed=("relaxed", "acquire", "release", "acq_rel")):
+    if not sem:
+        return None
+    sems = {"relaxed": ir.MEM_SEMANTIC.RELAXED, "acquire": ir.MEM_SEMANTIC.ACQUIRE,
+            "release": ir.MEM_SEMANTIC.RELEASE, "acq_rel": ir.MEM_SEMANTIC.ACQUIRE_RELEASE}
+    if sem not in allowed:
+        raise ValueError(f"Memory semantic {sem} not supported, it should be one of {allowed}")
+    return sems[sem]
+
+
+def _str_to_scope(scope):
+    if not scope:
+        return None
+    scopes = {"gpu": ir.MEM_SYNC_SCOPE.GPU, "cta": ir.MEM_SYNC_SCOPE.CTA, "sys": ir.MEM_SYNC_SCOPE.SYSTEM}
+    if scope not in scopes:
+        raise ValueError(f"Memory scope {scope} not supported, it should be one of {tuple(scopes)}")
+    return scopes[scope]
+
+
 def _canonicalize_boundary_check(boundary_check, block_shape):
     if boundary_check:
         if not hasattr(boundary_check, "__iter__"):
@@ -847,10 +890,15 @@ def _load_block_pointer(ptr, mask, other, boundary_check, padding, cache, evicti
                                                         is_volatile), dst_ty)
 
 
-def _load_legacy(ptr, mask, other, boundary_check, padding, cache, eviction, is_volatile, builder):
+def _load_legacy(ptr, mask, other, boundary_check, padding, cache, eviction, is_volatile, sem, scope, builder):
     # Load by a tensor of pointers or a pointer of scalar: `block_type<pointer_type<>>` or `pointer_type<>`
     if not ptr.type.scalar.is_ptr():
         raise ValueError(f"Unsupported ptr type {ptr.type.__repr__()} in `tl.load`")
+    # The elements of a parameter table are read with plain loads
+    if ptr.type.scalar.is_param() and (mask or other or is_volatile or sem is not None or
+                                        scope is not None):
+        raise ValueError("`mask`, `other`, `volatile`, `sem` and `scope` are not supported for loading from a "
+                         "parameter table")
 
     # Check `mask`, `other`, `boundary_check`, and `padding` arguments
     if not mask and other:
@@ -898,10 +946,10 @@ def _load_legacy(ptr, mask, other, boundary_check, padding, cache, eviction, is_
 
     # Build IR
     if not mask:
-        return tl.tensor(builder.create_load(ptr.handle, cache, eviction, is_volatile), dst_ty)
+        return tl.tensor(builder.create_load(ptr.handle, cache, eviction, is_volatile, sem, scope), dst_ty)
     else:
         return tl.tensor(builder.create_masked_load(ptr.handle, mask.handle, other.handle if other else None, cache,
-                                                    eviction, is_volatile), dst_ty)
+                                                    eviction, is_volatile, sem, scope), dst_ty)
 
 
 def load(ptr: tl.tensor,
@@ -912,18 +960,29 @@ def load(ptr: tl.tensor,
          cache_modifier: str,
          eviction_policy: str,
          is_volatile: bool,
+         sem: str,
+         scope: str,
          builder: ir.builder) -> tl.tensor:
     # Cache, eviction and padding options
-    cache = _str_to_cache_modifier(cache_modifier)
+    cache = _str_to_load_cache_modifier(cache_modifier)
     eviction = _str_to_eviction_policy(eviction_policy)
     padding = _str_to_padding_option(padding_option)
+    # Memory ordering, e.g. to read a flag set by another device
+    sem = _str_to_sem(sem, allowed=("relaxed", "acquire"))
+    scope = _str_to_scope(scope)
+    ordered = sem is not None or scope is not None
+    if ordered and (cache_modifier or is_volatile):
+        raise ValueError("`sem` and `scope` cannot be combined with `cache_modifier` or `volatile`")
 
     if ptr.type.is_ptr() and ptr.type.element_ty.is_block():
         # Load by a block pointer: `pointer_type<block_type<>>`
+        if ordered:
+            raise ValueError("`sem` and `scope` are not supported for loading block pointers")
         return _load_block_pointer(ptr, mask, other, boundary_check, padding, cache, eviction, is_volatile, builder)
     else:
         # Load by a tensor of pointers or a pointer of scalar: `block_type<pointer_type<>>` or `pointer_type<>`
-        return _load_legacy(ptr, mask, other, boundary_check, padding, cache, eviction, is_volatile, builder)
+        return _load_legacy(ptr, mask, other, boundary_check, padding, cache, eviction, is_volatile, sem, scope,
+                            builder)
 
 
 def _store_block_pointer(ptr, val, mask, boundary_check, cache, eviction, builder):
@@ -951,10 +1010,12 @@ def _store_block_pointer(ptr, val, mask, boundary_check, cache, eviction, builde
                      tl.void)
 
 
-def _store_legacy(ptr, val, mask, boundary_check, cache, eviction, builder):
+def _store_legacy(ptr, val, mask, boundary_check, cache, eviction, sem, scope, builder):
     # Store by a tensor of pointers or a pointer of scalar: `block_type<pointer_type<>>` or `pointer_type<>`
     if not ptr.type.scalar.is_ptr():
         raise ValueError(f"Unsupported ptr type {ptr.type.__repr__()} in `tl.store`")
+    if ptr.type.scalar.is_param():
+        raise ValueError("Parameter tables are read-only, they cannot be stored to")
 
     # Check `boundary_check` argument
     if boundary_check:
@@ -989,10 +1050,11 @@ def _store_legacy(ptr, val, mask, boundary_check, cache, eviction, builder):
 
     # Build IR
     if not mask:
-        return tl.tensor(builder.create_store(ptr.handle, val.handle, cache, eviction), tl.void)
+        return tl.tensor(builder.create_store(ptr.handle, val.handle, cache, eviction, sem, scope), tl.void)
     if not mask.type.scalar.is_bool():
         raise ValueError("Mask must have boolean scalar type")
-    return tl.tensor(builder.create_masked_store(ptr.handle, val.handle, mask.handle, cache, eviction), tl.void)
+    return tl.tensor(builder.create_masked_store(ptr.handle, val.handle, mask.handle, cache, eviction, sem, scope),
+                     tl.void)
 
 
 def store(ptr: tl.tensor,
@@ -1001,17 +1063,30 @@ def store(ptr: tl.tensor,
           boundary_check,
           cache_modifier: str,
           eviction_policy: str,
+          sem: str,
+          scope: str,
           builder: ir.builder) -> tl.tensor:
     # Cache and eviction options
-    cache = _str_to_cache_modifier(cache_modifier)
+    cache = _str_to_store_cache_modifier(cache_modifier)
     eviction = _str_to_eviction_policy(eviction_policy)
+    # st takes either a cache operator or an L1 eviction priority
+    if cache_modifier and eviction_policy in ("evict_first", "evict_last", "no_allocate"):
+        raise ValueError(f"cache modifier {cache_modifier} cannot be combined with eviction policy {eviction_policy}")
+    # Memory ordering, e.g. to publish data to another device
+    sem = _str_to_sem(sem, allowed=("relaxed", "release"))
+    scope = _str_to_scope(scope)
+    ordered = sem is not None or scope is not None
+    if ordered and cache_modifier:
+        raise ValueError("`sem` and `scope` cannot be combined with `cache_modifier`")
 
     if ptr.type.is_ptr() and ptr.type.element_ty.is_block():
         # Store by a block pointer: `pointer_type<block_type<>>`
+        if ordered:
+            raise ValueError("`sem` and `scope` are not supported for storing by block pointers")
         return _store_block_pointer(ptr, val, mask, boundary_check, cache, eviction, builder)
     else:
         # Store by a tensor of pointers or a pointer of scalar: `block_type<pointer_type<>>` or `pointer_type<>`
-        return _store_legacy(ptr, val, mask, boundary_check, cache, eviction, builder)
+        return _store_legacy(ptr, val, mask, boundary_check, cache, eviction, sem, scope, builder)
 
 
 #########
@@ -1022,11 +1097,14 @@ def store(ptr: tl.tensor,
 def atomic_cas(ptr: tl.tensor,
                cmp: tl.tensor,
                val: tl.tensor,
+               sem: str,
+               scope: str,
                builder: ir.builder) -> tl.tensor:
     element_ty = ptr.type.scalar.element_ty
     if element_ty.primitive_bitwidth not in [16, 32, 64]:
         raise ValueError("atomic_cas only supports elements with width {16, 32, 64}")
-    return tl.tensor(builder.create_atomic_cas(ptr.handle, cmp.handle, val.handle), val.type)
+    return tl.tensor(builder.create_atomic_cas(ptr.handle, cmp.handle, val.handle, _str_to_sem(sem),
+                                               _str_to_scope(scope)), val.type)
 
 
 def atom_red_typechecking_impl(ptr: tl.tensor,
@@ -1036,6 +1114,8 @@ def atom_red_typechecking_impl(ptr: tl.tensor,
                                builder: ir.builder) -> Tuple[tl.tensor, tl.tensor, tl.tensor]:
     if not ptr.type.scalar.is_ptr():
         raise ValueError("Pointer argument of store instruction is " + ptr.type.__repr__())
+    if ptr.type.scalar.is_param():
+        raise ValueError("Parameter tables are read-only, atomic_" + op + " cannot be applied to them")
 
     element_ty = ptr.type.scalar.element_ty
     if element_ty is tl.float16 and op != 'add':
@@ -1061,8 +1141,11 @@ def atom_red_typechecking_impl(ptr: tl.tensor,
 def atomic_max(ptr: tl.tensor,
                val: tl.tensor,
                mask: tl.tensor,
+               sem: str,
+               scope: str,
                builder: ir.builder) -> tl.tensor:
     ptr, val, mask = atom_red_typechecking_impl(ptr, val, mask, 'max', builder)
+    sem, scope = _str_to_sem(sem), _str_to_scope(scope)
     sca_ty = val.type.scalar
     # direct call to atomic_max for integers
     if sca_ty.is_int():
@@ -1070,13 +1153,17 @@ def atomic_max(ptr: tl.tensor,
             return tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.MAX,
                                                        ptr.handle,
                                                        val.handle,
-                                                       mask.handle),
+                                                       mask.handle,
+                                                       sem,
+                                                       scope),
                              val.type)
         else:
             return tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.UMAX,
                                                        ptr.handle,
                                                        val.handle,
-                                                       mask.handle),
+                                                       mask.handle,
+                                                       sem,
+                                                       scope),
                              val.type)
     # for float
     # return atomic_smax(i_ptr, i_val) if val >= 0
@@ -1085,16 +1172,19 @@ def atomic_max(ptr: tl.tensor,
     i_ptr = bitcast(ptr, tl.pointer_type(tl.int32, 1), builder)
     pos = greater_equal(val, tl.tensor(builder.get_fp32(0), sca_ty), builder)
     neg = less_than(val, tl.tensor(builder.get_fp32(0), sca_ty), builder)
-    pos_ret = tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.MAX, i_ptr.handle, i_val.handle, and_(mask, pos, builder).handle), i_val.type)
-    neg_ret = tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.UMIN, i_ptr.handle, i_val.handle, and_(mask, neg, builder).handle), i_val.type)
+    pos_ret = tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.MAX, i_ptr.handle, i_val.handle, and_(mask, pos, builder).handle, sem, scope), i_val.type)
+    neg_ret = tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.UMIN, i_ptr.handle, i_val.handle, and_(mask, neg, builder).handle, sem, scope), i_val.type)
     return where(pos, pos_ret, neg_ret, builder)
 
 
 def atomic_min(ptr: tl.tensor,
                val: tl.tensor,
                mask: tl.tensor,
+               sem: str,
+               scope: str,
                builder: ir.builder) -> tl.tensor:
     ptr, val, mask = atom_red_typechecking_impl(ptr, val, mask, 'min', builder)
+    sem, scope = _str_to_sem(sem), _str_to_scope(scope)
     sca_ty = val.type.scalar
     # direct call to atomic_min for integers
     if sca_ty.is_int():
@@ -1102,13 +1192,17 @@ def atomic_min(ptr: tl.tensor,
             return tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.MIN,
                                                        ptr.handle,
                                                        val.handle,
-                                                       mask.handle),
+                                                       mask.handle,
+                                                       sem,
+                                                       scope),
                              val.type)
         else:
             return tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.UMIN,
                                                        ptr.handle,
                                                        val.handle,
-                                                       mask.handle),
+                                                       mask.handle,
+                                                       sem,
+                                                       scope),
                              val.type)
     # for float
     # return atomic_smin(i_ptr, i_val) if val >= 0
@@ -1120,12 +1214,16 @@ def atomic_min(ptr: tl.tensor,
     pos_ret = tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.MIN,
                                                   i_ptr.handle,
                                                   i_val.handle,
-                                                  and_(mask, pos, builder).handle),
+                                                  and_(mask, pos, builder).handle,
+                                                  sem,
+                                                  scope),
                         i_val.type)
     neg_ret = tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.UMAX,
                                                   i_ptr.handle,
                                                   i_val.handle,
-                                                  and_(mask, neg, builder).handle),
+                                                  and_(mask, neg, builder).handle,
+                                                  sem,
+                                                  scope),
                         i_val.type)
     return where(pos, pos_ret, neg_ret, builder)
 
@@ -1133,58 +1231,190 @@ def atomic_min(ptr: tl.tensor,
 def atomic_add(ptr: tl.tensor,
                val: tl.tensor,
                mask: tl.tensor,
+               sem: str,
+               scope: str,
                builder: ir.builder) -> tl.tensor:
     ptr, val, mask = atom_red_typechecking_impl(ptr, val, mask, 'add', builder)
+    sem, scope = _str_to_sem(sem), _str_to_scope(scope)
     sca_ty = val.type.scalar
     op = ir.ATOMIC_OP.FADD if sca_ty.is_floating() else ir.ATOMIC_OP.ADD
-    return tl.tensor(builder.create_atomic_rmw(op, ptr.handle, val.handle, mask.handle), val.type)
+    return tl.tensor(builder.create_atomic_rmw(op, ptr.handle, val.handle, mask.handle, sem, scope), val.type)
 
 
 def atomic_and(ptr: tl.tensor,
                val: tl.tensor,
                mask: tl.tensor,
+               sem: str,
+               scope: str,
                builder: ir.builder) -> tl.tensor:
     ptr, val, mask = atom_red_typechecking_impl(ptr, val, mask, 'and', builder)
-    return tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.AND, ptr.handle, val.handle, mask.handle), val.type)
+    sem, scope = _str_to_sem(sem), _str_to_scope(scope)
+    return tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.AND, ptr.handle, val.handle, mask.handle, sem, scope), val.type)
 
 
 def atomic_or(ptr: tl.tensor,
               val: tl.tensor,
               mask: tl.tensor,
+              sem: str,
+              scope: str,
               builder: ir.builder) -> tl.tensor:
     ptr, val, mask = atom_red_typechecking_impl(ptr, val, mask, 'or', builder)
-    return tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.OR, ptr.handle, val.handle, mask.handle), val.type)
+    sem, scope = _str_to_sem(sem), _str_to_scope(scope)
+    return tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.OR, ptr.handle, val.handle, mask.handle, sem, scope), val.type)
 
 
 def atomic_xor(ptr: tl.tensor,
                val: tl.tensor,
                mask: tl.tensor,
+               sem: str,
+               scope: str,
                builder: ir.builder) -> tl.tensor:
     ptr, val, mask = atom_red_typechecking_impl(ptr, val, mask, 'xor', builder)
-    return tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.XOR, ptr.handle, val.handle, mask.handle), val.type)
+    sem, scope = _str_to_sem(sem), _str_to_scope(scope)
+    return tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.XOR, ptr.handle, val.handle, mask.handle, sem, scope), val.type)
 
 
 def atomic_xchg(ptr: tl.tensor,
                 val: tl.tensor,
                 mask: tl.tensor,
+                sem: str,
+                scope: str,
                 builder: ir.builder) -> tl.tensor:
     ptr, val, mask = atom_red_typechecking_impl(ptr, val, mask, 'xchg', builder)
-    return tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.XCHG, ptr.handle, val.handle, mask.handle), val.type)
+    sem, scope = _str_to_sem(sem), _str_to_scope(scope)
+    return tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.XCHG, ptr.handle, val.handle, mask.handle, sem, scope), val.type)
+
+
+def _check_semaphore(ptr: tl.tensor, value: tl.tensor, name: str, builder: ir.builder) -> tl.tensor:
+    if ptr.type.is_block() or not ptr.type.is_ptr() or ptr.type.element_ty != tl.int32:
+        raise ValueError(f"{name} takes a pointer to a scalar int32 semaphore, not {ptr.type}")
+    if value.type.is_block():
+        raise ValueError(f"the value of {name} must be a scalar")
+    return cast(value, tl.int32, builder)
+
+
+def semaphore_wait(ptr: tl.tensor,
+                   value: tl.tensor,
+                   sem: str,
+                   scope: str,
+                   builder: ir.builder) -> tl.tensor:
+    value = _check_semaphore(ptr, value, "semaphore_wait", builder)
+    sem = _str_to_sem(sem, allowed=("relaxed", "acquire"))
+    return tl.tensor(builder.create_semaphore_wait(ptr.handle, value.handle, sem, _str_to_scope(scope)), tl.void)
+
+
+def semaphore_signal(ptr: tl.tensor,
+                     value: tl.tensor,
+                     add: bool,
+                     sem: str,
+                     scope: str,
+                     builder: ir.builder) -> tl.tensor:
+    value = _check_semaphore(ptr, value, "semaphore_signal", builder)
+    sem = _str_to_sem(sem, allowed=("relaxed", "release"))
+    return tl.tensor(builder.create_semaphore_signal(ptr.handle, value.handle, add, sem, _str_to_scope(scope)),
+                     tl.void)
+
+
+def _check_shared_buffer(buffer: tl.tensor, index: tl.tensor, fn: str, builder: ir.builder) -> tl.tensor:
+    if not isinstance(buffer.type, tl.shared_block_type):
+        raise ValueError(f"The buffer of `{fn}` must be a buffer of `smem_alloc`, got {buffer.type}")
+    if index.type.is_block() or not index.type.is_int():
+        raise ValueError(f"The index of `{fn}` must be a scalar integer, got {index.type}")
+    return cast(index, tl.int32, builder)
+
+
+def smem_alloc(shape: List[int], dtype: tl.dtype, stages: int, builder: ir.builder) -> tl.tensor:
+    if len(shape) != 2:
+        raise ValueError(f"The tiles of shared memory buffers are 2D, got shape {shape}")
+    if not isinstance(stages, int) or stages < 1:
+        raise ValueError(f"The number of stages of a shared memory buffer must be a positive int, got {stages}")
+    if dtype == tl.int1 or dtype.is_ptr():
+        raise ValueError(f"Shared memory buffers of {dtype} are not supported")
+    ret_ty = tl.shared_block_type(dtype, [stages] + list(shape))
+    return tl.tensor(builder.create_alloc_tensor(ret_ty.to_ir(builder)), ret_ty)
+
+
+def async_copy(buffer: tl.tensor, index: tl.tensor, ptr: tl.tensor, mask: Optional[tl.tensor],
+               builder: ir.builder) -> tl.tensor:
+    index = _check_shared_buffer(buffer, index, "async_copy", builder)
+    tile_shape = buffer.type.shape[1:]
+    if not ptr.type.is_block() or not ptr.type.scalar.is_ptr():
+        raise ValueError(f"The pointers of `async_copy` must be a tensor of pointers, got {ptr.type}")
+    if ptr.type.get_block_shapes() != tile_shape:
+        raise ValueError(f"The pointers of `async_copy` must have the shape of the tiles of the buffer, {tile_shape}, "
+                         f"got {ptr.type.get_block_shapes()}")
+    if ptr.type.scalar.element_ty != buffer.type.element_ty:
+        raise ValueError(f"Cannot copy {ptr.type.scalar.element_ty} into a buffer of {buffer.type.element_ty}")
+    if mask:
+        mask = broadcast_impl_shape(mask, tile_shape, builder)
+    ret = builder.create_insert_slice_async(ptr.handle, buffer.handle, index.handle, mask.handle if mask else None,
+                                            None, ir.CACHE_MODIFIER.NONE, ir.EVICTION_POLICY.NORMAL, False)
+    builder.create_async_commit_group()
+    return tl.tensor(ret, buffer.type)
+
+
+def async_wait(num_pending: int, builder: ir.builder) -> tl.tensor:
+    if not isinstance(num_pending, int) or num_pending < 0:
+        raise ValueError(f"The number of pending copies of `async_wait` must be a non-negative int, got {num_pending}")
+    return tl.tensor(builder.create_async_wait(num_pending), tl.void)
+
+
+def smem_load(buffer: tl.tensor, index: tl.tensor, builder: ir.builder) -> tl.tensor:
+    index = _check_shared_buffer(buffer, index, "smem_load", builder)
+    tile = builder.create_extract_slice(buffer.handle, index.handle)
+    # the conversion to TritonGPU gives the tile a layout in registers
+    ret_ty = tl.block_type(buffer.type.element_ty, buffer.type.shape[1:])
+    return tl.tensor(builder.create_convert_layout(tile, ret_ty.to_ir(builder)), ret_ty)
 
 # ===----------------------------------------------------------------------===//
 #                               Linear Algebra
 # ===----------------------------------------------------------------------===//
 
 
+def _split_tf32(x: tl.tensor, builder: ir.builder):
+    # the high part keeps the sign, the exponent and the 10 mantissa bits of
+    # tf32, the low part the rest of the mantissa
+    bits = bitcast(x, tl.int32, builder)
+    mask = tl.tensor(builder.get_int32(-8192), tl.int32)  # 0xffffe000
+    hi = bitcast(and_(bits, mask, builder), tl.float32, builder)
+    return hi, sub(x, hi, builder)
+
+
+def _sparse_dot(lhs: tl.tensor, rhs: tl.tensor, meta: tl.tensor, capability, builder: ir.builder) -> tl.tensor:
+    # lhs is the 2:4 compression of a (M, K) matrix, see tl.dot
+    assert capability is None or capability >= 80, "sparse dots need compute capability 80 or more (mma.sp)"
+    assert lhs.type.is_block() and rhs.type.is_block() and meta.type.is_block()
+    assert lhs.dtype == rhs.dtype, "lhs and rhs must have the same dtype!"
+    assert lhs.dtype.is_fp16() or lhs.dtype.is_bf16(), "sparse dots only support float16 and bfloat16"
+    assert len(lhs.shape) == 2 and len(rhs.shape) == 2 and len(meta.shape) == 2
+    M, K, N = lhs.shape[0].value, rhs.shape[0].value, rhs.shape[1].value
+    assert 2 * lhs.shape[1].value == K, \
+        f"the sparse lhs must hold half of the {K} columns of the dense matrix, but has {lhs.shape[1].value}"
+    assert K % 32 == 0 and M >= 16 and N >= 16, "small blocks not supported!"
+    assert meta.dtype in (tl.int16, tl.uint16), "the sparsity metadata must be int16"
+    assert [d.value for d in meta.shape] == [M, K // 16], \
+        f"the sparsity metadata must have shape [{M}, {K // 16}]"
+    _0 = builder.create_splat(builder.get_fp32(0), [M, N])
+    return tl.tensor(builder.create_sparse_dot(lhs.handle, rhs.handle, _0, meta.handle),
+                     tl.block_type(tl.float32, [M, N]))
+
+
 def dot(lhs: tl.tensor,
         rhs: tl.tensor,
         allow_tf32: bool,
         out_dtype: tl.dtype,
-        builder: ir.builder) -> tl.tensor:
+        builder: ir.builder,
+        input_precision: str = None,
+        sparse_meta: tl.tensor = None) -> tl.tensor:
     try:
         import torch
     except ImportError:
         raise ImportError("Triton requires PyTorch to be installed")
+    if input_precision not in (None, "tf32", "tf32x3", "ieee"):
+        raise ValueError(f"input_precision must be one of 'tf32', 'tf32x3' or 'ieee', not {input_precision!r}")
+    if input_precision is not None:
+        allow_tf32 = input_precision != "ieee"
+    capability = None
     if torch.version.hip is None:
         device = triton.runtime.jit.get_current_device()
         capability = triton.runtime.jit.get_device_capability(device)
@@ -1193,6 +1423,8 @@ def dot(lhs: tl.tensor,
             assert (
                 not rhs.dtype.is_fp16() and not rhs.dtype.is_fp8()
             ), "Float8 and Float16 types are not supported for compute capability < 70 (use Float32 or above)"
+    if sparse_meta is not None:
+        return _sparse_dot(lhs, rhs, sparse_meta, capability, builder)
     assert lhs.type.is_block() and rhs.type.is_block()
     assert lhs.dtype == rhs.dtype, "lhs and rhs must have the same dtype!"
     assert len(lhs.shape) == 2 and len(rhs.shape) == 2
@@ -1217,6 +1449,19 @@ def dot(lhs: tl.tensor,
     N = rhs.type.shape[1]
     _0 = builder.create_splat(_0, [M, N])
     ret_ty = tl.block_type(ret_scalar_ty, [M, N])
+    # 3xTF32 needs the TF32 tensor cores of sm_80+, elsewhere the fp32 dot is
+    # as accurate and faster
+    if input_precision == "tf32x3" and lhs.type.scalar.is_fp32() and capability is not None and capability >= 80:
+        # lhs @ rhs ~= lhs_hi @ rhs_hi + lhs_hi @ rhs_lo + lhs_lo @ rhs_hi,
+        # accumulated from the smallest terms
+        lhs_hi, lhs_lo = _split_tf32(lhs, builder)
+        rhs_hi, rhs_lo = _split_tf32(rhs, builder)
+        acc = _0
+        for a, b in ((lhs_lo, rhs_hi), (lhs_hi, rhs_lo), (lhs_hi, rhs_hi)):
+            acc = builder.create_dot(a.handle, b.handle, acc, True)
+        return tl.tensor(acc, ret_ty)
+    if input_precision == "tf32x3":
+        allow_tf32 = False
     return tl.tensor(builder.create_dot(lhs.handle, rhs.handle, _0, allow_tf32),
                      ret_ty)
 
@@ -1273,6 +1518,86 @@ def reduction(
     )
 
 
+def associative_scan(
+    inputs: Sequence[tl.tensor], axis: int, region_builder_fn, builder: ir.builder
+) -> Tuple[tl.tensor, ...]:
+    shape = inputs[0].type.shape
+    for t in inputs:
+        assert t.type.shape == shape
+
+    def wrap_tensor(x, scalar_ty):
+        res_ty = tl.block_type(scalar_ty, shape)
+        return tl.tensor(x, res_ty)
+
+    scan_op = builder.create_scan([t.handle for t in inputs], axis)
+    region_builder_fn(scan_op)
+    scan_op.verify()
+
+    return tuple(
+        wrap_tensor(scan_op.get_result(i), inputs[i].type.scalar)
+        for i in range(len(inputs))
+    )
+
+
+def _check_sort_inputs(inputs: Sequence[tl.tensor], axis: int):
+    shape = inputs[0].type.shape
+    for t in inputs:
+        assert t.type.shape == shape
+        if t.type.scalar.is_fp8():
+            raise ValueError("sorting fp8 values is not supported")
+    if not 0 <= axis < len(shape):
+        raise ValueError(f"sort dimension {axis} is out of range for a tensor of rank {len(shape)}")
+
+
+def sort(inputs: Sequence[tl.tensor], axis: int, descending: bool, builder: ir.builder) -> Tuple[tl.tensor, ...]:
+    _check_sort_inputs(inputs, axis)
+    is_unsigned = inputs[0].type.scalar.is_int_unsigned()
+    sort_op = builder.create_sort([t.handle for t in inputs], axis, descending, is_unsigned)
+    return tuple(tl.tensor(sort_op.get_result(i), t.type) for i, t in enumerate(inputs))
+
+
+def topk(inputs: Sequence[tl.tensor], k: int, axis: int, builder: ir.builder) -> Tuple[tl.tensor, ...]:
+    _check_sort_inputs(inputs, axis)
+    ret_shape = list(inputs[0].type.shape)
+    if k < 1 or k > ret_shape[axis] or k & (k - 1):
+        raise ValueError(f"k must be a power of 2 between 1 and {ret_shape[axis]}, got {k}")
+    ret_shape[axis] = k
+    is_unsigned = inputs[0].type.scalar.is_int_unsigned()
+    topk_op = builder.create_topk([t.handle for t in inputs], axis, k, is_unsigned)
+    return tuple(tl.tensor(topk_op.get_result(i), tl.block_type(t.type.scalar, ret_shape))
+                 for i, t in enumerate(inputs))
+
+
+def histogram(input: tl.tensor, num_bins: int, builder: ir.builder) -> tl.tensor:
+    if not input.type.scalar.is_int():
+        raise ValueError(f"histogram expects integer values, got {input.type.scalar}")
+    if num_bins < 1 or num_bins & (num_bins - 1):
+        raise ValueError(f"the number of bins must be a power of 2, got {num_bins}")
+    # the lowering sign-extends the values to find their bins: the unsigned
+    # ones, e.g. uint8 values above 127, are zero-extended to a signed type
+    # that holds them first
+    if input.type.scalar.is_int_unsigned() and input.type.scalar.int_bitwidth < 64:
+        input = cast(input, tl.int32 if input.type.scalar.int_bitwidth < 32 else tl.int64, builder)
+    return tl.tensor(builder.create_histogram(input.handle, num_bins),
+                     tl.block_type(tl.int32, [num_bins]))
+
+
+def philox(c0: tl.tensor, c1: tl.tensor, c2: tl.tensor, c3: tl.tensor, k0: tl.tensor, k1: tl.tensor,
+           n_rounds: int, builder: ir.builder) -> Tuple[tl.tensor, ...]:
+    args = [c0, c1, c2, c3, k0, k1]
+    for arg in args:
+        if not arg.type.scalar.is_int() or arg.type.scalar.primitive_bitwidth != 32:
+            raise ValueError(f"philox expects 32-bit integers, got {arg.type.scalar}")
+    # the counter and the key take a common shape; the second pass broadcasts
+    # the first operands to the shape of the last ones
+    for _ in range(2):
+        for i in range(1, len(args)):
+            args[0], args[i] = broadcast_impl_value(args[0], args[i], builder)
+    args = [bitcast(arg, tl.uint32, builder) for arg in args]
+    philox_op = builder.create_philox(*[arg.handle for arg in args], n_rounds)
+    return tuple(tl.tensor(philox_op.get_result(i), args[0].type) for i in range(4))
+
+
 # ===----------------------------------------------------------------------===
 #                               Math
 # ===----------------------------------------------------------------------===
@@ -1416,6 +1741,8 @@ def make_block_ptr(base: tl.tensor, shape, strides, offsets, block_shape, order,
     # Check `base` type
     if not base.type.is_ptr() or base.type.element_ty.is_block():
         raise ValueError("Expected `base` to be a pointer type (but not a block pointer type or others)")
+    if base.type.is_param():
+        raise ValueError("Block pointers cannot be made into a parameter table, index it with a tensor of pointers")
 
     # Treat `pointer_type<tl.int1>` as `pointer_type<tl.int8>`
     if base.type.element_ty == tl.int1:
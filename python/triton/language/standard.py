@@ -96,3 +96,91 @@ def zeros(shape, dtype):
 @jit
 def zeros_like(input):
     return zeros(input.shape, input.dtype)
+
+
+@jit
+def grid_sum(x, partials, counter):
+    """
+    Sums :code:`x` over all the programs of the launch grid, in a single launch.
+
+    Every program stores its :code:`x` to :code:`partials` and takes a ticket
+    from :code:`counter`. The last program to take one adds the partials up in
+    program order, so the result does not depend on the scheduling of the
+    programs.
+
+    :param x: the partial result of the current program; its number of
+        elements must be a power of 2
+    :type x: Block
+    :param partials: pointer to a workspace of :code:`x.numel` elements per
+        program, of the type the partials are summed in
+    :param counter: pointer to an int32 zero. The last program resets it, so
+        that it can be reused by the next launch.
+    :return: the sum over the grid, which is only valid in the last program,
+        and whether the current program is the last one
+    """
+    num_x = core.num_programs(0)
+    num_y = core.num_programs(1)
+    pid = core.program_id(0) + (core.program_id(1) + core.program_id(2) * num_y) * num_x
+    num_pids = num_x * num_y * core.num_programs(2)
+    offs = core.arange(0, x.numel)
+    core.store(partials + pid * x.numel + offs, ravel(x))
+    # the partials of all the threads of the program are written before the
+    # ticket is taken. The ticket releases them at the gpu scope, and the last
+    # program acquires the partials of all the others with it.
+    core.debug_barrier()
+    ticket = core.atomic_add(counter, 1, sem="acq_rel", scope="gpu")
+    is_last = ticket == num_pids - 1
+    total = zeros((x.numel,), partials.dtype.element_ty)
+    if is_last:
+        for i in range(0, num_pids):
+            total += core.load(partials + i * x.numel + offs)
+        core.atomic_xchg(counter, 0)
+    return core.view(total, x.shape), is_last
+
+
+@jit
+def signal(flag, value, scope="sys"):
+    """
+    Sets the int32 :code:`flag` to :code:`value` once all the memory accesses
+    of the current program before it are done, e.g. to tell the programs of a
+    peer device that the data stored to its memory is ready.
+
+    :param flag: pointer to the flag, e.g. in a buffer of a peer device
+    :param value: the new value of the flag
+    :param scope: the scope of the programs waiting on the flag: "sys" (the
+        default) for the peer devices or the host, "gpu" for the current one
+    """
+    core.semaphore_signal(flag, value, sem="release", scope=scope)
+
+
+@jit
+def wait(flag, value, scope="sys"):
+    """
+    Waits until the int32 :code:`flag` is :code:`value`, e.g. set by
+    :code:`signal` in a program of a peer device; the memory accesses of the
+    current program after it see the data stored before the signal.
+
+    :param flag: pointer to the flag
+    :param value: the value to wait for
+    :param scope: the scope of the program setting the flag, see :code:`signal`
+    """
+    core.semaphore_wait(flag, value, sem="acquire", scope=scope)
+
+
+@jit
+def multi_tensor_chunk(tensor_list, chunk, dtype):
+    """
+    Returns the address of the first element of a chunk of a
+    :code:`triton.runtime.TensorList`, as a pointer to :code:`dtype`, and the
+    number of elements of the chunk.
+
+    :param tensor_list: the tensor list, passed to the kernel as a pointer
+    :param chunk: the index of the chunk, e.g. :code:`tl.program_id(0)` when
+        the kernel is launched on the :code:`grid` of the list
+    :param dtype: the element type of the tensors of the list
+    :return: the pointer and the int32 number of elements
+    """
+    ptr = core.load(tensor_list + 2 * chunk).to(core.pointer_type(dtype))
+    # a chunk holds fewer than 2**31 elements
+    numel = core.load(tensor_list + 2 * chunk + 1).to(core.int32)
+    return ptr, numel
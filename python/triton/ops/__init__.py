@@ -1,8 +1,9 @@
 # from .conv import _conv, conv
 from . import blocksparse
 from .cross_entropy import _cross_entropy, cross_entropy
-from .flash_attention import attention
-from .matmul import _matmul, matmul
+from .flash_attention import attention, paged_attention
+from .matmul import _matmul, grouped_matmul, matmul, scaled_matmul
+from .normalization import layer_norm, rms_norm
 
 __all__ = [
     "blocksparse",
@@ -10,5 +11,10 @@ __all__ = [
     "cross_entropy",
     "_matmul",
     "matmul",
+    "grouped_matmul",
+    "scaled_matmul",
     "attention",
+    "paged_attention",
+    "layer_norm",
+    "rms_norm",
 ]
@@ -1,3 +1,6 @@
+import hashlib
+from collections import OrderedDict
+
 import torch
 
 import triton
@@ -301,14 +304,10 @@ def dsd_lut(layout, block, step, trans, device):
     if trans:
         A_idx = torch.arange(num_blocks, device=layout.device)
     else:
-        A_idx = torch.tensor([], dtype=torch.int64, device=layout.device)
-        current_offset = 0
-        for z in range(layout.size(0)):
-            layoutw = layout[z, :, :].clone().long()
-            msum = layoutw.sum()
-            layoutw[layoutw > 0] = 1 + torch.arange(msum, device=layout.device)
-            A_idx = torch.cat((A_idx, current_offset + layoutw.T[layoutw.T > 0] - 1))
-            current_offset += msum
+        # the index of each block in the row-major order of the sparse
+        # memory layout, read in the column-major order of each head
+        ranks = (torch.cumsum(layout.flatten() > 0, dim=0) - 1).view(layout.shape)
+        A_idx = ranks.transpose(1, 2)[layout.transpose(1, 2) > 0]
     A_incs = A_idx * block * block
     A_incs[1:] -= A_idx[:-1] * block * block
     A_incs = A_incs.view(-1, 1).repeat(1, div)
@@ -350,6 +349,48 @@ def dds_matmul(a, b, trans_a, trans_b, trans_c, spdims, block, lut, width, out=N
 #  MAIN API  #
 ##############
 
+# the look-up tables of the recently used layouts, keyed by content
+LUT_CACHE_SIZE = 64
+_lut_cache = OrderedDict()
+
+
+def _make_luts(layout, block, mode, trans_a, trans_b, device):
+    step = min(block, 32)
+    if mode == 'sdd':
+        c_lut, c_width = sdd_lut(layout, block, device)
+        da_lut, da_width = dsd_lut(layout, block, step, True, device)
+        db_lut, db_width = dsd_lut(layout, block, step, False, device)
+    if mode == 'dsd':
+        c_lut, c_width = dsd_lut(layout, block, step, not trans_a, device)
+        da_lut, da_width = sdd_lut(layout, block, device)
+        db_lut, db_width = dsd_lut(layout, block, step, trans_a, device)
+    if mode == 'dds':
+        c_lut, c_width = dsd_lut(layout, block, step, trans_b, device)
+        da_lut, da_width = dsd_lut(layout, block, step, not trans_b, device)
+        db_lut, db_width = sdd_lut(layout, block, device)
+    return c_lut, c_width, da_lut, da_width, db_lut, db_width
+
+
+def get_luts(layout, block, mode, trans_a, trans_b, device):
+    """
+    Returns the look-up tables of the layout, built once per distinct layout
+    content: layouts that change per call, e.g. in dynamic sparse attention,
+    reuse the tables of the recent layouts with the same blocks. The layout
+    is hashed on the host, so layouts on the GPU are copied back first.
+    """
+    layout_cpu = layout.detach().cpu().contiguous()
+    digest = hashlib.sha1(layout_cpu.numpy().tobytes()).hexdigest()
+    key = (digest, tuple(layout_cpu.shape), str(layout_cpu.dtype), block, mode, trans_a, trans_b, str(device))
+    luts = _lut_cache.get(key)
+    if luts is None:
+        luts = _make_luts(layout_cpu, block, mode, trans_a, trans_b, device)
+        _lut_cache[key] = luts
+        if len(_lut_cache) > LUT_CACHE_SIZE:
+            _lut_cache.popitem(last=False)
+    else:
+        _lut_cache.move_to_end(key)
+    return luts
+
 
 class _matmul(torch.autograd.Function):
 
@@ -410,28 +451,25 @@ class matmul:
         self.trans_a = trans_a
         self.trans_b = trans_b
         self.trans_c = trans_c
+        self.device = device
         self.layout = layout
         self.spdims = layout.shape
-        step = min(block, 32)
-        if self.mode == 'sdd':
-            self.c_lut, self.c_width = sdd_lut(layout, block, device)
-            self.da_lut, self.da_width = dsd_lut(layout, block, step, True, device)
-            self.db_lut, self.db_width = dsd_lut(layout, block, step, False, device)
-        if self.mode == 'dsd':
-            self.c_lut, self.c_width = dsd_lut(layout, block, step, not self.trans_a, device)
-            self.da_lut, self.da_width = sdd_lut(layout, block, device)
-            self.db_lut, self.db_width = dsd_lut(layout, block, step, self.trans_a, device)
-        if self.mode == 'dds':
-            self.c_lut, self.c_width = dsd_lut(layout, block, step, self.trans_b, device)
-            self.da_lut, self.da_width = dsd_lut(layout, block, step, not self.trans_b, device)
-            self.db_lut, self.db_width = sdd_lut(layout, block, device)
-
-    def __call__(self, a, b, out=None):
+        self.c_lut, self.c_width, self.da_lut, self.da_width, self.db_lut, self.db_width = \
+            get_luts(layout, block, mode, trans_a, trans_b, device)
+
+    def __call__(self, a, b, out=None, layout=None):
+        """
+        :param layout: the layout of this call, in place of the layout of the
+            op, with the same block size; its look-up tables are cached
+        """
+        spdims = self.spdims
+        luts = self.c_lut, self.c_width, self.da_lut, self.da_width, self.db_lut, self.db_width
+        if layout is not None:
+            spdims = layout.shape
+            luts = get_luts(layout, self.block, self.mode, self.trans_a, self.trans_b, self.device)
         c = _matmul.apply(
-            a, b, self.trans_a, self.trans_b, self.trans_c, self.mode, self.spdims, self.block,
-            self.c_lut, self.c_width,
-            self.da_lut, self.da_width,
-            self.db_lut, self.db_width,
+            a, b, self.trans_a, self.trans_b, self.trans_c, self.mode, spdims, self.block,
+            *luts,
             out
         )
         return c
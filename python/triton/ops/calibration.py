@@ -0,0 +1,202 @@
+"""
+Measures the bandwidths and the matmul throughput that a device achieves,
+for the matmul performance model: the nominal numbers derived from the
+clocks overestimate some devices (e.g. the DRAM of A10 and L4) and the
+ratios between them differ across architectures.
+
+The results are saved per device model in the cache directory, so a device
+is calibrated once with :code:`calibrate()`, or with
+:code:`python -m triton.ops.calibration`.
+"""
+
+import json
+import os
+import re
+
+import torch
+
+import triton
+import triton.language as tl
+from triton.runtime.cache import default_cache_dir
+
+CALIBRATION_VERSION = 1
+
+# the calibration of each device, None when the device is not calibrated
+_calibrations = {}
+
+
+@triton.jit
+def _copy_kernel(X, Y, N, BLOCK: tl.constexpr):
+    offs = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+    mask = offs < N
+    tl.store(Y + offs, tl.load(X + offs, mask=mask), mask=mask)
+
+
+@triton.jit
+def _fill_kernel(Y, N, BLOCK: tl.constexpr):
+    offs = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+    tl.store(Y + offs, tl.zeros([BLOCK], dtype=tl.float32), mask=offs < N)
+
+
+@triton.jit
+def _l2_read_kernel(X, OUT, num_blocks, REPEAT, BLOCK: tl.constexpr):
+    # every program reads REPEAT blocks of X, which fits in the L2 cache
+    pid = tl.program_id(0)
+    num_programs = tl.num_programs(0)
+    acc = tl.zeros([BLOCK], dtype=tl.float32)
+    for r in range(0, REPEAT):
+        start = ((pid + r * num_programs) % num_blocks) * BLOCK
+        acc += tl.load(X + tl.multiple_of(start, BLOCK) + tl.arange(0, BLOCK))
+    # the sum keeps the loads alive
+    tl.store(OUT + pid, tl.sum(acc, axis=0))
+
+
+@triton.jit
+def _mma_kernel(A, B, C, K,
+                dot_out_dtype: tl.constexpr,
+                BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr):
+    # every program multiplies the same (BLOCK_M, K) and (K, BLOCK_N)
+    # operands, which stay in the L2 cache
+    rm = tl.arange(0, BLOCK_M)
+    rn = tl.arange(0, BLOCK_N)
+    rk = tl.arange(0, BLOCK_K)
+    A = A + (rm[:, None] * K + rk[None, :])
+    B = B + (rk[:, None] * BLOCK_N + rn[None, :])
+    acc = tl.zeros((BLOCK_M, BLOCK_N), dtype=dot_out_dtype)
+    for k in range(0, K, BLOCK_K):
+        acc += tl.dot(tl.load(A), tl.load(B), out_dtype=dot_out_dtype)
+        A += BLOCK_K
+        B += BLOCK_K * BLOCK_N
+    C = C + tl.program_id(0) * BLOCK_M * BLOCK_N + (rm[:, None] * BLOCK_N + rn[None, :])
+    tl.store(C, acc.to(C.dtype.element_ty))
+
+
+def _get_path(device):
+    name = re.sub(r'[^\w.-]', '_', torch.cuda.get_device_name(device))
+    cache_dir = os.getenv("TRITON_CACHE_DIR", default_cache_dir())
+    return os.path.join(cache_dir, "calibration", f"{name}.json")
+
+
+def _measure_dram_gbps(device):
+    n = 64 * 1024 * 1024
+    x = torch.ones(n, dtype=torch.float32, device=device)
+    y = torch.empty_like(x)
+    grid = (triton.cdiv(n, 1024),)
+    ms = triton.testing.do_bench(lambda: _copy_kernel[grid](x, y, n, BLOCK=1024))
+    # the copy reads and writes every byte
+    return 2 * x.numel() * x.element_size() / (1024 * 1024) / ms
+
+
+def _measure_store_gbps(device):
+    n = 64 * 1024 * 1024
+    y = torch.empty(n, dtype=torch.float32, device=device)
+    grid = (triton.cdiv(n, 1024),)
+    ms = triton.testing.do_bench(lambda: _fill_kernel[grid](y, n, BLOCK=1024))
+    return y.numel() * y.element_size() / (1024 * 1024) / ms
+
+
+def _measure_l2_gbps(device, props):
+    block = 1024
+    # half of the L2 cache, so that the reads hit
+    num_blocks = max(props.get("l2_cache_size", 0) // 2 // (4 * block), 1)
+    x = torch.ones(num_blocks * block, dtype=torch.float32, device=device)
+    num_programs = props["multiprocessor_count"] * 8
+    out = torch.empty(num_programs, dtype=torch.float32, device=device)
+    repeat = 256
+    ms = triton.testing.do_bench(lambda: _l2_read_kernel[(num_programs,)](x, out, num_blocks, repeat, BLOCK=block))
+    return num_programs * repeat * block * x.element_size() / (1024 * 1024) / ms
+
+
+def _measure_mma_tflops(device, props, dtype):
+    K = 4096
+    num_programs = props["multiprocessor_count"] * 4
+    int8 = dtype == torch.int8
+    dot_out_dtype = tl.int32 if int8 else tl.float32
+    # a large tile first, the fallback for the devices with less shared memory
+    for BLOCK_M, BLOCK_N, BLOCK_K, num_warps, num_stages in [(128, 256, 64 if int8 else 32, 8, 3),
+                                                             (128, 128, 64 if int8 else 32, 4, 2)]:
+        if int8:
+            a = torch.randint(-8, 8, (BLOCK_M, K), dtype=dtype, device=device)
+            b = torch.randint(-8, 8, (K, BLOCK_N), dtype=dtype, device=device)
+            c = torch.empty((num_programs * BLOCK_M, BLOCK_N), dtype=torch.int32, device=device)
+        else:
+            a = torch.randn((BLOCK_M, K), dtype=dtype, device=device)
+            b = torch.randn((K, BLOCK_N), dtype=dtype, device=device)
+            c = torch.empty((num_programs * BLOCK_M, BLOCK_N), dtype=dtype, device=device)
+        fn = lambda: _mma_kernel[(num_programs,)](a, b, c, K, dot_out_dtype=dot_out_dtype, BLOCK_M=BLOCK_M,
+                                                  BLOCK_N=BLOCK_N, BLOCK_K=BLOCK_K, num_warps=num_warps,
+                                                  num_stages=num_stages)
+        try:
+            ms = triton.testing.do_bench(fn)
+        except triton.OutOfResources:
+            continue
+        # in the units of get_max_tensorcore_tflops
+        return 2 * num_programs * BLOCK_M * BLOCK_N * K / (1024 * 1024 * 1024) / ms
+    return None
+
+
+def calibrate(device=None, save=True):
+    """
+    Measures the achieved DRAM copy, store and L2 read bandwidths in GB/s,
+    and the throughput of a matmul with operands in the L2 cache in TFLOPS
+    for each dtype with tensor cores, then saves them as the calibration of
+    the device.
+
+    :param device: the device, the current one by default
+    :param save: also writes the calibration to the cache directory
+    :return: the calibration, a dict of :code:`dram_gbps`,
+        :code:`store_gbps`, :code:`l2_gbps` and :code:`mma_tflops` (keyed by
+        the name of the torch dtype)
+    """
+    from triton.runtime import driver
+    if device is None:
+        device = torch.cuda.current_device()
+    props = driver.utils.get_device_properties(device)
+    capability = torch.cuda.get_device_capability(device)
+    # the tensor cores of Volta and Turing only take fp16 operands
+    dtypes = [torch.float16, torch.bfloat16, torch.float32, torch.int8] if capability[0] >= 8 else [torch.float16]
+    mma_tflops = {}
+    for dtype in dtypes:
+        tflops = _measure_mma_tflops(device, props, dtype)
+        if tflops is not None:
+            mma_tflops[str(dtype)] = tflops
+    calibration = {"version": CALIBRATION_VERSION,
+                   "device": torch.cuda.get_device_name(device),
+                   "dram_gbps": _measure_dram_gbps(device),
+                   "store_gbps": _measure_store_gbps(device),
+                   "l2_gbps": _measure_l2_gbps(device, props),
+                   "mma_tflops": mma_tflops}
+    if save:
+        path = _get_path(device)
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        # written atomically: other processes may be reading it
+        tmp_path = f"{path}.tmp.pid_{os.getpid()}"
+        with open(tmp_path, "w") as f:
+            json.dump(calibration, f)
+        os.replace(tmp_path, path)
+    _calibrations[device] = calibration
+    return calibration
+
+
+def get_calibration(device=None):
+    """
+    Returns the saved calibration of the device (see :code:`calibrate`), or
+    None if the device model has not been calibrated.
+    """
+    if device is None:
+        device = torch.cuda.current_device()
+    if device not in _calibrations:
+        calibration = None
+        path = _get_path(device)
+        if os.path.exists(path):
+            with open(path) as f:
+                calibration = json.load(f)
+            # calibrations of older versions are measured again
+            if calibration.get("version") != CALIBRATION_VERSION:
+                calibration = None
+        _calibrations[device] = calibration
+    return _calibrations[device]
+
+
+if __name__ == "__main__":
+    print(json.dumps(calibrate(), indent=2))
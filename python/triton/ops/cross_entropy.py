@@ -23,83 +23,113 @@ def num_warps(N):
     return 16
 
 
-@triton.heuristics({'num_warps': lambda nargs: num_warps(nargs['N'])})
-@triton.heuristics({'BLOCK': lambda nargs: next_power_of_2(nargs['N'])})
+# the vocabulary is processed in chunks of at most MAX_BLOCK columns, so
+# that the registers of a program do not grow with the vocabulary size
+MAX_BLOCK = 4096
+
+
+def block_size(N):
+    return min(next_power_of_2(N), MAX_BLOCK)
+
+
+@triton.heuristics({'num_warps': lambda nargs: num_warps(block_size(nargs['N']))})
+@triton.heuristics({'BLOCK': lambda nargs: block_size(nargs['N'])})
 @triton.jit
-def _forward(LOGITS, PROBS, IDX, LOSS, N, BLOCK: tl.constexpr):
+def _forward(LOGITS, IDX, LOSS, LSE, N, label_smoothing, z_loss, BLOCK: tl.constexpr):
     row = tl.program_id(0)
     cols = tl.arange(0, BLOCK)
     idx = tl.load(IDX + row)
-    # pointers to logit and probs
-    LOGITS = LOGITS + row * N + cols
-    WRIT_PROBS = PROBS + row * N + cols
-    READ_PROBS = PROBS + row * N + idx
-    # write-back negative log-probs
-    logits = tl.load(LOGITS, mask=cols < N, other=-float('inf'))
-    logits = logits.to(tl.float32)
-    logits = logits - tl.max(logits, 0)
-    probs = tl.log(tl.sum(tl.exp(logits), 0)) - logits
-    tl.store(WRIT_PROBS, probs, mask=cols < N)
-    # There is a bug in the compiler, which fails to insert a barrier here.
-    # We add it explicitly for now. Will be fixed soon.
-    tl.debug_barrier()
-    # write-back loss
-    probs = tl.load(READ_PROBS)
-    tl.store(LOSS + row, probs)
-
-
-@triton.heuristics({'num_warps': lambda nargs: num_warps(nargs['N'])})
-@triton.heuristics({'BLOCK': lambda nargs: next_power_of_2(nargs['N'])})
+    LOGITS = LOGITS + row.to(tl.int64) * N
+    # online log-sum-exp: every column of the chunk keeps its own running
+    # max and sum, which are reduced once after the loop
+    m = tl.zeros([BLOCK], dtype=tl.float32) - float("inf")
+    s = tl.zeros([BLOCK], dtype=tl.float32)
+    sum_logits = tl.zeros([BLOCK], dtype=tl.float32)
+    for start in range(0, N, BLOCK):
+        mask = start + cols < N
+        logits = tl.load(LOGITS + start + cols, mask=mask, other=-float('inf')).to(tl.float32)
+        m_new = tl.maximum(m, logits)
+        # the columns past N have not seen any logit yet
+        m_safe = tl.where(m_new == -float('inf'), 0., m_new)
+        s = s * tl.exp(m - m_safe) + tl.exp(logits - m_safe)
+        m = m_new
+        sum_logits += tl.where(mask, logits, 0.)
+    m_max = tl.max(m, 0)
+    lse = m_max + tl.log(tl.sum(s * tl.exp(m - m_max), 0))
+    # -log(p[idx]), with the smoothing over the uniform distribution
+    target = tl.load(LOGITS + idx).to(tl.float32)
+    loss = lse - (1. - label_smoothing) * target - label_smoothing * tl.sum(sum_logits, 0) / N
+    loss += z_loss * lse * lse
+    tl.store(LSE + row, lse)
+    tl.store(LOSS + row, loss)
+
+
+@triton.heuristics({'num_warps': lambda nargs: num_warps(block_size(nargs['N']))})
+@triton.heuristics({'BLOCK': lambda nargs: block_size(nargs['N'])})
 @triton.jit
-def _backward(PROBS, IDX, DPROBS, N, BLOCK: tl.constexpr):
+def _backward(LOGITS, DLOGITS, IDX, LSE, DLOSS, N, label_smoothing, z_loss, BLOCK: tl.constexpr):
     row = tl.program_id(0)
     cols = tl.arange(0, BLOCK)
     idx = tl.load(IDX + row)
-    # pointers to probs
-    PROBS = PROBS + row * N + cols
-    # We know d(-log(p[i])/dlogit[k] = -id_mat[i,k] + p[k]
-    # and we have -log(p[k]) stored in PROBS, so this is easy
-    probs = -tl.load(PROBS, mask=cols < N, other=float('inf'))
-    probs = tl.exp(probs.to(tl.float32))
-    delta = cols == idx
-    # write result in-place in PROBS
-    dout = tl.load(DPROBS + row)
-    din = (probs - delta) * dout
-    tl.store(PROBS, din.to(PROBS.dtype.element_ty), mask=cols < N)
+    LOGITS = LOGITS + row.to(tl.int64) * N
+    DLOGITS = DLOGITS + row.to(tl.int64) * N
+    lse = tl.load(LSE + row)
+    dout = tl.load(DLOSS + row).to(tl.float32)
+    # We know d(-log(p[i])/dlogit[k] = -id_mat[i,k] + p[k]; the softmax is
+    # recomputed from the saved log-sum-exp, and d(lse^2)/dlogit[k] is
+    # 2 * lse * p[k]
+    scale = 1. + 2. * z_loss * lse
+    for start in range(0, N, BLOCK):
+        mask = start + cols < N
+        logits = tl.load(LOGITS + start + cols, mask=mask, other=0.).to(tl.float32)
+        probs = tl.exp(logits - lse)
+        delta = tl.where(start + cols == idx, 1. - label_smoothing, 0.)
+        din = (probs * scale - delta - label_smoothing / N) * dout
+        tl.store(DLOGITS + start + cols, din.to(DLOGITS.dtype.element_ty), mask=mask)
 
 
 class _cross_entropy(torch.autograd.Function):
     @classmethod
-    def forward(cls, ctx, logits, indices):
+    def forward(cls, ctx, logits, indices, label_smoothing=0., z_loss=0.):
         # make sure we can use triton
         assert (indices.dtype == torch.int64), "Indices are expected to be of type long."
+        assert 0. <= label_smoothing <= 1., "label_smoothing must be in [0, 1]"
+        logits = logits.contiguous()
         # make kernel
         device, dtype = logits.device, logits.dtype
         n_cols = logits.shape[-1]
         # run the kernel
         result = torch.empty_like(indices, dtype=dtype, device=device)
-        neg_logprobs = torch.empty_like(logits, dtype=dtype, device=device)
+        lse = torch.empty_like(indices, dtype=torch.float32, device=device)
         grid = lambda opt: (logits.numel() // n_cols, )
-        _forward[grid](logits, neg_logprobs, indices, result, n_cols)
-        # save for backward
-        ctx.save_for_backward(neg_logprobs, indices)
+        _forward[grid](logits, indices, result, lse, n_cols, float(label_smoothing), float(z_loss))
+        # save for backward: a float per row in place of the probabilities
+        ctx.save_for_backward(logits, indices, lse)
+        ctx.label_smoothing = float(label_smoothing)
+        ctx.z_loss = float(z_loss)
         return result
 
     @classmethod
     def backward(cls, ctx, dneg_logprobs):
-        """We know d(-log(p[i])/dlogit[k] = -id_mat[i,k] + p[k]
-        so we initialize the gradient as neg_logprobs, so we can just exponentiate
-        to get p[k], which is most of what we need...  neg_logprobs will be
-        modified in place to become the gradient we want
-        """
         # load saved tensors
-        neg_logprobs, indices = ctx.saved_tensors
+        logits, indices, lse = ctx.saved_tensors
         # run the kernel
-        # neg_logprobs will be modified in place to become our gradient:
-        n_cols = neg_logprobs.shape[-1]
-        grid = lambda opt: (neg_logprobs.numel() // n_cols, )
-        _backward[grid](neg_logprobs, indices, dneg_logprobs, n_cols)
-        return neg_logprobs, None
+        dlogits = torch.empty_like(logits)
+        n_cols = logits.shape[-1]
+        grid = lambda opt: (logits.numel() // n_cols, )
+        _backward[grid](logits, dlogits, indices, lse, dneg_logprobs.contiguous(), n_cols,
+                        ctx.label_smoothing, ctx.z_loss)
+        return dlogits, None, None, None
+
 
+def cross_entropy(logits, indices, label_smoothing=0., z_loss=0.):
+    """
+    Returns the cross-entropy loss of each row of :code:`logits` for the
+    classes :code:`indices`.
 
-cross_entropy = _cross_entropy.apply
+    :param label_smoothing: the weight of the uniform distribution mixed into
+        the target distribution, as in :code:`torch.nn.CrossEntropyLoss`
+    :param z_loss: the weight of the :code:`logsumexp(logits) ** 2` term
+        added to the loss, which keeps the logits from drifting
+    """
+    return _cross_entropy.apply(logits, indices, label_smoothing, z_loss)
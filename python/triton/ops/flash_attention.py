@@ -11,6 +11,48 @@ import triton
 import triton.language as tl
 
 
+@triton.jit
+def _fwd_inner(
+    acc, l_prev, m_prev, q,
+    k_ptrs, v_ptrs, sm_scale,
+    stride_kn, stride_vk,
+    offs_m, offs_n,
+    lo, hi, window,
+    MASKED: tl.constexpr, BLOCK_N: tl.constexpr,
+):
+    # Visits the keys in [lo, hi). Only the tiles that cross the diagonal or
+    # the edge of the window are MASKED: a query sees the keys up to its own
+    # position and within `window` of it.
+    k_ptrs += lo * stride_kn
+    v_ptrs += lo * stride_vk
+    for start_n in range(lo, hi, BLOCK_N):
+        # -- compute qk ----
+        k = tl.load(k_ptrs)
+        qk = tl.dot(q, k) * sm_scale
+        if MASKED:
+            dist = offs_m[:, None] - (start_n + offs_n[None, :])
+            qk = tl.where((dist >= 0) & (dist < window), qk, float("-inf"))
+        # compute new m
+        m_curr = tl.maximum(tl.max(qk, 1), m_prev)
+        # the edge of the window hides whole rows of a tile
+        m_sub = m_curr
+        if MASKED:
+            m_sub = tl.where(m_curr == float("-inf"), 0., m_curr)
+        # correct old l and acc
+        alpha = tl.exp(m_prev - m_sub)
+        # attention weights
+        p = tl.exp(qk - m_sub[:, None])
+        l_prev = l_prev * alpha + tl.sum(p, 1)
+        # update acc
+        v = tl.load(v_ptrs)
+        acc = acc * alpha[:, None] + tl.dot(p.to(v.dtype), v)
+        m_prev = m_curr
+        # update pointers
+        k_ptrs += BLOCK_N * stride_kn
+        v_ptrs += BLOCK_N * stride_vk
+    return acc, l_prev, m_prev
+
+
 @triton.jit
 def _fwd_kernel(
     Q, K, V, sm_scale,
@@ -20,7 +62,7 @@ def _fwd_kernel(
     stride_kz, stride_kh, stride_kn, stride_kk,
     stride_vz, stride_vh, stride_vk, stride_vn,
     stride_oz, stride_oh, stride_om, stride_on,
-    Z, H, N_CTX,
+    Z, H, N_CTX, window,
     BLOCK_M: tl.constexpr, BLOCK_DMODEL: tl.constexpr,
     BLOCK_N: tl.constexpr,
 ):
@@ -43,35 +85,20 @@ def _fwd_kernel(
     acc = tl.zeros([BLOCK_M, BLOCK_DMODEL], dtype=tl.float32)
     # load q: it will stay in SRAM throughout
     q = tl.load(q_ptrs)
-    # loop over k, v and update accumulator
-    for start_n in range(0, (start_m + 1) * BLOCK_M, BLOCK_N):
-        # -- compute qk ----
-        k = tl.load(k_ptrs)
-        qk = tl.zeros([BLOCK_M, BLOCK_N], dtype=tl.float32)
-        qk += tl.dot(q, k)
-        qk *= sm_scale
-        qk = tl.where(offs_m[:, None] >= (start_n + offs_n[None, :]), qk, float("-inf"))
-        # compute new m
-        m_curr = tl.maximum(tl.max(qk, 1), m_prev)
-        # correct old l
-        l_prev *= tl.exp(m_prev - m_curr)
-        # attention weights
-        p = tl.exp(qk - m_curr[:, None])
-        l_curr = tl.sum(p, 1) + l_prev
-        # rescale operands of matmuls
-        l_rcp = 1. / l_curr
-        p *= l_rcp[:, None]
-        acc *= (l_prev * l_rcp)[:, None]
-        # update acc
-        p = p.to(Q.dtype.element_ty)
-        v = tl.load(v_ptrs)
-        acc += tl.dot(p, v)
-        # update m_i and l_i
-        l_prev = l_curr
-        m_prev = m_curr
-        # update pointers
-        k_ptrs += BLOCK_N * stride_kn
-        v_ptrs += BLOCK_N * stride_vk
+    # loop over k, v and update accumulator. The keys before `lo` are out of
+    # the window of every query of the block; those in [full_lo, start_q) are
+    # visible to all of them and need no mask.
+    start_q = start_m * BLOCK_M
+    lo = tl.cdiv(tl.maximum(start_q - window - BLOCK_N + 2, 0), BLOCK_N) * BLOCK_N
+    full_lo = tl.minimum(tl.maximum(tl.cdiv(tl.maximum(start_q + BLOCK_M - window, 0), BLOCK_N) * BLOCK_N, lo),
+                         start_q)
+    acc, l_prev, m_prev = _fwd_inner(acc, l_prev, m_prev, q, k_ptrs, v_ptrs, sm_scale, stride_kn, stride_vk,
+                                     offs_m, offs_n, lo, full_lo, window, MASKED=True, BLOCK_N=BLOCK_N)
+    acc, l_prev, m_prev = _fwd_inner(acc, l_prev, m_prev, q, k_ptrs, v_ptrs, sm_scale, stride_kn, stride_vk,
+                                     offs_m, offs_n, full_lo, start_q, window, MASKED=False, BLOCK_N=BLOCK_N)
+    acc, l_prev, m_prev = _fwd_inner(acc, l_prev, m_prev, q, k_ptrs, v_ptrs, sm_scale, stride_kn, stride_vk,
+                                     offs_m, offs_n, start_q, start_q + BLOCK_M, window, MASKED=True, BLOCK_N=BLOCK_N)
+    acc = acc / l_prev[:, None]
     # rematerialize offsets to save registers
     start_m = tl.program_id(0)
     offs_m = start_m * BLOCK_M + tl.arange(0, BLOCK_M)
@@ -107,6 +134,51 @@ def _bwd_preprocess(
     tl.store(Delta + off_m, delta)
 
 
+@triton.jit
+def _bwd_inner(
+    dv, dk, k, v,
+    q_ptrs, do_ptrs, dq_ptrs, m_ptrs, D_ptrs, sm_scale, stride_qm,
+    offs_m, offs_n, q_lo, lo, hi, window,
+    MASKED: tl.constexpr, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr,
+):
+    # Visits the rows in [lo, hi); the pointers point to the rows at q_lo
+    q_ptrs += (lo - q_lo) * stride_qm
+    do_ptrs += (lo - q_lo) * stride_qm
+    dq_ptrs += (lo - q_lo) * stride_qm
+    for start_m in range(lo, hi, BLOCK_M):
+        offs_m_curr = start_m + offs_m
+        # load q, k, v, do on-chip
+        q = tl.load(q_ptrs)
+        # recompute p = softmax(qk, dim=-1).T
+        # NOTE: `do` is pre-divided by `l`; no normalization here
+        qk = tl.dot(q, tl.trans(k))
+        if MASKED:
+            dist = offs_m_curr[:, None] - offs_n[None, :]
+            qk = tl.where((dist >= 0) & (dist < window), qk, float("-inf"))
+        m = tl.load(m_ptrs + offs_m_curr)
+        p = tl.exp(qk * sm_scale - m[:, None])
+        # compute dv
+        do = tl.load(do_ptrs)
+        dv += tl.dot(tl.trans(p.to(k.dtype)), do)
+        # compute dp = dot(v, do)
+        Di = tl.load(D_ptrs + offs_m_curr)
+        dp = tl.zeros([BLOCK_M, BLOCK_N], dtype=tl.float32) - Di[:, None]
+        dp += tl.dot(do, tl.trans(v))
+        # compute ds = p * (dp - delta[:, None])
+        ds = p * dp * sm_scale
+        # compute dk = dot(ds.T, q)
+        dk += tl.dot(tl.trans(ds.to(k.dtype)), q)
+        # compute dq
+        dq = tl.load(dq_ptrs)
+        dq += tl.dot(ds.to(k.dtype), k)
+        tl.store(dq_ptrs, dq)
+        # increment pointers
+        dq_ptrs += BLOCK_M * stride_qm
+        q_ptrs += BLOCK_M * stride_qm
+        do_ptrs += BLOCK_M * stride_qm
+    return dv, dk
+
+
 @triton.jit
 def _bwd_kernel(
     Q, K, V, sm_scale, Out, DO,
@@ -116,7 +188,7 @@ def _bwd_kernel(
     stride_qz, stride_qh, stride_qm, stride_qk,
     stride_kz, stride_kh, stride_kn, stride_kk,
     stride_vz, stride_vh, stride_vk, stride_vn,
-    Z, H, N_CTX,
+    Z, H, N_CTX, window,
     num_block,
     BLOCK_M: tl.constexpr, BLOCK_DMODEL: tl.constexpr,
     BLOCK_N: tl.constexpr,
@@ -154,36 +226,19 @@ def _bwd_kernel(
         # k and v stay in SRAM throughout
         k = tl.load(k_ptrs)
         v = tl.load(v_ptrs)
-        # loop over rows
-        for start_m in range(lo, num_block * BLOCK_M, BLOCK_M):
-            offs_m_curr = start_m + offs_m
-            # load q, k, v, do on-chip
-            q = tl.load(q_ptrs)
-            # recompute p = softmax(qk, dim=-1).T
-            # NOTE: `do` is pre-divided by `l`; no normalization here
-            qk = tl.dot(q, tl.trans(k))
-            qk = tl.where(offs_m_curr[:, None] >= (offs_n[None, :]), qk, float("-inf"))
-            m = tl.load(m_ptrs + offs_m_curr)
-            p = tl.exp(qk * sm_scale - m[:, None])
-            # compute dv
-            do = tl.load(do_ptrs)
-            dv += tl.dot(tl.trans(p.to(Q.dtype.element_ty)), do)
-            # compute dp = dot(v, do)
-            Di = tl.load(D_ptrs + offs_m_curr)
-            dp = tl.zeros([BLOCK_M, BLOCK_N], dtype=tl.float32) - Di[:, None]
-            dp += tl.dot(do, tl.trans(v))
-            # compute ds = p * (dp - delta[:, None])
-            ds = p * dp * sm_scale
-            # compute dk = dot(ds.T, q)
-            dk += tl.dot(tl.trans(ds.to(Q.dtype.element_ty)), q)
-            # compute dq
-            dq = tl.load(dq_ptrs)
-            dq += tl.dot(ds.to(Q.dtype.element_ty), k)
-            tl.store(dq_ptrs, dq)
-            # increment pointers
-            dq_ptrs += BLOCK_M * stride_qm
-            q_ptrs += BLOCK_M * stride_qm
-            do_ptrs += BLOCK_M * stride_qm
+        # loop over rows: the diagonal block and the blocks crossing the edge
+        # of the window are masked, the rows past `hi` see none of the keys
+        hi = tl.minimum(num_block * BLOCK_M, (lo + BLOCK_M - 2 + window) // BLOCK_M * BLOCK_M + BLOCK_M)
+        full_hi = tl.minimum(hi, tl.maximum(lo + BLOCK_M, lo + window // BLOCK_M * BLOCK_M))
+        dv, dk = _bwd_inner(dv, dk, k, v, q_ptrs, do_ptrs, dq_ptrs, m_ptrs, D_ptrs, sm_scale, stride_qm,
+                            offs_m, offs_n, lo, lo, lo + BLOCK_M, window,
+                            MASKED=True, BLOCK_M=BLOCK_M, BLOCK_N=BLOCK_N)
+        dv, dk = _bwd_inner(dv, dk, k, v, q_ptrs, do_ptrs, dq_ptrs, m_ptrs, D_ptrs, sm_scale, stride_qm,
+                            offs_m, offs_n, lo, lo + BLOCK_M, full_hi, window,
+                            MASKED=False, BLOCK_M=BLOCK_M, BLOCK_N=BLOCK_N)
+        dv, dk = _bwd_inner(dv, dk, k, v, q_ptrs, do_ptrs, dq_ptrs, m_ptrs, D_ptrs, sm_scale, stride_qm,
+                            offs_m, offs_n, lo, full_hi, hi, window,
+                            MASKED=True, BLOCK_M=BLOCK_M, BLOCK_N=BLOCK_N)
         # write-back
         dv_ptrs = DV + (offs_n[:, None] * stride_qm + offs_k[None, :] * stride_qk)
         dk_ptrs = DK + (offs_n[:, None] * stride_kn + offs_k[None, :] * stride_kk)
@@ -194,7 +249,7 @@ def _bwd_kernel(
 class _attention(torch.autograd.Function):
 
     @staticmethod
-    def forward(ctx, q, k, v, sm_scale):
+    def forward(ctx, q, k, v, sm_scale, window=None):
         # only support for Ampere now
         capability = torch.cuda.get_device_capability()
         if capability[0] < 8:
@@ -210,6 +265,10 @@ class _attention(torch.autograd.Function):
         L = torch.empty((q.shape[0] * q.shape[1], q.shape[2]), device=q.device, dtype=torch.float32)
         m = torch.empty((q.shape[0] * q.shape[1], q.shape[2]), device=q.device, dtype=torch.float32)
         num_warps = 4 if Lk <= 64 else 8
+        # a query attends to the `window` keys up to its own position
+        if window is None:
+            window = q.shape[2]
+        assert window > 0, "window must be positive"
 
         _fwd_kernel[grid](
             q, k, v, sm_scale,
@@ -219,7 +278,7 @@ class _attention(torch.autograd.Function):
             k.stride(0), k.stride(1), k.stride(2), k.stride(3),
             v.stride(0), v.stride(1), v.stride(2), v.stride(3),
             o.stride(0), o.stride(1), o.stride(2), o.stride(3),
-            q.shape[0], q.shape[1], q.shape[2],
+            q.shape[0], q.shape[1], q.shape[2], window,
             BLOCK_M=BLOCK, BLOCK_N=BLOCK,
             BLOCK_DMODEL=Lk, num_warps=num_warps,
             num_stages=2,
@@ -228,6 +287,7 @@ class _attention(torch.autograd.Function):
         ctx.save_for_backward(q, k, v, o, L, m)
         ctx.grid = grid
         ctx.sm_scale = sm_scale
+        ctx.window = window
         ctx.BLOCK_DMODEL = Lk
         return o
 
@@ -255,13 +315,210 @@ class _attention(torch.autograd.Function):
             q.stride(0), q.stride(1), q.stride(2), q.stride(3),
             k.stride(0), k.stride(1), k.stride(2), k.stride(3),
             v.stride(0), v.stride(1), v.stride(2), v.stride(3),
-            q.shape[0], q.shape[1], q.shape[2],
+            q.shape[0], q.shape[1], q.shape[2], ctx.window,
             ctx.grid[0],
             BLOCK_M=BLOCK, BLOCK_N=BLOCK,
             BLOCK_DMODEL=ctx.BLOCK_DMODEL, num_warps=8,
             num_stages=1,
         )
-        return dq, dk, dv, None
+        return dq, dk, dv, None, None
 
 
 attention = _attention.apply
+
+
+@triton.jit
+def _paged_fwd_kernel(
+    Q, K, V, sm_scale,
+    Out, Lse,
+    BlockTable, CuSeqlensQ, SeqLensK,
+    stride_qt, stride_qh,
+    stride_kb, stride_kp, stride_kh,
+    stride_vb, stride_vp, stride_vh,
+    stride_os, stride_ot, stride_oh,
+    stride_ls, stride_lt,
+    stride_bt,
+    H, num_kv_groups, pages_per_split,
+    IS_CAUSAL: tl.constexpr,
+    BLOCK_M: tl.constexpr, BLOCK_DMODEL: tl.constexpr,
+    PAGE_SIZE: tl.constexpr,
+):
+    start_m = tl.program_id(0)
+    off_bh = tl.program_id(1)
+    split = tl.program_id(2)
+    off_b = off_bh // H
+    off_h = off_bh % H
+    # the query heads of a group share their key/value head
+    off_kv_h = off_h // num_kv_groups
+    # the queries of the sequence are packed after those of the previous ones
+    q_start = tl.load(CuSeqlensQ + off_b)
+    q_len = tl.load(CuSeqlensQ + off_b + 1) - q_start
+    k_len = tl.load(SeqLensK + off_b)
+    offs_m = start_m * BLOCK_M + tl.arange(0, BLOCK_M)
+    offs_p = tl.arange(0, PAGE_SIZE)
+    offs_d = tl.arange(0, BLOCK_DMODEL)
+    mask_m = offs_m < q_len
+    q_ptrs = Q + (q_start + offs_m)[:, None] * stride_qt + off_h * stride_qh + offs_d[None, :]
+    q = tl.load(q_ptrs, mask=mask_m[:, None], other=0.)
+    # the queries are the last tokens of the sequence
+    q_pos = k_len - q_len + offs_m
+    # pages of the keys and values visited by this split
+    page_lo = split * pages_per_split
+    page_hi = tl.minimum(page_lo + pages_per_split, tl.cdiv(k_len, PAGE_SIZE))
+    if IS_CAUSAL:
+        last_pos = k_len - q_len + tl.minimum((start_m + 1) * BLOCK_M, q_len) - 1
+        page_hi = tl.minimum(page_hi, last_pos // PAGE_SIZE + 1)
+    # the programs past the queries of the sequence visit no page
+    page_hi = tl.where(start_m * BLOCK_M < q_len, page_hi, page_lo)
+    m_i = tl.zeros([BLOCK_M], dtype=tl.float32) - float("inf")
+    l_i = tl.zeros([BLOCK_M], dtype=tl.float32)
+    acc = tl.zeros([BLOCK_M, BLOCK_DMODEL], dtype=tl.float32)
+    for page in range(page_lo, page_hi):
+        block = tl.load(BlockTable + off_b * stride_bt + page).to(tl.int64)
+        offs_n = page * PAGE_SIZE + offs_p
+        mask_n = offs_n < k_len
+        # -- compute qk ----
+        k_ptrs = K + block * stride_kb + offs_p[None, :] * stride_kp + off_kv_h * stride_kh + offs_d[:, None]
+        k = tl.load(k_ptrs, mask=mask_n[None, :], other=0.)
+        qk = tl.dot(q, k) * sm_scale
+        mask = mask_n[None, :]
+        if IS_CAUSAL:
+            mask = mask & (offs_n[None, :] <= q_pos[:, None])
+        qk = tl.where(mask, qk, float("-inf"))
+        # -- update the running max and sum; rows without visible keys
+        # keep a max of -inf and get no weight
+        m_curr = tl.maximum(m_i, tl.max(qk, 1))
+        m_safe = tl.where(m_curr == float("-inf"), 0., m_curr)
+        alpha = tl.exp(m_i - m_safe)
+        p = tl.exp(qk - m_safe[:, None])
+        l_i = l_i * alpha + tl.sum(p, 1)
+        v_ptrs = V + block * stride_vb + offs_p[:, None] * stride_vp + off_kv_h * stride_vh + offs_d[None, :]
+        v = tl.load(v_ptrs, mask=mask_n[:, None], other=0.)
+        acc = acc * alpha[:, None] + tl.dot(p.to(v.dtype), v)
+        m_i = m_curr
+    # an empty split has a log-sum-exp of -inf and no output
+    l_safe = tl.where(l_i == 0., 1., l_i)
+    acc = acc / l_safe[:, None]
+    lse = tl.where(l_i == 0., float("-inf"), m_i + tl.log(l_safe))
+    out_ptrs = Out + split * stride_os + (q_start + offs_m)[:, None] * stride_ot + off_h * stride_oh + offs_d[None, :]
+    tl.store(out_ptrs, acc, mask=mask_m[:, None])
+    lse_ptrs = Lse + split * stride_ls + (q_start + offs_m) * stride_lt + off_h
+    tl.store(lse_ptrs, lse, mask=mask_m)
+
+
+@triton.jit
+def _merge_splits_kernel(
+    PartialOut, PartialLse,
+    Out, Lse,
+    num_splits,
+    stride_ps, stride_pt, stride_ph,
+    stride_pls, stride_plt,
+    stride_ot, stride_oh,
+    stride_lt,
+    BLOCK_S: tl.constexpr, BLOCK_DMODEL: tl.constexpr,
+):
+    off_t = tl.program_id(0)
+    off_h = tl.program_id(1)
+    offs_s = tl.arange(0, BLOCK_S)
+    offs_d = tl.arange(0, BLOCK_DMODEL)
+    mask_s = offs_s < num_splits
+    lse_s = tl.load(PartialLse + offs_s * stride_pls + off_t * stride_plt + off_h, mask=mask_s, other=float("-inf"))
+    lse_max = tl.max(lse_s, 0)
+    lse_max = tl.where(lse_max == float("-inf"), 0., lse_max)
+    # each split is weighted by its share of the softmax denominator
+    w = tl.exp(lse_s - lse_max)
+    w_sum = tl.sum(w, 0)
+    o_ptrs = PartialOut + offs_s[:, None] * stride_ps + off_t * stride_pt + off_h * stride_ph + offs_d[None, :]
+    o_s = tl.load(o_ptrs, mask=mask_s[:, None], other=0.)
+    w_safe = tl.where(w_sum == 0., 1., w_sum)
+    out = tl.sum(o_s * w[:, None], 0) / w_safe
+    tl.store(Out + off_t * stride_ot + off_h * stride_oh + offs_d, out)
+    lse = tl.where(w_sum == 0., float("-inf"), lse_max + tl.log(w_safe))
+    tl.store(Lse + off_t * stride_lt + off_h, lse)
+
+
+def paged_attention(q, k_cache, v_cache, block_table, cu_seqlens_q, seq_lens_k, max_seqlen_q,
+                    sm_scale=None, causal=True, num_splits=None):
+    """
+    Attention of variable-length sequences over a paged key/value cache, for
+    the prefill and decode steps of serving.
+
+    The queries of the sequences are packed: the queries of sequence `b` are
+    the rows :code:`cu_seqlens_q[b]:cu_seqlens_q[b + 1]` of :code:`q`, and
+    are the last tokens of the :code:`seq_lens_k[b]` tokens of the sequence
+    in the cache. Page :code:`i` of sequence `b` holds its tokens
+    :code:`i * page_size:(i + 1) * page_size` and is the block
+    :code:`block_table[b, i]` of the cache.
+
+    :param q: the queries, of shape :code:`[total_q, H, D]`
+    :param k_cache: the keys, of shape :code:`[num_blocks, page_size, H_KV, D]`.
+        :code:`H` must be a multiple of :code:`H_KV`: groups of
+        :code:`H // H_KV` query heads share a key/value head (GQA, or MQA
+        with :code:`H_KV = 1`).
+    :param v_cache: the values, of the shape of :code:`k_cache`
+    :param block_table: the blocks of the pages of the sequences, of shape
+        :code:`[B, max_pages]`
+    :param cu_seqlens_q: the cumulative query lengths, of shape :code:`[B + 1]`
+    :param seq_lens_k: the lengths of the sequences in the cache, of shape
+        :code:`[B]`
+    :param max_seqlen_q: the largest query length
+    :param causal: whether a query only attends to the tokens up to its own
+    :param num_splits: the number of programs that split the pages of a
+        sequence when there are too few queries to fill the device; the
+        partial results are merged by their log-sum-exp. Chosen from the
+        number of multiprocessors by default.
+    :return: the output, of the shape and type of :code:`q`, and the
+        log-sum-exp of the scores of each query and head in float32
+    """
+    total_q, H, D = q.shape
+    num_blocks, page_size, H_KV, Dk = k_cache.shape
+    assert v_cache.shape == k_cache.shape and Dk == D
+    assert D in {16, 32, 64, 128}, "head dimension must be 16, 32, 64 or 128"
+    assert page_size >= 16 and (page_size & (page_size - 1)) == 0, "page size must be a power of 2 of at least 16"
+    assert H % H_KV == 0, "query heads must be a multiple of the key/value heads"
+    assert q.stride(2) == 1 and k_cache.stride(3) == 1 and v_cache.stride(3) == 1
+    B, max_pages = block_table.shape
+    if sm_scale is None:
+        sm_scale = D ** -0.5
+    BLOCK_M = 16 if max_seqlen_q <= 16 else 64
+    grid_m = triton.cdiv(max_seqlen_q, BLOCK_M)
+    if num_splits is None:
+        # fill the multiprocessors twice
+        num_sms = torch.cuda.get_device_properties(q.device).multi_processor_count
+        num_splits = max(1, min(triton.cdiv(2 * num_sms, grid_m * B * H), max_pages))
+    pages_per_split = triton.cdiv(max_pages, num_splits)
+    num_splits = triton.cdiv(max_pages, pages_per_split)
+    out = torch.empty_like(q)
+    lse = torch.empty((total_q, H), device=q.device, dtype=torch.float32)
+    if num_splits == 1:
+        partial_out, partial_lse = out.unsqueeze(0), lse.unsqueeze(0)
+    else:
+        partial_out = torch.empty((num_splits, total_q, H, D), device=q.device, dtype=torch.float32)
+        partial_lse = torch.empty((num_splits, total_q, H), device=q.device, dtype=torch.float32)
+    _paged_fwd_kernel[(grid_m, B * H, num_splits)](
+        q, k_cache, v_cache, sm_scale,
+        partial_out, partial_lse,
+        block_table, cu_seqlens_q, seq_lens_k,
+        q.stride(0), q.stride(1),
+        k_cache.stride(0), k_cache.stride(1), k_cache.stride(2),
+        v_cache.stride(0), v_cache.stride(1), v_cache.stride(2),
+        partial_out.stride(0), partial_out.stride(1), partial_out.stride(2),
+        partial_lse.stride(0), partial_lse.stride(1),
+        block_table.stride(0),
+        H, H // H_KV, pages_per_split,
+        IS_CAUSAL=causal,
+        BLOCK_M=BLOCK_M, BLOCK_DMODEL=D, PAGE_SIZE=page_size,
+        num_warps=4, num_stages=2,
+    )
+    if num_splits > 1:
+        _merge_splits_kernel[(total_q, H)](
+            partial_out, partial_lse,
+            out, lse,
+            num_splits,
+            partial_out.stride(0), partial_out.stride(1), partial_out.stride(2),
+            partial_lse.stride(0), partial_lse.stride(1),
+            out.stride(0), out.stride(1),
+            lse.stride(0),
+            BLOCK_S=max(triton.next_power_of_2(num_splits), 2), BLOCK_DMODEL=D,
+        )
+    return out, lse
@@ -1,7 +1,11 @@
+import statistics
+
 import torch
 
 import triton
 import triton.language as tl
+from triton.runtime import driver
+from triton.runtime.jit import TensorWrapper
 from .matmul_perf_model import early_config_prune, estimate_matmul_time
 
 
@@ -26,8 +30,8 @@ def get_configs_io_bound():
     return configs
 
 
-@triton.autotune(
-    configs=[
+def get_configs_compute_bound():
+    return [
         # basic configs for compute-bound matmuls
         triton.Config({'BLOCK_M': 128, 'BLOCK_N': 256, 'BLOCK_K': 32, 'SPLIT_K': 1}, num_stages=3, num_warps=8),
         triton.Config({'BLOCK_M': 256, 'BLOCK_N': 128, 'BLOCK_K': 32, 'SPLIT_K': 1}, num_stages=3, num_warps=8),
@@ -48,7 +52,11 @@ def get_configs_io_bound():
         triton.Config({'BLOCK_M': 64, 'BLOCK_N': 128, 'BLOCK_K': 64, 'SPLIT_K': 1}, num_stages=4, num_warps=4),
         triton.Config({'BLOCK_M': 128, 'BLOCK_N': 32, 'BLOCK_K': 64, 'SPLIT_K': 1}, num_stages=4, num_warps=4),
         triton.Config({'BLOCK_M': 64, 'BLOCK_N': 32, 'BLOCK_K': 64, 'SPLIT_K': 1}, num_stages=5, num_warps=2),
-    ] + get_configs_io_bound(),
+    ]
+
+
+@triton.autotune(
+    configs=get_configs_compute_bound() + get_configs_io_bound(),
     key=['M', 'N', 'K'],
     prune_configs_by={
         'early_config_prune': early_config_prune,
@@ -60,13 +68,15 @@ def get_configs_io_bound():
     'EVEN_K': lambda args: args['K'] % (args['BLOCK_K'] * args['SPLIT_K']) == 0,
 })
 @triton.jit
-def _kernel(A, B, C, M, N, K,
+def _kernel(A, B, C, W, M, N, K,
             stride_am, stride_ak,
             stride_bk, stride_bn,
             stride_cm, stride_cn,
             dot_out_dtype: tl.constexpr,
             BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr,
             GROUP_M: tl.constexpr, SPLIT_K: tl.constexpr, EVEN_K: tl.constexpr,
+            DETERMINISTIC: tl.constexpr,
+            EPILOGUE: tl.constexpr, E0, E1, E2, E3,
             ):
     # matrix multiplication
     pid = tl.program_id(0)
@@ -100,7 +110,6 @@ def _kernel(A, B, C, M, N, K,
         acc += tl.dot(a, b, out_dtype=dot_out_dtype)
         A += BLOCK_K * SPLIT_K * stride_ak
         B += BLOCK_K * SPLIT_K * stride_bk
-    acc = acc.to(C.dtype.element_ty)
     # rematerialize rm and rn to save registers
     rm = pid_m * BLOCK_M + tl.arange(0, BLOCK_M)
     rn = pid_n * BLOCK_N + tl.arange(0, BLOCK_N)
@@ -108,18 +117,330 @@ def _kernel(A, B, C, M, N, K,
     mask = (rm < M)[:, None] & (rn < N)[None, :]
     # handles write-back with reduction-splitting
     if SPLIT_K == 1:
-        tl.store(C, acc, mask=mask)
+        if EPILOGUE is not None:
+            acc = EPILOGUE(acc, rm, rn, M, N, E0, E1, E2, E3)
+        tl.store(C, acc.to(C.dtype.element_ty), mask=mask)
+    elif DETERMINISTIC:
+        # partial results are kept in the accumulator type in the (SPLIT_K, M, N)
+        # workspace, and summed in a fixed order by _split_k_reduce
+        W = W + ((pid_z * M + rm[:, None]) * N + rn[None, :])
+        tl.store(W, acc, mask=mask)
     else:
+        tl.atomic_add(C, acc.to(C.dtype.element_ty), mask=mask)
+
+
+@triton.jit
+def _split_k_reduce(W, C, M, N,
+                    stride_cm, stride_cn,
+                    BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, SPLIT_K: tl.constexpr,
+                    EPILOGUE: tl.constexpr, E0, E1, E2, E3,
+                    ):
+    # sums the partial results of the deterministic reduction-splitting
+    pid_m = tl.program_id(0)
+    pid_n = tl.program_id(1)
+    rm = pid_m * BLOCK_M + tl.arange(0, BLOCK_M)
+    rn = pid_n * BLOCK_N + tl.arange(0, BLOCK_N)
+    mask = (rm < M)[:, None] & (rn < N)[None, :]
+    W = W + (rm[:, None] * N + rn[None, :])
+    acc = tl.load(W, mask=mask, other=0)
+    for _ in range(1, SPLIT_K):
+        W += M * N
+        acc += tl.load(W, mask=mask, other=0)
+    if EPILOGUE is not None:
+        acc = EPILOGUE(acc, rm, rn, M, N, E0, E1, E2, E3)
+    C = C + (rm[:, None] * stride_cm + rn[None, :] * stride_cn)
+    tl.store(C, acc.to(C.dtype.element_ty), mask=mask)
+
+
+def get_configs_persistent(pre_hook=None):
+    # persistent kernels walk the K loop of a tile in a single program, so
+    # only the compute-bound configs (without reduction-splitting) apply
+    configs = []
+    for config in get_configs_compute_bound():
+        kwargs = {k: v for k, v in config.kwargs.items() if k != 'SPLIT_K'}
+        configs.append(triton.Config(kwargs, num_stages=config.num_stages, num_warps=config.num_warps,
+                                     pre_hook=pre_hook))
+    return configs
+
+
+@triton.jit
+def _tile_coords(tile_id, grid_m, grid_n, GROUP_M: tl.constexpr, SCHEDULE: tl.constexpr):
+    if SCHEDULE == "row_major":
+        pid_m = tile_id // grid_n
+        pid_n = tile_id % grid_n
+    else:
+        # re-order tile ID for better L2 performance
+        width = GROUP_M * grid_n
+        group_id = tile_id // width
+        group_size = min(grid_m - group_id * GROUP_M, GROUP_M)
+        pid_m = group_id * GROUP_M + (tile_id % group_size)
+        pid_n = (tile_id % width) // (group_size)
+    return pid_m, pid_n
+
+
+@triton.jit
+def _tile_mac_loop(A, B, M, N, K,
+                   stride_am, stride_ak,
+                   stride_bk, stride_bn,
+                   pid_m, pid_n, k_start, k_end,
+                   dot_out_dtype: tl.constexpr,
+                   BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr,
+                   EVEN_K: tl.constexpr,
+                   ):
+    # accumulates the K-iterations [k_start, k_end) of tile (pid_m, pid_n)
+    rm = pid_m * BLOCK_M + tl.arange(0, BLOCK_M)
+    rn = pid_n * BLOCK_N + tl.arange(0, BLOCK_N)
+    ram = tl.max_contiguous(tl.multiple_of(rm % M, BLOCK_M), BLOCK_M)
+    rbn = tl.max_contiguous(tl.multiple_of(rn % N, BLOCK_N), BLOCK_N)
+    rk = tl.arange(0, BLOCK_K)
+    # pointers
+    A = A + (ram[:, None] * stride_am + (k_start * BLOCK_K + rk[None, :]) * stride_ak)
+    B = B + ((k_start * BLOCK_K + rk[:, None]) * stride_bk + rbn[None, :] * stride_bn)
+    acc = tl.zeros((BLOCK_M, BLOCK_N), dtype=dot_out_dtype)
+    for k in range(k_start, k_end):
+        if EVEN_K:
+            a = tl.load(A)
+            b = tl.load(B)
+        else:
+            k_remaining = K - k * BLOCK_K
+            a = tl.load(A, mask=rk[None, :] < k_remaining, other=0.)
+            b = tl.load(B, mask=rk[:, None] < k_remaining, other=0.)
+        acc += tl.dot(a, b, out_dtype=dot_out_dtype)
+        A += BLOCK_K * stride_ak
+        B += BLOCK_K * stride_bk
+    return acc
+
+
+@triton.jit
+def _tile_write_back(C, acc, M, N, stride_cm, stride_cn, pid_m, pid_n,
+                     BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, ATOMIC: tl.constexpr):
+    acc = acc.to(C.dtype.element_ty)
+    rm = pid_m * BLOCK_M + tl.arange(0, BLOCK_M)
+    rn = pid_n * BLOCK_N + tl.arange(0, BLOCK_N)
+    C = C + (rm[:, None] * stride_cm + rn[None, :] * stride_cn)
+    mask = (rm < M)[:, None] & (rn < N)[None, :]
+    if ATOMIC:
         tl.atomic_add(C, acc, mask=mask)
+    else:
+        tl.store(C, acc, mask=mask)
+
+
+@triton.jit
+def _persistent_kernel(A, B, C, M, N, K,
+                       stride_am, stride_ak,
+                       stride_bk, stride_bn,
+                       stride_cm, stride_cn,
+                       dot_out_dtype: tl.constexpr,
+                       BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr,
+                       GROUP_M: tl.constexpr, SCHEDULE: tl.constexpr, EVEN_K: tl.constexpr,
+                       ):
+    # a fixed number of programs (about one per SM) loops over the output
+    # tiles, so that the tile count does not need to be a multiple of the
+    # SM count to keep every SM busy
+    pid = tl.program_id(0)
+    num_programs = tl.num_programs(0)
+    grid_m = tl.cdiv(M, BLOCK_M)
+    grid_n = tl.cdiv(N, BLOCK_N)
+    num_tiles = grid_m * grid_n
+    iters_per_tile = tl.cdiv(K, BLOCK_K)
+    if SCHEDULE == "stream_k":
+        # every program gets an even share of the flattened (tile, k)
+        # iteration space; tiles that straddle two programs are fixed up
+        # by accumulating the partial results into the zero-initialized C
+        total_iters = num_tiles * iters_per_tile
+        iters_per_program = tl.cdiv(total_iters, num_programs)
+        start_iter = pid * iters_per_program
+        end_iter = tl.minimum(start_iter + iters_per_program, total_iters)
+        for tile_id in range(start_iter // iters_per_tile, tl.cdiv(end_iter, iters_per_tile)):
+            pid_m, pid_n = _tile_coords(tile_id, grid_m, grid_n, GROUP_M, "grouped")
+            tile_start = tile_id * iters_per_tile
+            k_start = tl.maximum(start_iter, tile_start) - tile_start
+            k_end = tl.minimum(end_iter, tile_start + iters_per_tile) - tile_start
+            acc = _tile_mac_loop(A, B, M, N, K, stride_am, stride_ak, stride_bk, stride_bn,
+                                 pid_m, pid_n, k_start, k_end,
+                                 dot_out_dtype, BLOCK_M, BLOCK_N, BLOCK_K, EVEN_K)
+            if (k_start == 0) & (k_end == iters_per_tile):
+                _tile_write_back(C, acc, M, N, stride_cm, stride_cn, pid_m, pid_n, BLOCK_M, BLOCK_N, False)
+            else:
+                _tile_write_back(C, acc, M, N, stride_cm, stride_cn, pid_m, pid_n, BLOCK_M, BLOCK_N, True)
+    else:
+        for tile_id in range(pid, num_tiles, num_programs):
+            pid_m, pid_n = _tile_coords(tile_id, grid_m, grid_n, GROUP_M, SCHEDULE)
+            acc = _tile_mac_loop(A, B, M, N, K, stride_am, stride_ak, stride_bk, stride_bn,
+                                 pid_m, pid_n, 0, iters_per_tile,
+                                 dot_out_dtype, BLOCK_M, BLOCK_N, BLOCK_K, EVEN_K)
+            _tile_write_back(C, acc, M, N, stride_cm, stride_cn, pid_m, pid_n, BLOCK_M, BLOCK_N, False)
+
+
+def _autotune_persistent(pre_hook=None):
+    # one autotuner per schedule: the schedule is a constexpr and would
+    # otherwise not be part of the tuning key
+    return triton.autotune(
+        configs=get_configs_persistent(pre_hook),
+        key=['M', 'N', 'K'],
+        prune_configs_by={
+            'early_config_prune': early_config_prune,
+            'perf_model': estimate_matmul_time,
+            'top_k': 10
+        },
+    )(triton.heuristics({
+        'EVEN_K': lambda args: args['K'] % args['BLOCK_K'] == 0,
+    })(_persistent_kernel))
+
+
+PERSISTENT_SCHEDULES = ["row_major", "grouped", "stream_k"]
+
+
+def get_configs_grouped():
+    # the problems of grouped matmuls are typically small (e.g. the tokens
+    # routed to one expert), so smaller tiles are tuned as well
+    configs = []
+    for block_m, block_n, num_warps in [(128, 128, 8), (128, 64, 4), (64, 128, 4), (64, 64, 4), (32, 64, 2),
+                                        (16, 64, 2)]:
+        for block_k, num_stages in [(32, 4), (64, 3)]:
+            configs.append(triton.Config({'BLOCK_M': block_m, 'BLOCK_N': block_n, 'BLOCK_K': block_k},
+                                         num_stages=num_stages, num_warps=num_warps))
+    return configs
+
+
+def _bucket(x):
+    # the autotuning buckets of the problem shapes
+    return triton.next_power_of_2(max(int(x), 1))
+
+
+@triton.autotune(
+    configs=get_configs_grouped(),
+    key=['m_bucket', 'n_bucket', 'k_bucket', 'group_bucket'],
+)
+@triton.jit(do_not_specialize=["group_size", "m_bucket", "n_bucket", "k_bucket", "group_bucket"])
+def _grouped_kernel(A_PTRS, B_PTRS, C_PTRS, SIZES, STRIDES, group_size,
+                    m_bucket, n_bucket, k_bucket, group_bucket,
+                    DTYPE: tl.constexpr, dot_out_dtype: tl.constexpr,
+                    BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr,
+                    GROUP_M: tl.constexpr,
+                    ):
+    # a fixed number of programs loops over the tiles of all the problems:
+    # problem g has the (M, N, K) of SIZES[g], the leading dimensions of
+    # STRIDES[g], and its operands at the addresses A_PTRS[g], B_PTRS[g] and
+    # C_PTRS[g]. The tiles of problem g follow those of problem g - 1.
+    tile_id = tl.program_id(0)
+    num_programs = tl.num_programs(0)
+    problem_start = 0
+    for g in range(0, group_size):
+        M = tl.load(SIZES + g * 3)
+        N = tl.load(SIZES + g * 3 + 1)
+        K = tl.load(SIZES + g * 3 + 2)
+        grid_m = tl.cdiv(M, BLOCK_M)
+        grid_n = tl.cdiv(N, BLOCK_N)
+        num_tiles = grid_m * grid_n
+        while (tile_id >= problem_start) & (tile_id < problem_start + num_tiles):
+            lda = tl.load(STRIDES + g * 3)
+            ldb = tl.load(STRIDES + g * 3 + 1)
+            ldc = tl.load(STRIDES + g * 3 + 2)
+            A = tl.load(A_PTRS + g).to(tl.pointer_type(DTYPE))
+            B = tl.load(B_PTRS + g).to(tl.pointer_type(DTYPE))
+            C = tl.load(C_PTRS + g).to(tl.pointer_type(DTYPE))
+            pid_m, pid_n = _tile_coords(tile_id - problem_start, grid_m, grid_n, GROUP_M, "grouped")
+            acc = _tile_mac_loop(A, B, M, N, K, lda, 1, ldb, 1,
+                                 pid_m, pid_n, 0, tl.cdiv(K, BLOCK_K),
+                                 dot_out_dtype, BLOCK_M, BLOCK_N, BLOCK_K, False)
+            _tile_write_back(C, acc, M, N, ldc, 1, pid_m, pid_n, BLOCK_M, BLOCK_N, False)
+            tile_id += num_programs
+        problem_start += num_tiles
+
+
+@triton.autotune(
+    configs=get_configs_persistent(),
+    key=['M', 'N', 'K'],
+    prune_configs_by={
+        'early_config_prune': early_config_prune,
+        'perf_model': estimate_matmul_time,
+        'top_k': 10
+    },
+)
+@triton.heuristics({
+    'EVEN_K': lambda args: args['K'] % args['BLOCK_K'] == 0,
+})
+@triton.jit
+def _scaled_kernel(A, B, C, SCALE_A, SCALE_B, M, N, K,
+                   stride_am, stride_ak,
+                   stride_bk, stride_bn,
+                   stride_cm, stride_cn,
+                   ROW_SCALE_A: tl.constexpr, ROW_SCALE_B: tl.constexpr,
+                   BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr,
+                   GROUP_M: tl.constexpr, EVEN_K: tl.constexpr,
+                   ):
+    # C = (SCALE_A[:, None] * SCALE_B[None, :]) * (A @ B) for fp8 A and B; the
+    # scales are either one value per tensor, or one per row of A and one per
+    # column of B
+    pid = tl.program_id(0)
+    grid_m = tl.cdiv(M, BLOCK_M)
+    grid_n = tl.cdiv(N, BLOCK_N)
+    pid_m, pid_n = _tile_coords(pid, grid_m, grid_n, GROUP_M, "grouped")
+    rm = pid_m * BLOCK_M + tl.arange(0, BLOCK_M)
+    rn = pid_n * BLOCK_N + tl.arange(0, BLOCK_N)
+    ram = tl.max_contiguous(tl.multiple_of(rm % M, BLOCK_M), BLOCK_M)
+    rbn = tl.max_contiguous(tl.multiple_of(rn % N, BLOCK_N), BLOCK_N)
+    rk = tl.arange(0, BLOCK_K)
+    # pointers
+    A = A + (ram[:, None] * stride_am + rk[None, :] * stride_ak)
+    B = B + (rk[:, None] * stride_bk + rbn[None, :] * stride_bn)
+    acc = tl.zeros((BLOCK_M, BLOCK_N), dtype=tl.float32)
+    for k in range(0, tl.cdiv(K, BLOCK_K)):
+        if EVEN_K:
+            a = tl.load(A)
+            b = tl.load(B)
+        else:
+            k_remaining = K - k * BLOCK_K
+            a = tl.load(A, mask=rk[None, :] < k_remaining, other=0.)
+            b = tl.load(B, mask=rk[:, None] < k_remaining, other=0.)
+        # the tensor cores take fp16 operands: the fp8 tiles are converted in
+        # registers, after the loads that only move half the bytes
+        acc += tl.dot(a.to(tl.float16), b.to(tl.float16))
+        A += BLOCK_K * stride_ak
+        B += BLOCK_K * stride_bk
+    # rematerialize rm and rn to save registers
+    rm = pid_m * BLOCK_M + tl.arange(0, BLOCK_M)
+    rn = pid_n * BLOCK_N + tl.arange(0, BLOCK_N)
+    # scales the accumulator once in the epilogue
+    if ROW_SCALE_A:
+        acc *= tl.load(SCALE_A + rm, mask=rm < M, other=0.)[:, None]
+    else:
+        acc *= tl.load(SCALE_A)
+    if ROW_SCALE_B:
+        acc *= tl.load(SCALE_B + rn, mask=rn < N, other=0.)[None, :]
+    else:
+        acc *= tl.load(SCALE_B)
+    C = C + (rm[:, None] * stride_cm + rn[None, :] * stride_cn)
+    mask = (rm < M)[:, None] & (rn < N)[None, :]
+    tl.store(C, acc.to(C.dtype.element_ty), mask=mask)
+
+
+def _as_fp8(x):
+    # returns the fp8 tensor x, as a TensorWrapper, and its underlying tensor
+    if isinstance(x, TensorWrapper):
+        assert x.dtype in [tl.float8e4, tl.float8e5], "scaled_matmul takes fp8 operands"
+        return x, x.base
+    fp8_dtypes = {getattr(torch, 'float8_e4m3fn', None): tl.float8e4, getattr(torch, 'float8_e5m2', None): tl.float8e5}
+    assert x.dtype in fp8_dtypes, "scaled_matmul takes fp8 operands"
+    base = x.view(torch.int8)
+    return triton.reinterpret(base, fp8_dtypes[x.dtype]), base
 
 
 class _matmul(torch.autograd.Function):
     kernel = _kernel
+    scaled_kernel = _scaled_kernel
+    grouped_kernel = _grouped_kernel
+    persistent_kernels = {
+        "row_major": _autotune_persistent(),
+        "grouped": _autotune_persistent(),
+        "stream_k": _autotune_persistent(pre_hook=init_to_zero('C')),
+    }
 
     _locks = {}
 
     @staticmethod
-    def _call(a, b, dot_out_dtype):
+    def _call(a, b, dot_out_dtype, schedule=None, deterministic=False, epilogue=None, epilogue_args=()):
         device = a.device
         # handle non-contiguous inputs if necessary
         if a.stride(0) > 1 and a.stride(1) > 1:
@@ -128,10 +449,26 @@ class _matmul(torch.autograd.Function):
             b = b.contiguous()
         # checks constraints
         assert a.shape[1] == b.shape[0], "incompatible dimensions"
+        assert schedule is None or schedule in PERSISTENT_SCHEDULES, f"unknown schedule {schedule}"
+        assert not (deterministic and schedule == "stream_k"), "stream_k fixes up partial tiles with atomics"
+        assert epilogue is None or schedule is None, "epilogues are only supported without a persistent schedule"
+        assert len(epilogue_args) <= 4, "epilogues take at most 4 arguments"
+        # the epilogue of a split-k matmul runs on the sum of the partial
+        # results, so these are reduced through the workspace
+        if epilogue is not None:
+            deterministic = True
+        E0, E1, E2, E3 = tuple(epilogue_args) + (None,) * (4 - len(epilogue_args))
         M, K = a.shape
         _, N = b.shape
+        # stream-k fixes up partial tiles with atomic_add, which
+        # some dtypes do not allow
+        if schedule == "stream_k" and a.dtype not in [torch.float16, torch.float32]:
+            schedule = "grouped"
         # allocates output
-        c = torch.empty((M, N), device=device, dtype=a.dtype)
+        if schedule == "stream_k":
+            c = torch.zeros((M, N), device=device, dtype=a.dtype)
+        else:
+            c = torch.empty((M, N), device=device, dtype=a.dtype)
         if dot_out_dtype is None:
             if a.dtype in [torch.float16, torch.float32, torch.bfloat16]:
                 dot_out_dtype = tl.float32
@@ -146,18 +483,165 @@ class _matmul(torch.autograd.Function):
             else:
                 dot_out_dtype = tl.int32
         # launch kernel
-        grid = lambda META: (triton.cdiv(M, META['BLOCK_M']) * triton.cdiv(N, META['BLOCK_N']), META['SPLIT_K'])
-        _kernel[grid](a, b, c, M, N, K,
-                      a.stride(0), a.stride(1),
-                      b.stride(0), b.stride(1),
-                      c.stride(0), c.stride(1),
-                      dot_out_dtype=dot_out_dtype,
-                      GROUP_M=8)
+        if schedule is None:
+            # the deterministic reduction-splitting needs a workspace for the
+            # partial results of the largest SPLIT_K the autotuner may pick
+            if deterministic:
+                max_split_k = max(config.kwargs['SPLIT_K'] for config in _kernel.configs)
+                w_dtype = {tl.float16: torch.float16, tl.float32: torch.float32, tl.int32: torch.int32}[dot_out_dtype]
+                w = torch.empty((max_split_k, M, N), device=device, dtype=w_dtype)
+            else:
+                w = c
+            grid = lambda META: (triton.cdiv(M, META['BLOCK_M']) * triton.cdiv(N, META['BLOCK_N']), META['SPLIT_K'])
+            _kernel[grid](a, b, c, w, M, N, K,
+                          a.stride(0), a.stride(1),
+                          b.stride(0), b.stride(1),
+                          c.stride(0), c.stride(1),
+                          dot_out_dtype=dot_out_dtype,
+                          GROUP_M=8, DETERMINISTIC=deterministic,
+                          EPILOGUE=epilogue, E0=E0, E1=E1, E2=E2, E3=E3)
+            split_k = _kernel.best_config.kwargs['SPLIT_K']
+            if deterministic and split_k > 1:
+                grid = (triton.cdiv(M, 64), triton.cdiv(N, 64))
+                _split_k_reduce[grid](w, c, M, N,
+                                      c.stride(0), c.stride(1),
+                                      BLOCK_M=64, BLOCK_N=64, SPLIT_K=split_k,
+                                      EPILOGUE=epilogue, E0=E0, E1=E1, E2=E2, E3=E3)
+            return c
+        num_sms = driver.utils.get_device_properties(device.index)["multiprocessor_count"]
+        if schedule == "stream_k":
+            grid = lambda META: (num_sms,)
+        else:
+            grid = lambda META: (min(num_sms, triton.cdiv(M, META['BLOCK_M']) * triton.cdiv(N, META['BLOCK_N'])),)
+        _matmul.persistent_kernels[schedule][grid](a, b, c, M, N, K,
+                                                   a.stride(0), a.stride(1),
+                                                   b.stride(0), b.stride(1),
+                                                   c.stride(0), c.stride(1),
+                                                   dot_out_dtype=dot_out_dtype,
+                                                   GROUP_M=8, SCHEDULE=schedule)
+        return c
+
+    @staticmethod
+    def _call_grouped(a_list, b_list, dot_out_dtype=None):
+        assert len(a_list) == len(b_list) and len(a_list) > 0, "expected as many left and right operands"
+        device = a_list[0].device
+        dtype = a_list[0].dtype
+        # the kernel reads the rows of the operands with a unit stride
+        a_list = [a if a.stride(1) == 1 else a.contiguous() for a in a_list]
+        b_list = [b if b.stride(1) == 1 else b.contiguous() for b in b_list]
+        # checks constraints
+        for a, b in zip(a_list, b_list):
+            assert a.dtype == dtype and b.dtype == dtype, "all the operands must have the same dtype"
+            assert a.shape[1] == b.shape[0], "incompatible dimensions"
+        # allocates output
+        c_list = [torch.empty((a.shape[0], b.shape[1]), device=device, dtype=dtype) for a, b in zip(a_list, b_list)]
+        if dot_out_dtype is None:
+            dot_out_dtype = tl.float32 if dtype in [torch.float16, torch.float32, torch.bfloat16] else tl.int32
+        else:
+            dot_out_dtype = tl.float16 if dot_out_dtype == torch.float16 else tl.float32
+        # the problem descriptors
+        ptrs = torch.tensor([[a.data_ptr() for a in a_list], [b.data_ptr() for b in b_list],
+                             [c.data_ptr() for c in c_list]], dtype=torch.int64).to(device)
+        sizes = [[a.shape[0], b.shape[1], a.shape[1]] for a, b in zip(a_list, b_list)]
+        strides = [[a.stride(0), b.stride(0), c.stride(0)] for a, b, c in zip(a_list, b_list, c_list)]
+        # the tuning key is the median problem shape and the group size,
+        # rounded up to powers of 2
+        m_bucket, n_bucket, k_bucket = (_bucket(statistics.median_low(dim)) for dim in zip(*sizes))
+        sizes = torch.tensor(sizes, dtype=torch.int32).to(device)
+        strides = torch.tensor(strides, dtype=torch.int32).to(device)
+        group_size = len(a_list)
+        num_sms = driver.utils.get_device_properties(device.index)["multiprocessor_count"]
+        grid = lambda META: (num_sms,)
+        tl_dtype = {torch.float16: tl.float16, torch.bfloat16: tl.bfloat16, torch.float32: tl.float32,
+                    torch.int8: tl.int8}[dtype]
+        _grouped_kernel[grid](ptrs[0], ptrs[1], ptrs[2], sizes, strides, group_size,
+                              m_bucket, n_bucket, k_bucket, _bucket(group_size),
+                              DTYPE=tl_dtype, dot_out_dtype=dot_out_dtype, GROUP_M=8)
+        return c_list
+
+    @staticmethod
+    def _call_scaled(a, b, scale_a, scale_b, out_dtype=torch.float16):
+        a, a_base = _as_fp8(a)
+        b, b_base = _as_fp8(b)
+        device = a_base.device
+        # checks constraints
+        assert a_base.shape[1] == b_base.shape[0], "incompatible dimensions"
+        M, K = a_base.shape
+        _, N = b_base.shape
+        assert scale_a.numel() in [1, M], "scale_a must have one value, or one per row of a"
+        assert scale_b.numel() in [1, N], "scale_b must have one value, or one per column of b"
+        assert out_dtype in [torch.float16, torch.bfloat16, torch.float32], f"unsupported out_dtype {out_dtype}"
+        scale_a = scale_a.to(torch.float32).contiguous()
+        scale_b = scale_b.to(torch.float32).contiguous()
+        # allocates output
+        c = torch.empty((M, N), device=device, dtype=out_dtype)
+        # launch kernel
+        grid = lambda META: (triton.cdiv(M, META['BLOCK_M']) * triton.cdiv(N, META['BLOCK_N']),)
+        _scaled_kernel[grid](a, b, c, scale_a, scale_b, M, N, K,
+                             a_base.stride(0), a_base.stride(1),
+                             b_base.stride(0), b_base.stride(1),
+                             c.stride(0), c.stride(1),
+                             ROW_SCALE_A=scale_a.numel() > 1, ROW_SCALE_B=scale_b.numel() > 1,
+                             GROUP_M=8)
         return c
 
     @staticmethod
-    def forward(ctx, a, b, dot_out_dtype=None):
-        return _matmul._call(a, b, dot_out_dtype=dot_out_dtype)
+    def forward(ctx, a, b, dot_out_dtype=None, schedule=None, deterministic=False, epilogue=None, epilogue_args=()):
+        return _matmul._call(a, b, dot_out_dtype=dot_out_dtype, schedule=schedule, deterministic=deterministic,
+                             epilogue=epilogue, epilogue_args=epilogue_args)
+
+
+def matmul(a, b, dot_out_dtype=None, schedule=None, deterministic=False, epilogue=None, epilogue_args=()):
+    """
+    Computes :code:`a @ b`.
+
+    :param dot_out_dtype: the dtype of the accumulator
+    :param schedule: one of :code:`PERSISTENT_SCHEDULES` to run a persistent
+        kernel, or None
+    :param deterministic: sums the partial results of reduction-splitting in
+        a fixed order instead of with atomics
+    :param epilogue: a :code:`@triton.jit` function applied to the accumulator
+        before it is stored, e.g. to add a bias or a residual, apply an
+        activation or quantize the output, saving a round trip of the output
+        through memory. It is called as :code:`epilogue(acc, rm, rn, M, N, E0,
+        E1, E2, E3)` where :code:`acc` is the (BLOCK_M, BLOCK_N) tile of the
+        output in the accumulator dtype, :code:`rm` and :code:`rn` are its row
+        and column indices, which may be out of bounds, and :code:`E0` to
+        :code:`E3` are the :code:`epilogue_args`, None when not given. It
+        returns the tile to store. Each epilogue compiles its own kernel.
+    :param epilogue_args: up to 4 tensors or scalars passed to the epilogue
+    """
+    return _matmul.apply(a, b, dot_out_dtype, schedule, deterministic, epilogue, tuple(epilogue_args))
+
+
+def grouped_matmul(a_list, b_list, dot_out_dtype=None):
+    """
+    Computes :code:`[a @ b for a, b in zip(a_list, b_list)]` with one
+    launch, e.g. the matmuls of the experts of a mixture-of-experts layer.
+    The problems may all have different shapes; a persistent kernel walks
+    their tiles, and the autotuner keys on the median problem shape and the
+    number of problems rounded up to powers of 2.
+
+    :param a_list: the (M_i, K_i) left operands, all of the same dtype
+    :param b_list: the (K_i, N_i) right operands
+    :param dot_out_dtype: the dtype of the accumulator
+    """
+    return _matmul._call_grouped(list(a_list), list(b_list), dot_out_dtype=dot_out_dtype)
+
 
+def scaled_matmul(a, b, scale_a, scale_b, out_dtype=torch.float16):
+    """
+    Computes :code:`(scale_a[:, None] * scale_b[None, :]) * (a @ b)` for fp8
+    :code:`a` and :code:`b`, e.g. quantized activations and weights.
 
-matmul = _matmul.apply
+    :param a: the (M, K) fp8 left operand, either a :code:`float8_e4m3fn` or
+        :code:`float8_e5m2` torch tensor, or an int8 tensor reinterpreted with
+        :code:`triton.reinterpret(x, tl.float8e4)` (or :code:`tl.float8e5`)
+    :param b: the (K, N) fp8 right operand
+    :param scale_a: the dequantization scale of :code:`a`, one value for the
+        whole tensor or one per row
+    :param scale_b: the dequantization scale of :code:`b`, one value for the
+        whole tensor or one per column
+    :param out_dtype: the dtype of the result
+    """
+    return _matmul._call_scaled(a, b, scale_a, scale_b, out_dtype=out_dtype)
@@ -5,17 +5,56 @@ import torch
 import triton
 import triton._C.libtriton.triton as _triton
 from triton.runtime import driver
+from triton.runtime.jit import TensorWrapper
 from triton.testing import get_dram_gbps, get_max_simd_tflops, get_max_tensorcore_tflops
 
+from .calibration import get_calibration
+
+
+def get_operand_dtype(A):
+    # fp8 operands are reinterpreted int8 tensors, converted to fp16 for the
+    # tensor cores
+    if isinstance(A, TensorWrapper):
+        return torch.float16, A.base.element_size()
+    return A.dtype, A.element_size()
+
 
 def get_tensorcore_tflops(backend, device, num_ctas, num_warps, dtype):
     ''' return compute throughput in TOPS '''
     total_warps = num_ctas * min(num_warps, 4)
     num_subcores = driver.utils.get_device_properties(device)["multiprocessor_count"] * 4  # on recent GPUs
-    tflops = min(num_subcores, total_warps) / num_subcores * get_max_tensorcore_tflops(dtype, backend, device)
+    tflops = min(num_subcores, total_warps) / num_subcores * get_peak_tensorcore_tflops(backend, device, dtype)
     return tflops
 
 
+def get_peak_tensorcore_tflops(backend, device, dtype):
+    ''' return the measured matmul throughput if the device is calibrated, the nominal one otherwise '''
+    calibration = get_calibration(device)
+    if calibration is not None and str(dtype) in calibration["mma_tflops"]:
+        return calibration["mma_tflops"][str(dtype)]
+    return get_max_tensorcore_tflops(dtype, backend, device)
+
+
+def get_bandwidths(backend, device):
+    ''' return the DRAM, L2 and store bandwidths in GB/s '''
+    calibration = get_calibration(device)
+    if calibration is not None:
+        return calibration["dram_gbps"], calibration["l2_gbps"], calibration["store_gbps"]
+    dram_bw = get_dram_gbps(backend, device)
+    return dram_bw, dram_bw * 4, dram_bw * 0.6  # rough estimation (should be 4.7 for A100?)
+
+
+def get_mma_cycles(backend, device, dtype):
+    ''' return the cycles of a subcore per 16x8x16 mma '''
+    calibration = get_calibration(device)
+    if calibration is None or str(dtype) not in calibration["mma_tflops"]:
+        return 8  # ampere fp16
+    props = driver.utils.get_device_properties(device)
+    num_subcores = props["multiprocessor_count"] * 4
+    ops_per_cycle = calibration["mma_tflops"][str(dtype)] * 1e9 / (num_subcores * props["sm_clock_rate"])
+    return 2 * 16 * 8 * 16 / ops_per_cycle
+
+
 def get_simd_tflops(backend, device, num_ctas, num_warps, dtype):
     ''' return compute throughput in TOPS '''
     total_warps = num_ctas * min(num_warps, 4)
@@ -36,15 +75,14 @@ def estimate_matmul_time(
     num_warps, num_stages,
     A, B, C,
     M, N, K,
-    BLOCK_M, BLOCK_N, BLOCK_K, SPLIT_K,
+    BLOCK_M, BLOCK_N, BLOCK_K, SPLIT_K=1,
     debug=False, **kwargs
 ):
     ''' return estimated running time in ms
           = max(compute, loading) + store '''
     backend = _triton.runtime.backend.CUDA
     device = torch.cuda.current_device()
-    dtype = A.dtype
-    dtsize = A.element_size()
+    dtype, dtsize = get_operand_dtype(A)
 
     num_cta_m = triton.cdiv(M, BLOCK_M)
     num_cta_n = triton.cdiv(N, BLOCK_N)
@@ -63,9 +101,11 @@ def estimate_matmul_time(
     num_sm = driver.utils.get_device_properties(device)["multiprocessor_count"]
     active_cta_ratio = min(1, num_ctas / num_sm)
     active_cta_ratio_bw1 = min(1, num_ctas / 32)  # 32 active ctas are enough to saturate
-    active_cta_ratio_bw2 = max(min(1, (num_ctas - 32) / (108 - 32)), 0)  # 32-108, remaining 5%
-    dram_bw = get_dram_gbps(backend, device) * (active_cta_ratio_bw1 * 0.95 + active_cta_ratio_bw2 * 0.05)  # in GB/s
-    l2_bw = dram_bw * 4  # rough estimation (should be 4.7 for A100?)
+    active_cta_ratio_bw2 = max(min(1, (num_ctas - 32) / max(num_sm - 32, 1)), 0)  # 32-num_sm, remaining 5%
+    active_bw_ratio = active_cta_ratio_bw1 * 0.95 + active_cta_ratio_bw2 * 0.05
+    peak_dram_bw, peak_l2_bw, peak_store_bw = get_bandwidths(backend, device)
+    dram_bw = peak_dram_bw * active_bw_ratio  # in GB/s
+    l2_bw = peak_l2_bw * active_bw_ratio
     # assume 80% of (following) loads are in L2 cache
     load_a_dram = M * K * dtsize * (1 + 0.2 * (num_cta_n - 1))
     load_a_l2 = M * K * dtsize * 0.8 * (num_cta_n - 1)
@@ -78,7 +118,7 @@ def estimate_matmul_time(
     load_ms = total_dram / dram_bw + total_l2 / l2_bw
 
     # estimate storing time
-    store_bw = dram_bw * 0.6  # :o
+    store_bw = peak_store_bw * active_bw_ratio
     store_c_dram = M * N * dtsize * SPLIT_K / (1024 * 1024)  # MB
     if SPLIT_K == 1:
         store_ms = store_c_dram / store_bw
@@ -98,11 +138,11 @@ def estimate_matmul_time(
 
 
 def early_config_prune(configs, named_args):
+    backend = _triton.runtime.backend.CUDA
     device = torch.cuda.current_device()
     capability = torch.cuda.get_device_capability()
     # BLOCK_M, BLOCK_N, BLOCK_K, SPLIT_K, num_warps, num_stages
-    dtsize = named_args['A'].element_size()
-    dtype = named_args['A'].dtype
+    dtype, dtsize = get_operand_dtype(named_args['A'])
 
     # 1. make sure we have enough smem
     pruned_configs = []
@@ -119,14 +159,14 @@ def early_config_prune(configs, named_args):
 
     # Some dtypes do not allow atomic_add
     if dtype not in [torch.float16, torch.float32]:
-        configs = [config for config in configs if config.kwargs['SPLIT_K'] == 1]
+        configs = [config for config in configs if config.kwargs.get('SPLIT_K', 1) == 1]
 
     # group configs by (BLOCK_M,_N,_K, SPLIT_K, num_warps)
     configs_map = {}
     for config in configs:
         kw = config.kwargs
         BLOCK_M, BLOCK_N, BLOCK_K, SPLIT_K, num_warps, num_stages = \
-            kw['BLOCK_M'], kw['BLOCK_N'], kw['BLOCK_K'], kw['SPLIT_K'], config.num_warps, config.num_stages
+            kw['BLOCK_M'], kw['BLOCK_N'], kw['BLOCK_K'], kw.get('SPLIT_K', 1), config.num_warps, config.num_stages
 
         key = (BLOCK_M, BLOCK_N, BLOCK_K, SPLIT_K, num_warps)
         if key in configs_map:
@@ -140,7 +180,7 @@ def early_config_prune(configs, named_args):
         if capability[0] >= 8:
             # compute cycles (only works for ampere GPUs)
             mmas = BLOCK_M * BLOCK_N * BLOCK_K / (16 * 8 * 16)
-            mma_cycles = mmas / min(4, num_warps) * 8
+            mma_cycles = mmas / min(4, num_warps) * get_mma_cycles(backend, device, dtype)
 
             ldgsts_latency = 300  # Does this matter?
             optimal_num_stages = ldgsts_latency / mma_cycles
@@ -0,0 +1,282 @@
+"""
+Layer normalization and RMS normalization of the rows of a tensor, with an
+optional residual added to the input and an optional fp8 output.
+
+The kernels are persistent: a few programs per SM walk the rows, so that the
+weight and the bias are loaded once per program, and the backward pass
+accumulates the gradients of the weight and of the bias over the rows of
+each program, which are summed by a second kernel.
+"""
+
+import torch
+
+import triton
+import triton.language as tl
+from triton.runtime import driver
+
+# a row is normalized in a single block of at most MAX_FUSED_SIZE bytes
+MAX_FUSED_SIZE = 65536
+
+# the largest finite values of the fp8 outputs, which are saturated to them
+FP8_MAX = {tl.float8e4: 448., tl.float8e5: 57344.}
+
+
+def _prune_configs(configs, nargs):
+    # every thread of a row holds 4 elements at least
+    block = triton.next_power_of_2(nargs['N'])
+    pruned = [config for config in configs if config.num_warps * 32 * 4 <= block]
+    return pruned or configs[:1]
+
+
+def _get_configs():
+    return [triton.Config({}, num_warps=num_warps) for num_warps in [1, 2, 4, 8, 16]]
+
+
+@triton.autotune(
+    configs=_get_configs(),
+    key=['N', 'IS_RMS', 'HAS_RESIDUAL', 'QUANTIZE'],
+    prune_configs_by={'early_config_prune': _prune_configs},
+)
+@triton.jit
+def _forward(X, R, Y, H, W, B, Mean, Rstd, Scale, M, N,
+             stride_x, stride_r, stride_y, stride_h, eps,
+             IS_RMS: tl.constexpr, HAS_BIAS: tl.constexpr, HAS_RESIDUAL: tl.constexpr,
+             QUANTIZE: tl.constexpr, OUT_MAX: tl.constexpr, BLOCK_N: tl.constexpr):
+    cols = tl.arange(0, BLOCK_N)
+    mask = cols < N
+    w = tl.load(W + cols, mask=mask).to(tl.float32)
+    if HAS_BIAS:
+        b = tl.load(B + cols, mask=mask).to(tl.float32)
+    if QUANTIZE:
+        scale = tl.load(Scale)
+    for row in range(tl.program_id(0), M, tl.num_programs(0)):
+        row64 = row.to(tl.int64)
+        x = tl.load(X + row64 * stride_x + cols, mask=mask, other=0.).to(tl.float32)
+        if HAS_RESIDUAL:
+            x += tl.load(R + row64 * stride_r + cols, mask=mask, other=0.).to(tl.float32)
+            # the sum is the input of the backward pass and of the next residual
+            tl.store(H + row64 * stride_h + cols, x.to(H.dtype.element_ty), mask=mask)
+        if not IS_RMS:
+            mean = tl.sum(x, axis=0) / N
+            x = tl.where(mask, x - mean, 0.)
+            tl.store(Mean + row, mean)
+        rstd = 1 / tl.sqrt(tl.sum(x * x, axis=0) / N + eps)
+        tl.store(Rstd + row, rstd)
+        y = x * rstd * w
+        if HAS_BIAS:
+            y += b
+        if QUANTIZE:
+            y = tl.minimum(tl.maximum(y * scale, -OUT_MAX), OUT_MAX)
+        tl.store(Y + row64 * stride_y + cols, y.to(Y.dtype.element_ty), mask=mask)
+
+
+@triton.autotune(
+    configs=_get_configs(),
+    key=['N', 'IS_RMS', 'HAS_DH'],
+    prune_configs_by={'early_config_prune': _prune_configs},
+)
+@triton.jit
+def _backward(X, W, DY, DX, DH, DW, DB, Mean, Rstd, M, N,
+              stride_x, stride_dy, stride_dx, stride_dh,
+              IS_RMS: tl.constexpr, HAS_BIAS: tl.constexpr, HAS_DH: tl.constexpr,
+              BLOCK_N: tl.constexpr):
+    pid = tl.program_id(0)
+    cols = tl.arange(0, BLOCK_N)
+    mask = cols < N
+    w = tl.load(W + cols, mask=mask).to(tl.float32)
+    # the partial gradients of the weight and of the bias over the rows of
+    # the program
+    dw = tl.zeros([BLOCK_N], dtype=tl.float32)
+    db = tl.zeros([BLOCK_N], dtype=tl.float32)
+    for row in range(pid, M, tl.num_programs(0)):
+        row64 = row.to(tl.int64)
+        x = tl.load(X + row64 * stride_x + cols, mask=mask, other=0.).to(tl.float32)
+        dy = tl.load(DY + row64 * stride_dy + cols, mask=mask, other=0.).to(tl.float32)
+        rstd = tl.load(Rstd + row)
+        if not IS_RMS:
+            x = x - tl.load(Mean + row)
+        xhat = tl.where(mask, x * rstd, 0.)
+        wdy = w * dy
+        dw += dy * xhat
+        if HAS_BIAS:
+            db += dy
+        # dx = rstd * (wdy - xhat * mean(xhat * wdy) - mean(wdy)), without
+        # the last term for RMS normalization
+        c1 = tl.sum(xhat * wdy, axis=0) / N
+        if IS_RMS:
+            dx = (wdy - xhat * c1) * rstd
+        else:
+            c2 = tl.sum(wdy, axis=0) / N
+            dx = (wdy - (xhat * c1 + c2)) * rstd
+        if HAS_DH:
+            dx += tl.load(DH + row64 * stride_dh + cols, mask=mask, other=0.).to(tl.float32)
+        tl.store(DX + row64 * stride_dx + cols, dx.to(DX.dtype.element_ty), mask=mask)
+    tl.store(DW + pid * N + cols, dw, mask=mask)
+    if HAS_BIAS:
+        tl.store(DB + pid * N + cols, db, mask=mask)
+
+
+@triton.jit
+def _reduce_partials(P, OUT, num_partials, N, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr):
+    # OUT[n] = sum(P[:, n]) for the (num_partials, N) partial sums P
+    cols = tl.program_id(0) * BLOCK_N + tl.arange(0, BLOCK_N)
+    acc = tl.zeros([BLOCK_M, BLOCK_N], dtype=tl.float32)
+    for start in range(0, num_partials, BLOCK_M):
+        rows = start + tl.arange(0, BLOCK_M)
+        mask = (rows < num_partials)[:, None] & (cols < N)[None, :]
+        acc += tl.load(P + rows[:, None] * N + cols[None, :], mask=mask, other=0.)
+    tl.store(OUT + cols, tl.sum(acc, axis=0).to(OUT.dtype.element_ty), mask=cols < N)
+
+
+def _num_programs(M, device):
+    num_sms = driver.utils.get_device_properties(device.index)["multiprocessor_count"]
+    return max(1, min(M, 4 * num_sms))
+
+
+def _block_size(x):
+    N = x.shape[-1]
+    block = triton.next_power_of_2(N)
+    assert block * x.element_size() <= MAX_FUSED_SIZE, \
+        f"rows of more than {MAX_FUSED_SIZE // x.element_size()} elements are not supported"
+    return block
+
+
+def _rows(x):
+    # the (M, N) view of x, whose rows have a unit stride
+    x = x.reshape(-1, x.shape[-1])
+    return x if x.stride(-1) == 1 else x.contiguous()
+
+
+def _fp8_dtypes():
+    return {dtype: tl_dtype
+            for dtype, tl_dtype in [(getattr(torch, 'float8_e4m3fn', None), tl.float8e4),
+                                    (getattr(torch, 'float8_e5m2', None), tl.float8e5)]
+            if dtype is not None}
+
+
+def _norm_forward(x, weight, bias, residual, eps, is_rms, out_dtype=None, out_scale=None):
+    shape = x.shape
+    N = shape[-1]
+    assert weight.shape == (N,), "the weight must have one element per column"
+    assert bias is None or bias.shape == (N,), "the bias must have one element per column"
+    x2 = _rows(x)
+    M = x2.shape[0]
+    weight = weight.contiguous()
+    bias = bias.contiguous() if bias is not None else None
+    device = x.device
+    r2, h2 = None, None
+    if residual is not None:
+        assert residual.shape == shape, "the residual must have the shape of the input"
+        r2 = _rows(residual)
+        h2 = torch.empty_like(x2)
+    # the fp8 outputs are written through their int8 storage
+    quantize = out_dtype in _fp8_dtypes()
+    if quantize:
+        fp8_dtype = _fp8_dtypes()[out_dtype]
+        if out_scale is None:
+            out_scale = 1.
+        if not isinstance(out_scale, torch.Tensor):
+            out_scale = torch.full((1, ), out_scale, device=device)
+        assert out_scale.numel() == 1, "the output scale must have one value"
+        out_scale = out_scale.to(torch.float32)
+        y2 = torch.empty((M, N), device=device, dtype=torch.int8)
+        y_arg = triton.reinterpret(y2, fp8_dtype)
+    else:
+        y2 = torch.empty((M, N), device=device, dtype=out_dtype or x.dtype)
+        y_arg = y2
+    mean = torch.empty((M, ), device=device, dtype=torch.float32)
+    rstd = torch.empty((M, ), device=device, dtype=torch.float32)
+    grid = (_num_programs(M, device), )
+    _forward[grid](x2, r2, y_arg, h2, weight, bias, mean, rstd, out_scale, M, N,
+                   x2.stride(0), r2.stride(0) if r2 is not None else 0, y2.stride(0),
+                   h2.stride(0) if h2 is not None else 0, eps,
+                   IS_RMS=is_rms, HAS_BIAS=bias is not None, HAS_RESIDUAL=residual is not None,
+                   QUANTIZE=quantize, OUT_MAX=FP8_MAX[fp8_dtype] if quantize else 0.,
+                   BLOCK_N=_block_size(x2))
+    y = (y2.view(out_dtype) if quantize else y2).reshape(shape)
+    h = h2.reshape(shape) if h2 is not None else None
+    return y, h, x2 if h2 is None else h2, mean, rstd
+
+
+def _norm_backward(dy, dh, x2, weight, bias, mean, rstd, is_rms):
+    M, N = x2.shape
+    device = x2.device
+    dy2 = _rows(dy)
+    dh2 = _rows(dh) if dh is not None else None
+    dx2 = torch.empty_like(x2)
+    num_programs = _num_programs(M, device)
+    dw_partial = torch.empty((num_programs, N), device=device, dtype=torch.float32)
+    db_partial = torch.empty((num_programs, N), device=device, dtype=torch.float32) if bias is not None else None
+    _backward[(num_programs, )](x2, weight, dy2, dx2, dh2, dw_partial, db_partial, mean, rstd, M, N,
+                                x2.stride(0), dy2.stride(0), dx2.stride(0),
+                                dh2.stride(0) if dh2 is not None else 0,
+                                IS_RMS=is_rms, HAS_BIAS=bias is not None, HAS_DH=dh is not None,
+                                BLOCK_N=_block_size(x2))
+    grid = (triton.cdiv(N, 128), )
+    dw = torch.empty_like(weight)
+    _reduce_partials[grid](dw_partial, dw, num_programs, N, BLOCK_M=32, BLOCK_N=128)
+    db = None
+    if bias is not None:
+        db = torch.empty_like(bias)
+        _reduce_partials[grid](db_partial, db, num_programs, N, BLOCK_M=32, BLOCK_N=128)
+    return dx2, dw, db
+
+
+class _norm(torch.autograd.Function):
+
+    @staticmethod
+    def forward(ctx, x, weight, bias, residual, eps, is_rms):
+        y, h, x2, mean, rstd = _norm_forward(x, weight, bias, residual, eps, is_rms)
+        ctx.save_for_backward(x2, weight, bias, mean, rstd)
+        ctx.is_rms = is_rms
+        ctx.has_residual = residual is not None
+        ctx.shape = x.shape
+        return (y, h) if residual is not None else y
+
+    @staticmethod
+    def backward(ctx, dy, dh=None):
+        x2, weight, bias, mean, rstd = ctx.saved_tensors
+        # the gradient of the sum flows to both the input and the residual
+        dx2, dw, db = _norm_backward(dy, dh, x2, weight, bias, mean, rstd, ctx.is_rms)
+        dx = dx2.reshape(ctx.shape)
+        return dx, dw, db, dx if ctx.has_residual else None, None, None
+
+
+def _apply_norm(x, weight, bias, eps, residual, out_dtype, out_scale, is_rms):
+    if out_dtype in _fp8_dtypes():
+        # the quantized outputs have no gradient
+        y, h, _, _, _ = _norm_forward(x, weight, bias, residual, eps, is_rms, out_dtype, out_scale)
+        return (y, h) if residual is not None else y
+    assert out_dtype is None or out_dtype == x.dtype, "the output has the dtype of the input, or an fp8 one"
+    return _norm.apply(x, weight, bias, residual, eps, is_rms)
+
+
+def layer_norm(x, weight, bias=None, eps=1e-5, residual=None, out_dtype=None, out_scale=None):
+    """
+    Returns the layer normalization of the last dimension of :code:`x`, as
+    :code:`torch.nn.functional.layer_norm(x, x.shape[-1:], weight, bias, eps)`.
+
+    :param residual: a tensor of the shape of :code:`x` added to it before the
+        normalization. The sum is then returned too, as :code:`(y, x +
+        residual)`, as it is the residual of the next layer.
+    :param out_dtype: the dtype of the output, the one of :code:`x` by
+        default, or :code:`torch.float8_e4m3fn` or :code:`torch.float8_e5m2`
+        to quantize it. The quantized output has no gradient.
+    :param out_scale: the scale of the quantized output, a float or a tensor
+        of one element: the output is :code:`out_scale * y`, saturated to the
+        largest finite value of its dtype
+    """
+    return _apply_norm(x, weight, bias, eps, residual, out_dtype, out_scale, False)
+
+
+def rms_norm(x, weight, eps=1e-6, residual=None, out_dtype=None, out_scale=None):
+    """
+    Returns the RMS normalization of the last dimension of :code:`x`,
+    :code:`x * weight / sqrt(mean(x ** 2, -1) + eps)`.
+
+    :param residual: a tensor added to :code:`x` before the normalization, see
+        :code:`layer_norm`
+    :param out_dtype: the dtype of the output, see :code:`layer_norm`
+    :param out_scale: the scale of the quantized output, see :code:`layer_norm`
+    """
+    return _apply_norm(x, weight, None, eps, residual, out_dtype, out_scale, True)
@@ -0,0 +1,302 @@
+"""
+A profiler of the launches of Triton kernels, built on the launch hooks of
+:code:`CompiledKernel`: it counts the launches of every compiled
+specialization and times a sample of them on the GPU with CUDA events.
+
+.. highlight:: python
+.. code-block:: python
+
+    with triton.profiler.Profiler(sample_every=10) as prof:
+        run_model()
+    print(prof.table())
+    prof.export_chrome_trace("trace.json")
+
+The launches are attributed to the compiled kernels, so the specializations
+of a :code:`@triton.jit` function (constexprs, num_warps, divisibility) are
+reported apart. Within a kernel, :code:`RegionTimer` decodes the cycles of
+the regions marked with :code:`tl.extra.cuda.clock64`.
+"""
+
+import json
+from collections import namedtuple
+
+# A timed launch; the events are resolved when the profiler stops
+_Launch = namedtuple("_Launch", ["kernel", "grid", "device", "stream", "num_bytes", "start", "end"])
+
+
+def _num_bytes(args):
+    # the bytes of the tensor arguments, an upper bound of the DRAM traffic of
+    # kernels that read or write each tensor once
+    return sum(arg.numel() * arg.element_size() for arg in args if hasattr(arg, "element_size"))
+
+
+class KernelStats:
+    """
+    The launches of a compiled kernel.
+
+    :ivar name: the name of the kernel
+    :ivar constants: the constexpr and specialized arguments
+    :ivar num_warps: the warps per program
+    :ivar n_regs: the registers per thread
+    :ivar shared: the bytes of shared memory per program
+    :ivar calls: the launches of the kernel
+    :ivar timed_calls: the launches timed on the GPU
+    :ivar gpu_ms: the GPU time of the timed launches
+    :ivar num_bytes: the bytes of the tensor arguments of the timed launches
+    :ivar grids: the number of launches of each grid
+    """
+
+    def __init__(self, kernel):
+        self.name = kernel.metadata["name"]
+        self.constants = {str(k): repr(v) for k, v in kernel.constants.items()}
+        self.num_warps = kernel.num_warps
+        self.n_regs = getattr(kernel, "n_regs", None)
+        self.shared = kernel.shared
+        self.calls = 0
+        self.timed_calls = 0
+        self.gpu_ms = 0.
+        self.num_bytes = 0
+        self.grids = {}
+
+    @property
+    def mean_ms(self):
+        return self.gpu_ms / self.timed_calls if self.timed_calls else 0.
+
+    @property
+    def estimated_total_ms(self):
+        """The GPU time of all the launches, extrapolated from the timed ones."""
+        return self.mean_ms * self.calls
+
+    @property
+    def gbps(self):
+        """The bandwidth achieved on the tensor arguments of the timed launches."""
+        return self.num_bytes * 1e-9 / (self.gpu_ms * 1e-3) if self.gpu_ms > 0 else 0.
+
+    def as_dict(self):
+        return {"name": self.name, "constants": self.constants, "num_warps": self.num_warps,
+                "n_regs": self.n_regs, "shared": self.shared, "calls": self.calls,
+                "timed_calls": self.timed_calls, "gpu_ms": self.gpu_ms, "mean_ms": self.mean_ms,
+                "estimated_total_ms": self.estimated_total_ms, "gbps": self.gbps,
+                "grids": {"x".join(map(str, grid)): n for grid, n in self.grids.items()}}
+
+
+class Profiler:
+    """
+    Records the launches of Triton kernels between :code:`start` and
+    :code:`stop`, or within a :code:`with` block.
+
+    :param sample_every: times one launch out of every :code:`sample_every`
+        launches of each kernel on the GPU; the other launches are only
+        counted, which costs a dict lookup. 0 disables the timing.
+    :param max_trace_events: the timed launches kept for the trace; past it,
+        the launches are aggregated but not traced
+    :note: the launches of a :code:`KernelGraph` replay are not seen, and the
+        recording of a :code:`LaunchPlan` launches its kernels one by one
+    """
+
+    def __init__(self, sample_every=1, max_trace_events=100000):
+        self.sample_every = sample_every
+        self.max_trace_events = max_trace_events
+        self.stats = {}
+        self.trace = []
+        self._pending = []
+        self._streams = {}
+        self._origin = None
+        self._hooks = None
+        self._timing = False
+        self._start = None
+
+    def start(self):
+        from .compiler import CompiledKernel
+        assert self._hooks is None, "the profiler is already started"
+        enter_hook, exit_hook = CompiledKernel.launch_enter_hook, CompiledKernel.launch_exit_hook
+        self._hooks = (enter_hook, exit_hook)
+        # the event that the times of the trace are relative to
+        self._origin = self._record(None)
+
+        def on_enter(*args):
+            if enter_hook is not None:
+                enter_hook(*args)
+            self._on_enter(args)
+
+        def on_exit(*args):
+            self._on_exit(args)
+            if exit_hook is not None:
+                exit_hook(*args)
+        CompiledKernel.launch_enter_hook = on_enter
+        CompiledKernel.launch_exit_hook = on_exit
+        return self
+
+    def stop(self):
+        """Stops the recording and waits for the timed launches."""
+        from .compiler import CompiledKernel
+        import torch
+        if self._hooks is None:
+            return
+        CompiledKernel.launch_enter_hook, CompiledKernel.launch_exit_hook = self._hooks
+        self._hooks = None
+        torch.cuda.synchronize()
+        for launch in self._pending:
+            ms = launch.start.elapsed_time(launch.end)
+            stats = self.stats[launch.kernel]
+            stats.timed_calls += 1
+            stats.gpu_ms += ms
+            stats.num_bytes += launch.num_bytes
+            if len(self.trace) < self.max_trace_events:
+                begin = self._origin.elapsed_time(launch.start)
+                self.trace.append({"name": stats.name, "device": launch.device, "stream": launch.stream,
+                                   "grid": launch.grid, "begin_ms": begin, "ms": ms,
+                                   "num_bytes": launch.num_bytes, "kernel": launch.kernel})
+        self._pending = []
+
+    def __enter__(self):
+        return self.start()
+
+    def __exit__(self, *exc):
+        self.stop()
+
+    def _record(self, stream):
+        import torch
+        event = torch.cuda.Event(enable_timing=True)
+        if stream is None:
+            event.record()
+        else:
+            # the launchers get the raw stream
+            if stream not in self._streams:
+                self._streams[stream] = torch.cuda.ExternalStream(stream)
+            event.record(self._streams[stream])
+        return event
+
+    def _on_enter(self, args):
+        # (grid_0, grid_1, grid_2, num_warps, shared, stream, function,
+        #  enter_hook, exit_hook, kernel, *args)
+        kernel = args[9]
+        stats = self.stats.get(id(kernel))
+        if stats is None:
+            stats = self.stats[id(kernel)] = KernelStats(kernel)
+        grid = args[:3]
+        stats.grids[grid] = stats.grids.get(grid, 0) + 1
+        stats.calls += 1
+        self._timing = self.sample_every > 0 and (stats.calls - 1) % self.sample_every == 0
+        if self._timing:
+            self._start = self._record(args[5])
+
+    def _on_exit(self, args):
+        import torch
+        if not self._timing:
+            return
+        self._timing = False
+        end = self._record(args[5])
+        device = torch.cuda.current_device()
+        self._pending.append(_Launch(id(args[9]), list(args[:3]), device, args[5], _num_bytes(args[10:]),
+                                     self._start, end))
+
+    def table(self, sort_by="estimated_total_ms"):
+        """Returns the statistics of the kernels as a text table."""
+        rows = sorted(self.stats.values(), key=lambda stats: getattr(stats, sort_by), reverse=True)
+        width = max([len(stats.name) for stats in rows] + [6])
+        lines = [f"{'kernel':<{width}}  {'calls':>8}  {'timed':>6}  {'mean ms':>9}  {'total ms':>9}  "
+                 f"{'GB/s':>8}  {'warps':>5}  {'regs':>4}  {'shared':>6}"]
+        for stats in rows:
+            lines.append(f"{stats.name:<{width}}  {stats.calls:>8}  {stats.timed_calls:>6}  {stats.mean_ms:>9.4f}  "
+                         f"{stats.estimated_total_ms:>9.3f}  {stats.gbps:>8.1f}  {stats.num_warps:>5}  "
+                         f"{str(stats.n_regs):>4}  {stats.shared:>6}")
+        return "\n".join(lines)
+
+    def export_json(self, path):
+        """Writes the statistics of every kernel specialization as JSON."""
+        with open(path, "w") as f:
+            json.dump([stats.as_dict() for stats in self.stats.values()], f, indent=2)
+
+    def export_chrome_trace(self, path):
+        """Writes the timed launches in the Chrome trace format (chrome://tracing, Perfetto)."""
+        events = []
+        for launch in self.trace:
+            stats = self.stats[launch["kernel"]]
+            events.append({"name": launch["name"], "ph": "X", "cat": "triton", "pid": launch["device"],
+                           "tid": launch["stream"],
+                           "ts": launch["begin_ms"] * 1e3, "dur": launch["ms"] * 1e3,
+                           "args": {"grid": launch["grid"], "num_warps": stats.num_warps, "n_regs": stats.n_regs,
+                                    "shared": stats.shared, "constants": stats.constants,
+                                    "bytes": launch["num_bytes"]}})
+        with open(path, "w") as f:
+            json.dump({"traceEvents": events, "displayTimeUnit": "ms"}, f)
+
+
+class RegionTimer:
+    """
+    The cycles that the programs of a kernel spend in user-marked regions,
+    e.g. the pipelined loop and the epilogue of a matmul. The kernel takes the
+    buffer of the timer, reads :code:`tl.extra.cuda.clock64()` around the
+    regions and stores the cycles of each region with
+    :code:`tl.extra.cuda.record_region`:
+
+    .. highlight:: python
+    .. code-block:: python
+
+        @triton.jit
+        def kernel(..., Times, NUM_REGIONS: tl.constexpr):
+            loop = 0
+            for k in range(0, K, BLOCK_K):
+                start = tl.extra.cuda.clock64()
+                ...
+                loop += tl.extra.cuda.clock64() - start
+            start = tl.extra.cuda.clock64()
+            ...  # epilogue
+            tl.extra.cuda.record_region(Times, 0, loop, NUM_REGIONS)
+            tl.extra.cuda.record_region(Times, 1, tl.extra.cuda.clock64() - start, NUM_REGIONS)
+
+        timer = triton.profiler.RegionTimer(grid, ["loop", "epilogue"])
+        kernel[grid](..., timer.buffer, NUM_REGIONS=timer.num_regions)
+        print(timer.table())
+
+    :param grid: the grid of the launch
+    :param regions: the names of the regions
+    :note: the clocks are read by every thread; the stored cycles are those of
+        one thread of the program. The reads are not barriers, so the
+        asynchronous copies and loads issued in a region can complete in the
+        next one.
+    """
+
+    def __init__(self, grid, regions, device="cuda"):
+        import torch
+        grid = tuple(grid) + (1,) * (3 - len(grid))
+        self.regions = list(regions)
+        self.num_programs = grid[0] * grid[1] * grid[2]
+        # [sm, cycles of each region] per program
+        self.buffer = torch.zeros((self.num_programs, self.num_regions + 1), dtype=torch.int64, device=device)
+
+    @property
+    def num_regions(self):
+        return len(self.regions)
+
+    def reset(self):
+        self.buffer.zero_()
+
+    def cycles(self):
+        """Returns the cycles of each program in each region, as a :code:`(num_programs, num_regions)` tensor."""
+        return self.buffer[:, 1:].cpu()
+
+    def summary(self):
+        """Returns the mean, min and max cycles of the programs in each region, and the share of the total."""
+        cycles = self.cycles().double()
+        total = cycles.sum().item()
+        return {name: {"mean": cycles[:, i].mean().item(), "min": cycles[:, i].min().item(),
+                       "max": cycles[:, i].max().item(), "share": cycles[:, i].sum().item() / total if total else 0.}
+                for i, name in enumerate(self.regions)}
+
+    def per_sm(self):
+        """Returns the total cycles of each region on each SM, to spot imbalanced SMs."""
+        table = self.buffer.cpu()
+        result = {}
+        for sm in table[:, 0].unique().tolist():
+            result[sm] = table[table[:, 0] == sm, 1:].sum(dim=0).tolist()
+        return result
+
+    def table(self):
+        width = max([len(name) for name in self.regions] + [6])
+        lines = [f"{'region':<{width}}  {'mean cycles':>12}  {'min':>10}  {'max':>10}  {'share':>6}"]
+        for name, stats in self.summary().items():
+            lines.append(f"{name:<{width}}  {stats['mean']:>12.0f}  {stats['min']:>10.0f}  {stats['max']:>10.0f}  "
+                         f"{stats['share']:>6.1%}")
+        return "\n".join(lines)
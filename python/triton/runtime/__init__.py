@@ -1,8 +1,14 @@
 from .autotuner import (Autotuner, Config, Heuristics, OutOfResources, autotune,
-                        heuristics)
+                        exhaustive_search, heuristics, rank_by_resources, reject_costly_configs,
+                        successive_halving)
+from .batch import LaunchPlan, launch_batch
 from .driver import driver
-from .jit import (JITFunction, KernelInterface, MockTensor, TensorWrapper, reinterpret,
+from .fusion import HorizontalFusion
+from .graph import KernelGraph
+from .jit import (JITFunction, KernelInterface, MockTensor, ParamTable, TensorWrapper, reinterpret,
                   version_key)
+from .multi_tensor import TensorList
+from .occupancy import max_regs_for_occupancy, occupancy
 
 __all__ = [
     "driver",
@@ -17,5 +23,17 @@ __all__ = [
     "TensorWrapper",
     "OutOfResources",
     "MockTensor",
+    "ParamTable",
     "Autotuner",
+    "KernelGraph",
+    "LaunchPlan",
+    "launch_batch",
+    "HorizontalFusion",
+    "TensorList",
+    "reject_costly_configs",
+    "rank_by_resources",
+    "exhaustive_search",
+    "successive_halving",
+    "occupancy",
+    "max_regs_for_occupancy",
 ]
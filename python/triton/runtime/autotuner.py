@@ -1,11 +1,18 @@
 from __future__ import annotations
 
 import builtins
+import hashlib
+import json
+import math
+import os
 import time
-from typing import Dict
+from concurrent.futures import ThreadPoolExecutor
+from typing import Dict, Tuple
 
 from ..testing import do_bench
-from .jit import KernelInterface
+from .cache import get_cache_manager
+from .graph import is_capturing
+from .jit import JITFunction, KernelInterface, get_compile_pool, round_to_bucket
 
 
 class OutOfResources(Exception):
@@ -24,20 +31,177 @@ class OutOfResources(Exception):
         return (type(self), (self.required, self.limit, self.name))
 
 
+# Winning configs of all autotuners, benchmarked in this process or loaded
+# from a tuning file:
+# (kernel hash, device, driver version, key) -> config fields
+_tuning_records: Dict[Tuple[str, str, str, str], Dict] = {}
+_tuning_file_loaded = False
+
+
+def load_tuning_file(path):
+    """
+    Loads the tuning results saved by :code:`save_tuning_file`. Autotuned
+    kernels use them instead of benchmarking when the kernel, the device, the
+    driver version and the key values match. The file named by the
+    :code:`TRITON_AUTOTUNE_FILE` environment variable is loaded automatically.
+    """
+    with open(path) as f:
+        records = json.load(f)
+    for record in records:
+        _tuning_records[(record["kernel"], record["device"], record["driver"], record["key"])] = record["config"]
+
+
+def save_tuning_file(path):
+    """
+    Saves the tuning results known to this process, so that other processes
+    can load them with :code:`load_tuning_file`.
+    """
+    records = [{"kernel": kernel, "device": device, "driver": driver, "key": key, "config": config}
+               for (kernel, device, driver, key), config in _tuning_records.items()]
+    with open(path, "w") as f:
+        json.dump(records, f, indent=2)
+
+
+def _load_default_tuning_file():
+    global _tuning_file_loaded
+    if _tuning_file_loaded:
+        return
+    _tuning_file_loaded = True
+    path = os.environ.get("TRITON_AUTOTUNE_FILE", None)
+    if path is not None and os.path.exists(path):
+        load_tuning_file(path)
+
+
+def reject_costly_configs(max_spills=0, min_occupancy=1):
+    """
+    Returns a :code:`resource_prune` rule for :code:`prune_configs_by`. It
+    rejects the configs whose kernel spills more than :code:`max_spills` words
+    per thread, or has fewer than :code:`min_occupancy` warps resident on a
+    multiprocessor. If the rule rejects every config, all of them are kept.
+    """
+    def prune(configs, usages):
+        def is_cheap(config):
+            usage = usages.get(config, None)
+            if usage is None:
+                return True
+            return usage["n_spills"] <= max_spills and usage["occupancy"] >= min_occupancy
+        kept = [config for config in configs if is_cheap(config)]
+        return kept or configs
+    return prune
+
+
+def rank_by_resources(top_k, saturation_warps=16, device=None):
+    """
+    Returns a :code:`resource_prune` rule for :code:`prune_configs_by` that
+    keeps the :code:`top_k` configs of the lowest runtime estimated from the
+    resources of their kernels, for any kernel, like
+    :code:`estimate_matmul_time` does for the matmuls from their tiles.
+
+    The model is coarse: the programs of the grid share the work evenly and
+    run in waves of as many programs as the multiprocessors can hold, each
+    multiprocessor being saturated by :code:`saturation_warps` resident warps.
+    It ranks the configs by wave quantization, residency and spills; the
+    configs whose grid or usage is unknown are ranked last.
+    """
+    def prune(configs, usages):
+        if len(configs) <= top_k:
+            return configs
+        from .driver import driver
+        from .jit import get_current_device
+        props = driver.utils.get_device_properties(get_current_device() if device is None else device)
+        num_sms = props["multiprocessor_count"]
+
+        def estimate(config):
+            usage = usages.get(config, None)
+            if usage is None or not usage.get("num_programs") or usage["occupancy"] <= 0:
+                return float('inf')
+            num_programs = usage["num_programs"]
+            blocks = builtins.max(usage["occupancy"] // config.num_warps, 1)
+            waves = -(-num_programs // (num_sms * blocks))
+            # the programs resident on a multiprocessor in a (full) wave
+            resident = builtins.min(blocks, -(-num_programs // num_sms))
+            utilization = builtins.min(1.0, resident * config.num_warps / saturation_warps)
+            # spilled words per thread go through the L1 cache
+            return waves * resident / (num_programs * utilization) * (1 + usage["n_spills"] / 64)
+        return sorted(configs, key=estimate)[:top_k]
+    return prune
+
+
+def exhaustive_search(configs, bench):
+    """
+    The default :code:`search` of :code:`autotune`: benchmarks every config
+    once, with the default warmup and repetition times of :code:`do_bench`.
+    """
+    return {config: bench(config) for config in configs}
+
+
+def successive_halving(eta=2, min_rep=10, max_rep=100, warmup=5):
+    """
+    Returns a :code:`search` for :code:`autotune` that benchmarks all the
+    configs briefly, then benchmarks the fastest :code:`1 / eta` of them
+    :code:`eta` times longer, and so on until one config is left or the
+    benchmarks last :code:`max_rep` ms. Large config spaces then cost a few
+    full benchmarks instead of one per config.
+
+    :param eta: the fraction of the configs dropped at each round, and the
+        growth of the benchmark time
+    :param min_rep: the repetition time (in ms) of the first round
+    :param max_rep: the repetition time (in ms) of the last round
+    :param warmup: the warmup time (in ms) of every benchmark
+    """
+    assert eta >= 2, "successive halving keeps 1 / eta of the configs at each round"
+
+    def search(configs, bench):
+        timings = {}
+        survivors = list(configs)
+        rep = builtins.min(min_rep, max_rep)
+        while True:
+            last = rep >= max_rep or len(survivors) == 1
+            round_timings = {config: bench(config, warmup=warmup, rep=max_rep if last else rep)
+                             for config in survivors}
+            # the time budget of the key ran out
+            if all(timing[0] == float('inf') for timing in round_timings.values()) and timings:
+                break
+            # the configs left out by the budget keep their last timing
+            for config, timing in round_timings.items():
+                if timing[0] != float('inf') or config not in timings:
+                    timings[config] = timing
+            if last:
+                break
+            survivors = sorted(survivors, key=timings.get)[:builtins.max(1, -(-len(survivors) // eta))]
+            rep = builtins.min(rep * eta, max_rep)
+        return timings
+    return search
+
+
 class Autotuner(KernelInterface):
-    def __init__(self, fn, arg_names, configs, key, reset_to_zero, prune_configs_by: Dict = None):
+    def __init__(self, fn, arg_names, configs, key, reset_to_zero, prune_configs_by: Dict = None, async_compile=None,
+                 key_buckets=None, search=None, time_budget=None, reuse_nearest=False):
         '''
         :param prune_configs_by: a dict of functions that are used to prune configs, fields:
             'perf_model': performance model used to predicate running time with different configs, returns running time
             'top_k': number of configs to bench
             'prune_num_stages_by'(optional): a function used to prune num_stages. It takes configs:List[Config] as its input, and returns pruned configs.
+            'resource_prune'(optional): a function used to prune the compiled configs before benchmarking them. It takes
+            configs:List[Config] and usages:Dict[Config, Dict] as its inputs, with the `CompiledKernel.get_resource_usage`
+            of each config, and returns pruned configs. Defaults to `reject_costly_configs()`; None disables it.
+            'estimate_prune'(optional): whether to compile the configs up to their TritonGPU IR first, and to drop the
+            configs whose `EstimatedKernel` does not fit the device before compiling the others fully. Defaults to True.
         '''
         if not configs:
             self.configs = [Config({}, num_warps=4, num_stages=2)]
         else:
             self.configs = configs
         self.key_idx = [arg_names.index(k) for k in key]
+        # the values of the key arguments are rounded up to their buckets
+        key_buckets = key_buckets or {}
+        assert all(k in key for k in key_buckets), "only key arguments can be bucketed"
+        self.key_buckets = [key_buckets.get(k, None) for k in key]
+        self.key_buckets = [b if b is None or callable(b) else sorted(b) for b in self.key_buckets]
         self.cache = {}
+        # the keys of the cache that borrow the config of the nearest tuned key
+        self.reuse_nearest = reuse_nearest
+        self._borrowed = set()
         # hook to reset all required tensor to zeros before relaunching a kernel
         self.hook = lambda args: 0
         if reset_to_zero is not None:
@@ -50,16 +214,24 @@ class Autotuner(KernelInterface):
         self.arg_names = arg_names
         # prune configs
         if prune_configs_by:
-            perf_model, top_k = prune_configs_by['perf_model'], prune_configs_by['top_k']
-            if 'early_config_prune' in prune_configs_by:
-                early_config_prune = prune_configs_by['early_config_prune']
+            perf_model, top_k = prune_configs_by.get('perf_model', None), prune_configs_by.get('top_k', None)
+            early_config_prune = prune_configs_by.get('early_config_prune', None)
         else:
             perf_model, top_k, early_config_prune = None, None, None
         self.perf_model, self.configs_top_k = perf_model, top_k
         self.early_config_prune = early_config_prune
+        self.resource_prune = reject_costly_configs()
+        if prune_configs_by and 'resource_prune' in prune_configs_by:
+            self.resource_prune = prune_configs_by['resource_prune']
+        self.estimate_prune = prune_configs_by.get('estimate_prune', True) if prune_configs_by else True
+        self.search = exhaustive_search if search is None else search
+        self.time_budget = time_budget
         self.fn = fn
+        self.async_compile = os.environ.get("TRITON_ASYNC_COMPILE", "0") == "1" if async_compile is None else async_compile
+        # the background compilations of the configs of the new keys
+        self._pending = {}
 
-    def _bench(self, *args, config, **meta):
+    def _bench(self, *args, config, bench_warmup=25, bench_rep=100, **meta):
         # check for conflicts, i.e. meta-parameters both provided
         # as kwargs and by the autotuner
         conflicts = meta.keys() & config.kwargs.keys()
@@ -77,10 +249,109 @@ class Autotuner(KernelInterface):
             self.hook(args)
             self.fn.run(*args, num_warps=config.num_warps, num_stages=config.num_stages, **current)
         try:
-            return do_bench(kernel_call, quantiles=(0.5, 0.2, 0.8))
+            return do_bench(kernel_call, warmup=bench_warmup, rep=bench_rep, quantiles=(0.5, 0.2, 0.8))
         except OutOfResources:
             return [float('inf'), float('inf'), float('inf')]
 
+    def _prune_by_estimates(self, configs, *args, **meta):
+        # the shared memory and estimated registers of a config are known in
+        # milliseconds, before its code generation takes seconds
+        if not self.estimate_prune or len(configs) <= 1:
+            return configs
+        fitting = []
+        for config in configs:
+            current = dict(meta, **config.kwargs)
+            try:
+                estimate = self.fn.run(*args, num_warps=config.num_warps, num_stages=config.num_stages,
+                                       target="ttgir", **current)
+            except Exception:
+                # errors are reported when the config is benchmarked
+                fitting.append(config)
+                continue
+            if estimate.fits():
+                fitting.append(config)
+        return fitting or configs
+
+    def _precompile(self, configs, *args, **meta):
+        # compile the configs concurrently so that benchmarking them does not
+        # have to; the compiler releases the GIL outside of code generation.
+        # Returns the kernels of the configs that compiled
+        num_threads = int(os.environ.get("TRITON_AUTOTUNE_COMPILE_THREADS", os.cpu_count() or 1))
+        num_threads = builtins.min(num_threads, len(configs))
+        # the current device is thread-local
+        if 'device' not in meta:
+            from .jit import get_current_device
+            meta = dict(meta, device=get_current_device())
+        from ..compiler.errors import CompilationError
+
+        def compile_config(config):
+            current = dict(meta, **config.kwargs)
+            try:
+                return self.fn.run(*args, num_warps=config.num_warps, num_stages=config.num_stages, warmup=True,
+                                   **current)
+            except (OutOfResources, CompilationError):
+                # errors are reported when the config is benchmarked
+                return None
+        if num_threads <= 1:
+            kernels = [compile_config(config) for config in configs]
+        else:
+            with ThreadPoolExecutor(max_workers=num_threads) as executor:
+                kernels = list(executor.map(compile_config, configs))
+        return {config: kernel for config, kernel in zip(configs, kernels) if kernel is not None}
+
+    def _tune_async(self, key, *args, fallback=None, **kwargs):
+        # Compiles the configs of a new key in the background and returns the
+        # config to launch meanwhile, `fallback` or the last one launched.
+        # Returns None once the configs are compiled, for the caller to
+        # benchmark them.
+        if fallback is None:
+            fallback = getattr(self, "best_config", None)
+        pending = self._pending.get(key)
+        if pending is None:
+            if fallback is None:
+                return None
+            configs = self.prune_configs(kwargs)
+            if 'device' not in kwargs:
+                from .jit import get_current_device
+                kwargs = dict(kwargs, device=get_current_device())
+
+            def compile_configs():
+                self._precompile(self._prune_by_estimates(configs, *args, **kwargs), *args, **kwargs)
+            pending = self._pending[key] = get_compile_pool().submit(compile_configs)
+        if not pending.done():
+            return fallback
+        del self._pending[key]
+        return None
+
+    def _num_programs(self, config, kwargs):
+        # the programs of the grid of the launch with `config`, if known
+        grid = kwargs.get("grid", None)
+        try:
+            if callable(grid):
+                grid = grid({**self.nargs, **kwargs, **config.kwargs})
+            grid = tuple(grid) if isinstance(grid, (tuple, list)) else (grid,)
+            num_programs = 1
+            for size in grid:
+                num_programs *= int(size)
+            return num_programs
+        except Exception:
+            return None
+
+    def _prune_by_resources(self, configs, kernels, kwargs):
+        # the registers, spills and occupancy of the kernels are known once
+        # they are loaded, before any benchmark
+        if self.resource_prune is None:
+            return configs
+        usages = {}
+        for config, kernel in kernels.items():
+            try:
+                usages[config] = dict(kernel.get_resource_usage(), num_programs=self._num_programs(config, kwargs))
+            except Exception:
+                # errors are reported when the config is benchmarked
+                pass
+        self.resource_usages = usages
+        return self.resource_prune(configs, usages)
+
     def run(self, *args, **kwargs):
         self.nargs = dict(zip(self.arg_names, args))
         if len(self.configs) > 1:
@@ -89,19 +360,40 @@ class Autotuner(KernelInterface):
             for name in self.arg_names:
                 if name in all_args:
                     _args.append(all_args[name])
-            key = tuple(_args[i] for i in self.key_idx)
+            key = tuple(_args[i] if buckets is None else round_to_bucket(_args[i], buckets, self.arg_names[i])
+                        for i, buckets in zip(self.key_idx, self.key_buckets))
+            if key not in self.cache:
+                config = self._load_tuned_config(key)
+                if config is not None:
+                    self.cache[key] = config
+            fallback = None
             if key not in self.cache:
+                nearest = self._nearest_config(key) if self.reuse_nearest else None
+                if is_capturing():
+                    if nearest is None:
+                        raise RuntimeError(f"{self.fn} cannot be autotuned while capturing a CUDA graph; "
+                                           "launch it once with the same key before capturing")
+                    fallback = nearest
+                elif self.async_compile:
+                    fallback = self._tune_async(key, *args, fallback=nearest, **kwargs)
+                elif nearest is not None:
+                    self.cache[key] = nearest
+                    self._borrowed.add(key)
+            if key not in self.cache and fallback is None:
                 # prune configs
                 pruned_configs = self.prune_configs(kwargs)
+                pruned_configs = self._prune_by_estimates(pruned_configs, *args, **kwargs)
+                kernels = self._precompile(pruned_configs, *args, **kwargs)
+                pruned_configs = self._prune_by_resources(pruned_configs, kernels, kwargs)
                 bench_start = time.time()
-                timings = {config: self._bench(*args, config=config, **kwargs)
-                           for config in pruned_configs}
+                timings = self._search(pruned_configs, *args, **kwargs)
                 bench_end = time.time()
                 self.bench_time = bench_end - bench_start
                 self.cache[key] = builtins.min(timings, key=timings.get)
                 self.hook(args)
                 self.configs_timings = timings
-            config = self.cache[key]
+                self._store_tuned_config(key, self.cache[key])
+            config = self.cache[key] if fallback is None else fallback
         else:
             config = self.configs[0]
         self.best_config = config
@@ -109,6 +401,102 @@ class Autotuner(KernelInterface):
             config.pre_hook(self.nargs)
         return self.fn.run(*args, num_warps=config.num_warps, num_stages=config.num_stages, **kwargs, **config.kwargs)
 
+    @staticmethod
+    def _key_distance(a, b):
+        # the keys are as far apart as the log2 ratios of their numbers; their
+        # other values, e.g. dtypes, must be equal
+        distance = 0.0
+        for x, y in zip(a, b):
+            if x == y:
+                continue
+            numbers = all(isinstance(v, (int, float)) and not isinstance(v, bool) for v in (x, y))
+            if not numbers:
+                return float('inf')
+            distance += abs(math.log2(builtins.max(x, 1)) - math.log2(builtins.max(y, 1)))
+        return distance
+
+    def _nearest_config(self, key):
+        # the config of the tuned key nearest to `key`, if any
+        tuned = [k for k in self.cache if k not in self._borrowed]
+        if not tuned:
+            return None
+        nearest = builtins.min(tuned, key=lambda k: self._key_distance(k, key))
+        if self._key_distance(nearest, key) == float('inf'):
+            return None
+        return self.cache[nearest]
+
+    def _search(self, configs, *args, **kwargs):
+        # Runs the search strategy over the configs. Once a config is measured
+        # and the time budget of the key is spent, the configs left are not
+        # benchmarked and time as inf
+        deadline = None if self.time_budget is None else time.time() + self.time_budget
+        measured = []
+
+        def bench(config, warmup=25, rep=100):
+            if measured and deadline is not None and time.time() > deadline:
+                return [float('inf'), float('inf'), float('inf')]
+            timing = self._bench(*args, config=config, bench_warmup=warmup, bench_rep=rep, **kwargs)
+            if timing[0] != float('inf'):
+                measured.append(config)
+            return timing
+        timings = self.search(configs, bench)
+        assert timings, "the search benchmarked no config"
+        return timings
+
+    def _tuning_id(self):
+        # the kernel, device and driver the results are measured with
+        import torch
+        fn = self.fn
+        while not isinstance(fn, JITFunction):
+            fn = fn.fn
+        kernel = hashlib.md5(fn.cache_key.encode("utf-8")).hexdigest()
+        device = torch.cuda.get_device_name(torch.cuda.current_device())
+        driver = str(torch.version.hip or torch.version.cuda)
+        return kernel, device, driver
+
+    @staticmethod
+    def _config_fields(config):
+        # normalized through JSON so that stored and loaded fields compare equal
+        fields = {"kwargs": config.kwargs, "num_warps": config.num_warps, "num_stages": config.num_stages}
+        return json.loads(json.dumps(fields))
+
+    @staticmethod
+    def _persistent_cache_enabled():
+        return os.environ.get("TRITON_AUTOTUNE_CACHE", "0") == "1"
+
+    @staticmethod
+    def _cache_file_name(tuning_id, key):
+        # one file per key, so that concurrent processes never overwrite each other's results
+        return hashlib.md5("-".join([*tuning_id, repr(key)]).encode("utf-8")).hexdigest() + ".autotune.json"
+
+    def _load_tuned_config(self, key):
+        _load_default_tuning_file()
+        tuning_id = self._tuning_id()
+        fields = _tuning_records.get((*tuning_id, repr(key)), None)
+        if fields is None and self._persistent_cache_enabled():
+            cache_manager = get_cache_manager(tuning_id[0])
+            path = cache_manager.get_file(self._cache_file_name(tuning_id, key))
+            if path is not None:
+                with open(path) as f:
+                    fields = json.load(f)
+        if fields is None:
+            return None
+        # configs are matched against the current ones to recover their pre-hooks;
+        # results for configs that no longer exist are ignored
+        for config in self.configs:
+            if self._config_fields(config) == fields:
+                _tuning_records[(*tuning_id, repr(key))] = fields
+                return config
+        return None
+
+    def _store_tuned_config(self, key, config):
+        tuning_id = self._tuning_id()
+        fields = self._config_fields(config)
+        _tuning_records[(*tuning_id, repr(key))] = fields
+        if self._persistent_cache_enabled():
+            cache_manager = get_cache_manager(tuning_id[0])
+            cache_manager.put(json.dumps(fields), self._cache_file_name(tuning_id, key), binary=False)
+
     def prune_configs(self, kwargs):
         pruned_configs = self.configs
         if self.early_config_prune:
@@ -171,7 +559,8 @@ class Config:
         return ', '.join(res)
 
 
-def autotune(configs, key, prune_configs_by=None, reset_to_zero=None):
+def autotune(configs, key, prune_configs_by=None, reset_to_zero=None, async_compile=None, key_buckets=None,
+             search=None, time_budget=None, reuse_nearest=False):
     """
     Decorator for auto-tuning a :code:`triton.jit`'d function.
 
@@ -200,11 +589,39 @@ def autotune(configs, key, prune_configs_by=None, reset_to_zero=None):
         'perf_model': performance model used to predicate running time with different configs, returns running time
         'top_k': number of configs to bench
         'early_config_prune'(optional): a function used to do early prune (eg, num_stages). It takes configs:List[Config] as its input, and returns pruned configs.
+        'resource_prune'(optional): a function used to prune the compiled configs by their resource usage, e.g.
+        :code:`reject_costly_configs(max_spills=0, min_occupancy=4)`. It takes configs:List[Config] and
+        usages:Dict[Config, Dict] as its inputs, and returns pruned configs. By default, the configs that spill
+        are rejected unless all of them do; None keeps every config. :code:`rank_by_resources(top_k)` keeps the
+        configs of the lowest runtime estimated from their usage and grid, the :code:`num_programs` of the usages.
     :param reset_to_zero: a list of argument names whose value will be reset to zero before evaluating any configs.
     :type reset_to_zero: list[str]
+    :param async_compile: compile the configs of a new key on a background thread pool and launch the last
+        launched config until they are compiled; the compiled configs are then benchmarked on the next launch with
+        the key. Defaults to the :code:`TRITON_ASYNC_COMPILE` environment variable.
+    :type async_compile: bool, optional
+    :param key_buckets: the values that key arguments are rounded up to before looking up their tuned config, by
+        argument name: a list of values, or a function of the value such as :code:`triton.next_power_of_2`. Dynamic
+        sizes then tune once per bucket instead of once per size.
+    :type key_buckets: dict, optional
+    :param search: how the pruned configs are benchmarked: a function of the configs and of
+        :code:`bench(config, warmup=25, rep=100)`, which benchmarks a config for the given times in ms and returns
+        its median, 20th and 80th percentile runtimes, that returns the timings of the benchmarked configs. The
+        fastest config is picked. Defaults to :code:`exhaustive_search`; :code:`successive_halving()` benchmarks
+        the slow configs briefly.
+    :type search: callable, optional
+    :param time_budget: the seconds that the benchmarks of a key may take: once they are spent, the configs left
+        are not benchmarked, and the fastest config benchmarked so far is picked.
+    :type time_budget: float, optional
+    :param reuse_nearest: launch the keys that are not tuned with the config of the nearest tuned key, by the log2
+        ratios of their numeric values, instead of tuning them. With :code:`async_compile`, the keys are still tuned
+        in the background and launch with the nearest config meanwhile; during the capture of a CUDA graph, they
+        launch with it.
+    :type reuse_nearest: bool, optional
     """
     def decorator(fn):
-        return Autotuner(fn, fn.arg_names, configs, key, reset_to_zero, prune_configs_by)
+        return Autotuner(fn, fn.arg_names, configs, key, reset_to_zero, prune_configs_by, async_compile, key_buckets,
+                         search, time_budget, reuse_nearest)
 
     return decorator
 
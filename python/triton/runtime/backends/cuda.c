@@ -1,6 +1,7 @@
 #include "cuda.h"
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
+#include <string.h>
 
 static inline void gpuAssert(CUresult code, const char *file, int line) {
   if (code != CUDA_SUCCESS) {
@@ -35,6 +36,13 @@ static PyObject *getDeviceProperties(PyObject *self, PyObject *args) {
   int sm_clock_rate;
   int mem_clock_rate;
   int mem_bus_width;
+  // the limits of the occupancy calculator
+  int max_regs_per_sm;
+  int max_threads_per_sm;
+  int max_blocks_per_sm;
+  int max_shared_mem_per_sm;
+  int reserved_shared_mem;
+  int l2_cache_size;
   CUDA_CHECK(cuDeviceGetAttribute(
       &max_shared_mem, CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_BLOCK_OPTIN,
       device));
@@ -46,12 +54,34 @@ static PyObject *getDeviceProperties(PyObject *self, PyObject *args) {
       &mem_clock_rate, CU_DEVICE_ATTRIBUTE_MEMORY_CLOCK_RATE, device));
   CUDA_CHECK(cuDeviceGetAttribute(
       &mem_bus_width, CU_DEVICE_ATTRIBUTE_GLOBAL_MEMORY_BUS_WIDTH, device));
+  CUDA_CHECK(cuDeviceGetAttribute(
+      &max_regs_per_sm, CU_DEVICE_ATTRIBUTE_MAX_REGISTERS_PER_MULTIPROCESSOR,
+      device));
+  CUDA_CHECK(cuDeviceGetAttribute(
+      &max_threads_per_sm,
+      CU_DEVICE_ATTRIBUTE_MAX_THREADS_PER_MULTIPROCESSOR, device));
+  CUDA_CHECK(cuDeviceGetAttribute(
+      &max_blocks_per_sm, CU_DEVICE_ATTRIBUTE_MAX_BLOCKS_PER_MULTIPROCESSOR,
+      device));
+  CUDA_CHECK(cuDeviceGetAttribute(
+      &max_shared_mem_per_sm,
+      CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_MULTIPROCESSOR, device));
+  CUDA_CHECK(cuDeviceGetAttribute(
+      &reserved_shared_mem,
+      CU_DEVICE_ATTRIBUTE_RESERVED_SHARED_MEMORY_PER_BLOCK, device));
+  CUDA_CHECK(cuDeviceGetAttribute(&l2_cache_size,
+                                  CU_DEVICE_ATTRIBUTE_L2_CACHE_SIZE, device));
 
-  return Py_BuildValue("{s:i, s:i, s:i, s:i, s:i}", "max_shared_mem",
-                       max_shared_mem, "multiprocessor_count",
-                       multiprocessor_count, "sm_clock_rate", sm_clock_rate,
-                       "mem_clock_rate", mem_clock_rate, "mem_bus_width",
-                       mem_bus_width);
+  return Py_BuildValue(
+      "{s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i}",
+      "max_shared_mem",
+      max_shared_mem, "multiprocessor_count", multiprocessor_count,
+      "sm_clock_rate", sm_clock_rate, "mem_clock_rate", mem_clock_rate,
+      "mem_bus_width", mem_bus_width, "max_regs_per_sm", max_regs_per_sm,
+      "max_threads_per_sm", max_threads_per_sm, "max_blocks_per_sm",
+      max_blocks_per_sm, "max_shared_mem_per_sm", max_shared_mem_per_sm,
+      "reserved_shared_mem", reserved_shared_mem, "l2_cache_size",
+      l2_cache_size);
 }
 
 static PyObject *loadBinary(PyObject *self, PyObject *args) {
@@ -68,14 +98,36 @@ static PyObject *loadBinary(PyObject *self, PyObject *args) {
   CUmodule mod;
   int32_t n_regs = 0;
   int32_t n_spills = 0;
+  int32_t local_bytes = 0;
+  // the module is loaded in the primary context of `device`, which is not
+  // necessarily the current one in multi-GPU processes. The module keeps the
+  // context retained until unload_binary.
+  CUdevice cu_device;
+  CUcontext ctx;
+  CUDA_CHECK(cuDeviceGet(&cu_device, device));
+  CUDA_CHECK(cuDevicePrimaryCtxRetain(&ctx, cu_device));
+  CUDA_CHECK(cuCtxPushCurrent(ctx));
   // create driver handles
-  CUDA_CHECK(cuModuleLoadData(&mod, data));
+  // `data` is a cubin, or the PTX of a fat binary that the driver compiles
+  // for the device, whose errors are reported from the log
+  char error_log[4096] = {0};
+  CUjit_option options[] = {CU_JIT_ERROR_LOG_BUFFER,
+                            CU_JIT_ERROR_LOG_BUFFER_SIZE_BYTES};
+  void *values[] = {(void *)error_log, (void *)(uintptr_t)sizeof(error_log)};
+  CUresult load_err = cuModuleLoadDataEx(&mod, data, 2, options, values);
+  if (load_err != CUDA_SUCCESS && error_log[0]) {
+    cuCtxPopCurrent(NULL);
+    cuDevicePrimaryCtxRelease(cu_device);
+    PyErr_Format(PyExc_RuntimeError, "Triton Error [CUDA]: %s", error_log);
+    return NULL;
+  }
+  CUDA_CHECK(load_err);
   CUDA_CHECK(cuModuleGetFunction(&fun, mod, name));
   // get allocated registers and spilled registers from the function
   CUDA_CHECK(cuFuncGetAttribute(&n_regs, CU_FUNC_ATTRIBUTE_NUM_REGS, fun));
-  CUDA_CHECK(
-      cuFuncGetAttribute(&n_spills, CU_FUNC_ATTRIBUTE_LOCAL_SIZE_BYTES, fun));
-  n_spills /= 4;
+  CUDA_CHECK(cuFuncGetAttribute(&local_bytes,
+                                CU_FUNC_ATTRIBUTE_LOCAL_SIZE_BYTES, fun));
+  n_spills = local_bytes / 4;
   // set dynamic shared memory if necessary
   int shared_optin;
   CUDA_CHECK(cuDeviceGetAttribute(
@@ -93,19 +145,183 @@ static PyObject *loadBinary(PyObject *self, PyObject *args) {
         cuFuncSetAttribute(fun, CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES,
                            shared_optin - shared_static));
   }
+  CUDA_CHECK(cuCtxPopCurrent(NULL));
 
   if (PyErr_Occurred()) {
     return NULL;
   }
-  return Py_BuildValue("(KKii)", (uint64_t)mod, (uint64_t)fun, n_regs,
-                       n_spills);
+  return Py_BuildValue("(KKiii)", (uint64_t)mod, (uint64_t)fun, n_regs,
+                       n_spills, local_bytes);
+}
+
+// Returns the number of blocks of `block_size` threads with `shared` bytes of
+// dynamic shared memory that can be resident on a multiprocessor at once.
+static PyObject *getMaxActiveBlocks(PyObject *self, PyObject *args) {
+  unsigned long long fun;
+  int block_size;
+  int shared;
+  if (!PyArg_ParseTuple(args, "Kii", &fun, &block_size, &shared))
+    return NULL;
+  int num_blocks;
+  CUDA_CHECK(cuOccupancyMaxActiveBlocksPerMultiprocessor(
+      &num_blocks, (CUfunction)fun, block_size, (size_t)shared));
+  return Py_BuildValue("i", num_blocks);
+}
+
+// Unloads a module loaded by load_binary on `device`. The pending work of the
+// context is waited for first, since it may still run the kernels of the
+// module.
+static PyObject *unloadBinary(PyObject *self, PyObject *args) {
+  unsigned long long mod;
+  int device;
+  if (!PyArg_ParseTuple(args, "Ki", &mod, &device))
+    return NULL;
+  CUdevice cu_device;
+  CUcontext ctx;
+  CUDA_CHECK(cuDeviceGet(&cu_device, device));
+  CUDA_CHECK(cuDevicePrimaryCtxRetain(&ctx, cu_device));
+  CUDA_CHECK(cuCtxPushCurrent(ctx));
+  CUDA_CHECK(cuCtxSynchronize());
+  CUDA_CHECK(cuModuleUnload((CUmodule)mod));
+  CUDA_CHECK(cuCtxPopCurrent(NULL));
+  // the retains of this call and of load_binary
+  CUDA_CHECK(cuDevicePrimaryCtxRelease(cu_device));
+  CUDA_CHECK(cuDevicePrimaryCtxRelease(cu_device));
+  Py_RETURN_NONE;
+}
+
+// Stores the 64-bit `value` in the global variable `name` of a module loaded
+// by load_binary on `device`, e.g. the address of a buffer the kernels write.
+static PyObject *setModuleGlobal(PyObject *self, PyObject *args) {
+  unsigned long long mod;
+  const char *name;
+  unsigned long long value;
+  int device;
+  if (!PyArg_ParseTuple(args, "KsKi", &mod, &name, &value, &device))
+    return NULL;
+  CUdevice cu_device;
+  CUcontext ctx;
+  CUdeviceptr global;
+  size_t size;
+  CUDA_CHECK(cuDeviceGet(&cu_device, device));
+  CUDA_CHECK(cuDevicePrimaryCtxRetain(&ctx, cu_device));
+  CUDA_CHECK(cuCtxPushCurrent(ctx));
+  CUDA_CHECK(cuModuleGetGlobal(&global, &size, (CUmodule)mod, name));
+  if (size == sizeof(value))
+    CUDA_CHECK(cuMemcpyHtoD(global, &value, sizeof(value)));
+  CUDA_CHECK(cuCtxPopCurrent(NULL));
+  CUDA_CHECK(cuDevicePrimaryCtxRelease(cu_device));
+  if (size != sizeof(value)) {
+    PyErr_Format(PyExc_ValueError, "%s is not a 64-bit global", name);
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+// Marks [base_ptr, base_ptr + num_bytes) as the access-policy window of
+// `stream`: a `hit_ratio` fraction of its accesses persist in the L2 set-aside
+// area and the others are streamed. A window of 0 bytes resets it.
+static PyObject *setAccessPolicyWindow(PyObject *self, PyObject *args) {
+  unsigned long long stream;
+  unsigned long long base_ptr;
+  unsigned long long num_bytes;
+  float hit_ratio;
+  if (!PyArg_ParseTuple(args, "KKKf", &stream, &base_ptr, &num_bytes,
+                        &hit_ratio))
+    return NULL;
+  CUstreamAttrValue value;
+  memset(&value, 0, sizeof(value));
+  value.accessPolicyWindow.base_ptr = (void *)base_ptr;
+  value.accessPolicyWindow.num_bytes = (size_t)num_bytes;
+  value.accessPolicyWindow.hitRatio = hit_ratio;
+  value.accessPolicyWindow.hitProp = CU_ACCESS_PROPERTY_PERSISTING;
+  value.accessPolicyWindow.missProp = CU_ACCESS_PROPERTY_STREAMING;
+  CUDA_CHECK(cuStreamSetAttribute(
+      (CUstream)stream, CU_STREAM_ATTRIBUTE_ACCESS_POLICY_WINDOW, &value));
+  Py_RETURN_NONE;
+}
+
+// Sets the size of the L2 area set aside for persisting accesses in the
+// current context, and returns the previous size.
+static PyObject *setPersistingL2CacheSize(PyObject *self, PyObject *args) {
+  unsigned long long num_bytes;
+  if (!PyArg_ParseTuple(args, "K", &num_bytes))
+    return NULL;
+  size_t previous;
+  CUDA_CHECK(cuCtxGetLimit(&previous, CU_LIMIT_PERSISTING_L2_CACHE_SIZE));
+  CUDA_CHECK(
+      cuCtxSetLimit(CU_LIMIT_PERSISTING_L2_CACHE_SIZE, (size_t)num_bytes));
+  return Py_BuildValue("K", (unsigned long long)previous);
+}
+
+// The most parameters of a kernel: 4KB of 8-byte slots
+#define MAX_BATCH_PARAMS 512
+
+// Launches a sequence of (grid_x, grid_y, grid_z, num_warps, threads_per_warp,
+// shared, stream, function, params) back-to-back, where params are the kernel
+// parameters packed in 8-byte slots by the `pack` of the launchers.
+static PyObject *launchBatch(PyObject *self, PyObject *args) {
+  PyObject *launches;
+  if (!PyArg_ParseTuple(args, "O", &launches))
+    return NULL;
+  PyObject *seq = PySequence_Fast(launches, "launches must be a sequence");
+  if (!seq)
+    return NULL;
+  void *params[MAX_BATCH_PARAMS];
+  Py_ssize_t num_launches = PySequence_Fast_GET_SIZE(seq);
+  for (Py_ssize_t i = 0; i < num_launches; ++i) {
+    int grid_x, grid_y, grid_z, num_warps, threads_per_warp, shared;
+    unsigned long long stream, function;
+    const char *slots;
+    Py_ssize_t num_bytes;
+    PyObject *launch = PySequence_Fast_GET_ITEM(seq, i);
+    if (!PyArg_ParseTuple(launch, "iiiiiiKKy#", &grid_x, &grid_y, &grid_z,
+                          &num_warps, &threads_per_warp, &shared, &stream,
+                          &function, &slots, &num_bytes)) {
+      Py_DECREF(seq);
+      return NULL;
+    }
+    Py_ssize_t num_params = num_bytes / 8;
+    if (num_params > MAX_BATCH_PARAMS) {
+      Py_DECREF(seq);
+      PyErr_SetString(PyExc_ValueError, "too many kernel parameters");
+      return NULL;
+    }
+    for (Py_ssize_t j = 0; j < num_params; ++j)
+      params[j] = (void *)(slots + 8 * j);
+    if (grid_x * grid_y * grid_z == 0)
+      continue;
+    CUresult err = cuLaunchKernel(
+        (CUfunction)function, grid_x, grid_y, grid_z,
+        threads_per_warp * num_warps, 1, 1, shared, (CUstream)stream, params,
+        NULL);
+    gpuAssert(err, __FILE__, __LINE__);
+    if (PyErr_Occurred()) {
+      Py_DECREF(seq);
+      return NULL;
+    }
+  }
+  Py_DECREF(seq);
+  Py_RETURN_NONE;
 }
 
 static PyMethodDef ModuleMethods[] = {
     {"load_binary", loadBinary, METH_VARARGS,
      "Load provided cubin into CUDA driver"},
+    {"unload_binary", unloadBinary, METH_VARARGS,
+     "Unload a module loaded by load_binary"},
+    {"launch_batch", launchBatch, METH_VARARGS,
+     "Launch a sequence of kernels with packed parameters"},
+    {"get_max_active_blocks", getMaxActiveBlocks, METH_VARARGS,
+     "Get the number of resident blocks per multiprocessor of a function"},
     {"get_device_properties", getDeviceProperties, METH_VARARGS,
      "Get the properties for a given device"},
+    {"set_module_global", setModuleGlobal, METH_VARARGS,
+     "Store a 64-bit value in a global variable of a loaded module"},
+    {"set_access_policy_window", setAccessPolicyWindow, METH_VARARGS,
+     "Set the L2 access-policy window of a stream"},
+    {"set_persisting_l2_cache_size", setPersistingL2CacheSize, METH_VARARGS,
+     "Set the L2 set-aside size for persisting accesses"},
     {NULL, NULL, 0, NULL} // sentinel
 };
 
@@ -34,12 +34,19 @@ static PyObject *getDeviceProperties(PyObject *self, PyObject *args) {
   hipDeviceProp_t props;
   HIP_CHECK(hipGetDeviceProperties(&props, device_id));
 
-  // create a struct to hold device properties
-  return Py_BuildValue("{s:i, s:i, s:i, s:i, s:i}", "max_shared_mem",
-                       props.sharedMemPerBlock, "multiprocessor_count",
-                       props.multiProcessorCount, "sm_clock_rate",
-                       props.clockRate, "mem_clock_rate", props.memoryClockRate,
-                       "mem_bus_width", props.memoryBusWidth);
+  // create a struct to hold device properties. HIP reports no limit on the
+  // blocks of a compute unit: a block takes at least a wavefront.
+  return Py_BuildValue(
+      "{s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i}",
+      "max_shared_mem",
+      props.sharedMemPerBlock, "multiprocessor_count",
+      props.multiProcessorCount, "sm_clock_rate", props.clockRate,
+      "mem_clock_rate", props.memoryClockRate, "mem_bus_width",
+      props.memoryBusWidth, "max_regs_per_sm", props.regsPerMultiprocessor,
+      "max_threads_per_sm", props.maxThreadsPerMultiProcessor,
+      "max_blocks_per_sm", props.maxThreadsPerMultiProcessor / props.warpSize,
+      "max_shared_mem_per_sm", props.maxSharedMemoryPerMultiProcessor,
+      "reserved_shared_mem", 0, "l2_cache_size", props.l2CacheSize);
 }
 
 static PyObject *loadBinary(PyObject *self, PyObject *args) {
@@ -53,21 +60,6 @@ static PyObject *loadBinary(PyObject *self, PyObject *args) {
     return NULL;
   }
 
-  // Open HSACO file
-  FILE *hsaco_file;
-  if ((hsaco_file = fopen(data, "rb")) == NULL) {
-    return NULL;
-  }
-
-  // Read HSCAO file into Buffer
-  fseek(hsaco_file, 0L, SEEK_END);
-  size_t hsaco_file_size = ftell(hsaco_file);
-  unsigned char *hsaco =
-      (unsigned char *)malloc(hsaco_file_size * sizeof(unsigned char));
-  rewind(hsaco_file);
-  fread(hsaco, sizeof(unsigned char), hsaco_file_size, hsaco_file);
-  fclose(hsaco_file);
-
   // set HIP options
   hipJitOption opt[] = {hipJitOptionErrorLogBufferSizeBytes,
                         hipJitOptionErrorLogBuffer,
@@ -80,28 +72,149 @@ static PyObject *loadBinary(PyObject *self, PyObject *args) {
   void *optval[] = {(void *)(uintptr_t)errbufsize, (void *)_err,
                     (void *)(uintptr_t)logbufsize, (void *)_log, (void *)1};
 
+  // the module is loaded on `device`, which is not necessarily the current
+  // one in multi-GPU processes
+  int current_device;
+  HIP_CHECK(hipGetDevice(&current_device));
+  HIP_CHECK(hipSetDevice(device));
   // launch HIP Binary
   hipModule_t mod;
   hipFunction_t fun;
-  hipModuleLoadDataEx(&mod, hsaco, 5, opt, optval);
+  hipModuleLoadDataEx(&mod, data, 5, opt, optval);
   hipModuleGetFunction(&fun, mod, name);
-  free(hsaco);
+  HIP_CHECK(hipSetDevice(current_device));
 
   // get allocated registers and spilled registers from the function
   int n_regs = 0;
   int n_spills = 0;
+  int local_bytes = 0;
   if (PyErr_Occurred()) {
     return NULL;
   }
-  return Py_BuildValue("(KKii)", (uint64_t)mod, (uint64_t)fun, n_regs,
-                       n_spills);
+  return Py_BuildValue("(KKiii)", (uint64_t)mod, (uint64_t)fun, n_regs,
+                       n_spills, local_bytes);
+}
+
+// Returns the number of blocks of `block_size` threads with `shared` bytes of
+// dynamic shared memory that can be resident on a compute unit at once.
+static PyObject *getMaxActiveBlocks(PyObject *self, PyObject *args) {
+  unsigned long long fun;
+  int block_size;
+  int shared;
+  if (!PyArg_ParseTuple(args, "Kii", &fun, &block_size, &shared))
+    return NULL;
+  int num_blocks;
+  HIP_CHECK(hipModuleOccupancyMaxActiveBlocksPerMultiprocessor(
+      &num_blocks, (hipFunction_t)fun, block_size, (size_t)shared));
+  return Py_BuildValue("i", num_blocks);
+}
+
+// Unloads a module loaded by load_binary on `device`. The pending work of the
+// device is waited for first, since it may still run the kernels of the
+// module.
+static PyObject *unloadBinary(PyObject *self, PyObject *args) {
+  unsigned long long mod;
+  int device;
+  if (!PyArg_ParseTuple(args, "Ki", &mod, &device))
+    return NULL;
+  int current_device;
+  HIP_CHECK(hipGetDevice(&current_device));
+  HIP_CHECK(hipSetDevice(device));
+  HIP_CHECK(hipDeviceSynchronize());
+  HIP_CHECK(hipModuleUnload((hipModule_t)mod));
+  HIP_CHECK(hipSetDevice(current_device));
+  Py_RETURN_NONE;
+}
+
+// Stores the 64-bit `value` in the global variable `name` of a module loaded
+// by load_binary on `device`, e.g. the address of a buffer the kernels write.
+static PyObject *setModuleGlobal(PyObject *self, PyObject *args) {
+  unsigned long long mod;
+  const char *name;
+  unsigned long long value;
+  int device;
+  if (!PyArg_ParseTuple(args, "KsKi", &mod, &name, &value, &device))
+    return NULL;
+  int current_device;
+  hipDeviceptr_t global;
+  size_t size;
+  HIP_CHECK(hipGetDevice(&current_device));
+  HIP_CHECK(hipSetDevice(device));
+  HIP_CHECK(hipModuleGetGlobal(&global, &size, (hipModule_t)mod, name));
+  if (size == sizeof(value))
+    HIP_CHECK(hipMemcpyHtoD(global, &value, sizeof(value)));
+  HIP_CHECK(hipSetDevice(current_device));
+  if (size != sizeof(value)) {
+    PyErr_Format(PyExc_ValueError, "%s is not a 64-bit global", name);
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+// The most parameters of a kernel: 4KB of 8-byte slots
+#define MAX_BATCH_PARAMS 512
+
+// Launches a sequence of (grid_x, grid_y, grid_z, num_warps, threads_per_warp,
+// shared, stream, function, params) back-to-back, where params are the kernel
+// parameters packed in 8-byte slots by the `pack` of the launchers.
+static PyObject *launchBatch(PyObject *self, PyObject *args) {
+  PyObject *launches;
+  if (!PyArg_ParseTuple(args, "O", &launches))
+    return NULL;
+  PyObject *seq = PySequence_Fast(launches, "launches must be a sequence");
+  if (!seq)
+    return NULL;
+  void *params[MAX_BATCH_PARAMS];
+  Py_ssize_t num_launches = PySequence_Fast_GET_SIZE(seq);
+  for (Py_ssize_t i = 0; i < num_launches; ++i) {
+    int grid_x, grid_y, grid_z, num_warps, threads_per_warp, shared;
+    unsigned long long stream, function;
+    const char *slots;
+    Py_ssize_t num_bytes;
+    PyObject *launch = PySequence_Fast_GET_ITEM(seq, i);
+    if (!PyArg_ParseTuple(launch, "iiiiiiKKy#", &grid_x, &grid_y, &grid_z,
+                          &num_warps, &threads_per_warp, &shared, &stream,
+                          &function, &slots, &num_bytes)) {
+      Py_DECREF(seq);
+      return NULL;
+    }
+    Py_ssize_t num_params = num_bytes / 8;
+    if (num_params > MAX_BATCH_PARAMS) {
+      Py_DECREF(seq);
+      PyErr_SetString(PyExc_ValueError, "too many kernel parameters");
+      return NULL;
+    }
+    for (Py_ssize_t j = 0; j < num_params; ++j)
+      params[j] = (void *)(slots + 8 * j);
+    if (grid_x * grid_y * grid_z == 0)
+      continue;
+    hipError_t err = hipModuleLaunchKernel(
+        (hipFunction_t)function, grid_x, grid_y, grid_z,
+        threads_per_warp * num_warps, 1, 1, shared, (hipStream_t)stream,
+        params, NULL);
+    gpuAssert(err, __FILE__, __LINE__);
+    if (PyErr_Occurred()) {
+      Py_DECREF(seq);
+      return NULL;
+    }
+  }
+  Py_DECREF(seq);
+  Py_RETURN_NONE;
 }
 
 static PyMethodDef ModuleMethods[] = {
     {"load_binary", loadBinary, METH_VARARGS,
      "Load provided hsaco into HIP driver"},
+    {"unload_binary", unloadBinary, METH_VARARGS,
+     "Unload a module loaded by load_binary"},
+    {"launch_batch", launchBatch, METH_VARARGS,
+     "Launch a sequence of kernels with packed parameters"},
+    {"get_max_active_blocks", getMaxActiveBlocks, METH_VARARGS,
+     "Get the number of resident blocks per compute unit of a function"},
     {"get_device_properties", getDeviceProperties, METH_VARARGS,
      "Get the properties for a given device"},
+    {"set_module_global", setModuleGlobal, METH_VARARGS,
+     "Store a 64-bit value in a global variable of a loaded module"},
     {NULL, NULL, 0, NULL} // sentinel
 };
 
@@ -0,0 +1,132 @@
+from __future__ import annotations
+
+from .driver import driver
+from .jit import JITFunction, get_cuda_stream, get_current_device
+
+
+class LaunchPlan:
+    """
+    A sequence of kernel launches issued back-to-back by a single call into
+    the driver, e.g. the per-parameter kernels of a fused optimizer step.
+
+    The arguments of every launch are converted to kernel parameters when
+    they are set, so issuing the plan only loops over the packed launches in
+    C. Unlike a CUDA graph, the arguments and grids of the launches can change
+    between issues, with :code:`set_args` and :code:`set_grid`.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        plan = triton.runtime.LaunchPlan()
+        for p, g in zip(params, grads):
+            plan.add(sgd_kernel, (triton.cdiv(p.numel(), 1024),), p, g, lr, p.numel(), BLOCK=1024)
+        plan.launch()
+
+    :note: the launch hooks of :code:`CompiledKernel` don't see the launches
+        of the plan one by one; when a hook is installed, the plan falls back
+        to launching the kernels individually.
+    """
+
+    def __init__(self):
+        # [kernel, grid, regular args, packed parameters] of each launch
+        self._launches = []
+        # the launches given to the driver, for a (device, stream)
+        self._batch = None
+        self._batch_key = None
+
+    def __len__(self):
+        return len(self._launches)
+
+    def add(self, kernel, grid, *args, **kwargs):
+        """
+        Appends a launch of :code:`kernel[grid](*args, **kwargs)` and returns
+        its index in the plan.
+
+        :param kernel: a :code:`CompiledKernel`, launched with its regular
+            arguments, or a :code:`@triton.jit` function, compiled for the
+            arguments like :code:`warmup`. The :code:`kwargs` are the
+            constexpr arguments and launch options, e.g. :code:`num_warps`.
+        :param grid: the grid of the launch, a tuple of up to 3 ints
+        """
+        if isinstance(kernel, JITFunction):
+            kernel, args = self._compile(kernel, grid, args, kwargs)
+        elif kwargs:
+            raise TypeError("a compiled kernel takes its regular arguments only")
+        self._launches.append([kernel, self._make_grid(grid), tuple(args), kernel.c_pack(*args)])
+        self._batch = None
+        return len(self._launches) - 1
+
+    def set_args(self, index, *args):
+        """
+        Replaces the regular arguments of the launch at :code:`index`. The
+        new arguments must keep the specialization the kernel was compiled
+        for: the pointers and integers divisible by 16 and the integers equal
+        to 1.
+        """
+        launch = self._launches[index]
+        launch[3] = launch[0].c_pack(*args)
+        launch[2] = tuple(args)
+        self._batch = None
+
+    def set_grid(self, index, grid):
+        """Replaces the grid of the launch at :code:`index`."""
+        self._launches[index][1] = self._make_grid(grid)
+        self._batch = None
+
+    def launch(self, stream=None):
+        """Issues the launches in order on :code:`stream`, the current stream by default."""
+        from ..compiler import CompiledKernel
+        if CompiledKernel.launch_enter_hook is not None or CompiledKernel.launch_exit_hook is not None:
+            for kernel, grid, args, _ in self._launches:
+                kernel[grid](*args, stream=stream)
+            return
+        device = get_current_device()
+        if stream is None:
+            stream = get_cuda_stream(device)
+        # the functions can be unloaded by the bound on the resident modules:
+        # their modules are pinned until the launches are issued
+        resident = CompiledKernel.resident_modules
+        pin = resident.max_bytes is not None
+        if self._batch is None or self._batch_key != (device, stream) or pin:
+            pinned = []
+            try:
+                batch = []
+                for kernel, grid, _, params in self._launches:
+                    function = kernel._init_handles(device, pin)[1]
+                    if pin:
+                        pinned.append(kernel)
+                    batch.append((*grid, kernel.num_warps, kernel.threads_per_warp, kernel.shared, stream, function,
+                                  params))
+                self._batch, self._batch_key = batch, (device, stream)
+                driver.utils.launch_batch(batch)
+            finally:
+                for kernel in pinned:
+                    resident.release(kernel, device)
+            return
+        driver.utils.launch_batch(self._batch)
+
+    @staticmethod
+    def _make_grid(grid):
+        grid = tuple(grid)
+        assert 1 <= len(grid) <= 3, "the grid must have 1 to 3 dimensions"
+        return grid + (1,) * (3 - len(grid))
+
+    @staticmethod
+    def _compile(fn, grid, args, kwargs):
+        bin = fn.run(*args, grid=grid, warmup=True, **kwargs)
+        bound = dict(zip(fn.arg_names, args))
+        bound.update((name, value) for name, value in kwargs.items() if name in fn.arg_names)
+        regular_args = [bound[name] for i, name in enumerate(fn.arg_names) if i not in fn.constexprs]
+        return bin, regular_args
+
+
+def launch_batch(launches, stream=None):
+    """
+    Issues a list of :code:`(kernel, grid, args)` launches of compiled
+    kernels back-to-back with a single call into the driver. See
+    :code:`LaunchPlan` to issue the same launches repeatedly.
+    """
+    plan = LaunchPlan()
+    for kernel, grid, args in launches:
+        plan.add(kernel, grid, *args)
+    plan.launch(stream)
@@ -1,9 +1,14 @@
+import atexit
+import fcntl
 import json
 import os
 import random
+import shutil
+import tempfile
+import zipfile
 from abc import ABC, abstractmethod
 from pathlib import Path
-from typing import Dict, Optional
+from typing import Dict, List, Optional
 
 
 def default_cache_dir():
@@ -110,6 +115,325 @@ class FileCacheManager(CacheManager):
         return filepath
 
 
+def _write_file(path, data):
+    # writes through a temporary file renamed into place, so that concurrent
+    # readers never see a partial write
+    temp_path = f"{path}.tmp.pid_{os.getpid()}_{random.randint(0, 1000000)}"
+    with open(temp_path, "wb") as f:
+        f.write(data)
+    os.replace(temp_path, path)
+    return path
+
+
+def parse_cache_size(size) -> int:
+    """
+    The bytes of a size like :code:`"512M"` or :code:`"20G"`, or of a number.
+    """
+    size = str(size).strip().upper()
+    if size.endswith("B"):
+        size = size[:-1]
+    units = {"K": 1 << 10, "M": 1 << 20, "G": 1 << 30, "T": 1 << 40}
+    if size and size[-1] in units:
+        return int(float(size[:-1]) * units[size[-1]])
+    return int(size)
+
+
+class _CacheLock:
+    # an exclusive lock on a cache directory, shared by all the processes
+    # that use it
+    def __init__(self, dirname):
+        self.path = os.path.join(dirname, "lock")
+
+    def __enter__(self):
+        self.file = open(self.path, "a")
+        fcntl.flock(self.file, fcntl.LOCK_EX)
+        return self
+
+    def __exit__(self, *args):
+        fcntl.flock(self.file, fcntl.LOCK_UN)
+        self.file.close()
+
+
+# The directory, local to the process, where the packed files are extracted
+_extract_dir = None
+
+
+def _get_extract_dir():
+    global _extract_dir
+    if _extract_dir is None:
+        _extract_dir = tempfile.mkdtemp(prefix="triton-cache-")
+        atexit.register(shutil.rmtree, _extract_dir, True)
+    return _extract_dir
+
+
+class PackedCacheManager(CacheManager):
+    """
+    Keeps all the files of a key in a single zip archive,
+    `<TRITON_CACHE_DIR>/packed/<key>.zip`, instead of a directory of files per
+    key: a lookup opens one file, whose central directory indexes its
+    members, which keeps the cache usable on network file systems. Select it
+    with `TRITON_CACHE_MANAGER=triton.runtime.cache:PackedCacheManager`.
+
+    The members are extracted on first use to a temporary directory of the
+    process, as their readers expect paths, e.g. to import the launchers.
+    Archives are rewritten whole and renamed into place under a lock shared
+    by all the processes, so readers see a group either whole or not at all.
+
+    `TRITON_CACHE_MAX_SIZE`, e.g. "20G", bounds the size of the archives: the
+    least recently used ones are evicted once a write exceeds it. The sizes
+    are kept in an index of the directory, so writes don't scan it.
+    """
+
+    def __init__(self, key):
+        self.key = key
+        self.pack_path = None
+        cache_dir = os.environ.get('TRITON_CACHE_DIR', default_cache_dir())
+        if cache_dir:
+            self.pack_dir = os.path.join(cache_dir, "packed")
+            self.pack_path = os.path.join(self.pack_dir, f"{key}.zip")
+            os.makedirs(self.pack_dir, exist_ok=True)
+        max_size = os.environ.get("TRITON_CACHE_MAX_SIZE", "")
+        self.max_size = parse_cache_size(max_size) if max_size else None
+        self._members = None
+        self._touched = False
+
+    def _local_path(self, filename) -> str:
+        dirname = os.path.join(_get_extract_dir(), self.key)
+        os.makedirs(dirname, exist_ok=True)
+        return os.path.join(dirname, filename)
+
+    def _index(self):
+        # the names of the members of the archive
+        if self._members is None:
+            try:
+                with zipfile.ZipFile(self.pack_path) as pack:
+                    self._members = set(pack.namelist())
+            except (FileNotFoundError, zipfile.BadZipFile):
+                self._members = set()
+        return self._members
+
+    def _extract(self, filenames: List[str]) -> Dict[str, str]:
+        # the local paths of the members, extracted if need be
+        paths = {f: self._local_path(f) for f in filenames}
+        missing = [f for f, path in paths.items() if not os.path.exists(path)]
+        if missing:
+            try:
+                with zipfile.ZipFile(self.pack_path) as pack:
+                    for filename in missing:
+                        _write_file(paths[filename], pack.read(filename))
+            except (FileNotFoundError, KeyError, zipfile.BadZipFile):
+                # the archive was evicted or rewritten without the files
+                return {}
+        if not self._touched:
+            # the modification time of the archives orders their eviction
+            self._touched = True
+            try:
+                os.utime(self.pack_path)
+            except FileNotFoundError:
+                pass
+        return paths
+
+    def has_file(self, filename) -> bool:
+        if not self.pack_path:
+            return False
+        return filename in self._index()
+
+    def get_file(self, filename) -> Optional[str]:
+        if not self.has_file(filename):
+            return None
+        return self._extract([filename]).get(filename, None)
+
+    def get_group(self, filename: str) -> Optional[Dict[str, str]]:
+        grp_path = self.get_file(f"__grp__{filename}")
+        if grp_path is None:
+            return None
+        with open(grp_path) as f:
+            grp_data = json.load(f)
+        child_paths = grp_data.get("child_paths", None)
+        # Invalid group data.
+        if child_paths is None or not set(child_paths) <= self._index():
+            return None
+        result = self._extract(child_paths)
+        if len(result) != len(child_paths):
+            return None
+        return result
+
+    def put_group(self, filename: str, group: Dict[str, str]):
+        if not self.pack_path:
+            return
+        grp_contents = json.dumps({"child_paths": sorted(list(group.keys()))})
+        grp_filename = f"__grp__{filename}"
+        return self.put(grp_contents, grp_filename, binary=False)
+
+    def put(self, data, filename, binary=True) -> str:
+        if not self.pack_path:
+            return
+        if not isinstance(data, bytes):
+            data = str(data).encode("utf-8")
+        path = _write_file(self._local_path(filename), data)
+        with _CacheLock(self.pack_dir):
+            members = dict()
+            try:
+                with zipfile.ZipFile(self.pack_path) as pack:
+                    members = {name: pack.read(name) for name in pack.namelist()}
+            except (FileNotFoundError, zipfile.BadZipFile):
+                pass
+            members[filename] = data
+            temp_path = f"{self.pack_path}.tmp.pid_{os.getpid()}_{random.randint(0, 1000000)}"
+            with zipfile.ZipFile(temp_path, "w") as pack:
+                for name, member in members.items():
+                    pack.writestr(name, member)
+            os.replace(temp_path, self.pack_path)
+            self._members = set(members)
+            self._update_index(os.path.getsize(self.pack_path))
+        return path
+
+    def _update_index(self, size):
+        # Records the size of the archive in the index of the directory and
+        # evicts the least recently used archives beyond the maximum size.
+        # The lock is held.
+        index_path = os.path.join(self.pack_dir, "index.json")
+        try:
+            with open(index_path) as f:
+                sizes = json.load(f)
+        except (FileNotFoundError, ValueError):
+            # rebuild the index of a new or damaged directory
+            sizes = {entry.name[:-len(".zip")]: entry.stat().st_size
+                     for entry in os.scandir(self.pack_dir) if entry.name.endswith(".zip")}
+        sizes[self.key] = size
+        if self.max_size is not None and sum(sizes.values()) > self.max_size:
+            used = dict()
+            for key in sizes:
+                try:
+                    used[key] = os.stat(os.path.join(self.pack_dir, f"{key}.zip")).st_mtime
+                except FileNotFoundError:
+                    used[key] = None
+            for key in [k for k, t in used.items() if t is None]:
+                del sizes[key]
+            total = sum(sizes.values())
+            for key in sorted(sizes, key=lambda k: used[k]):
+                if total <= self.max_size:
+                    break
+                if key == self.key:
+                    continue
+                try:
+                    os.remove(os.path.join(self.pack_dir, f"{key}.zip"))
+                except FileNotFoundError:
+                    pass
+                total -= sizes.pop(key)
+        _write_file(index_path, json.dumps(sizes).encode("utf-8"))
+
+
+class RemoteCacheBackend(ABC):
+    """
+    A key-value store shared by all the nodes of a fleet.
+    """
+
+    def __init__(self, key: str):
+        pass
+
+    @abstractmethod
+    def get(self, filenames: List[str]) -> Dict[str, bytes]:
+        pass
+
+    @abstractmethod
+    def put(self, filename: str, data: bytes):
+        pass
+
+
+class RedisRemoteCacheBackend(RemoteCacheBackend):
+    def __init__(self, key):
+        import redis
+        self._key = key
+        self._key_fmt = os.environ.get("TRITON_REDIS_KEY_FORMAT", "triton:{key}:{filename}")
+        self._redis = redis.Redis(
+            host=os.environ.get("TRITON_REDIS_HOST", "localhost"),
+            port=int(os.environ.get("TRITON_REDIS_PORT", 6379)),
+        )
+
+    def _get_key(self, filename: str) -> str:
+        return self._key_fmt.format(key=self._key, filename=filename)
+
+    def get(self, filenames: List[str]) -> Dict[str, bytes]:
+        results = self._redis.mget([self._get_key(f) for f in filenames])
+        return {filename: result for filename, result in zip(filenames, results) if result is not None}
+
+    def put(self, filename: str, data: bytes):
+        self._redis.set(self._get_key(filename), data)
+
+
+class RemoteCacheManager(CacheManager):
+    """
+    Shares compiled artifacts through a remote backend, selected by
+    `TRITON_REMOTE_CACHE_BACKEND` ("module:class", Redis by default), and keeps
+    a local copy of the files it fetches in a `FileCacheManager`.
+
+    Groups are published atomically: the group file is only uploaded after all
+    of its children, so a reader either finds the whole group or nothing.
+    """
+
+    def __init__(self, key):
+        remote_cache_backend = os.environ.get("TRITON_REMOTE_CACHE_BACKEND", None)
+        if remote_cache_backend is None:
+            backend_cls = RedisRemoteCacheBackend
+        else:
+            import importlib
+            module_path, clz_nme = remote_cache_backend.split(":")
+            module = importlib.import_module(module_path)
+            backend_cls = getattr(module, clz_nme)
+        self._backend = backend_cls(key)
+        self._file_cache = FileCacheManager(key)
+
+    def _fetch(self, filenames: List[str]) -> Dict[str, str]:
+        # download missing files into the local cache
+        paths = {}
+        missing = []
+        for filename in filenames:
+            path = self._file_cache.get_file(filename)
+            if path is None:
+                missing.append(filename)
+            else:
+                paths[filename] = path
+        if missing:
+            for filename, data in self._backend.get(missing).items():
+                paths[filename] = self._file_cache.put(data, filename)
+        return paths
+
+    def get_file(self, filename) -> Optional[str]:
+        return self._fetch([filename]).get(filename, None)
+
+    def has_file(self, filename) -> bool:
+        return self.get_file(filename) is not None
+
+    def put(self, data, filename, binary=True) -> str:
+        path = self._file_cache.put(data, filename, binary)
+        if not isinstance(data, bytes):
+            data = str(data).encode("utf-8")
+        self._backend.put(filename, data)
+        return path
+
+    def get_group(self, filename: str) -> Optional[Dict[str, str]]:
+        grp_filename = f"__grp__{filename}"
+        grp_path = self.get_file(grp_filename)
+        if grp_path is None:
+            return None
+        with open(grp_path) as f:
+            grp_data = json.load(f)
+        child_paths = grp_data.get("child_paths", None)
+        # Invalid group data.
+        if child_paths is None:
+            return None
+        result = self._fetch(child_paths)
+        if len(result) != len(child_paths):
+            return None
+        return result
+
+    def put_group(self, filename: str, group: Dict[str, str]):
+        grp_contents = json.dumps({"child_paths": sorted(list(group.keys()))})
+        grp_filename = f"__grp__{filename}"
+        return self.put(grp_contents, grp_filename, binary=False)
+
+
 __cache_cls = FileCacheManager
 __cache_cls_nme = "DEFAULT"
 
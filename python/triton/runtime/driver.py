@@ -51,7 +51,13 @@ class CudaUtils(object):
         mod = importlib.util.module_from_spec(spec)
         spec.loader.exec_module(mod)
         self.load_binary = mod.load_binary
+        self.unload_binary = mod.unload_binary
+        self.launch_batch = mod.launch_batch
+        self.get_max_active_blocks = mod.get_max_active_blocks
         self.get_device_properties = mod.get_device_properties
+        self.set_module_global = mod.set_module_global
+        self.set_access_policy_window = mod.set_access_policy_window
+        self.set_persisting_l2_cache_size = mod.set_persisting_l2_cache_size
 
 
 class CudaDriver(DriverBase):
@@ -96,7 +102,11 @@ class HIPUtils(object):
         mod = importlib.util.module_from_spec(spec)
         spec.loader.exec_module(mod)
         self.load_binary = mod.load_binary
+        self.unload_binary = mod.unload_binary
+        self.launch_batch = mod.launch_batch
+        self.get_max_active_blocks = mod.get_max_active_blocks
         self.get_device_properties = mod.get_device_properties
+        self.set_module_global = mod.set_module_global
 
 
 class HIPDriver(DriverBase):
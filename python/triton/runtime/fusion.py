@@ -0,0 +1,162 @@
+from __future__ import annotations
+
+import hashlib
+import inspect
+import linecache
+
+from .. import language
+from ..language.core import _constexpr_to_value, _to_tensor, builtin
+from .jit import JITFunction
+
+
+class HorizontalFusion:
+    """
+    Independent launches of small kernels fused into a single launch of one
+    kernel, e.g. the bias additions of several heads or the normalizations of
+    a layer, which would each pay the launch overhead and underfill the GPU.
+
+    The fused kernel runs the programs of every part one after the other
+    along its 1-D grid: each part sees its own :code:`tl.program_id` and
+    :code:`tl.num_programs`, as if it was launched alone. The parts are in
+    distinct branches of the fused kernel, so their shared memory overlaps:
+    the fused kernel needs as much as its largest part. It is compiled and
+    cached like any other :code:`@triton.jit` function, for the kernels of
+    the parts and the specialization of all their arguments.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        fusion = triton.runtime.HorizontalFusion()
+        for x, bias in zip(heads, biases):
+            fusion.add(add_bias, (triton.cdiv(x.numel(), 1024),), x, bias, x.numel(), BLOCK=1024)
+        fusion.add(layer_norm, (rows,), y, w, b, cols, eps, BLOCK=triton.next_power_of_2(cols))
+        fusion.launch(num_warps=4)
+
+    :note: the parts run in no particular order and in a single launch, so
+        they must not depend on each other. The launch options, e.g.
+        :code:`num_warps`, apply to the fused kernel as a whole. The functions
+        called by a part read its program ids only if their caller does too.
+    """
+
+    def __init__(self):
+        # [kernel, grid, bound arguments] of each part
+        self._parts = []
+
+    def __len__(self):
+        return len(self._parts)
+
+    def add(self, kernel, grid, *args, **kwargs):
+        """
+        Appends a part running :code:`kernel[grid](*args, **kwargs)` and
+        returns its index in the fusion.
+
+        :param kernel: a :code:`@triton.jit` function
+        :param grid: the grid of the part, a tuple of up to 3 ints, or a
+            callable returning it for the arguments of the part by name
+        """
+        assert isinstance(kernel, JITFunction), "only @triton.jit functions can be fused"
+        bound = inspect.signature(kernel.fn).bind(*args, **kwargs)
+        bound.apply_defaults()
+        self._parts.append([kernel, grid, dict(bound.arguments)])
+        return len(self._parts) - 1
+
+    @property
+    def kernel(self):
+        """The fused :code:`@triton.jit` function of the parts."""
+        return fuse([kernel for kernel, _, _ in self._parts])
+
+    @property
+    def grid(self):
+        """The grid of the fused kernel, one program per program of a part."""
+        return (sum(_grid_size(grid) for grid in self._grids()),)
+
+    def _grids(self):
+        grids = []
+        for _, grid, args in self._parts:
+            if callable(grid):
+                grid = grid(args)
+            grid = tuple(grid) if isinstance(grid, (tuple, list)) else (grid,)
+            assert 1 <= len(grid) <= 3, "the grid of a part has 1 to 3 dimensions"
+            grids.append(grid + (1,) * (3 - len(grid)))
+        return grids
+
+    def launch(self, **kwargs):
+        """
+        Launches the fused kernel; the :code:`kwargs` are the launch options
+        of a :code:`@triton.jit` function, e.g. :code:`num_warps` or
+        :code:`stream`.
+        """
+        assert self._parts, "the fusion has no parts"
+        grids = self._grids()
+        args = {}
+        for i, ((_, _, part_args), grid) in enumerate(zip(self._parts, grids)):
+            args.update({f"_p{i}_{name}": value for name, value in part_args.items()})
+            args.update({f"_grid{i}_{d}": size for d, size in enumerate(grid)})
+        total = sum(_grid_size(grid) for grid in grids)
+        if total == 0:
+            return None
+        return self.kernel[(total,)](**args, **kwargs)
+
+
+def _grid_size(grid):
+    size = 1
+    for dim in grid:
+        size *= dim
+    return size
+
+
+@builtin
+def _call_part(fn, program_ids, num_programs, *args, _builder=None, _generator=None):
+    # calls the kernel of a part, whose tl.program_id and tl.num_programs
+    # return `program_ids` and `num_programs`
+    pids = [_to_tensor(pid, _builder) for pid in tuple(program_ids) + tuple(num_programs)]
+    return _generator.call_JitFunction(_constexpr_to_value(fn), list(args), {}, program_ids=pids)
+
+
+_fused_functions = {}
+
+
+def fuse(kernels):
+    """
+    Returns the :code:`@triton.jit` function running the programs of each
+    kernel of :code:`kernels`, in order, along its 1-D grid. Its arguments
+    are those of every kernel, prefixed with :code:`_p<i>_`, followed by the
+    3 dimensions of its grid, :code:`_grid<i>_0` to :code:`_grid<i>_2`.
+    """
+    key = tuple(kernels)
+    if key not in _fused_functions:
+        _fused_functions[key] = _make_fused_function(key)
+    return _fused_functions[key]
+
+
+def _make_fused_function(kernels):
+    name = "fused_" + "_".join(kernel.__name__ for kernel in kernels)
+    scope = {"__name__": __name__, "tl": language, "_call_part": _call_part}
+    params, do_not_specialize = [], []
+    body = ["    pid = tl.program_id(0)"]
+    for i, kernel in enumerate(kernels):
+        scope[f"_kernel{i}"] = kernel
+        args = [f"_p{i}_{arg}" for arg in kernel.arg_names]
+        params += [f"{arg}: tl.constexpr" if j in kernel.constexprs else arg for j, arg in enumerate(args)]
+        do_not_specialize += [args[j] for j in kernel.do_not_specialize]
+        grid = [f"_grid{i}_{d}" for d in range(3)]
+        params += grid
+        size = " * ".join(grid)
+        body.append(f"    _end{i} = {size}" if i == 0 else f"    _end{i} = _end{i - 1} + {size}")
+    for i, kernel in enumerate(kernels):
+        g0, g1, g2 = [f"_grid{i}_{d}" for d in range(3)]
+        args = ", ".join(f"_p{i}_{arg}" for arg in kernel.arg_names)
+        indent = "    "
+        if len(kernels) > 1:
+            branch = "if" if i == 0 else "elif" if i < len(kernels) - 1 else "else"
+            body.append(f"    {branch} pid < _end{i}:" if branch != "else" else "    else:")
+            indent = "        "
+        body.append(f"{indent}_pid = pid" if i == 0 else f"{indent}_pid = pid - _end{i - 1}")
+        body.append(f"{indent}_call_part(_kernel{i}, (_pid % {g0}, _pid // {g0} % {g1}, _pid // ({g0} * {g1})),")
+        body.append(f"{indent}           ({g0}, {g1}, {g2}), {args})")
+    src = "\n".join([f"def {name}({', '.join(params)}):"] + body) + "\n"
+    # JITFunction reads the source of the function back, from the linecache
+    filename = f"<triton-fusion-{hashlib.md5(src.encode('utf-8')).hexdigest()}>"
+    linecache.cache[filename] = (len(src), None, src.splitlines(keepends=True), filename)
+    exec(compile(src, filename, "exec"), scope)
+    return JITFunction(scope[name], do_not_specialize=do_not_specialize)
@@ -0,0 +1,98 @@
+from __future__ import annotations
+
+from typing import Callable
+
+
+def is_capturing() -> bool:
+    """
+    Returns True when the current CUDA stream is being captured into a graph.
+    """
+    import torch
+    return torch.cuda.is_available() and torch.cuda.is_current_stream_capturing()
+
+
+class KernelGraph:
+    """
+    Records a sequence of Triton launches into a CUDA graph and replays it.
+
+    Replaying the graph skips the Python launcher of every kernel, which
+    removes the host overhead of launch-bound loops. Launches are recorded
+    with the addresses of their arguments: the tensors passed to
+    :code:`capture` become the inputs of the graph, and :code:`replay` copies
+    new inputs into them.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        graph = triton.runtime.KernelGraph()
+        out = graph.capture(step, x, w)
+        for x in inputs:
+            out = graph.replay(x, w)
+
+    :note: Kernels are compiled, and autotuned kernels are tuned, by the
+        warm-up runs that precede the capture. Autotuning a new key while
+        capturing raises an error.
+    :note: :code:`CompiledKernel.launch_enter_hook` and
+        :code:`launch_exit_hook` only run when the launches are recorded,
+        not when the graph is replayed.
+    """
+
+    def __init__(self, device=None, pool=None):
+        import torch
+        self.device = torch.cuda.current_device() if device is None else device
+        self.pool = pool
+        self.graph = None
+        self.static_args = None
+        self.static_outputs = None
+
+    def capture(self, fn: Callable, *args, warmup: int = 1):
+        """
+        Records the Triton launches issued by :code:`fn(*args)`.
+
+        :param fn: function launching Triton kernels
+        :param args: arguments of :code:`fn`; tensors are captured by address
+            and must stay alive as long as the graph
+        :param warmup: number of eager runs before the capture. At least one
+            is needed to compile and tune the kernels.
+        :return: the outputs of :code:`fn`, which are updated by every replay
+        """
+        import torch
+        if warmup < 1:
+            raise ValueError("at least one warm-up run is needed before capturing a CUDA graph")
+        with torch.cuda.device(self.device):
+            self.static_args = args
+            # compile, load and tune the kernels outside of the capture
+            stream = torch.cuda.Stream()
+            stream.wait_stream(torch.cuda.current_stream())
+            with torch.cuda.stream(stream):
+                for _ in range(warmup):
+                    fn(*self.static_args)
+            torch.cuda.current_stream().wait_stream(stream)
+            self.graph = torch.cuda.CUDAGraph()
+            with torch.cuda.graph(self.graph, pool=self.pool):
+                self.static_outputs = fn(*self.static_args)
+        return self.static_outputs
+
+    def replay(self, *args):
+        """
+        Replays the recorded launches.
+
+        :param args: new arguments of the captured function. Tensors are copied
+            into the recorded ones; other arguments must be the same as the
+            captured ones. No argument replays the graph with its current inputs.
+        :return: the outputs of the captured function
+        """
+        import torch
+        if self.graph is None:
+            raise RuntimeError("KernelGraph.replay called before capture")
+        if args:
+            if len(args) != len(self.static_args):
+                raise ValueError(f"expected {len(self.static_args)} arguments, got {len(args)}")
+            for static, arg in zip(self.static_args, args):
+                if isinstance(static, torch.Tensor):
+                    if arg is not static:
+                        static.copy_(arg)
+                elif arg != static:
+                    raise ValueError(f"non-tensor argument {arg} differs from the captured value {static}")
+        self.graph.replay()
+        return self.static_outputs
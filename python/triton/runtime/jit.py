@@ -7,10 +7,13 @@ import inspect
 import os
 import subprocess
 import textwrap
+import threading
 from collections import defaultdict, namedtuple
-from typing import Callable, Generic, Iterable, Optional, TypeVar, Union, cast, overload
+from concurrent.futures import ThreadPoolExecutor
+from typing import Callable, Dict, Generic, Iterable, Optional, TypeVar, Union, cast, overload
 
 import triton
+import triton._C.libtriton.triton as _triton
 
 
 def get_cuda_stream(idx=None):
@@ -34,6 +37,37 @@ def set_current_device(idx):
     torch.cuda.set_device(idx)
 
 
+def round_to_bucket(value, buckets, name="value"):
+    """
+    Returns the smallest of the sorted :code:`buckets` that is at least
+    :code:`value`, or :code:`buckets(value)` when the buckets are a function,
+    e.g. :code:`triton.next_power_of_2`.
+    """
+    if callable(buckets):
+        return buckets(value)
+    for bucket in buckets:
+        if value <= bucket:
+            return bucket
+    raise ValueError(f"{name}={value} is larger than its largest bucket {buckets[-1]}")
+
+
+_compile_pool = None
+_compile_pool_lock = threading.Lock()
+
+
+def get_compile_pool():
+    """
+    Returns the worker threads of the background compilations, as many as
+    :code:`TRITON_ASYNC_COMPILE_THREADS` or the CPUs.
+    """
+    global _compile_pool
+    with _compile_pool_lock:
+        if _compile_pool is None:
+            num_threads = int(os.environ.get("TRITON_ASYNC_COMPILE_THREADS", os.cpu_count() or 1))
+            _compile_pool = ThreadPoolExecutor(max_workers=num_threads, thread_name_prefix="triton-compile")
+    return _compile_pool
+
+
 def get_device_capability(idx):
     import torch
     return torch.cuda.get_device_capability(idx)
@@ -153,6 +187,8 @@ class JITFunction(KernelInterface[T]):
                 return "i64"
         elif isinstance(arg, float):
             return 'fp32'
+        elif hasattr(arg, "param_type"):
+            return arg.param_type
         elif arg is None:
             return None
         else:
@@ -237,58 +273,45 @@ class JITFunction(KernelInterface[T]):
 
         return JITFunction.cache_hook(key=key, repr=repr, fn=LegacyCompiler(module, name), compile={"key": key, **kwargs}, is_manual_warmup=False, already_compiled=False)
 
-    def _get_arg_specialization_key(self, arg) -> str:
+    def _get_arg_kind(self, arg):
         arg_annotation = self.__annotations__.get(arg, '')
         if arg_annotation == '':
-            return f'({arg}.data_ptr() % {JITFunction.divisibility} == 0) if hasattr({arg}, "data_ptr") \
-                        else ({arg} % {JITFunction.divisibility} == 0, {arg} == 1) if isinstance({arg}, int) \
-                        else (False,)'
+            return _triton.runtime.arg_kind.ANY
         elif 'Tensor' in arg_annotation:
-            return f'({arg}.data_ptr() % {JITFunction.divisibility} == 0)'
-        elif arg_annotation == 'int':
-            return f'({arg} % {JITFunction.divisibility} == 0, {arg} == 1)'
-        else:
-            return '(False,)'
-
-    def _get_arg_sig_key(self, arg) -> str:
-        arg_annotation = self.__annotations__.get(arg, '')
-        if 'Tensor' in arg_annotation:
-            return f'{arg}.dtype'
+            return _triton.runtime.arg_kind.TENSOR
         elif arg_annotation == 'bool':
-            return "i1"
+            return _triton.runtime.arg_kind.BOOL
         elif arg_annotation == 'float':
-            return 'fp32'
+            return _triton.runtime.arg_kind.FLOAT
+        elif arg_annotation == 'int':
+            return _triton.runtime.arg_kind.INT
         else:
-            return f'_key_of({arg})'
+            return _triton.runtime.arg_kind.OTHER
+
+    def _make_dispatcher(self):
+        # the cache key, the specialization checks and the cache lookup
+        # of every launch are computed in C++
+        regular_args = [arg for i, arg in enumerate(self.arg_names) if i not in self.constexprs]
+        is_constexpr = [i in self.constexprs for i in range(len(self.arg_names))]
+        arg_kinds = [self._get_arg_kind(arg) for arg in regular_args]
+        specialize = [i not in self.do_not_specialize for i in range(len(regular_args))]
+        return _triton.runtime.dispatcher(version_key(), is_constexpr, arg_kinds, specialize, JITFunction.divisibility)
 
     def _make_launcher(self):
         regular_args = [f'{arg}' for i, arg in enumerate(self.arg_names) if i not in self.constexprs]
         constexpr_args = [f'{arg}' for i, arg in enumerate(self.arg_names) if i in self.constexprs]
         args = ', '.join(regular_args)
-        # cache key for regular argument type
-        sig_keys = ', '.join([self._get_arg_sig_key(arg) for arg in regular_args])
+        all_args = ', '.join(self.arg_names)
         # cache key for constexpr argument values
         constexpr_keys = ', '.join(constexpr_args)
-        # cache key for argument specialization
-        specializations = []
-        for i, arg in enumerate(regular_args):
-            if i in self.do_not_specialize:
-                continue
-            specializations += [self._get_arg_specialization_key(arg)]
-
-        spec_keys = ', '.join(specializations)
         grid_args = ','.join([f'"{arg}": {arg}' for arg in self.arg_names])
+        # the bucketed constexprs are rounded up before the grid and the key
+        buckets = ''.join([f'    {arg} = round_to_bucket({arg}, self.buckets["{arg}"], "{arg}")\n' for arg in self.buckets])
 
         src = f"""
-def {self.fn.__name__}({', '.join(self.arg_names)}, grid, num_warps=4, num_stages=3, extern_libs=None, stream=None, warmup=False, device=None):
-    sig_key =  {sig_keys},
-    constexpr_key = {f'{constexpr_keys},' if len(constexpr_keys) > 0 else ()}
-    spec_key = {f'{spec_keys},' if len(spec_keys) > 0 else ()}
-    key = (version_key, sig_key, constexpr_key, spec_key, num_warps, num_stages, self.debug)
-    if not extern_libs is None:
-      key = (key, tuple(extern_libs.items()))
+def {self.fn.__name__}({all_args}, grid, num_warps=4, num_stages=3, extern_libs=None, stream=None, warmup=False, device=None, target=None):
     assert num_warps > 0 and (num_warps & (num_warps - 1)) == 0, "num_warps must be a power of 2"
-    if callable(grid):
+{buckets}    if callable(grid):
         grid = grid({{{grid_args}}})
     grid_size = len(grid)
     grid_0 = grid[0]
@@ -299,43 +322,61 @@ def {self.fn.__name__}({', '.join(self.arg_names)}, grid, num_warps=4, num_stage
         set_current_device(device)
     if stream is None and not warmup:
       stream = get_cuda_stream(device)
-    try:
-      bin = cache[device][key]
-      if not warmup:
-          bin.c_wrapper(grid_0, grid_1, grid_2, bin.num_warps, bin.shared, stream, bin.cu_function, triton.compiler.CompiledKernel.launch_enter_hook, triton.compiler.CompiledKernel.launch_exit_hook, bin, {args})
-      return bin
+    if target is None:
+      bin = dispatcher.launch(cache[device], device, num_warps, num_stages, self.debug, extern_libs, grid_0, grid_1, grid_2, stream, warmup, triton.compiler.CompiledKernel.launch_enter_hook, triton.compiler.CompiledKernel.launch_exit_hook, {all_args})
+      if bin is not None:
+        return bin
     # kernel not cached -- compile
-    except KeyError:
-      # build dict of constant values
-      args = [{args}]
-      all_args = {', '.join([f'{arg}' for arg in self.arg_names])},
-      configs = self._get_config(*all_args),
-      constants = self._make_constants(constexpr_key)
-      constants.update({{i: None for i, arg in enumerate(all_args) if arg is None}})
-      constants.update({{i: 1 for i in configs[0].equal_to_1}})
-      # build kernel signature -- doesn't include specialized arguments
-      signature = {{ i: self._type_of(_key_of(arg)) for i, arg in enumerate(all_args) if i not in self.constexprs }}
-      # build stub signature -- includes arguments that are specialized
-      for i, arg in constants.items():
-        if callable(arg):
-          raise TypeError(f"Callable constexpr at index {{i}} is not supported")
-      if not self._call_hook(key, signature, device, constants, num_warps, num_stages, extern_libs, configs):
-        bin = triton.compile(self, signature=signature, device=device, constants=constants, num_warps=num_warps, num_stages=num_stages, extern_libs=extern_libs, configs=configs, debug=self.debug)
+    key = dispatcher.key(num_warps, num_stages, self.debug, extern_libs, {all_args})
+    if target is None:
+      # the devices of the same target share the compiled kernel, each loads it
+      bin = self._get_shared(device, key)
+      if bin is not None:
         if not warmup:
-            bin.c_wrapper(grid_0, grid_1, grid_2, bin.num_warps, bin.shared, stream, bin.cu_function, triton.compiler.CompiledKernel.launch_enter_hook, triton.compiler.CompiledKernel.launch_exit_hook, bin, *args)
+          bin._run(device, grid_0, grid_1, grid_2, stream, *[{args}])
         self.cache[device][key] = bin
         return bin
-      return None
+    constexpr_key = {f'{constexpr_keys},' if len(constexpr_keys) > 0 else ()}
+    # build dict of constant values
+    args = [{args}]
+    all_args = {all_args},
+    configs = self._get_config(*all_args),
+    constants = self._make_constants(constexpr_key)
+    constants.update({{i: None for i, arg in enumerate(all_args) if arg is None}})
+    constants.update({{i: 1 for i in configs[0].equal_to_1}})
+    # build kernel signature -- doesn't include specialized arguments
+    signature = {{ i: self._type_of(_key_of(arg)) for i, arg in enumerate(all_args) if i not in self.constexprs }}
+    # build stub signature -- includes arguments that are specialized
+    for i, arg in constants.items():
+      if callable(arg) and not isinstance(arg, JITFunction):
+        raise TypeError(f"Callable constexpr at index {{i}} is not supported: only @triton.jit functions can be passed")
+    # resource estimates are not cached
+    if target is not None:
+      return self._compile(signature, device, constants, num_warps, num_stages, extern_libs, configs, target=target)
+    if not self._call_hook(key, signature, device, constants, num_warps, num_stages, extern_libs, configs):
+      if self.async_compile and not warmup:
+        # launches a fallback until the kernel compiles in the background
+        bin = self._compile_async(device, key, signature, constants, num_warps, num_stages, extern_libs, configs)
+      else:
+        bin = self._compile(signature, device, constants, num_warps, num_stages, extern_libs, configs)
+        self.cache[device][key] = bin
+      if not warmup:
+          bin._run(device, grid_0, grid_1, grid_2, stream, *args)
+      return bin
+    return None
 """
-        scope = {"version_key": version_key(), "get_cuda_stream": get_cuda_stream,
+        scope = {"get_cuda_stream": get_cuda_stream,
                  "self": self, "_spec_of": self._spec_of, "_key_of": self._key_of,
-                 "cache": self.cache, "triton": triton,
+                 "cache": self.cache, "triton": triton, "JITFunction": JITFunction,
+                 "dispatcher": self._make_dispatcher(),
                  "get_current_device": get_current_device,
-                 "set_current_device": set_current_device}
+                 "set_current_device": set_current_device,
+                 "round_to_bucket": round_to_bucket}
         exec(src, scope)
         return scope[self.fn.__name__]
 
-    def __init__(self, fn, version=None, do_not_specialize=None, debug=None, noinline=None):
+    def __init__(self, fn, version=None, do_not_specialize=None, debug=None, noinline=None, fast_math=None, auto_num_stages=None,
+                 maxnreg=None, min_blocks_per_sm=None, async_compile=None, buckets=None, auto_num_warps=None):
         self.fn = fn
         self.module = fn.__module__
         self.version = version
@@ -347,8 +388,11 @@ def {self.fn.__name__}({', '.join(self.arg_names)}, grid, num_warps=4, num_stage
         self.do_not_specialize = [] if do_not_specialize is None else do_not_specialize
         self.do_not_specialize = {self.arg_names.index(arg) if isinstance(arg, str) else arg for arg in self.do_not_specialize}
         # function source code (without decorators)
-        self.src = textwrap.dedent(inspect.getsource(fn))
-        self.src = self.src[self.src.find("def"):]
+        src = textwrap.dedent(inspect.getsource(fn))
+        self.src = src[src.find("def"):]
+        # the file and line of the `def`, i.e. of the first line of `src`
+        self.file_name = fn.__code__.co_filename
+        self.starting_line_number = fn.__code__.co_firstlineno + src[:src.find("def")].count("\n")
         # cache of just-in-time compiled kernels
         self.cache = defaultdict(dict)
         self.hash = None
@@ -358,11 +402,27 @@ def {self.fn.__name__}({', '.join(self.arg_names)}, grid, num_warps=4, num_stage
         self.kernel = None
         self.debug = os.environ.get("TRITON_DEBUG", "0") == "1" if debug is None else debug
         self.noinline = noinline
+        self.fast_math = os.environ.get("TRITON_FAST_MATH", "0") == "1" if fast_math is None else fast_math
+        self.auto_num_stages = os.environ.get("TRITON_AUTO_NUM_STAGES", "0") == "1" if auto_num_stages is None else auto_num_stages
+        self.auto_num_warps = os.environ.get("TRITON_AUTO_NUM_WARPS", "0") == "1" if auto_num_warps is None else auto_num_warps
+        self.maxnreg = maxnreg
+        self.min_blocks_per_sm = min_blocks_per_sm
+        self.async_compile = os.environ.get("TRITON_ASYNC_COMPILE", "0") == "1" if async_compile is None else async_compile
+        # the background compilations, by (device, key), and the kernels
+        # launched meanwhile, by unspecialized signature
+        self._pending = {}
+        self._fallbacks = {}
         # annotations
         normalize_ty = lambda ty: ty.__name__ if isinstance(ty, type) else ty
         self.__annotations__ = {name: normalize_ty(ty) for name, ty in fn.__annotations__.items()}
         # index of constexprs
         self.constexprs = [self.arg_names.index(name) for name, ty in self.__annotations__.items() if 'constexpr' in ty]
+        # the values a constexpr is rounded up to
+        self.buckets = {}
+        for name, values in (buckets or {}).items():
+            assert name in self.arg_names and self.arg_names.index(name) in self.constexprs, \
+                f"only constexpr arguments can be bucketed, not {name}"
+            self.buckets[name] = values if callable(values) else sorted(values)
         # launcher
         self.run = self._make_launcher()
         # re-use docs of wrapped function
@@ -383,6 +443,84 @@ def {self.fn.__name__}({', '.join(self.arg_names)}, grid, num_warps=4, num_stage
     def warmup(self, *args, **kwargs):
         return self.run(*map(MockTensor.wrap_dtype, args), **kwargs, warmup=True)
 
+    def preload(self, *args, devices=None, **kwargs):
+        '''
+        Compiles the kernel for the given arguments like :code:`warmup`, and
+        loads it on each of :code:`devices`, all the visible devices by
+        default: a multi-GPU process compiles the kernel once per target and
+        its first launch on each device neither compiles nor loads it.
+
+        :return: the compiled kernel of each device
+        '''
+        if devices is None:
+            import torch
+            devices = range(torch.cuda.device_count())
+        bins = {device: self.warmup(*args, device=device, **kwargs) for device in devices}
+        for device, bin in bins.items():
+            bin.preload([device])
+        return bins
+
+    def _compile(self, signature, device, constants, num_warps, num_stages, extern_libs, configs, target=None):
+        return triton.compile(self, signature=signature, device=device, constants=constants, num_warps=num_warps,
+                              num_stages=num_stages, extern_libs=extern_libs, configs=configs, debug=self.debug,
+                              fast_math=self.fast_math, auto_num_stages=self.auto_num_stages, maxnreg=self.maxnreg,
+                              min_blocks_per_sm=self.min_blocks_per_sm, auto_num_warps=self.auto_num_warps, target=target)
+
+    def _compile_async(self, device, key, signature, constants, num_warps, num_stages, extern_libs, configs):
+        # Compiles the specialization in the background, and returns the
+        # variant of the kernel without the divisibility and equal-to-1
+        # specializations of the arguments, which every specialization of the
+        # signature can launch. The fallback compiles once per signature.
+        pending = self._pending.get((device, key))
+        if pending is not None and pending.done():
+            # raises the errors of the compilation
+            bin = pending.result()
+            self.cache[device][key] = bin
+            return bin
+        divisible = [i for i in configs[0].divisible_by_16 if i not in self.constexprs]
+        equal_to_1 = [i for i in configs[0].equal_to_1 if i not in self.constexprs]
+        if not divisible and not equal_to_1:
+            bin = self._compile(signature, device, constants, num_warps, num_stages, extern_libs, configs)
+            self.cache[device][key] = bin
+            return bin
+        if pending is None:
+            pending = get_compile_pool().submit(self._compile, signature, device, constants, num_warps, num_stages,
+                                                extern_libs, configs)
+            self._pending[(device, key)] = pending
+
+            def install(future):
+                if future.exception() is None:
+                    self.cache[device][key] = future.result()
+                    self._pending.pop((device, key), None)
+            pending.add_done_callback(install)
+        constants = {i: value for i, value in constants.items() if i not in equal_to_1}
+        fallback_key = (device, num_warps, num_stages, str(extern_libs), tuple(sorted(signature.items())),
+                        repr(sorted(constants.items())))
+        fallback = self._fallbacks.get(fallback_key)
+        if fallback is None:
+            configs = (type(configs[0])((), ()), )
+            fallback = self._compile(signature, device, constants, num_warps, num_stages, extern_libs, configs)
+            self._fallbacks[fallback_key] = fallback
+        return fallback
+
+    def wait_for_compilations(self):
+        """Waits for the background compilations of :code:`async_compile`, and raises their errors."""
+        for (device, key), pending in list(self._pending.items()):
+            self.cache[device][key] = pending.result()
+            self._pending.pop((device, key), None)
+
+    def _get_shared(self, device, key):
+        # the kernel compiled for another device of the same target
+        capability = None
+        for other, cache in self.cache.items():
+            if other == device or key not in cache:
+                continue
+            if capability is None:
+                capability = get_device_capability(device)
+            if get_device_capability(other) == capability:
+                return cache[key]
+        return None
+
     # we do not parse `src` in the constructor because
     # the user might want to monkey-patch self.src dynamically.
     # Our unit tests do this, for example.
@@ -428,6 +566,13 @@ def jit(
     do_not_specialize: Optional[Iterable[int]] = None,
     debug: Optional[bool] = None,
     noinline: Optional[bool] = None,
+    fast_math: Optional[bool] = None,
+    auto_num_stages: Optional[bool] = None,
+    maxnreg: Optional[int] = None,
+    min_blocks_per_sm: Optional[int] = None,
+    async_compile: Optional[bool] = None,
+    buckets: Optional[Dict[str, Union[Iterable[int], Callable[[int], int]]]] = None,
+    auto_num_warps: Optional[bool] = None,
 ) -> Callable[[T], JITFunction[T]]:
     ...
 
@@ -439,6 +584,13 @@ def jit(
     do_not_specialize: Optional[Iterable[int]] = None,
     debug: Optional[bool] = None,
     noinline: Optional[bool] = None,
+    fast_math: Optional[bool] = None,
+    auto_num_stages: Optional[bool] = None,
+    maxnreg: Optional[int] = None,
+    min_blocks_per_sm: Optional[int] = None,
+    async_compile: Optional[bool] = None,
+    buckets: Optional[Dict[str, Union[Iterable[int], Callable[[int], int]]]] = None,
+    auto_num_warps: Optional[bool] = None,
     interpret: Optional[bool] = None,
 ) -> Union[JITFunction[T], Callable[[T], JITFunction[T]]]:
     """
@@ -457,6 +609,48 @@ def jit(
 
     :param fn: the function to be jit-compiled
     :type fn: Callable
+    :param fast_math: lower f32 :code:`exp`, :code:`log`, :code:`sin`,
+        :code:`cos`, :code:`sqrt`, reciprocals and the matching libdevice
+        functions (including :code:`tanh`) to approximate PTX instructions, and
+        let LLVM reassociate floating-point math. Defaults to the
+        :code:`TRITON_FAST_MATH` environment variable.
+    :type fast_math: bool, optional
+    :param auto_num_stages: treat :code:`num_stages` as an upper bound and
+        compile with the largest stage count whose shared memory fits the
+        device. The chosen count is in the :code:`num_stages` of the compiled
+        kernel. Defaults to the :code:`TRITON_AUTO_NUM_STAGES` environment
+        variable.
+    :type auto_num_stages: bool, optional
+    :param maxnreg: the maximum number of registers per thread, as the
+        :code:`-maxrregcount` of :code:`nvcc`. The registers over the bound
+        are spilled to local memory.
+    :type maxnreg: int, optional
+    :param min_blocks_per_sm: the minimum number of programs that must be
+        resident on a multiprocessor, as the second argument of
+        :code:`__launch_bounds__`. ptxas bounds the registers accordingly.
+    :type min_blocks_per_sm: int, optional
+    :param async_compile: compile the new specializations of the arguments
+        on a background thread pool. Until a specialization is compiled, its
+        launches use a variant of the kernel without the divisibility and
+        equal-to-1 hints of the arguments, compiled once per signature and
+        constexpr values. Defaults to the :code:`TRITON_ASYNC_COMPILE`
+        environment variable.
+    :type async_compile: bool, optional
+    :param buckets: the values that constexpr arguments are rounded up to,
+        by argument name: a list of values, or a function of the value such
+        as :code:`triton.next_power_of_2`. A kernel whose constexpr follows a
+        dynamic shape, e.g. the bound of a loop over a sequence, then compiles
+        once per bucket and masks the elements past the runtime size. The
+        grid function sees the rounded values.
+    :type buckets: dict, optional
+    :param auto_num_warps: treat :code:`num_warps` as an upper bound and
+        launch the kernels whose tensors are smaller than the warps, e.g.
+        small bias adds and the per-row scalars of decoding, with the warps
+        that own their elements instead of replicating the elements in every
+        warp. The chosen count is in the :code:`num_warps` of the compiled
+        kernel. Defaults to the :code:`TRITON_AUTO_NUM_WARPS` environment
+        variable.
+    :type auto_num_warps: bool, optional
     """
 
     def decorator(fn: T) -> JITFunction[T]:
@@ -471,6 +665,13 @@ def jit(
                 do_not_specialize=do_not_specialize,
                 debug=debug,
                 noinline=noinline,
+                fast_math=fast_math,
+                auto_num_stages=auto_num_stages,
+                maxnreg=maxnreg,
+                min_blocks_per_sm=min_blocks_per_sm,
+                async_compile=async_compile,
+                buckets=buckets,
+                auto_num_warps=auto_num_warps,
             )
     if fn is not None:
         return decorator(fn)
@@ -530,3 +731,48 @@ def reinterpret(tensor, dtype):
         return TensorWrapper(tensor, dtype)
     else:
         raise TypeError(f'Cannot reinterpret a {type(tensor)}.')
+
+
+class ParamTable:
+    """
+    A small read-only table passed by value in the parameters of the launch,
+    e.g. a quantization codebook or the scales of the heads, instead of a
+    pointer to the global memory:
+
+        scales = triton.ParamTable(torch.tensor([...], dtype=torch.float32))
+        kernel[grid](x, scales, ...)
+
+    The kernel indexes it like a pointer, ``tl.load(scales + offsets)``,
+    without masks. The table is specialized on its type and number of
+    elements, and is read through the constant cache.
+
+    :param values: the elements of the table, a tensor on any device.
+    :param dtype: the type the bytes of the table are reinterpreted as, e.g.
+        :code:`tl.float8e4` (optional).
+    """
+
+    # the parameters of a launch are limited to 4KB, shared with the other
+    # arguments of the kernel
+    MAX_BYTES = 2048
+
+    def __init__(self, values, dtype=None):
+        import torch
+        values = values.detach().reshape(-1).contiguous().cpu()
+        if dtype is None:
+            dtype, elem_bytes = values.dtype, values.element_size()
+        else:
+            elem_bytes = dtype.primitive_bitwidth // 8
+        ty = JITFunction._type_of(dtype)[1:]
+        if ty == "i1":
+            raise TypeError("Parameter tables of booleans are not supported, use int8")
+        # the bytes of the table, which the launcher passes to the driver
+        self.data = values.view(torch.uint8).numpy().tobytes()
+        if len(self.data) % elem_bytes != 0:
+            raise ValueError(f"A table of {len(self.data)} bytes is not made of {ty} elements")
+        if not 0 < len(self.data) <= ParamTable.MAX_BYTES:
+            raise ValueError(f"Parameter tables hold 1 to {ParamTable.MAX_BYTES} bytes, got {len(self.data)}")
+        self.numel = len(self.data) // elem_bytes
+        self.param_type = f"[{self.numel}x{ty}]"
+
+    def __str__(self) -> str:
+        return f'ParamTable[{self.param_type}]'
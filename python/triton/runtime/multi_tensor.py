@@ -0,0 +1,82 @@
+from __future__ import annotations
+
+
+class TensorList:
+    """
+    A list of tensors split into chunks, passed to a kernel as a single pointer
+    argument so that one launch processes all the tensors, e.g. the parameters
+    of an optimizer step ("multi_tensor_apply").
+
+    The list is a device buffer of the address and the number of elements of
+    every chunk, packed on the host in pinned memory and copied to the device
+    asynchronously. Programs map to chunks with
+    :code:`tl.multi_tensor_chunk`, and the lists of the same shapes and chunk
+    size map to the same chunks:
+
+    .. highlight:: python
+    .. code-block:: python
+
+        @triton.jit
+        def sgd_kernel(PARAMS, GRADS, lr, BLOCK: tl.constexpr):
+            chunk = tl.program_id(0)
+            p, n = tl.multi_tensor_chunk(PARAMS, chunk, tl.float32)
+            g, _ = tl.multi_tensor_chunk(GRADS, chunk, tl.float32)
+            for start in range(0, n, BLOCK):
+                offs = start + tl.arange(0, BLOCK)
+                mask = offs < n
+                tl.store(p + offs, tl.load(p + offs, mask=mask) - lr * tl.load(g + offs, mask=mask), mask=mask)
+
+        params, grads = TensorList(params, chunk_size), TensorList(grads, chunk_size)
+        sgd_kernel[params.grid](params, grads, lr, BLOCK=1024)
+
+    :param tensors: the contiguous tensors of the list, on the same device
+    :param chunk_size: the elements per chunk, a multiple of 16 so that the
+        chunks keep the alignment of the tensors
+    :note: the list holds references to its tensors, which must not be resized
+        while the list is in use
+    """
+
+    def __init__(self, tensors, chunk_size=65536):
+        import torch
+        assert len(tensors) > 0, "the list must hold at least one tensor"
+        assert 0 < chunk_size < 2**31 and chunk_size % 16 == 0, "the chunk size must be a positive multiple of 16"
+        device = tensors[0].device
+        entries = []
+        for tensor in tensors:
+            assert tensor.device == device, "the tensors must be on the same device"
+            assert tensor.is_contiguous(), "the tensors must be contiguous"
+            numel = tensor.numel()
+            for offset in range(0, numel, chunk_size):
+                entries += [tensor.data_ptr() + offset * tensor.element_size(), min(chunk_size, numel - offset)]
+        self.tensors = list(tensors)
+        self.chunk_size = chunk_size
+        self.numels = [tensor.numel() for tensor in tensors]
+        # the pinned buffer stays alive until the asynchronous copy is done
+        self._host = torch.tensor(entries, dtype=torch.int64).pin_memory()
+        self._buffer = self._host.to(device, non_blocking=True)
+
+    @property
+    def num_chunks(self):
+        return self._buffer.numel() // 2
+
+    @property
+    def grid(self):
+        """The grid with one program per chunk."""
+        return (self.num_chunks,)
+
+    # the kernels see the list as a pointer to int64
+    @property
+    def dtype(self):
+        return self._buffer.dtype
+
+    def data_ptr(self):
+        return self._buffer.data_ptr()
+
+    def __len__(self):
+        return len(self.tensors)
+
+    def __getitem__(self, index):
+        return self.tensors[index]
+
+    def __repr__(self):
+        return f"TensorList({len(self.tensors)} tensors, {self.num_chunks} chunks of {self.chunk_size})"
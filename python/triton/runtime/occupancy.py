@@ -0,0 +1,64 @@
+from __future__ import annotations
+
+from .driver import driver
+
+# The registers of a warp are allocated in units of 256, i.e. the registers
+# per thread are rounded up to a multiple of 8
+_REG_ALLOC_UNIT = 256
+_MAX_REGS_PER_THREAD = 255
+_WARP_SIZE = 32
+
+
+def _get_properties(device, properties):
+    if properties is not None:
+        return properties
+    if device is None:
+        from .jit import get_current_device
+        device = get_current_device()
+    return driver.utils.get_device_properties(device)
+
+
+def occupancy(n_regs, shared, num_warps, device=None, properties=None):
+    """
+    Computes the number of programs of a kernel that can be resident on a
+    multiprocessor, from the registers per thread and shared memory per
+    program of the kernel (e.g. the :code:`n_regs` and :code:`shared` of a
+    compiled kernel) and the limits of the device.
+
+    :param n_regs: the registers per thread
+    :param shared: the bytes of shared memory per program
+    :param num_warps: the warps per program
+    :param device: the device, the current one by default
+    :param properties: the properties of the device, as returned by
+        :code:`driver.utils.get_device_properties`, in place of :code:`device`
+    :return: a dict with the resident :code:`blocks` and :code:`warps`, the
+        :code:`occupancy` as the fraction of the warps that the multiprocessor
+        can hold, and the resource that bounds them, the :code:`limiter`
+    """
+    props = _get_properties(device, properties)
+    max_warps = props["max_threads_per_sm"] // _WARP_SIZE
+    limits = {"warps": max_warps // num_warps, "blocks": props["max_blocks_per_sm"]}
+    if n_regs > 0:
+        regs_per_warp = -(-n_regs * _WARP_SIZE // _REG_ALLOC_UNIT) * _REG_ALLOC_UNIT
+        limits["registers"] = props["max_regs_per_sm"] // regs_per_warp // num_warps
+    if shared > 0:
+        limits["shared memory"] = props["max_shared_mem_per_sm"] // (shared + props["reserved_shared_mem"])
+    limiter = min(limits, key=limits.get)
+    blocks = limits[limiter]
+    return {"blocks": blocks, "warps": blocks * num_warps,
+            "occupancy": blocks * num_warps / max_warps, "limiter": limiter}
+
+
+def max_regs_for_occupancy(num_warps, blocks, device=None, properties=None):
+    """
+    Returns the largest number of registers per thread with which
+    :code:`blocks` programs of :code:`num_warps` warps fit on a
+    multiprocessor, e.g. the :code:`maxnreg` of :code:`triton.jit` that
+    trades registers for occupancy. Returns 0 if the programs don't fit.
+    """
+    props = _get_properties(device, properties)
+    if blocks * num_warps * _WARP_SIZE > props["max_threads_per_sm"] or blocks > props["max_blocks_per_sm"]:
+        return 0
+    regs_per_warp = props["max_regs_per_sm"] // (blocks * num_warps)
+    regs_per_warp -= regs_per_warp % _REG_ALLOC_UNIT
+    return min(regs_per_warp // _WARP_SIZE, _MAX_REGS_PER_THREAD)
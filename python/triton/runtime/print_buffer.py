@@ -0,0 +1,148 @@
+"""
+The buffer that :code:`tl.device_print` writes to in the kernels compiled with
+:code:`TRITON_PRINT_BUFFER=1`: instead of calling :code:`vprintf`, which
+serializes the warps, each thread appends a binary record of its program id,
+thread id and values to a buffer of the device, where each warp allocates its
+records with one atomic. The records are decoded on the host once the kernels
+are done:
+
+.. highlight:: python
+.. code-block:: python
+
+    kernel[grid](...)  # compiled with TRITON_PRINT_BUFFER=1
+    for record in triton.runtime.print_buffer.drain():
+        print(record)
+
+The buffer of a device holds :code:`TRITON_PRINT_BUFFER_BYTES` bytes, 16MB by
+default. The records that do not fit are dropped, and counted by
+:code:`dropped_words`, until the next :code:`drain`.
+"""
+
+import os
+import struct
+from collections import namedtuple
+
+# The words of the buffer before the records: the cursor and the capacity
+_HEADER_WORDS = 2
+# The words of a record before the values: the format id, the program id and
+# the thread id
+_RECORD_HEADER_WORDS = 5
+_KIND_WORDS = {"i32": 1, "f32": 1, "i64": 2, "f64": 2, "ptr": 2}
+
+# The formats of the records of the kernels loaded by this process:
+# format id -> (prefix, [(kind, values per thread) of each operand])
+_formats = dict()
+# The print buffer of each device
+_buffers = dict()
+
+
+def enabled():
+    """Whether the kernels are compiled to write to the print buffer, with
+    :code:`TRITON_PRINT_BUFFER` set to 1, true or on."""
+    return os.environ.get("TRITON_PRINT_BUFFER", "").lower() in ("1", "true", "on")
+
+
+class PrintRecord(namedtuple("PrintRecord", ["pid", "tid", "prefix", "values"])):
+    """A :code:`tl.device_print` of a thread."""
+
+    def __str__(self):
+        values = ", ".join(f"{v:f}" if isinstance(v, float) else str(v) for v in self.values)
+        return f"pid ({self.pid[0]}, {self.pid[1]}, {self.pid[2]}) tid {self.tid}{self.prefix}{values}"
+
+
+def _decode_value(kind, words):
+    if kind == "i32":
+        return struct.unpack("<i", struct.pack("<I", words[0]))[0]
+    if kind == "f32":
+        return struct.unpack("<f", struct.pack("<I", words[0]))[0]
+    raw = struct.pack("<II", words[0], words[1])
+    if kind == "i64":
+        return struct.unpack("<q", raw)[0]
+    if kind == "f64":
+        return struct.unpack("<d", raw)[0]
+    return hex(struct.unpack("<Q", raw)[0])
+
+
+class PrintBuffer:
+    """
+    The print buffer of a device.
+
+    :param num_bytes: the bytes of the buffer, including an 8-byte header
+    :param device: the index of the device
+    """
+
+    def __init__(self, num_bytes, device):
+        import torch
+        self.device = device
+        self.words = torch.zeros(num_bytes // 4, dtype=torch.int32, device=f"cuda:{device}")
+        self.capacity = self.words.numel() - _HEADER_WORDS
+        self.words[1] = self.capacity
+        self.dropped_words = 0
+
+    def data_ptr(self):
+        return self.words.data_ptr()
+
+    def drain(self):
+        """
+        Waits for the kernels of the device, and returns the records they
+        appended since the last drain, in the order of their allocation.
+        """
+        import torch
+        torch.cuda.synchronize(self.device)
+        words = self.words.cpu().numpy().view("uint32").tolist()
+        cursor = words[0]
+        used = min(cursor, self.capacity)
+        self.dropped_words += cursor - used
+        records = []
+        pos, end = _HEADER_WORDS, _HEADER_WORDS + used
+        while pos + _RECORD_HEADER_WORDS <= end:
+            format_id, x, y, z, tid = words[pos:pos + _RECORD_HEADER_WORDS]
+            # the end of the records written before the buffer was full
+            if format_id not in _formats:
+                break
+            pos += _RECORD_HEADER_WORDS
+            prefix, operands = _formats[format_id]
+            values = []
+            for kind, count in operands:
+                num_words = _KIND_WORDS[kind]
+                for _ in range(count):
+                    values.append(_decode_value(kind, words[pos:pos + num_words]))
+                    pos += num_words
+            records.append(PrintRecord((x, y, z), tid, prefix, values))
+        self.words[:end].zero_()
+        self.words[1] = self.capacity
+        return records
+
+
+def get_print_buffer(device):
+    """Returns the print buffer of a device, allocated on first use."""
+    if device not in _buffers:
+        num_bytes = int(os.environ.get("TRITON_PRINT_BUFFER_BYTES", 1 << 24))
+        _buffers[device] = PrintBuffer(num_bytes, device)
+    return _buffers[device]
+
+
+def attach(module, formats, device):
+    """
+    Points the kernels of a module loaded on a device to the print buffer of
+    the device, and registers the formats of their records.
+    """
+    from .driver import driver
+    for format_id, format in formats:
+        kinds, prefix = format.split("|", 1)
+        operands = []
+        for operand in kinds.split(",") if kinds else []:
+            kind, count = operand.split("x")
+            operands.append((kind, int(count)))
+        _formats[format_id] = (prefix, operands)
+    driver.utils.set_module_global(module, "triton_print_buffer", get_print_buffer(device).data_ptr(), device)
+
+
+def drain(device=None):
+    """Returns the records of the kernels of a device, the current one by default."""
+    from .jit import get_current_device
+    if device is None:
+        device = get_current_device()
+    if device not in _buffers:
+        return []
+    return _buffers[device].drain()
@@ -1,7 +1,10 @@
 import functools
+import math
 import os
 import subprocess
 import sys
+import warnings
+from collections import namedtuple
 from contextlib import contextmanager
 
 import triton._C.libtriton.triton as _triton
@@ -91,6 +94,154 @@ def do_bench(fn, warmup=25, rep=100, grad_to_none=None,
     return getattr(torch, return_mode)(times).item()
 
 
+# The two-sided 95% quantiles of the Student t distribution by degrees of
+# freedom; the normal quantile is used past 30
+_T_95 = [12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+         2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+         2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042]
+
+
+class BenchStats(namedtuple("BenchStats", ["mean", "median", "std", "ci_low", "ci_high", "num_samples",
+                                           "clocks_stable"])):
+    """
+    The statistics of the runtimes of a benchmark, in ms: the :code:`mean`,
+    :code:`median` and standard deviation of the samples, and the 95%
+    confidence interval :code:`[ci_low, ci_high]` of the mean.
+    :code:`clocks_stable` is False if the SM clock changed during the
+    measurement, and None if the clocks can't be queried.
+    """
+
+    def as_tuple(self):
+        """Returns (mean, ci_low, ci_high), the values that :code:`perf_report` plots."""
+        return self.mean, self.ci_low, self.ci_high
+
+
+def get_bench_stats(times, clocks_stable=None):
+    """Returns the :code:`BenchStats` of a list of runtimes."""
+    import statistics
+    n = len(times)
+    mean = statistics.fmean(times)
+    std = statistics.stdev(times) if n > 1 else 0.
+    t = _T_95[n - 2] if 1 < n <= len(_T_95) + 1 else 1.960
+    half_width = t * std / math.sqrt(n)
+    return BenchStats(mean, statistics.median(times), std, mean - half_width, mean + half_width, n,
+                      clocks_stable)
+
+
+def get_sm_clock():
+    """Returns the current SM clock of the GPU in MHz, or None without :code:`nvidia-smi`."""
+    try:
+        return nvsmi(["clocks.current.sm"])[0]
+    except (OSError, subprocess.CalledProcessError, ValueError):
+        return None
+
+
+def do_bench_cudagraph(fn, rep=20, num_samples=20, grad_to_none=None, quantiles=None, return_mode="mean"):
+    """
+    Benchmark the runtime of the provided function with CUDA graphs: the
+    launches of :code:`fn` are captured back-to-back into a graph that runs for
+    about :code:`rep` ms, so that the CPU overhead of the launches and the
+    jitter of the launch queue don't show in the runtimes of short kernels.
+    The graph is replayed :code:`num_samples` times, and every sample is the
+    time of one replay divided by the launches in the graph. The L2 cache is
+    not flushed between the launches, so this measures the warm runtime.
+
+    :param fn: Function to benchmark, without host synchronization
+    :type fn: Callable
+    :param rep: Time of a replay of the graph (in ms)
+    :type rep: int
+    :param num_samples: Number of replays of the graph
+    :type num_samples: int
+    :param grad_to_none: Reset the gradient of the provided tensor to None
+    :type grad_to_none: torch.tensor, optional
+    :param quantiles: Performance percentile of the samples to return
+    :type quantiles: list[float]
+    :param return_mode: The statistic of the samples to return, or
+        :code:`"stats"` for their :code:`BenchStats`
+    :type return_mode: str
+    """
+    import torch
+    assert return_mode in ["min", "max", "mean", "median", "stats"]
+    assert num_samples > 0
+
+    def run():
+        # the gradients are reset at capture time, not at replay time
+        if grad_to_none is not None:
+            for x in grad_to_none:
+                x.grad = None
+        fn()
+
+    # captures run on a side stream
+    with torch.cuda.stream(torch.cuda.Stream()):
+        # the compilation and the autotuning must happen before the capture
+        run()
+        torch.cuda.synchronize()
+        # Estimate the runtime of the function
+        graph = torch.cuda.CUDAGraph()
+        with torch.cuda.graph(graph):
+            run()
+        torch.cuda.synchronize()
+        start_event = torch.cuda.Event(enable_timing=True)
+        end_event = torch.cuda.Event(enable_timing=True)
+        start_event.record()
+        for _ in range(5):
+            graph.replay()
+        end_event.record()
+        torch.cuda.synchronize()
+        estimate_ms = start_event.elapsed_time(end_event) / 5
+        n_repeat = max(1, int(rep / estimate_ms))
+        # Capture `n_repeat` back-to-back launches
+        graph = torch.cuda.CUDAGraph()
+        with torch.cuda.graph(graph):
+            for _ in range(n_repeat):
+                run()
+        torch.cuda.synchronize()
+        # Warm-up
+        graph.replay()
+        sm_clock = get_sm_clock()
+        start_event = [torch.cuda.Event(enable_timing=True) for i in range(num_samples)]
+        end_event = [torch.cuda.Event(enable_timing=True) for i in range(num_samples)]
+        for i in range(num_samples):
+            start_event[i].record()
+            graph.replay()
+            end_event[i].record()
+        torch.cuda.synchronize()
+    end_sm_clock = get_sm_clock()
+    times = [s.elapsed_time(e) / n_repeat for s, e in zip(start_event, end_event)]
+    clocks_stable = None if sm_clock is None or end_sm_clock is None else sm_clock == end_sm_clock
+    if clocks_stable is False:
+        warnings.warn(f"the SM clock changed from {sm_clock} to {end_sm_clock} MHz during the benchmark, "
+                      "the runtimes are noisy; lock the clocks with `set_gpu_clock`")
+    if return_mode == "stats":
+        return get_bench_stats(times, clocks_stable)
+    times = torch.tensor(times)
+    if quantiles is not None:
+        ret = torch.quantile(times, torch.tensor(quantiles)).tolist()
+        if len(ret) == 1:
+            ret = ret[0]
+        return ret
+    return getattr(torch, return_mode)(times).item()
+
+
+def get_utilization(ms, flops=None, num_bytes=None, dtype=None, device=None):
+    """
+    Returns the achieved throughputs of a kernel that runs in :code:`ms` and
+    their fraction of the peak of the device: :code:`tflops` and
+    :code:`tflops_util` against :code:`get_max_tensorcore_tflops(dtype)` for
+    the given :code:`flops`, and :code:`gbps` and :code:`dram_util` against
+    :code:`get_dram_gbps()` for the given :code:`num_bytes` read and written.
+    """
+    ret = {}
+    if flops is not None:
+        ret["tflops"] = flops * 1e-12 / (ms * 1e-3)
+        if dtype is not None:
+            ret["tflops_util"] = ret["tflops"] / get_max_tensorcore_tflops(dtype, device=device)
+    if num_bytes is not None:
+        ret["gbps"] = num_bytes * 1e-9 / (ms * 1e-3)
+        ret["dram_util"] = ret["gbps"] / get_dram_gbps(device=device)
+    return ret
+
+
 def assert_close(x, y, atol=None, rtol=None, err_msg=''):
     import numpy as np
     import torch
@@ -148,6 +299,7 @@ class Benchmark:
         y_log=False,
         color=None,
         styles=None,
+        instruction_mix=None,
     ):
         """
         Constructor
@@ -174,6 +326,11 @@ class Benchmark:
         :type x_log: bool, optional
         :param y_log: Whether the y axis should be log scale.
         :type y_log: bool, optional
+        :param instruction_mix: Statistics of the SASS instruction mix of the kernels launched by each run to add to
+            the data as :code:`<line name>-<statistic>` columns, e.g. :code:`["mma", "ldg", "predicated_load_ratio"]`.
+            The statistics are the keys of :code:`InstructionMix.as_dict`. Recording the kernels adds a Python call to
+            every launch.
+        :type instruction_mix: List[str], optional
         """
         self.x_names = x_names
         self.x_vals = x_vals
@@ -188,6 +345,49 @@ class Benchmark:
         self.ylabel = ylabel
         self.plot_name = plot_name
         self.args = args
+        self.instruction_mix = instruction_mix or []
+
+
+@contextmanager
+def record_kernels():
+    """
+    Records the compiled kernels launched within the context, in the order of
+    their first launch.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        with triton.testing.record_kernels() as kernels:
+            fn()
+        mix = triton.testing.get_instruction_mix(kernels)
+    """
+    from .compiler import CompiledKernel
+    kernels = []
+    seen = set()
+    enter_hook = CompiledKernel.launch_enter_hook
+
+    def hook(*args):
+        # The launchers pass the compiled kernel after the hooks
+        kernel = args[9]
+        if id(kernel) not in seen:
+            seen.add(id(kernel))
+            kernels.append(kernel)
+        if enter_hook is not None:
+            enter_hook(*args)
+    CompiledKernel.launch_enter_hook = hook
+    try:
+        yield kernels
+    finally:
+        CompiledKernel.launch_enter_hook = enter_hook
+
+
+def get_instruction_mix(kernels):
+    """
+    Returns the :code:`InstructionMix` of the SASS of the given compiled
+    kernels, summed over the kernels.
+    """
+    from .tools.instruction_mix import InstructionMix
+    return sum((kernel.get_instruction_mix() for kernel in kernels), InstructionMix())
 
 
 class Mark:
@@ -203,12 +403,22 @@ class Mark:
         y_mean = bench.line_names
         y_min = [f'{x}-min' for x in bench.line_names]
         y_max = [f'{x}-max' for x in bench.line_names]
-        df = pd.DataFrame(columns=[bench.x_names[0]] + y_mean + y_min + y_max)
+        y_mix = [f'{x}-{stat}' for x in bench.line_names for stat in bench.instruction_mix]
+        df = pd.DataFrame(columns=[bench.x_names[0]] + y_mean + y_min + y_max + y_mix)
         for x in bench.x_vals:
             x_args = {x_name: x for x_name in bench.x_names}
-            row_mean, row_min, row_max = [], [], []
+            row_mean, row_min, row_max, row_mix = [], [], [], []
             for y in bench.line_vals:
-                ret = self.fn(**x_args, **{bench.line_arg: y}, **bench.args)
+                if bench.instruction_mix:
+                    with record_kernels() as kernels:
+                        ret = self.fn(**x_args, **{bench.line_arg: y}, **bench.args)
+                    mix = get_instruction_mix(kernels).as_dict()
+                    row_mix += [mix[stat] for stat in bench.instruction_mix]
+                else:
+                    ret = self.fn(**x_args, **{bench.line_arg: y}, **bench.args)
+                # the confidence interval of the mean is the error band
+                if isinstance(ret, BenchStats):
+                    ret = ret.as_tuple()
                 try:
                     y_mean, y_min, y_max = ret
                 except TypeError:
@@ -216,7 +426,7 @@ class Mark:
                 row_mean += [y_mean]
                 row_min += [y_min]
                 row_max += [y_max]
-            df.loc[len(df)] = [x] + row_mean + row_min + row_max
+            df.loc[len(df)] = [x] + row_mean + row_min + row_max + row_mix
         if bench.plot_name:
             plt.figure()
             ax = plt.subplot()
@@ -239,7 +449,7 @@ class Mark:
                 plt.show()
             if save_path:
                 plt.savefig(os.path.join(save_path, f"{bench.plot_name}.png"))
-        df = df[[bench.x_names[0]] + bench.line_names]
+        df = df[[bench.x_names[0]] + bench.line_names + y_mix]
         if print_data:
             print(bench.plot_name + ':')
             print(df)
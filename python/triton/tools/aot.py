@@ -1,9 +1,320 @@
 import argparse
+import itertools
+import os
+import re
 import sys
+from concurrent.futures import ThreadPoolExecutor
+from typing import Dict, List, Optional, Union
 
+import triton
 import triton._C.libtriton.triton as libtriton
 import triton.compiler.compiler as tc
 
+# ----- kernel library --------
+
+
+class AOTKernel:
+    """
+    A :code:`@triton.jit` kernel to compile ahead of time, together with the
+    grid of configurations to compile it for.
+
+    :param fn: the kernel
+    :param signature: types of the regular (non-constexpr) arguments, in order,
+        e.g. :code:`"*fp32, *fp32, i32"`, or a dict from argument name to type
+    :param constants: values of the constexpr arguments. A list of values
+        compiles one configuration per value.
+    :param num_warps: values of :code:`num_warps` to compile for
+    :param num_stages: values of :code:`num_stages` to compile for
+    :param specialize: regular arguments compiled both for values divisible
+        by 16 and for other values; the launcher picks the variant from the
+        argument values. Defaults to the pointer arguments.
+    :param name: prefix of the generated launchers, defaults to the kernel name
+    """
+
+    def __init__(self, fn, signature: Union[str, Dict[str, str]], constants: Optional[Dict[str, object]] = None,
+                 num_warps: List[int] = (4,), num_stages: List[int] = (3,), specialize: Optional[List[str]] = None,
+                 name: Optional[str] = None):
+        self.fn = fn
+        self.name = fn.__name__ if name is None else name
+        constants = dict() if constants is None else constants
+        arg_names = fn.arg_names
+        self.regular_args = [arg for i, arg in enumerate(arg_names) if i not in fn.constexprs]
+        constexpr_args = [arg for i, arg in enumerate(arg_names) if i in fn.constexprs]
+        if isinstance(signature, str):
+            types = [ty.strip() for ty in signature.split(",")]
+            if len(types) != len(self.regular_args):
+                raise ValueError(f"{self.name}: expected {len(self.regular_args)} types, got {len(types)}")
+            signature = dict(zip(self.regular_args, types))
+        if set(signature) != set(self.regular_args):
+            raise ValueError(f"{self.name}: the signature must give the types of {self.regular_args}")
+        if set(constants) != set(constexpr_args):
+            raise ValueError(f"{self.name}: the constants must give the values of {constexpr_args}")
+        self.signature = {arg_names.index(arg): signature[arg] for arg in self.regular_args}
+        self.constants = {arg: values if isinstance(values, (list, tuple)) else [values]
+                          for arg, values in constants.items()}
+        self.num_warps = list(num_warps)
+        self.num_stages = list(num_stages)
+        if specialize is None:
+            specialize = [arg for arg in self.regular_args if signature[arg][0] == '*']
+        for arg in specialize:
+            if arg not in signature or signature[arg][0] not in "*iu":
+                raise ValueError(f"{self.name}: only pointer and integer arguments can be specialized, got {arg}")
+        self.specialize = [arg_names.index(arg) for arg in specialize]
+
+    def configs(self):
+        names = list(self.constants)
+        for values in itertools.product(*self.constants.values(), self.num_warps, self.num_stages):
+            yield dict(zip(names, values[:-2])), values[-2], values[-1]
+
+    def variants(self):
+        # variant `key` is divisible by 16 at the arguments selected by the
+        # bits of `key`, which is what the launchers compute at runtime
+        for key in range(1 << len(self.specialize)):
+            yield {idx for j, idx in enumerate(self.specialize) if key >> j & 1}
+
+
+_BACKENDS = {
+    "cuda": {
+        "include": "#include <cuda.h>",
+        "result": "CUresult", "success": "CUDA_SUCCESS", "not_initialized": "CUDA_ERROR_NOT_INITIALIZED",
+        "stream": "CUstream", "module": "CUmodule", "function": "CUfunction", "ptr": "CUdeviceptr",
+        "load": "cuModuleLoadData", "get_function": "cuModuleGetFunction", "unload": "cuModuleUnload",
+        "launch": "cuLaunchKernel", "warp_size": 32,
+    },
+    "hip": {
+        "include": "#define __HIP_PLATFORM_AMD__\n#include <hip/hip_runtime.h>",
+        "result": "hipError_t", "success": "hipSuccess", "not_initialized": "hipErrorNotInitialized",
+        "stream": "hipStream_t", "module": "hipModule_t", "function": "hipFunction_t", "ptr": "hipDeviceptr_t",
+        "load": "hipModuleLoadData", "get_function": "hipModuleGetFunction", "unload": "hipModuleUnload",
+        "launch": "hipModuleLaunchKernel", "warp_size": 64,
+    },
+}
+
+
+def _ty_to_c(ty, b):
+    if ty[0] == '*':
+        return b["ptr"]
+    return {
+        "i1": "int32_t",
+        "i8": "int8_t",
+        "i16": "int16_t",
+        "i32": "int32_t",
+        "i64": "int64_t",
+        "u32": "uint32_t",
+        "u64": "uint64_t",
+        "fp16": "float",
+        "bf16": "float",
+        "fp32": "float",
+        "f32": "float",
+        "fp64": "double",
+    }[ty]
+
+
+def _c_identifier(s):
+    return re.sub(r"\W", "_", str(s))
+
+
+def _launcher_name(kernel, constants, num_warps, num_stages):
+    suffix = "".join(f"_{arg}{_c_identifier(int(v) if isinstance(v, bool) else v)}" for arg, v in constants.items())
+    return f"{kernel.name}{suffix}_w{num_warps}_s{num_stages}"
+
+
+def _image_of(compiled, backend):
+    if backend == "cuda":
+        return compiled.asm["cubin"]
+    return compiled.asm["hsaco"]
+
+
+def _generate_header(lib, launchers, b):
+    guard = f"TRITON_{lib.upper()}_H"
+    decls = []
+    for fname, kernel, constants, num_warps, num_stages in launchers:
+        params = ", ".join(f"{_ty_to_c(kernel.signature[i], b)} {kernel.fn.arg_names[i]}"
+                           for i in kernel.signature)
+        config = ", ".join([f"{arg}={v}" for arg, v in constants.items()] +
+                           [f"num_warps={num_warps}", f"num_stages={num_stages}"])
+        decls.append(f"// {kernel.fn.__name__} with {config}\n"
+                     f"{b['result']} {fname}({b['stream']} stream, unsigned int gridX, unsigned int gridY,\n"
+                     f"    unsigned int gridZ{', ' if params else ''}{params});")
+    decls = "\n\n".join(decls)
+    return f"""#ifndef {guard}
+#define {guard}
+
+{b['include']}
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {{
+#endif
+
+// Loads every kernel of the library into the current context. The launchers
+// fail with "not initialized" until it succeeds.
+{b['result']} {lib}_load(void);
+
+// Unloads the kernels loaded by {lib}_load.
+void {lib}_unload(void);
+
+{decls}
+
+#ifdef __cplusplus
+}}
+#endif
+
+#endif // {guard}
+"""
+
+
+def _generate_source(lib, launchers, variants, b):
+    images = []
+    for i, (_, _, _, image) in enumerate(variants):
+        data = ",".join(f"0x{byte:02x}" for byte in image)
+        data = "\n  ".join(data[k:k + 100] for k in range(0, len(data), 100))
+        images.append(f"static const unsigned char {lib}_image_{i}[] = {{\n  {data}}};")
+    images = "\n\n".join(images)
+    table = ",\n".join(f"    {{{lib}_image_{i}, \"{name}\", {shared}, {num_warps}, NULL, NULL}}"
+                        for i, (name, shared, num_warps, _) in enumerate(variants))
+    # CUDA functions need an opt-in to use more than 48KB of shared memory
+    set_shared = ""
+    if b is _BACKENDS["cuda"]:
+        set_shared = f"""
+  if (v->shared > 49152) {{
+    result = cuFuncSetAttribute(v->function,
+                                CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES,
+                                v->shared);
+    if (result != {b['success']})
+      return result;
+  }}"""
+    defs = []
+    first = 0
+    for fname, kernel, _, _, _ in launchers:
+        arg_names = kernel.fn.arg_names
+        params = ", ".join(f"{_ty_to_c(kernel.signature[i], b)} {arg_names[i]}" for i in kernel.signature)
+        keys = "".join(f"\n  key |= (unsigned int)((uintptr_t){arg_names[idx]} % 16 == 0) << {j};"
+                       for j, idx in enumerate(kernel.specialize))
+        args = ", ".join(f"&{arg_names[i]}" for i in kernel.signature)
+        defs.append(f"""{b['result']} {fname}({b['stream']} stream, unsigned int gridX, unsigned int gridY,
+    unsigned int gridZ{', ' if params else ''}{params}) {{
+  unsigned int key = 0;{keys}
+  const {lib}_variant_t *v = &{lib}_variants[{first} + key];
+  if (v->function == NULL)
+    return {b['not_initialized']};
+  if (gridX * gridY * gridZ == 0)
+    return {b['success']};
+  void *params[] = {{{args}}};
+  return {b['launch']}(v->function, gridX, gridY, gridZ, {b['warp_size']} * v->num_warps, 1, 1,
+      v->shared, stream, params, NULL);
+}}""")
+        first += 1 << len(kernel.specialize)
+    defs = "\n\n".join(defs)
+    return f"""// Generated by triton.tools.aot -- do not edit.
+#include "{lib}.h"
+
+#include <stddef.h>
+
+typedef struct {{
+  const unsigned char *image;
+  const char *name;
+  unsigned int shared;
+  unsigned int num_warps;
+  {b['module']} module;
+  {b['function']} function;
+}} {lib}_variant_t;
+
+{images}
+
+static {lib}_variant_t {lib}_variants[] = {{
+{table}}};
+
+static const size_t {lib}_num_variants =
+    sizeof({lib}_variants) / sizeof({lib}_variants[0]);
+
+static {b['result']} {lib}_load_variant({lib}_variant_t *v) {{
+  {b['result']} result = {b['load']}(&v->module, v->image);
+  if (result != {b['success']})
+    return result;
+  result = {b['get_function']}(&v->function, v->module, v->name);
+  if (result != {b['success']})
+    return result;{set_shared}
+  return {b['success']};
+}}
+
+{b['result']} {lib}_load(void) {{
+  for (size_t i = 0; i < {lib}_num_variants; ++i) {{
+    {b['result']} result = {lib}_load_variant(&{lib}_variants[i]);
+    if (result != {b['success']}) {{
+      {lib}_unload();
+      return result;
+    }}
+  }}
+  return {b['success']};
+}}
+
+void {lib}_unload(void) {{
+  for (size_t i = 0; i < {lib}_num_variants; ++i) {{
+    {lib}_variant_t *v = &{lib}_variants[i];
+    if (v->module != NULL)
+      {b['unload']}(v->module);
+    v->module = NULL;
+    v->function = NULL;
+  }}
+}}
+
+{defs}
+"""
+
+
+def build_library(name: str, kernels: List[AOTKernel], out_dir: str, cc=None, max_workers: Optional[int] = None):
+    """
+    Compiles every configuration and specialization of :code:`kernels` and
+    writes a C library made of :code:`<name>.h` and :code:`<name>.c` to
+    :code:`out_dir`.
+
+    The source embeds all the binaries, so the library needs neither Python
+    nor a cache directory at runtime. The header declares one launcher per
+    kernel configuration, which picks the specialization from the values of
+    its arguments, and :code:`<name>_load`, which must be called once in the
+    context the kernels are launched in.
+
+    :param cc: target architecture, defaults to the current device
+    :param max_workers: number of kernels compiled concurrently
+    :return: the paths to the header and to the source
+    """
+    if not re.fullmatch(r"[A-Za-z_]\w*", name):
+        raise ValueError(f"library name {name} is not a C identifier")
+    arch = tc.get_architecture_descriptor(cc)
+    backend = "cuda" if tc._is_cuda(arch) else "hip"
+    launchers = []
+    jobs = []
+    for kernel in kernels:
+        for constants, num_warps, num_stages in kernel.configs():
+            fname = _launcher_name(kernel, constants, num_warps, num_stages)
+            launchers.append((fname, kernel, constants, num_warps, num_stages))
+            constexprs = {kernel.fn.arg_names.index(arg): v for arg, v in constants.items()}
+            for divisible_by_16 in kernel.variants():
+                config = tc.instance_descriptor(divisible_by_16=divisible_by_16, equal_to_1=set())
+                jobs.append(dict(fn=kernel.fn, signature=kernel.signature, constants=constexprs,
+                                 num_warps=num_warps, num_stages=num_stages, configs=[config], cc=arch))
+    names = [fname for fname, *_ in launchers]
+    if len(set(names)) != len(names):
+        raise ValueError("kernels with the same name must be given distinct names")
+
+    # the bulk of the compilation time is spent in ptxas, so concurrent
+    # compilations overlap even though the frontend holds the GIL
+    with ThreadPoolExecutor(max_workers=max_workers) as executor:
+        compiled = list(executor.map(lambda job: triton.compile(job.pop("fn"), **job), jobs))
+    variants = [(c.metadata["name"], c.shared, c.num_warps, _image_of(c, backend)) for c in compiled]
+
+    b = _BACKENDS[backend]
+    os.makedirs(out_dir, exist_ok=True)
+    header_path = os.path.join(out_dir, f"{name}.h")
+    source_path = os.path.join(out_dir, f"{name}.c")
+    with open(header_path, "w") as f:
+        f.write(_generate_header(name, launchers, b))
+    with open(source_path, "w") as f:
+        f.write(_generate_source(name, launchers, variants, b))
+    return header_path, source_path
+
+
 if __name__ == '__main__':
 
     # valid source and target formats
@@ -77,9 +388,8 @@ if __name__ == '__main__':
         # use compute_capability == 80
         module = tc.ttgir_to_llir(module, extern_libs=None, arch=80)
         # llvm-ir -> amdgcn asm, hsaco binary
-        module, hsaco_path = tc.llir_to_amdgcn_and_hsaco(module, arch_name, arch_triple, arch_features)
+        module, hsaco = tc.llir_to_amdgcn_and_hsaco(module, arch_name, arch_triple, arch_features)
 
-        print(hsaco_path)
         print(module)
         sys.exit(0)
 
@@ -109,6 +419,6 @@ if __name__ == '__main__':
     if args.target == 'amdgcn':
         if not args.gfx:
             raise argparse.ArgumentError(None, "Must specify --gfx for AMDGCN compilation")
-        module, hsaco_path = tc.llir_to_amdgcn_and_hsaco(module, args.gfx)
+        module, hsaco = tc.llir_to_amdgcn_and_hsaco(module, args.gfx)
 
     print(module)
@@ -0,0 +1,119 @@
+"""
+Compares two sets of benchmark results, e.g. the baselines of a device and
+the results of a new compiler commit, as written by
+:code:`python/test/regression/test_benchmarks.py`, and flags the benchmarks
+that are significantly slower.
+
+A benchmark regresses when its mean runtime is slower by more than the
+threshold and the difference is significant under Welch's t-test, so the
+noise of the measurements is not reported as a regression.
+
+.. highlight:: bash
+.. code-block:: bash
+
+    python -m triton.tools.compare_benchmarks baselines/a100.json results/a100.json
+"""
+
+import argparse
+import json
+import math
+import sys
+from statistics import NormalDist
+
+RESULTS_VERSION = 1
+
+
+def save(path, device, benchmarks, **info):
+    """
+    Writes the results of the benchmarks, a dict from benchmark name to dict
+    of the :code:`mean` and :code:`std` runtimes in ms and
+    :code:`num_samples`, along with the :code:`info` of the run (e.g. the
+    compiler commit).
+    """
+    with open(path, "w") as f:
+        json.dump({"version": RESULTS_VERSION, "device": device, **info,
+                   "benchmarks": benchmarks}, f, indent=2, sort_keys=True)
+
+
+def load(path):
+    with open(path) as f:
+        results = json.load(f)
+    if results.get("version") != RESULTS_VERSION:
+        raise ValueError(f"{path}: unsupported results version {results.get('version')}")
+    return results
+
+
+def _t_quantile(p, df):
+    # Cornish-Fisher expansion of the Student t quantile around the normal one
+    z = NormalDist().inv_cdf(p)
+    return z + (z ** 3 + z) / (4 * df) + (5 * z ** 5 + 16 * z ** 3 + 3 * z) / (96 * df ** 2)
+
+
+def welch_test(a, b, alpha):
+    """
+    Returns whether the means of the measurements :code:`a` and :code:`b`,
+    dicts of :code:`mean`, :code:`std` and :code:`num_samples`, differ
+    significantly at the level :code:`alpha`.
+    """
+    var_a = a["std"] ** 2 / a["num_samples"]
+    var_b = b["std"] ** 2 / b["num_samples"]
+    diff = b["mean"] - a["mean"]
+    if var_a + var_b == 0:
+        return diff != 0
+    t = diff / math.sqrt(var_a + var_b)
+    # the Welch-Satterthwaite degrees of freedom
+    num = (var_a + var_b) ** 2
+    den = sum(v ** 2 / (r["num_samples"] - 1) for v, r in ((var_a, a), (var_b, b)) if r["num_samples"] > 1)
+    df = max(num / den, 1.0) if den > 0 else 1.0
+    return abs(t) > _t_quantile(1 - alpha / 2, df)
+
+
+def compare(baseline, current, threshold=0.02, alpha=0.01):
+    """
+    Compares the benchmarks present in both results.
+
+    :param threshold: the relative slowdown below which a benchmark is not
+        flagged, however significant
+    :param alpha: the significance level of the test
+    :return: a list of dicts of the :code:`name`, the baseline and current
+        mean runtimes, their :code:`ratio` and the :code:`status` of each
+        benchmark: :code:`"regression"`, :code:`"improvement"` or
+        :code:`"unchanged"`
+    """
+    rows = []
+    for name in sorted(set(baseline["benchmarks"]) & set(current["benchmarks"])):
+        a, b = baseline["benchmarks"][name], current["benchmarks"][name]
+        ratio = b["mean"] / a["mean"]
+        status = "unchanged"
+        if abs(ratio - 1) > threshold and welch_test(a, b, alpha):
+            status = "regression" if ratio > 1 else "improvement"
+        rows.append({"name": name, "baseline": a["mean"], "current": b["mean"], "ratio": ratio,
+                     "status": status})
+    return rows
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description="Flags the benchmarks that regressed between two results")
+    parser.add_argument("baseline", help="the JSON results to compare against")
+    parser.add_argument("current", help="the JSON results of the new run")
+    parser.add_argument("--threshold", type=float, default=0.02,
+                        help="the relative slowdown below which a benchmark is not flagged")
+    parser.add_argument("--alpha", type=float, default=0.01, help="the significance level of the test")
+    args = parser.parse_args(argv)
+    baseline, current = load(args.baseline), load(args.current)
+    if baseline["device"] != current["device"]:
+        print(f"warning: comparing results of {baseline['device']} and {current['device']}", file=sys.stderr)
+    rows = compare(baseline, current, args.threshold, args.alpha)
+    width = max([len(row["name"]) for row in rows] + [9])
+    print(f"{'benchmark':<{width}}  {'baseline':>10}  {'current':>10}  {'ratio':>6}  status")
+    for row in rows:
+        print(f"{row['name']:<{width}}  {row['baseline']:>8.4f}ms  {row['current']:>8.4f}ms  "
+              f"{row['ratio']:>6.3f}  {row['status']}")
+    missing = sorted(set(baseline["benchmarks"]) - set(current["benchmarks"]))
+    if missing:
+        print(f"missing from the current results: {', '.join(missing)}", file=sys.stderr)
+    return 1 if any(row["status"] == "regression" for row in rows) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,148 @@
+"""
+Static analysis of the SASS of a kernel, as dumped by
+:code:`CompiledKernel.get_sass`: the instructions are counted by class, and
+the shared memory and global load instructions are summarized.
+"""
+
+import re
+from collections import Counter
+
+# An instruction is "[@[!]P] OPCODE[.MODIFIER]* OPERANDS ;"
+INSTR_RE = re.compile(r'^(?:@(!?)(U?P\w+)\s+)?([A-Z][A-Z0-9_]*)((?:\.\w+)*)\s*(.*?)\s*;$')
+
+# The classes of the opcodes, checked in order
+CLASSES = [
+    ("mma", re.compile(r'^(HMMA|IMMA|DMMA|BMMA|HGMMA|IGMMA|QGMMA|BGMMA)$')),
+    ("lds", re.compile(r'^(LDS|LDSM)$')),
+    ("sts", re.compile(r'^STS$')),
+    ("ldg", re.compile(r'^(LDG|LD)$')),
+    ("stg", re.compile(r'^(STG|ST)$')),
+    ("ldgsts", re.compile(r'^(LDGSTS|LDGDEPBAR|UTMALDG|UBLKCP)$')),
+    ("bar", re.compile(r'^(BAR|BSYNC|WARPSYNC|DEPBAR|MEMBAR|SYNCS)$')),
+    ("shfl", re.compile(r'^SHFL$')),
+    ("cvt", re.compile(r'^(F2F|F2FP|F2I|I2F|I2I|I2FP|FRND)$')),
+    ("atom", re.compile(r'^(ATOM|ATOMS|ATOMG|RED|REDUX)$')),
+    ("branch", re.compile(r'^(BRA|BRX|JMP|JMX|CALL|RET|EXIT|BSSY)$')),
+]
+
+# The bytes that the banks of shared memory serve per cycle
+SMEM_BYTES_PER_WAVEFRONT = 128
+WARP_SIZE = 32
+
+
+def _classify(opcode):
+    for name, pattern in CLASSES:
+        if pattern.match(opcode):
+            return name
+    return "other"
+
+
+def _access_bytes(opcode, modifiers):
+    """Returns the bytes that a thread accesses given the opcode modifiers."""
+    # ldmatrix reads 1, 2 or 4 8x8 matrices of 16-bit elements, i.e. 4 bytes
+    # per thread and matrix: "LDSM.16.M88.4"
+    if opcode == "LDSM":
+        return 4 * (int(modifiers[-1]) if modifiers and modifiers[-1] in ("2", "4") else 1)
+    for modifier in modifiers:
+        if modifier in ("128", "64"):
+            return int(modifier) // 8
+        if modifier in ("U8", "S8"):
+            return 1
+        if modifier in ("U16", "S16"):
+            return 2
+    return 4
+
+
+class InstructionMix:
+    """
+    The instruction mix of a kernel.
+
+    :ivar counts: the number of instructions of each class: :code:`mma`,
+        :code:`lds` and :code:`sts` (shared memory), :code:`ldg` and
+        :code:`stg` (global memory), :code:`ldgsts` (asynchronous copies),
+        :code:`bar`, :code:`shfl`, :code:`cvt` (conversions), :code:`atom`,
+        :code:`branch` and :code:`other`
+    :ivar opcodes: the number of instructions of each opcode
+    :ivar predicated_loads: the number of global loads guarded by a
+        predicate, e.g. by the mask of :code:`tl.load`
+    :ivar smem_wavefronts: the shared memory wavefronts that a warp needs to
+        run every shared memory instruction once, where a wavefront serves
+        128 bytes. This is the conflict-free lower bound: the addresses are
+        not known statically, so the bank conflicts of a kernel show as the
+        excess of the wavefronts measured by a profiler over this count.
+    :ivar smem_bytes: the bytes per thread accessed by the shared memory
+        instructions
+    """
+
+    def __init__(self, sass=""):
+        self.counts = Counter({name: 0 for name, _ in CLASSES + [("other", None)]})
+        self.opcodes = Counter()
+        self.predicated_loads = 0
+        self.smem_wavefronts = 0
+        self.smem_bytes = 0
+        for line in sass.splitlines():
+            # "<control codes>\t<instruction>"
+            match = INSTR_RE.match(line.split('\t')[-1].strip())
+            if match is None:
+                continue
+            negated, predicate, opcode, modifiers, _ = match.groups()
+            modifiers = modifiers.split('.')[1:]
+            # NOPs pad the end of the kernels
+            if opcode == "NOP":
+                continue
+            instr_class = _classify(opcode)
+            self.counts[instr_class] += 1
+            self.opcodes[opcode] += 1
+            if instr_class == "ldg" and predicate is not None and not (predicate == "PT" and not negated):
+                self.predicated_loads += 1
+            if instr_class in ("lds", "sts"):
+                num_bytes = _access_bytes(opcode, modifiers)
+                self.smem_bytes += num_bytes
+                self.smem_wavefronts += max(1, WARP_SIZE * num_bytes // SMEM_BYTES_PER_WAVEFRONT)
+
+    @property
+    def num_instructions(self):
+        return sum(self.counts.values())
+
+    @property
+    def predicated_load_ratio(self):
+        """The fraction of the global loads guarded by a predicate."""
+        return self.predicated_loads / self.counts["ldg"] if self.counts["ldg"] else 0.0
+
+    @property
+    def smem_bytes_per_access(self):
+        """
+        The average bytes per thread of the shared memory instructions; narrow
+        accesses need more instructions and are more exposed to bank
+        conflicts.
+        """
+        num_smem = self.counts["lds"] + self.counts["sts"]
+        return self.smem_bytes / num_smem if num_smem else 0.0
+
+    def as_dict(self):
+        """Returns the counts of the classes and the summaries as a flat dict."""
+        return {**self.counts,
+                "num_instructions": self.num_instructions,
+                "predicated_load_ratio": self.predicated_load_ratio,
+                "smem_wavefronts": self.smem_wavefronts,
+                "smem_bytes_per_access": self.smem_bytes_per_access}
+
+    def __add__(self, other):
+        mix = InstructionMix()
+        # Counter addition would drop the classes without instructions
+        mix.counts = Counter({name: n + other.counts[name] for name, n in self.counts.items()})
+        mix.opcodes = self.opcodes + other.opcodes
+        mix.predicated_loads = self.predicated_loads + other.predicated_loads
+        mix.smem_wavefronts = self.smem_wavefronts + other.smem_wavefronts
+        mix.smem_bytes = self.smem_bytes + other.smem_bytes
+        return mix
+
+    def __repr__(self):
+        counts = ', '.join(f'{name}: {n}' for name, n in self.counts.items() if n)
+        return f'InstructionMix({counts}, predicated_load_ratio: {self.predicated_load_ratio:.2f}, ' \
+               f'smem_wavefronts: {self.smem_wavefronts})'
+
+
+def analyze(sass):
+    """Returns the :class:`InstructionMix` of the SASS of a kernel."""
+    return InstructionMix(sass)
@@ -0,0 +1,142 @@
+"""
+Compiles ahead of time the kernels recorded in a compilation manifest, e.g.
+at image-build time, so that serving processes find every kernel in the
+cache instead of compiling it at start-up.
+
+The manifest is written by the processes that run with
+:code:`TRITON_COMPILE_MANIFEST=<path>`: each line holds the arguments of a
+compilation of a :code:`@triton.jit` function, which is found again by its
+module and qualified name. The kernels are compiled into
+:code:`TRITON_CACHE_DIR`, or into :code:`--cache-dir`, and the cache can be
+packed into a bundle to unpack where the kernels run.
+
+.. highlight:: bash
+.. code-block:: bash
+
+    TRITON_COMPILE_MANIFEST=kernels.jsonl python serve.py --trace-requests
+    python -m triton.tools.warmup_cache kernels.jsonl --cache-dir /opt/triton-cache --bundle cache.tar.gz
+"""
+
+import argparse
+import importlib
+import json
+import os
+import sys
+import tarfile
+from concurrent.futures import ThreadPoolExecutor
+
+
+def load_manifest(path):
+    """Returns the distinct compilations recorded in a manifest, in order."""
+    records, seen = [], set()
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if line and line not in seen:
+                seen.add(line)
+                records.append(json.loads(line))
+    return records
+
+
+def find_kernel(name):
+    """
+    Returns the :code:`JITFunction` named :code:`module:qualname`, unwrapping
+    the autotuners and heuristics that decorate it.
+    """
+    from ..runtime.jit import JITFunction
+    module_name, qualname = name.split(":")
+    fn = importlib.import_module(module_name)
+    for attr in qualname.split("."):
+        fn = getattr(fn, attr)
+    while not isinstance(fn, JITFunction):
+        fn = fn.fn
+    return fn
+
+
+def compile_record(record):
+    """Compiles the kernel of a manifest record, as recorded."""
+    import hashlib
+
+    import triton
+    from ..compiler.compiler import instance_descriptor
+    fn = find_kernel(record["kernel"])
+    constants = {int(k): find_kernel(v["jit"]) if isinstance(v, dict) else v
+                 for k, v in record["constants"].items()}
+    kwargs = dict(record["options"])
+    if record["max_shared"] is not None:
+        kwargs["max_shared"] = record["max_shared"]
+    kernel = triton.compile(fn, signature={int(k): v for k, v in record["signature"].items()},
+                            constants=constants, cc=record["cc"],
+                            configs=[instance_descriptor(set(record["divisible_by_16"]), set(record["equal_to_1"]))],
+                            **kwargs)
+    # the source of the kernel changed since it was recorded
+    stale = hashlib.md5(fn.cache_key.encode("utf-8")).hexdigest() != record["cache_key"]
+    return kernel, stale
+
+
+def warmup(records, num_threads=None):
+    """
+    Compiles the recorded kernels on :code:`num_threads` threads and returns
+    the number of kernels compiled, of kernels whose source changed since
+    they were recorded (compiled anyway), and the errors by kernel name.
+    """
+    from ..compiler.compiler import CODEGEN_ENV_VARS
+    num_threads = num_threads or os.cpu_count() or 1
+    compiled, stale, errors = 0, 0, {}
+    # the environment variables that change the generated code are
+    # process-wide, so the records of each environment are compiled together
+    groups = {}
+    for record in records:
+        groups.setdefault(tuple(sorted(record.get("env", {}).items())), []).append(record)
+    saved = {name: os.environ.get(name, None) for name in CODEGEN_ENV_VARS}
+    try:
+        for env, group in groups.items():
+            for name in CODEGEN_ENV_VARS:
+                os.environ.pop(name, None)
+            os.environ.update(dict(env))
+
+            def run(record):
+                try:
+                    return compile_record(record)[1], None
+                except Exception as e:
+                    return None, f"{type(e).__name__}: {e}"
+            with ThreadPoolExecutor(max_workers=num_threads) as executor:
+                for record, (is_stale, error) in zip(group, executor.map(run, group)):
+                    if error is not None:
+                        errors.setdefault(record["kernel"], error)
+                        continue
+                    compiled += 1
+                    stale += is_stale
+    finally:
+        for name, value in saved.items():
+            if value is None:
+                os.environ.pop(name, None)
+            else:
+                os.environ[name] = value
+    return compiled, stale, errors
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description="Compiles the kernels recorded with TRITON_COMPILE_MANIFEST")
+    parser.add_argument("manifest", nargs="+", help="the JSON lines manifests to replay")
+    parser.add_argument("--cache-dir", help="the cache to populate, TRITON_CACHE_DIR by default")
+    parser.add_argument("--bundle", help="packs the cache into this .tar.gz file")
+    parser.add_argument("--threads", type=int, default=None, help="the compilation threads, the CPUs by default")
+    args = parser.parse_args(argv)
+    if args.cache_dir:
+        os.environ["TRITON_CACHE_DIR"] = args.cache_dir
+    records = [record for path in args.manifest for record in load_manifest(path)]
+    compiled, stale, errors = warmup(records, args.threads)
+    print(f"compiled {compiled} of {len(records)} kernels ({stale} whose source changed since they were recorded)")
+    for kernel, error in errors.items():
+        print(f"failed to compile {kernel}: {error}", file=sys.stderr)
+    if args.bundle:
+        from ..runtime.cache import default_cache_dir
+        cache_dir = os.environ.get("TRITON_CACHE_DIR", default_cache_dir())
+        with tarfile.open(args.bundle, "w:gz") as bundle:
+            bundle.add(cache_dir, arcname=".")
+    return 1 if errors else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
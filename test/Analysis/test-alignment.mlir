@@ -572,3 +572,28 @@ tt.func @call_graph(%arg0: i32) {
 }
 
 }
+
+// -----
+
+module {
+
+// Tensor arguments get the axis info of the call sites
+// CHECK-LABEL: @tensor_callee
+tt.func @tensor_callee(%arg0: tensor<128x!tt.ptr<f32>>) {
+  // CHECK: constancy = [128], constant_value = 0
+  %cst = arith.constant dense<0> : tensor<128xi32>
+  // CHECK-NEXT: contiguity = [128], divisibility = [16], constancy = [1], constant_value = <none>
+  %0 = tt.addptr %arg0, %cst : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  tt.return
+}
+
+// CHECK-LABEL: @tensor_caller
+tt.func @tensor_caller(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+  %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  tt.call @tensor_callee(%2) : (tensor<128x!tt.ptr<f32>>) -> ()
+  tt.return
+}
+
+}
@@ -0,0 +1,82 @@
+// RUN: triton-opt %s -split-input-file --mlir-disable-threading -test-print-allocation="strategy=best-fit" 2>&1 | FileCheck %s
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#A_SHARED = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// The heuristic needs 2656 bytes for this function (see multi_color in
+// test-allocation.mlir); packing the buffers by decreasing size gets close to
+// the lower bound.
+// CHECK-LABEL: multi_color
+tt.func @multi_color(%A : !tt.ptr<f16>) {
+  // CHECK: offset = 1280, size = 64
+  %cst = arith.constant dense<0.000000e+00> : tensor<4x8xf16, #A_SHARED>
+  // CHECK-NEXT: offset = 1408, size = 32
+  %cst_0 = arith.constant dense<0.000000e+00> : tensor<4x4xf16, #A_SHARED>
+  // CHECK-NEXT: offset = 1152, size = 128
+  %cst_1 = arith.constant dense<0.000000e+00> : tensor<16x4xf16, #A_SHARED>
+  %cst_2 = arith.constant dense<0.000000e+00> : tensor<16x32xf16, #AL>
+  // CHECK-NEXT: scratch offset = 0, size = 1152
+  %0 = triton_gpu.convert_layout %cst_2 : (tensor<16x32xf16, #AL>) -> tensor<16x32xf16, #AL>
+  %1 = triton_gpu.convert_layout %cst : (tensor<4x8xf16, #A_SHARED>) -> tensor<4x8xf16, #AL>
+  // CHECK-NEXT: offset = 0, size = 128
+  %cst_3 = arith.constant dense<0.000000e+00> : tensor<4x16xf16, #A_SHARED>
+  %2 = triton_gpu.convert_layout %cst_0 : (tensor<4x4xf16, #A_SHARED>) -> tensor<4x4xf16, #AL>
+  // CHECK-NEXT: scratch offset = 0, size = 1152
+  %3 = triton_gpu.convert_layout %cst_2 : (tensor<16x32xf16, #AL>) -> tensor<16x32xf16, #AL>
+  // CHECK-NEXT: offset = 512, size = 256
+  %cst_4 = arith.constant dense<0.000000e+00> : tensor<4x32xf16, #A_SHARED>
+  // CHECK-NEXT: offset = 768, size = 64
+  %cst_5 = arith.constant dense<0.000000e+00> : tensor<4x8xf16, #A_SHARED>
+  %4 = triton_gpu.convert_layout %cst_5 : (tensor<4x8xf16, #A_SHARED>) -> tensor<4x8xf16, #AL>
+  %5 = triton_gpu.convert_layout %cst_5 : (tensor<4x8xf16, #A_SHARED>) -> tensor<4x8xf16, #AL>
+  // CHECK-NEXT: offset = 0, size = 512
+  %cst_6 = arith.constant dense<0.000000e+00> : tensor<8x32xf16, #A_SHARED>
+  // CHECK-NEXT: offset = 1280, size = 128
+  %cst_7 = arith.constant dense<0.000000e+00> : tensor<2x32xf16, #A_SHARED>
+  %6 = triton_gpu.convert_layout %cst_0 : (tensor<4x4xf16, #A_SHARED>) -> tensor<4x4xf16, #AL>
+  // CHECK-NEXT: offset = 0, size = 512
+  %cst_8 = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #A_SHARED>
+  // CHECK-NEXT: offset = 768, size = 32
+  %cst_9 = arith.constant dense<0.000000e+00> : tensor<4x4xf16, #A_SHARED>
+  // CHECK-NEXT: offset = 0, size = 512
+  %cst_10 = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #A_SHARED>
+  %7 = triton_gpu.convert_layout %cst_1 : (tensor<16x4xf16, #A_SHARED>) -> tensor<16x4xf16, #AL>
+  %8 = triton_gpu.convert_layout %cst_4 : (tensor<4x32xf16, #A_SHARED>) -> tensor<4x32xf16, #AL>
+  // CHECK-NEXT: scratch offset = 0, size = 1152
+  %9 = triton_gpu.convert_layout %cst_2 : (tensor<16x32xf16, #AL>) -> tensor<16x32xf16, #AL>
+  %cst_11 = arith.constant dense<0.000000e+00> : tensor<4x4xf16, #AL>
+  %10 = triton_gpu.convert_layout %cst_7 : (tensor<2x32xf16, #A_SHARED>) -> tensor<2x32xf16, #AL>
+  %cst_12 = arith.constant dense<0.000000e+00> : tensor<4x16xf16, #AL>
+  %cst_13 = arith.constant dense<0.000000e+00> : tensor<8x32xf16, #AL>
+  // CHECK-NEXT: size = 1440
+  // CHECK-NEXT: lower bound = 1376
+  tt.return
+}
+
+// Few buffers: every placement order is searched. The heuristic needs 6144
+// bytes here, while the best packing reaches the lower bound.
+// CHECK-LABEL: exhaustive
+tt.func @exhaustive(%A : !tt.ptr<f16>) {
+  // CHECK: offset = 0, size = 2048
+  %cst0 = arith.constant dense<0.000000e+00> : tensor<32x32xf16, #A_SHARED>
+  // CHECK-NEXT: offset = 2048, size = 1024
+  %cst1 = arith.constant dense<0.000000e+00> : tensor<32x16xf16, #A_SHARED>
+  %0 = triton_gpu.convert_layout %cst0 : (tensor<32x32xf16, #A_SHARED>) -> tensor<32x32xf16, #AL>
+  // CHECK-NEXT: offset = 1024, size = 512
+  %cst2 = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #A_SHARED>
+  // CHECK-NEXT: offset = 0, size = 1024
+  %cst3 = arith.constant dense<0.000000e+00> : tensor<32x16xf16, #A_SHARED>
+  %1 = triton_gpu.convert_layout %cst2 : (tensor<16x16xf16, #A_SHARED>) -> tensor<16x16xf16, #AL>
+  %2 = triton_gpu.convert_layout %cst1 : (tensor<32x16xf16, #A_SHARED>) -> tensor<32x16xf16, #AL>
+  // CHECK-NEXT: offset = 1024, size = 2048
+  %cst4 = arith.constant dense<0.000000e+00> : tensor<32x32xf16, #A_SHARED>
+  %3 = triton_gpu.convert_layout %cst3 : (tensor<32x16xf16, #A_SHARED>) -> tensor<32x16xf16, #AL>
+  %4 = triton_gpu.convert_layout %cst4 : (tensor<32x32xf16, #A_SHARED>) -> tensor<32x32xf16, #AL>
+  tt.return
+  // CHECK-NEXT: size = 3072
+  // CHECK-NEXT: lower bound = 3072
+}
+
+}
@@ -0,0 +1,32 @@
+// RUN: env TRITON_SWIZZLE_CVT_LAYOUT=1 triton-opt %s --mlir-disable-threading -test-print-allocation 2>&1 | FileCheck %s
+// RUN: triton-opt %s --mlir-disable-threading -test-print-allocation 2>&1 | FileCheck %s --check-prefix=PADDED
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#BL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+#C = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// A 16x32 replica of f16, padded by 4 elements per row when not swizzled
+// CHECK-LABEL: blocked_to_blocked
+// CHECK: scratch offset = 0, size = 1024
+// PADDED-LABEL: blocked_to_blocked
+// PADDED: scratch offset = 0, size = 1152
+tt.func @blocked_to_blocked() {
+  %cst = arith.constant dense<0.000000e+00> : tensor<128x32xf16, #AL>
+  %0 = triton_gpu.convert_layout %cst : (tensor<128x32xf16, #AL>) -> tensor<128x32xf16, #BL>
+  tt.return
+}
+
+// A 64x128 replica of f32, padded by 4 elements per row when not swizzled
+// CHECK-LABEL: mma_to_blocked
+// CHECK: scratch offset = 0, size = 32768
+// PADDED-LABEL: mma_to_blocked
+// PADDED: scratch offset = 0, size = 33792
+tt.func @mma_to_blocked() {
+  %cst = arith.constant dense<0.000000e+00> : tensor<128x128xf32, #C>
+  %0 = triton_gpu.convert_layout %cst : (tensor<128x128xf32, #C>) -> tensor<128x128xf32, #BL>
+  tt.return
+}
+
+}
@@ -2,7 +2,9 @@
 
 #AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
 #sliceAd0 = #triton_gpu.slice<{dim = 0, parent = #AL}>
+#sliceAd1 = #triton_gpu.slice<{dim = 1, parent = #AL}>
 #BL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+#AL_T = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [0, 1]}>
 #A_SHARED = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
 #A_SHARED_T = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [0, 1]}>
 #B_SHARED = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
@@ -199,9 +201,23 @@ tt.func @multi_color(%A : !tt.ptr<f16>) {
   %cst_12 = arith.constant dense<0.000000e+00> : tensor<4x16xf16, #AL>
   %cst_13 = arith.constant dense<0.000000e+00> : tensor<8x32xf16, #AL>
   // CHECK-NEXT: size = 2656
+  // CHECK-NEXT: lower bound = 1376
   tt.return
 }
 
+// A conversion that keeps every element in its warp is done with warp
+// shuffles and needs no scratch buffer
+// CHECK-LABEL: warp_local_cvt
+tt.func @warp_local_cvt(%A : !tt.ptr<f16>) {
+  // CHECK: offset = 0, size = 512
+  %cst = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #A_SHARED>
+  %cst_0 = arith.constant dense<0.000000e+00> : tensor<16x32xf16, #AL>
+  // CHECK-NOT: scratch
+  %0 = triton_gpu.convert_layout %cst_0 : (tensor<16x32xf16, #AL>) -> tensor<16x32xf16, #AL_T>
+  tt.return
+  // CHECK: size = 512
+}
+
 // CHECK-LABEL: alloc
 tt.func @alloc(%A : !tt.ptr<f16>) {
   // CHECK: offset = 0, size = 512
@@ -226,6 +242,22 @@ tt.func @scratch() {
   // CHECK-NEXT: size = 512
 }
 
+// The rows are reduced within warps, without scratch memory
+// CHECK-LABEL: scratch_warp_sync_reduce
+tt.func @scratch_warp_sync_reduce() {
+  %cst0 = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #AL>
+  %cst1 = arith.constant dense<0> : tensor<16x16xi32, #AL>
+  %b:2 = "tt.reduce" (%cst0, %cst1) ({
+  ^bb0(%arg0: f16, %arg1: i32, %arg2: f16, %arg3: i32):
+    %cmp = arith.cmpf ogt, %arg0, %arg2 : f16
+    %v = arith.select %cmp, %arg0, %arg2 : f16
+    %i = arith.select %cmp, %arg1, %arg3 : i32
+    tt.reduce.return %v, %i : f16, i32
+  }) {axis = 1 : i32} : (tensor<16x16xf16, #AL>, tensor<16x16xi32, #AL>) -> (tensor<16xf16, #sliceAd1>, tensor<16xi32, #sliceAd1>)
+  tt.return
+  // CHECK: size = 0
+}
+
 // CHECK-LABEL: trans
 tt.func @trans(%A : !tt.ptr<f16>) {
   // CHECK: offset = 0, size = 1024
@@ -325,6 +357,26 @@ tt.func @for(%lb : index, %ub : index, %step : index, %A : !tt.ptr<f16>, %B : !t
   // CHECK-NEXT: size = 24576
 }
 
+// The buffer yielded by one branch is dead in the other one, which reuses it
+// CHECK-LABEL: if_else_split
+tt.func @if_else_split(%i1 : i1) {
+  %0 = scf.if %i1 -> tensor<128x32xf16, #A_SHARED> {
+    // CHECK: offset = 0, size = 8192
+    %cst0 = arith.constant dense<0.00e+00> : tensor<128x32xf16, #A_SHARED>
+    scf.yield %cst0 : tensor<128x32xf16, #A_SHARED>
+  } else {
+    // CHECK-NEXT: offset = 0, size = 8192
+    %cst1 = arith.constant dense<0.00e+00> : tensor<128x32xf16, #A_SHARED>
+    // CHECK-NEXT: offset = 8192, size = 8192
+    %cst2 = arith.constant dense<0.00e+00> : tensor<128x32xf16, #A_SHARED>
+    %1 = triton_gpu.convert_layout %cst1 : (tensor<128x32xf16, #A_SHARED>) -> tensor<128x32xf16, #AL>
+    scf.yield %cst2 : tensor<128x32xf16, #A_SHARED>
+  }
+  %2 = triton_gpu.convert_layout %0 : (tensor<128x32xf16, #A_SHARED>) -> tensor<128x32xf16, #AL>
+  tt.return
+  // CHECK-NEXT: size = 16384
+}
+
 // CHECK-LABEL: for_if_slice
 tt.func @for_if_slice(%lb : index, %ub : index, %step : index, %A : !tt.ptr<f16>, %B : !tt.ptr<f16>, %i1 : i1) {
   // CHECK: offset = 0, size = 8192
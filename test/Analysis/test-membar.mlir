@@ -100,6 +100,83 @@ tt.func @async_wait() {
   tt.return
 }
 
+// CHECK-LABEL: async_wait_no_read
+tt.func @async_wait_no_read(%A : !tt.ptr<f16>, %i1 : i1) {
+  %a_ptr = tt.broadcast %A : (!tt.ptr<f16>) -> tensor<16x16x!tt.ptr<f16>, #AL>
+  %mask = tt.splat %i1 : (i1) -> tensor<16x16xi1, #AL>
+  %other = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #AL>
+  %tensor = triton_gpu.alloc_tensor : tensor<1x16x16xf16, #A_SHARED>
+  %index = arith.constant 0 : i32
+  %0 = triton_gpu.insert_slice_async %a_ptr, %tensor, %index, %mask, %other {axis = 0 : i32, cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16x!tt.ptr<f16>, #AL> -> tensor<1x16x16xf16, #A_SHARED>
+  triton_gpu.async_commit_group
+  // CHECK-NOT: gpu.barrier
+  // CHECK: tt.return
+  triton_gpu.async_wait {num = 0 : i32}
+  tt.return
+}
+
+// The completed copies are synced before their first read, and copies into
+// a slot that isn't being read don't need a barrier
+// CHECK-LABEL: async_wait_slots
+tt.func @async_wait_slots(%A : !tt.ptr<f16>, %i1 : i1) {
+  %a_ptr = tt.broadcast %A : (!tt.ptr<f16>) -> tensor<16x16x!tt.ptr<f16>, #AL>
+  %mask = tt.splat %i1 : (i1) -> tensor<16x16xi1, #AL>
+  %other = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #AL>
+  %tensor = triton_gpu.alloc_tensor : tensor<2x16x16xf16, #A_SHARED>
+  %c0 = arith.constant 0 : i32
+  %c1 = arith.constant 1 : i32
+  %0 = triton_gpu.insert_slice_async %a_ptr, %tensor, %c0, %mask, %other {axis = 0 : i32, cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16x!tt.ptr<f16>, #AL> -> tensor<2x16x16xf16, #A_SHARED>
+  triton_gpu.async_commit_group
+  triton_gpu.async_wait {num = 0 : i32}
+  // CHECK: triton_gpu.async_wait {num = 0 : i32}
+  // CHECK-NEXT: triton_gpu.extract_slice
+  // CHECK-NEXT: gpu.barrier
+  // CHECK-NEXT: triton_gpu.convert_layout
+  // CHECK-NEXT: triton_gpu.insert_slice_async
+  // CHECK-NEXT: triton_gpu.async_commit_group
+  // CHECK-NEXT: triton_gpu.async_wait {num = 0 : i32}
+  // CHECK-NEXT: triton_gpu.extract_slice
+  // CHECK-NEXT: gpu.barrier
+  // CHECK-NEXT: triton_gpu.convert_layout
+  %1 = triton_gpu.extract_slice %0[%c0, 0, 0][1, 16, 16][1, 1, 1] : tensor<2x16x16xf16, #A_SHARED> to tensor<16x16xf16, #A_SHARED>
+  %2 = triton_gpu.convert_layout %1 : (tensor<16x16xf16, #A_SHARED>) -> tensor<16x16xf16, #AL>
+  %3 = triton_gpu.insert_slice_async %a_ptr, %0, %c1, %mask, %other {axis = 0 : i32, cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16x!tt.ptr<f16>, #AL> -> tensor<2x16x16xf16, #A_SHARED>
+  triton_gpu.async_commit_group
+  triton_gpu.async_wait {num = 0 : i32}
+  %4 = triton_gpu.extract_slice %3[%c1, 0, 0][1, 16, 16][1, 1, 1] : tensor<2x16x16xf16, #A_SHARED> to tensor<16x16xf16, #A_SHARED>
+  %5 = triton_gpu.convert_layout %4 : (tensor<16x16xf16, #A_SHARED>) -> tensor<16x16xf16, #AL>
+  tt.return
+}
+
+// The slices of a slot joined by a branch only alias that slot, so a copy
+// into another slot doesn't need a barrier
+// CHECK-LABEL: async_wait_slots_branch
+tt.func @async_wait_slots_branch(%A : !tt.ptr<f16>, %i1 : i1) {
+  %a_ptr = tt.broadcast %A : (!tt.ptr<f16>) -> tensor<16x16x!tt.ptr<f16>, #AL>
+  %mask = tt.splat %i1 : (i1) -> tensor<16x16xi1, #AL>
+  %other = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #AL>
+  %tensor = triton_gpu.alloc_tensor : tensor<2x16x16xf16, #A_SHARED>
+  %c0 = arith.constant 0 : i32
+  %c1 = arith.constant 1 : i32
+  %0 = triton_gpu.insert_slice_async %a_ptr, %tensor, %c0, %mask, %other {axis = 0 : i32, cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16x!tt.ptr<f16>, #AL> -> tensor<2x16x16xf16, #A_SHARED>
+  triton_gpu.async_commit_group
+  triton_gpu.async_wait {num = 0 : i32}
+  %1 = scf.if %i1 -> tensor<16x16xf16, #A_SHARED> {
+    %2 = triton_gpu.extract_slice %0[%c0, 0, 0][1, 16, 16][1, 1, 1] : tensor<2x16x16xf16, #A_SHARED> to tensor<16x16xf16, #A_SHARED>
+    scf.yield %2 : tensor<16x16xf16, #A_SHARED>
+  } else {
+    %2 = triton_gpu.extract_slice %0[0, 0, 0][1, 16, 16][1, 1, 1] : tensor<2x16x16xf16, #A_SHARED> to tensor<16x16xf16, #A_SHARED>
+    scf.yield %2 : tensor<16x16xf16, #A_SHARED>
+  }
+  // CHECK: gpu.barrier
+  // CHECK-NEXT: triton_gpu.convert_layout
+  // CHECK-NEXT: triton_gpu.insert_slice_async
+  %3 = triton_gpu.convert_layout %1 : (tensor<16x16xf16, #A_SHARED>) -> tensor<16x16xf16, #AL>
+  %4 = triton_gpu.insert_slice_async %a_ptr, %0, %c1, %mask, %other {axis = 0 : i32, cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16x!tt.ptr<f16>, #AL> -> tensor<2x16x16xf16, #A_SHARED>
+  triton_gpu.async_commit_group
+  tt.return
+}
+
 // CHECK-LABEL: alloc
 tt.func @alloc() {
   %0 = triton_gpu.alloc_tensor : tensor<16x16xf16, #A_SHARED>
@@ -0,0 +1,34 @@
+// RUN: triton-opt %s --mlir-disable-threading -test-print-register-usage 2>&1 | FileCheck %s
+
+#BL = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// A thread holds 4 elements of the tensors: 4 registers of i32 or f32 and 8
+// of pointers. Both offsets and pointers are live at the second addptr.
+// CHECK-LABEL: add
+// CHECK-NEXT: registers = 24
+tt.func @add(%arg0: !tt.ptr<f32>, %arg1: !tt.ptr<f32>) {
+  %0 = tt.make_range {end = 512 : i32, start = 0 : i32} : tensor<512xi32, #BL>
+  %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<512x!tt.ptr<f32>, #BL>
+  %2 = tt.addptr %1, %0 : tensor<512x!tt.ptr<f32>, #BL>, tensor<512xi32, #BL>
+  %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<512xf32, #BL>
+  %4 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<512x!tt.ptr<f32>, #BL>
+  %5 = tt.addptr %4, %0 : tensor<512x!tt.ptr<f32>, #BL>, tensor<512xi32, #BL>
+  tt.store %5, %3 : tensor<512xf32, #BL>
+  tt.return
+}
+
+// Two f16 elements share a register
+// CHECK-LABEL: copy_f16
+// CHECK-NEXT: registers = 40
+tt.func @copy_f16(%arg0: !tt.ptr<f16>) {
+  %0 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #BL>
+  %1 = tt.splat %arg0 : (!tt.ptr<f16>) -> tensor<1024x!tt.ptr<f16>, #BL>
+  %2 = tt.addptr %1, %0 : tensor<1024x!tt.ptr<f16>, #BL>, tensor<1024xi32, #BL>
+  %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<1024xf16, #BL>
+  tt.store %2, %3 : tensor<1024xf16, #BL>
+  tt.return
+}
+
+}
@@ -125,6 +125,37 @@ tt.func @reduce_ops_infer(%ptr: !tt.ptr<f32>, %v : tensor<1x2x4xf32>) {
   tt.return
 }
 
+tt.func @scan_ops_infer(%ptr: !tt.ptr<f32>, %v : tensor<2x4xf32>) {
+  // Test if scan ops infer types correctly
+
+  // CHECK: }) {axis = 1 : i32} : (tensor<2x4xf32>) -> tensor<2x4xf32>
+  %a = "tt.scan" (%v) ({
+  ^bb0(%arg0: f32, %arg1: f32):
+    %add = arith.addf %arg0, %arg1 : f32
+    tt.scan.return %add : f32
+  }) {axis = 1 : i32}  : (tensor<2x4xf32>) -> tensor<2x4xf32>
+
+  %ptr2x4 = tt.splat %ptr : (!tt.ptr<f32>) -> tensor<2x4x!tt.ptr<f32>>
+  tt.store %ptr2x4, %a : tensor<2x4xf32>
+  tt.return
+}
+
+tt.func @sort_ops_infer(%v : tensor<2x8xf32>, %i : tensor<2x8xi32>) {
+  // Test if sort ops infer types correctly
+
+  // CHECK: tt.sort %{{.*}}, %{{.*}} {axis = 1 : i32, descending = false} : tensor<2x8xf32>, tensor<2x8xi32>
+  %a:2 = tt.sort %v, %i {axis = 1 : i32, descending = false} : tensor<2x8xf32>, tensor<2x8xi32>
+  // CHECK: tt.topk %{{.*}}, %{{.*}} {axis = 1 : i32, k = 4 : i32} : tensor<2x8xf32>, tensor<2x8xi32> -> tensor<2x4xf32>, tensor<2x4xi32>
+  %b:2 = tt.topk %a#0, %a#1 {axis = 1 : i32, k = 4 : i32} : tensor<2x8xf32>, tensor<2x8xi32> -> tensor<2x4xf32>, tensor<2x4xi32>
+  tt.return
+}
+
+tt.func @histogram_op(%v : tensor<2x8xi32>) {
+  // CHECK: tt.histogram %{{.*}} : tensor<2x8xi32> -> tensor<16xi32>
+  %a = tt.histogram %v : tensor<2x8xi32> -> tensor<16xi32>
+  tt.return
+}
+
 tt.func @dot_ops_infer(%ptr: !tt.ptr<f32>, %v : f32) {
   // Test if reduce ops infer types correctly
   %v128x32 = tt.splat %v : (f32) -> tensor<128x32xf32>
@@ -154,3 +185,10 @@ tt.func @dot_ops_infer(%ptr: !tt.ptr<f32>, %v : f32) {
   tt.store %ptr1x1, %r4 : tensor<1x1xf32>
   tt.return
 }
+
+tt.func @sparse_dot_ops_infer(%a: tensor<32x16xf16>, %b: tensor<32x32xf16>, %meta: tensor<32x2xi16>) -> tensor<32x32xf32> {
+  %zero = arith.constant dense<0.00e+00> : tensor<32x32xf32>
+  // CHECK: %{{.*}} = tt.sparse_dot %{{.*}} : tensor<32x16xf16> * tensor<32x32xf16> meta tensor<32x2xi16> -> tensor<32x32xf32>
+  %r = tt.sparse_dot %a, %b, %zero, %meta : tensor<32x16xf16> * tensor<32x32xf16> meta tensor<32x2xi16> -> tensor<32x32xf32>
+  tt.return %r : tensor<32x32xf32>
+}
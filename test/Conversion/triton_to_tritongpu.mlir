@@ -1,7 +1,7 @@
 // RUN: triton-opt %s -split-input-file -convert-triton-to-tritongpu=num-warps=2 | FileCheck %s
 
 tt.func @ops() {
-  // CHECK: module attributes {"triton_gpu.num-warps" = 2 : i32} {{.*}}
+  // CHECK: module attributes {"triton_gpu.num-warps" = 2 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {{.*}}
   %a = arith.constant dense<1.00e+00> : tensor<128x32xf16>
   %b = arith.constant dense<2.00e+00> : tensor<32x128xf16>
   %c = arith.constant dense<3.00e+00> : tensor<128x128xf32>
@@ -30,13 +30,28 @@ tt.func @load_ops(%ptr: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
 
 // -----
 
+tt.func @block_ptr_ops(%ptr: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %n: i64) {
+  // Block pointers keep no layout, their loaded and stored values do
+  %c0 = arith.constant 0 : i32
+  %c1 = arith.constant 1 : i64
+  // CHECK: %[[PTR:.*]] = tt.make_tensor_ptr {{.*}} : !tt.ptr<tensor<128xf32>>
+  %block = tt.make_tensor_ptr %ptr, [%n], [%c1], [%c0] {order = array<i32: 0>} : !tt.ptr<tensor<128xf32>>
+  // CHECK: %[[VAL:.*]] = tt.load %[[PTR]] {boundaryCheck = array<i32: 0>, cache = 1 : i32, evict = 1 : i32, isVolatile = false, padding = 1 : i32} : !tt.ptr<tensor<128xf32>> -> tensor<128xf32, #{{.*}}>
+  %a = tt.load %block {boundaryCheck = array<i32: 0>, cache = 1 : i32, evict = 1 : i32, isVolatile = false, padding = 1 : i32} : !tt.ptr<tensor<128xf32>> -> tensor<128xf32>
+  // CHECK: tt.store %[[PTR]], %[[VAL]] {boundaryCheck = array<i32: 0>, cache = 1 : i32, evict = 1 : i32} : !tt.ptr<tensor<128xf32>>, tensor<128xf32, #{{.*}}>
+  tt.store %block, %a {boundaryCheck = array<i32: 0>, cache = 1 : i32, evict = 1 : i32} : !tt.ptr<tensor<128xf32>>, tensor<128xf32>
+  tt.return
+}
+
+// -----
+
 tt.func @reduce_ops(%ptr: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
   // Test if the total number of threadsPerWarp is 32
   // Test if the total number of warps is 2
   // CHECK: #[[blocked0:.*]] = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [4, 8], warpsPerCTA = [1, 2], order = [0, 1]}>
   // CHECK: #[[blocked1:.*]] = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [8, 4], warpsPerCTA = [1, 2], order = [0, 1]}>
   // CHECK: #[[blocked2:.*]] = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [16, 2], warpsPerCTA = [1, 2], order = [0, 1]}>
-  // CHECK: module attributes {"triton_gpu.num-warps" = 2 : i32} {{.*}}
+  // CHECK: module attributes {"triton_gpu.num-warps" = 2 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {{.*}}
   %c0 = arith.constant dense<1.00e+00> : tensor<4x4xf32>
   %c1 = arith.constant dense<2.00e+00> : tensor<8x2xf32>
   %c2 = arith.constant dense<3.00e+00> : tensor<16x16xf32>
@@ -67,3 +82,67 @@ tt.func @reduce_ops(%ptr: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
 
   tt.return
 }
+
+// -----
+
+// CHECK-DAG: #[[BLOCKED:.*]] = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [32, 1], warpsPerCTA = [1, 2], order = [0, 1]}>
+// CHECK-DAG: #[[TRANS:.*]] = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [2, 1], order = [1, 0]}>
+// CHECK-LABEL: trans_in_registers
+tt.func @trans_in_registers(%arg0: tensor<32x16xf32>) {
+  // A blocked tensor is transposed in registers, without going through
+  // shared memory
+  // CHECK-NOT: triton_gpu.convert_layout
+  // CHECK: tt.trans %{{.*}} : (tensor<32x16xf32, #[[BLOCKED]]>) -> tensor<16x32xf32, #[[TRANS]]>
+  %0 = tt.trans %arg0 : (tensor<32x16xf32>) -> tensor<16x32xf32>
+  tt.return
+}
+
+// -----
+
+// CHECK-LABEL: trans_dot_operand
+tt.func @trans_dot_operand(%a: tensor<16x16xf16>, %b: tensor<16x16xf16>) {
+  // The operands of a dot are read from shared memory, where the transposed
+  // operand is a view
+  // CHECK: %[[SHARED:.*]] = triton_gpu.convert_layout %{{.*}} -> tensor<16x16xf16, #shared
+  // CHECK: tt.trans %[[SHARED]]
+  %c = arith.constant dense<0.00e+00> : tensor<16x16xf32>
+  %bt = tt.trans %b : (tensor<16x16xf16>) -> tensor<16x16xf16>
+  %0 = tt.dot %a, %bt, %c {allowTF32 = true, transA = false, transB = false} : tensor<16x16xf16> * tensor<16x16xf16> -> tensor<16x16xf32>
+  tt.return
+}
+
+// -----
+
+#shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+// CHECK-LABEL: shared_memory_ops
+tt.func @shared_memory_ops(%ptrs: tensor<16x16x!tt.ptr<f16>>, %mask: tensor<16x16xi1>) -> tensor<16x16xf16> {
+  // The buffers of the frontend keep their layout, the pointers copied into
+  // them and the tiles loaded out of them get a blocked one
+  // CHECK: %[[BUF:.*]] = triton_gpu.alloc_tensor : tensor<2x16x16xf16, #shared>
+  // CHECK: %[[COPY:.*]] = triton_gpu.insert_slice_async %{{.*}}, %[[BUF]], %{{.*}}, %{{.*}} {{.*}} : tensor<16x16x!tt.ptr<f16>, #blocked{{.*}}> -> tensor<2x16x16xf16, #shared>
+  // CHECK: triton_gpu.async_commit_group
+  // CHECK: triton_gpu.async_wait {num = 0 : i32}
+  // CHECK: %[[TILE:.*]] = triton_gpu.extract_slice %[[COPY]]
+  // CHECK: triton_gpu.convert_layout %[[TILE]] : (tensor<16x16xf16, #shared>) -> tensor<16x16xf16, #blocked
+  %c0 = arith.constant 0 : i32
+  %buf = triton_gpu.alloc_tensor : tensor<2x16x16xf16, #shared>
+  %copy = triton_gpu.insert_slice_async %ptrs, %buf, %c0, %mask {axis = 0 : i32, cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16x!tt.ptr<f16>> -> tensor<2x16x16xf16, #shared>
+  triton_gpu.async_commit_group
+  triton_gpu.async_wait {num = 0 : i32}
+  %tile = triton_gpu.extract_slice %copy[%c0, 0, 0] [1, 16, 16] [1, 1, 1] : tensor<2x16x16xf16, #shared> to tensor<16x16xf16, #shared>
+  %0 = triton_gpu.convert_layout %tile : (tensor<16x16xf16, #shared>) -> tensor<16x16xf16>
+  tt.return %0 : tensor<16x16xf16>
+}
+
+// -----
+
+// CHECK-LABEL: sparse_dot
+tt.func @sparse_dot(%a: tensor<64x32xf16>, %b: tensor<64x64xf16>, %meta: tensor<64x4xi16>) -> tensor<64x64xf32> {
+  // $a and $b are dot operands like in a dense dot, the metadata is read
+  // from shared memory
+  // CHECK: %[[META:.*]] = triton_gpu.convert_layout %{{.*}} -> tensor<64x4xi16, #shared
+  // CHECK: tt.sparse_dot %{{.*}}, %{{.*}}, %{{.*}}, %[[META]] : tensor<64x32xf16, #triton_gpu.dot_op<{opIdx = 0, {{.*}}}>> * tensor<64x64xf16, #triton_gpu.dot_op<{opIdx = 1, {{.*}}}>> meta tensor<64x4xi16, #shared
+  %c = arith.constant dense<0.00e+00> : tensor<64x64xf32>
+  %0 = tt.sparse_dot %a, %b, %c, %meta : tensor<64x32xf16> * tensor<64x64xf16> meta tensor<64x4xi16> -> tensor<64x64xf32>
+  tt.return %0 : tensor<64x64xf32>
+}
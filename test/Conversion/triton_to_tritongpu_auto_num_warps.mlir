@@ -0,0 +1,36 @@
+// RUN: triton-opt %s -split-input-file -convert-triton-to-tritongpu="num-warps=4 auto-num-warps=true" | FileCheck %s
+
+// A 16-element bias add only needs a warp
+// CHECK: #[[blocked:.*]] = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [1], order = [0]}>
+// CHECK: module attributes {"triton_gpu.num-warps" = 1 : i32, "triton_gpu.threads-per-warp" = 32 : i32}
+tt.func @bias_add(%ptr: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %bias: f32) {
+  // CHECK: tensor<16x!tt.ptr<f32>, #[[blocked]]>
+  %offs = tt.make_range {end = 16 : i32, start = 0 : i32} : tensor<16xi32>
+  %ptrs = tt.splat %ptr : (!tt.ptr<f32>) -> tensor<16x!tt.ptr<f32>>
+  %addrs = tt.addptr %ptrs, %offs : tensor<16x!tt.ptr<f32>>, tensor<16xi32>
+  %x = tt.load %addrs {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16xf32>
+  %b = tt.splat %bias : (f32) -> tensor<16xf32>
+  %y = arith.addf %x, %b : tensor<16xf32>
+  tt.store %addrs, %y : tensor<16xf32>
+  tt.return
+}
+
+// -----
+
+// The warps are bounded by num-warps
+// CHECK: module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32}
+tt.func @large_ops() {
+  %a = arith.constant dense<1.00e+00> : tensor<128x32xf16>
+  tt.return
+}
+
+// -----
+
+// The 64 elements of a 2x32 tile take 2 warps
+// CHECK: module attributes {"triton_gpu.num-warps" = 2 : i32, "triton_gpu.threads-per-warp" = 32 : i32}
+tt.func @rows(%ptr: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+  %ptrs = tt.splat %ptr : (!tt.ptr<f32>) -> tensor<2x32x!tt.ptr<f32>>
+  %x = tt.load %ptrs {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<2x32xf32>
+  tt.store %ptrs, %x : tensor<2x32xf32>
+  tt.return
+}
@@ -0,0 +1,28 @@
+// RUN: triton-opt %s -split-input-file -convert-triton-to-tritongpu="num-warps=2 threads-per-warp=64" | FileCheck %s
+
+tt.func @wave64_ops(%ptr: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+  // Test if the total number of threadsPerWarp is 64
+  // CHECK: #[[blocked0:.*]] = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [64], warpsPerCTA = [2], order = [0]}>
+  // CHECK: #[[blocked1:.*]] = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [4, 16], warpsPerCTA = [1, 2], order = [0, 1]}>
+  // CHECK: #[[blocked2:.*]] = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [16, 4], warpsPerCTA = [1, 2], order = [0, 1]}>
+  // CHECK: module attributes {"triton_gpu.num-warps" = 2 : i32, "triton_gpu.threads-per-warp" = 64 : i32} {{.*}}
+  // CHECK: tensor<128x!tt.ptr<f32>, #[[blocked0]]>
+  %ptrs = tt.splat %ptr : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+  %a = tt.load %ptrs {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32>
+  tt.store %ptrs, %a : tensor<128xf32>
+  %c0 = arith.constant dense<1.00e+00> : tensor<4x4xf32>
+  %c1 = arith.constant dense<2.00e+00> : tensor<16x16xf32>
+  // CHECK: (tensor<4x4xf32, #[[blocked1]]>) -> tensor<4xf32, #triton_gpu.slice<{dim = 0, parent = #[[blocked1]]}>>
+  %c0_ = "tt.reduce" (%c0) ({
+  ^bb0(%arg1: f32, %arg2: f32):
+    %add = arith.addf %arg1, %arg2 : f32
+    tt.reduce.return %add : f32
+  }) {axis = 0 : i32} : (tensor<4x4xf32>) -> tensor<4xf32>
+  // CHECK: (tensor<16x16xf32, #[[blocked2]]>) -> tensor<16xf32, #triton_gpu.slice<{dim = 1, parent = #[[blocked2]]}>>
+  %c1_ = "tt.reduce" (%c1) ({
+  ^bb0(%arg3: f32, %arg4: f32):
+    %add = arith.addf %arg3, %arg4 : f32
+    tt.reduce.return %add : f32
+  }) {axis = 1 : i32} : (tensor<16x16xf32>) -> tensor<16xf32>
+  tt.return
+}
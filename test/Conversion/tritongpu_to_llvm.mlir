@@ -40,6 +40,26 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // A parameter table is passed by value and read with plain loads
+  // CHECK: llvm.func @param_table_load(%arg0: !llvm.ptr<array<128 x f32>> {llvm.align = 4 : i64, llvm.byval = !llvm.array<128 x f32>}
+  tt.func @param_table_load(%table : !tt.ptr<f32, 101> {tt.param_table = 128 : i32}, %out : tensor<128x!tt.ptr<f32>, #blocked0>) {
+    // CHECK: llvm.bitcast %arg0 : !llvm.ptr<array<128 x f32>> to !llvm.ptr<f32>
+    // CHECK: llvm.getelementptr
+    // CHECK: llvm.load %{{.*}} : !llvm.ptr<f32>
+    // CHECK-NOT: ld.global
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32, #blocked0>
+    %1 = tt.splat %table : (!tt.ptr<f32, 101>) -> tensor<128x!tt.ptr<f32, 101>, #blocked0>
+    %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f32, 101>, #blocked0>, tensor<128xi32, #blocked0>
+    %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32, #blocked0>
+    tt.store %out, %3 : tensor<128xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [8], threadsPerWarp = [32], warpsPerCTA = [1], order = [0]}>
 module attributes {"triton_gpu.num-warps" = 1 : i32} {
   // CHECK-LABEL: vectorized_load_f16
@@ -55,6 +75,24 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: load_store_l2_cache_hint
+  tt.func @load_store_l2_cache_hint(%a_ptr_init : tensor<256x!tt.ptr<f32>, #blocked0>, %b_ptr_init : tensor<256x!tt.ptr<f32>, #blocked0>, %cst : tensor<256xi1, #blocked0>, %cst_0 : tensor<256xf32, #blocked0>) {
+    // CHECK: createpolicy.fractional.L2::evict_last.b64 $0, 1.0;
+    // CHECK: ld.global.L2::cache_hint.b32 { $0 }, [ $1 + 0 ], $2;
+    // CHECK: ld.global.L2::cache_hint.b32 { $0 }, [ $1 + 0 ], $2;
+    %1 = tt.load %a_ptr_init, %cst, %cst_0 {cache = 1 : i32, evict = 5 : i32, isVolatile = false} : tensor<256xf32, #blocked0>
+    // CHECK: createpolicy.fractional.L2::evict_first.b64 $0, 1.0;
+    // CHECK: st.global.L2::cache_hint.b32 [ $1 + 0 ], { $0 }, $2;
+    // CHECK: st.global.L2::cache_hint.b32 [ $1 + 0 ], { $0 }, $2;
+    tt.store %b_ptr_init, %1, %cst {cache = 1 : i32, evict = 4 : i32} : tensor<256xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
 // TODO: masked load with vectorization is pending on TODO
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [8], order = [0]}>
 module attributes {"triton_gpu.num-warps" = 4 : i32} {
@@ -81,6 +119,27 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: masked_load_uniform_mask
+  tt.func @masked_load_uniform_mask(%a_ptr_init : tensor<256x!tt.ptr<f32>, #blocked0>, %flag : i1) {
+    %mask = tt.splat %flag : (i1) -> tensor<256xi1, #blocked0>
+    %other = arith.constant dense<1.000000e+00> : tensor<256xf32, #blocked0>
+    // A uniform mask branches around the loads, which move nothing into
+    // their masked-off registers
+    // CHECK: llvm.cond_br %{{.*}}, ^bb{{[0-9]+}}, ^bb{{[0-9]+}}(
+    // CHECK: ld.global.b32
+    // CHECK-NOT: mov.u32
+    // CHECK: ld.global.b32
+    // CHECK-NOT: mov.u32
+    // CHECK: llvm.br
+    %1 = tt.load %a_ptr_init, %mask, %other {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<256xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [2], order = [0]}>
 module attributes {"triton_gpu.num-warps" = 2 : i32} {
   // CHECK-LABEL: global_load_store_no_vec
@@ -353,6 +412,44 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: packed_truncf
+  tt.func @packed_truncf(%arg0 : tensor<256xf32,#blocked0>) {
+    // CHECK: cvt.rn.f16x2.f32 $0, $2, $1;
+    // CHECK-NOT: cvt.rn.f16x2.f32
+    %0 = arith.truncf %arg0 : tensor<256xf32,#blocked0> to tensor<256xf16,#blocked0>
+    // CHECK: cvt.rn.bf16x2.f32 $0, $2, $1;
+    // CHECK-NOT: cvt.rn.bf16x2.f32
+    %1 = arith.truncf %arg0 : tensor<256xf32,#blocked0> to tensor<256xbf16,#blocked0>
+    // CHECK: llvm.shl
+    // CHECK: llvm.and
+    // CHECK-NOT: cvt.f32.bf16
+    %2 = arith.extf %1 : tensor<256xbf16,#blocked0> to tensor<256xf32,#blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: packed_int8_to_fp16
+  tt.func @packed_int8_to_fp16(%arg0 : tensor<512xi8,#blocked0>) {
+    // CHECK: xor.b32 a, $2, 0x80808080;
+    // CHECK: prmt.b32 b0, a, 0x64646464, 0x5150;
+    // CHECK: sub.f16x2 $0, b0, bias;
+    // CHECK-NOT: llvm.sitofp
+    %0 = arith.sitofp %arg0 : tensor<512xi8,#blocked0> to tensor<512xf16,#blocked0>
+    // CHECK: prmt.b32 b0, $2, 0x64646464, 0x5150;
+    // CHECK-NOT: llvm.uitofp
+    %1 = arith.uitofp %arg0 : tensor<512xi8,#blocked0> to tensor<512xf16,#blocked0>
+    tt.return
+  }
+}
+
+// -----
+
 module attributes {"triton_gpu.num-warps" = 4 : i32} {
   // CHECK-LABEL: basic_program_id
   tt.func @basic_program_id() {
@@ -521,6 +618,54 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#A = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 4, order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: block_ptr_insert_slice_async
+  tt.func @block_ptr_insert_slice_async(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg1: i64 {tt.divisibility = 16 : i32}, %arg2: i64 {tt.divisibility = 16 : i32}) {
+    %c0_i32 = arith.constant 0 : i32
+    %c1_i64 = arith.constant 1 : i64
+    %ptr = tt.make_tensor_ptr %arg0, [%arg1, %arg2], [%arg2, %c1_i64], [%c0_i32, %c0_i32] {order = array<i32: 1, 0>} : !tt.ptr<tensor<16x64xf16>>
+    %mask = arith.constant dense<true> : tensor<16x64xi1, #AL>
+    %tensor = triton_gpu.alloc_tensor : tensor<2x16x64xf16, #A>
+    %index = arith.constant 1 : i32
+    // The bounds of the columns are checked, the copies are 16 bytes
+    // CHECK: llvm.icmp "slt"
+    // CHECK: llvm.inline_asm has_side_effects asm_dialect = att
+    // CHECK-SAME: cp.async.cg.shared.global [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x10, ${{.*}}
+    // CHECK-NOT: cp.async.cg.shared.global
+    // CHECK: cp.async.commit_group
+    %a = triton_gpu.insert_slice_async %ptr, %tensor, %index, %mask {axis = 0 : i32, boundaryCheck = array<i32: 1>, cache = 1 : i32, evict = 1 : i32, isVolatile = false} : !tt.ptr<tensor<16x64xf16>>, tensor<16x64xi1, #AL> -> tensor<2x16x64xf16, #A>
+    triton_gpu.async_commit_group
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: block_ptr_load_store
+  tt.func @block_ptr_load_store(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg1: i64 {tt.divisibility = 16 : i32}, %arg2: i64 {tt.divisibility = 16 : i32}) {
+    %c0_i32 = arith.constant 0 : i32
+    %c64_i32 = arith.constant 64 : i32
+    %c1_i64 = arith.constant 1 : i64
+    %0 = tt.make_tensor_ptr %arg0, [%arg1, %arg2], [%arg2, %c1_i64], [%c0_i32, %c0_i32] {order = array<i32: 1, 0>} : !tt.ptr<tensor<16x64xf16>>
+    // CHECK: llvm.icmp "slt"
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: ld.global.v4.b32
+    %1 = tt.load %0 {boundaryCheck = array<i32: 1>, cache = 1 : i32, evict = 1 : i32, isVolatile = false, padding = 1 : i32} : !tt.ptr<tensor<16x64xf16>> -> tensor<16x64xf16, #blocked>
+    // CHECK: llvm.add
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: st.global.v4.b32
+    %2 = tt.advance %0, [%c0_i32, %c64_i32] : !tt.ptr<tensor<16x64xf16>>
+    tt.store %2, %1 {boundaryCheck = array<i32: 1>, cache = 1 : i32, evict = 1 : i32} : !tt.ptr<tensor<16x64xf16>>, tensor<16x64xf16, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
 #block0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [4], warpsPerCTA = [4], order = [0]}>
 #block1 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [8], warpsPerCTA = [4], order = [0]}>
 #block2 = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [4, 1], warpsPerCTA = [4, 1], order = [1, 0]}>
@@ -653,6 +798,34 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // The 64 elements are replicated across warps: the mask of the redundant
+  // threads is computed once per function, with shifts instead of divisions.
+  // CHECK-LABEL: store_shared_mask
+  tt.func @store_shared_mask(%ptrs: tensor<64x!tt.ptr<f32>, #blocked0>, %vals: tensor<64xf32, #blocked0>) {
+    // CHECK-NOT: llvm.udiv
+    // CHECK: llvm.lshr
+    // CHECK: llvm.icmp "slt"
+    // CHECK: st.global.b32
+    // CHECK: st.global.b32
+    tt.store %ptrs, %vals : tensor<64xf32, #blocked0>
+    tt.store %ptrs, %vals : tensor<64xf32, #blocked0>
+    tt.return
+  }
+
+  // Every function gets its own cached values
+  // CHECK-LABEL: store_shared_mask_callee
+  tt.func @store_shared_mask_callee(%ptrs: tensor<64x!tt.ptr<f32>, #blocked0>, %vals: tensor<64xf32, #blocked0>) {
+    // CHECK: llvm.icmp "slt"
+    // CHECK: st.global.b32
+    tt.store %ptrs, %vals : tensor<64xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0]}>
 #blocked1 = #triton_gpu.blocked<{sizePerThread = [4, 1], threadsPerWarp = [4, 8], warpsPerCTA = [1, 1], order = [0, 1]}>
 module attributes {"triton_gpu.num-warps" = 1 : i32} {
@@ -752,6 +925,21 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [4, 8], warpsPerCTA = [1, 1], order = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [4, 8], warpsPerCTA = [1, 1], order = [0, 1]}>
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: convert_layout_blocked_blocked_warp_local
+  tt.func @convert_layout_blocked_blocked_warp_local(%arg0: tensor<8x16xf32, #blocked0>) {
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK-COUNT-4: shfl.sync.idx.b32
+    // CHECK-NOT: llvm.store
+    %0 = triton_gpu.convert_layout %arg0 : (tensor<8x16xf32, #blocked0>) -> tensor<8x16xf32, #blocked1>
+    tt.return
+  }
+}
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0]}>
 #shared0 = #triton_gpu.shared<{vec = 1, perPhase=2, maxPhase=8 ,order = [1, 0]}>
 #mma0 = #triton_gpu.mma<{versionMajor=2, warpsPerCTA=[1,1]}>
@@ -780,6 +968,77 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
   }
 }
 
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0]}>
+#shared0 = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#mma0 = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [1, 1]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx = 0, parent = #mma0, kWidth = 2}>
+#dot_operand_b = #triton_gpu.dot_op<{opIdx = 1, parent = #mma0, kWidth = 2}>
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: convert_sparse_dot
+  tt.func @convert_sparse_dot(%A: tensor<16x16xf16, #dot_operand_a>, %B: tensor<32x16xf16, #dot_operand_b>, %meta: tensor<16x2xi16, #blocked0>) {
+    %M = triton_gpu.convert_layout %meta : (tensor<16x2xi16, #blocked0>) -> tensor<16x2xi16, #shared0>
+    %cst0 = arith.constant dense<0.000000e+00> : tensor<16x16xf32, #mma0>
+    // The 32 bits of metadata of a row are read at once, then each tile of
+    // 32 columns is one mma.sp per 8 columns of the result
+    // CHECK: llvm.load
+    // CHECK-SAME: !llvm.ptr<i32, 3>
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: mma.sp.sync.aligned.m16n8k32.row.col.f32.f16.f16.f32
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: mma.sp.sync.aligned.m16n8k32.row.col.f32.f16.f16.f32
+    // CHECK-NOT: mma.sp.sync
+    %D = tt.sparse_dot %A, %B, %cst0, %M : tensor<16x16xf16, #dot_operand_a> * tensor<32x16xf16, #dot_operand_b> meta tensor<16x2xi16, #shared0> -> tensor<16x16xf32, #mma0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#shared0 = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [1, 0]}>
+#shared1 = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#mma0 = #triton_gpu.mma<{versionMajor = 3, warpsPerCTA = [4, 1]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx = 0, parent = #mma0, kWidth = 2}>
+#dot_operand_b = #triton_gpu.dot_op<{opIdx = 1, parent = #mma0, kWidth = 2}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: convert_dot_wgmma
+  tt.func @convert_dot_wgmma(%A: tensor<64x16xf16, #blocked0>, %B: tensor<16x64xf16, #blocked0>) {
+    %AA = triton_gpu.convert_layout %A : (tensor<64x16xf16, #blocked0>) -> tensor<64x16xf16, #shared0>
+    %BB = triton_gpu.convert_layout %B : (tensor<16x64xf16, #blocked0>) -> tensor<16x64xf16, #shared0>
+    // $b is read in shared memory
+    // CHECK: ldmatrix.sync.aligned.m8n8.x4
+    // CHECK-NOT: ldmatrix
+    // CHECK: fence.proxy.async.shared::cta
+    // CHECK: nvvm.barrier0
+    // CHECK: wgmma.fence.sync.aligned
+    // CHECK: wgmma.mma_async.sync.aligned.m64n64k16.f32.f16.f16
+    // CHECK-NOT: wgmma.mma_async
+    // CHECK: wgmma.commit_group.sync.aligned
+    // CHECK: wgmma.wait_group.sync.aligned 0
+    %AA_DOT = triton_gpu.convert_layout %AA : (tensor<64x16xf16, #shared0>) -> tensor<64x16xf16, #dot_operand_a>
+    %BB_DOT = triton_gpu.convert_layout %BB : (tensor<16x64xf16, #shared0>) -> tensor<16x64xf16, #dot_operand_b>
+    %cst0 = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #mma0>
+    %D = tt.dot %AA_DOT, %BB_DOT, %cst0 {allowTF32 = true} : tensor<64x16xf16, #dot_operand_a> * tensor<16x64xf16, #dot_operand_b> -> tensor<64x64xf32, #mma0>
+    tt.return
+  }
+
+  // An unswizzled $b falls back to mma.sync with the same layouts
+  // CHECK-LABEL: convert_dot_wgmma_fallback
+  tt.func @convert_dot_wgmma_fallback(%A: tensor<64x16xf16, #blocked0>, %B: tensor<16x64xf16, #blocked0>) {
+    %AA = triton_gpu.convert_layout %A : (tensor<64x16xf16, #blocked0>) -> tensor<64x16xf16, #shared0>
+    %BB = triton_gpu.convert_layout %B : (tensor<16x64xf16, #blocked0>) -> tensor<16x64xf16, #shared1>
+    // CHECK-NOT: wgmma
+    // CHECK: mma.sync.aligned.m16n8k16.row.col.f32.f16.f16.f32
+    %AA_DOT = triton_gpu.convert_layout %AA : (tensor<64x16xf16, #shared0>) -> tensor<64x16xf16, #dot_operand_a>
+    %BB_DOT = triton_gpu.convert_layout %BB : (tensor<16x64xf16, #shared1>) -> tensor<16x64xf16, #dot_operand_b>
+    %cst0 = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #mma0>
+    %D = tt.dot %AA_DOT, %BB_DOT, %cst0 {allowTF32 = true} : tensor<64x16xf16, #dot_operand_a> * tensor<16x64xf16, #dot_operand_b> -> tensor<64x64xf32, #mma0>
+    tt.return
+  }
+}
+
 // TODO: problems in MLIR's parser on slice layout
 // #blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0]}>
 // module attributes {"triton_gpu.num-warps" = 1 : i32} {
@@ -811,6 +1070,58 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
 
 // -----
 
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 2}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: convert_layout_mma_to_dot_f16
+  tt.func @convert_layout_mma_to_dot_f16(%arg0: tensor<64x16xf16, #mma>) {
+    // CHECK-NOT: shfl.sync
+    // CHECK-NOT: llvm.store
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK: llvm.return
+    %0 = triton_gpu.convert_layout %arg0 : (tensor<64x16xf16, #mma>) -> tensor<64x16xf16, #dot_operand_a>
+    tt.return
+  }
+}
+
+// -----
+
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 1}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // Each of the 8 registers of $a is selected from two shuffles within the
+  // quad of threads.
+  // CHECK-LABEL: convert_layout_mma_to_dot_f32
+  tt.func @convert_layout_mma_to_dot_f32(%arg0: tensor<64x16xf32, #mma>) {
+    // CHECK-COUNT-16: shfl.sync.idx.b32
+    // CHECK-NOT: shfl.sync
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK: llvm.return
+    %0 = triton_gpu.convert_layout %arg0 : (tensor<64x16xf32, #mma>) -> tensor<64x16xf32, #dot_operand_a>
+    tt.return
+  }
+}
+
+// -----
+
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 4}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // Each of the 4 registers of $a gathers two halves of words shuffled
+  // within the quad of threads.
+  // CHECK-LABEL: convert_layout_mma_to_dot_i8
+  tt.func @convert_layout_mma_to_dot_i8(%arg0: tensor<64x32xi8, #mma>) {
+    // CHECK-COUNT-8: shfl.sync.idx.b32
+    // CHECK-NOT: shfl.sync
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK: llvm.return
+    %0 = triton_gpu.convert_layout %arg0 : (tensor<64x32xi8, #mma>) -> tensor<64x32xi8, #dot_operand_a>
+    tt.return
+  }
+}
+
+// -----
+
 #blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [1, 4], order = [1, 0]}>
 #mma = #triton_gpu.mma<{versionMajor = 1, versionMinor = 3, warpsPerCTA = [2, 2]}>
 module attributes {"triton_gpu.num-warps" = 1 : i32} {
@@ -849,6 +1160,41 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
   }
 }
 
+// -----
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0]}>
+#shared0 = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: convert_layout_blocked_shared_unswizzled
+  tt.func @convert_layout_blocked_shared_unswizzled(%arg0: tensor<16x16xf32, #blocked0>) {
+    // The rows of an unswizzled layout are contiguous whatever its vec
+    // CHECK-NOT: !llvm.ptr<vector<1xf32>, 3>
+    // CHECK: llvm.store
+    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
+    // CHECK: llvm.store
+    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
+    %0 = triton_gpu.convert_layout %arg0 : (tensor<16x16xf32, #blocked0>) -> tensor<16x16xf32, #shared0>
+    tt.return
+  }
+}
+
+// -----
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0]}>
+#shared0 = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: convert_layout_shared_blocked
+  tt.func @convert_layout_shared_blocked(%index: i32) {
+    // The tile of a buffer is read with the vectors of the blocked layout
+    // CHECK: llvm.load
+    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
+    // CHECK: llvm.load
+    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
+    %buf = triton_gpu.alloc_tensor : tensor<2x16x16xf32, #shared0>
+    %tile = triton_gpu.extract_slice %buf[%index, 0, 0] [1, 16, 16] [1, 1, 1] : tensor<2x16x16xf32, #shared0> to tensor<16x16xf32, #shared0>
+    %0 = triton_gpu.convert_layout %tile : (tensor<16x16xf32, #shared0>) -> tensor<16x16xf32, #blocked0>
+    tt.return
+  }
+}
+
 // -----
 
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [1], order = [0]}>
@@ -919,6 +1265,22 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+#shared = #triton_gpu.shared<{vec = 16, perPhase = 1, maxPhase = 8, order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [2, 2]}>
+#dot_operand_b = #triton_gpu.dot_op<{opIdx=1, parent=#mma, kWidth=4}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: mmav2_int8_transposed_b
+  tt.func @mmav2_int8_transposed_b(%b:tensor<64x64xi8, #shared>) {
+    // The bytes of the N-major operand are read one by one and packed
+    // CHECK-NOT: ldmatrix
+    // CHECK: prmt.b32
+    %b_mat = triton_gpu.convert_layout %b : (tensor<64x64xi8, #shared>) -> tensor<64x64xi8, #dot_operand_b>
+    tt.return
+  }
+}
+
+// -----
+
 #blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [1, 4], order = [1, 0]}>
 #shared0 = #triton_gpu.shared<{vec = 4, perPhase = 1, maxPhase = 8, order = [1, 0]}>
 #shared1 = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 4, order = [1, 0]}>
@@ -966,6 +1328,31 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [1, 4], order = [1, 0]}>
+#shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx=0, parent=#blocked}>
+#dot_operand_b = #triton_gpu.dot_op<{opIdx=1, parent=#blocked}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: matmul_fmadot_f16_acc
+  tt.func @matmul_fmadot_f16_acc(%ptr:!tt.ptr<f16> {tt.divisibility = 16 : i32},
+  %a:tensor<32x16xf16, #shared>, %b:tensor<16x32xf16, #shared>) {
+    %cst = arith.constant dense<0.000000e+00> : tensor<32x32xf16, #blocked>
+    // The 4 elements of a thread along N are contiguous in B
+    // CHECK: llvm.load {{.*}} : !llvm.ptr<vector<4xf16>, 3>
+    %a_mat = triton_gpu.convert_layout %a : (tensor<32x16xf16, #shared>) -> tensor<32x16xf16, #dot_operand_a>
+    %b_mat = triton_gpu.convert_layout %b : (tensor<16x32xf16, #shared>) -> tensor<16x32xf16, #dot_operand_b>
+    // CHECK: llvm.intr.fmuladd{{.*}} -> vector<2xf16>
+    // CHECK-NOT: llvm.intr.fmuladd{{.*}} -> f16
+    %28 = tt.dot %a_mat, %b_mat, %cst {allowTF32 = false, transA = false, transB = false} : tensor<32x16xf16, #dot_operand_a> * tensor<16x32xf16, #dot_operand_b> -> tensor<32x32xf16, #blocked>
+    %30 = tt.splat %ptr : (!tt.ptr<f16>) -> tensor<32x1x!tt.ptr<f16>, #blocked>
+    %36 = tt.broadcast %30 : (tensor<32x1x!tt.ptr<f16>, #blocked>) -> tensor<32x32x!tt.ptr<f16>, #blocked>
+    tt.store %36, %28 : tensor<32x32xf16, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
 #mma = #triton_gpu.mma<{versionMajor=2, warpsPerCTA=[2, 2]}>
 #shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
 #blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [1, 4], order = [1, 0]}>
@@ -1009,11 +1396,45 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 module attributes {"triton_gpu.num-warps" = 4 : i32} {
   // CHECK-LABEL: atomic_add_f32
   tt.func @atomic_add_f32(%arg0 : tensor<256x!tt.ptr<f32>, #blocked0>, %arg1 : tensor<256xi1, #blocked0>, %arg2 : tensor<256xf32, #blocked0>) {
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: @$2 red.global.gpu.add.f32
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: @$2 red.global.gpu.add.f32
+    %0 = "tt.atomic_rmw" (%arg0, %arg2, %arg1) {atomic_rmw_op = 5 : i32} : (tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xf32, #blocked0>, tensor<256xi1, #blocked0>) -> tensor<256xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: atomic_add_f32_result
+  tt.func @atomic_add_f32_result(%arg0 : tensor<256x!tt.ptr<f32>, #blocked0>, %arg1 : tensor<256xi1, #blocked0>, %arg2 : tensor<256xf32, #blocked0>, %arg3 : tensor<256x!tt.ptr<f32>, #blocked0>) {
     // CHECK: llvm.inline_asm
     // CHECK-SAME: @$3 atom.global.gpu.add.f32
     // CHECK: llvm.inline_asm
     // CHECK-SAME: @$3 atom.global.gpu.add.f32
     %0 = "tt.atomic_rmw" (%arg0, %arg2, %arg1) {atomic_rmw_op = 5 : i32} : (tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xf32, #blocked0>, tensor<256xi1, #blocked0>) -> tensor<256xf32, #blocked0>
+    tt.store %arg3, %0 : tensor<256xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: atomic_add_f32_same_address
+  tt.func @atomic_add_f32_same_address(%arg0 : !tt.ptr<f32>, %arg1 : tensor<512xf32, #blocked0>) {
+    %mask = arith.constant dense<true> : tensor<512xi1, #blocked0>
+    %ptrs = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<512x!tt.ptr<f32>, #blocked0>
+    // The elements of a thread are summed before a single atomic
+    // CHECK-COUNT-3: llvm.fadd
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: @$2 red.global.gpu.add.f32
+    // CHECK-NOT: red.global
+    %0 = "tt.atomic_rmw" (%ptrs, %arg1, %mask) {atomic_rmw_op = 5 : i32} : (tensor<512x!tt.ptr<f32>, #blocked0>, tensor<512xf32, #blocked0>, tensor<512xi1, #blocked0>) -> tensor<512xf32, #blocked0>
     tt.return
   }
 }
@@ -1026,7 +1447,7 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
     // CHECK: llvm.icmp "eq"
     // CHECK: llvm.inline_asm
     // CHECK: llvm.inline_asm
-    // CHECK-SAME: @$3 atom.global.gpu.add.f32
+    // CHECK-SAME: @$2 red.global.gpu.add.f32
     %0 = "tt.atomic_rmw" (%arg0, %arg2, %arg1) {atomic_rmw_op = 5 : i32} : (!tt.ptr<f32>, f32, i1) -> f32
     tt.return
   }
@@ -1034,6 +1455,73 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // The accesses ordered at the system scope, e.g. to the flags of a peer
+  // device
+  // CHECK-LABEL: system_scope_accesses
+  tt.func @system_scope_accesses(%flag : !tt.ptr<i32>, %data : !tt.ptr<f32>, %v : f32) {
+    %c0 = arith.constant 0 : i32
+    %c1 = arith.constant 1 : i32
+    %true = arith.constant true
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: st.release.sys.global.b32
+    tt.store %data, %v {cache = 1 : i32, evict = 1 : i32, sem = 3 : i32, scope = 3 : i32} : f32
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: membar.sys
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: atom.global.acq_rel.sys.cas.b32
+    %0 = "tt.atomic_cas" (%flag, %c0, %c1) {sem = 4 : i32, scope = 3 : i32} : (!tt.ptr<i32>, i32, i32) -> i32
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: membar.sys
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: atom.global.release.sys.exch.b32
+    %1 = "tt.atomic_rmw" (%flag, %c0, %true) {atomic_rmw_op = 10 : i32, sem = 3 : i32, scope = 3 : i32} : (!tt.ptr<i32>, i32, i1) -> i32
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: ld.acquire.sys.global.b32
+    %2 = tt.load %flag {cache = 1 : i32, evict = 1 : i32, isVolatile = false, sem = 2 : i32, scope = 3 : i32} : i32
+    tt.return
+  }
+}
+
+// -----
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // Thread 0 polls the semaphore with a growing sleep, then all the threads
+  // meet at the barrier
+  // CHECK-LABEL: semaphore_wait
+  tt.func @semaphore_wait(%sem : !tt.ptr<i32>, %v : i32) {
+    // CHECK: llvm.cond_br %{{.*}}, ^[[POLL:[^(]*]](%{{.*}} : i32), ^[[TAIL:[^ ]*]]{{$}}
+    // CHECK: ^[[POLL]](%{{.*}}: i32):
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: ld.acquire.gpu.global.b32
+    // CHECK: llvm.cond_br %{{.*}}, ^[[TAIL]], ^[[SLEEP:[^ ]*]]{{$}}
+    // CHECK: ^[[SLEEP]]:
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: nanosleep.u32
+    // CHECK: llvm.intr.umin
+    // CHECK: llvm.br ^[[POLL]]
+    // CHECK: ^[[TAIL]]:
+    // CHECK: nvvm.barrier0
+    tt.semaphore_wait %sem, %v {sem = 2 : i32, scope = 1 : i32} : !tt.ptr<i32>
+    tt.return
+  }
+
+  // CHECK-LABEL: semaphore_signal
+  tt.func @semaphore_signal(%sem : !tt.ptr<i32>, %v : i32) {
+    // CHECK: nvvm.barrier0
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: @$2 st.release.gpu.global.b32
+    tt.semaphore_signal %sem, %v {add = false, sem = 3 : i32, scope = 1 : i32} : !tt.ptr<i32>
+    // CHECK: nvvm.barrier0
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: @$2 red.global.release.sys.add.s32
+    tt.semaphore_signal %sem, %v {add = true, sem = 3 : i32, scope = 3 : i32} : !tt.ptr<i32>
+    tt.return
+  }
+}
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
 module attributes {"triton_gpu.num-warps" = 4 : i32} {
   // CHECK-LABEL: store_f32
@@ -1145,3 +1633,219 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
       tt.return
   }
 }
+
+// -----
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: scan_1d
+  tt.func @scan_1d(%arg0: tensor<128xf32, #blocked0>) {
+    // CHECK-COUNT-6: shfl.sync.up.b32
+    // CHECK: st.shared.b32
+    // CHECK: nvvm.barrier0
+    // CHECK-COUNT-4: llvm.load
+    %0 = "tt.scan"(%arg0) ({
+    ^bb0(%arg1: f32, %arg2: f32):
+      %1 = arith.addf %arg1, %arg2 : f32
+      tt.scan.return %1 : f32
+    }) {axis = 0 : i32} : (tensor<128xf32, #blocked0>) -> tensor<128xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: reduce_redux_sync
+  tt.func @reduce_redux_sync(%arg0 : tensor<32x32xi32, #blocked>) {
+    // CHECK: redux.sync.max.s32
+    // CHECK-NOT: shfl.sync
+    %0 = "tt.reduce" (%arg0) ({
+    ^bb0(%arg1: i32, %arg2: i32):
+      %max = arith.maxsi %arg1, %arg2 : i32
+      tt.reduce.return %max : i32
+    }) {axis = 1 : i32} : (tensor<32x32xi32, #blocked>) -> tensor<32xi32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: reduce_packed_f16_shuffle
+  tt.func @reduce_packed_f16_shuffle(%arg0 : tensor<32x32xf16, #blocked>) {
+    // CHECK: llvm.bitcast %{{.*}} : vector<2xf16> to i32
+    // CHECK: shfl.sync.bfly.b32
+    %0 = "tt.reduce" (%arg0) ({
+    ^bb0(%arg1: f16, %arg2: f16):
+      %add = arith.addf %arg1, %arg2 : f16
+      tt.reduce.return %add : f16
+    }) {axis = 1 : i32} : (tensor<32x32xf16, #blocked>) -> tensor<32xf16, #triton_gpu.slice<{dim = 1, parent = #blocked}>>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // Both operands are exchanged by the same shuffle rounds and the rows
+  // never leave their warp
+  // CHECK-LABEL: reduce_argmax_warp_sync
+  tt.func @reduce_argmax_warp_sync(%arg0 : tensor<16x32xf16, #blocked>, %arg1 : tensor<16x32xi32, #blocked>) {
+    // CHECK: shfl.sync.bfly.b32
+    // CHECK-NOT: st.shared
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK: llvm.return
+    %0:2 = "tt.reduce" (%arg0, %arg1) ({
+    ^bb0(%arg2: f16, %arg3: i32, %arg4: f16, %arg5: i32):
+      %cmp = arith.cmpf ogt, %arg2, %arg4 : f16
+      %v = arith.select %cmp, %arg2, %arg4 : f16
+      %i = arith.select %cmp, %arg3, %arg5 : i32
+      tt.reduce.return %v, %i : f16, i32
+    }) {axis = 1 : i32} : (tensor<16x32xf16, #blocked>, tensor<16x32xi32, #blocked>) -> (tensor<16xf16, #triton_gpu.slice<{dim = 1, parent = #blocked}>>, tensor<16xi32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>)
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // The reduction axis is not the fastest one: the accumulators of each
+  // thread are combined with a tree in shared memory, without shuffles
+  // CHECK-LABEL: reduce_basic_strided_axis
+  tt.func @reduce_basic_strided_axis(%arg0 : tensor<32x32xf32, #blocked>) {
+    // CHECK-NOT: shfl.sync
+    // CHECK: llvm.store %{{.*}}, %{{.*}} : !llvm.ptr<f32, 3>
+    // CHECK: nvvm.barrier0
+    // CHECK: llvm.load %{{.*}} : !llvm.ptr<f32, 3>
+    // CHECK-NOT: shfl.sync
+    // CHECK: llvm.return
+    %0 = "tt.reduce" (%arg0) ({
+    ^bb0(%arg1: f32, %arg2: f32):
+      %add = arith.addf %arg1, %arg2 : f32
+      tt.reduce.return %add : f32
+    }) {axis = 0 : i32} : (tensor<32x32xf32, #blocked>) -> tensor<32xf32, #triton_gpu.slice<{dim = 0, parent = #blocked}>>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 2], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // Each row is sorted within a warp, in registers and with shuffles
+  // CHECK-LABEL: sort_within_warp
+  tt.func @sort_within_warp(%arg0 : tensor<4x64xf32, #blocked>, %arg1 : tensor<4x64xi32, #blocked>) {
+    // CHECK: llvm.fcmp "olt"
+    // CHECK: shfl.sync.bfly.b32
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK: llvm.return
+    %0:2 = tt.sort %arg0, %arg1 {axis = 1 : i32, descending = true} : tensor<4x64xf32, #blocked>, tensor<4x64xi32, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 2], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // Unsigned integers are compared as unsigned
+  // CHECK-LABEL: sort_unsigned
+  tt.func @sort_unsigned(%arg0 : tensor<4x64xi32, #blocked>) {
+    // CHECK: llvm.icmp "ult"
+    // CHECK: llvm.return
+    %0 = tt.sort %arg0 {axis = 1 : i32, descending = false, isUnsigned} : tensor<4x64xi32, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 2], threadsPerWarp = [1, 32], warpsPerCTA = [1, 4], order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // The rows span several warps, which merge their elements and gather the
+  // top-k in shared memory
+  // CHECK-LABEL: topk_across_warps
+  tt.func @topk_across_warps(%arg0 : tensor<4x256xf32, #blocked>) {
+    // CHECK: shfl.sync.bfly.b32
+    // CHECK: llvm.store
+    // CHECK: nvvm.barrier0
+    // CHECK: llvm.load
+    %0 = tt.topk %arg0 {axis = 1 : i32, k = 8 : i32} : tensor<4x256xf32, #blocked> -> tensor<4x8xf32, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // The bins are cleared, counted in shared memory and read back
+  // CHECK-LABEL: histogram
+  tt.func @histogram(%arg0 : tensor<512xi32, #blocked>) {
+    // CHECK: llvm.store
+    // CHECK: nvvm.barrier0
+    // CHECK-COUNT-4: red.shared.add.u32
+    // CHECK: nvvm.barrier0
+    // CHECK: llvm.load
+    %0 = tt.histogram %arg0 : tensor<512xi32, #blocked> -> tensor<64xi32, #blocked1>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [32, 1], warpsPerCTA = [1, 4], order = [0, 1]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // A transposed blocked layout relabels the registers of each thread
+  // CHECK-LABEL: trans_blocked
+  tt.func @trans_blocked(%arg0 : tensor<32x16xf32, #blocked0>) {
+    // CHECK-NOT: llvm.store
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK: llvm.return
+    %0 = tt.trans %arg0 : (tensor<32x16xf32, #blocked0>) -> tensor<16x32xf32, #blocked1>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // The four i8 of a group share a 32-bit register
+  // CHECK-LABEL: elementwise_inline_asm_packed
+  tt.func @elementwise_inline_asm_packed(%arg0 : tensor<512xi8, #blocked>) {
+    // CHECK: llvm.bitcast %{{.*}} : vector<4xi8> to i32
+    // CHECK: llvm.inline_asm {{.*}} "and.b32 $0, $1, 0x0f0f0f0f;", "=r,r" %{{.*}} : (i32) -> i32
+    // CHECK-NOT: llvm.inline_asm
+    // CHECK: llvm.bitcast %{{.*}} : i32 to vector<4xi8>
+    %0 = tt.elementwise_inline_asm "and.b32 $0, $1, 0x0f0f0f0f;" {constraints = "=r,r", packed_element = 4 : i32, pure = true} %arg0 : tensor<512xi8, #blocked> -> tensor<512xi8, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // Both halves of each product come from one 64-bit multiply
+  // CHECK-LABEL: philox_one_round
+  tt.func @philox_one_round(%c0 : tensor<128xi32, #blocked>, %c1 : tensor<128xi32, #blocked>, %k0 : tensor<128xi32, #blocked>, %k1 : tensor<128xi32, #blocked>) {
+    // CHECK: llvm.zext %{{.*}} : i32 to i64
+    // CHECK: llvm.mul %{{.*}} : i64
+    // CHECK: llvm.lshr
+    // CHECK: llvm.trunc %{{.*}} : i64 to i32
+    // CHECK: llvm.trunc %{{.*}} : i64 to i32
+    // CHECK: llvm.zext %{{.*}} : i32 to i64
+    // CHECK: llvm.mul %{{.*}} : i64
+    // CHECK-NOT: llvm.mul
+    // CHECK: llvm.xor
+    %0:4 = tt.philox %c0, %c1, %c1, %c1, %k0, %k1 {n_rounds = 1 : i32} : tensor<128xi32, #blocked>
+    tt.return
+  }
+}
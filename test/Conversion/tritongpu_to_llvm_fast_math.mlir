@@ -0,0 +1,41 @@
+// RUN: triton-opt %s -split-input-file --convert-triton-gpu-to-llvm="fast-math=true" | FileCheck %s
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: fast_math_approx
+  tt.func @fast_math_approx(%arg0 : tensor<128xf32,#blocked0>) {
+    // CHECK: lg2.approx.f32
+    // CHECK: llvm.fmul {{.*}} {fastmathFlags = #llvm.fastmath<contract, afn, reassoc>} : f32
+    %0 = math.log %arg0 : tensor<128xf32,#blocked0>
+    // CHECK: sin.approx.f32
+    %1 = math.sin %arg0 : tensor<128xf32,#blocked0>
+    // CHECK: sqrt.approx.f32
+    %2 = math.sqrt %arg0 : tensor<128xf32,#blocked0>
+    // CHECK: tanh.approx.f32
+    // CHECK-NOT: __nv_tanhf
+    %3 = tt.pure_extern_elementwise %arg0 {libname = "libdevice", libpath = "", symbol = "__nv_tanhf"} : (tensor<128xf32,#blocked0>) -> tensor<128xf32,#blocked0>
+    // CHECK: rcp.approx.f32
+    %cst = arith.constant dense<1.000000e+00> : tensor<128xf32,#blocked0>
+    %4 = arith.divf %cst, %arg0 : tensor<128xf32,#blocked0>
+    // CHECK: div.full.f32
+    %5 = arith.divf %arg0, %4 : tensor<128xf32,#blocked0>
+    // CHECK: llvm.fadd {{.*}} {fastmathFlags = #llvm.fastmath<contract, afn, reassoc>} : f32
+    %6 = arith.addf %arg0, %5 : tensor<128xf32,#blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // f64 math and libdevice functions without an approximation are untouched
+  // CHECK-LABEL: fast_math_precise
+  tt.func @fast_math_precise(%arg0 : tensor<128xf64,#blocked0>, %arg1 : tensor<128xf32,#blocked0>) {
+    // CHECK-NOT: lg2.approx
+    %0 = math.log %arg0 : tensor<128xf64,#blocked0>
+    // CHECK: llvm.call @__nv_erff
+    %1 = tt.pure_extern_elementwise %arg1 {libname = "libdevice", libpath = "", symbol = "__nv_erff"} : (tensor<128xf32,#blocked0>) -> tensor<128xf32,#blocked0>
+    tt.return
+  }
+}
@@ -0,0 +1,33 @@
+// RUN: triton-opt %s -split-input-file --convert-triton-gpu-to-llvm | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.print-buffer"} {
+  // CHECK: llvm.mlir.global external @triton_print_buffer(0 : i64)
+  // CHECK-LABEL: print_buffer
+  tt.func @print_buffer(%arg0 : tensor<256xi32, #blocked>, %arg1 : f64) {
+    // CHECK-NOT: vprintf
+    // CHECK: llvm.mlir.addressof @triton_print_buffer
+    // CHECK: llvm.cond_br
+    // The 32 lanes allocate 5 + 2 + 2 words each at once
+    // CHECK: llvm.mlir.constant(288 : i32)
+    // CHECK: llvm.atomicrmw add {{.*}} monotonic
+    // CHECK: shfl.sync.idx.b32
+    // CHECK: llvm.cond_br
+    // CHECK-COUNT-9: llvm.store
+    tt.print " x: " : %arg0, %arg1 : tensor<256xi32, #blocked>, f64
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-NOT: @triton_print_buffer
+  // CHECK-LABEL: print_vprintf
+  tt.func @print_vprintf(%arg0 : tensor<256xi32, #blocked>) {
+    // CHECK: vprintf
+    tt.print " x: " : %arg0 : tensor<256xi32, #blocked>
+    tt.return
+  }
+}
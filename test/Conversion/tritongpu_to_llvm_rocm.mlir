@@ -0,0 +1,40 @@
+// RUN: triton-opt %s -split-input-file --convert-triton-gpu-to-llvm="is-rocm=true" | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [1, 4], order = [1, 0]}>
+#shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx=0, parent=#blocked}>
+#dot_operand_b = #triton_gpu.dot_op<{opIdx=1, parent=#blocked}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK: llvm.func @llvm.amdgcn.fdot2(vector<2xf16>, vector<2xf16>, f32, i1) -> f32
+  // CHECK-LABEL: matmul_fmadot_f16
+  tt.func @matmul_fmadot_f16(%a:tensor<32x16xf16, #shared>, %b:tensor<16x32xf16, #shared>) {
+    %cst = arith.constant dense<0.000000e+00> : tensor<32x32xf32, #blocked>
+    %a_mat = triton_gpu.convert_layout %a : (tensor<32x16xf16, #shared>) -> tensor<32x16xf16, #dot_operand_a>
+    %b_mat = triton_gpu.convert_layout %b : (tensor<16x32xf16, #shared>) -> tensor<16x32xf16, #dot_operand_b>
+    // CHECK: llvm.call @llvm.amdgcn.fdot2
+    // CHECK-NOT: llvm.intr.fmuladd
+    %28 = tt.dot %a_mat, %b_mat, %cst {allowTF32 = false, transA = false, transB = false} : tensor<32x16xf16, #dot_operand_a> * tensor<16x32xf16, #dot_operand_b> -> tensor<32x32xf32, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [1, 4], order = [1, 0]}>
+#shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx=0, parent=#blocked}>
+#dot_operand_b = #triton_gpu.dot_op<{opIdx=1, parent=#blocked}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // The last step of an odd K is a fma of the extended operands
+  // CHECK-LABEL: matmul_fmadot_f16_odd
+  tt.func @matmul_fmadot_f16_odd(%a:tensor<32x1xf16, #shared>, %b:tensor<1x32xf16, #shared>) {
+    %cst = arith.constant dense<0.000000e+00> : tensor<32x32xf32, #blocked>
+    %a_mat = triton_gpu.convert_layout %a : (tensor<32x1xf16, #shared>) -> tensor<32x1xf16, #dot_operand_a>
+    %b_mat = triton_gpu.convert_layout %b : (tensor<1x32xf16, #shared>) -> tensor<1x32xf16, #dot_operand_b>
+    // CHECK-NOT: llvm.call @llvm.amdgcn.fdot2
+    // CHECK: llvm.fpext %{{.*}} : f16 to f32
+    // CHECK: llvm.intr.fmuladd
+    %28 = tt.dot %a_mat, %b_mat, %cst {allowTF32 = false, transA = false, transB = false} : tensor<32x1xf16, #dot_operand_a> * tensor<1x32xf16, #dot_operand_b> -> tensor<32x32xf32, #blocked>
+    tt.return
+  }
+}
@@ -23,28 +23,55 @@ tt.func @test_combine_dot_add_pattern() -> (tensor<128x128xf32>, tensor<128x128x
 }
 
 
-// COM: CHECK-LABEL: @test_combine_addptr_pattern
+// CHECK-LABEL: @test_combine_addptr_pattern
 tt.func @test_combine_addptr_pattern(%base: !tt.ptr<f32>) -> tensor<8x!tt.ptr<f32>> {
     %off0 = arith.constant 10 : i32
     %off1 = arith.constant 15 : i32
 
     // 10 + 15 = 25
-    // COM: CHECK-NEXT: %[[cst:.*]] = arith.constant dense<25> : tensor<8xi32>
+    // CHECK-DAG: %[[cst:.*]] = arith.constant dense<25> : tensor<8xi32>
+    // CHECK-DAG: %[[tmp0:.*]] = tt.splat %{{.*}} : (!tt.ptr<f32>) -> tensor<8x!tt.ptr<f32>>
 
-    %base_ = tt.broadcast %base : (!tt.ptr<f32>) -> tensor<8x!tt.ptr<f32>>
+    %base_ = tt.splat %base : (!tt.ptr<f32>) -> tensor<8x!tt.ptr<f32>>
 
-    // COM: CHECK-NEXT: %[[tmp0:.*]] = tt.broadcast %{{.*}} : (!tt.ptr<f32>) -> tensor<8x!tt.ptr<f32>>
+    %idx0 = tt.splat %off0 : (i32) -> tensor<8xi32>
+    %idx1 = tt.splat %off1 : (i32) -> tensor<8xi32>
 
-    %idx0 = tt.broadcast %off0 : (i32) -> tensor<8xi32>
-    %idx1 = tt.broadcast %off1 : (i32) -> tensor<8xi32>
-
-    // COM: CHECK-NEXT: %1 = tt.addptr %[[tmp0]], %[[cst]] : tensor<8x!tt.ptr<f32>>, tensor<8xi32>
+    // CHECK: %[[res:.*]] = tt.addptr %[[tmp0]], %[[cst]] : tensor<8x!tt.ptr<f32>>, tensor<8xi32>
+    // CHECK-NEXT: tt.return %[[res]]
     %ptr0 = tt.addptr %base_, %idx0 : tensor<8x!tt.ptr<f32>>, tensor<8xi32>
     %ptr1 = tt.addptr %ptr0, %idx1 : tensor<8x!tt.ptr<f32>>, tensor<8xi32>
 
     tt.return %ptr1 : tensor<8x!tt.ptr<f32>>
 }
 
+// The 32-bit offset is sign-extended and added to the 64-bit one
+// CHECK-LABEL: @test_combine_addptr_mixed_widths
+tt.func @test_combine_addptr_mixed_widths(%ptrs: tensor<8x!tt.ptr<f32>>, %idx0: tensor<8xi32>, %idx1: tensor<8xi64>) -> tensor<8x!tt.ptr<f32>> {
+    // CHECK: %[[ext:.*]] = arith.extsi %{{.*}} : tensor<8xi32> to tensor<8xi64>
+    // CHECK-NEXT: %[[sum:.*]] = arith.addi %[[ext]], %{{.*}} : tensor<8xi64>
+    // CHECK-NEXT: %[[res:.*]] = tt.addptr %{{.*}}, %[[sum]] : tensor<8x!tt.ptr<f32>>, tensor<8xi64>
+    // CHECK-NEXT: tt.return %[[res]]
+    %ptr0 = tt.addptr %ptrs, %idx0 : tensor<8x!tt.ptr<f32>>, tensor<8xi32>
+    %ptr1 = tt.addptr %ptr0, %idx1 : tensor<8x!tt.ptr<f32>>, tensor<8xi64>
+    tt.return %ptr1 : tensor<8x!tt.ptr<f32>>
+}
+
+// The 32-bit offsets that are not constants may overflow once added, and the
+// pointers used elsewhere are kept
+// CHECK-LABEL: @test_combine_addptr_fail_pattern
+tt.func @test_combine_addptr_fail_pattern(%ptrs: tensor<8x!tt.ptr<f32>>, %idx0: tensor<8xi32>, %idx1: tensor<8xi32>, %idx2: tensor<8xi64>) -> (tensor<8x!tt.ptr<f32>>, tensor<8x!tt.ptr<f32>>, tensor<8x!tt.ptr<f32>>) {
+    // CHECK-NOT: arith.addi
+    // CHECK: %[[ptr0:.*]] = tt.addptr %{{.*}}, %{{.*}} : tensor<8x!tt.ptr<f32>>, tensor<8xi32>
+    // CHECK-NEXT: %[[ptr1:.*]] = tt.addptr %[[ptr0]], %{{.*}} : tensor<8x!tt.ptr<f32>>, tensor<8xi32>
+    // CHECK-NEXT: %[[ptr2:.*]] = tt.addptr %[[ptr0]], %{{.*}} : tensor<8x!tt.ptr<f32>>, tensor<8xi64>
+    // CHECK-NEXT: tt.return %[[ptr0]], %[[ptr1]], %[[ptr2]]
+    %ptr0 = tt.addptr %ptrs, %idx0 : tensor<8x!tt.ptr<f32>>, tensor<8xi32>
+    %ptr1 = tt.addptr %ptr0, %idx1 : tensor<8x!tt.ptr<f32>>, tensor<8xi32>
+    %ptr2 = tt.addptr %ptr0, %idx2 : tensor<8x!tt.ptr<f32>>, tensor<8xi64>
+    tt.return %ptr0, %ptr1, %ptr2 : tensor<8x!tt.ptr<f32>>, tensor<8x!tt.ptr<f32>>, tensor<8x!tt.ptr<f32>>
+}
+
 
 // CHECK-LABEL: @test_combine_select_masked_load_pattern
 tt.func @test_combine_select_masked_load_pattern(%ptr: tensor<8x!tt.ptr<f32>>, %cond: i1) -> (tensor<8xf32>, tensor<8xf32>) {
@@ -210,3 +237,88 @@ tt.func @test_fold_views() -> (tensor<16x8xf32>, tensor<16x128xf32>, tensor<1x1x
 
     tt.return %b, %c, %d : tensor<16x8xf32>, tensor<16x128xf32>, tensor<1x1x128xf32>
 }
+
+// -----
+
+// CHECK-LABEL: @test_combine_dot_scale_pattern
+tt.func @test_combine_dot_scale_pattern(%a: tensor<64x32xf16>, %q: tensor<32x64xi8>, %s: tensor<1x64xf16>, %acc: tensor<64x64xf32>) -> tensor<64x64xf32> {
+    // CHECK-DAG: %[[zero:.*]] = arith.constant dense<0.000000e+00> : tensor<64x64xf32>
+    // CHECK-DAG: %[[x:.*]] = arith.sitofp %{{.*}} : tensor<32x64xi8> to tensor<32x64xf16>
+    // CHECK: %[[dot:.*]] = tt.dot %{{.*}}, %[[x]], %[[zero]] {allowTF32 = true} : tensor<64x32xf16> * tensor<32x64xf16> -> tensor<64x64xf32>
+    // CHECK: %[[ext:.*]] = arith.extf %{{.*}} : tensor<1x64xf16> to tensor<1x64xf32>
+    // CHECK: %[[scale:.*]] = tt.broadcast %[[ext]] : (tensor<1x64xf32>) -> tensor<64x64xf32>
+    // CHECK: %[[mul:.*]] = arith.mulf %[[dot]], %[[scale]] : tensor<64x64xf32>
+    // CHECK: %[[res:.*]] = arith.addf %{{.*}}, %[[mul]] : tensor<64x64xf32>
+    // CHECK: tt.return %[[res]]
+    %x = arith.sitofp %q : tensor<32x64xi8> to tensor<32x64xf16>
+    %bs = tt.broadcast %s : (tensor<1x64xf16>) -> tensor<32x64xf16>
+    %b = arith.mulf %x, %bs : tensor<32x64xf16>
+    %res = tt.dot %a, %b, %acc {allowTF32 = true} : tensor<64x32xf16> * tensor<32x64xf16> -> tensor<64x64xf32>
+    tt.return %res : tensor<64x64xf32>
+}
+
+// CHECK-LABEL: @test_combine_dot_scale_pattern_k_varying
+tt.func @test_combine_dot_scale_pattern_k_varying(%a: tensor<64x32xf16>, %q: tensor<32x64xi8>, %s: tensor<32x1xf16>, %acc: tensor<64x64xf32>) -> tensor<64x64xf32> {
+    // A scale varying along K cannot be applied to the accumulator.
+    // CHECK: arith.mulf %{{.*}} : tensor<32x64xf16>
+    // CHECK: tt.dot
+    %x = arith.sitofp %q : tensor<32x64xi8> to tensor<32x64xf16>
+    %bs = tt.broadcast %s : (tensor<32x1xf16>) -> tensor<32x64xf16>
+    %b = arith.mulf %x, %bs : tensor<32x64xf16>
+    %res = tt.dot %a, %b, %acc {allowTF32 = true} : tensor<64x32xf16> * tensor<32x64xf16> -> tensor<64x64xf32>
+    tt.return %res : tensor<64x64xf32>
+}
+
+// CHECK-LABEL: @test_combine_dot_scale_pattern_f16_acc
+tt.func @test_combine_dot_scale_pattern_f16_acc(%a: tensor<64x32xf16>, %q: tensor<32x64xi8>, %s: tensor<1x64xf16>, %acc: tensor<64x64xf16>) -> tensor<64x64xf16> {
+    // The unscaled products could overflow an f16 accumulator.
+    // CHECK: arith.mulf %{{.*}} : tensor<32x64xf16>
+    // CHECK: tt.dot
+    %x = arith.sitofp %q : tensor<32x64xi8> to tensor<32x64xf16>
+    %bs = tt.broadcast %s : (tensor<1x64xf16>) -> tensor<32x64xf16>
+    %b = arith.mulf %x, %bs : tensor<32x64xf16>
+    %res = tt.dot %a, %b, %acc {allowTF32 = true} : tensor<64x32xf16> * tensor<32x64xf16> -> tensor<64x64xf16>
+    tt.return %res : tensor<64x64xf16>
+}
+
+// CHECK-LABEL: @test_combine_bounded_cmp_pattern
+tt.func @test_combine_bounded_cmp_pattern(%ptr: tensor<128x!tt.ptr<f32>>) -> (tensor<128xf32>, tensor<128xi1>, i1) {
+    // CHECK-DAG: %[[true:.*]] = arith.constant dense<true> : tensor<128xi1>
+    // CHECK-DAG: %[[false:.*]] = arith.constant dense<false> : tensor<128xi1>
+    // CHECK-DAG: %[[true_scalar:.*]] = arith.constant true
+    %c0 = arith.constant 0 : i32
+    %c4 = arith.constant 4 : i32
+    %c256 = arith.constant dense<256> : tensor<128xi32>
+    %other = arith.constant dense<0.0> : tensor<128xf32>
+    %range = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    // [0, 127] < 256
+    %mask = arith.cmpi slt, %range, %c256 : tensor<128xi32>
+    // CHECK: tt.load %{{.*}}, %[[true]], %{{.*}}
+    %x = tt.load %ptr, %mask, %other {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32>
+    // [256, 383] < 256
+    %shifted = arith.addi %range, %c256 : tensor<128xi32>
+    %empty = arith.cmpi slt, %shifted, %c256 : tensor<128xi32>
+    // pid % 4 < 4
+    %pid = tt.get_program_id {axis = 0 : i32} : i32
+    %rem = arith.remsi %pid, %c4 : i32
+    %in_bounds = arith.cmpi ult, %rem, %c4 : i32
+    // CHECK: tt.return %{{.*}}, %[[false]], %[[true_scalar]]
+    tt.return %x, %empty, %in_bounds : tensor<128xf32>, tensor<128xi1>, i1
+}
+
+// CHECK-LABEL: @test_combine_bounded_cmp_fail_pattern
+tt.func @test_combine_bounded_cmp_fail_pattern(%n: i32) -> (tensor<128xi1>, i1) {
+    %c128 = arith.constant 128 : i32
+    %range = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    // The bound is unknown
+    // CHECK: arith.cmpi slt
+    %splat = tt.splat %n : (i32) -> tensor<128xi32>
+    %mask = arith.cmpi slt, %range, %splat : tensor<128xi32>
+    // The product may overflow
+    // CHECK: arith.cmpi sge
+    %pid = tt.get_program_id {axis = 0 : i32} : i32
+    %offset = arith.muli %pid, %c128 : i32
+    %c0 = arith.constant 0 : i32
+    %positive = arith.cmpi sge, %offset, %c0 : i32
+    tt.return %mask, %positive : tensor<128xi1>, i1
+}
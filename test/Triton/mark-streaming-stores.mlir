@@ -0,0 +1,74 @@
+// RUN: triton-opt %s -split-input-file -triton-mark-streaming-stores | FileCheck %s
+
+// The output is never read: its stores stream, those of the input do not
+// CHECK-LABEL: tt.func public @elementwise
+tt.func public @elementwise(%arg0: !tt.ptr<f32>, %arg1: !tt.ptr<f32>) {
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+  %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32>
+  %4 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+  %5 = tt.addptr %4, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  // CHECK: tt.store %{{.*}}, %{{.*}} {cache = 5 : i32, evict = 1 : i32}
+  tt.store %5, %3 : tensor<128xf32>
+  // CHECK: tt.store %{{.*}}, %{{.*}} {cache = 1 : i32, evict = 1 : i32}
+  tt.store %2, %3 : tensor<128xf32>
+  tt.return
+}
+
+// -----
+
+// The pointers advanced by a loop are computed from their init value
+// CHECK-LABEL: tt.func public @loop
+tt.func public @loop(%arg0: !tt.ptr<f32>, %arg1: !tt.ptr<f32>) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c4 = arith.constant 4 : index
+  %cst = arith.constant dense<128> : tensor<128xi32>
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+  %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  %3 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+  %4 = tt.addptr %3, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  %5:2 = scf.for %i = %c0 to %c4 step %c1 iter_args(%src = %2, %dst = %4) -> (tensor<128x!tt.ptr<f32>>, tensor<128x!tt.ptr<f32>>) {
+    %6 = tt.load %src {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32>
+    // CHECK: tt.store %{{.*}}, %{{.*}} {cache = 5 : i32, evict = 1 : i32}
+    tt.store %dst, %6 : tensor<128xf32>
+    %7 = tt.addptr %src, %cst : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    %8 = tt.addptr %dst, %cst : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    scf.yield %7, %8 : tensor<128x!tt.ptr<f32>>, tensor<128x!tt.ptr<f32>>
+  }
+  tt.return
+}
+
+// -----
+
+// A kernel that reads through a pointer of unknown base may read any output
+// CHECK-LABEL: tt.func public @unknown_base
+tt.func public @unknown_base(%arg0: !tt.ptr<f32>, %arg1: !tt.ptr<f32>, %arg2: i1) {
+  %0 = arith.select %arg2, %arg0, %arg1 : !tt.ptr<f32>
+  %1 = tt.load %0 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : f32
+  // CHECK: tt.store %{{.*}}, %{{.*}} {cache = 1 : i32, evict = 1 : i32}
+  tt.store %arg1, %1 : f32
+  tt.return
+}
+
+// -----
+
+// The hints of the user are kept
+// CHECK-LABEL: tt.func public @user_hint
+tt.func public @user_hint(%arg0: !tt.ptr<f32>, %arg1: f32) {
+  // CHECK: tt.store %{{.*}}, %{{.*}} {cache = 6 : i32, evict = 1 : i32}
+  tt.store %arg0, %arg1 {cache = 6 : i32, evict = 1 : i32} : f32
+  tt.return
+}
+
+// -----
+
+// Ordered stores publish data that other programs read
+// CHECK-LABEL: tt.func public @ordered_store
+tt.func public @ordered_store(%arg0: !tt.ptr<f32>, %arg1: f32) {
+  // CHECK: tt.store %{{.*}}, %{{.*}} {cache = 1 : i32, evict = 1 : i32, scope = 3 : i32, sem = 3 : i32}
+  tt.store %arg0, %arg1 {cache = 1 : i32, evict = 1 : i32, sem = 3 : i32, scope = 3 : i32} : f32
+  tt.return
+}
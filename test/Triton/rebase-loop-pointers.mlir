@@ -0,0 +1,83 @@
+// RUN: triton-opt %s -split-input-file -triton-rebase-loop-pointers -canonicalize | FileCheck %s
+
+// The loop carries the scalar base; the pointers are rebuilt from the offsets
+// CHECK-LABEL: tt.func @rebase
+tt.func @rebase(%arg0: !tt.ptr<f16>, %arg1: i32) -> tensor<128xf16> {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c8 = arith.constant 8 : index
+  %cst = arith.constant dense<0.000000e+00> : tensor<128xf16>
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %1 = tt.splat %arg0 : (!tt.ptr<f16>) -> tensor<128x!tt.ptr<f16>>
+  %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f16>>, tensor<128xi32>
+  %3 = tt.splat %arg1 : (i32) -> tensor<128xi32>
+  // CHECK: scf.for {{.*}} iter_args(%[[BASE:.*]] = %arg0, {{.*}}) -> (!tt.ptr<f16>, tensor<128xf16>)
+  %4:2 = scf.for %i = %c0 to %c8 step %c1 iter_args(%ptrs = %2, %acc = %cst) -> (tensor<128x!tt.ptr<f16>>, tensor<128xf16>) {
+    // CHECK: %[[SPLAT:.*]] = tt.splat %[[BASE]]
+    // CHECK: %[[PTRS:.*]] = tt.addptr %[[SPLAT]], %{{.*}} : tensor<128x!tt.ptr<f16>>, tensor<128xi32>
+    // CHECK: tt.load %[[PTRS]]
+    %5 = tt.load %ptrs {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf16>
+    %6 = arith.addf %acc, %5 : tensor<128xf16>
+    // CHECK: %[[NEXT:.*]] = tt.addptr %[[BASE]], %arg1 : !tt.ptr<f16>, i32
+    // CHECK: scf.yield %[[NEXT]]
+    %7 = tt.addptr %ptrs, %3 : tensor<128x!tt.ptr<f16>>, tensor<128xi32>
+    scf.yield %7, %6 : tensor<128x!tt.ptr<f16>>, tensor<128xf16>
+  }
+  tt.return %4#1 : tensor<128xf16>
+}
+
+// -----
+
+// A step that is not uniform keeps the tensor of pointers
+// CHECK-LABEL: tt.func @non_uniform_step
+tt.func @non_uniform_step(%arg0: !tt.ptr<f16>) -> tensor<128xf16> {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c8 = arith.constant 8 : index
+  %cst = arith.constant dense<0.000000e+00> : tensor<128xf16>
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %1 = tt.splat %arg0 : (!tt.ptr<f16>) -> tensor<128x!tt.ptr<f16>>
+  %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f16>>, tensor<128xi32>
+  // CHECK: scf.for {{.*}} -> (tensor<128x!tt.ptr<f16>>, tensor<128xf16>)
+  %4:2 = scf.for %i = %c0 to %c8 step %c1 iter_args(%ptrs = %2, %acc = %cst) -> (tensor<128x!tt.ptr<f16>>, tensor<128xf16>) {
+    %5 = tt.load %ptrs {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf16>
+    %6 = arith.addf %acc, %5 : tensor<128xf16>
+    %7 = tt.addptr %ptrs, %0 : tensor<128x!tt.ptr<f16>>, tensor<128xi32>
+    scf.yield %7, %6 : tensor<128x!tt.ptr<f16>>, tensor<128xf16>
+  }
+  tt.return %4#1 : tensor<128xf16>
+}
+
+// -----
+
+// The steps of different widths, e.g. combined by triton-combine, advance the
+// base one after the other
+// CHECK-LABEL: tt.func @mixed_width_steps
+tt.func @mixed_width_steps(%arg0: !tt.ptr<f16>, %arg1: i32, %arg2: i64) -> tensor<128xf16> {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c8 = arith.constant 8 : index
+  %cst = arith.constant dense<0.000000e+00> : tensor<128xf16>
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %1 = tt.splat %arg0 : (!tt.ptr<f16>) -> tensor<128x!tt.ptr<f16>>
+  %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f16>>, tensor<128xi32>
+  %3 = tt.splat %arg1 : (i32) -> tensor<128xi32>
+  %4 = tt.splat %arg2 : (i64) -> tensor<128xi64>
+  // CHECK: %[[EXT:.*]] = arith.extsi %arg1 : i32 to i64
+  // CHECK: %[[STEP:.*]] = arith.addi %[[EXT]], %arg2 : i64
+  // CHECK: scf.for {{.*}} iter_args(%[[BASE:.*]] = %arg0, {{.*}}) -> (!tt.ptr<f16>, tensor<128xf16>)
+  %5:2 = scf.for %i = %c0 to %c8 step %c1 iter_args(%ptrs = %2, %acc = %cst) -> (tensor<128x!tt.ptr<f16>>, tensor<128xf16>) {
+    // CHECK: tt.load
+    %6 = tt.load %ptrs {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf16>
+    %7 = arith.addf %acc, %6 : tensor<128xf16>
+    // CHECK: %[[NEXT0:.*]] = tt.addptr %[[BASE]], %arg1 : !tt.ptr<f16>, i32
+    // CHECK: %[[NEXT1:.*]] = tt.addptr %[[NEXT0]], %[[STEP]] : !tt.ptr<f16>, i64
+    // CHECK: scf.yield %[[NEXT1]]
+    %8 = arith.extsi %3 : tensor<128xi32> to tensor<128xi64>
+    %9 = arith.addi %8, %4 : tensor<128xi64>
+    %10 = tt.addptr %ptrs, %3 : tensor<128x!tt.ptr<f16>>, tensor<128xi32>
+    %11 = tt.addptr %10, %9 : tensor<128x!tt.ptr<f16>>, tensor<128xi64>
+    scf.yield %11, %7 : tensor<128x!tt.ptr<f16>>, tensor<128xf16>
+  }
+  tt.return %5#1 : tensor<128xf16>
+}
@@ -0,0 +1,95 @@
+// RUN: triton-opt %s -split-input-file -triton-specialize-calls | FileCheck %s
+// RUN: triton-opt %s -split-input-file -triton-specialize-calls=max-clones=1 | FileCheck %s --check-prefix=LIMIT
+
+// The call sites with different alignments get their own callee
+// CHECK-LABEL: tt.func @load_helper_0(
+// CHECK-SAME: tt.divisibility = 4
+// CHECK-LABEL: tt.func @load_helper_1(
+// CHECK-SAME: tt.divisibility = 8
+// CHECK-LABEL: tt.func @load_helper(
+// CHECK-SAME: tt.divisibility = 16
+// CHECK-LABEL: tt.func @kernel
+// CHECK: tt.call @load_helper(
+// CHECK: tt.call @load_helper_0(
+// CHECK: tt.call @load_helper(
+// CHECK: tt.call @load_helper_1(
+
+// Past the limit, the call sites share a clone without argument info
+// LIMIT-LABEL: tt.func @load_helper_0(
+// LIMIT-NOT: tt.divisibility
+// LIMIT-LABEL: tt.func @load_helper(
+// LIMIT-SAME: tt.divisibility = 16
+// LIMIT-LABEL: tt.func @kernel
+// LIMIT: tt.call @load_helper(
+// LIMIT: tt.call @load_helper_0(
+// LIMIT: tt.call @load_helper(
+// LIMIT: tt.call @load_helper_0(
+tt.func @load_helper(%arg0: !tt.ptr<f32>) -> tensor<128xf32> {
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+  %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32>
+  tt.return %3 : tensor<128xf32>
+}
+
+tt.func @kernel(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+  %c1 = arith.constant 1 : i32
+  %c2 = arith.constant 2 : i32
+  %c128 = arith.constant 128 : i32
+  %0 = tt.call @load_helper(%arg0) : (!tt.ptr<f32>) -> tensor<128xf32>
+  %1 = tt.addptr %arg0, %c1 : !tt.ptr<f32>, i32
+  %2 = tt.call @load_helper(%1) : (!tt.ptr<f32>) -> tensor<128xf32>
+  %3 = tt.addptr %arg0, %c128 : !tt.ptr<f32>, i32
+  %4 = tt.call @load_helper(%3) : (!tt.ptr<f32>) -> tensor<128xf32>
+  %5 = tt.addptr %arg0, %c2 : !tt.ptr<f32>, i32
+  %6 = tt.call @load_helper(%5) : (!tt.ptr<f32>) -> tensor<128xf32>
+  tt.return
+}
+
+// -----
+
+// The callees of the clones are specialized as well
+// CHECK-LABEL: tt.func @inner_1(
+// CHECK-SAME: tt.divisibility = 4
+// CHECK-LABEL: tt.func @inner(
+// CHECK-SAME: tt.divisibility = 16
+// CHECK-LABEL: tt.func @outer_0(
+// CHECK: tt.call @inner_1(
+// CHECK-LABEL: tt.func @outer(
+// CHECK: tt.call @inner(
+tt.func @inner(%arg0: !tt.ptr<f32>) {
+  tt.return
+}
+
+tt.func @outer(%arg0: !tt.ptr<f32>) {
+  tt.call @inner(%arg0) : (!tt.ptr<f32>) -> ()
+  tt.return
+}
+
+tt.func @kernel(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+  %c1 = arith.constant 1 : i32
+  tt.call @outer(%arg0) : (!tt.ptr<f32>) -> ()
+  %0 = tt.addptr %arg0, %c1 : !tt.ptr<f32>, i32
+  tt.call @outer(%0) : (!tt.ptr<f32>) -> ()
+  tt.return
+}
+
+// -----
+
+// Tensor arguments get the axis info of each dimension
+// CHECK-LABEL: tt.func @tensor_helper
+// CHECK-SAME: tt.contiguity = 128
+// CHECK-SAME: tt.divisibility = 16
+// CHECK-LABEL: tt.func @tensor_kernel
+// CHECK: tt.call @tensor_helper(
+tt.func @tensor_helper(%arg0: tensor<128x!tt.ptr<f32>>) {
+  tt.return
+}
+
+tt.func @tensor_kernel(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+  %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  tt.call @tensor_helper(%2) : (tensor<128x!tt.ptr<f32>>) -> ()
+  tt.return
+}
@@ -0,0 +1,44 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-accelerate-matmul=compute-capability=80 | FileCheck %s
+
+// Both dots of a chain split their rows over all the warps, so that the
+// result of the first one is read in registers by the second one.
+#blocked = #triton_gpu.blocked<{sizePerThread = [4, 4], threadsPerWarp = [2, 16], warpsPerCTA = [4, 1], order = [1, 0]}>
+#dot0 = #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>
+#dot1 = #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>
+// CHECK: #[[MMA:.*]] = #triton_gpu.mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [4, 1]}>
+// CHECK-NOT: #triton_gpu.mma<
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: chained_dot
+  // CHECK: tt.dot {{.*}} -> tensor<64x64xf32, #[[MMA]]>
+  // CHECK: tt.dot {{.*}} -> tensor<64x128xf32, #[[MMA]]>
+  tt.func @chained_dot(%q: tensor<64x32xf16, #dot0>, %k: tensor<32x64xf16, #dot1>,
+                       %v: tensor<64x128xf16, #dot1>) -> tensor<64x128xf32, #blocked> {
+    %c0 = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #blocked>
+    %c1 = arith.constant dense<0.000000e+00> : tensor<64x128xf32, #blocked>
+    %s = tt.dot %q, %k, %c0 {allowTF32 = true} : tensor<64x32xf16, #dot0> * tensor<32x64xf16, #dot1> -> tensor<64x64xf32, #blocked>
+    %p = arith.truncf %s : tensor<64x64xf32, #blocked> to tensor<64x64xf16, #blocked>
+    %pa = triton_gpu.convert_layout %p : (tensor<64x64xf16, #blocked>) -> tensor<64x64xf16, #dot0>
+    %o = tt.dot %pa, %v, %c1 {allowTF32 = true} : tensor<64x64xf16, #dot0> * tensor<64x128xf16, #dot1> -> tensor<64x128xf32, #blocked>
+    tt.return %o : tensor<64x128xf32, #blocked>
+  }
+}
+
+// -----
+
+// The sparse dots use MMA v2 and leave their metadata in shared memory.
+#blocked = #triton_gpu.blocked<{sizePerThread = [4, 4], threadsPerWarp = [2, 16], warpsPerCTA = [4, 1], order = [1, 0]}>
+#shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#dot0 = #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>
+#dot1 = #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>
+// CHECK: #[[MMA:.*]] = #triton_gpu.mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [2, 2]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: sparse_dot
+  // CHECK-DAG: %[[A:.*]] = triton_gpu.convert_layout %{{.*}} -> tensor<64x32xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #[[MMA]], kWidth = 2}>>
+  // CHECK-DAG: %[[B:.*]] = triton_gpu.convert_layout %{{.*}} -> tensor<64x64xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #[[MMA]], kWidth = 2}>>
+  // CHECK: tt.sparse_dot %[[A]], %[[B]], %{{.*}}, %{{.*}} : {{.*}} meta tensor<64x4xi16, #shared> -> tensor<64x64xf32, #[[MMA]]>
+  tt.func @sparse_dot(%a: tensor<64x32xf16, #dot0>, %b: tensor<64x64xf16, #dot1>, %meta: tensor<64x4xi16, #shared>) -> tensor<64x64xf32, #blocked> {
+    %c = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #blocked>
+    %d = tt.sparse_dot %a, %b, %c, %meta : tensor<64x32xf16, #dot0> * tensor<64x64xf16, #dot1> meta tensor<64x4xi16, #shared> -> tensor<64x64xf32, #blocked>
+    tt.return %d : tensor<64x64xf32, #blocked>
+  }
+}
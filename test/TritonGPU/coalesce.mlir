@@ -51,3 +51,72 @@ tt.func @transpose(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32},
 }
 
 }
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [32, 1], warpsPerCTA = [4, 1], order = [0, 1]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// Block pointers are distributed along their unit-stride dimension
+// CHECK: [[block_layout:#.*]] = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+// CHECK-LABEL: @coalesce_block_ptr
+// CHECK: tt.load %{{.*}} {boundaryCheck = array<i32: 0, 1>, {{.*}}} : !tt.ptr<tensor<64x64xf16>> -> tensor<64x64xf16, [[block_layout]]>
+// CHECK: tt.store %{{.*}}, %{{.*}} {boundaryCheck = array<i32: 0, 1>, {{.*}}} : !tt.ptr<tensor<64x64xf16>>, tensor<64x64xf16, [[block_layout]]>
+tt.func @coalesce_block_ptr(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32},
+                            %arg1: i64 {tt.divisibility = 16 : i32},
+                            %arg2: i64 {tt.divisibility = 16 : i32}) {
+  %c0_i32 = arith.constant 0 : i32
+  %c1_i64 = arith.constant 1 : i64
+  %0 = tt.make_tensor_ptr %arg0, [%arg1, %arg2], [%arg2, %c1_i64], [%c0_i32, %c0_i32] {order = array<i32: 1, 0>} : !tt.ptr<tensor<64x64xf16>>
+  %1 = tt.load %0 {boundaryCheck = array<i32: 0, 1>, cache = 1 : i32, evict = 1 : i32, isVolatile = false} : !tt.ptr<tensor<64x64xf16>> -> tensor<64x64xf16, #blocked>
+  tt.store %0, %1 {boundaryCheck = array<i32: 0, 1>, cache = 1 : i32, evict = 1 : i32} : !tt.ptr<tensor<64x64xf16>>, tensor<64x64xf16, #blocked>
+  tt.return
+}
+
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [32, 1], warpsPerCTA = [4, 1], order = [0, 1]}>
+#slice = #triton_gpu.slice<{dim = 0, parent = #blocked}>
+#mma = #triton_gpu.mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [4, 1]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// The quads of f32 accumulators fill whole sectors, they are stored from the
+// MMA layout
+// CHECK: [[mma:#.*]] = #triton_gpu.mma
+// CHECK-LABEL: @store_mma_f32
+// CHECK: [[ptr:%.*]] = triton_gpu.convert_layout {{.*}} -> tensor<64x64x!tt.ptr<f32>, [[mma]]>
+// CHECK-NOT: triton_gpu.convert_layout
+// CHECK: tt.store [[ptr]], %arg1 : tensor<64x64xf32, [[mma]]>
+tt.func @store_mma_f32(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32},
+                       %arg1: tensor<64x64xf32, #mma>) {
+  %0 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32, #slice>
+  %1 = tt.expand_dims %0 {axis = 0 : i32} : (tensor<64xi32, #slice>) -> tensor<1x64xi32, #blocked>
+  %2 = tt.broadcast %1 : (tensor<1x64xi32, #blocked>) -> tensor<64x64xi32, #blocked>
+  %3 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<64x64x!tt.ptr<f32>, #blocked>
+  %4 = tt.addptr %3, %2 : tensor<64x64x!tt.ptr<f32>, #blocked>, tensor<64x64xi32, #blocked>
+  %5 = triton_gpu.convert_layout %arg1 : (tensor<64x64xf32, #mma>) -> tensor<64x64xf32, #blocked>
+  tt.store %4, %5 : tensor<64x64xf32, #blocked>
+  tt.return
+}
+
+// The quads of f16 accumulators only cover half a sector, they are converted
+// to the coalesced layout
+// CHECK-LABEL: @store_mma_f16
+// CHECK: [[ptr:%.*]] = triton_gpu.convert_layout {{.*}} -> tensor<64x64x!tt.ptr<f16>, [[blocked:#.*]]>
+// CHECK: [[val:%.*]] = triton_gpu.convert_layout {{.*}} -> tensor<64x64xf16, [[blocked]]>
+// CHECK: tt.store [[ptr]], [[val]] : tensor<64x64xf16, [[blocked]]>
+tt.func @store_mma_f16(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32},
+                       %arg1: tensor<64x64xf16, #mma>) {
+  %0 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32, #slice>
+  %1 = tt.expand_dims %0 {axis = 0 : i32} : (tensor<64xi32, #slice>) -> tensor<1x64xi32, #blocked>
+  %2 = tt.broadcast %1 : (tensor<1x64xi32, #blocked>) -> tensor<64x64xi32, #blocked>
+  %3 = tt.splat %arg0 : (!tt.ptr<f16>) -> tensor<64x64x!tt.ptr<f16>, #blocked>
+  %4 = tt.addptr %3, %2 : tensor<64x64x!tt.ptr<f16>, #blocked>, tensor<64x64xi32, #blocked>
+  %5 = triton_gpu.convert_layout %arg1 : (tensor<64x64xf16, #mma>) -> tensor<64x64xf16, #blocked>
+  tt.store %4, %5 : tensor<64x64xf16, #blocked>
+  tt.return
+}
+
+}
@@ -0,0 +1,35 @@
+// RUN: triton-opt %s -tritongpu-remove-layout-conversions="cost-model=true" 2>&1 | FileCheck %s
+
+#row = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#col = #triton_gpu.blocked<{sizePerThread = [4, 1], threadsPerWarp = [8, 4], warpsPerCTA = [1, 4], order = [0, 1]}>
+#row_slice = #triton_gpu.slice<{dim = 1, parent = #row}>
+
+// CHECK-DAG: [[$col:#.*]] = #triton_gpu.blocked<{sizePerThread = [4, 1], threadsPerWarp = [8, 4], warpsPerCTA = [1, 4], order = [0, 1]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// Rematerializing the broadcast in the layout of the store adds a conversion
+// of the loaded vector, which is much cheaper than the conversion of the
+// 128x128 tensor it replaces. RematerializeBackward rejects it since it only
+// counts conversions.
+// CHECK-LABEL: broadcast_row
+// CHECK: tt.load
+// CHECK: triton_gpu.convert_layout {{.*}} -> tensor<128xf32, #triton_gpu.slice<{dim = 1, parent = [[$col]]}>>
+// CHECK-NOT: triton_gpu.convert_layout
+// CHECK: tt.expand_dims {{.*}} -> tensor<128x1xf32, [[$col]]>
+// CHECK: tt.broadcast {{.*}} -> tensor<128x128xf32, [[$col]]>
+// CHECK: arith.addf {{.*}} : tensor<128x128xf32, [[$col]]>
+// CHECK-NOT: triton_gpu.convert_layout
+// CHECK: tt.store
+tt.func @broadcast_row(%ptrs: tensor<128x!tt.ptr<f32>, #row_slice>, %out: tensor<128x128x!tt.ptr<f32>, #col>) {
+  %cst = arith.constant dense<1.000000e+00> : tensor<128x128xf32, #row>
+  %0 = tt.load %ptrs {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32, #row_slice>
+  %1 = tt.expand_dims %0 {axis = 1 : i32} : (tensor<128xf32, #row_slice>) -> tensor<128x1xf32, #row>
+  %2 = tt.broadcast %1 : (tensor<128x1xf32, #row>) -> tensor<128x128xf32, #row>
+  %3 = arith.addf %2, %cst : tensor<128x128xf32, #row>
+  %4 = triton_gpu.convert_layout %3 : (tensor<128x128xf32, #row>) -> tensor<128x128xf32, #col>
+  tt.store %out, %4 : tensor<128x128xf32, #col>
+  tt.return
+}
+
+}
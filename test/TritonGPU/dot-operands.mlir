@@ -50,3 +50,25 @@ tt.func @push_elementwise2(
   %newc = tt.dot %dota, %dotb, %c {allowTF32 = true, transA = false, transB = false} : tensor<16x16xf16, #Av1> * tensor<16x16xf16, #Bv1> -> tensor<16x16xf32, #Cv1>
   tt.return %newc : tensor<16x16xf32, #Cv1>
 }
+
+// -----
+
+#Cv2 = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#Av2 = #triton_gpu.dot_op<{opIdx = 0, parent = #Cv2, kWidth=2}>
+#Bv2 = #triton_gpu.dot_op<{opIdx = 1, parent = #Cv2, kWidth=2}>
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#ALT = #triton_gpu.blocked<{sizePerThread = [4, 1], threadsPerWarp = [8, 4], warpsPerCTA = [1, 4], order = [0, 1]}>
+#BL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+
+// A transposition in registers is not reordered through shared memory
+// CHECK: tt.func @trans_blocked_to_dot
+// CHECK: %[[T:.*]] = tt.trans %{{.*}} : (tensor<16x16xf16, #{{.*}}>) -> tensor<16x16xf16, #{{.*}}>
+// CHECK: triton_gpu.convert_layout %[[T]]
+// CHECK: tt.dot
+tt.func @trans_blocked_to_dot(%a: tensor<16x16xf16, #BL>, %b: tensor<16x16xf16, #Bv2>, %c: tensor<16x16xf32, #Cv2>) -> tensor<16x16xf32, #Cv2> {
+  %0 = triton_gpu.convert_layout %a : (tensor<16x16xf16, #BL>) -> tensor<16x16xf16, #AL>
+  %1 = tt.trans %0 : (tensor<16x16xf16, #AL>) -> tensor<16x16xf16, #ALT>
+  %2 = triton_gpu.convert_layout %1 : (tensor<16x16xf16, #ALT>) -> tensor<16x16xf16, #Av2>
+  %d = tt.dot %2, %b, %c {allowTF32 = true, transA = false, transB = false} : tensor<16x16xf16, #Av2> * tensor<16x16xf16, #Bv2> -> tensor<16x16xf32, #Cv2>
+  tt.return %d : tensor<16x16xf32, #Cv2>
+}
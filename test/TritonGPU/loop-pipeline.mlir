@@ -225,20 +225,55 @@ tt.func @matmul_loop_single_pipeline(%lb : index, %ub : index, %step : index,
   tt.return %loop#1 : tensor<128x128xf32, #C>
 }
 
+// While loops counting up to a dynamic bound are pipelined as for loops
+// CHECK: tt.func @matmul_while_loop
+// CHECK: triton_gpu.insert_slice_async
+// CHECK: triton_gpu.insert_slice_async
+// CHECK: triton_gpu.async_wait {num = 1 : i32}
+// CHECK: %[[RES:.*]]:{{.*}} = scf.for
+// CHECK:   tt.dot
+// CHECK:   triton_gpu.insert_slice_async
+// CHECK:   triton_gpu.async_wait {num = 1 : i32}
+// CHECK: tt.return %[[RES]]#2
+tt.func @matmul_while_loop(%ub : i32, %a : tensor<128x32xf16, #A>,
+                           %b_ptr_init : tensor<32x128x!tt.ptr<f16>, #BL> {tt.divisibility = 16 : i32, tt.contiguity = 16 : i32}) -> tensor<128x128xf32, #C> {
+  %c0_i32 = arith.constant 0 : i32
+  %c32_i32 = arith.constant 32 : i32
+  %b_off = arith.constant dense<4> : tensor<32x128xi32, #BL>
+  %c_init = arith.constant dense<0.00e+00> : tensor<128x128xf32, #C>
+  %loop:3 = scf.while (%iv = %c0_i32, %b_ptr = %b_ptr_init, %prev_c = %c_init) : (i32, tensor<32x128x!tt.ptr<f16>, #BL>, tensor<128x128xf32, #C>) -> (i32, tensor<32x128x!tt.ptr<f16>, #BL>, tensor<128x128xf32, #C>) {
+    %cond = arith.cmpi slt, %iv, %ub : i32
+    scf.condition(%cond) %iv, %b_ptr, %prev_c : i32, tensor<32x128x!tt.ptr<f16>, #BL>, tensor<128x128xf32, #C>
+  } do {
+  ^bb0(%iv : i32, %b_ptr : tensor<32x128x!tt.ptr<f16>, #BL>, %prev_c : tensor<128x128xf32, #C>):
+    %b_ = tt.load %b_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<32x128xf16, #BL>
+    %b = triton_gpu.convert_layout %b_ : (tensor<32x128xf16, #BL>) -> tensor<32x128xf16, #B>
+    %c = tt.dot %a, %b, %prev_c {allowTF32 = true, transA = false, transB = false} : tensor<128x32xf16, #A> * tensor<32x128xf16, #B> -> tensor<128x128xf32, #C>
+    %next_b_ptr = tt.addptr %b_ptr, %b_off : tensor<32x128x!tt.ptr<f16>, #BL>, tensor<32x128xi32, #BL>
+    %next_iv = arith.addi %iv, %c32_i32 : i32
+    scf.yield %next_iv, %next_b_ptr, %c : i32, tensor<32x128x!tt.ptr<f16>, #BL>, tensor<128x128xf32, #C>
+  }
+  tt.return %loop#2 : tensor<128x128xf32, #C>
+}
+
 // CHECK: tt.func @lut_bmm_scalar
 // CHECK: triton_gpu.insert_slice_async
 // CHECK: triton_gpu.insert_slice_async
 // CHECK: triton_gpu.insert_slice_async
 // CHECK: triton_gpu.insert_slice_async
 // CHECK: triton_gpu.async_commit_group
-// CHECK: %[[LUT_BUFFER_0:.*]] = tt.load %arg15, {{.*}}
+// CHECK: %[[LUT_INIT:.*]] = tt.load
+// CHECK: scf.for {{.*}} iter_args({{.*}}, %[[LUT_BUFFER_0:arg[0-9]+]] = %[[LUT_INIT]])
 // CHECK: %[[LUT_BUFFER_1:.*]] = arith.muli {{.*}}, %[[LUT_BUFFER_0]]
 // CHECK: %[[LUT_BUFFER_2:.*]] = tt.splat %[[LUT_BUFFER_1]]
 // CHECK: %[[NEXT_BUFFER_0:.*]] = tt.addptr {{.*}}, %[[LUT_BUFFER_2]]
 // CHECK: %[[NEXT_BUFFER_1:.*]] = tt.addptr %arg14, {{.*}}
+// CHECK: %[[NEXT_LUT_PTR:.*]] = tt.addptr %arg15, {{.*}}
 // CHECK: triton_gpu.insert_slice_async %[[NEXT_BUFFER_1]]
 // CHECK: triton_gpu.insert_slice_async %[[NEXT_BUFFER_0]]
+// CHECK: %[[NEXT_LUT:.*]] = tt.load %[[NEXT_LUT_PTR]], {{.*}}
 // CHECK: triton_gpu.async_wait {num = 2 : i32}
+// CHECK: scf.yield {{.*}}, %[[NEXT_LUT]]
 tt.func @lut_bmm_scalar(%77: i64 {tt.divisibility=16: i32},
                    %76: index,
                    %49: tensor<16x16x!tt.ptr<f16>, #AL> {tt.divisibility=16: i32, tt.contiguity=2 : i32},
@@ -274,15 +309,19 @@ tt.func @lut_bmm_scalar(%77: i64 {tt.divisibility=16: i32},
 // CHECK: triton_gpu.insert_slice_async
 // CHECK: triton_gpu.insert_slice_async
 // CHECK: triton_gpu.async_commit_group
-// CHECK: %[[LUT_BUFFER_0:.*]] = tt.load %arg15, {{.*}}
+// CHECK: %[[LUT_INIT:.*]] = tt.load
+// CHECK: scf.for {{.*}} iter_args({{.*}}, %[[LUT_BUFFER_0:arg[0-9]+]] = %[[LUT_INIT]])
 // CHECK: %[[LUT_BUFFER_1:.*]] = tt.expand_dims %[[LUT_BUFFER_0]] {axis = 1 : i32}
 // CHECK: %[[LUT_BUFFER_2:.*]] = tt.broadcast %[[LUT_BUFFER_1]]
 // CHECK: %[[LUT_BUFFER_3:.*]] = arith.muli {{.*}}, %[[LUT_BUFFER_2]]
 // CHECK: %[[NEXT_BUFFER_0:.*]] = tt.addptr {{.*}}, %[[LUT_BUFFER_3]]
 // CHECK: %[[NEXT_BUFFER_1:.*]] = tt.addptr %arg14, {{.*}}
+// CHECK: %[[NEXT_LUT_PTR:.*]] = tt.addptr %arg15, {{.*}}
 // CHECK: triton_gpu.insert_slice_async %[[NEXT_BUFFER_1]]
 // CHECK: triton_gpu.insert_slice_async %[[NEXT_BUFFER_0]]
+// CHECK: %[[NEXT_LUT:.*]] = tt.load %[[NEXT_LUT_PTR]], {{.*}}
 // CHECK: triton_gpu.async_wait {num = 2 : i32}
+// CHECK: scf.yield {{.*}}, %[[NEXT_LUT]]
 tt.func @lut_bmm_vector(%77: tensor<16x16xi64, #BL> {tt.divisibility=16: i32, tt.constancy=16: i32},
                    %76: index,
                    %49: tensor<16x16x!tt.ptr<f16>, #AL> {tt.divisibility=16: i32, tt.contiguity=2 : i32},
@@ -313,3 +352,114 @@ tt.func @lut_bmm_vector(%77: tensor<16x16xi64, #BL> {tt.divisibility=16: i32, tt
   }
   tt.return %79#0 : tensor<16x16xf32, #C>
 }
+
+// The 2-D index load isn't a dot operand, the gather it feeds is pipelined
+// CHECK: tt.func @lut_bmm_tensor
+// CHECK-COUNT-4: triton_gpu.insert_slice_async
+// CHECK: %[[LUT_INIT:.*]] = tt.load
+// CHECK: scf.for {{.*}} iter_args({{.*}}, %[[LUT:arg[0-9]+]] = %[[LUT_INIT]])
+// CHECK: %[[OFFSET:.*]] = arith.muli {{.*}}, %[[LUT]]
+// CHECK: %[[NEXT_PTR:.*]] = tt.addptr {{.*}}, %[[OFFSET]]
+// CHECK: triton_gpu.insert_slice_async
+// CHECK: triton_gpu.insert_slice_async %[[NEXT_PTR]]
+// CHECK: %[[NEXT_LUT:.*]] = tt.load
+// CHECK: triton_gpu.async_wait {num = 2 : i32}
+// CHECK: scf.yield {{.*}}, %[[NEXT_LUT]]
+tt.func @lut_bmm_tensor(%77: tensor<16x16xi64, #BL> {tt.divisibility=16: i32, tt.constancy=16: i32},
+                   %76: index,
+                   %49: tensor<16x16x!tt.ptr<f16>, #AL> {tt.divisibility=16: i32, tt.contiguity=2 : i32},
+                   %75: tensor<16x16x!tt.ptr<i64>, #BL> {tt.divisibility=16: i32, tt.contiguity=16 : i32},
+                   %78: tensor<16x16xi32, #AL> {tt.constancy=16: i32, tt.divisibility=16: i32},
+                   %60: tensor<16x16x!tt.ptr<f16>, #BL> {tt.divisibility=16: i32, tt.contiguity=16 : i32}) -> tensor<16x16xf32, #C>{
+  %cst = arith.constant dense<0.000000e+00> : tensor<16x16xf32, #C>
+  %c1 = arith.constant 1 : index
+  %c0 = arith.constant 0 : index
+  %c16_i32 = arith.constant dense<16> : tensor<16x16xi32, #BL>
+  %79:3 = scf.for %arg18 = %c0 to %76 step %c1 iter_args(%arg19 = %cst, %arg20 = %49, %arg21 = %75) -> (tensor<16x16xf32, #C>, tensor<16x16x!tt.ptr<f16>, #AL>, tensor<16x16x!tt.ptr<i64>, #BL>) {
+    %82 = tt.load %arg20 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16xf16, #AL>
+    %83 = tt.load %arg21 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16xi64, #BL>
+    %85 = arith.muli %77, %83 : tensor<16x16xi64, #BL>
+    %86 = tt.addptr %60, %85 : tensor<16x16x!tt.ptr<f16>, #BL>, tensor<16x16xi64, #BL>
+    %87 = tt.load %86 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16xf16, #BL>
+    %88 = triton_gpu.convert_layout %82 : (tensor<16x16xf16, #AL>) -> tensor<16x16xf16, #A>
+    %89 = triton_gpu.convert_layout %87 : (tensor<16x16xf16, #BL>) -> tensor<16x16xf16, #B>
+    %90 = tt.dot %88, %89, %arg19 {allowTF32 = true} : tensor<16x16xf16, #A> * tensor<16x16xf16, #B> -> tensor<16x16xf32, #C>
+    %91 = tt.addptr %arg20, %78 : tensor<16x16x!tt.ptr<f16>, #AL>, tensor<16x16xi32, #AL>
+    %92 = tt.addptr %arg21, %c16_i32 : tensor<16x16x!tt.ptr<i64>, #BL>, tensor<16x16xi32, #BL>
+    scf.yield %90, %91, %92 : tensor<16x16xf32, #C>, tensor<16x16x!tt.ptr<f16>, #AL>, tensor<16x16x!tt.ptr<i64>, #BL>
+  }
+  tt.return %79#0 : tensor<16x16xf32, #C>
+}
+
+// CHECK: tt.func @matmul_loop_block_ptr
+// CHECK: triton_gpu.insert_slice_async {{.*}} {axis = 0 : i32, boundaryCheck = array<i32: 0, 1>, {{.*}}} : !tt.ptr<tensor<32x128xf16>>, tensor<32x128xi1, #{{.*}}> -> tensor<3x32x128xf16, #{{.*}}>
+// CHECK: triton_gpu.insert_slice_async {{.*}} {axis = 0 : i32, boundaryCheck = array<i32: 0, 1>, {{.*}}} : !tt.ptr<tensor<32x128xf16>>, tensor<32x128xi1, #{{.*}}> -> tensor<3x32x128xf16, #{{.*}}>
+// CHECK: scf.for
+// CHECK:   tt.dot
+// CHECK:   tt.advance
+// CHECK:   triton_gpu.insert_slice_async {{.*}} {axis = 0 : i32, boundaryCheck = array<i32: 0, 1>, {{.*}}} : !tt.ptr<tensor<32x128xf16>>
+tt.func @matmul_loop_block_ptr(%lb : index, %ub : index, %step : index,
+                               %a : tensor<128x32xf16, #A>,
+                               %B : !tt.ptr<f16> {tt.divisibility = 16 : i32},
+                               %K : i64 {tt.divisibility = 16 : i32},
+                               %N : i64 {tt.divisibility = 16 : i32}) -> tensor<128x128xf32, #C> {
+  %c0_i32 = arith.constant 0 : i32
+  %c32_i32 = arith.constant 32 : i32
+  %c1_i64 = arith.constant 1 : i64
+  %b_ptr_init = tt.make_tensor_ptr %B, [%K, %N], [%N, %c1_i64], [%c0_i32, %c0_i32] {order = array<i32: 1, 0>} : !tt.ptr<tensor<32x128xf16>>
+  %c_init = arith.constant dense<0.00e+00> : tensor<128x128xf32, #C>
+
+  %loop:2 = scf.for %iv = %lb to %ub step %step iter_args(%b_ptr = %b_ptr_init, %prev_c = %c_init) -> (!tt.ptr<tensor<32x128xf16>>, tensor<128x128xf32, #C>) {
+    %b_ = tt.load %b_ptr {boundaryCheck = array<i32: 0, 1>, cache = 1 : i32, evict = 1 : i32, isVolatile = false, padding = 1 : i32} : !tt.ptr<tensor<32x128xf16>> -> tensor<32x128xf16, #BL>
+    %b = triton_gpu.convert_layout %b_ : (tensor<32x128xf16, #BL>) -> tensor<32x128xf16, #B>
+    %c = tt.dot %a, %b, %prev_c {allowTF32 = true, transA = false, transB = false} : tensor<128x32xf16, #A> * tensor<32x128xf16, #B> -> tensor<128x128xf32, #C>
+    %next_b_ptr = tt.advance %b_ptr, [%c32_i32, %c0_i32] : !tt.ptr<tensor<32x128xf16>>
+    scf.yield %next_b_ptr, %c : !tt.ptr<tensor<32x128xf16>>, tensor<128x128xf32, #C>
+  }
+  tt.return %loop#1 : tensor<128x128xf32, #C>
+}
+
+// -----
+
+#L = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+
+// Loops without dot operands double-buffer their loads in registers
+// CHECK: tt.func @stream_loop
+// CHECK: %[[INIT:.*]] = tt.load
+// CHECK: scf.for %[[IV:.*]] = {{.*}} iter_args(%[[PTR:arg[0-9]+]] = {{.*}}, %[[ACC:arg[0-9]+]] = {{.*}}, %[[CUR:arg[0-9]+]] = %[[INIT]])
+// CHECK: %[[NEXT_IV:.*]] = arith.addi %[[IV]]
+// CHECK-DAG: arith.cmpi slt, %[[NEXT_IV]]
+// CHECK-DAG: %[[NEXT_PTR:.*]] = tt.addptr %[[PTR]]
+// CHECK: %[[NEXT:.*]] = tt.load %[[NEXT_PTR]]
+// CHECK: arith.addf %[[ACC]], %[[CUR]]
+// CHECK: scf.yield {{.*}}, %[[NEXT]]
+tt.func @stream_loop(%lb : index, %ub : index, %step : index,
+                     %ptr_init : tensor<1024x!tt.ptr<f32>, #L>) -> tensor<1024xf32, #L> {
+  %zero = arith.constant dense<0.00e+00> : tensor<1024xf32, #L>
+  %offset = arith.constant dense<1024> : tensor<1024xi32, #L>
+  %loop:2 = scf.for %iv = %lb to %ub step %step iter_args(%ptr = %ptr_init, %acc = %zero) -> (tensor<1024x!tt.ptr<f32>, #L>, tensor<1024xf32, #L>) {
+    %x = tt.load %ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<1024xf32, #L>
+    %next_acc = arith.addf %acc, %x : tensor<1024xf32, #L>
+    %next_ptr = tt.addptr %ptr, %offset : tensor<1024x!tt.ptr<f32>, #L>, tensor<1024xi32, #L>
+    scf.yield %next_ptr, %next_acc : tensor<1024x!tt.ptr<f32>, #L>, tensor<1024xf32, #L>
+  }
+  tt.return %loop#1 : tensor<1024xf32, #L>
+}
+
+// The prefetched loads may alias the stores
+// CHECK: tt.func @stream_copy_loop
+// CHECK: scf.for
+// CHECK-NEXT: tt.load
+tt.func @stream_copy_loop(%lb : index, %ub : index, %step : index,
+                          %src_init : tensor<1024x!tt.ptr<f32>, #L>,
+                          %dst_init : tensor<1024x!tt.ptr<f32>, #L>) {
+  %offset = arith.constant dense<1024> : tensor<1024xi32, #L>
+  %loop:2 = scf.for %iv = %lb to %ub step %step iter_args(%src = %src_init, %dst = %dst_init) -> (tensor<1024x!tt.ptr<f32>, #L>, tensor<1024x!tt.ptr<f32>, #L>) {
+    %x = tt.load %src {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<1024xf32, #L>
+    tt.store %dst, %x : tensor<1024xf32, #L>
+    %next_src = tt.addptr %src, %offset : tensor<1024x!tt.ptr<f32>, #L>, tensor<1024xi32, #L>
+    %next_dst = tt.addptr %dst, %offset : tensor<1024x!tt.ptr<f32>, #L>, tensor<1024xi32, #L>
+    scf.yield %next_src, %next_dst : tensor<1024x!tt.ptr<f32>, #L>, tensor<1024x!tt.ptr<f32>, #L>
+  }
+  tt.return
+}
@@ -0,0 +1,83 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-loop-unroll | FileCheck %s
+
+// 10 iterations unrolled 4 times: 2 iterations of the unrolled loop, then a
+// remainder loop for the last 2.
+// CHECK-LABEL: unroll_with_remainder
+// CHECK-DAG: %[[C0:.*]] = arith.constant 0 : i32
+// CHECK-DAG: %[[C1:.*]] = arith.constant 1 : i32
+// CHECK-DAG: %[[C8:.*]] = arith.constant 8 : i32
+// CHECK-DAG: %[[C4:.*]] = arith.constant 4 : i32
+// CHECK-DAG: %[[C10:.*]] = arith.constant 10 : i32
+// CHECK: %[[MAIN:.*]] = scf.for %[[IV:.*]] = %[[C0]] to %[[C8]] step %[[C4]] iter_args(%[[ACC:.*]] = %{{.*}}) -> (f32)
+// CHECK: %[[S0:.*]] = arith.addf %[[ACC]]
+// CHECK: %[[S1:.*]] = arith.addf %[[S0]]
+// CHECK: %[[S2:.*]] = arith.addf %[[S1]]
+// CHECK: %[[S3:.*]] = arith.addf %[[S2]]
+// CHECK: scf.yield %[[S3]] : f32
+// CHECK-NOT: tt.num_unroll
+// CHECK: %[[REM:.*]] = scf.for %{{.*}} = %[[C8]] to %[[C10]] step %[[C1]] iter_args(%{{.*}} = %[[MAIN]]) -> (f32)
+// CHECK: arith.addf
+// CHECK-NOT: arith.addf
+// CHECK: } {tt.unroll_remainder}
+// CHECK: tt.return %[[REM]]
+tt.func @unroll_with_remainder() -> f32 {
+  %c0 = arith.constant 0 : i32
+  %c1 = arith.constant 1 : i32
+  %c10 = arith.constant 10 : i32
+  %init = arith.constant 0.000000e+00 : f32
+  %res = scf.for %iv = %c0 to %c10 step %c1 iter_args(%acc = %init) -> (f32) {
+    %ivf = arith.sitofp %iv : i32 to f32
+    %next = arith.addf %acc, %ivf : f32
+    scf.yield %next : f32
+  } {tt.num_unroll = 4 : i32}
+  tt.return %res : f32
+}
+
+// -----
+
+// A trip count that is a multiple of the factor needs no remainder loop.
+// CHECK-LABEL: unroll_exact
+// CHECK: scf.for
+// CHECK-COUNT-2: arith.addf
+// CHECK: scf.yield
+// CHECK-NOT: scf.for
+// CHECK: tt.return
+tt.func @unroll_exact() -> f32 {
+  %c0 = arith.constant 0 : i32
+  %c1 = arith.constant 1 : i32
+  %c8 = arith.constant 8 : i32
+  %init = arith.constant 0.000000e+00 : f32
+  %res = scf.for %iv = %c0 to %c8 step %c1 iter_args(%acc = %init) -> (f32) {
+    %ivf = arith.sitofp %iv : i32 to f32
+    %next = arith.addf %acc, %ivf : f32
+    scf.yield %next : f32
+  } {tt.num_unroll = 2 : i32}
+  tt.return %res : f32
+}
+
+// -----
+
+// With dynamic bounds, the bound of the unrolled loop is computed at run
+// time and the remainder loop is always emitted.
+// CHECK-LABEL: unroll_dynamic
+// CHECK-SAME: %[[LB:[^:]*]]: i32, %[[UB:[^:]*]]: i32, %[[STEP:[^:]*]]: i32
+// CHECK: %[[TRIP:.*]] = arith.divsi
+// CHECK: %[[REM:.*]] = arith.remsi %[[TRIP]]
+// CHECK: %[[N:.*]] = arith.subi %[[TRIP]], %[[REM]]
+// CHECK: %[[SPAN:.*]] = arith.muli %[[N]], %[[STEP]]
+// CHECK: %[[END:.*]] = arith.addi %[[LB]], %[[SPAN]]
+// CHECK: %[[STEP2:.*]] = arith.muli %[[STEP]]
+// CHECK: scf.for %[[IV:.*]] = %[[LB]] to %[[END]] step %[[STEP2]]
+// CHECK: tt.store
+// CHECK: %[[OFF:.*]] = arith.muli %[[STEP]]
+// CHECK: arith.addi %[[IV]], %[[OFF]]
+// CHECK: tt.store
+// CHECK: scf.for %{{.*}} = %[[END]] to %[[UB]] step %[[STEP]]
+// CHECK: tt.store
+// CHECK: } {tt.unroll_remainder}
+tt.func @unroll_dynamic(%lb: i32, %ub: i32, %step: i32, %ptr: !tt.ptr<i32>) {
+  scf.for %iv = %lb to %ub step %step {
+    tt.store %ptr, %iv : i32
+  } {tt.num_unroll = 2 : i32}
+  tt.return
+}
@@ -0,0 +1,56 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-perf-lint -verify-diagnostics
+
+// The strided pointers are accessed one element at a time, while the
+// contiguous ones are accessed with 128-bit vectors.
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  tt.func @strided_load(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+    %0 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #blocked>
+    %c2 = arith.constant dense<2> : tensor<1024xi32, #blocked>
+    %1 = arith.muli %0, %c2 : tensor<1024xi32, #blocked>
+    %2 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<1024x!tt.ptr<f32>, #blocked>
+    %3 = tt.addptr %2, %1 : tensor<1024x!tt.ptr<f32>, #blocked>, tensor<1024xi32, #blocked>
+    // expected-remark @+1 {{load is not vectorized: 32-bit accesses instead of 128 bits, as the pointers have contiguity=1}}
+    %4 = tt.load %3 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<1024xf32, #blocked>
+    %5 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<1024x!tt.ptr<f32>, #blocked>
+    %6 = tt.addptr %5, %0 : tensor<1024x!tt.ptr<f32>, #blocked>, tensor<1024xi32, #blocked>
+    tt.store %6, %4 : tensor<1024xf32, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+// The operands of the dot are loaded element by element, which cannot be
+// copied asynchronously, and go through shared memory in every iteration.
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [4, 1]}>
+#dot0 = #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 2}>
+#dot1 = #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 2}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  tt.func @unpipelined_dot(%a_ptrs: tensor<32x32x!tt.ptr<f16>, #blocked>, %b_ptrs: tensor<32x32x!tt.ptr<f16>, #blocked>, %n: i32) -> tensor<32x32xf32, #mma> {
+    %c0 = arith.constant 0 : i32
+    %c1 = arith.constant 1 : i32
+    %acc0 = arith.constant dense<0.000000e+00> : tensor<32x32xf32, #mma>
+    // expected-remark @+2 {{2 layout conversions inside the loop go through shared memory, 2048 bytes at most each}}
+    // expected-remark @+1 {{pipelining skipped: none of the 2 loads can be pipelined}}
+    %res = scf.for %iv = %c0 to %n step %c1 iter_args(%acc = %acc0) -> (tensor<32x32xf32, #mma>) {
+      // expected-remark @+2 {{load is not vectorized: 16-bit accesses instead of 128 bits}}
+      // expected-note @+1 {{load not pipelined: its accesses are 16-bit wide, asynchronous copies need 32 bits or more}}
+      %a = tt.load %a_ptrs {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<32x32xf16, #blocked>
+      // expected-remark @+2 {{load is not vectorized: 16-bit accesses instead of 128 bits}}
+      // expected-note @+1 {{load not pipelined: its accesses are 16-bit wide, asynchronous copies need 32 bits or more}}
+      %b = tt.load %b_ptrs {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<32x32xf16, #blocked>
+      // expected-note @+1 {{conversion through 2048 bytes of shared memory}}
+      %a_smem = triton_gpu.convert_layout %a : (tensor<32x32xf16, #blocked>) -> tensor<32x32xf16, #shared>
+      %a_dot = triton_gpu.convert_layout %a_smem : (tensor<32x32xf16, #shared>) -> tensor<32x32xf16, #dot0>
+      // expected-note @+1 {{conversion through 2048 bytes of shared memory}}
+      %b_smem = triton_gpu.convert_layout %b : (tensor<32x32xf16, #blocked>) -> tensor<32x32xf16, #shared>
+      %b_dot = triton_gpu.convert_layout %b_smem : (tensor<32x32xf16, #shared>) -> tensor<32x32xf16, #dot1>
+      %d = tt.dot %a_dot, %b_dot, %acc {allowTF32 = true} : tensor<32x32xf16, #dot0> * tensor<32x32xf16, #dot1> -> tensor<32x32xf32, #mma>
+      scf.yield %d : tensor<32x32xf32, #mma>
+    }
+    tt.return %res : tensor<32x32xf32, #mma>
+  }
+}
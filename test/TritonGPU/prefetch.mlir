@@ -66,3 +66,38 @@ tt.func @matmul_loop_mixed(%lb : index, %ub : index, %step : index, %A : !tt.ptr
   }
   tt.return %loop#4 : tensor<128x128xf32, #C>
 }
+
+// -----
+
+#A = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+#B = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+#C = #triton_gpu.mma<{version = 2, warpsPerCTA = [4, 1]}>
+#A_OP = #triton_gpu.dot_op<{opIdx = 0, parent = #C, kWidth = 2}>
+#B_OP = #triton_gpu.dot_op<{opIdx = 1, parent = #C, kWidth = 2}>
+
+// Both dots of the loop are prefetched, the slices of the loop-invariant
+// operand are not carried
+// CHECK: tt.func @matmul_loop_two_dots
+// CHECK-DAG: %[[Q0:.*]] = triton_gpu.extract_slice %[[Q:.*]][0, 0] [128, 16]
+// CHECK-DAG: %[[Q0_PREFETCH:.*]] = triton_gpu.convert_layout %[[Q0]]
+// CHECK:     scf.for {{.*}} iter_args(%[[arg_a:.*]] = {{.*}}, %[[arg_b:.*]] = {{.*}}, %[[arg_k:.*]] = {{.*}}, {{.*}}, {{.*}}, %[[a_prefetch:.*]] = {{.*}}, %[[b_prefetch:.*]] = {{.*}}, %[[k_prefetch:.*]] = {{.*}})
+// CHECK:       %[[D0:.*]] = tt.dot %[[a_prefetch]], %[[b_prefetch]], {{.*}}
+// CHECK:       tt.dot {{.*}}, {{.*}}, %[[D0]]
+// CHECK-DAG:   %[[Q_REM:.*]] = triton_gpu.extract_slice %[[Q]][0, 16] [128, 16]
+// CHECK-DAG:   %[[K_REM:.*]] = triton_gpu.extract_slice %[[arg_k]][16, 0] [16, 128]
+// CHECK:       %[[E0:.*]] = tt.dot %[[Q0_PREFETCH]], %[[k_prefetch]], {{.*}}
+// CHECK:       tt.dot {{.*}}, {{.*}}, %[[E0]]
+// CHECK:     scf.yield {{.*}}, {{.*}}, {{.*}}, {{.*}}, {{.*}}, {{.*}}, {{.*}}, {{.*}} :
+tt.func @matmul_loop_two_dots(%lb : index, %ub : index, %step : index, %q : tensor<128x32xf16, #A>, %a_init : tensor<128x32xf16, #A>, %b_init : tensor<32x128xf16, #B>, %k_init : tensor<32x128xf16, #B>) -> (tensor<128x128xf32, #C>, tensor<128x128xf32, #C>) {
+  %c_init = arith.constant dense<0.00e+00> : tensor<128x128xf32, #C>
+  %loop:5 = scf.for %iv = %lb to %ub step %step iter_args(%a = %a_init, %b = %b_init, %k = %k_init, %prev_c = %c_init, %prev_e = %c_init) -> (tensor<128x32xf16, #A>, tensor<32x128xf16, #B>, tensor<32x128xf16, #B>, tensor<128x128xf32, #C>, tensor<128x128xf32, #C>) {
+    %a_op = triton_gpu.convert_layout %a : (tensor<128x32xf16, #A>) -> tensor<128x32xf16, #A_OP>
+    %b_op = triton_gpu.convert_layout %b : (tensor<32x128xf16, #B>) -> tensor<32x128xf16, #B_OP>
+    %c = tt.dot %a_op, %b_op, %prev_c {allowTF32 = true} : tensor<128x32xf16, #A_OP> * tensor<32x128xf16, #B_OP> -> tensor<128x128xf32, #C>
+    %q_op = triton_gpu.convert_layout %q : (tensor<128x32xf16, #A>) -> tensor<128x32xf16, #A_OP>
+    %k_op = triton_gpu.convert_layout %k : (tensor<32x128xf16, #B>) -> tensor<32x128xf16, #B_OP>
+    %e = tt.dot %q_op, %k_op, %prev_e {allowTF32 = true} : tensor<128x32xf16, #A_OP> * tensor<32x128xf16, #B_OP> -> tensor<128x128xf32, #C>
+    scf.yield %q, %k, %b, %c, %e : tensor<128x32xf16, #A>, tensor<32x128xf16, #B>, tensor<32x128xf16, #B>, tensor<128x128xf32, #C>, tensor<128x128xf32, #C>
+  }
+  tt.return %loop#3, %loop#4 : tensor<128x128xf32, #C>, tensor<128x128xf32, #C>
+}
@@ -0,0 +1,49 @@
+// RUN: triton-opt %s -tritongpu-reorder-instructions="reg-budget=90" | FileCheck %s
+// RUN: triton-opt %s -tritongpu-reorder-instructions | FileCheck %s --check-prefix=DEFAULT
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// Each tensor<1024xf32> needs 8 registers per thread and each tensor of
+// pointers 16. Issuing the four loads first peaks at 105 registers; consuming
+// the first two loads before issuing the others peaks at 97. The default
+// budget of 4 warps (255 registers) keeps the original order.
+// CHECK-LABEL: interleave_loads
+// CHECK: scf.for
+// CHECK: %[[A:.*]] = tt.load
+// CHECK-NEXT: %[[B:.*]] = tt.load
+// CHECK-NEXT: arith.addf %[[A]], %[[B]]
+// CHECK-NEXT: tt.load
+// CHECK-NEXT: tt.load
+// CHECK-NEXT: arith.addf
+// DEFAULT-LABEL: interleave_loads
+// DEFAULT: scf.for
+// DEFAULT: tt.load
+// DEFAULT-NEXT: tt.load
+// DEFAULT-NEXT: tt.load
+// DEFAULT-NEXT: tt.load
+// DEFAULT-NEXT: arith.addf
+tt.func @interleave_loads(%lb : index, %ub : index, %step : index,
+                          %pa : tensor<1024x!tt.ptr<f32>, #blocked>,
+                          %pb : tensor<1024x!tt.ptr<f32>, #blocked>,
+                          %pc : tensor<1024x!tt.ptr<f32>, #blocked>,
+                          %pd : tensor<1024x!tt.ptr<f32>, #blocked>,
+                          %out : tensor<1024x!tt.ptr<f32>, #blocked>) {
+  %acc_init = arith.constant dense<0.000000e+00> : tensor<1024xf32, #blocked>
+  %loop = scf.for %iv = %lb to %ub step %step iter_args(%acc = %acc_init) -> (tensor<1024xf32, #blocked>) {
+    %a = tt.load %pa {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<1024xf32, #blocked>
+    %b = tt.load %pb {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<1024xf32, #blocked>
+    %c = tt.load %pc {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<1024xf32, #blocked>
+    %d = tt.load %pd {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<1024xf32, #blocked>
+    %x = arith.addf %a, %b : tensor<1024xf32, #blocked>
+    %y = arith.addf %c, %d : tensor<1024xf32, #blocked>
+    %s = arith.addf %x, %y : tensor<1024xf32, #blocked>
+    %next = arith.addf %acc, %s : tensor<1024xf32, #blocked>
+    scf.yield %next : tensor<1024xf32, #blocked>
+  }
+  tt.store %out, %loop : tensor<1024xf32, #blocked>
+  tt.return
+}
+
+}
@@ -10,6 +10,14 @@ struct TestAllocationPass
 
   MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(TestAllocationPass);
 
+  TestAllocationPass() = default;
+  TestAllocationPass(const TestAllocationPass &pass) : PassWrapper(pass) {}
+
+  Option<std::string> strategy{
+      *this, "strategy",
+      llvm::cl::desc("allocation strategy: heuristic or best-fit"),
+      llvm::cl::init("heuristic")};
+
   StringRef getArgument() const final { return "test-print-allocation"; }
   StringRef getDescription() const final {
     return "print the result of the allocation pass";
@@ -19,7 +27,10 @@ struct TestAllocationPass
     auto &os = llvm::errs();
     ModuleOp moduleOp = getOperation();
     // Convert to std::string can remove quotes from opName
-    ModuleAllocation moduleAllocation(moduleOp);
+    auto allocationStrategy = strategy == "best-fit"
+                                  ? AllocationStrategy::BestFit
+                                  : AllocationStrategy::Heuristic;
+    ModuleAllocation moduleAllocation(moduleOp, allocationStrategy);
     moduleOp.walk([&](triton::FuncOp funcOp) {
       auto opName = SymbolTable::getSymbolName(funcOp).getValue().str();
       os << opName << "\n";
@@ -46,6 +57,8 @@ struct TestAllocationPass
         }
       });
       os << "size = " << allocation->getSharedMemorySize() << "\n";
+      os << "lower bound = " << allocation->getSharedMemoryLowerBound()
+         << "\n";
     });
   }
 };
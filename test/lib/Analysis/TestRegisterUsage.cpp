@@ -0,0 +1,38 @@
+#include "mlir/Pass/Pass.h"
+#include "triton/Analysis/RegisterUsage.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+
+using namespace mlir;
+
+namespace {
+
+struct TestRegisterUsagePass
+    : public PassWrapper<TestRegisterUsagePass, OperationPass<ModuleOp>> {
+
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(TestRegisterUsagePass);
+
+  StringRef getArgument() const final { return "test-print-register-usage"; }
+  StringRef getDescription() const final {
+    return "print the estimated registers per thread of the functions";
+  }
+
+  void runOnOperation() override {
+    auto &os = llvm::errs();
+    ModuleOp moduleOp = getOperation();
+    moduleOp.walk([&](triton::FuncOp funcOp) {
+      auto opName = SymbolTable::getSymbolName(funcOp).getValue().str();
+      os << opName << "\n";
+      os << "registers = " << estimateRegisterUsage(funcOp) << "\n";
+    });
+  }
+};
+
+} // namespace
+
+namespace mlir {
+namespace test {
+void registerTestRegisterUsagePass() {
+  PassRegistration<TestRegisterUsagePass>();
+}
+} // namespace test
+} // namespace mlir